@@ -22,8 +22,7 @@
 #include <base/counter.h>
 
 #include <cassert>
-
-#include <base/exclusive_lock.h>
+#include <mutex>
 
 using namespace Base;
 
@@ -36,33 +35,43 @@ TCounter::TCounter(const TCodeLocation &code_location,
   FirstCounter = this;
 }
 
+/* Serializes calls to Reset() and Sample().  Incrementing threads never
+   acquire this. */
+static std::mutex &GetSampleMutex() noexcept {
+  static std::mutex sample_mutex;
+  return sample_mutex;
+}
+
 time_t TCounter::Reset() noexcept {
-  TExclusiveLock<TBlockingAsset> lock(Asset);
+  std::lock_guard<std::mutex> lock(GetSampleMutex());
   ResetTime = time(0);
 
   for (TCounter *counter = FirstCounter;
        counter;
        counter = counter->NextCounter) {
-    counter->SampledCount = 0;
+    counter->ResetTotal = counter->SampledTotal;
   }
 
   return ResetTime;
 }
 
 void TCounter::Sample() noexcept {
-  TExclusiveLock<TBlockingAsset> lock(Asset);
+  std::lock_guard<std::mutex> lock(GetSampleMutex());
   SampleTime = time(0);
 
   for (TCounter *counter = FirstCounter;
        counter;
        counter = counter->NextCounter) {
-    counter->SampledCount += counter->UnsampledCount;
-    counter->UnsampledCount = 0;
+    uint64_t total = 0;
+
+    for (const TSlot &slot : counter->Slots) {
+      total += slot.Count.load(std::memory_order_relaxed);
+    }
+
+    counter->SampledTotal = total;
   }
 }
 
-TBlockingAsset TCounter::Asset;
-
 TCounter *TCounter::FirstCounter = nullptr;
 
 time_t TCounter::SampleTime = time(0);
@@ -21,13 +21,15 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <ctime>
 
 #include <base/code_location.h>
 #include <base/no_copy_semantics.h>
-#include <base/blocking_asset.h>
-#include <base/shared_lock.h>
+#include <base/thread_shard.h>
 
 /* A macro to simplify declaring counters. */
 #define DEFINE_COUNTER(name) static ::Base::TCounter name(HERE, #name);
@@ -77,8 +79,7 @@ namespace Base {
         }
 
      You may also call Reset(), which resets all the sampled values to zero.
-     Doing this periodically helps to avoid overflows; however, the counters
-     are unsigned 32-bit numbers, so don't sweat it.
+     The counters are unsigned 64-bit numbers, so overflow is not a concern.
 
      You may also call GetSampleTime() to get the time at which the counters
      were last sampled, and GetResetTime() to get the time at which the
@@ -87,7 +88,17 @@ namespace Base {
      The counters in the program are kept in a singly-linked list formed during
      pre-main initialization.  The GetFirstCounter() and GetNextCounter()
      functions allow you to access this list.  The counters appear in no
-     particular order. */
+     particular order.
+
+     Counters are incremented from many threads on the message handling fast
+     path, so Increment() must be cheap.  Each counter therefore keeps a
+     fixed number of cache line sized slots, and each thread increments only
+     the slot assigned to it (see <base/thread_shard.h>) using a relaxed
+     atomic add.  Sample() sums the slots without blocking incrementing
+     threads.  The price is that a sample is no longer a snapshot of all
+     counters at a single moment in time: an increment that races with
+     Sample() may show up in one counter's sampled value before it shows up
+     in another's. */
   class TCounter {
     NO_COPY_SEMANTICS(TCounter);
 
@@ -103,8 +114,8 @@ namespace Base {
     }
 
     /* The count as of the last time the counters were sampled. */
-    uint32_t GetCount() const noexcept {
-      return SampledCount;
+    uint64_t GetCount() const noexcept {
+      return SampledTotal - ResetTotal;
     }
 
     /* The name of this counter.  This should be unique within its module.
@@ -120,9 +131,9 @@ namespace Base {
 
     /* Increment the counter.  This will not change the current frozen value,
        but will be reflected in the next frozen value. */
-    void Increment(uint32_t delta = 1) noexcept {
-      Base::TSharedLock<Base::TBlockingAsset> lock(Asset);
-      __sync_add_and_fetch(&UnsampledCount, delta);
+    void Increment(uint64_t delta = 1) noexcept {
+      Slots[Base::GetThreadShardIndex() % SLOT_COUNT].Count.fetch_add(delta,
+          std::memory_order_relaxed);
     }
 
     /* The time of the most recent reset of the counters.
@@ -154,33 +165,37 @@ namespace Base {
       return FirstCounter;
     }
 
+    /* Number of slots per counter.  Threads beyond this many share slots,
+       which is still correct but lets them contend. */
+    static const size_t SLOT_COUNT = 8;
+
     private:
+    /* One thread's share of the count.  Each slot gets its own cache line so
+       that threads incrementing the same counter don't contend. */
+    struct alignas(64) TSlot {
+      std::atomic<uint64_t> Count{0};
+    };  // TSlot
+
     /* See accessor. */
     Base::TCodeLocation CodeLocation;
 
     /* See accessor. */
     const char *Name;
 
-    /* The currently incrementing count.  There is no direct access to this
-       variable; instead, the Sample() function adds this variable to
-       SampledCount, then sets this variable back to zero. */
-    uint32_t UnsampledCount = 0;
+    /* The currently incrementing counts.  These only ever increase.  There is
+       no direct access to them; instead, the Sample() function stores their
+       sum in SampledTotal. */
+    std::array<TSlot, SLOT_COUNT> Slots;
 
-    /* See accessor. */
-    uint32_t SampledCount = 0;
+    /* Sum of 'Slots' as of the last call to Sample(). */
+    uint64_t SampledTotal = 0;
+
+    /* Value of 'SampledTotal' as of the last call to Reset(). */
+    uint64_t ResetTotal = 0;
 
     /* See accessor. */
     TCounter *NextCounter;
 
-    /* We use this asset to coordinate the incrementing and freezing functions.
-       When any counter is incrementing, it acquires this asset in shared mode.
-       This allows multiple counters to be incrementing simultaneously with a
-       minimum of synchronization overhead.  During a freeze operation, this
-       asset is acquired exclusively, temporarily blocking all increments while
-       the frozen values are copied.  This allows us to get a consistent
-       snapshot of all counters at a single moment in time. */
-    static Base::TBlockingAsset Asset;
-
     /* See accessor. */
     static TCounter *FirstCounter;
 
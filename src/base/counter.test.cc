@@ -24,6 +24,7 @@
 #include <cstdio>
 #include <cstring>
 #include <thread>
+#include <vector>
 
 #include <arpa/inet.h>
 #include <netinet/in.h>
@@ -46,6 +47,8 @@ namespace {
 
   DEFINE_COUNTER(Connections);
   DEFINE_COUNTER(Requests);
+  DEFINE_COUNTER(Contended);
+  DEFINE_COUNTER(Wide);
 
   const size_t BufSize = 1024;
 
@@ -197,6 +200,56 @@ namespace {
     ASSERT_FALSE(Requests.GetCount());
   }
 
+  TEST_F(TCounterTest, ManyThreads) {
+    /* Use more threads than slots, so some threads share a slot. */
+    static const size_t thread_count = TCounter::SLOT_COUNT * 2;
+    static const uint64_t increment_count = 100000;
+    TCounter::Sample();
+    TCounter::Reset();
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < thread_count; ++i) {
+      threads.emplace_back(
+          [] {
+            for (uint64_t j = 0; j < increment_count; ++j) {
+              Contended.Increment();
+            }
+          });
+    }
+
+    /* Sampling while the threads are running must not block them. */
+    for (size_t i = 0; i < 10; ++i) {
+      TCounter::Sample();
+      ASSERT_LE(Contended.GetCount(), thread_count * increment_count);
+    }
+
+    for (std::thread &t : threads) {
+      t.join();
+    }
+
+    TCounter::Sample();
+    ASSERT_EQ(Contended.GetCount(), thread_count * increment_count);
+
+    /* After a reset, only increments since the reset are counted. */
+    TCounter::Reset();
+    ASSERT_EQ(Contended.GetCount(), 0U);
+    Contended.Increment(3);
+    TCounter::Sample();
+    ASSERT_EQ(Contended.GetCount(), 3U);
+  }
+
+  TEST_F(TCounterTest, Wide) {
+    /* Counts don't wrap at 32 bits. */
+    const uint64_t big = uint64_t(1) << 32;
+    TCounter::Sample();
+    TCounter::Reset();
+    Wide.Increment(big);
+    Wide.Increment(big);
+    Wide.Increment();
+    TCounter::Sample();
+    ASSERT_EQ(Wide.GetCount(), (2 * big) + 1);
+  }
+
 }  // namespace
 
 int main(int argc, char **argv) {
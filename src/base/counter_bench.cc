@@ -0,0 +1,165 @@
+/* <base/counter_bench.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Benchmark program that measures counter increment cost when many threads
+   increment the same counter.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <base/basename.h>
+#include <base/blocking_asset.h>
+#include <base/counter.h>
+#include <base/shared_lock.h>
+#include <tclap/CmdLine.h>
+
+using namespace Base;
+
+DEFINE_COUNTER(BenchCounter);
+
+struct TCmdLineArgs {
+  TCmdLineArgs(int argc, const char *const argv[]);
+
+  size_t Threads = 8;
+
+  size_t Increments = 10000000;
+};  // TCmdLineArgs
+
+TCmdLineArgs::TCmdLineArgs(int argc, const char *const argv[]) {
+  using namespace TCLAP;
+  const std::string prog_name = Basename(argv[0]);
+  std::vector<const char *> arg_vec(&argv[0], &argv[0] + argc);
+  arg_vec[0] = prog_name.c_str();
+  CmdLine cmd("Benchmark for measuring contended counter increment cost",
+      ' ', "1.0");
+  ValueArg<decltype(Threads)> arg_threads("", "threads",
+      "Number of threads incrementing the counter.", false, Threads, "COUNT");
+  cmd.add(arg_threads);
+  ValueArg<decltype(Increments)> arg_increments("", "increments",
+      "Number of increments done by each thread.", false, Increments,
+      "COUNT");
+  cmd.add(arg_increments);
+  cmd.parse(argc, &arg_vec[0]);
+  Threads = arg_threads.getValue();
+  Increments = arg_increments.getValue();
+}
+
+/* Run 'increment' 'args.Increments' times in each of 'args.Threads' threads,
+   and report the elapsed time. */
+static void RunOne(const TCmdLineArgs &args, const char *name,
+    const std::function<void()> &increment) {
+  std::atomic<bool> go(false);
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < args.Threads; ++i) {
+    threads.emplace_back(
+        [&args, &go, &increment] {
+          while (!go.load()) {
+          }
+
+          for (size_t j = 0; j < args.Increments; ++j) {
+            increment();
+          }
+        });
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  go.store(true);
+
+  for (std::thread &t : threads) {
+    t.join();
+  }
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  const double total = static_cast<double>(args.Threads) *
+      static_cast<double>(args.Increments);
+  const double ns_per_increment = (total > 0.0) ?
+      (static_cast<double>(elapsed) / total) : 0.0;
+  std::cout << name << ": " << args.Threads << " threads, "
+      << (elapsed / 1000000) << " ms, " << ns_per_increment
+      << " ns/increment (wall clock time divided by total increments)"
+      << std::endl;
+}
+
+static int counter_bench_main(int argc, const char *const *argv) {
+  const TCmdLineArgs args(argc, argv);
+
+  /* The counter implementation in use before counters were sharded, for
+     comparison: a shared lock plus an atomic add on a single count. */
+  TBlockingAsset asset;
+  uint32_t locked_count = 0;
+  RunOne(args, "shared lock + atomic add",
+      [&asset, &locked_count] {
+        TSharedLock<TBlockingAsset> lock(asset);
+        __sync_add_and_fetch(&locked_count, 1);
+      });
+
+  /* A single atomic count shared by all threads. */
+  std::atomic<uint64_t> shared_count(0);
+  RunOne(args, "single atomic",
+      [&shared_count] {
+        shared_count.fetch_add(1, std::memory_order_relaxed);
+      });
+
+  RunOne(args, "TCounter",
+      [] {
+        BenchCounter.Increment();
+      });
+
+  TCounter::Sample();
+
+  if (BenchCounter.GetCount() != (args.Threads * args.Increments)) {
+    std::cerr << "error: TCounter value " << BenchCounter.GetCount()
+        << " does not match expected value "
+        << (args.Threads * args.Increments) << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, const char *const *argv) {
+  int ret = EXIT_SUCCESS;
+
+  try {
+    ret = counter_bench_main(argc, argv);
+  } catch (const TCLAP::ArgException &x) {
+    std::cerr << "error: " << x.error() << " for arg " << x.argId()
+        << std::endl;
+    ret = EXIT_FAILURE;
+  } catch (const std::exception &ex) {
+    std::cerr << "error: " << ex.what() << std::endl;
+    ret = EXIT_FAILURE;
+  } catch (...) {
+    std::cerr << "error: uncaught unknown exception" << std::endl;
+    ret = EXIT_FAILURE;
+  }
+
+  return ret;
+}
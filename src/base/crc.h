@@ -16,7 +16,7 @@
    limitations under the License.
    ----------------------------------------------------------------------------
 
-   Function for computing 32-bit CRC.
+   Functions for computing 32-bit CRCs.
  */
 
 #pragma once
@@ -33,4 +33,13 @@ namespace Base {
     return result.checksum();
   }
 
+  /* Compute CRC-32C (Castagnoli polynomial), as used by the Kafka record batch
+     format. */
+  static inline uint32_t ComputeCrc32c(const void *data, size_t data_size) {
+    boost::crc_optimal<32, 0x1edc6f41, 0xffffffff, 0xffffffff, true, true>
+        result;
+    result.process_bytes(data, data_size);
+    return result.checksum();
+  }
+
 }  // Base
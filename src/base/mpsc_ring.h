@@ -0,0 +1,146 @@
+/* <base/mpsc_ring.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Bounded lock-free queue for multiple producers and a single consumer.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include <base/no_copy_semantics.h>
+
+namespace Base {
+
+  /* A fixed capacity ring buffer that any number of producer threads and one
+     consumer thread may access concurrently without locking.  Each slot
+     carries a sequence number that tells a producer when the slot is free and
+     the consumer when it holds an item.  'T' must be default constructible
+     and move assignable.
+
+     A producer that has claimed a slot but not yet filled it keeps the
+     consumer from seeing items in later slots until it finishes, so TryPop()
+     may briefly report the ring empty while other producers' items are
+     available.  Callers that sleep when the ring is empty must therefore have
+     producers wake them after pushing. */
+  template <typename T>
+  class TMpscRing final {
+    NO_COPY_SEMANTICS(TMpscRing);
+
+    public:
+    /* The capacity is 'min_capacity' rounded up to a power of 2, and at least
+       2. */
+    explicit TMpscRing(size_t min_capacity)
+        : Mask(RoundUpPow2(min_capacity) - 1),
+          Cells(new TCell[Mask + 1]) {
+      for (size_t i = 0; i <= Mask; ++i) {
+        Cells[i].Seq.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    size_t GetCapacity() const noexcept {
+      return Mask + 1;
+    }
+
+    /* Producers only: Append 'item' to the ring, and return true on success.
+       If the ring is full, return false and leave 'item' unchanged. */
+    bool TryPush(T &&item) {
+      TCell *cell = nullptr;
+      size_t pos = EnqueuePos.load(std::memory_order_relaxed);
+
+      for (; ; ) {
+        cell = &Cells[pos & Mask];
+        const size_t seq = cell->Seq.load(std::memory_order_acquire);
+        const auto diff = static_cast<intptr_t>(seq) -
+            static_cast<intptr_t>(pos);
+
+        if (diff == 0) {
+          if (EnqueuePos.compare_exchange_weak(pos, pos + 1,
+              std::memory_order_relaxed)) {
+            break;
+          }
+        } else if (diff < 0) {
+          /* The consumer hasn't yet emptied the slot from the previous lap. */
+          return false;
+        } else {
+          pos = EnqueuePos.load(std::memory_order_relaxed);
+        }
+      }
+
+      cell->Item = std::move(item);
+      cell->Seq.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+
+    /* Consumer only: Remove the oldest item and move it into 'item'.  Return
+       false if no item is available. */
+    bool TryPop(T &item) {
+      TCell &cell = Cells[DequeuePos & Mask];
+
+      if (cell.Seq.load(std::memory_order_acquire) != (DequeuePos + 1)) {
+        return false;
+      }
+
+      item = std::move(cell.Item);
+      cell.Item = T();
+      cell.Seq.store(DequeuePos + Mask + 1, std::memory_order_release);
+      ++DequeuePos;
+      return true;
+    }
+
+    /* Consumer only: Return true if TryPop() would succeed. */
+    bool HasItem() const noexcept {
+      return Cells[DequeuePos & Mask].Seq.load(std::memory_order_acquire) ==
+          (DequeuePos + 1);
+    }
+
+    private:
+    struct TCell {
+      std::atomic<size_t> Seq{0};
+
+      T Item;
+    };  // TCell
+
+    static size_t RoundUpPow2(size_t n) noexcept {
+      size_t result = 2;
+
+      while (result < n) {
+        result <<= 1;
+      }
+
+      return result;
+    }
+
+    const size_t Mask;
+
+    const std::unique_ptr<TCell[]> Cells;
+
+    /* Next position for a producer to claim.  On its own cache line, since
+       producers contend on it. */
+    alignas(64) std::atomic<size_t> EnqueuePos{0};
+
+    /* Next position for the consumer to read. */
+    alignas(64) size_t DequeuePos = 0;
+  };  // TMpscRing
+
+}  // Base
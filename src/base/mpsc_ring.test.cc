@@ -0,0 +1,133 @@
+/* <base/mpsc_ring.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit test for <base/mpsc_ring.h>.
+ */
+
+#include <base/mpsc_ring.h>
+
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <base/error_util.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+
+namespace {
+
+  /* The fixture for testing class TMpscRing. */
+  class TMpscRingTest : public ::testing::Test {
+    protected:
+    TMpscRingTest() = default;
+
+    ~TMpscRingTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TMpscRingTest
+
+  TEST_F(TMpscRingTest, BasicTest) {
+    TMpscRing<std::unique_ptr<int>> ring(3);
+    ASSERT_EQ(ring.GetCapacity(), 4U);
+    std::unique_ptr<int> item;
+    ASSERT_FALSE(ring.HasItem());
+    ASSERT_FALSE(ring.TryPop(item));
+
+    for (int i = 0; i < 4; ++i) {
+      ASSERT_TRUE(ring.TryPush(std::make_unique<int>(i)));
+    }
+
+    /* A failed push leaves the item alone. */
+    auto extra = std::make_unique<int>(4);
+    ASSERT_FALSE(ring.TryPush(std::move(extra)));
+    ASSERT_TRUE(extra != nullptr);
+
+    /* Wrap around several times. */
+    for (int i = 0; i < 20; ++i) {
+      ASSERT_TRUE(ring.HasItem());
+      ASSERT_TRUE(ring.TryPop(item));
+      ASSERT_TRUE(item != nullptr);
+      ASSERT_EQ(*item, i);
+      ASSERT_TRUE(ring.TryPush(std::make_unique<int>(i + 4)));
+    }
+
+    /* Items left in the ring are destroyed with it. */
+  }
+
+  TEST_F(TMpscRingTest, ThreadTest) {
+    const size_t num_producers = 4;
+    const size_t items_per_producer = 100000;
+    TMpscRing<size_t> ring(64);
+    std::vector<std::thread> producers;
+
+    for (size_t p = 0; p < num_producers; ++p) {
+      producers.emplace_back(
+          [&ring, p, items_per_producer]() {
+            for (size_t i = 0; i < items_per_producer; ++i) {
+              while (!ring.TryPush(size_t((p << 32) | i))) {
+                std::this_thread::yield();
+              }
+            }
+          });
+    }
+
+    /* Items from each producer must arrive in order. */
+    std::vector<size_t> next(num_producers, 0);
+    size_t total = 0;
+    bool ok = true;
+    size_t item = 0;
+
+    while (total < (num_producers * items_per_producer)) {
+      if (!ring.TryPop(item)) {
+        std::this_thread::yield();
+        continue;
+      }
+
+      size_t p = item >> 32;
+
+      if ((p >= num_producers) || ((item & 0xffffffff) != next[p])) {
+        ok = false;
+      } else {
+        ++next[p];
+      }
+
+      ++total;
+    }
+
+    for (auto &t : producers) {
+      t.join();
+    }
+
+    ASSERT_TRUE(ok);
+    ASSERT_FALSE(ring.HasItem());
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  DieOnTerminate();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,163 @@
+/* <base/spsc_queue.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unbounded lock-free single-producer single-consumer queue.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+
+#include <base/no_copy_semantics.h>
+
+namespace Base {
+
+  /* An unbounded queue that one producer thread and one consumer thread may
+     access concurrently without locking.  Items are stored in fixed size
+     segments, so memory is allocated only once per 'SegmentSize' items.  'T'
+     must be default constructible and move assignable.
+
+     The producer calls Push() and the consumer calls Consume().  Push()
+     reports whether the queue was empty, which lets the producer notify a
+     sleeping consumer only when necessary: Consume() doesn't return until it
+     has seen the queue empty, so the first Push() after that reports an empty
+     queue.  Either role may be handed off to a different thread, as long as
+     something like a thread join establishes ordering between the old and new
+     threads. */
+  template <typename T, size_t SegmentSize = 256>
+  class TSpscQueue final {
+    NO_COPY_SEMANTICS(TSpscQueue);
+
+    static_assert(SegmentSize > 0);
+
+    public:
+    TSpscQueue()
+        : Head(new TSegment),
+          Tail(Head) {
+    }
+
+    ~TSpscQueue() {
+      while (Head) {
+        TSegment *next = Head->Next.load(std::memory_order_relaxed);
+        delete Head;
+        Head = next;
+      }
+    }
+
+    /* Producer only: Append 'item' to the queue.  Return true if the queue
+       was empty immediately before the call. */
+    bool Push(T &&item) {
+      if (TailPos == SegmentSize) {
+        TSegment *seg = new TSegment;
+        Tail->Next.store(seg, std::memory_order_release);
+        Tail = seg;
+        TailPos = 0;
+      }
+
+      Tail->Items[TailPos] = std::move(item);
+      ++TailPos;
+      Tail->Written.store(TailPos, std::memory_order_release);
+      return (Size.fetch_add(1, std::memory_order_acq_rel) == 0);
+    }
+
+    /* Consumer only: Remove items from the queue in FIFO order, passing each
+       to 'consume_fn' as an rvalue reference, until the queue is observed to
+       be empty.  Return the number of items consumed. */
+    template <typename TConsumeFn>
+    size_t Consume(TConsumeFn &&consume_fn) {
+      size_t total = 0;
+      size_t n = 0;
+
+      do {
+        n = 0;
+        T item;
+
+        while (TryPop(item)) {
+          consume_fn(std::move(item));
+          ++n;
+        }
+
+        total += n;
+      } while (n && (Size.fetch_sub(n, std::memory_order_acq_rel) != n));
+
+      return total;
+    }
+
+    /* Return an approximation of the number of items in the queue, which may
+       be out of date by the time the caller sees it. */
+    size_t ApproxSize() const noexcept {
+      return Size.load(std::memory_order_relaxed);
+    }
+
+    private:
+    struct TSegment {
+      std::array<T, SegmentSize> Items;
+
+      /* Number of items the producer has written to 'Items'. */
+      std::atomic<size_t> Written{0};
+
+      std::atomic<TSegment *> Next{nullptr};
+    };  // TSegment
+
+    /* Consumer only. */
+    bool TryPop(T &item) {
+      if (HeadPos == SegmentSize) {
+        TSegment *next = Head->Next.load(std::memory_order_acquire);
+
+        if (next == nullptr) {
+          return false;
+        }
+
+        delete Head;
+        Head = next;
+        HeadPos = 0;
+      }
+
+      if (HeadPos == Head->Written.load(std::memory_order_acquire)) {
+        return false;
+      }
+
+      T &slot = Head->Items[HeadPos];
+      item = std::move(slot);
+      slot = T();
+      ++HeadPos;
+      return true;
+    }
+
+    /* Segment the consumer is reading from, and the position of the next item
+       to read. */
+    TSegment *Head;
+
+    size_t HeadPos = 0;
+
+    /* Segment the producer is writing to, and the position of the next item
+       to write. */
+    TSegment *Tail;
+
+    size_t TailPos = 0;
+
+    /* Number of items in the queue.  Updated by both producer and consumer.
+     */
+    std::atomic<size_t> Size{0};
+  };  // TSpscQueue
+
+}  // Base
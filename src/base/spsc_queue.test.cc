@@ -0,0 +1,125 @@
+/* <base/spsc_queue.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit test for <base/spsc_queue.h>.
+ */
+
+#include <base/spsc_queue.h>
+
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <base/error_util.h>
+#include <base/event_semaphore.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+
+namespace {
+
+  /* The fixture for testing class TSpscQueue. */
+  class TSpscQueueTest : public ::testing::Test {
+    protected:
+    TSpscQueueTest() = default;
+
+    ~TSpscQueueTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TSpscQueueTest
+
+  TEST_F(TSpscQueueTest, BasicTest) {
+    TSpscQueue<std::unique_ptr<int>, 4> queue;
+    std::vector<int> result;
+    auto consume_fn = [&result](std::unique_ptr<int> &&item) {
+      ASSERT_TRUE(item != nullptr);
+      result.push_back(*item);
+    };
+    ASSERT_EQ(queue.Consume(consume_fn), 0U);
+    ASSERT_TRUE(queue.Push(std::make_unique<int>(0)));
+    ASSERT_FALSE(queue.Push(std::make_unique<int>(1)));
+    ASSERT_EQ(queue.ApproxSize(), 2U);
+    ASSERT_EQ(queue.Consume(consume_fn), 2U);
+    ASSERT_EQ(queue.ApproxSize(), 0U);
+
+    /* Span several segments. */
+    ASSERT_TRUE(queue.Push(std::make_unique<int>(2)));
+
+    for (int i = 3; i < 15; ++i) {
+      ASSERT_FALSE(queue.Push(std::make_unique<int>(i)));
+    }
+
+    ASSERT_EQ(queue.Consume(consume_fn), 13U);
+    ASSERT_EQ(result.size(), 15U);
+
+    for (size_t i = 0; i < result.size(); ++i) {
+      ASSERT_EQ(result[i], static_cast<int>(i));
+    }
+
+    /* Items left in the queue are destroyed with it. */
+    ASSERT_TRUE(queue.Push(std::make_unique<int>(15)));
+  }
+
+  TEST_F(TSpscQueueTest, ThreadTest) {
+    const size_t num_items = 200000;
+    TSpscQueue<size_t, 64> queue;
+    TEventSemaphore notify;
+    std::thread producer(
+        [&queue, &notify, num_items]() {
+          for (size_t i = 0; i < num_items; ++i) {
+            if (queue.Push(size_t(i))) {
+              notify.Push();
+            }
+          }
+        });
+
+    /* The consumer sleeps on the semaphore whenever it empties the queue, so
+       a missed notification would cause this to hang. */
+    size_t expected = 0;
+    bool ok = true;
+
+    while (expected < num_items) {
+      notify.Pop();
+      queue.Consume(
+          [&expected, &ok](size_t &&item) {
+            if (item != expected) {
+              ok = false;
+            }
+
+            ++expected;
+          });
+    }
+
+    producer.join();
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(expected, num_items);
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  DieOnTerminate();
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,33 @@
+/* <base/thread_shard.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <base/thread_shard.h>.
+ */
+
+#include <base/thread_shard.h>
+
+#include <atomic>
+
+namespace Base {
+
+  size_t NextThreadShardIndex() noexcept {
+    static std::atomic<size_t> next_index(0);
+    return next_index.fetch_add(1, std::memory_order_relaxed);
+  }
+
+}  // Base
@@ -0,0 +1,42 @@
+/* <base/thread_shard.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Assigns each thread a small integer for spreading per-thread state across
+   a fixed number of shards.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace Base {
+
+  /* Return the next unused thread shard index.  Called once per thread by
+     GetThreadShardIndex(). */
+  size_t NextThreadShardIndex() noexcept;
+
+  /* Return a small integer identifying the calling thread.  Indexes are
+     assigned in order of each thread's first call, starting at 0.  Callers
+     with a fixed number of shards take the result modulo their shard count,
+     so threads are spread evenly across shards. */
+  inline size_t GetThreadShardIndex() noexcept {
+    thread_local const size_t index = NextThreadShardIndex();
+    return index;
+  }
+
+}  // Base
@@ -76,4 +76,10 @@ namespace Base {
     return (static_cast<uint64_t>(t.tv_sec) * 1000) + (t.tv_nsec / 1000000);
   }
 
+  uint64_t GetMonotonicRawMicroseconds() noexcept {
+    struct timespec t;
+    Wr::clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+    return (static_cast<uint64_t>(t.tv_sec) * 1000000) + (t.tv_nsec / 1000);
+  }
+
 }  // Base
@@ -47,4 +47,7 @@ namespace Base {
      past.  Uses clock_gettime() with clock type of CLOCK_MONOTONIC_RAW. */
   uint64_t GetMonotonicRawMilliseconds() noexcept;
 
+  /* Same as above, but with microsecond resolution. */
+  uint64_t GetMonotonicRawMicroseconds() noexcept;
+
 }  // Base
@@ -59,9 +59,11 @@ void *TPool::Alloc() {
   auto *result = FirstFreeBlock;
 
   if (!result) {
+    CountAllocFailure();
     throw TMemoryCapReached();
   }
 
+  CountAlloc();
   return TBlock::Unlink(FirstFreeBlock);
 }
 
@@ -75,16 +77,18 @@ TPool::TBlock *TPool::AllocList(size_t block_count) {
       opt_lock.emplace(Mutex);
     }
 
-    for (; block_count; --block_count) {
+    for (size_t i = 0; i < block_count; ++i) {
       if (!FirstFreeBlock) {
         if (first_block) {
           DoFreeList(first_block);
         }
 
+        CountAllocFailure();
         throw TMemoryCapReached();
       }
 
       TBlock::Unlink(FirstFreeBlock)->Link(first_block);
+      CountAlloc();
     }
   }
 
@@ -117,11 +121,29 @@ void TPool::FreeList(TBlock *first_block) noexcept {
   DoFreeList(first_block);
 }
 
+void TPool::CountAlloc() noexcept {
+  const size_t allocated =
+      AllocatedBlockCount.load(std::memory_order_relaxed) + 1;
+  AllocatedBlockCount.store(allocated, std::memory_order_relaxed);
+
+  if (allocated > PeakAllocatedBlockCount.load(std::memory_order_relaxed)) {
+    PeakAllocatedBlockCount.store(allocated, std::memory_order_relaxed);
+  }
+
+  TotalAllocCount.store(
+      TotalAllocCount.load(std::memory_order_relaxed) + 1,
+      std::memory_order_relaxed);
+}
+
 void TPool::DoFree(void *ptr) noexcept {
   assert(ptr);
   assert(Storage <= ptr);
   assert(ptr < Storage + BlockSize * BlockCount);
   new (ptr) TBlock(FirstFreeBlock);
+  assert(AllocatedBlockCount.load(std::memory_order_relaxed) > 0);
+  AllocatedBlockCount.store(
+      AllocatedBlockCount.load(std::memory_order_relaxed) - 1,
+      std::memory_order_relaxed);
 }
 
 void TPool::DoFreeList(TBlock *first_block) noexcept {
@@ -21,7 +21,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <mutex>
 
 #include <base/no_copy_semantics.h>
@@ -120,7 +122,43 @@ namespace Capped {
       return BlockSize;
     }
 
+    /* The number of blocks currently allocated.  This may be called without
+       synchronization, in which case the result may be slightly stale. */
+    size_t GetAllocatedBlockCount() const noexcept {
+      return AllocatedBlockCount.load(std::memory_order_relaxed);
+    }
+
+    /* The largest number of blocks that have been allocated at once.  May be
+       slightly stale, as above. */
+    size_t GetPeakAllocatedBlockCount() const noexcept {
+      return PeakAllocatedBlockCount.load(std::memory_order_relaxed);
+    }
+
+    /* The total number of blocks that have ever been allocated.  May be
+       slightly stale, as above. */
+    uint64_t GetTotalAllocCount() const noexcept {
+      return TotalAllocCount.load(std::memory_order_relaxed);
+    }
+
+    /* The number of calls to Alloc() and AllocList() that threw
+       TMemoryCapReached.  May be slightly stale, as above. */
+    uint64_t GetAllocFailureCount() const noexcept {
+      return AllocFailureCount.load(std::memory_order_relaxed);
+    }
+
     private:
+    /* Update stats for the allocation of a block.  Called while holding
+       'Mutex' (if the pool is guarded). */
+    void CountAlloc() noexcept;
+
+    /* Update stats for a failed allocation.  Called while holding 'Mutex' (if
+       the pool is guarded). */
+    void CountAllocFailure() noexcept {
+      AllocFailureCount.store(
+          AllocFailureCount.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+    }
+
     /* Similar to Free() but mutex is not acquired.  Assumes that 'ptr' is not
        null. */
     void DoFree(void *ptr) noexcept;
@@ -150,6 +188,20 @@ namespace Capped {
 
     /* Our storage space.  Never null. */
     char *Storage;
+
+    /* See GetAllocatedBlockCount().  Only modified while holding 'Mutex' (if
+       the pool is guarded), so relaxed ordering suffices. */
+    std::atomic<size_t> AllocatedBlockCount{0};
+
+    /* See GetPeakAllocatedBlockCount().  Modified like 'AllocatedBlockCount'.
+     */
+    std::atomic<size_t> PeakAllocatedBlockCount{0};
+
+    /* See GetTotalAllocCount().  Modified like 'AllocatedBlockCount'. */
+    std::atomic<uint64_t> TotalAllocCount{0};
+
+    /* See GetAllocFailureCount().  Modified like 'AllocatedBlockCount'. */
+    std::atomic<uint64_t> AllocFailureCount{0};
   };  // TPool
 
 }  // Capped
@@ -95,13 +95,33 @@ namespace {
         a(new TPoint),
         b(new TPoint),
         c(new TPoint);
+    ASSERT_EQ(TPoint::Pool.GetAllocatedBlockCount(), 3U);
     ASSERT_FALSE(TryNewPoint());
     a.reset();
+    ASSERT_EQ(TPoint::Pool.GetAllocatedBlockCount(), 2U);
     ASSERT_TRUE(TryNewPoint());
     a.reset(new TPoint);
     ASSERT_FALSE(TryNewPoint());
   }
 
+  TEST_F(TPoolTest, Stats) {
+    TPool pool(64, 4, TPool::TSync::Mutexed);
+    void *a = pool.Alloc();
+    TPool::TBlock *list = pool.AllocList(3);
+    ASSERT_EQ(pool.GetAllocatedBlockCount(), 4U);
+    ASSERT_THROW(pool.AllocList(1), TMemoryCapReached);
+    pool.FreeList(list);
+    ASSERT_THROW(pool.AllocList(4), TMemoryCapReached);
+    ASSERT_EQ(pool.GetAllocatedBlockCount(), 1U);
+    pool.Free(a);
+    ASSERT_EQ(pool.GetAllocatedBlockCount(), 0U);
+    ASSERT_EQ(pool.GetPeakAllocatedBlockCount(), 4U);
+    ASSERT_EQ(pool.GetAllocFailureCount(), 2U);
+
+    /* The failed AllocList(4) allocated and freed 3 blocks. */
+    ASSERT_EQ(pool.GetTotalAllocCount(), 7U);
+  }
+
 }  // namespace
 
 int main(int argc, char **argv) {
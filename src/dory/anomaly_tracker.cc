@@ -67,6 +67,8 @@ static void UpdateLruList(std::string &&s, std::list<std::string> &lru_list,
   assert(lru_list.size() <= max_list_size);
 }
 
+std::atomic<uint64_t> TAnomalyTracker::NextId{1};
+
 size_t TAnomalyTracker::GetNoDiscardQueryCount() {
   TCounter::Sample();
   return NoDiscardQuery.GetCount();
@@ -75,36 +77,29 @@ size_t TAnomalyTracker::GetNoDiscardQueryCount() {
 void TAnomalyTracker::TrackDiscard(TMsg &msg, TDiscardReason reason) {
   uint64_t now = ClockFn();
   DiscardFileLogger.LogDiscard(msg, reason);
-  const std::string &msg_topic = msg.GetTopic();
-  std::string topic(msg_topic);
+  CheckReportPeriod(now);
+  TThreadBuffer &buf = GetThreadBuffer();
 
-  std::lock_guard<std::mutex> lock(Mutex);
-  AdvanceReportPeriod(now);
-  UpdateTopicMap(FillingReport->DiscardTopicMap, std::move(topic),
-                 msg.GetTimestamp());
+  std::lock_guard<std::mutex> lock(buf.BufferMutex);
+  TTopicDelta &delta = buf.Discards[msg.GetTopic()];
+  delta.Add(msg.GetTimestamp());
 
   if (reason == TDiscardReason::RateLimit) {
-    TRateLimitMap &rmap = FillingReport->RateLimitDiscardMap;
-    auto iter = rmap.find(msg_topic);
-
-    if (iter == rmap.end()) {
-      /* First rate limit discard for topic in current reporting period. */
-      rmap[msg_topic] = 1;
-    } else {
-      ++iter->second;
-    }
+    ++delta.RateLimitCount;
   }
+
+  buf.Dirty = true;
 }
 
 void TAnomalyTracker::TrackDuplicate(const TMsg &msg) {
   uint64_t now = ClockFn();
   DiscardFileLogger.LogDuplicate(msg);
-  std::string topic(msg.GetTopic());
+  CheckReportPeriod(now);
+  TThreadBuffer &buf = GetThreadBuffer();
 
-  std::lock_guard<std::mutex> lock(Mutex);
-  AdvanceReportPeriod(now);
-  UpdateTopicMap(FillingReport->DuplicateTopicMap, std::move(topic),
-                 msg.GetTimestamp());
+  std::lock_guard<std::mutex> lock(buf.BufferMutex);
+  buf.Duplicates[msg.GetTopic()].Add(msg.GetTimestamp());
+  buf.Dirty = true;
 }
 
 void TAnomalyTracker::TrackNoMemDiscard(TMsg::TTimestamp timestamp,
@@ -258,6 +253,7 @@ TAnomalyTracker::GetInfo(TInfo &filling_report_copy) const {
 
   std::lock_guard<std::mutex> lock(Mutex);
   AdvanceReportPeriod(now);
+  MergeThreadBuffers();
   filling_report_copy = *FillingReport;
   return LastFullReport;
 }
@@ -286,6 +282,94 @@ const uint8_t *TAnomalyTracker::EnforceMaxPrefixLen(const void *msg_begin,
   return begin + std::min(msg_size, MaxMsgPrefixLen);
 }
 
+void TAnomalyTracker::TThreadBufferHolder::Reset() noexcept {
+  if (Buffer) {
+    Buffer->Retired.store(true, std::memory_order_release);
+    Buffer.reset();
+  }
+
+  TrackerId = 0;
+}
+
+TAnomalyTracker::TThreadBuffer &TAnomalyTracker::GetThreadBuffer() {
+  static thread_local TThreadBufferHolder holder;
+
+  if (holder.TrackerId != Id) {
+    /* First use of this tracker by the calling thread, or the thread last used
+       a different tracker (only in tests). */
+    holder.Reset();
+    auto buf = std::make_shared<TThreadBuffer>();
+
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      ThreadBuffers.push_back(buf);
+    }
+
+    holder.Buffer = std::move(buf);
+    holder.TrackerId = Id;
+  }
+
+  return *holder.Buffer;
+}
+
+void TAnomalyTracker::CheckReportPeriod(uint64_t now) const {
+  if ((ReportInterval != 0) &&
+      (now >= FillingReportEnd.load(std::memory_order_relaxed))) {
+    std::lock_guard<std::mutex> lock(Mutex);
+    AdvanceReportPeriod(now);
+  }
+}
+
+void TAnomalyTracker::MergeThreadBuffers() const {
+  assert(FillingReport);
+
+  for (auto iter = ThreadBuffers.begin(); iter != ThreadBuffers.end(); ) {
+    TThreadBuffer &buf = **iter;
+
+    {
+      std::lock_guard<std::mutex> lock(buf.BufferMutex);
+
+      if (buf.Dirty) {
+        for (auto &item : buf.Discards) {
+          TTopicDelta &delta = item.second;
+
+          if (delta.Count) {
+            MergeTopicDelta(FillingReport->DiscardTopicMap, item.first,
+                delta);
+
+            if (delta.RateLimitCount) {
+              FillingReport->RateLimitDiscardMap[item.first] +=
+                  delta.RateLimitCount;
+            }
+
+            delta = TTopicDelta();
+          }
+        }
+
+        for (auto &item : buf.Duplicates) {
+          TTopicDelta &delta = item.second;
+
+          if (delta.Count) {
+            MergeTopicDelta(FillingReport->DuplicateTopicMap, item.first,
+                delta);
+            delta = TTopicDelta();
+          }
+        }
+
+        buf.Dirty = false;
+      }
+    }
+
+    if (buf.Retired.load(std::memory_order_acquire)) {
+      /* The owning thread is gone, and anything it tracked was merged
+         above. */
+      iter = ThreadBuffers.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+}
+
 void TAnomalyTracker::AdvanceReportPeriod(uint64_t now) const {
   assert(FillingReport);
   assert((FillingReport->GetReportId() == 0) || LastFullReport);
@@ -304,6 +388,11 @@ void TAnomalyTracker::AdvanceReportPeriod(uint64_t now) const {
   /* Compute how many increments we must advance the current report ID by. */
   size_t period_offset = now_offset / ReportInterval;
 
+  if (period_offset) {
+    /* Anything buffered belongs to the period that is ending. */
+    MergeThreadBuffers();
+  }
+
   switch (period_offset) {
     case 0: {
       /* Still in same reporting period: nothing to do. */
@@ -335,6 +424,8 @@ void TAnomalyTracker::AdvanceReportPeriod(uint64_t now) const {
     }
   }
 
+  FillingReportEnd.store(FillingReport->GetStartTime() + ReportInterval,
+      std::memory_order_relaxed);
   assert(FillingReport);
   assert((FillingReport->GetReportId() == 0) || LastFullReport);
 }
@@ -361,3 +452,28 @@ void TAnomalyTracker::UpdateTopicMap(TMap &topic_map, std::string &&topic,
     interval.Last = timestamp;
   }
 }
+
+void TAnomalyTracker::MergeTopicDelta(TMap &topic_map,
+    const std::string &topic, const TTopicDelta &delta) {
+  assert(delta.Count);
+  auto iter = topic_map.find(topic);
+
+  if (iter == topic_map.end()) {
+    /* First entry for that topic in current reporting period. */
+    iter = topic_map.insert(std::make_pair(topic, TTopicInfo(delta.First)))
+        .first;
+    iter->second.Count = 0;
+  }
+
+  TTopicInfo &info = iter->second;
+  TInterval &interval = info.Interval;
+  info.Count += delta.Count;
+
+  if (delta.First < interval.First) {
+    interval.First = delta.First;
+  }
+
+  if (interval.Last < delta.Last) {
+    interval.Last = delta.Last;
+  }
+}
@@ -33,6 +33,8 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <base/no_copy_semantics.h>
 #include <base/time_util.h>
@@ -42,7 +44,14 @@
 namespace Dory {
 
   /* Class used by dory daemon to track message discard and possible duplicate
-     events. */
+     events.
+
+     When Kafka is unavailable, connector threads may discard messages at a
+     very high rate.  Therefore discards and possible duplicates of messages
+     with valid topics are first counted in a buffer owned by the calling
+     thread, which avoids both the global lock and copying the topic.  The
+     buffers are merged into the filling report when a report is requested
+     and before the reporting period advances. */
   class TAnomalyTracker final {
     NO_COPY_SEMANTICS(TAnomalyTracker);
 
@@ -216,8 +225,10 @@ namespace Dory {
           ReportInterval(report_interval),
           ClockFn(clock_fn),
           MaxMsgPrefixLen(max_msg_prefix_len),
+          Id(NextId.fetch_add(1, std::memory_order_relaxed)),
           LastGetInfoTime(clock_fn()),
-          FillingReport(new TInfo(0, LastGetInfoTime.load())) {
+          FillingReport(new TInfo(0, LastGetInfoTime.load())),
+          FillingReportEnd(LastGetInfoTime.load() + report_interval) {
     }
 
     /* Parameter 'msg' is a message that is about to be discarded.  Update the
@@ -316,6 +327,85 @@ namespace Dory {
     }
 
     private:
+    /* Per-topic counts of discards or possible duplicates, accumulated by one
+       thread since its buffer was last merged. */
+    struct TTopicDelta {
+      size_t Count = 0;
+
+      /* Count of discards due to rate limiting, which are also included in
+         'Count'. */
+      size_t RateLimitCount = 0;
+
+      /* Meaningful only when 'Count' is nonzero. */
+      TMsg::TTimestamp First = 0;
+
+      TMsg::TTimestamp Last = 0;
+
+      void Add(TMsg::TTimestamp timestamp) noexcept {
+        if (Count == 0) {
+          First = timestamp;
+          Last = timestamp;
+        } else if (timestamp < First) {
+          First = timestamp;
+        } else if (Last < timestamp) {
+          Last = timestamp;
+        }
+
+        ++Count;
+      }
+    };  // TTopicDelta
+
+    /* Keys are topics.  Entries are zeroed rather than erased when merged, so
+       a thread copies a given topic only the first time it sees it. */
+    using TDeltaMap = std::unordered_map<std::string, TTopicDelta>;
+
+    /* Discard and duplicate info accumulated by one thread. */
+    struct TThreadBuffer {
+      /* Acquired by the owning thread for each update, and by the merging
+         thread while holding 'Mutex'.  Therefore nearly always
+         uncontended. */
+      std::mutex BufferMutex;
+
+      TDeltaMap Discards;
+
+      TDeltaMap Duplicates;
+
+      /* True if any entries have nonzero counts. */
+      bool Dirty = false;
+
+      /* Set when the owning thread exits, so the buffer can be freed once
+         merged. */
+      std::atomic<bool> Retired{false};
+    };  // TThreadBuffer
+
+    /* Thread local pointer to the calling thread's buffer for the tracker it
+       most recently used.  Marks the buffer retired on thread exit. */
+    struct TThreadBufferHolder {
+      uint64_t TrackerId = 0;
+
+      std::shared_ptr<TThreadBuffer> Buffer;
+
+      void Reset() noexcept;
+
+      ~TThreadBufferHolder() {
+        Reset();
+      }
+    };  // TThreadBufferHolder
+
+    static std::atomic<uint64_t> NextId;
+
+    /* Return the calling thread's buffer, registering it if necessary. */
+    TThreadBuffer &GetThreadBuffer();
+
+    /* If 'now' is past the end of the current reporting period, advance it
+       before buffering anything for the new period.  Acquires 'Mutex' only in
+       that case, which happens once per reporting period. */
+    void CheckReportPeriod(uint64_t now) const;
+
+    /* Caller must hold 'Mutex'.  Merge the contents of all thread buffers into
+       'FillingReport', and free the buffers of exited threads. */
+    void MergeThreadBuffers() const;
+
     const uint8_t *EnforceMaxPrefixLen(const void *msg_begin,
         const void *msg_end);
 
@@ -324,8 +414,13 @@ namespace Dory {
     void AdvanceReportPeriod(uint64_t now) const;
 
     /* Caller must hold 'Mutex'. */
-    void UpdateTopicMap(TMap &topic_map, std::string &&topic,
-                        TMsg::TTimestamp timestamp);
+    static void UpdateTopicMap(TMap &topic_map, std::string &&topic,
+                               TMsg::TTimestamp timestamp);
+
+    /* Caller must hold 'Mutex'.  Same as above, but merges a thread's counts
+       for 'topic'. */
+    static void MergeTopicDelta(TMap &topic_map, const std::string &topic,
+                                const TTopicDelta &delta);
 
     TDiscardFileLogger &DiscardFileLogger;
 
@@ -336,15 +431,26 @@ namespace Dory {
 
     const size_t MaxMsgPrefixLen;
 
+    /* Distinguishes this tracker from others in the thread local state.  Never
+       reused, unlike our address. */
+    const uint64_t Id;
+
     /* Value is in seconds since the epoch. */
     mutable std::atomic<uint64_t> LastGetInfoTime;
 
-    /* Protects 'LastFullReport' and 'FillingReport'. */
+    /* Protects 'LastFullReport', 'FillingReport', and 'ThreadBuffers'. */
     mutable std::mutex Mutex;
 
     mutable std::shared_ptr<const TInfo> LastFullReport;
 
     mutable std::unique_ptr<TInfo> FillingReport;
+
+    /* End time of reporting period of 'FillingReport' in seconds since the
+       epoch.  Updated while holding 'Mutex', but read without it. */
+    mutable std::atomic<uint64_t> FillingReportEnd;
+
+    /* Buffers of all threads that have tracked a discard or duplicate. */
+    mutable std::vector<std::shared_ptr<TThreadBuffer>> ThreadBuffers;
   };  // TAnomalyTracker
 
 }  // Dory
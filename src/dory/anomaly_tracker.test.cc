@@ -26,6 +26,8 @@
 #include <cstring>
 #include <limits>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <base/tmp_file.h>
 #include <capped/pool.h>
@@ -451,6 +453,75 @@ namespace {
     ASSERT_EQ(filling_report.GetReportId(), 16U);
   }
 
+  TEST_F(TAnomalyTrackerTest, ManyThreadsDiscardTest) {
+    const size_t thread_count = 4;
+    const size_t msgs_per_thread = 1000;
+    TAnomalyTrackerConfig cfg(100);
+    cfg.Clock = 10;
+    std::vector<std::vector<TMsg::TPtr>> msgs(thread_count);
+
+    for (size_t i = 0; i < thread_count; ++i) {
+      for (size_t j = 0; j < msgs_per_thread; ++j) {
+        msgs[i].push_back(cfg.NewMsg((j % 2) ? "topic1" : "topic2", "value"));
+      }
+    }
+
+    auto run_threads = [&cfg, &msgs] {
+      std::vector<std::thread> threads;
+
+      for (auto &msg_vec : msgs) {
+        threads.emplace_back(
+            [&cfg, &msg_vec] {
+              for (size_t j = 0; j < msg_vec.size(); ++j) {
+                if (j % 4) {
+                  cfg.AnomalyTracker.TrackDiscard(msg_vec[j],
+                      TAnomalyTracker::TDiscardReason::KafkaErrorAck);
+                } else {
+                  cfg.AnomalyTracker.TrackDiscard(msg_vec[j],
+                      TAnomalyTracker::TDiscardReason::RateLimit);
+                }
+
+                cfg.AnomalyTracker.TrackDuplicate(msg_vec[j]);
+              }
+            });
+      }
+
+      for (auto &t : threads) {
+        t.join();
+      }
+    };
+
+    run_threads();
+    TAnomalyTracker::TInfo filling_report;
+    std::shared_ptr<const TAnomalyTracker::TInfo> last_full_report =
+        cfg.AnomalyTracker.GetInfo(filling_report);
+    ASSERT_FALSE(!!last_full_report);
+    ASSERT_EQ(filling_report.DiscardTopicMap.size(), 2U);
+    size_t total = thread_count * msgs_per_thread;
+    ASSERT_EQ(filling_report.DiscardTopicMap.at("topic1").Count, total / 2);
+    ASSERT_EQ(filling_report.DiscardTopicMap.at("topic2").Count, total / 2);
+    ASSERT_EQ(filling_report.DuplicateTopicMap.at("topic1").Count, total / 2);
+    ASSERT_EQ(filling_report.DuplicateTopicMap.at("topic2").Count, total / 2);
+    ASSERT_EQ(filling_report.DiscardTopicMap.at("topic1").Interval.First, 10U);
+    ASSERT_EQ(filling_report.DiscardTopicMap.at("topic1").Interval.Last, 10U);
+    ASSERT_EQ(filling_report.RateLimitDiscardMap.at("topic2"), total / 4);
+    ASSERT_EQ(filling_report.RateLimitDiscardMap.count("topic1"), 0U);
+
+    /* Discards buffered before the period ends are reported in that period,
+       and those after in the next. */
+    run_threads();
+    cfg.Clock = 100;
+    run_threads();
+    last_full_report = cfg.AnomalyTracker.GetInfo(filling_report);
+    ASSERT_TRUE(!!last_full_report);
+    ASSERT_EQ(last_full_report->DiscardTopicMap.at("topic1").Count, total);
+    ASSERT_EQ(last_full_report->DuplicateTopicMap.at("topic2").Count, total);
+    ASSERT_EQ(filling_report.GetReportId(), 1U);
+    ASSERT_EQ(filling_report.DiscardTopicMap.at("topic1").Count, total / 2);
+    ASSERT_EQ(filling_report.DuplicateTopicMap.at("topic2").Count,
+        total / 2);
+  }
+
   TEST_F(TAnomalyTrackerTest, GetInfoTest2) {
     TAnomalyTrackerConfig cfg(100);
     ASSERT_EQ(cfg.AnomalyTracker.GetReportInterval(), 100U);
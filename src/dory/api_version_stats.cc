@@ -0,0 +1,76 @@
+/* <dory/api_version_stats.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/api_version_stats.h>.
+ */
+
+#include <dory/api_version_stats.h>
+
+#include <base/time_util.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::KafkaProto::ApiVersions;
+
+void TApiVersionStats::RecordProduceApiVersion(const std::string &host,
+    in_port_t port, long broker_id,
+    const std::vector<TApiVersionRange> &broker_versions,
+    size_t produce_api_version) {
+  uint64_t now = GetEpochMilliseconds();
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  TBrokerInfo &info = GetEntry(host, port);
+  info.BrokerId = broker_id;
+  info.BrokerVersions = broker_versions;
+  info.ProduceApiVersion = produce_api_version;
+  info.UpdateTime = now;
+}
+
+void TApiVersionStats::RecordMetadataApiVersion(const std::string &host,
+    in_port_t port, const std::vector<TApiVersionRange> &broker_versions,
+    size_t metadata_api_version) {
+  uint64_t now = GetEpochMilliseconds();
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  TBrokerInfo &info = GetEntry(host, port);
+  info.BrokerVersions = broker_versions;
+  info.MetadataApiVersion = metadata_api_version;
+  info.UpdateTime = now;
+}
+
+std::vector<TApiVersionStats::TBrokerInfo>
+TApiVersionStats::GetBrokerInfo() const {
+  std::vector<TBrokerInfo> result;
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  result.reserve(BrokerInfoMap.size());
+
+  for (const auto &item : BrokerInfoMap) {
+    result.push_back(item.second);
+  }
+
+  return result;
+}
+
+TApiVersionStats::TBrokerInfo &
+TApiVersionStats::GetEntry(const std::string &host, in_port_t port) {
+  TBrokerInfo &info = BrokerInfoMap[std::make_pair(host, port)];
+  info.Host = host;
+  info.Port = port;
+  return info;
+}
@@ -0,0 +1,100 @@
+/* <dory/api_version_stats.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Per-broker record of Kafka API versions chosen by dory, for reporting via
+   the web interface.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <netinet/in.h>
+
+#include <base/no_copy_semantics.h>
+#include <dory/kafka_proto/api_versions/api_versions.h>
+
+namespace Dory {
+
+  /* Keeps track of which produce and metadata API versions dory uses when
+     talking to each broker.  Connector threads and the router thread record
+     info here, and Mongoose reports it, so thread synchronization is
+     necessary. */
+  class TApiVersionStats final {
+    NO_COPY_SEMANTICS(TApiVersionStats);
+
+    public:
+    struct TBrokerInfo {
+      std::string Host;
+
+      in_port_t Port = 0;
+
+      /* Unknown for a broker that dory has only contacted to get metadata. */
+      std::optional<long> BrokerId;
+
+      /* API list from the broker's ApiVersions response.  Empty if API
+         version negotiation is disabled. */
+      std::vector<KafkaProto::ApiVersions::TApiVersionRange> BrokerVersions;
+
+      /* Produce API version that the broker's connector thread uses. */
+      std::optional<size_t> ProduceApiVersion;
+
+      /* Metadata API version used when getting metadata from the broker. */
+      std::optional<size_t> MetadataApiVersion;
+
+      /* Milliseconds since the epoch of most recent update. */
+      uint64_t UpdateTime = 0;
+    };  // TBrokerInfo
+
+    TApiVersionStats() = default;
+
+    /* Called by a connector thread once it has chosen a produce API version.
+       'broker_versions' is empty if API version negotiation is disabled. */
+    void RecordProduceApiVersion(const std::string &host, in_port_t port,
+        long broker_id,
+        const std::vector<KafkaProto::ApiVersions::TApiVersionRange>
+            &broker_versions,
+        size_t produce_api_version);
+
+    /* Called by router thread once it has chosen a metadata API version for
+       a broker it is getting metadata from. */
+    void RecordMetadataApiVersion(const std::string &host, in_port_t port,
+        const std::vector<KafkaProto::ApiVersions::TApiVersionRange>
+            &broker_versions,
+        size_t metadata_api_version);
+
+    /* Called by Mongoose thread.  Results are sorted by host and port. */
+    std::vector<TBrokerInfo> GetBrokerInfo() const;
+
+    private:
+    TBrokerInfo &GetEntry(const std::string &host, in_port_t port);
+
+    /* Protects 'BrokerInfoMap' from concurrent access. */
+    mutable std::mutex Mutex;
+
+    std::map<std::pair<std::string, in_port_t>, TBrokerInfo> BrokerInfoMap;
+  };  // TApiVersionStats
+
+}  // Dory
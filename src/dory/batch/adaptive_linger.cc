@@ -0,0 +1,81 @@
+/* <dory/batch/adaptive_linger.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/batch/adaptive_linger.h>.
+ */
+
+#include <dory/batch/adaptive_linger.h>
+
+#include <algorithm>
+#include <cassert>
+
+using namespace Dory;
+using namespace Dory::Batch;
+
+TAdaptiveLinger::TAdaptiveLinger(size_t min_time_limit, size_t max_time_limit,
+    size_t target_bytes) noexcept
+    : MinTimeLimit(min_time_limit),
+      MaxTimeLimit(max_time_limit),
+      TargetBytes(target_bytes),
+
+      /* Until we know the arrival rate, batch as the configuration would
+         without adaptation. */
+      TimeLimit(max_time_limit) {
+  assert(MinTimeLimit <= MaxTimeLimit);
+  assert(TargetBytes > 0);
+}
+
+bool TAdaptiveLinger::RecordArrival(TMsg::TTimestamp now,
+    size_t bytes) noexcept {
+  if (WindowStart < 0) {
+    WindowStart = now;
+  }
+
+  WindowBytes += bytes;
+  const TMsg::TTimestamp elapsed = now - WindowStart;
+
+  if (elapsed < WINDOW_MS) {
+    return false;
+  }
+
+  const double sample = static_cast<double>(WindowBytes) /
+      static_cast<double>(elapsed);
+  BytesPerMs = (BytesPerMs < 0.0) ? sample :
+      (RATE_WEIGHT * sample) + ((1.0 - RATE_WEIGHT) * BytesPerMs);
+
+  /* The message that completes a window starts the next one.  Its bytes were
+     counted in the completed window, since they arrived at its end. */
+  WindowStart = now;
+  WindowBytes = 0;
+  UpdateTimeLimit();
+  return true;
+}
+
+void TAdaptiveLinger::UpdateTimeLimit() noexcept {
+  assert(BytesPerMs >= 0.0);
+  const auto max_limit = static_cast<double>(MaxTimeLimit);
+  double limit = max_limit;
+
+  if (BytesPerMs > 0.0) {
+    limit = std::min(max_limit, static_cast<double>(TargetBytes) / BytesPerMs);
+  }
+
+  limit = std::max(limit, static_cast<double>(std::min(AckLatency,
+      MaxTimeLimit)));
+  TimeLimit = std::max(MinTimeLimit, static_cast<size_t>(limit));
+}
@@ -0,0 +1,120 @@
+/* <dory/batch/adaptive_linger.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Adaptive batching time limit (linger time) for a single batcher.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <dory/msg.h>
+
+namespace Dory {
+
+  namespace Batch {
+
+    /* Chooses a batching time limit within configured bounds, so that batches
+       reach a target byte size.  The arrival rate of message data is measured
+       over windows of at least WINDOW_MS milliseconds, and smoothed with an
+       exponentially weighted moving average.  The time limit is then the time
+       needed to accumulate the target byte count at that rate.  If the broker
+       takes longer than that to ACK a produce request, there is little point
+       in completing batches more often, so the time limit is raised to the
+       ACK latency (still subject to the upper bound). */
+    class TAdaptiveLinger final {
+      public:
+      /* Minimum duration in milliseconds of a rate measurement window. */
+      static const TMsg::TTimestamp WINDOW_MS = 100;
+
+      /* Weight given to each new rate measurement. */
+      static constexpr double RATE_WEIGHT = 0.25;
+
+      TAdaptiveLinger(size_t min_time_limit, size_t max_time_limit,
+          size_t target_bytes) noexcept;
+
+      TAdaptiveLinger(const TAdaptiveLinger &) noexcept = default;
+
+      TAdaptiveLinger &operator=(const TAdaptiveLinger &) noexcept = default;
+
+      /* Record the arrival of a message with 'bytes' bytes of data at time
+         'now'.  Return true if this completed a measurement window, in which
+         case the time limit may have changed. */
+      bool RecordArrival(TMsg::TTimestamp now, size_t bytes) noexcept;
+
+      /* Set the most recently observed broker ACK latency in milliseconds.
+         This takes effect when the next measurement window completes, so the
+         time limit only changes during a call to RecordArrival(). */
+      void SetAckLatency(size_t ack_latency) noexcept {
+        AckLatency = ack_latency;
+      }
+
+      size_t GetAckLatency() const noexcept {
+        return AckLatency;
+      }
+
+      /* Return the time limit currently in effect, in milliseconds. */
+      size_t GetTimeLimit() const noexcept {
+        return TimeLimit;
+      }
+
+      size_t GetMinTimeLimit() const noexcept {
+        return MinTimeLimit;
+      }
+
+      size_t GetMaxTimeLimit() const noexcept {
+        return MaxTimeLimit;
+      }
+
+      size_t GetTargetBytes() const noexcept {
+        return TargetBytes;
+      }
+
+      /* Return the smoothed arrival rate in bytes per second. */
+      double GetByteRate() const noexcept {
+        return BytesPerMs * 1000.0;
+      }
+
+      private:
+      void UpdateTimeLimit() noexcept;
+
+      size_t MinTimeLimit;
+
+      size_t MaxTimeLimit;
+
+      size_t TargetBytes;
+
+      /* Time limit currently in effect. */
+      size_t TimeLimit;
+
+      size_t AckLatency = 0;
+
+      /* Smoothed arrival rate.  Negative until the first window completes. */
+      double BytesPerMs = -1.0;
+
+      /* Start time of current measurement window, and bytes that have
+         arrived during it.  A negative start time indicates that no message
+         has arrived yet. */
+      TMsg::TTimestamp WindowStart = -1;
+
+      size_t WindowBytes = 0;
+    };  // TAdaptiveLinger
+
+  }  // Batch
+
+}  // Dory
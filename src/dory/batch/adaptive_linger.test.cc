@@ -0,0 +1,128 @@
+/* <dory/batch/adaptive_linger.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit test for <dory/batch/adaptive_linger.h>.
+ */
+
+#include <dory/batch/adaptive_linger.h>
+
+#include <base/tmp_file.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Batch;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TAdaptiveLinger. */
+  class TAdaptiveLingerTest : public ::testing::Test {
+    protected:
+    TAdaptiveLingerTest() = default;
+
+    ~TAdaptiveLingerTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TAdaptiveLingerTest
+
+  TEST_F(TAdaptiveLingerTest, ArrivalRate) {
+    TAdaptiveLinger linger(5, 500, 10000);
+    ASSERT_EQ(linger.GetTimeLimit(), 500U);
+    ASSERT_LT(linger.GetByteRate(), 0.0);
+
+    /* No change until a full window has elapsed. */
+    ASSERT_FALSE(linger.RecordArrival(1000, 0));
+    ASSERT_FALSE(linger.RecordArrival(1000 + TAdaptiveLinger::WINDOW_MS - 1,
+        5000));
+    ASSERT_EQ(linger.GetTimeLimit(), 500U);
+
+    /* 10000 bytes in 100 ms: 100 bytes/ms, so reaching the target takes 100
+       ms. */
+    ASSERT_TRUE(linger.RecordArrival(1100, 5000));
+    ASSERT_EQ(linger.GetTimeLimit(), 100U);
+    ASSERT_DOUBLE_EQ(linger.GetByteRate(), 100000.0);
+
+    /* A sample of 400 bytes/ms moves the average to 175 bytes/ms. */
+    ASSERT_TRUE(linger.RecordArrival(1200, 40000));
+    ASSERT_EQ(linger.GetTimeLimit(), 57U);
+
+    /* Very high rate: clamped to lower bound. */
+    for (TMsg::TTimestamp t = 1300; t < 3000; t += 100) {
+      linger.RecordArrival(t, 100000000);
+    }
+
+    ASSERT_EQ(linger.GetTimeLimit(), 5U);
+
+    /* No arrivals for a long time, then a tiny message: rate drops and the
+       limit moves back up, but never past the upper bound. */
+    for (TMsg::TTimestamp t = 100000; t < 200000; t += 1000) {
+      linger.RecordArrival(t, 1);
+    }
+
+    ASSERT_EQ(linger.GetTimeLimit(), 500U);
+  }
+
+  TEST_F(TAdaptiveLingerTest, AckLatency) {
+    TAdaptiveLinger linger(5, 500, 10000);
+    linger.RecordArrival(0, 0);
+    ASSERT_TRUE(linger.RecordArrival(100, 100000));
+    ASSERT_EQ(linger.GetTimeLimit(), 10U);
+
+    /* ACK latency takes effect when the next window completes. */
+    linger.SetAckLatency(80);
+    ASSERT_EQ(linger.GetAckLatency(), 80U);
+    ASSERT_EQ(linger.GetTimeLimit(), 10U);
+    ASSERT_TRUE(linger.RecordArrival(200, 100000));
+    ASSERT_EQ(linger.GetTimeLimit(), 80U);
+
+    /* ACK latency above the upper bound is clamped. */
+    linger.SetAckLatency(1000);
+    ASSERT_TRUE(linger.RecordArrival(300, 100000));
+    ASSERT_EQ(linger.GetTimeLimit(), 500U);
+
+    /* Once the broker speeds up, the arrival rate governs again. */
+    linger.SetAckLatency(0);
+    ASSERT_TRUE(linger.RecordArrival(400, 100000));
+    ASSERT_EQ(linger.GetTimeLimit(), 10U);
+  }
+
+  TEST_F(TAdaptiveLingerTest, FixedBounds) {
+    /* With equal bounds, the limit never moves. */
+    TAdaptiveLinger linger(50, 50, 1);
+    linger.SetAckLatency(200);
+
+    for (TMsg::TTimestamp t = 0; t < 2000; t += 100) {
+      linger.RecordArrival(t, static_cast<size_t>(t));
+      ASSERT_EQ(linger.GetTimeLimit(), 50U);
+    }
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
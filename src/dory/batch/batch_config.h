@@ -50,6 +50,13 @@ namespace Dory {
       size_t MsgCount = 0;
 
       size_t ByteCount = 0;
+
+      /* If nonzero, the time limit adapts to the message arrival rate so that
+         batches reach this many bytes.  'TimeLimit' is then the upper bound on
+         the adapted time limit, and 'MinTimeLimit' the lower bound. */
+      size_t LingerTargetBytes = 0;
+
+      size_t MinTimeLimit = 0;  // milliseconds
     };  // TBatchConfig
 
     inline bool BatchingIsEnabled(const TBatchConfig &config) noexcept {
@@ -60,6 +67,10 @@ namespace Dory {
       return (config.TimeLimit != 0);
     }
 
+    inline bool AdaptiveLingerIsEnabled(const TBatchConfig &config) noexcept {
+      return TimeLimitIsEnabled(config) && (config.LingerTargetBytes != 0);
+    }
+
     inline bool MsgCountLimitIsEnabled(const TBatchConfig &config) noexcept {
       return (config.MsgCount != 0);
     }
@@ -129,7 +129,10 @@ static TBatchConfig ToBatchConfig(const TBatchConf::TBatchValues &values) {
   size_t time_limit = values.OptTimeLimit.value_or(0);
   size_t msg_count = values.OptMsgCount.value_or(0);
   size_t byte_count = values.OptByteCount.value_or(0);
-  return TBatchConfig(time_limit, msg_count, byte_count);
+  TBatchConfig config(time_limit, msg_count, byte_count);
+  config.LingerTargetBytes = values.LingerTargetBytes;
+  config.MinTimeLimit = values.MinLingerTime;
+  return config;
 }
 
 TGlobalBatchConfig TBatchConfigBuilder::BuildFromConf(const TBatchConf &conf) {
@@ -32,7 +32,7 @@ std::optional<TMsg::TTimestamp> TBatcherCore::GetNextCompleteTime() const noexce
     return std::nullopt;
   }
 
-  return MinTimestamp + Config.TimeLimit;
+  return MinTimestamp + static_cast<TMsg::TTimestamp>(GetTimeLimit());
 }
 
 TBatcherCore::TAction
@@ -51,6 +51,10 @@ TBatcherCore::ProcessNewMsg(TMsg::TTimestamp now,
      is enabled. */
   size_t body_size = std::max(size_t(1), msg->GetKeyAndValue().Size());
 
+  if (Linger && Linger->RecordArrival(now, body_size)) {
+    LingerUpdated = true;
+  }
+
   if (ByteCountLimitIsEnabled(Config) && (body_size >= Config.ByteCount)) {
     ClearState();
     return TAction::LeaveMsgAndReturnBatch;
@@ -90,7 +94,7 @@ bool TBatcherCore::TestTimeLimit(TMsg::TTimestamp now,
   }
 
   TMsg::TTimestamp min_ts = std::min(MinTimestamp, new_msg_timestamp);
-  return (now >= static_cast<TMsg::TTimestamp>(min_ts + Config.TimeLimit));
+  return (now >= static_cast<TMsg::TTimestamp>(min_ts + GetTimeLimit()));
 }
 
 bool TBatcherCore::TestMsgCount(bool adding_msg) const noexcept {
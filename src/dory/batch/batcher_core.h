@@ -21,10 +21,12 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
 #include <limits>
 #include <optional>
 
+#include <dory/batch/adaptive_linger.h>
 #include <dory/batch/batch_config.h>
 #include <dory/msg.h>
 
@@ -45,6 +47,10 @@ namespace Dory {
 
       explicit TBatcherCore(const TBatchConfig &config) noexcept
           : Config(config) {
+        if (AdaptiveLingerIsEnabled(Config)) {
+          Linger.emplace(std::min(Config.MinTimeLimit, Config.TimeLimit),
+              Config.TimeLimit, Config.LingerTargetBytes);
+        }
       }
 
       TBatcherCore(const TBatcherCore &) noexcept = default;
@@ -73,6 +79,33 @@ namespace Dory {
 
       std::optional<TMsg::TTimestamp> GetNextCompleteTime() const noexcept;
 
+      /* Return the time limit in effect, which differs from the configured
+         time limit when adaptive linger is enabled. */
+      size_t GetTimeLimit() const noexcept {
+        return Linger ? Linger->GetTimeLimit() : Config.TimeLimit;
+      }
+
+      /* Return adaptive linger state, or nullptr if adaptive linger is not
+         enabled. */
+      const TAdaptiveLinger *GetAdaptiveLinger() const noexcept {
+        return Linger ? &*Linger : nullptr;
+      }
+
+      /* See TAdaptiveLinger::SetAckLatency(). */
+      void SetAckLatency(size_t ack_latency) noexcept {
+        if (Linger) {
+          Linger->SetAckLatency(ack_latency);
+        }
+      }
+
+      /* Return true if the adaptive linger time limit was recomputed since the
+         last call. */
+      bool TakeLingerUpdate() noexcept {
+        bool result = LingerUpdated;
+        LingerUpdated = false;
+        return result;
+      }
+
       TAction ProcessNewMsg(TMsg::TTimestamp now,
           const TMsg::TPtr &msg) noexcept;
 
@@ -103,6 +136,10 @@ namespace Dory {
       size_t MsgCount = 0;
 
       size_t ByteCount = 0;
+
+      std::optional<TAdaptiveLinger> Linger;
+
+      bool LingerUpdated = false;
     };  // TBatcherCore
 
   }  // Batch
@@ -113,6 +113,21 @@ namespace Dory {
         return CoreState.GetNextCompleteTime();
       }
 
+      /* See TBatcherCore::GetAdaptiveLinger(). */
+      const TAdaptiveLinger *GetAdaptiveLinger() const noexcept {
+        return CoreState.GetAdaptiveLinger();
+      }
+
+      /* See TBatcherCore::SetAckLatency(). */
+      void SetAckLatency(size_t ack_latency) noexcept {
+        CoreState.SetAckLatency(ack_latency);
+      }
+
+      /* See TBatcherCore::TakeLingerUpdate(). */
+      bool TakeLingerUpdate() noexcept {
+        return CoreState.TakeLingerUpdate();
+      }
+
       /* Empty out the batcher, and return all messages it contained, grouped
          by topic. */
       std::list<std::list<TMsg::TPtr>> TakeBatch();
@@ -31,26 +31,32 @@ using namespace Dory;
 using namespace Dory::Batch;
 using namespace Log;
 
-TPerTopicBatcher::TPerTopicBatcher(const std::shared_ptr<TConfig> &config)
-    : Config(config) {
+TPerTopicBatcher::TPerTopicBatcher(const std::shared_ptr<TConfig> &config,
+    TGrouping grouping)
+    : Config(config),
+      Grouping(grouping) {
 }
 
-TPerTopicBatcher::TPerTopicBatcher(std::shared_ptr<TConfig> &&config)
-    : Config(std::move(config)) {
+TPerTopicBatcher::TPerTopicBatcher(std::shared_ptr<TConfig> &&config,
+    TGrouping grouping)
+    : Config(std::move(config)),
+      Grouping(grouping) {
 }
 
 std::list<std::list<TMsg::TPtr>>
 TPerTopicBatcher::AddMsg(TMsg::TPtr &&msg, TMsg::TTimestamp now) {
   assert(msg);
   const std::string &topic = msg->GetTopic();
-  auto iter = BatchMap.find(topic);
+  TBatchKey key{topic,
+      (Grouping == TGrouping::ByPartition) ? msg->GetPartition() : 0};
+  auto iter = BatchMap.find(key);
 
   if (iter == BatchMap.end()) {
     auto result = BatchMap.insert(
-        std::make_pair(topic,
-            TBatchMapEntry(Config->Get(topic), ExpiryTracker.end())));
+        std::make_pair(std::move(key), TBatchMapEntry(Config->Get(topic))));
     assert(result.second);
     iter = result.first;
+    iter->second.ExpiryTimer.Data = &iter->second;
   }
 
   std::list<std::list<TMsg::TPtr>> complete_topic_batches;
@@ -59,55 +65,32 @@ TPerTopicBatcher::AddMsg(TMsg::TPtr &&msg, TMsg::TTimestamp now) {
 
   if (batcher.BatchingIsEnabled()) {
     auto opt_nct_initial = batcher.GetNextCompleteTime();
+    const TExpiryWheel::TTimer &timer = entry.ExpiryTimer;
 
-    if (opt_nct_initial.has_value() !=
-        (entry.ExpiryRef != ExpiryTracker.end())) {
-      LOG(TPri::ERR) << "Bug!!!  Topic batcher state out of sync with ExpiryRef: "
-          << std::boolalpha << opt_nct_initial.has_value();
+    if (opt_nct_initial.has_value() != timer.IsArmed()) {
+      LOG(TPri::ERR) << "Bug!!!  Topic batcher state out of sync with "
+          << "expiry timer: " << std::boolalpha
+          << opt_nct_initial.has_value();
       assert(false);
     }
 
-    TMsg::TTimestamp expiry = 0;
-
-    if (entry.ExpiryRef != ExpiryTracker.end()) {
-      expiry = entry.ExpiryRef->GetExpiry();
-
-      if (!opt_nct_initial || (*opt_nct_initial != expiry)) {
-        TMsg::TTimestamp nct_initial = opt_nct_initial.value_or(0);
-        LOG(TPri::ERR) << "Bug!!!  Topic batcher time limit does not match "
-            << "expiry tracker time limit: " << std::boolalpha
-            << opt_nct_initial.has_value() << " " << nct_initial << " "
-            << expiry;
-        assert(false);
-      }
+    if (timer.IsArmed() &&
+        (!opt_nct_initial || (*opt_nct_initial != timer.GetExpiry()))) {
+      TMsg::TTimestamp nct_initial = opt_nct_initial.value_or(0);
+      LOG(TPri::ERR) << "Bug!!!  Topic batcher time limit does not match "
+          << "expiry timer time limit: " << std::boolalpha
+          << opt_nct_initial.has_value() << " " << nct_initial << " "
+          << timer.GetExpiry();
+      assert(false);
     }
 
+    batcher.SetAckLatency(AckLatency);
     std::list<TMsg::TPtr> complete_batch = batcher.AddMsg(std::move(msg), now);
-    auto opt_nct_final = batcher.GetNextCompleteTime();
-    bool remove_old_expiry = false;
-    bool add_new_expiry = false;
-
-    if (entry.ExpiryRef != ExpiryTracker.end()) {
-      if (opt_nct_final) {
-        if (*opt_nct_final != expiry) {
-          remove_old_expiry = true;
-          add_new_expiry = true;
-        }
-      } else {
-        remove_old_expiry = true;
-      }
-    } else if (opt_nct_final) {
-      add_new_expiry = true;
-    }
+    ExpiryWheel.Set(entry.ExpiryTimer, batcher.GetNextCompleteTime());
 
-    if (remove_old_expiry) {
-      ExpiryTracker.erase(entry.ExpiryRef);
-      entry.ExpiryRef = ExpiryTracker.end();
-    }
-
-    if (add_new_expiry) {
-      entry.ExpiryRef = ExpiryTracker.insert(
-          TBatchExpiryRecord(*opt_nct_final, topic));
+    if (batcher.TakeLingerUpdate() && LingerStats) {
+      LingerStats->Update(iter->first.Topic, LingerStatsBrokerId,
+          *batcher.GetAdaptiveLinger());
     }
 
     if (!complete_batch.empty()) {
@@ -132,44 +115,18 @@ TPerTopicBatcher::AddMsg(TMsg::TPtr &&msg, TMsg::TTimestamp now) {
 std::list<std::list<TMsg::TPtr>>
 TPerTopicBatcher::GetCompleteBatches(TMsg::TTimestamp now) {
   std::list<std::list<TMsg::TPtr>> result;
-
-  for (TExpiryRef iter = ExpiryTracker.begin();
-       (iter != ExpiryTracker.end()) && (iter->GetExpiry() <= now); ) {
-    TExpiryRef curr = iter;
-    ++iter;
-
-    auto map_iter = BatchMap.find(curr->GetTopic());
-
-    if (map_iter == BatchMap.end()) {
-      LOG(TPri::ERR) << "Bug!!! BatchMap lookup failed in "
-          << "TPerTopicBatcher::GetCompleteBatches()";
-      assert(false);
-      continue;
-    }
-
-    TBatchMapEntry &map_entry = map_iter->second;
-
-    if (map_entry.ExpiryRef != curr) {
-      LOG(TPri::ERR) << "Bug!!! TBatchMapEntry ExpiryRef is incorrect in "
-          << "TPerTopicBatcher::GetCompleteBatches()";
-      assert(false);
-    }
-
-    assert(!map_entry.Batcher.IsEmpty());
-    result.push_back(map_entry.Batcher.TakeBatch());
-    map_entry.ExpiryRef = ExpiryTracker.end();
-    ExpiryTracker.erase(curr);
-  }
-
+  ExpiryWheel.Advance(now,
+      [&result](TExpiryWheel::TTimer &timer) {
+        TBatchMapEntry &entry = *timer.Data;
+        assert(&entry.ExpiryTimer == &timer);
+        assert(!entry.Batcher.IsEmpty());
+        result.push_back(entry.Batcher.TakeBatch());
+      });
   return result;
 }
 
 std::optional<TMsg::TTimestamp> TPerTopicBatcher::GetNextCompleteTime() const noexcept {
-  if (ExpiryTracker.empty()) {
-    return std::nullopt;
-  }
-
-  return ExpiryTracker.begin()->GetExpiry();
+  return ExpiryWheel.GetNextExpiry();
 }
 
 std::list<std::list<TMsg::TPtr>> TPerTopicBatcher::GetAllBatches() {
@@ -184,76 +141,75 @@ std::list<std::list<TMsg::TPtr>> TPerTopicBatcher::GetAllBatches() {
       result.push_back(std::move(batch));
     }
 
-    entry.ExpiryRef = ExpiryTracker.end();
+    ExpiryWheel.Cancel(entry.ExpiryTimer);
   }
 
-  ExpiryTracker.clear();
+  assert(ExpiryWheel.IsEmpty());
   return result;
 }
 
 std::list<TMsg::TPtr> TPerTopicBatcher::DeleteTopic(const std::string &topic) {
-  auto iter = BatchMap.find(topic);
+  std::list<TMsg::TPtr> result;
 
-  if (iter == BatchMap.end()) {
-    return std::list<TMsg::TPtr>();
+  if (Grouping == TGrouping::ByTopic) {
+    auto iter = BatchMap.find(TBatchKey{topic, 0});
+
+    if (iter != BatchMap.end()) {
+      result = DeleteEntry(iter);
+    }
+
+    return result;
   }
 
-  TBatchMapEntry &entry = iter->second;
-  std::list<TMsg::TPtr> batch = entry.Batcher.TakeBatch();
-  TExpiryRef ref = entry.ExpiryRef;
+  /* Topic deletion happens only on metadata updates, so a full scan of the
+     map is acceptable here. */
+  for (auto iter = BatchMap.begin(), next = iter;
+       iter != BatchMap.end();
+       iter = next) {
+    ++next;
 
-  if (ref != ExpiryTracker.end()) {
-    assert(ref->GetTopic() == topic);
-    assert(!batch.empty());
-    ExpiryTracker.erase(ref);
+    if (iter->first.Topic == topic) {
+      result.splice(result.end(), DeleteEntry(iter));
+    }
   }
 
+  return result;
+}
+
+std::list<TMsg::TPtr> TPerTopicBatcher::DeleteEntry(TBatchMap::iterator iter) {
+  TBatchMapEntry &entry = iter->second;
+  std::list<TMsg::TPtr> batch = entry.Batcher.TakeBatch();
+  assert(!entry.ExpiryTimer.IsArmed() || !batch.empty());
+  ExpiryWheel.Cancel(entry.ExpiryTimer);
   BatchMap.erase(iter);
   return batch;
 }
 
 bool TPerTopicBatcher::SanityCheck() const {
+  size_t armed_count = 0;
+
   for (const auto &map_item : BatchMap) {
-    const std::string &topic = map_item.first;
     const TBatchMapEntry &entry = map_item.second;
-    TExpiryRef expiry_iter = ExpiryTracker.begin();
-
-    for (; expiry_iter != ExpiryTracker.end(); ++expiry_iter) {
-      if (expiry_iter->GetTopic() == topic) {
-        break;
-      }
-    }
+    const TExpiryWheel::TTimer &timer = entry.ExpiryTimer;
 
-    auto opt_time_limit = entry.Batcher.GetNextCompleteTime();
-
-    if (opt_time_limit.has_value()) {
-      if ((expiry_iter == ExpiryTracker.end()) ||
-          (entry.ExpiryRef != expiry_iter)) {
-        return false;
-      }
-
-      if (entry.ExpiryRef->GetExpiry() != *opt_time_limit) {
-        return false;
-      }
-    } else if ((entry.ExpiryRef != ExpiryTracker.end()) ||
-               (expiry_iter != ExpiryTracker.end())) {
+    if (timer.Data != &entry) {
       return false;
     }
-  }
 
-  std::set<std::string> topic_set;
+    auto opt_time_limit = entry.Batcher.GetNextCompleteTime();
 
-  for (const TBatchExpiryRecord &rec : ExpiryTracker) {
-    if (BatchMap.find(rec.GetTopic()) == BatchMap.end()) {
+    if (opt_time_limit.has_value() != timer.IsArmed()) {
       return false;
     }
 
-    auto result = topic_set.insert(rec.GetTopic());
+    if (timer.IsArmed()) {
+      if (timer.GetExpiry() != *opt_time_limit) {
+        return false;
+      }
 
-    if (!result.second) {
-      return false;
+      ++armed_count;
     }
   }
 
-  return true;
+  return (armed_count == ExpiryWheel.Size()) && ExpiryWheel.SanityCheck();
 }
@@ -21,16 +21,20 @@
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <list>
 #include <memory>
 #include <optional>
-#include <set>
 #include <string>
 #include <unordered_map>
 
 #include <base/no_copy_semantics.h>
 #include <dory/batch/batch_config.h>
 #include <dory/batch/single_topic_batcher.h>
+#include <dory/batch/timer_wheel.h>
+#include <dory/linger_stats.h>
 #include <dory/msg.h>
 
 namespace Dory {
@@ -68,9 +72,23 @@ namespace Dory {
         std::unordered_map<std::string, TBatchConfig> PerTopic;
       };  // TConfig
 
-      explicit TPerTopicBatcher(const std::shared_ptr<TConfig> &config);
+      /* Determines what set of messages a single batch holds. */
+      enum class TGrouping {
+        /* One batch per topic. */
+        ByTopic,
 
-      explicit TPerTopicBatcher(std::shared_ptr<TConfig> &&config);
+        /* One batch per (topic, partition) pair, so batching limits apply to
+           each partition's message set separately.  Messages must have their
+           partitions assigned before they are batched, so this is only useful
+           for PartitionKey messages. */
+        ByPartition
+      };  // TGrouping
+
+      explicit TPerTopicBatcher(const std::shared_ptr<TConfig> &config,
+          TGrouping grouping = TGrouping::ByTopic);
+
+      explicit TPerTopicBatcher(std::shared_ptr<TConfig> &&config,
+          TGrouping grouping = TGrouping::ByTopic);
 
       /* TODO: Eliminate need for clients to call this method. */
       bool IsEnabled() const noexcept {
@@ -81,6 +99,10 @@ namespace Dory {
         return Config;
       }
 
+      TGrouping GetGrouping() const noexcept {
+        return Grouping;
+      }
+
       std::list<std::list<TMsg::TPtr>>
       AddMsg(TMsg::TPtr &&msg, TMsg::TTimestamp now);
 
@@ -95,7 +117,26 @@ namespace Dory {
          have no messages.  This is used when dory is shutting down. */
       std::list<std::list<TMsg::TPtr>> GetAllBatches();
 
-      /* Delete all batch state for the given topic and return a list of all
+      /* Set the most recently observed broker ACK latency in milliseconds, for
+         use by topics with adaptive linger enabled.  See
+         TAdaptiveLinger::SetAckLatency(). */
+      void SetAckLatency(size_t ack_latency) noexcept {
+        AckLatency = ack_latency;
+      }
+
+      /* Report adaptive linger time limits for each topic to 'stats', with
+         'broker_id' identifying this batcher.  'broker_id' is empty for the
+         router thread's batcher.  With TGrouping::ByPartition, each topic
+         reports the time limit of whichever of its partitions most recently
+         updated its time limit. */
+      void SetLingerStats(TLingerStats *stats,
+          std::optional<long> broker_id) noexcept {
+        LingerStats = stats;
+        LingerStatsBrokerId = broker_id;
+      }
+
+      /* Delete all batch state for the given topic (including all of its
+         partitions, with TGrouping::ByPartition) and return a list of all
          messages that were batched for that topic. */
       std::list<TMsg::TPtr> DeleteTopic(const std::string &topic);
 
@@ -103,91 +144,74 @@ namespace Dory {
       bool SanityCheck() const;
 
       private:
-      /* We store these in a multiset.  Each record represents a topic batch
-         with a time limit.  The records are ordered by ascending expiry time,
-         regardless of topic.  In other words, two records with the same
-         timestamp but different topics are considered equal from the
-         multiset's point of view.  The multiset contains at most one record
-         for a given topic.  No record for a given topic appears in the
-         multiset in the case where the batch for that topic is empty or has no
-         time limit. */
-      class TBatchExpiryRecord final {
-        public:
-        TBatchExpiryRecord(TMsg::TTimestamp expiry, const std::string &topic)
-            : Expiry(expiry),
-              Topic(topic) {
-        }
-
-        TBatchExpiryRecord(TMsg::TTimestamp expiry, std::string &&topic)
-            : Expiry(expiry),
-              Topic(std::move(topic)) {
-        }
-
-        TBatchExpiryRecord(TBatchExpiryRecord &&that) noexcept
-            : Expiry(that.Expiry),
-              Topic(std::move(that.Topic)) {
-        }
-
-        TBatchExpiryRecord &operator=(TBatchExpiryRecord &&that) noexcept {
-          if (this != &that) {
-            Expiry = that.Expiry;
-            Topic = std::move(that.Topic);
-          }
-
-          return *this;
-        }
+      /* Identifies a batch.  'Partition' is always 0 with TGrouping::ByTopic.
+       */
+      struct TBatchKey {
+        std::string Topic;
 
-        bool operator<(const TBatchExpiryRecord &that) const noexcept {
-          return (Expiry < that.Expiry);
-        }
+        int32_t Partition;
 
-        TMsg::TTimestamp GetExpiry() const noexcept {
-          return Expiry;
+        bool operator==(const TBatchKey &that) const noexcept {
+          return (Partition == that.Partition) && (Topic == that.Topic);
         }
+      };  // TBatchKey
 
-        const std::string &GetTopic() const noexcept {
-          return Topic;
+      struct TBatchKeyHash {
+        size_t operator()(const TBatchKey &key) const noexcept {
+          return std::hash<std::string>()(key.Topic) ^
+              (std::hash<int32_t>()(key.Partition) * 0x9e3779b9U);
         }
+      };  // TBatchKeyHash
 
-        private:
-        /* Batch expiry time. */
-        TMsg::TTimestamp Expiry;
-
-        /* Batch topic. */
-        std::string Topic;
-      };  // TBatchExpiryRecord
+      struct TBatchMapEntry;
 
-      using TExpiryRef = std::multiset<TBatchExpiryRecord>::const_iterator;
+      /* Each timer's data points to the entry containing the timer. */
+      using TExpiryWheel = TTimerWheel<TBatchMapEntry *>;
 
       struct TBatchMapEntry {
         /* A batch for a single topic. */
         TSingleTopicBatcher Batcher;
 
-        /* If the batch is nonempty and has a time limit, then this references
-           the corresponding entry in 'ExpiryTracker' below.  Otherwise this is
-           set to ExpiryTracker.end(). */
-        TExpiryRef ExpiryRef;
+        /* Armed in 'ExpiryWheel' below if and only if the batch is nonempty
+           and has a time limit.  In that case, the timer's expiry is the time
+           limit. */
+        TExpiryWheel::TTimer ExpiryTimer;
 
-        TBatchMapEntry(const TBatchConfig &config, TExpiryRef expiry_ref)
+        explicit TBatchMapEntry(const TBatchConfig &config)
             : Batcher(config),
-              ExpiryRef(expiry_ref) {
+              ExpiryTimer(nullptr) {
         }
 
         TBatchMapEntry(TBatchMapEntry &&) = default;
-
-        TBatchMapEntry &operator=(TBatchMapEntry &&) = default;
       };  // TBatchMapEntry
 
+      using TBatchMap =
+          std::unordered_map<TBatchKey, TBatchMapEntry, TBatchKeyHash>;
+
+      /* Remove the entry at 'iter' and return its messages. */
+      std::list<TMsg::TPtr> DeleteEntry(TBatchMap::iterator iter);
+
       /* Per-topic batching configuration obtained from a config file. */
       std::shared_ptr<TConfig> Config;
 
-      /* Key is topic and value is batch of messages for topic. */
-      std::unordered_map<std::string, TBatchMapEntry> BatchMap;
+      const TGrouping Grouping;
+
+      /* Key identifies a topic (and partition, with TGrouping::ByPartition)
+         and value is batch of messages for it.  Since 'ExpiryWheel' links to
+         the timers in the entries, we rely on the guarantee that elements of
+         an unordered_map never move once inserted. */
+      TBatchMap BatchMap;
+
+      /* This contains an armed timer for each nonempty topic batch with a
+         time limit.  It lets us efficiently determine the soonest time limit
+         expiration, and find the batches whose time limits have expired. */
+      TExpiryWheel ExpiryWheel;
+
+      size_t AckLatency = 0;
+
+      TLingerStats *LingerStats = nullptr;
 
-      /* This contains a record for each nonempty topic batch with a time
-         limit.  It lets us efficiently determine the soonest time limit
-         expiration. */
-      std::multiset<TBatchExpiryRecord> ExpiryTracker;
+      std::optional<long> LingerStatsBrokerId;
     };  // TPerTopicBatcher
 
   }  // Batch
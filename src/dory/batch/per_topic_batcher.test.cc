@@ -353,6 +353,64 @@ namespace {
     ASSERT_FALSE(opt_nct.has_value());
   }
 
+  TEST_F(TPerTopicBatcherTest, ByPartitionTest) {
+    TTestMsgCreator mc;  // create this first since it contains buffer pool
+    TPerTopicBatcher batcher(MakeTopicBatchConfig(),
+        TPerTopicBatcher::TGrouping::ByPartition);
+    ASSERT_TRUE(batcher.GetGrouping() ==
+        TPerTopicBatcher::TGrouping::ByPartition);
+    std::list<std::list<TMsg::TPtr>> complete_batches;
+
+    /* Topic t1 completes a batch at 3 messages.  Alternate between two
+       partitions, so partition 0 reaches the limit with the fifth message. */
+    for (int i = 0; i < 5; ++i) {
+      TMsg::TPtr msg = mc.NewMsg("t1", "t1 msg", 5 + i);
+      msg->SetPartition(i % 2);
+      complete_batches = SetProcessed(batcher.AddMsg(std::move(msg), 5 + i));
+      ASSERT_TRUE(batcher.SanityCheck());
+      ASSERT_FALSE(!!msg);
+
+      if (i < 4) {
+        ASSERT_TRUE(complete_batches.empty());
+      }
+    }
+
+    ASSERT_EQ(complete_batches.size(), 1U);
+    ASSERT_EQ(complete_batches.front().size(), 3U);
+
+    for (const TMsg::TPtr &msg : complete_batches.front()) {
+      ASSERT_EQ(msg->GetPartition(), 0);
+    }
+
+    /* The batch for partition 1 still holds 2 messages, and expires 10 ms
+       after its first message arrived. */
+    auto opt_nct = batcher.GetNextCompleteTime();
+    ASSERT_TRUE(opt_nct.has_value());
+    ASSERT_EQ(*opt_nct, 16);
+
+    TMsg::TPtr msg = mc.NewMsg("t2", "t2 msg", 10);
+    msg->SetPartition(1);
+    complete_batches = SetProcessed(batcher.AddMsg(std::move(msg), 10));
+    ASSERT_TRUE(complete_batches.empty());
+    msg = mc.NewMsg("t1", "t1 msg", 11);
+    msg->SetPartition(2);
+    complete_batches = SetProcessed(batcher.AddMsg(std::move(msg), 11));
+    ASSERT_TRUE(complete_batches.empty());
+
+    /* Deleting t1 removes the batches for all of its partitions, but leaves
+       t2 alone. */
+    std::list<TMsg::TPtr> deleted = SetProcessed(batcher.DeleteTopic("t1"));
+    ASSERT_TRUE(batcher.SanityCheck());
+    ASSERT_EQ(deleted.size(), 3U);
+    opt_nct = batcher.GetNextCompleteTime();
+    ASSERT_TRUE(opt_nct.has_value());
+    ASSERT_EQ(*opt_nct, 30);
+    complete_batches = SetProcessed(batcher.GetAllBatches());
+    ASSERT_EQ(complete_batches.size(), 1U);
+    ASSERT_EQ(complete_batches.front().size(), 1U);
+    ASSERT_EQ(complete_batches.front().front()->GetTopic(), "t2");
+  }
+
 }  // namespace
 
 int main(int argc, char **argv) {
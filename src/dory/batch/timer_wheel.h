@@ -0,0 +1,439 @@
+/* <dory/batch/timer_wheel.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Hierarchical timer wheel for tracking batch expiry times.
+ */
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <base/time_util.h>
+#include <dory/msg.h>
+
+namespace Dory {
+
+  namespace Batch {
+
+    /* A hierarchical timer wheel with millisecond resolution.  Arming and
+       cancelling a timer take constant time and do no memory allocation,
+       since timers are linked directly into the wheel's slots.  Each of the
+       wheel's levels has 256 slots.  A slot at level 0 covers a single
+       millisecond, and a slot at level N covers 256 times the span of a slot
+       at level N - 1.  A timer is placed at the lowest level where its expiry
+       time falls within the current rotation, and moves down a level when the
+       wheel's current time reaches its slot.  'TData' is arbitrary client data
+       stored with each timer, which the client typically uses to find the
+       object that owns an expired timer.  An armed timer must not be
+       destroyed before the wheel that contains it. */
+    template <typename TData>
+    class TTimerWheel final {
+      NO_COPY_SEMANTICS(TTimerWheel);
+
+      public:
+      class TTimer final {
+        NO_COPY_SEMANTICS(TTimer);
+
+        public:
+        explicit TTimer(const TData &data)
+            : Data(data) {
+        }
+
+        /* Only an unarmed timer may be moved, since the wheel holds pointers
+           to armed timers. */
+        TTimer(TTimer &&that) noexcept
+            : Data(std::move(that.Data)) {
+          assert(!that.Armed);
+        }
+
+        bool IsArmed() const noexcept {
+          return Armed;
+        }
+
+        /* Must only be called when timer is armed. */
+        TMsg::TTimestamp GetExpiry() const noexcept {
+          assert(Armed);
+          return Expiry;
+        }
+
+        TData Data;
+
+        private:
+        friend class TTimerWheel;
+
+        TTimer *Prev = nullptr;
+
+        TTimer *Next = nullptr;
+
+        TMsg::TTimestamp Expiry = 0;
+
+        /* Index of slot containing timer, when armed. */
+        size_t Slot = 0;
+
+        bool Armed = false;
+      };  // TTimer
+
+      /* The wheel's initial current time is the time given by
+         Base::GetEpochMilliseconds(), which is the clock that message
+         timestamps and batch expiry times are based on.  Starting from the
+         current time rather than 0 avoids a long walk through the wheel on
+         the first call to Advance(), and a scan of every armed timer by
+         GetNextExpiry() until then. */
+      TTimerWheel()
+          : TTimerWheel(
+                static_cast<TMsg::TTimestamp>(Base::GetEpochMilliseconds())) {
+      }
+
+      /* 'now' is the wheel's initial current time.  It must not be negative.
+       */
+      explicit TTimerWheel(TMsg::TTimestamp now)
+          : Slots(NUM_LEVELS * SLOTS_PER_LEVEL),
+            Current(now) {
+        assert(now >= 0);
+        Occupied.fill(0);
+      }
+
+      bool IsEmpty() const noexcept {
+        return (Count == 0);
+      }
+
+      /* Return the number of armed timers. */
+      size_t Size() const noexcept {
+        return Count;
+      }
+
+      /* Arm 'timer', which must not already be armed, to expire at time
+         'expiry'.  An expiry time in the past is allowed, in which case the
+         timer will expire on the next call to Advance(). */
+      void Arm(TTimer &timer, TMsg::TTimestamp expiry) noexcept {
+        assert(!timer.Armed);
+        timer.Expiry = expiry;
+        Insert(timer);
+        timer.Armed = true;
+        ++Count;
+
+        if (CachedMinValid && (!CachedMin || (expiry < *CachedMin))) {
+          CachedMin = expiry;
+        }
+      }
+
+      /* Disarm 'timer' if it is armed.  Otherwise do nothing. */
+      void Cancel(TTimer &timer) noexcept {
+        if (!timer.Armed) {
+          return;
+        }
+
+        Unlink(timer);
+        timer.Armed = false;
+        assert(Count);
+        --Count;
+
+        if (CachedMinValid && CachedMin && (*CachedMin == timer.Expiry)) {
+          CachedMinValid = false;
+        }
+      }
+
+      /* Arm 'timer' to expire at time 'expiry', or disarm it if 'expiry' is
+         empty.  'timer' may or may not already be armed on entry. */
+      void Set(TTimer &timer,
+          const std::optional<TMsg::TTimestamp> &expiry) noexcept {
+        if (timer.Armed && expiry && (*expiry == timer.Expiry)) {
+          return;
+        }
+
+        Cancel(timer);
+
+        if (expiry) {
+          Arm(timer, *expiry);
+        }
+      }
+
+      /* Return the earliest expiry time of all armed timers, or an empty
+         value if no timers are armed. */
+      std::optional<TMsg::TTimestamp> GetNextExpiry() const noexcept {
+        if (!CachedMinValid) {
+          CachedMin = ComputeNextExpiry();
+          CachedMinValid = true;
+        }
+
+        return CachedMin;
+      }
+
+      /* Set the wheel's current time to 'now', and disarm all timers whose
+         expiry times are <= 'now', calling 'on_expiry' for each of them in
+         order of ascending expiry time.  'on_expiry' is called with a
+         reference to the expired timer, and must not arm or cancel timers.  If
+         'now' is less than the current time (for instance, due to the system
+         clock being set back), the current time is left unchanged. */
+      template <typename TOnExpiry>
+      void Advance(TMsg::TTimestamp now, TOnExpiry &&on_expiry) {
+        for (; ; ) {
+          std::optional<TMsg::TTimestamp> next = ComputeNextExpiry();
+
+          if (!next || (*next > now)) {
+            break;
+          }
+
+          MoveTo(std::max(*next, Current));
+          TSlot &slot = Slots[SlotIndex(0, Current)];
+
+          for (TTimer *timer = slot.Head, *next_timer = nullptr; timer;
+               timer = next_timer) {
+            next_timer = timer->Next;
+
+            /* The slot may also contain timers that were armed with expiry
+               times in the past.  Expire only those with the earliest expiry
+               time on this pass, so timers expire in order. */
+            if (timer->Expiry == *next) {
+              Unlink(*timer);
+              timer->Armed = false;
+              --Count;
+              on_expiry(*timer);
+            }
+          }
+        }
+
+        if (now > Current) {
+          MoveTo(now);
+        }
+
+        CachedMinValid = false;
+      }
+
+      /* For testing. */
+      bool SanityCheck() const noexcept {
+        size_t count = 0;
+
+        for (size_t i = 0; i < Slots.size(); ++i) {
+          const TSlot &slot = Slots[i];
+
+          if (IsOccupied(i) != (slot.Head != nullptr)) {
+            return false;
+          }
+
+          for (const TTimer *timer = slot.Head; timer; timer = timer->Next) {
+            if (!timer->Armed || (timer->Slot != i) ||
+                (timer->Next ? (timer->Next->Prev != timer) :
+                    (slot.Tail != timer))) {
+              return false;
+            }
+
+            ++count;
+          }
+        }
+
+        return (count == Count) &&
+            (GetNextExpiry() == ComputeNextExpiry());
+      }
+
+      private:
+      static const size_t SLOT_BITS = 8;
+
+      static const size_t SLOTS_PER_LEVEL = size_t(1) << SLOT_BITS;
+
+      static const uint64_t SLOT_MASK = SLOTS_PER_LEVEL - 1;
+
+      static const size_t NUM_LEVELS = 64 / SLOT_BITS;
+
+      static const size_t WORDS_PER_LEVEL = SLOTS_PER_LEVEL / 64;
+
+      struct TSlot {
+        TTimer *Head = nullptr;
+
+        TTimer *Tail = nullptr;
+      };  // TSlot
+
+      static size_t SlotIndex(size_t level, TMsg::TTimestamp t) noexcept {
+        return (level * SLOTS_PER_LEVEL) +
+            ((static_cast<uint64_t>(t) >> (level * SLOT_BITS)) & SLOT_MASK);
+      }
+
+      bool IsOccupied(size_t slot_index) const noexcept {
+        return (Occupied[slot_index / 64] >> (slot_index % 64)) & 1;
+      }
+
+      /* Return the index of the first occupied slot at 'level' whose position
+         within the level is >= the position of the wheel's current time, or
+         an empty value if there is none. */
+      std::optional<size_t> FindOccupiedSlot(size_t level) const noexcept {
+        size_t start = SlotIndex(level, Current);
+        size_t end = (level + 1) * SLOTS_PER_LEVEL;
+
+        for (size_t word = start / 64; (word * 64) < end; ++word) {
+          uint64_t bits = Occupied[word];
+
+          if ((word * 64) < start) {
+            bits &= ~uint64_t(0) << (start % 64);
+          }
+
+          if (bits) {
+            return (word * 64) + static_cast<size_t>(std::countr_zero(bits));
+          }
+        }
+
+        return std::nullopt;
+      }
+
+      std::optional<TMsg::TTimestamp> ComputeNextExpiry() const noexcept {
+        for (size_t level = 0; level < NUM_LEVELS; ++level) {
+          std::optional<size_t> opt_slot = FindOccupiedSlot(level);
+
+          if (!opt_slot) {
+            continue;
+          }
+
+          if ((level == 0) && (*opt_slot != SlotIndex(0, Current))) {
+            /* All timers in a level 0 slot after the current one have the
+               same expiry time. */
+            return Slots[*opt_slot].Head->Expiry;
+          }
+
+          /* Either a level 0 slot holding timers that are due now (possibly
+             with expiry times in the past), or a higher level slot holding
+             timers with expiry times spread across the slot's span.  In both
+             cases we must examine the individual timers.  Timers in any slot
+             at a higher level expire later than the timers in this slot. */
+          const TTimer *timer = Slots[*opt_slot].Head;
+          TMsg::TTimestamp result = timer->Expiry;
+
+          for (timer = timer->Next; timer; timer = timer->Next) {
+            result = std::min(result, timer->Expiry);
+          }
+
+          return result;
+        }
+
+        return std::nullopt;
+      }
+
+      void Insert(TTimer &timer) noexcept {
+        const auto expiry = static_cast<uint64_t>(
+            std::max(timer.Expiry, Current));
+        const auto current = static_cast<uint64_t>(Current);
+        size_t level = 0;
+
+        /* Find the lowest level at which the expiry time falls within the
+           current rotation of the wheel. */
+        while (((level + 1) < NUM_LEVELS) &&
+            ((expiry >> ((level + 1) * SLOT_BITS)) !=
+                (current >> ((level + 1) * SLOT_BITS)))) {
+          ++level;
+        }
+
+        const size_t slot_index = SlotIndex(level,
+            static_cast<TMsg::TTimestamp>(expiry));
+        TSlot &slot = Slots[slot_index];
+        timer.Slot = slot_index;
+        timer.Prev = slot.Tail;
+        timer.Next = nullptr;
+
+        if (slot.Tail) {
+          slot.Tail->Next = &timer;
+        } else {
+          slot.Head = &timer;
+          Occupied[slot_index / 64] |= uint64_t(1) << (slot_index % 64);
+        }
+
+        slot.Tail = &timer;
+      }
+
+      void Unlink(TTimer &timer) noexcept {
+        TSlot &slot = Slots[timer.Slot];
+
+        if (timer.Prev) {
+          timer.Prev->Next = timer.Next;
+        } else {
+          slot.Head = timer.Next;
+        }
+
+        if (timer.Next) {
+          timer.Next->Prev = timer.Prev;
+        } else {
+          slot.Tail = timer.Prev;
+        }
+
+        timer.Prev = nullptr;
+        timer.Next = nullptr;
+
+        if (slot.Head == nullptr) {
+          Occupied[timer.Slot / 64] &= ~(uint64_t(1) << (timer.Slot % 64));
+        }
+      }
+
+      /* Set the current time to 'now', which must not be later than the
+         expiry time of any armed timer, and move down the timers in the slots
+         that 'now' falls within at each level above 0. */
+      void MoveTo(TMsg::TTimestamp now) noexcept {
+        assert(now >= Current);
+
+        if (now == Current) {
+          return;
+        }
+
+        Current = now;
+
+        for (size_t level = NUM_LEVELS - 1; level > 0; --level) {
+          const size_t slot_index = SlotIndex(level, Current);
+
+          if (!IsOccupied(slot_index)) {
+            continue;
+          }
+
+          TSlot &slot = Slots[slot_index];
+          TTimer *timer = slot.Head;
+          slot.Head = nullptr;
+          slot.Tail = nullptr;
+          Occupied[slot_index / 64] &= ~(uint64_t(1) << (slot_index % 64));
+
+          while (timer) {
+            TTimer *next = timer->Next;
+            Insert(*timer);
+            timer = next;
+          }
+        }
+      }
+
+      std::vector<TSlot> Slots;
+
+      /* Bit i is set if and only if slot i is nonempty. */
+      std::array<uint64_t, NUM_LEVELS * WORDS_PER_LEVEL> Occupied;
+
+      /* The wheel's current time. */
+      TMsg::TTimestamp Current;
+
+      /* Number of armed timers. */
+      size_t Count = 0;
+
+      /* Cached result of ComputeNextExpiry(), valid only when
+         'CachedMinValid' is true. */
+      mutable std::optional<TMsg::TTimestamp> CachedMin;
+
+      mutable bool CachedMinValid = true;
+    };  // TTimerWheel
+
+  }  // Batch
+
+}  // Dory
@@ -0,0 +1,228 @@
+/* <dory/batch/timer_wheel.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit test for <dory/batch/timer_wheel.h>.
+ */
+
+#include <dory/batch/timer_wheel.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include <base/time_util.h>
+#include <base/tmp_file.h>
+#include <dory/msg.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Batch;
+using namespace ::TestUtil;
+
+namespace {
+
+  using TWheel = TTimerWheel<size_t>;
+
+  /* Advance 'wheel' to 'now' and return the data values of the timers that
+     expired, in order of expiry. */
+  std::vector<size_t> Advance(TWheel &wheel, TMsg::TTimestamp now) {
+    std::vector<size_t> result;
+    wheel.Advance(now,
+        [&result](TWheel::TTimer &timer) {
+          EXPECT_FALSE(timer.IsArmed());
+          result.push_back(timer.Data);
+        });
+    return result;
+  }
+
+  /* The fixture for testing class TTimerWheel. */
+  class TTimerWheelTest : public ::testing::Test {
+    protected:
+    TTimerWheelTest() = default;
+
+    ~TTimerWheelTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TTimerWheelTest
+
+  TEST_F(TTimerWheelTest, BasicTest) {
+    const TMsg::TTimestamp start = 1500000000000;
+    TWheel wheel(start);
+    ASSERT_TRUE(wheel.IsEmpty());
+    ASSERT_FALSE(wheel.GetNextExpiry().has_value());
+    TWheel::TTimer t0(0), t1(1), t2(2), t3(3);
+    wheel.Arm(t0, start + 50);
+    wheel.Arm(t1, start + 10);
+    wheel.Arm(t2, start + 100000);
+    wheel.Arm(t3, start + 10);
+    ASSERT_EQ(wheel.Size(), 4U);
+    ASSERT_TRUE(wheel.SanityCheck());
+    ASSERT_EQ(wheel.GetNextExpiry(), start + 10);
+    ASSERT_TRUE(Advance(wheel, start + 9).empty());
+    ASSERT_EQ(Advance(wheel, start + 10), std::vector<size_t>({1, 3}));
+    ASSERT_EQ(wheel.GetNextExpiry(), start + 50);
+    ASSERT_TRUE(wheel.SanityCheck());
+
+    /* Cancel and rearm. */
+    wheel.Cancel(t0);
+    ASSERT_FALSE(t0.IsArmed());
+    ASSERT_EQ(wheel.GetNextExpiry(), start + 100000);
+    wheel.Set(t2, start + 20);
+    ASSERT_EQ(t2.GetExpiry(), start + 20);
+    ASSERT_EQ(wheel.GetNextExpiry(), start + 20);
+    wheel.Set(t0, start + 5);  // already in the past
+    ASSERT_EQ(wheel.GetNextExpiry(), start + 5);
+    ASSERT_TRUE(wheel.SanityCheck());
+    ASSERT_EQ(Advance(wheel, start + 11), std::vector<size_t>({0}));
+    wheel.Set(t2, std::nullopt);
+    ASSERT_TRUE(wheel.IsEmpty());
+    ASSERT_FALSE(wheel.GetNextExpiry().has_value());
+    ASSERT_TRUE(Advance(wheel, start + 1000000).empty());
+    ASSERT_TRUE(wheel.SanityCheck());
+  }
+
+  TEST_F(TTimerWheelTest, ClockBackwardTest) {
+    const TMsg::TTimestamp start = 1000000;
+    TWheel wheel(start);
+    TWheel::TTimer t0(0), t1(1);
+    wheel.Arm(t0, start - 100);
+    wheel.Arm(t1, start - 50);
+
+    /* Only timers that have actually expired relative to the time passed in
+       are removed, even if the wheel's current time is later. */
+    ASSERT_EQ(Advance(wheel, start - 75), std::vector<size_t>({0}));
+    ASSERT_EQ(wheel.GetNextExpiry(), start - 50);
+    ASSERT_TRUE(wheel.SanityCheck());
+    ASSERT_EQ(Advance(wheel, start), std::vector<size_t>({1}));
+    ASSERT_TRUE(wheel.IsEmpty());
+  }
+
+  TEST_F(TTimerWheelTest, DefaultStartTest) {
+    /* A default constructed wheel starts at the current time. */
+    const auto start = static_cast<TMsg::TTimestamp>(GetEpochMilliseconds());
+    TWheel wheel;
+    TWheel::TTimer t0(0), t1(1);
+    wheel.Arm(t0, start + 100);
+    wheel.Arm(t1, start + 50);
+    ASSERT_EQ(wheel.GetNextExpiry(), start + 50);
+    ASSERT_TRUE(wheel.SanityCheck());
+    ASSERT_EQ(Advance(wheel, start + 100), std::vector<size_t>({1, 0}));
+    ASSERT_TRUE(wheel.IsEmpty());
+  }
+
+  TEST_F(TTimerWheelTest, RandomTest) {
+    const size_t num_timers = 2000;
+    TMsg::TTimestamp now = 1600000000000;
+    TWheel wheel(now);
+    std::vector<std::unique_ptr<TWheel::TTimer>> timers;
+
+    for (size_t i = 0; i < num_timers; ++i) {
+      timers.push_back(std::make_unique<TWheel::TTimer>(i));
+    }
+
+    /* Reference implementation: key is timer index, value is expiry. */
+    std::map<size_t, TMsg::TTimestamp> expected;
+    std::mt19937_64 rng(12345);
+
+    for (size_t iter = 0; iter < 20000; ++iter) {
+      size_t i = rng() % num_timers;
+      TWheel::TTimer &timer = *timers[i];
+
+      switch (rng() % 4) {
+        case 0:
+        case 1: {
+          /* Mostly short delays, with occasional long ones that land in
+             higher levels of the wheel. */
+          TMsg::TTimestamp delay = (rng() % 8) ?
+              static_cast<TMsg::TTimestamp>(rng() % 300) :
+              static_cast<TMsg::TTimestamp>(rng() % 100000000);
+          wheel.Set(timer, now + delay - 10);
+          expected[i] = now + delay - 10;
+          break;
+        }
+        case 2: {
+          wheel.Cancel(timer);
+          expected.erase(i);
+          break;
+        }
+        default: {
+          now += static_cast<TMsg::TTimestamp>(rng() % 100);
+
+          if ((rng() % 50) == 0) {
+            now += static_cast<TMsg::TTimestamp>(rng() % 10000000);
+          }
+
+          std::vector<size_t> fired = Advance(wheel, now);
+          TMsg::TTimestamp prev = 0;
+
+          for (size_t index : fired) {
+            auto pos = expected.find(index);
+            ASSERT_TRUE(pos != expected.end());
+            ASSERT_LE(pos->second, now);
+            ASSERT_GE(pos->second, prev);
+            prev = pos->second;
+            expected.erase(pos);
+          }
+
+          for (const auto &item : expected) {
+            ASSERT_GT(item.second, now);
+          }
+
+          break;
+        }
+      }
+
+      ASSERT_EQ(wheel.Size(), expected.size());
+      std::optional<TMsg::TTimestamp> expected_next;
+
+      for (const auto &item : expected) {
+        if (!expected_next || (item.second < *expected_next)) {
+          expected_next = item.second;
+        }
+      }
+
+      ASSERT_EQ(wheel.GetNextExpiry(), expected_next);
+    }
+
+    ASSERT_TRUE(wheel.SanityCheck());
+
+    for (auto &timer : timers) {
+      wheel.Cancel(*timer);
+    }
+
+    ASSERT_TRUE(wheel.IsEmpty());
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,281 @@
+/* <dory/binary_discard_log.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/binary_discard_log.h>.
+ */
+
+#include <dory/binary_discard_log.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include <base/field_access.h>
+#include <base/io_util.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::BinaryDiscardLog;
+
+/* Size of fixed-length part of entry record body, not including type. */
+static const size_t ENTRY_FIXED_SIZE = 8 + 8 + 1 + 1 + 1 + 4 + 4 + 4 + 4 + 4 +
+    4 + 4;
+
+static const size_t READ_CHUNK_SIZE = 1024 * 1024;
+
+static void AppendUint8(std::string &out, uint8_t value) {
+  out.push_back(static_cast<char>(value));
+}
+
+static void AppendUint32(std::string &out, uint32_t value) {
+  char buf[4];
+  WriteUint32ToHeader(buf, value);
+  out.append(buf, sizeof(buf));
+}
+
+static void AppendUint64(std::string &out, uint64_t value) {
+  char buf[8];
+  WriteUint64ToHeader(buf, value);
+  out.append(buf, sizeof(buf));
+}
+
+static void AppendBytes(std::string &out, const std::vector<uint8_t> &bytes) {
+  AppendUint32(out, static_cast<uint32_t>(bytes.size()));
+
+  if (!bytes.empty()) {
+    out.append(reinterpret_cast<const char *>(&bytes[0]), bytes.size());
+  }
+}
+
+void TBinaryDiscardLogEncoder::StartFile(std::string &out) {
+  TopicIds.clear();
+  char buf[FILE_HEADER_SIZE];
+  WriteUint32ToHeader(&buf[0], MAGIC);
+  WriteUint16ToHeader(&buf[4], VERSION);
+  WriteUint16ToHeader(&buf[6], 0);
+  out.append(buf, sizeof(buf));
+}
+
+void TBinaryDiscardLogEncoder::Encode(const TDiscardLogEntry &entry,
+    std::string &out) {
+  uint32_t topic_id = NO_TOPIC_ID;
+
+  if (!entry.Topic.empty()) {
+    auto iter = TopicIds.find(entry.Topic);
+
+    if (iter == TopicIds.end()) {
+      topic_id = static_cast<uint32_t>(TopicIds.size());
+      TopicIds.insert(std::make_pair(entry.Topic, topic_id));
+      AppendUint32(out, static_cast<uint32_t>(1 + 4 + entry.Topic.size()));
+      AppendUint8(out, TOPIC_DEF_RECORD);
+      AppendUint32(out, topic_id);
+      out += entry.Topic;
+    } else {
+      topic_id = iter->second;
+    }
+  }
+
+  AppendUint32(out, static_cast<uint32_t>(1 + ENTRY_FIXED_SIZE +
+      entry.Key.size() + entry.Value.size()));
+  AppendUint8(out, ENTRY_RECORD);
+  AppendUint64(out, entry.Now);
+  AppendUint64(out, static_cast<uint64_t>(entry.Timestamp));
+  AppendUint8(out, static_cast<uint8_t>(entry.Event));
+  AppendUint8(out, static_cast<uint8_t>(entry.Info));
+  AppendUint8(out, static_cast<uint8_t>(
+      (entry.HasInfoArg ? FLAG_INFO_ARG : 0) |
+      (entry.HasPartitionKey ? FLAG_PARTITION_KEY : 0)));
+  AppendUint32(out, static_cast<uint32_t>(entry.InfoArg));
+  AppendUint32(out, topic_id);
+  AppendUint32(out, static_cast<uint32_t>(entry.PartitionKey));
+  AppendUint32(out, static_cast<uint32_t>(entry.KeySize));
+  AppendBytes(out, entry.Key);
+  AppendUint32(out, static_cast<uint32_t>(entry.ValueSize));
+  AppendBytes(out, entry.Value);
+}
+
+/* Read a key or value from the entry record at 'pos', and advance 'pos'. */
+static void ReadKeyOrValue(const uint8_t *&pos, const uint8_t *end,
+    size_t &orig_size, std::vector<uint8_t> &bytes) {
+  if ((end - pos) < 8) {
+    THROW_ERROR(TBinaryDiscardLogReader::TBadDiscardLog)
+        << "Entry record too short";
+  }
+
+  orig_size = ReadUint32FromHeader(pos);
+  pos += 4;
+  const size_t len = ReadUint32FromHeader(pos);
+  pos += 4;
+
+  if ((static_cast<size_t>(end - pos) < len) || (len > orig_size)) {
+    THROW_ERROR(TBinaryDiscardLogReader::TBadDiscardLog)
+        << "Invalid key or value length";
+  }
+
+  bytes.assign(pos, pos + len);
+  pos += len;
+}
+
+TBinaryDiscardLogReader::TBinaryDiscardLogReader(int fd)
+    : Fd(fd) {
+  assert(fd >= 0);
+}
+
+bool TBinaryDiscardLogReader::Read(TDiscardLogEntry &entry) {
+  if (!HeaderRead && !ReadFileHeader()) {
+    return false;
+  }
+
+  for (; ; ) {
+    if (!Fill(4)) {
+      if (Begin == End) {
+        return false;
+      }
+
+      THROW_ERROR(TBadDiscardLog) << "File ends inside record size";
+    }
+
+    const size_t size = ReadUint32FromHeader(&Buf[Begin]);
+
+    if (size == 0) {
+      THROW_ERROR(TBadDiscardLog) << "Empty record";
+    }
+
+    if (!Fill(4 + size)) {
+      THROW_ERROR(TBadDiscardLog) << "File ends inside record";
+    }
+
+    const uint8_t *pos = &Buf[Begin + 4];
+    const uint8_t *const end = pos + size;
+    Begin += 4 + size;
+    const uint8_t type = *pos++;
+
+    if (type == TOPIC_DEF_RECORD) {
+      if ((end - pos) < 4) {
+        THROW_ERROR(TBadDiscardLog) << "Topic definition too short";
+      }
+
+      if (ReadUint32FromHeader(pos) != Topics.size()) {
+        THROW_ERROR(TBadDiscardLog) << "Topic ID out of sequence";
+      }
+
+      pos += 4;
+      Topics.emplace_back(reinterpret_cast<const char *>(pos),
+          reinterpret_cast<const char *>(end));
+      continue;
+    }
+
+    if (type != ENTRY_RECORD) {
+      THROW_ERROR(TBadDiscardLog) << "Unknown record type "
+          << static_cast<unsigned>(type);
+    }
+
+    if (static_cast<size_t>(end - pos) < ENTRY_FIXED_SIZE) {
+      THROW_ERROR(TBadDiscardLog) << "Entry record too short";
+    }
+
+    entry.Now = ReadUint64FromHeader(pos);
+    pos += 8;
+    entry.Timestamp = ReadInt64FromHeader(pos);
+    pos += 8;
+    const uint8_t event = *pos++;
+    const uint8_t info = *pos++;
+
+    if ((event > static_cast<uint8_t>(TDiscardLogEvent::Duplicate)) ||
+        (info > MAX_DISCARD_LOG_INFO)) {
+      THROW_ERROR(TBadDiscardLog) << "Invalid event or info code";
+    }
+
+    entry.Event = static_cast<TDiscardLogEvent>(event);
+    entry.Info = static_cast<TDiscardLogInfo>(info);
+    const uint8_t flags = *pos++;
+    entry.HasInfoArg = ((flags & FLAG_INFO_ARG) != 0);
+    entry.InfoArg = ReadInt32FromHeader(pos);
+    pos += 4;
+    const uint32_t topic_id = ReadUint32FromHeader(pos);
+    pos += 4;
+
+    if (topic_id == NO_TOPIC_ID) {
+      entry.Topic.clear();
+    } else if (topic_id < Topics.size()) {
+      entry.Topic = Topics[topic_id];
+    } else {
+      THROW_ERROR(TBadDiscardLog) << "Undefined topic ID " << topic_id;
+    }
+
+    entry.HasPartitionKey = ((flags & FLAG_PARTITION_KEY) != 0);
+    entry.PartitionKey = ReadInt32FromHeader(pos);
+    pos += 4;
+
+    ReadKeyOrValue(pos, end, entry.KeySize, entry.Key);
+    ReadKeyOrValue(pos, end, entry.ValueSize, entry.Value);
+
+    if (pos != end) {
+      THROW_ERROR(TBadDiscardLog) << "Entry record has trailing bytes";
+    }
+
+    return true;
+  }
+}
+
+bool TBinaryDiscardLogReader::Fill(size_t size) {
+  while ((End - Begin) < size) {
+    if (Begin) {
+      /* Move unread data to front of buffer. */
+      std::memmove(&Buf[0], &Buf[Begin], End - Begin);
+      End -= Begin;
+      Begin = 0;
+    }
+
+    if (Buf.size() < std::max(size, READ_CHUNK_SIZE)) {
+      Buf.resize(std::max(size, READ_CHUNK_SIZE));
+    }
+
+    const size_t nbytes = ReadAtMost(Fd, &Buf[End], Buf.size() - End);
+
+    if (nbytes == 0) {
+      return false;
+    }
+
+    End += nbytes;
+  }
+
+  return true;
+}
+
+bool TBinaryDiscardLogReader::ReadFileHeader() {
+  if (!Fill(FILE_HEADER_SIZE)) {
+    if (Begin == End) {
+      return false;
+    }
+
+    THROW_ERROR(TBadDiscardLog) << "File too short for header";
+  }
+
+  if (ReadUint32FromHeader(&Buf[Begin]) != MAGIC) {
+    THROW_ERROR(TBadDiscardLog) << "Bad magic number";
+  }
+
+  if (ReadUint16FromHeader(&Buf[Begin + 4]) != VERSION) {
+    THROW_ERROR(TBadDiscardLog) << "Unsupported version";
+  }
+
+  Begin += FILE_HEADER_SIZE;
+  HeaderRead = true;
+  return true;
+}
@@ -0,0 +1,155 @@
+/* <dory/binary_discard_log.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Compact binary format for discard logfiles.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <base/thrower.h>
+#include <dory/discard_log_entry.h>
+
+namespace Dory {
+
+  /* A binary discard logfile starts with a header:
+
+         magic (4 bytes): 0x44444c42 ("DDLB")
+         version (2 bytes): 1
+         reserved (2 bytes): 0
+
+     followed by records.  Each record is:
+
+         size (4 bytes): number of bytes in record after this field
+         type (1 byte): 0 for topic definition, 1 for entry
+
+     and then, for a topic definition:
+
+         topic ID (4 bytes): IDs are assigned in order starting at 0
+         topic (remaining bytes)
+
+     or, for an entry:
+
+         now (8 bytes): epoch milliseconds when entry was logged
+         timestamp (8 bytes): message timestamp
+         event (1 byte): TDiscardLogEvent
+         info (1 byte): TDiscardLogInfo
+         flags (1 byte): bit 0 set if info arg is present, bit 1 set if
+             partition key is present
+         info arg (4 bytes)
+         topic ID (4 bytes): NO_TOPIC_ID if no topic
+         partition key (4 bytes)
+         key size before truncation (4 bytes)
+         key length (4 bytes)
+         key (key length bytes)
+         value size before truncation (4 bytes)
+         value length (4 bytes)
+         value (value length bytes)
+
+     All integers are big endian.  A topic is defined in each file before the
+     first entry that refers to it, so each file can be read on its own. */
+  namespace BinaryDiscardLog {
+
+    const uint32_t MAGIC = 0x44444c42;
+
+    const uint16_t VERSION = 1;
+
+    const size_t FILE_HEADER_SIZE = 8;
+
+    const uint8_t TOPIC_DEF_RECORD = 0;
+
+    const uint8_t ENTRY_RECORD = 1;
+
+    const uint32_t NO_TOPIC_ID = 0xffffffff;
+
+    const uint8_t FLAG_INFO_ARG = 1;
+
+    const uint8_t FLAG_PARTITION_KEY = 2;
+
+  }  // BinaryDiscardLog
+
+  /* Encodes entries for a binary discard logfile. */
+  class TBinaryDiscardLogEncoder final {
+    NO_COPY_SEMANTICS(TBinaryDiscardLogEncoder);
+
+    public:
+    TBinaryDiscardLogEncoder() = default;
+
+    /* Forget all topic definitions, and append a file header to 'out'.  Call
+       this at the start of each file. */
+    void StartFile(std::string &out);
+
+    /* Append a record for 'entry' to 'out', preceded by a definition of its
+       topic if this is the first entry in the file with that topic. */
+    void Encode(const TDiscardLogEntry &entry, std::string &out);
+
+    private:
+    /* Keys are topics, and values are topic IDs. */
+    std::unordered_map<std::string, uint32_t> TopicIds;
+  };  // TBinaryDiscardLogEncoder
+
+  /* Reads entries from a binary discard logfile. */
+  class TBinaryDiscardLogReader final {
+    NO_COPY_SEMANTICS(TBinaryDiscardLogReader);
+
+    public:
+    DEFINE_ERROR(TBadDiscardLog, std::runtime_error,
+                 "Invalid binary discard logfile");
+
+    /* 'fd' is the open logfile, which the caller continues to own. */
+    explicit TBinaryDiscardLogReader(int fd);
+
+    /* Read the next entry into 'entry', skipping topic definitions.  Return
+       false at the end of the file.  An empty file has no entries.  Throws
+       TBadDiscardLog if the file is invalid or ends in the middle of a
+       record, which may happen if dory was writing the file when it was
+       copied. */
+    bool Read(TDiscardLogEntry &entry);
+
+    private:
+    /* Try to make at least 'size' unread bytes available in 'Buf'.  Return
+       false if the file ends first. */
+    bool Fill(size_t size);
+
+    /* Return false if the file is empty, which happens when dory has created
+       a logfile but not yet written to it. */
+    bool ReadFileHeader();
+
+    const int Fd;
+
+    std::vector<uint8_t> Buf;
+
+    /* Unread data is in 'Buf' at [Begin, End). */
+    size_t Begin = 0;
+
+    size_t End = 0;
+
+    bool HeaderRead = false;
+
+    /* Index is topic ID. */
+    std::vector<std::string> Topics;
+  };  // TBinaryDiscardLogReader
+
+}  // Dory
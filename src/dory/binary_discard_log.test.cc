@@ -0,0 +1,170 @@
+/* <dory/binary_discard_log.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/binary_discard_log.h>.
+ */
+
+#include <dory/binary_discard_log.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <base/io_util.h>
+#include <base/tmp_file.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing binary discard logfiles. */
+  class TBinaryDiscardLogTest : public ::testing::Test {
+    protected:
+    TBinaryDiscardLogTest() = default;
+
+    ~TBinaryDiscardLogTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TBinaryDiscardLogTest
+
+  TDiscardLogEntry MakeEntry(const std::string &topic, const char *key,
+      const char *value) {
+    TDiscardLogEntry entry;
+    entry.Now = 1000;
+    entry.Timestamp = 2000;
+    entry.Event = TDiscardLogEvent::Discard;
+    entry.Info = TDiscardLogInfo::KafkaErrorAck;
+    entry.Topic = topic;
+    entry.Key.assign(key, key + std::strlen(key));
+    entry.KeySize = entry.Key.size();
+    entry.Value.assign(value, value + std::strlen(value));
+    entry.ValueSize = entry.Value.size();
+    return entry;
+  }
+
+  void WriteFile(const TTmpFile &file, const std::string &contents) {
+    WriteExactly(file.GetFd(), contents.data(), contents.size());
+    lseek(file.GetFd(), 0, SEEK_SET);
+  }
+
+  TEST_F(TBinaryDiscardLogTest, RoundTrip) {
+    std::vector<TDiscardLogEntry> in;
+    in.push_back(MakeEntry("t1", "k1", "v1"));
+    in.push_back(MakeEntry("t2", "", "v2"));
+    in.push_back(MakeEntry("t1", "k3", std::string(1000, 'x').c_str()));
+    in.push_back(MakeEntry("", "", ""));
+    in[1].Event = TDiscardLogEvent::Duplicate;
+    in[1].Info = TDiscardLogInfo::None;
+    in[2].ValueSize = 5000;
+    in[2].Timestamp = -1;
+    in[3].Info = TDiscardLogInfo::ApiKey;
+    in[3].HasInfoArg = true;
+    in[3].InfoArg = -7;
+    in[0].HasPartitionKey = true;
+    in[0].PartitionKey = -12345;
+    TBinaryDiscardLogEncoder encoder;
+    std::string contents;
+    encoder.StartFile(contents);
+
+    for (const auto &entry : in) {
+      encoder.Encode(entry, contents);
+    }
+
+    TTmpFile file("/tmp/binary_discard_log_test.XXXXXX", true);
+    WriteFile(file, contents);
+    TBinaryDiscardLogReader reader(file.GetFd());
+    TDiscardLogEntry out;
+
+    for (const auto &entry : in) {
+      ASSERT_TRUE(reader.Read(out));
+      ASSERT_EQ(out.Now, entry.Now);
+      ASSERT_EQ(out.Timestamp, entry.Timestamp);
+      ASSERT_EQ(out.Event, entry.Event);
+      ASSERT_EQ(out.Info, entry.Info);
+      ASSERT_EQ(out.HasInfoArg, entry.HasInfoArg);
+      ASSERT_EQ(out.InfoArg, entry.InfoArg);
+      ASSERT_EQ(out.Topic, entry.Topic);
+      ASSERT_EQ(out.HasPartitionKey, entry.HasPartitionKey);
+      ASSERT_EQ(out.PartitionKey, entry.PartitionKey);
+      ASSERT_EQ(out.Key, entry.Key);
+      ASSERT_EQ(out.KeySize, entry.KeySize);
+      ASSERT_EQ(out.Value, entry.Value);
+      ASSERT_EQ(out.ValueSize, entry.ValueSize);
+      ASSERT_EQ(out.IsTruncated(), entry.IsTruncated());
+    }
+
+    ASSERT_TRUE(in[2].IsTruncated());
+    ASSERT_FALSE(reader.Read(out));
+
+    /* Text rendering of a decoded entry matches the text logfile format. */
+    std::string text;
+    AppendDiscardLogText(in[3], text);
+    ASSERT_EQ(text, "now: 1000 ts: 2000 event: DISC info: API_KEY(-7) "
+        "topic: 0[] key: 0[] msg: 0[]\n");
+  }
+
+  TEST_F(TBinaryDiscardLogTest, EmptyFile) {
+    TTmpFile file("/tmp/binary_discard_log_test.XXXXXX", true);
+    TBinaryDiscardLogReader reader(file.GetFd());
+    TDiscardLogEntry entry;
+    ASSERT_FALSE(reader.Read(entry));
+  }
+
+  TEST_F(TBinaryDiscardLogTest, BadMagic) {
+    TTmpFile file("/tmp/binary_discard_log_test.XXXXXX", true);
+    WriteFile(file, "now: 1000 ts: 2000 event: DISC\n");
+    TBinaryDiscardLogReader reader(file.GetFd());
+    TDiscardLogEntry entry;
+    ASSERT_THROW(reader.Read(entry), TBinaryDiscardLogReader::TBadDiscardLog);
+  }
+
+  TEST_F(TBinaryDiscardLogTest, TruncatedFile) {
+    TBinaryDiscardLogEncoder encoder;
+    std::string contents;
+    encoder.StartFile(contents);
+    encoder.Encode(MakeEntry("topic", "key", "value"), contents);
+    encoder.Encode(MakeEntry("topic", "key", "value"), contents);
+    contents.resize(contents.size() - 1);
+    TTmpFile file("/tmp/binary_discard_log_test.XXXXXX", true);
+    WriteFile(file, contents);
+    TBinaryDiscardLogReader reader(file.GetFd());
+    TDiscardLogEntry entry;
+    ASSERT_TRUE(reader.Read(entry));
+    ASSERT_EQ(entry.Topic, "topic");
+    ASSERT_THROW(reader.Read(entry), TBinaryDiscardLogReader::TBadDiscardLog);
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
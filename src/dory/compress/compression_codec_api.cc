@@ -21,6 +21,9 @@
 
 #include <dory/compress/compression_codec_api.h>
 
+#include <algorithm>
+#include <cassert>
+
 using namespace Dory;
 using namespace Dory::Compress;
 
@@ -28,3 +31,61 @@ int TCompressionCodecApi::CompressionLevelParam(
     std::optional<int> requested_level) const noexcept {
   return GetRealCompressionLevel(requested_level).value_or(0);
 }
+
+/* Minimum amount by which a stream compressor's output buffer grows.  The
+   buffer otherwise roughly doubles in size each time it grows. */
+static const size_t MIN_OUTPUT_GROWTH = 4096;
+
+void TCompressionCodecApi::TStreamCompressor::Begin(std::vector<uint8_t> &dst,
+    size_t uncompressed_size, std::optional<int> compression_level) {
+  Dst = &dst;
+  StartOffset = dst.size();
+  OutputSize = 0;
+  DoBegin(uncompressed_size, Codec.CompressionLevelParam(compression_level));
+}
+
+void TCompressionCodecApi::TStreamCompressor::Write(const void *data,
+    size_t size) {
+  assert(Dst);
+
+  if (size) {
+    DoWrite(data, size);
+  }
+}
+
+size_t TCompressionCodecApi::TStreamCompressor::Finish() {
+  assert(Dst);
+  DoFinish();
+  Dst->resize(StartOffset + OutputSize);
+  Dst = nullptr;
+  return OutputSize;
+}
+
+void TCompressionCodecApi::TStreamCompressor::Abort() noexcept {
+  if (Dst) {
+    Dst->resize(StartOffset);
+    Dst = nullptr;
+  }
+}
+
+uint8_t *TCompressionCodecApi::TStreamCompressor::GetOutputSpace(
+    size_t min_size, size_t &size) {
+  assert(Dst);
+  const size_t used = StartOffset + OutputSize;
+  assert(Dst->size() >= used);
+
+  if ((Dst->size() - used) < min_size) {
+    Dst->resize(used +
+        std::max(min_size, std::max(OutputSize, MIN_OUTPUT_GROWTH)));
+  }
+
+  size = Dst->size() - used;
+  return &(*Dst)[used];
+}
+
+void TCompressionCodecApi::TStreamCompressor::CommitOutput(
+    size_t size) noexcept {
+  assert(Dst);
+  assert((Dst->size() - StartOffset - OutputSize) >= size);
+  OutputSize += size;
+}
@@ -22,8 +22,11 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <stdexcept>
+#include <vector>
 
 #include <base/no_copy_semantics.h>
 
@@ -48,6 +51,76 @@ namespace Dory {
         }
       };  // TError
 
+      /* Incremental compressor for data that isn't available in a single
+         contiguous buffer.  Compressed output is appended directly to a
+         caller-supplied buffer, which grows as needed, so the caller needn't
+         gather the uncompressed data into a separate buffer first or reserve
+         worst-case space for the output.  Unlike codecs, stream compressors
+         have state, so a single instance must not be used concurrently by
+         multiple threads.  An instance may be reused for any number of
+         streams. */
+      class TStreamCompressor {
+        NO_COPY_SEMANTICS(TStreamCompressor);
+
+        public:
+        virtual ~TStreamCompressor() = default;
+
+        /* Start compressing a stream of exactly 'uncompressed_size' bytes,
+           appending the compressed result to 'dst'.  The caller must not
+           modify 'dst' until Finish() or Abort() has been called.  Parameter
+           'compression_level' is an optional requested compression level.
+           Throw TError on error. */
+        void Begin(std::vector<uint8_t> &dst, size_t uncompressed_size,
+            std::optional<int> compression_level);
+
+        /* Compress the next 'size' bytes of the stream.  Throw TError on
+           error. */
+        void Write(const void *data, size_t size);
+
+        /* Finish the stream and return the size in bytes of the compressed
+           result, which occupies the end of 'dst'.  Throw TError on error. */
+        size_t Finish();
+
+        /* Abandon the stream, restoring 'dst' to its size before Begin() was
+           called. */
+        void Abort() noexcept;
+
+        protected:
+        explicit TStreamCompressor(const TCompressionCodecApi &codec) noexcept
+            : Codec(codec) {
+        }
+
+        /* Return a pointer to at least 'min_size' bytes of unused space at
+           the end of the output buffer, growing it if necessary.  On return,
+           'size' gives the total amount of unused space available. */
+        uint8_t *GetOutputSpace(size_t min_size, size_t &size);
+
+        /* Record that 'size' bytes of compressed output were written to the
+           space obtained from GetOutputSpace(). */
+        void CommitOutput(size_t size) noexcept;
+
+        /* Note: If the algorithm supports compression levels, then
+           'compression_level' is guaranteed to be a value that it considers
+           valid.  Otherwise, 'compression_level' will be 0. */
+        virtual void DoBegin(size_t uncompressed_size,
+            int compression_level) = 0;
+
+        virtual void DoWrite(const void *data, size_t size) = 0;
+
+        virtual void DoFinish() = 0;
+
+        private:
+        const TCompressionCodecApi &Codec;
+
+        std::vector<uint8_t> *Dst = nullptr;
+
+        /* Offset in 'Dst' where the compressed output begins. */
+        size_t StartOffset = 0;
+
+        /* Number of compressed bytes written so far. */
+        size_t OutputSize = 0;
+      };  // TStreamCompressor
+
       virtual ~TCompressionCodecApi() = default;
 
       /* Parameter 'requested_level' is a compression level requested by the
@@ -69,6 +142,12 @@ namespace Dory {
       virtual std::optional<int> GetRealCompressionLevel(
           std::optional<int> requested_level) const noexcept = 0;
 
+      /* If the algorithm supports compression levels, return the level that
+         compresses fastest while still doing some compression.  Otherwise
+         return an empty result. */
+      virtual std::optional<int> GetFastestCompressionLevel() const noexcept
+          = 0;
+
       /* Return true if the algorithm supports compression levels, or false
          otherwise. */
       bool SupportsCompressionLevels() const noexcept {
@@ -100,6 +179,13 @@ namespace Dory {
             output_buf_size, CompressionLevelParam(compression_level));
       }
 
+      /* Return a new stream compressor for this algorithm, or null if the
+         algorithm doesn't support streaming.  Throw TError on error. */
+      virtual std::unique_ptr<TStreamCompressor>
+      CreateStreamCompressor() const {
+        return nullptr;
+      }
+
       /* Return the maximum uncompressed size in bytes of 'compressed_size'
          bytes of data in buffer 'compressed_data'.  Throw TError on error. */
       virtual size_t ComputeUncompressedResultBufSpace(
@@ -36,6 +36,8 @@ void Dory::Compress::CompressionInit() {
   /* Force all supported compression libraries that we access using dlopen()
      and dlsym() to load.  We dynamically link to zlib at build time
      (i.e. -lz), and we statically link to the lz4 library, so they don't
-     appear here.  This will throw if there is an error loading a library. */
+     appear here.  This will throw if there is an error loading a library.
+     The zstd library is omitted since the mock Kafka server only speaks
+     produce API version 0, which doesn't support zstd. */
   TSnappyCodec::The();
 }
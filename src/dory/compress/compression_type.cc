@@ -40,6 +40,9 @@ const char *Dory::Compress::ToString(TCompressionType type) noexcept {
     case TCompressionType::Lz4: {
       return "lz4";
     }
+    case TCompressionType::Zstd: {
+      return "zstd";
+    }
     NO_DEFAULT_CASE;
   }
 
@@ -29,7 +29,8 @@ namespace Dory {
       None,
       Gzip,
       Snappy,
-      Lz4
+      Lz4,
+      Zstd
     };  // TCompressionType
 
     const char *ToString(TCompressionType type) noexcept;
@@ -25,12 +25,14 @@
 #include <dory/compress/gzip/gzip_codec.h>
 #include <dory/compress/lz4/lz4_codec.h>
 #include <dory/compress/snappy/snappy_codec.h>
+#include <dory/compress/zstd/zstd_codec.h>
 
 using namespace Dory;
 using namespace Dory::Compress;
 using namespace Dory::Compress::Gzip;
 using namespace Dory::Compress::Lz4;
 using namespace Dory::Compress::Snappy;
+using namespace Dory::Compress::Zstd;
 
 const TCompressionCodecApi *
 Dory::Compress::GetCompressionCodec(TCompressionType type) {
@@ -43,6 +45,8 @@ Dory::Compress::GetCompressionCodec(TCompressionType type) {
       return &TLz4Codec::The();
     case TCompressionType::Snappy:
       return &TSnappyCodec::The();
+    case TCompressionType::Zstd:
+      return &TZstdCodec::The();
     NO_DEFAULT_CASE;
   }
 
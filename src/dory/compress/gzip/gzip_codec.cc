@@ -21,8 +21,10 @@
 
 #include <dory/compress/gzip/gzip_codec.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <new>
@@ -143,6 +145,10 @@ std::optional<int> TGzipCodec::GetRealCompressionLevel(
       requested : DEFAULT_LEVEL;
 }
 
+std::optional<int> TGzipCodec::GetFastestCompressionLevel() const noexcept {
+  return Z_BEST_SPEED;
+}
+
 static size_t DoUncompress(const void *compressed_data, size_t compressed_size,
     void *output_buf, size_t output_buf_size, bool preserve_output) {
   z_stream strm;
@@ -252,6 +258,117 @@ namespace {
 
 }  // namespace
 
+namespace {
+
+  /* Stream compressor for gzip.  The zlib stream is initialized on first use
+     and then reset for each subsequent stream, unless the compression level
+     changes. */
+  class TGzipStreamCompressor final
+      : public TCompressionCodecApi::TStreamCompressor {
+    NO_COPY_SEMANTICS(TGzipStreamCompressor);
+
+    public:
+    explicit TGzipStreamCompressor(const TGzipCodec &codec) noexcept
+        : TStreamCompressor(codec) {
+      std::memset(&Strm, 0, sizeof(Strm));
+    }
+
+    ~TGzipStreamCompressor() override {
+      if (Initialized) {
+        deflateEnd(&Strm);
+      }
+    }
+
+    protected:
+    void DoBegin(size_t uncompressed_size, int compression_level) override;
+
+    void DoWrite(const void *data, size_t size) override;
+
+    void DoFinish() override;
+
+    private:
+    /* Minimum amount of output space to offer zlib for each call to
+       deflate(). */
+    static const size_t MIN_OUTPUT_SPACE = 1024;
+
+    int Deflate(int flush);
+
+    z_stream Strm;
+
+    bool Initialized = false;
+
+    int Level = 0;
+  };  // TGzipStreamCompressor
+
+}  // namespace
+
+void TGzipStreamCompressor::DoBegin(size_t /*uncompressed_size*/,
+    int compression_level) {
+  if (Initialized && (compression_level == Level)) {
+    CheckStatus(deflateReset(&Strm), Strm, "deflateReset");
+    return;
+  }
+
+  if (Initialized) {
+    deflateEnd(&Strm);
+    Initialized = false;
+  }
+
+  std::memset(&Strm, 0, sizeof(Strm));
+  CheckStatus(deflateInit2(&Strm, compression_level, Z_DEFLATED, 15 + 16, 8,
+      Z_DEFAULT_STRATEGY), Strm, "deflateInit2");
+  Initialized = true;
+  Level = compression_level;
+}
+
+void TGzipStreamCompressor::DoWrite(const void *data, size_t size) {
+  assert(Initialized);
+  const auto *pos = reinterpret_cast<const uint8_t *>(data);
+
+  while (size) {
+    /* The input size is limited by the width of zlib's size fields. */
+    auto chunk_size = static_cast<uInt>(std::min<size_t>(size,
+        std::numeric_limits<uInt>::max()));
+    Strm.next_in = const_cast<Bytef *>(pos);
+    Strm.avail_in = chunk_size;
+
+    while (Strm.avail_in) {
+      Deflate(Z_NO_FLUSH);
+    }
+
+    pos += chunk_size;
+    size -= chunk_size;
+  }
+}
+
+void TGzipStreamCompressor::DoFinish() {
+  assert(Initialized);
+  Strm.next_in = nullptr;
+  Strm.avail_in = 0;
+
+  while (Deflate(Z_FINISH) != Z_STREAM_END) {
+  }
+
+  ZlibCompressSuccess.Increment();
+}
+
+int TGzipStreamCompressor::Deflate(int flush) {
+  size_t space = 0;
+  uint8_t *out = GetOutputSpace(MIN_OUTPUT_SPACE, space);
+  auto avail = static_cast<uInt>(std::min<size_t>(space,
+      std::numeric_limits<uInt>::max()));
+  Strm.next_out = out;
+  Strm.avail_out = avail;
+  int status = CheckStatus(deflate(&Strm, flush), Strm, "deflate");
+  CommitOutput(avail - Strm.avail_out);
+  return status;
+}
+
+std::unique_ptr<TCompressionCodecApi::TStreamCompressor>
+TGzipCodec::CreateStreamCompressor() const {
+  return std::make_unique<TGzipStreamCompressor>(*this);
+}
+
 size_t TGzipCodec::DoComputeCompressedResultBufSpace(
     const void * /*uncompressed_data*/, size_t uncompressed_size,
     int compression_level) const {
@@ -22,6 +22,7 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
 #include <optional>
 
 #include <base/no_copy_semantics.h>
@@ -44,6 +45,12 @@ namespace Dory {
         std::optional<int> GetRealCompressionLevel(
             std::optional<int> requested_level) const noexcept override;
 
+        std::optional<int> GetFastestCompressionLevel() const noexcept
+            override;
+
+        std::unique_ptr<TStreamCompressor> CreateStreamCompressor() const
+            override;
+
         size_t ComputeUncompressedResultBufSpace(const void *compressed_data,
             size_t compressed_size) const override;
 
@@ -89,6 +89,11 @@ std::optional<int> TLz4Codec::GetRealCompressionLevel(
       requested : DEFAULT_LEVEL;
 }
 
+std::optional<int> TLz4Codec::GetFastestCompressionLevel() const noexcept {
+  /* Levels below 3 all select the fast (non-HC) compressor. */
+  return MIN_LEVEL;
+}
+
 size_t TLz4Codec::ComputeUncompressedResultBufSpace(
     const void *compressed_data, size_t compressed_size) const {
   LZ4F_decompressionContext_t dctx = nullptr;
@@ -283,3 +288,87 @@ size_t TLz4Codec::DoCompress(const void *input_buf, size_t input_buf_size,
   Lz4CompressSuccess.Increment();
   return compressed_size;
 }
+
+namespace {
+
+  /* Stream compressor for lz4.  The compression context is created once and
+     reused for each stream. */
+  class TLz4StreamCompressor final
+      : public TCompressionCodecApi::TStreamCompressor {
+    NO_COPY_SEMANTICS(TLz4StreamCompressor);
+
+    public:
+    explicit TLz4StreamCompressor(const TLz4Codec &codec)
+        : TStreamCompressor(codec) {
+      CheckLz4Status(LZ4F_createCompressionContext(&Cctx, LZ4F_VERSION),
+          "LZ4F_createCompressionContext");
+      assert(Cctx);
+      std::memset(&Prefs, 0, sizeof(Prefs));
+    }
+
+    ~TLz4StreamCompressor() override {
+      LZ4F_freeCompressionContext(Cctx);
+    }
+
+    protected:
+    void DoBegin(size_t uncompressed_size, int compression_level) override;
+
+    void DoWrite(const void *data, size_t size) override;
+
+    void DoFinish() override;
+
+    private:
+    LZ4F_compressionContext_t Cctx = nullptr;
+
+    LZ4F_preferences_t Prefs;
+  };  // TLz4StreamCompressor
+
+}  // namespace
+
+void TLz4StreamCompressor::DoBegin(size_t uncompressed_size,
+    int compression_level) {
+  assert((compression_level >= MIN_LEVEL) && (compression_level <= MAX_LEVEL));
+  std::memset(&Prefs, 0, sizeof(Prefs));
+  Prefs.compressionLevel = compression_level;
+  Prefs.frameInfo.blockMode = LZ4F_blockIndependent;
+
+  /* Same frame settings as TLz4Codec::DoCompress().  Recording the content
+     size also makes LZ4F_compressEnd() verify that the caller wrote exactly
+     the promised amount of data. */
+  Prefs.frameInfo.contentSize = uncompressed_size;
+  size_t space = 0;
+  uint8_t *out = GetOutputSpace(LZ4F_HEADER_SIZE_MAX, space);
+  size_t bytes_written = CheckLz4Status(
+      LZ4F_compressBegin(Cctx, out, space, &Prefs), "LZ4F_compressBegin");
+  CheckWriteBufferOverflow(bytes_written, space, "LZ4F_compressBegin");
+  CommitOutput(bytes_written);
+}
+
+void TLz4StreamCompressor::DoWrite(const void *data, size_t size) {
+  size_t space = 0;
+  uint8_t *out = GetOutputSpace(
+      CheckLz4Status(LZ4F_compressBound(size, &Prefs), "LZ4F_compressBound"),
+      space);
+  size_t bytes_written = CheckLz4Status(
+      LZ4F_compressUpdate(Cctx, out, space, data, size, nullptr),
+      "LZ4F_compressUpdate");
+  CheckWriteBufferOverflow(bytes_written, space, "LZ4F_compressUpdate");
+  CommitOutput(bytes_written);
+}
+
+void TLz4StreamCompressor::DoFinish() {
+  size_t space = 0;
+  uint8_t *out = GetOutputSpace(
+      CheckLz4Status(LZ4F_compressBound(0, &Prefs), "LZ4F_compressBound"),
+      space);
+  size_t bytes_written = CheckLz4Status(
+      LZ4F_compressEnd(Cctx, out, space, nullptr), "LZ4F_compressEnd");
+  CheckWriteBufferOverflow(bytes_written, space, "LZ4F_compressEnd");
+  CommitOutput(bytes_written);
+  Lz4CompressSuccess.Increment();
+}
+
+std::unique_ptr<TCompressionCodecApi::TStreamCompressor>
+TLz4Codec::CreateStreamCompressor() const {
+  return std::make_unique<TLz4StreamCompressor>(*this);
+}
@@ -21,6 +21,9 @@
 
 #include <dory/compress/lz4/lz4_codec.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <vector>
@@ -142,6 +145,54 @@ namespace {
     ASSERT_EQ(final_result, to_compress);
   }
 
+  TEST_F(TLz4CodecTest, StreamTest) {
+    const TLz4Codec &codec = TLz4Codec::The();
+    std::unique_ptr<TCompressionCodecApi::TStreamCompressor> stream =
+        codec.CreateStreamCompressor();
+    ASSERT_TRUE(stream != nullptr);
+    std::string to_compress;
+
+    for (size_t i = 0; i < 1024; ++i) {
+      to_compress += "a bunch of junk to compress";
+      to_compress += std::to_string(i);
+    }
+
+    const std::string prefix("prefix");
+
+    for (std::optional<int> level :
+        { std::optional<int>(), std::optional<int>(9) }) {
+      std::vector<uint8_t> dst(prefix.begin(), prefix.end());
+      stream->Begin(dst, to_compress.size(), level);
+
+      /* Feed the input in pieces of varying sizes. */
+      size_t offset = 0;
+
+      for (size_t chunk = 1; offset < to_compress.size(); chunk *= 3) {
+        size_t size = std::min(chunk, to_compress.size() - offset);
+        stream->Write(to_compress.data() + offset, size);
+        offset += size;
+      }
+
+      size_t result_size = stream->Finish();
+      ASSERT_EQ(dst.size(), prefix.size() + result_size);
+      ASSERT_LT(result_size, to_compress.size());
+      ASSERT_EQ(std::string(dst.begin(), dst.begin() + prefix.size()), prefix);
+      const uint8_t *compressed = &dst[prefix.size()];
+      std::vector<char> uncompressed_output(
+          codec.ComputeUncompressedResultBufSpace(compressed, result_size));
+      result_size = codec.Uncompress(compressed, result_size,
+          &uncompressed_output[0], uncompressed_output.size());
+      ASSERT_EQ(std::string(uncompressed_output.begin(),
+          uncompressed_output.begin() + result_size), to_compress);
+    }
+
+    std::vector<uint8_t> dst(prefix.begin(), prefix.end());
+    stream->Begin(dst, to_compress.size(), std::nullopt);
+    stream->Write(to_compress.data(), to_compress.size() / 2);
+    stream->Abort();
+    ASSERT_EQ(std::string(dst.begin(), dst.end()), prefix);
+  }
+
 }  // namespace
 
 int main(int argc, char **argv) {
@@ -95,6 +95,11 @@ std::optional<int> TSnappyCodec::GetRealCompressionLevel(
   return std::nullopt;
 }
 
+std::optional<int> TSnappyCodec::GetFastestCompressionLevel() const noexcept {
+  /* This algorithm does not support compression levels. */
+  return std::nullopt;
+}
+
 size_t TSnappyCodec::ComputeUncompressedResultBufSpace(
     const void *compressed_data, size_t compressed_size) const {
   size_t result = 0;
@@ -46,6 +46,9 @@ namespace Dory {
         std::optional<int> GetRealCompressionLevel(
             std::optional<int> requested_level) const noexcept override;
 
+        std::optional<int> GetFastestCompressionLevel() const noexcept
+            override;
+
         size_t ComputeUncompressedResultBufSpace(const void *compressed_data,
             size_t compressed_size) const override;
 
@@ -0,0 +1,68 @@
+/* <dory/compress/zstd/lib_zstd.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/compress/zstd/lib_zstd.h>.
+ */
+
+#include <dory/compress/zstd/lib_zstd.h>
+
+#include <dlfcn.h>
+
+using namespace Dory;
+using namespace Dory::Compress;
+using namespace Dory::Compress::Zstd;
+
+const TLibZstd *TLibZstd::The() {
+  if (!LoadAttempted) {
+    LoadAttempted = true;
+    Singleton.reset(new TLibZstd);  // throw on failure
+  }
+
+  return Singleton.get();
+}
+
+TLibZstd::TLibZstd()
+    : TDynamicLib(LibName, RTLD_LAZY),
+      fn_ZSTD_compress(LoadSym<t_fn_ZSTD_compress>("ZSTD_compress")),
+      fn_ZSTD_decompress(LoadSym<t_fn_ZSTD_decompress>("ZSTD_decompress")),
+      fn_ZSTD_getFrameContentSize(LoadSym<t_fn_ZSTD_getFrameContentSize>(
+          "ZSTD_getFrameContentSize")),
+      fn_ZSTD_compressBound(
+          LoadSym<t_fn_ZSTD_compressBound>("ZSTD_compressBound")),
+      fn_ZSTD_isError(LoadSym<t_fn_ZSTD_isError>("ZSTD_isError")),
+      fn_ZSTD_getErrorName(
+          LoadSym<t_fn_ZSTD_getErrorName>("ZSTD_getErrorName")),
+      fn_ZSTD_maxCLevel(LoadSym<t_fn_ZSTD_maxCLevel>("ZSTD_maxCLevel")),
+      fn_ZSTD_createCCtx(LoadSym<t_fn_ZSTD_createCCtx>("ZSTD_createCCtx")),
+      fn_ZSTD_freeCCtx(LoadSym<t_fn_ZSTD_freeCCtx>("ZSTD_freeCCtx")),
+      fn_ZSTD_CCtx_reset(LoadSym<t_fn_ZSTD_CCtx_reset>("ZSTD_CCtx_reset")),
+      fn_ZSTD_CCtx_setParameter(LoadSym<t_fn_ZSTD_CCtx_setParameter>(
+          "ZSTD_CCtx_setParameter")),
+      fn_ZSTD_CCtx_setPledgedSrcSize(LoadSym<t_fn_ZSTD_CCtx_setPledgedSrcSize>(
+          "ZSTD_CCtx_setPledgedSrcSize")),
+      fn_ZSTD_compressStream2(
+          LoadSym<t_fn_ZSTD_compressStream2>("ZSTD_compressStream2")),
+      fn_ZSTD_CStreamOutSize(
+          LoadSym<t_fn_ZSTD_CStreamOutSize>("ZSTD_CStreamOutSize")) {
+}
+
+const char TLibZstd::LibName[] = "libzstd.so.1";
+
+std::unique_ptr<const TLibZstd> TLibZstd::Singleton;
+
+bool TLibZstd::LoadAttempted = false;
@@ -0,0 +1,239 @@
+/* <dory/compress/zstd/lib_zstd.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Wrapper class for Zstandard compression library.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include <base/dynamic_lib.h>
+#include <base/no_copy_semantics.h>
+
+namespace Dory {
+
+  namespace Compress {
+
+    namespace Zstd {
+
+      /* Wrapper class for Zstandard compression library.  Constructor
+         dynamically loads library and the symbols for its C language API.
+         Only functions from the library's stable API are used, so we declare
+         their signatures here rather than depending on the library's
+         development headers at build time. */
+      class TLibZstd final : public Base::TDynamicLib {
+        NO_COPY_SEMANTICS(TLibZstd);
+
+        public:
+        /* Values returned by ZSTD_getFrameContentSize() when the content size
+           is not available. */
+        static const unsigned long long CONTENTSIZE_UNKNOWN = 0ULL - 1;
+
+        static const unsigned long long CONTENTSIZE_ERROR = 0ULL - 2;
+
+        /* Opaque compression context type (ZSTD_CCtx). */
+        struct TCCtx;
+
+        /* Same layout as ZSTD_inBuffer. */
+        struct TInBuffer {
+          const void *src;
+
+          size_t size;
+
+          size_t pos;
+        };  // TInBuffer
+
+        /* Same layout as ZSTD_outBuffer. */
+        struct TOutBuffer {
+          void *dst;
+
+          size_t size;
+
+          size_t pos;
+        };  // TOutBuffer
+
+        /* Values of ZSTD_EndDirective. */
+        static const int E_CONTINUE = 0;
+
+        static const int E_END = 2;
+
+        /* ZSTD_c_compressionLevel value of ZSTD_cParameter. */
+        static const int C_COMPRESSION_LEVEL = 100;
+
+        /* ZSTD_reset_session_only value of ZSTD_ResetDirective. */
+        static const int RESET_SESSION_ONLY = 1;
+
+        /* Singleton accessor.  On the first call, the behavior is as follows:
+
+               Attempt to load library and its symbols.  On failure, throw
+               TDynamicLib::TLibLoadError or TDynamicLib::TSymLoadError.  On
+               success, return a pointer to the newly constructed TLibZstd
+               singleton.
+
+           On subsequent calls, the behavior is as follows:
+
+               If the first call failed, return nullptr.  Otherwise, return a
+               pointer to the TLibZstd singleton.  In either case, the method
+               is guaranteed not to throw.
+         */
+        static const TLibZstd *The();
+
+        ~TLibZstd() override = default;
+
+        size_t ZSTD_compress(void *dst, size_t dst_capacity, const void *src,
+            size_t src_size, int compression_level) const {
+          return fn_ZSTD_compress(dst, dst_capacity, src, src_size,
+                                  compression_level);
+        }
+
+        size_t ZSTD_decompress(void *dst, size_t dst_capacity,
+            const void *src, size_t compressed_size) const {
+          return fn_ZSTD_decompress(dst, dst_capacity, src, compressed_size);
+        }
+
+        unsigned long long ZSTD_getFrameContentSize(const void *src,
+            size_t src_size) const {
+          return fn_ZSTD_getFrameContentSize(src, src_size);
+        }
+
+        size_t ZSTD_compressBound(size_t src_size) const {
+          return fn_ZSTD_compressBound(src_size);
+        }
+
+        unsigned ZSTD_isError(size_t code) const {
+          return fn_ZSTD_isError(code);
+        }
+
+        const char *ZSTD_getErrorName(size_t code) const {
+          return fn_ZSTD_getErrorName(code);
+        }
+
+        int ZSTD_maxCLevel() const {
+          return fn_ZSTD_maxCLevel();
+        }
+
+        TCCtx *ZSTD_createCCtx() const {
+          return fn_ZSTD_createCCtx();
+        }
+
+        size_t ZSTD_freeCCtx(TCCtx *cctx) const {
+          return fn_ZSTD_freeCCtx(cctx);
+        }
+
+        size_t ZSTD_CCtx_reset(TCCtx *cctx, int reset) const {
+          return fn_ZSTD_CCtx_reset(cctx, reset);
+        }
+
+        size_t ZSTD_CCtx_setParameter(TCCtx *cctx, int param,
+            int value) const {
+          return fn_ZSTD_CCtx_setParameter(cctx, param, value);
+        }
+
+        size_t ZSTD_CCtx_setPledgedSrcSize(TCCtx *cctx,
+            unsigned long long pledged_src_size) const {
+          return fn_ZSTD_CCtx_setPledgedSrcSize(cctx, pledged_src_size);
+        }
+
+        size_t ZSTD_compressStream2(TCCtx *cctx, TOutBuffer *output,
+            TInBuffer *input, int end_op) const {
+          return fn_ZSTD_compressStream2(cctx, output, input, end_op);
+        }
+
+        size_t ZSTD_CStreamOutSize() const {
+          return fn_ZSTD_CStreamOutSize();
+        }
+
+        private:
+        TLibZstd();  // called by singleton accessor
+
+        typedef size_t (*t_fn_ZSTD_compress)(void *dst, size_t dst_capacity,
+            const void *src, size_t src_size, int compression_level);
+
+        typedef size_t (*t_fn_ZSTD_decompress)(void *dst, size_t dst_capacity,
+            const void *src, size_t compressed_size);
+
+        typedef unsigned long long (*t_fn_ZSTD_getFrameContentSize)(
+            const void *src, size_t src_size);
+
+        typedef size_t (*t_fn_ZSTD_compressBound)(size_t src_size);
+
+        typedef unsigned (*t_fn_ZSTD_isError)(size_t code);
+
+        typedef const char *(*t_fn_ZSTD_getErrorName)(size_t code);
+
+        typedef int (*t_fn_ZSTD_maxCLevel)();
+
+        typedef TCCtx *(*t_fn_ZSTD_createCCtx)();
+
+        typedef size_t (*t_fn_ZSTD_freeCCtx)(TCCtx *cctx);
+
+        typedef size_t (*t_fn_ZSTD_CCtx_reset)(TCCtx *cctx, int reset);
+
+        typedef size_t (*t_fn_ZSTD_CCtx_setParameter)(TCCtx *cctx, int param,
+            int value);
+
+        typedef size_t (*t_fn_ZSTD_CCtx_setPledgedSrcSize)(TCCtx *cctx,
+            unsigned long long pledged_src_size);
+
+        typedef size_t (*t_fn_ZSTD_compressStream2)(TCCtx *cctx,
+            TOutBuffer *output, TInBuffer *input, int end_op);
+
+        typedef size_t (*t_fn_ZSTD_CStreamOutSize)();
+
+        static const char LibName[];
+
+        static std::unique_ptr<const TLibZstd> Singleton;
+
+        static bool LoadAttempted;
+
+        t_fn_ZSTD_compress fn_ZSTD_compress;
+
+        t_fn_ZSTD_decompress fn_ZSTD_decompress;
+
+        t_fn_ZSTD_getFrameContentSize fn_ZSTD_getFrameContentSize;
+
+        t_fn_ZSTD_compressBound fn_ZSTD_compressBound;
+
+        t_fn_ZSTD_isError fn_ZSTD_isError;
+
+        t_fn_ZSTD_getErrorName fn_ZSTD_getErrorName;
+
+        t_fn_ZSTD_maxCLevel fn_ZSTD_maxCLevel;
+
+        t_fn_ZSTD_createCCtx fn_ZSTD_createCCtx;
+
+        t_fn_ZSTD_freeCCtx fn_ZSTD_freeCCtx;
+
+        t_fn_ZSTD_CCtx_reset fn_ZSTD_CCtx_reset;
+
+        t_fn_ZSTD_CCtx_setParameter fn_ZSTD_CCtx_setParameter;
+
+        t_fn_ZSTD_CCtx_setPledgedSrcSize fn_ZSTD_CCtx_setPledgedSrcSize;
+
+        t_fn_ZSTD_compressStream2 fn_ZSTD_compressStream2;
+
+        t_fn_ZSTD_CStreamOutSize fn_ZSTD_CStreamOutSize;
+      };  // TLibZstd
+
+    }  // Zstd
+
+  }  // Compress
+
+}  // Dory
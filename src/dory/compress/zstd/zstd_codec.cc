@@ -0,0 +1,266 @@
+/* <dory/compress/zstd/zstd_codec.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/compress/zstd/zstd_codec.h>.
+ */
+
+#include <dory/compress/zstd/zstd_codec.h>
+
+#include <cassert>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+
+#include <base/counter.h>
+#include <base/error_util.h>
+#include <dory/compress/zstd/lib_zstd.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Compress;
+using namespace Dory::Compress::Zstd;
+
+DEFINE_COUNTER(ZstdCompressSuccess);
+DEFINE_COUNTER(ZstdError);
+
+static size_t CheckZstdStatus(const TLibZstd &lib, size_t status,
+    const char *zstd_function_name) {
+  assert(zstd_function_name);
+
+  if (lib.ZSTD_isError(status)) {
+    ZstdError.Increment();
+    std::string msg("Function ");
+    msg += zstd_function_name;
+    msg += " reported error: [";
+    msg += lib.ZSTD_getErrorName(status);
+    msg += "]";
+    throw TCompressionCodecApi::TError(msg.c_str());
+  }
+
+  return status;
+}
+
+static std::mutex SingletonInitMutex;
+
+static std::unique_ptr<const TZstdCodec> Singleton;
+
+const TZstdCodec &TZstdCodec::The() {
+  if (!Singleton) {
+    std::lock_guard<std::mutex> lock(SingletonInitMutex);
+
+    if (!Singleton) {
+      Singleton.reset(new TZstdCodec);
+    }
+  }
+
+  return *Singleton;
+}
+
+/* Same as the library's default (ZSTD_CLEVEL_DEFAULT) and the default used by
+   the Java Kafka client. */
+static const int DEFAULT_LEVEL = 3;
+
+static const int MIN_LEVEL = 1;
+
+std::optional<int> TZstdCodec::GetRealCompressionLevel(
+    std::optional<int> requested_level) const noexcept {
+  if (!requested_level.has_value()) {
+    return DEFAULT_LEVEL;
+  }
+
+  int requested = *requested_level;
+  return ((requested >= MIN_LEVEL) && (requested <= MaxLevel)) ?
+      requested : DEFAULT_LEVEL;
+}
+
+std::optional<int> TZstdCodec::GetFastestCompressionLevel() const noexcept {
+  return MIN_LEVEL;
+}
+
+size_t TZstdCodec::ComputeUncompressedResultBufSpace(
+    const void *compressed_data, size_t compressed_size) const {
+  unsigned long long uncompressed_size =
+      Lib.ZSTD_getFrameContentSize(compressed_data, compressed_size);
+
+  /* ZSTD_compress() always records the content size in the frame header, but
+     other producers may omit it.  Since we use only the library's
+     single-shot API, we can't handle a frame without a known content size. */
+  if ((uncompressed_size == TLibZstd::CONTENTSIZE_ERROR) ||
+      (uncompressed_size == TLibZstd::CONTENTSIZE_UNKNOWN) ||
+      (uncompressed_size > std::numeric_limits<size_t>::max())) {
+    ZstdError.Increment();
+    std::string msg(
+        "Bad or missing uncompressed data size in zstd frame: compressed size "
+    );
+    msg += std::to_string(compressed_size);
+    throw TCompressionCodecApi::TError(msg.c_str());
+  }
+
+  return static_cast<size_t>(uncompressed_size);
+}
+
+size_t TZstdCodec::Uncompress(const void *input_buf, size_t input_buf_size,
+    void *output_buf, size_t output_buf_size) const {
+  size_t result = CheckZstdStatus(Lib,
+      Lib.ZSTD_decompress(output_buf, output_buf_size, input_buf,
+          input_buf_size),
+      "ZSTD_decompress");
+
+  if (result > output_buf_size) {
+    /* There is a bug in the compression library that caused data to be
+       written past the end of our buffer.  Terminate immediately, since
+       memory has been trashed. */
+    Die("Bug in ZSTD_decompress(): output buffer overflow");
+  }
+
+  return result;  // size in bytes of uncompressed output
+}
+
+size_t TZstdCodec::DoComputeCompressedResultBufSpace(
+    const void * /*uncompressed_data*/, size_t uncompressed_size,
+    int /*compression_level*/) const {
+  return CheckZstdStatus(Lib, Lib.ZSTD_compressBound(uncompressed_size),
+      "ZSTD_compressBound");
+}
+
+size_t TZstdCodec::DoCompress(const void *input_buf, size_t input_buf_size,
+    void *output_buf, size_t output_buf_size, int compression_level) const {
+  assert((compression_level >= MIN_LEVEL) && (compression_level <= MaxLevel));
+  size_t compressed_size = CheckZstdStatus(Lib,
+      Lib.ZSTD_compress(output_buf, output_buf_size, input_buf,
+          input_buf_size, compression_level),
+      "ZSTD_compress");
+
+  if (compressed_size > output_buf_size) {
+    /* There is a bug in the compression library that caused data to be
+       written past the end of our buffer.  Terminate immediately, since
+       memory has been trashed. */
+    Die("Bug in ZSTD_compress(): output buffer overflow");
+  }
+
+  ZstdCompressSuccess.Increment();
+  return compressed_size;
+}
+
+namespace {
+
+  /* Stream compressor for zstd.  The compression context is created once and
+     reused for each stream. */
+  class TZstdStreamCompressor final
+      : public TCompressionCodecApi::TStreamCompressor {
+    NO_COPY_SEMANTICS(TZstdStreamCompressor);
+
+    public:
+    TZstdStreamCompressor(const TZstdCodec &codec, const TLibZstd &lib)
+        : TStreamCompressor(codec),
+          Lib(lib),
+          Cctx(lib.ZSTD_createCCtx()),
+          OutputChunkSize(lib.ZSTD_CStreamOutSize()) {
+      if (Cctx == nullptr) {
+        throw std::bad_alloc();
+      }
+    }
+
+    ~TZstdStreamCompressor() override {
+      Lib.ZSTD_freeCCtx(Cctx);
+    }
+
+    protected:
+    void DoBegin(size_t uncompressed_size, int compression_level) override;
+
+    void DoWrite(const void *data, size_t size) override;
+
+    void DoFinish() override;
+
+    private:
+    /* Returns the value returned by ZSTD_compressStream2(). */
+    size_t Compress(TLibZstd::TInBuffer &input, int end_op);
+
+    const TLibZstd &Lib;
+
+    TLibZstd::TCCtx * const Cctx;
+
+    /* Recommended output buffer size for ZSTD_compressStream2(). */
+    const size_t OutputChunkSize;
+  };  // TZstdStreamCompressor
+
+}  // namespace
+
+void TZstdStreamCompressor::DoBegin(size_t uncompressed_size,
+    int compression_level) {
+  CheckZstdStatus(Lib,
+      Lib.ZSTD_CCtx_reset(Cctx, TLibZstd::RESET_SESSION_ONLY),
+      "ZSTD_CCtx_reset");
+  CheckZstdStatus(Lib,
+      Lib.ZSTD_CCtx_setParameter(Cctx, TLibZstd::C_COMPRESSION_LEVEL,
+          compression_level),
+      "ZSTD_CCtx_setParameter");
+
+  /* Recording the content size in the frame header lets the receiver size
+     its output buffer, as with ZSTD_compress(). */
+  CheckZstdStatus(Lib,
+      Lib.ZSTD_CCtx_setPledgedSrcSize(Cctx, uncompressed_size),
+      "ZSTD_CCtx_setPledgedSrcSize");
+}
+
+void TZstdStreamCompressor::DoWrite(const void *data, size_t size) {
+  TLibZstd::TInBuffer input = { data, size, 0 };
+
+  while (input.pos < input.size) {
+    Compress(input, TLibZstd::E_CONTINUE);
+  }
+}
+
+void TZstdStreamCompressor::DoFinish() {
+  TLibZstd::TInBuffer input = { nullptr, 0, 0 };
+
+  /* A return value of 0 indicates that the frame is complete. */
+  while (Compress(input, TLibZstd::E_END)) {
+  }
+
+  ZstdCompressSuccess.Increment();
+}
+
+size_t TZstdStreamCompressor::Compress(TLibZstd::TInBuffer &input,
+    int end_op) {
+  size_t space = 0;
+  uint8_t *out = GetOutputSpace(OutputChunkSize, space);
+  TLibZstd::TOutBuffer output = { out, space, 0 };
+  size_t result = CheckZstdStatus(Lib,
+      Lib.ZSTD_compressStream2(Cctx, &output, &input, end_op),
+      "ZSTD_compressStream2");
+
+  if (output.pos > space) {
+    Die("Bug in ZSTD_compressStream2(): output buffer overflow");
+  }
+
+  CommitOutput(output.pos);
+  return result;
+}
+
+std::unique_ptr<TCompressionCodecApi::TStreamCompressor>
+TZstdCodec::CreateStreamCompressor() const {
+  return std::make_unique<TZstdStreamCompressor>(*this, Lib);
+}
+
+TZstdCodec::TZstdCodec()
+    : Lib(*TLibZstd::The()),
+      MaxLevel(Lib.ZSTD_maxCLevel()) {
+}
@@ -0,0 +1,87 @@
+/* <dory/compress/zstd/zstd_codec.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Zstandard compression codec.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include <base/no_copy_semantics.h>
+#include <dory/compress/compression_codec_api.h>
+
+namespace Dory {
+
+  namespace Compress {
+
+    namespace Zstd {
+
+      class TLibZstd;
+
+      /* Warning: Kafka supports zstd compression only for produce API
+         versions >= 7 (broker versions >= 2.1.0), so a topic configured for
+         zstd compression requires a broker that supports produce API version
+         7. */
+      class TZstdCodec final : public TCompressionCodecApi {
+        NO_COPY_SEMANTICS(TZstdCodec);
+
+        public:
+        static const TZstdCodec &The();  // singleton accessor
+
+        ~TZstdCodec() override = default;
+
+        std::optional<int> GetRealCompressionLevel(
+            std::optional<int> requested_level) const noexcept override;
+
+        std::optional<int> GetFastestCompressionLevel() const noexcept
+            override;
+
+        std::unique_ptr<TStreamCompressor> CreateStreamCompressor() const
+            override;
+
+        size_t ComputeUncompressedResultBufSpace(const void *compressed_data,
+            size_t compressed_size) const override;
+
+        size_t Uncompress(const void *input_buf, size_t input_buf_size,
+            void *output_buf, size_t output_buf_size) const override;
+
+        protected:
+        size_t DoComputeCompressedResultBufSpace(const void *uncompressed_data,
+            size_t uncompressed_size, int compression_level) const override;
+
+        size_t DoCompress(const void *input_buf, size_t input_buf_size,
+            void *output_buf, size_t output_buf_size,
+            int compression_level) const override;
+
+        private:
+        TZstdCodec();
+
+        const TLibZstd &Lib;
+
+        /* Highest compression level supported by the library. */
+        const int MaxLevel;
+      };  // TZstdCodec
+
+    }  // Zstd
+
+  }  // Compress
+
+}  // Dory
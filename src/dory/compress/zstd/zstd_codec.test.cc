@@ -0,0 +1,191 @@
+/* <dory/compress/zstd/zstd_codec.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit test for <dory/compress/zstd/zstd_codec.h>.
+ */
+
+#include <dory/compress/zstd/zstd_codec.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <base/tmp_file.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Compress;
+using namespace Dory::Compress::Zstd;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TZstdCodec. */
+  class TZstdCodecTest : public ::testing::Test {
+    protected:
+    TZstdCodecTest() = default;
+
+    ~TZstdCodecTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TZstdCodecTest
+
+  TEST_F(TZstdCodecTest, BasicTest) {
+    const TZstdCodec &codec = TZstdCodec::The();
+    auto default_level = codec.GetRealCompressionLevel(std::nullopt);
+    ASSERT_TRUE(default_level.has_value());
+    ASSERT_EQ(*default_level, 3);
+    auto level = codec.GetRealCompressionLevel(1);
+    ASSERT_TRUE(level.has_value());
+    ASSERT_EQ(*level, 1);
+    level = codec.GetRealCompressionLevel(19);
+    ASSERT_TRUE(level.has_value());
+    ASSERT_EQ(*level, 19);
+    level = codec.GetRealCompressionLevel(0);
+    ASSERT_TRUE(level.has_value());
+    ASSERT_EQ(*level, *default_level);
+    level = codec.GetRealCompressionLevel(1000000);
+    ASSERT_TRUE(level.has_value());
+    ASSERT_EQ(*level, *default_level);
+    level = codec.GetFastestCompressionLevel();
+    ASSERT_TRUE(level.has_value());
+    ASSERT_EQ(*level, 1);
+
+    std::string to_compress;
+
+    for (size_t i = 0; i < 1024; ++i) {
+      to_compress += "{\"a bunch of\": \"JSON junk to compress\"}";
+    }
+
+    const std::optional<int> levels[] = { std::nullopt, 1, 9, 19 };
+
+    for (const std::optional<int> &lvl : levels) {
+      std::vector<char> compressed_output(
+          codec.ComputeCompressedResultBufSpace(to_compress.data(),
+              to_compress.size(), lvl));
+      size_t result_size = codec.Compress(to_compress.data(),
+          to_compress.size(), &compressed_output[0], compressed_output.size(),
+          lvl);
+      ASSERT_LE(result_size, compressed_output.size());
+      ASSERT_LT(result_size, to_compress.size());
+      compressed_output.resize(result_size);
+
+      std::vector<char> uncompressed_output(
+          codec.ComputeUncompressedResultBufSpace(&compressed_output[0],
+              compressed_output.size()));
+      ASSERT_EQ(uncompressed_output.size(), to_compress.size());
+      result_size = codec.Uncompress(&compressed_output[0],
+          compressed_output.size(), &uncompressed_output[0],
+          uncompressed_output.size());
+      ASSERT_EQ(result_size, uncompressed_output.size());
+
+      std::string final_result(uncompressed_output.begin(),
+          uncompressed_output.end());
+      ASSERT_EQ(final_result, to_compress);
+    }
+  }
+
+  TEST_F(TZstdCodecTest, BadInputTest) {
+    const TZstdCodec &codec = TZstdCodec::The();
+    const std::string junk("this is not a zstd frame");
+    bool threw = false;
+
+    try {
+      codec.ComputeUncompressedResultBufSpace(junk.data(), junk.size());
+    } catch (const TCompressionCodecApi::TError &) {
+      threw = true;
+    }
+
+    ASSERT_TRUE(threw);
+    std::vector<char> output(1024);
+    threw = false;
+
+    try {
+      codec.Uncompress(junk.data(), junk.size(), &output[0], output.size());
+    } catch (const TCompressionCodecApi::TError &) {
+      threw = true;
+    }
+
+    ASSERT_TRUE(threw);
+  }
+
+  TEST_F(TZstdCodecTest, StreamTest) {
+    const TZstdCodec &codec = TZstdCodec::The();
+    std::unique_ptr<TCompressionCodecApi::TStreamCompressor> stream =
+        codec.CreateStreamCompressor();
+    ASSERT_TRUE(stream != nullptr);
+    std::string to_compress;
+
+    for (size_t i = 0; i < 1024; ++i) {
+      to_compress += "a bunch of junk to compress";
+      to_compress += std::to_string(i);
+    }
+
+    const std::string prefix("prefix");
+
+    for (std::optional<int> level :
+        { std::optional<int>(), std::optional<int>(9) }) {
+      std::vector<uint8_t> dst(prefix.begin(), prefix.end());
+      stream->Begin(dst, to_compress.size(), level);
+
+      /* Feed the input in pieces of varying sizes. */
+      size_t offset = 0;
+
+      for (size_t chunk = 1; offset < to_compress.size(); chunk *= 3) {
+        size_t size = std::min(chunk, to_compress.size() - offset);
+        stream->Write(to_compress.data() + offset, size);
+        offset += size;
+      }
+
+      size_t result_size = stream->Finish();
+      ASSERT_EQ(dst.size(), prefix.size() + result_size);
+      ASSERT_LT(result_size, to_compress.size());
+      ASSERT_EQ(std::string(dst.begin(), dst.begin() + prefix.size()), prefix);
+      const uint8_t *compressed = &dst[prefix.size()];
+      std::vector<char> uncompressed_output(
+          codec.ComputeUncompressedResultBufSpace(compressed, result_size));
+      result_size = codec.Uncompress(compressed, result_size,
+          &uncompressed_output[0], uncompressed_output.size());
+      ASSERT_EQ(std::string(uncompressed_output.begin(),
+          uncompressed_output.begin() + result_size), to_compress);
+    }
+
+    std::vector<uint8_t> dst(prefix.begin(), prefix.end());
+    stream->Begin(dst, to_compress.size(), std::nullopt);
+    stream->Write(to_compress.data(), to_compress.size() / 2);
+    stream->Abort();
+    ASSERT_EQ(std::string(dst.begin(), dst.end()), prefix);
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,58 @@
+/* <dory/compression_stats.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/compression_stats.h>.
+ */
+
+#include <dory/compression_stats.h>
+
+#include <base/time_util.h>
+
+using namespace Base;
+using namespace Dory;
+
+void TCompressionStats::Update(const TTopicInfo &info) {
+  uint64_t now = GetEpochMilliseconds();
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  TTopicInfo &entry = TopicInfoMap[std::make_pair(info.Topic, info.BrokerId)];
+  const uint64_t compressed_count =
+      entry.CompressedCount + info.CompressedCount;
+  const uint64_t not_compressible_count =
+      entry.NotCompressibleCount + info.NotCompressibleCount;
+  const uint64_t skipped_count = entry.SkippedCount + info.SkippedCount;
+  entry = info;
+  entry.CompressedCount = compressed_count;
+  entry.NotCompressibleCount = not_compressible_count;
+  entry.SkippedCount = skipped_count;
+  entry.UpdateTime = now;
+}
+
+std::vector<TCompressionStats::TTopicInfo>
+TCompressionStats::GetTopicInfo() const {
+  std::vector<TTopicInfo> result;
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  result.reserve(TopicInfoMap.size());
+
+  for (const auto &item : TopicInfoMap) {
+    result.push_back(item.second);
+  }
+
+  return result;
+}
@@ -0,0 +1,104 @@
+/* <dory/compression_stats.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Per-topic adaptive compression statistics, for reporting via the web
+   interface.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <dory/compress/compression_type.h>
+
+namespace Dory {
+
+  /* Keeps track of the adaptive compression decisions that each connector
+     thread has made for each topic.  Connector threads record info here, and
+     Mongoose reports it, so thread synchronization is necessary. */
+  class TCompressionStats final {
+    NO_COPY_SEMANTICS(TCompressionStats);
+
+    public:
+    struct TTopicInfo {
+      std::string Topic;
+
+      /* Kafka ID of broker whose connector thread made the decisions. */
+      long BrokerId = 0;
+
+      Compress::TCompressionType Type = Compress::TCompressionType::None;
+
+      /* Compression level from config, and level currently in use.  These
+         are empty for an algorithm that doesn't support levels. */
+      std::optional<int> ConfiguredLevel;
+
+      std::optional<int> Level;
+
+      /* One of "learning", "compressing", or "skipping". */
+      std::string State;
+
+      /* Moving averages of (compressed size / uncompressed size) and
+         compression time in nanoseconds per uncompressed byte. */
+      double AvgRatio = 0.0;
+
+      double AvgNsPerByte = 0.0;
+
+      /* Samples collected since the averages were last reset. */
+      size_t SampleCount = 0;
+
+      /* Message sets sent compressed. */
+      uint64_t CompressedCount = 0;
+
+      /* Message sets that were compressed, but sent uncompressed because they
+         didn't compress well enough. */
+      uint64_t NotCompressibleCount = 0;
+
+      /* Message sets sent uncompressed without trying to compress them. */
+      uint64_t SkippedCount = 0;
+
+      /* Milliseconds since the epoch of most recent update. */
+      uint64_t UpdateTime = 0;
+    };  // TTopicInfo
+
+    TCompressionStats() = default;
+
+    /* Called by a connector thread after compressing a message set.  The
+       counts in 'info' are added to the totals for the topic and broker, and
+       all other fields replace the previous values. */
+    void Update(const TTopicInfo &info);
+
+    /* Called by Mongoose thread.  Results are sorted by topic and broker ID.
+     */
+    std::vector<TTopicInfo> GetTopicInfo() const;
+
+    private:
+    /* Protects 'TopicInfoMap' from concurrent access. */
+    mutable std::mutex Mutex;
+
+    std::map<std::pair<std::string, long>, TTopicInfo> TopicInfoMap;
+  };  // TCompressionStats
+
+}  // Dory
@@ -172,6 +172,13 @@ namespace Dory {
         std::optional<size_t> OptMsgCount;
 
         std::optional<size_t> OptByteCount;
+
+        /* Nonzero enables adaptive linger: the time limit adapts so batches
+           reach this many bytes, staying between 'MinLingerTime' and
+           'OptTimeLimit'. */
+        size_t LingerTargetBytes = 0;
+
+        size_t MinLingerTime = 0;
       };  // TBatchValues
 
       struct TTopicConf final {
@@ -210,6 +217,10 @@ namespace Dory {
 
       size_t ProduceRequestDataLimit = 0;
 
+      /* If true, when the next batch won't fit in a produce request, later
+         batches for other topics may still be added to fill the request. */
+      bool ProduceRequestPacking = false;
+
       size_t MessageMaxBytes = 0;
 
       bool CombinedTopicsBatchingEnabled = false;
@@ -236,6 +247,10 @@ namespace Dory {
       /* A value of 0 for 'limit' means "disable batch combining". */
       void SetProduceRequestDataLimit(size_t limit);
 
+      void SetProduceRequestPacking(bool enabled) noexcept {
+        BuildResult.ProduceRequestPacking = enabled;
+      }
+
       void SetMessageMaxBytes(size_t message_max_bytes);
 
       void SetCombinedTopicsConfig(bool enabled,
@@ -54,6 +54,11 @@ bool TCompressionConf::StringToType(const char *s,
     return true;
   }
 
+  if (!strcasecmp(s, "zstd")) {
+    result = TCompressionType::Zstd;
+    return true;
+  }
+
   return false;
 }
 
@@ -146,6 +146,26 @@ namespace Dory {
 
       using TTopicMap = std::unordered_map<std::string, TConf>;
 
+      /* Settings for adaptive compression, where each connector thread
+         learns which topics compress poorly and stops compressing them. */
+      struct TAdaptiveConf final {
+        bool Enable = false;
+
+        /* Number of compressed message sets to observe for a topic before
+           deciding whether to keep compressing it. */
+        size_t MinSamples = 8;
+
+        /* Once compression is being skipped for a topic, compress every
+           RecheckInterval-th eligible message set to see whether the data
+           has become compressible. */
+        size_t RecheckInterval = 64;
+
+        /* If nonzero, and the average compression cost for a topic exceeds
+           this many nanoseconds per uncompressed byte, switch to the
+           fastest compression level that the topic's algorithm supports. */
+        size_t MaxNsPerByte = 0;
+      };  // TAdaptiveConf
+
       static bool StringToType(const char *s,
           Compress::TCompressionType &result) noexcept;
 
@@ -159,6 +179,8 @@ namespace Dory {
       TConf DefaultTopicConfig;
 
       TTopicMap TopicConfigs;
+
+      TAdaptiveConf AdaptiveConf;
     };  // TCompressionConf
 
     class TCompressionConf::TBuilder final {
@@ -175,6 +197,10 @@ namespace Dory {
 
       void SetSizeThresholdPercent(size_t size_threshold_percent);
 
+      void SetAdaptiveConf(const TAdaptiveConf &conf) {
+        BuildResult.AdaptiveConf = conf;
+      }
+
       void SetDefaultTopicConfig(const std::string &config_name);
 
       void SetTopicConfig(const std::string &topic,
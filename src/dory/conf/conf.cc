@@ -60,6 +60,20 @@ TConf::TBuilder::TBuilder(bool allow_input_bind_ephemeral, bool enable_lz4)
       XmlDoc(MakeEmptyDomDocumentUniquePtr()) {
 }
 
+static bool UsesZstd(const TCompressionConf &conf) {
+  if (conf.DefaultTopicConfig.Type == TCompressionType::Zstd) {
+    return true;
+  }
+
+  for (const auto &item : conf.TopicConfigs) {
+    if (item.second.Type == TCompressionType::Zstd) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 TConf TConf::TBuilder::Build(const void *buf, size_t buf_size) {
   assert(buf);
   Reset();
@@ -84,7 +98,8 @@ void TConf::TBuilder::ProcessSingleBatchingNamedConfig(
       TOpts::TRIM_WHITESPACE | TOpts::THROW_IF_EMPTY);
   RequireAllChildElementLeaves(config_elem);
   const auto subsection_map = GetSubsectionElements(config_elem,
-      {{"time", false}, {"messages", false}, {"bytes", false}}, false);
+      {{"time", false}, {"messages", false}, {"bytes", false},
+       {"adaptiveLinger", false}}, false);
   TBatchConf::TBatchValues values;
 
   if (subsection_map.count("time")) {
@@ -118,6 +133,39 @@ void TConf::TBuilder::ProcessSingleBatchingNamedConfig(
     throw TInvalidBatchingConfig(config_elem, msg.c_str());
   }
 
+  if (subsection_map.count("adaptiveLinger")) {
+    const DOMElement &elem = *subsection_map.at("adaptiveLinger");
+
+    if (!values.OptTimeLimit.has_value()) {
+      std::string msg("Named batching config [");
+      msg += name;
+      msg += "] must specify a time limit to use adaptiveLinger";
+      throw TInvalidBatchingConfig(elem, msg.c_str());
+    }
+
+    values.LingerTargetBytes = TAttrReader::GetUnsigned<size_t>(elem,
+        "targetBytes", 0 | TBase::DEC, 0 | TOpts::ALLOW_K);
+
+    if (values.LingerTargetBytes == 0) {
+      throw TInvalidAttr(elem, "targetBytes", "0",
+          "Adaptive linger targetBytes must be at least 1");
+    }
+
+    std::optional<size_t> opt_min = TAttrReader::GetOptUnsigned<size_t>(elem,
+        "minTime", nullptr, 0 | TBase::DEC);
+
+    if (opt_min.has_value()) {
+      if (*opt_min > *values.OptTimeLimit) {
+        std::string msg("Named batching config [");
+        msg += name;
+        msg += "] has adaptiveLinger minTime greater than time limit";
+        throw TInvalidBatchingConfig(elem, msg.c_str());
+      }
+
+      values.MinLingerTime = *opt_min;
+    }
+  }
+
   try {
     BatchingConfBuilder.AddNamedConfig(name, values);
   } catch (const TBatchDuplicateNamedConfig &x) {
@@ -199,8 +247,9 @@ void TConf::TBuilder::ProcessBatchingElem(const DOMElement &batching_elem) {
   const auto subsection_map = GetSubsectionElements(batching_elem,
       {
         {"namedConfigs", false}, {"produceRequestDataLimit", true},
-        {"messageMaxBytes", true}, {"combinedTopics", true},
-        {"defaultTopic", true}, {"topicConfigs", false}
+        {"produceRequestPacking", false}, {"messageMaxBytes", true},
+        {"combinedTopics", true}, {"defaultTopic", true},
+        {"topicConfigs", false}
       },
       false);
 
@@ -226,6 +275,13 @@ void TConf::TBuilder::ProcessBatchingElem(const DOMElement &batching_elem) {
     }
   }
 
+  if (subsection_map.count("produceRequestPacking")) {
+    const DOMElement &elem = *subsection_map.at("produceRequestPacking");
+    RequireLeaf(elem);
+    BatchingConfBuilder.SetProduceRequestPacking(
+        TAttrReader::GetBool(elem, "enable"));
+  }
+
   {
     const DOMElement &elem = *subsection_map.at("messageMaxBytes");
     RequireLeaf(elem);
@@ -353,7 +409,8 @@ void TConf::TBuilder::ProcessCompressionElem(
   const auto subsection_map = GetSubsectionElements(compression_elem,
       {
         {"namedConfigs", true}, {"sizeThresholdPercent", false},
-        {"defaultTopic", true}, {"topicConfigs", false}
+        {"defaultTopic", true}, {"topicConfigs", false},
+        {"adaptive", false}
       }, false);
 
   {
@@ -405,6 +462,45 @@ void TConf::TBuilder::ProcessCompressionElem(
     ProcessCompressionTopicConfigsElem(*subsection_map.at("topicConfigs"));
   }
 
+  if (subsection_map.count("adaptive")) {
+    const DOMElement &elem = *subsection_map.at("adaptive");
+    RequireLeaf(elem);
+    TCompressionConf::TAdaptiveConf adaptive;
+    adaptive.Enable = TAttrReader::GetBool(elem, "enable");
+    std::optional<size_t> opt_value = TAttrReader::GetOptUnsigned<size_t>(
+        elem, "minSamples", nullptr, 0 | TBase::DEC);
+
+    if (opt_value.has_value()) {
+      if (*opt_value == 0) {
+        throw TInvalidAttr(elem, "minSamples", "0",
+            "Adaptive compression minSamples must be at least 1");
+      }
+
+      adaptive.MinSamples = *opt_value;
+    }
+
+    opt_value = TAttrReader::GetOptUnsigned<size_t>(elem, "recheckInterval",
+        nullptr, 0 | TBase::DEC, 0 | TOpts::ALLOW_K);
+
+    if (opt_value.has_value()) {
+      if (*opt_value == 0) {
+        throw TInvalidAttr(elem, "recheckInterval", "0",
+            "Adaptive compression recheckInterval must be at least 1");
+      }
+
+      adaptive.RecheckInterval = *opt_value;
+    }
+
+    opt_value = TAttrReader::GetOptUnsigned<size_t>(elem, "maxNsPerByte",
+        nullptr, 0 | TBase::DEC);
+
+    if (opt_value.has_value()) {
+      adaptive.MaxNsPerByte = *opt_value;
+    }
+
+    CompressionConfBuilder.SetAdaptiveConf(adaptive);
+  }
+
   try {
     BuildResult.CompressionConf = CompressionConfBuilder.Build();
   } catch (const TCompressionMissingDefaultTopic &) {
@@ -622,7 +718,8 @@ void TConf::TBuilder::ProcessMsgDeliveryElem(
           {"metadataRefreshInterval", false},
           {"compareMetadataOnRefresh", false}, {"kafkaSocketTimeout", false},
           {"pauseRateLimitInitial", false}, {"pauseRateLimitMaxDouble", false},
-          {"minPauseDelay", false}
+          {"minPauseDelay", false}, {"connectorEventLoops", false},
+          {"partitionRetry", false}
       }, false);
   RequireAllChildElementLeaves(msg_delivery_elem);
 
@@ -697,6 +794,24 @@ void TConf::TBuilder::ProcessMsgDeliveryElem(
             BuildResult.MsgDeliveryConf.MinPauseDelay)>(
             *subsection_map.at("minPauseDelay"), "value", 0 | TBase::DEC);
   }
+
+  if (subsection_map.count("connectorEventLoops")) {
+    BuildResult.MsgDeliveryConf.ConnectorEventLoops =
+        TAttrReader::GetUnsigned<decltype(
+            BuildResult.MsgDeliveryConf.ConnectorEventLoops)>(
+            *subsection_map.at("connectorEventLoops"), "value",
+            0 | TBase::DEC);
+  }
+
+  if (subsection_map.count("partitionRetry")) {
+    const DOMElement &elem = *subsection_map.at("partitionRetry");
+    BuildResult.MsgDeliveryConf.PartitionRetry =
+        TAttrReader::GetBool(elem, "enable");
+    BuildResult.MsgDeliveryConf.PartitionRetryDelay =
+        TAttrReader::GetUnsigned<decltype(
+            BuildResult.MsgDeliveryConf.PartitionRetryDelay)>(
+            elem, "delay", 0 | TBase::DEC);
+  }
 }
 
 void TConf::TBuilder::ProcessHttpInterfaceElem(
@@ -704,7 +819,8 @@ void TConf::TBuilder::ProcessHttpInterfaceElem(
   const auto subsection_map = GetSubsectionElements(http_interface_elem,
       {
           {"port", false}, {"loopbackOnly", false},
-          {"discardReportInterval", false}, {"badMsgPrefixSize", false}
+          {"discardReportInterval", false}, {"badMsgPrefixSize", false},
+          {"maxQueueStatsTopics", false}
       }, false);
   RequireAllChildElementLeaves(http_interface_elem);
 
@@ -747,6 +863,19 @@ void TConf::TBuilder::ProcessHttpInterfaceElem(
             BuildResult.HttpInterfaceConf.BadMsgPrefixSize)>(
             *subsection_map.at("badMsgPrefixSize"), "value", 0 | TBase::DEC);
   }
+
+  if (subsection_map.count("maxQueueStatsTopics")) {
+    const DOMElement &elem = *subsection_map.at("maxQueueStatsTopics");
+    BuildResult.HttpInterfaceConf.MaxQueueStatsTopics =
+        TAttrReader::GetUnsigned<decltype(
+            BuildResult.HttpInterfaceConf.MaxQueueStatsTopics)>(
+            elem, "value", 0 | TBase::DEC, TOpts::ALLOW_K);
+
+    if (BuildResult.HttpInterfaceConf.MaxQueueStatsTopics == 0) {
+      throw TInvalidAttr(elem, "value", "0",
+          "HTTP interface maxQueueStatsTopics must be positive");
+    }
+  }
 }
 
 void TConf::TBuilder::ProcessDiscardLoggingElem(
@@ -754,7 +883,8 @@ void TConf::TBuilder::ProcessDiscardLoggingElem(
   const auto subsection_map = GetSubsectionElements(discard_logging_elem,
       {
           {"path", true}, {"maxFileSize", false},
-          {"maxArchiveSize", false}, {"maxMsgPrefixSize", false}
+          {"maxArchiveSize", false}, {"maxMsgPrefixSize", false},
+          {"format", false}
       }, false);
   const bool enable = TAttrReader::GetBool(discard_logging_elem, "enable");
   RequireAllChildElementLeaves(discard_logging_elem);
@@ -789,6 +919,17 @@ void TConf::TBuilder::ProcessDiscardLoggingElem(
         std::numeric_limits<t_max_prefix_type>::max());
   }
 
+  if (subsection_map.count("format")) {
+    const DOMElement &elem = *subsection_map.at("format");
+    const std::string format_str = TAttrReader::GetString(elem, "value",
+        TOpts::TRIM_WHITESPACE | TOpts::THROW_IF_EMPTY);
+
+    if (!TDiscardLoggingConf::StringToFormat(format_str,
+        BuildResult.DiscardLoggingConf.Format)) {
+      throw TInvalidAttr(elem, "value", format_str.c_str());
+    }
+  }
+
   if (!enable) {
     path.clear();
   }
@@ -805,7 +946,8 @@ void TConf::TBuilder::ProcessKafkaConfigElem(
     const DOMElement &kafka_config_elem) {
   const auto subsection_map = GetSubsectionElements(kafka_config_elem,
       {
-          {"clientId", false}, {"replicationTimeout", false}
+          {"clientId", false}, {"replicationTimeout", false},
+          {"produceApiVersion", false}, {"apiVersionRequest", false}
       }, false);
   RequireAllChildElementLeaves(kafka_config_elem);
 
@@ -827,6 +969,25 @@ void TConf::TBuilder::ProcessKafkaConfigElem(
         "Invalid replication timeout");
     }
   }
+
+  if (subsection_map.count("produceApiVersion")) {
+    const DOMElement &elem = *subsection_map.at("produceApiVersion");
+    const auto version = TAttrReader::GetUnsigned<decltype(
+        BuildResult.KafkaConfigConf.ProduceApiVersion)>(elem, "value",
+            0 | TBase::DEC);
+
+    try {
+      BuildResult.KafkaConfigConf.SetProduceApiVersion(version);
+    } catch (const TKafkaConfigUnsupportedProduceApiVersion &) {
+      throw TInvalidAttr(elem, "value", std::to_string(version).c_str(),
+        "Unsupported produce API version");
+    }
+  }
+
+  if (subsection_map.count("apiVersionRequest")) {
+    BuildResult.KafkaConfigConf.ApiVersionRequest = TAttrReader::GetBool(
+        *subsection_map.at("apiVersionRequest"), "value");
+  }
 }
 
 void TConf::TBuilder::ProcessMsgDebugElem(const DOMElement &msg_debug_elem) {
@@ -866,15 +1027,242 @@ void TConf::TBuilder::ProcessMsgDebugElem(const DOMElement &msg_debug_elem) {
   }
 }
 
+void TConf::TBuilder::ProcessMsgTracingElem(
+    const DOMElement &msg_tracing_elem) {
+  const auto subsection_map = GetSubsectionElements(msg_tracing_elem,
+      {
+          {"sampleInterval", true}, {"ringSize", false}
+      }, false);
+  const bool enable = TAttrReader::GetBool(msg_tracing_elem, "enable");
+  RequireAllChildElementLeaves(msg_tracing_elem);
+  TMsgTracingConf &conf = BuildResult.MsgTracingConf;
+  const DOMElement &interval_elem = *subsection_map.at("sampleInterval");
+  const size_t sample_interval =
+      TAttrReader::GetUnsigned<decltype(conf.SampleInterval)>(interval_elem,
+          "value", 0 | TBase::DEC, TOpts::ALLOW_K | TOpts::ALLOW_M);
+
+  if (sample_interval == 0) {
+    throw TInvalidAttr(interval_elem, "value", "0",
+        "Message tracing sampleInterval must be positive");
+  }
+
+  if (subsection_map.count("ringSize")) {
+    const DOMElement &elem = *subsection_map.at("ringSize");
+    conf.RingSize = TAttrReader::GetUnsigned<decltype(conf.RingSize)>(elem,
+        "value", 0 | TBase::DEC, 0 | TOpts::ALLOW_K);
+
+    if (conf.RingSize == 0) {
+      throw TInvalidAttr(elem, "value", "0",
+          "Message tracing ringSize must be positive");
+    }
+  }
+
+  conf.SampleInterval = enable ? sample_interval : 0;
+}
+
+void TConf::TBuilder::ProcessProfilingElem(const DOMElement &profiling_elem) {
+  RequireLeaf(profiling_elem);
+  BuildResult.ProfilingConf.Enable =
+      TAttrReader::GetBool(profiling_elem, "enable");
+}
+
+void TConf::TBuilder::ProcessSpilloverElem(const DOMElement &spillover_elem) {
+  const auto subsection_map = GetSubsectionElements(spillover_elem,
+      {
+          {"path", true}, {"maxDiskBytes", false}, {"segmentSize", false},
+          {"highWatermarkPercent", false}, {"lowWatermarkPercent", false}
+      }, false);
+  const bool enable = TAttrReader::GetBool(spillover_elem, "enable");
+  RequireAllChildElementLeaves(spillover_elem);
+  const DOMElement &path_elem = *subsection_map.at("path");
+  std::string path = TAttrReader::GetString(path_elem, "value");
+  TSpilloverConf &conf = BuildResult.SpilloverConf;
+
+  if (subsection_map.count("maxDiskBytes")) {
+    conf.MaxDiskBytes = TAttrReader::GetUnsigned<decltype(conf.MaxDiskBytes)>(
+        *subsection_map.at("maxDiskBytes"), "value", 0 | TBase::DEC,
+        TOpts::ALLOW_K | TOpts::ALLOW_M);
+  }
+
+  if (subsection_map.count("segmentSize")) {
+    const DOMElement &elem = *subsection_map.at("segmentSize");
+    conf.SegmentSize = TAttrReader::GetUnsigned<decltype(conf.SegmentSize)>(
+        elem, "value", 0 | TBase::DEC, TOpts::ALLOW_K | TOpts::ALLOW_M);
+
+    /* Record sizes are stored as 32-bit values, so keep segments well below
+       4 GiB. */
+    if ((conf.SegmentSize < 64 * 1024) ||
+        (conf.SegmentSize > 1024 * 1024 * 1024)) {
+      throw TInvalidAttr(elem, "value",
+          std::to_string(conf.SegmentSize).c_str(),
+          "Spillover segmentSize must be at least 64k and at most 1024m");
+    }
+  }
+
+  if (conf.SegmentSize > conf.MaxDiskBytes) {
+    const DOMElement *elem = TryGetChildElement(spillover_elem,
+        "maxDiskBytes");
+    throw TInvalidAttr(elem ? *elem : spillover_elem, "value",
+        std::to_string(conf.MaxDiskBytes).c_str(),
+        "Spillover maxDiskBytes must be at least segmentSize");
+  }
+
+  if (subsection_map.count("highWatermarkPercent")) {
+    const DOMElement &elem = *subsection_map.at("highWatermarkPercent");
+    conf.HighWatermarkPercent =
+        TAttrReader::GetUnsigned<decltype(conf.HighWatermarkPercent)>(
+            elem, "value", 0 | TBase::DEC);
+
+    if ((conf.HighWatermarkPercent == 0) ||
+        (conf.HighWatermarkPercent > 100)) {
+      throw TInvalidAttr(elem, "value",
+          std::to_string(conf.HighWatermarkPercent).c_str(),
+          "Spillover highWatermarkPercent must be from 1 to 100");
+    }
+  }
+
+  if (subsection_map.count("lowWatermarkPercent")) {
+    conf.LowWatermarkPercent =
+        TAttrReader::GetUnsigned<decltype(conf.LowWatermarkPercent)>(
+            *subsection_map.at("lowWatermarkPercent"), "value",
+            0 | TBase::DEC);
+  }
+
+  if (conf.LowWatermarkPercent >= conf.HighWatermarkPercent) {
+    /* At least one of the two elements is present, since the defaults are
+       valid. */
+    const DOMElement *elem = TryGetChildElement(spillover_elem,
+        "lowWatermarkPercent");
+
+    if (elem == nullptr) {
+      elem = subsection_map.at("highWatermarkPercent");
+    }
+
+    throw TInvalidAttr(*elem, "value",
+        std::to_string(conf.LowWatermarkPercent).c_str(),
+        "Spillover lowWatermarkPercent must be less than "
+        "highWatermarkPercent");
+  }
+
+  if (!enable) {
+    path.clear();
+  }
+
+  try {
+    conf.SetPath(path);
+  } catch (const TSpilloverRelativePath &) {
+    throw TInvalidAttr(path_elem, "value", path.c_str(),
+        "Spillover path must be absolute");
+  }
+}
+
+void TConf::TBuilder::ProcessJournalElem(const DOMElement &journal_elem) {
+  const auto subsection_map = GetSubsectionElements(journal_elem,
+      {
+          {"path", true}, {"segmentSize", false}, {"syncPolicy", false},
+          {"syncInterval", false}, {"maxPendingBytes", false}
+      }, false);
+  const bool enable = TAttrReader::GetBool(journal_elem, "enable");
+  RequireAllChildElementLeaves(journal_elem);
+  const DOMElement &path_elem = *subsection_map.at("path");
+  std::string path = TAttrReader::GetString(path_elem, "value");
+  TJournalConf &conf = BuildResult.JournalConf;
+
+  if (subsection_map.count("segmentSize")) {
+    const DOMElement &elem = *subsection_map.at("segmentSize");
+    conf.SegmentSize = TAttrReader::GetUnsigned<decltype(conf.SegmentSize)>(
+        elem, "value", 0 | TBase::DEC, TOpts::ALLOW_K | TOpts::ALLOW_M);
+
+    if ((conf.SegmentSize < 64 * 1024) ||
+        (conf.SegmentSize > 1024 * 1024 * 1024)) {
+      throw TInvalidAttr(elem, "value",
+          std::to_string(conf.SegmentSize).c_str(),
+          "Journal segmentSize must be at least 64k and at most 1024m");
+    }
+  }
+
+  if (subsection_map.count("syncPolicy")) {
+    const DOMElement &elem = *subsection_map.at("syncPolicy");
+    const std::string policy_str = TAttrReader::GetString(elem, "value",
+        TOpts::TRIM_WHITESPACE | TOpts::THROW_IF_EMPTY);
+
+    if (!TJournalConf::StringToSyncPolicy(policy_str, conf.SyncPolicy)) {
+      throw TInvalidAttr(elem, "value", policy_str.c_str());
+    }
+  }
+
+  if (subsection_map.count("syncInterval")) {
+    const DOMElement &elem = *subsection_map.at("syncInterval");
+    conf.SyncInterval = TAttrReader::GetUnsigned<decltype(conf.SyncInterval)>(
+        elem, "value", 0 | TBase::DEC);
+
+    if (conf.SyncInterval == 0) {
+      throw TInvalidAttr(elem, "value", "0",
+          "Journal syncInterval must be positive");
+    }
+  }
+
+  if (subsection_map.count("maxPendingBytes")) {
+    const DOMElement &elem = *subsection_map.at("maxPendingBytes");
+    conf.MaxPendingBytes =
+        TAttrReader::GetUnsigned<decltype(conf.MaxPendingBytes)>(elem,
+            "value", 0 | TBase::DEC, TOpts::ALLOW_K | TOpts::ALLOW_M);
+
+    if (conf.MaxPendingBytes < 64 * 1024) {
+      throw TInvalidAttr(elem, "value",
+          std::to_string(conf.MaxPendingBytes).c_str(),
+          "Journal maxPendingBytes must be at least 64k");
+    }
+  }
+
+  if (!enable) {
+    path.clear();
+  }
+
+  try {
+    conf.SetPath(path);
+  } catch (const TJournalRelativePath &) {
+    throw TInvalidAttr(path_elem, "value", path.c_str(),
+        "Journal path must be absolute");
+  }
+}
+
 void TConf::TBuilder::ProcessLoggingElem(const DOMElement &logging_elem) {
   const auto extra_subsections = ProcessCommonLogging(logging_elem,
-      BuildResult.LoggingConf.Common, {{"logDiscards", false}}, false);
+      BuildResult.LoggingConf.Common,
+      {{"logDiscards", false}, {"asyncWrites", false},
+          {"memoryStats", false}}, false);
 
   if (extra_subsections.count("logDiscards")) {
     const DOMElement &elem = *extra_subsections.at("logDiscards");
     RequireLeaf(elem);
     BuildResult.LoggingConf.LogDiscards = TAttrReader::GetBool(elem, "enable");
   }
+
+  if (extra_subsections.count("asyncWrites")) {
+    const DOMElement &elem = *extra_subsections.at("asyncWrites");
+    RequireLeaf(elem);
+    BuildResult.LoggingConf.AsyncWrites = TAttrReader::GetBool(elem, "enable");
+    const std::optional<size_t> opt_size =
+        TAttrReader::GetOptUnsigned<size_t>(elem, "threadBufferSize",
+            nullptr, 0 | TBase::DEC, TOpts::ALLOW_K | TOpts::ALLOW_M);
+
+    if (opt_size.has_value()) {
+      if (*opt_size == 0) {
+        throw TInvalidAttr(elem, "threadBufferSize", "0",
+            "Async log threadBufferSize must be at least 1");
+      }
+
+      BuildResult.LoggingConf.AsyncThreadBufferSize = *opt_size;
+    }
+  }
+
+  if (extra_subsections.count("memoryStats")) {
+    const DOMElement &elem = *extra_subsections.at("memoryStats");
+    RequireLeaf(elem);
+    BuildResult.LoggingConf.MemoryStatsInterval =
+        TAttrReader::GetUnsigned<size_t>(elem, "interval", 0 | TBase::DEC);
+  }
 }
 
 void TConf::TBuilder::ProcessInitialBrokersElem(
@@ -908,7 +1296,9 @@ void TConf::TBuilder::ProcessRootElem(const DOMElement &root_elem) {
         {"topicRateLimiting", false}, {"inputSources", true},
         {"inputConfig", false}, {"msgDelivery", false},
         {"httpInterface", false}, {"discardLogging", false},
-        {"kafkaConfig", false}, {"msgDebug", false}, {"logging", false},
+        {"kafkaConfig", false}, {"msgDebug", false},
+        {"msgTracing", false}, {"profiling", false}, {"spillover", false},
+        {"journal", false}, {"logging", false},
         {"initialBrokers", true}
       },
       false);
@@ -970,10 +1360,37 @@ void TConf::TBuilder::ProcessRootElem(const DOMElement &root_elem) {
     ProcessKafkaConfigElem(*subsection_map.at("kafkaConfig"));
   }
 
+  /* Here we rely on the compression and kafkaConfig sections having already
+     been processed above.  When API versions are negotiated with the brokers,
+     zstd is allowed since a broker may support it.  Message sets for a broker
+     that doesn't will be sent uncompressed. */
+  if (subsection_map.count("compression") &&
+      UsesZstd(BuildResult.CompressionConf) &&
+      !BuildResult.KafkaConfigConf.ApiVersionRequest &&
+      (BuildResult.KafkaConfigConf.ProduceApiVersion < 7)) {
+    throw TZstdRequiresNewerProduceApi(*subsection_map.at("compression"));
+  }
+
   if (subsection_map.count("msgDebug")) {
     ProcessMsgDebugElem(*subsection_map.at("msgDebug"));
   }
 
+  if (subsection_map.count("msgTracing")) {
+    ProcessMsgTracingElem(*subsection_map.at("msgTracing"));
+  }
+
+  if (subsection_map.count("profiling")) {
+    ProcessProfilingElem(*subsection_map.at("profiling"));
+  }
+
+  if (subsection_map.count("spillover")) {
+    ProcessSpilloverElem(*subsection_map.at("spillover"));
+  }
+
+  if (subsection_map.count("journal")) {
+    ProcessJournalElem(*subsection_map.at("journal"));
+  }
+
   if (subsection_map.count("logging")) {
     ProcessLoggingElem(*subsection_map.at("logging"));
   }
@@ -39,10 +39,14 @@
 #include <dory/conf/http_interface_conf.h>
 #include <dory/conf/input_config_conf.h>
 #include <dory/conf/input_sources_conf.h>
+#include <dory/conf/journal_conf.h>
 #include <dory/conf/kafka_config_conf.h>
 #include <dory/conf/logging_conf.h>
 #include <dory/conf/msg_debug_conf.h>
 #include <dory/conf/msg_delivery_conf.h>
+#include <dory/conf/msg_tracing_conf.h>
+#include <dory/conf/profiling_conf.h>
+#include <dory/conf/spillover_conf.h>
 #include <dory/conf/topic_rate_conf.h>
 #include <dory/util/host_and_port.h>
 #include <xml/config/config_errors.h>
@@ -86,6 +90,16 @@ namespace Dory {
       }
     };  // TInitialBrokersMissing
 
+    class TZstdRequiresNewerProduceApi final
+        : public Xml::Config::TElementError {
+      public:
+      TZstdRequiresNewerProduceApi(const xercesc::DOMElement &elem)
+          : TElementError(elem,
+                "Zstd compression requires produceApiVersion of at least 7 "
+                "or apiVersionRequest enabled") {
+      }
+    };  // TZstdRequiresNewerProduceApi
+
     struct TConf final {
       class TBuilder;
 
@@ -111,6 +125,14 @@ namespace Dory {
 
       TMsgDebugConf MsgDebugConf;
 
+      TMsgTracingConf MsgTracingConf;
+
+      TProfilingConf ProfilingConf;
+
+      TSpilloverConf SpilloverConf;
+
+      TJournalConf JournalConf;
+
       TLoggingConf LoggingConf;
 
       std::vector<TBroker> InitialBrokers;
@@ -183,6 +205,15 @@ namespace Dory {
 
       void ProcessMsgDebugElem(const xercesc::DOMElement &msg_debug_elem);
 
+      void ProcessMsgTracingElem(
+          const xercesc::DOMElement &msg_tracing_elem);
+
+      void ProcessProfilingElem(const xercesc::DOMElement &profiling_elem);
+
+      void ProcessSpilloverElem(const xercesc::DOMElement &spillover_elem);
+
+      void ProcessJournalElem(const xercesc::DOMElement &journal_elem);
+
       void ProcessLoggingElem(const xercesc::DOMElement &logging_elem);
 
       void ProcessInitialBrokersElem(
@@ -80,11 +80,15 @@ namespace {
         << "                <time value=\"5\" />" << std::endl
         << "                <messages value=\"disable\" />" << std::endl
         << "                <bytes value=\"20k\" />" << std::endl
+        << "                <adaptiveLinger targetBytes=\"64k\" "
+        << "minTime=\"2\" />" << std::endl
         << "            </config>" << std::endl
         << "        </namedConfigs>" << std::endl
         << std::endl
         << "        <produceRequestDataLimit value=\"100\" />" << std::endl
         << std::endl
+        << "        <produceRequestPacking enable=\"true\" />" << std::endl
+        << std::endl
         << "        <messageMaxBytes value=\"200\" />" << std::endl
         << std::endl
         << "        <combinedTopics enable=\"true\" config=\"config1\" />"
@@ -116,6 +120,8 @@ namespace {
         << "minSize=\"16384\" />" << std::endl
         << "            <config name=\"lz4_2\" type=\"lz4\" level=\"5\" "
         << "minSize=\"32768\" />" << std::endl
+        << "            <config name=\"zstd1\" type=\"zstd\" level=\"9\" "
+        << "minSize=\"512\" />" << std::endl
         << "        </namedConfigs>" << std::endl
         << std::endl
         << "        <sizeThresholdPercent value=\"75\" />" << std::endl
@@ -130,8 +136,12 @@ namespace {
         << "            <topic name=\"topic4\" config=\"gzip2\" />"
         << "            <topic name=\"topic5\" config=\"lz4_1\" />"
         << "            <topic name=\"topic6\" config=\"lz4_2\" />"
+        << "            <topic name=\"topic7\" config=\"zstd1\" />"
         << std::endl
         << "        </topicConfigs>" << std::endl
+        << std::endl
+        << "        <adaptive enable=\"true\" minSamples=\"4\" "
+        << "recheckInterval=\"1k\" maxNsPerByte=\"20\" />" << std::endl
         << "    </compression>" << std::endl
         << std::endl
         << "    <topicRateLimiting>" << std::endl
@@ -189,6 +199,8 @@ namespace {
         << "    <pauseRateLimitInitial value=\"6500\" />" << std::endl
         << "    <pauseRateLimitMaxDouble value=\"3\" />" << std::endl
         << "    <minPauseDelay value=\"4500\" />" << std::endl
+        << "    <connectorEventLoops value=\"4\" />" << std::endl
+        << "    <partitionRetry enable=\"true\" delay=\"250\" />" << std::endl
         << "</msgDelivery>" << std::endl
         << std::endl
         << "<httpInterface>" << std::endl
@@ -196,6 +208,7 @@ namespace {
         << "    <loopbackOnly value=\"true\" />" << std::endl
         << "    <discardReportInterval value=\"750\" />" << std::endl
         << "    <badMsgPrefixSize value=\"512\" />" << std::endl
+        << "    <maxQueueStatsTopics value=\"1000\" />" << std::endl
         << "</httpInterface>" << std::endl
         << std::endl
         << "<discardLogging enable=\"true\">" << std::endl
@@ -203,11 +216,14 @@ namespace {
         << "    <maxFileSize value=\"2m\" />" << std::endl
         << "    <maxArchiveSize value=\"64m\" />" << std::endl
         << "    <maxMsgPrefixSize value=\"384\" />" << std::endl
+        << "    <format value=\"binary\" />" << std::endl
         << "</discardLogging>" << std::endl
         << std::endl
         << "<kafkaConfig>" << std::endl
         << "    <clientId value=\"test client\" />" << std::endl
         << "    <replicationTimeout value=\"9000\" />" << std::endl
+        << "    <produceApiVersion value=\"3\" />" << std::endl
+        << "    <apiVersionRequest value=\"true\" />" << std::endl
         << "</kafkaConfig>" << std::endl
         << std::endl
         << "<msgDebug enable=\"true\">" << std::endl
@@ -216,6 +232,29 @@ namespace {
         << "    <byteLimit value=\"512m\" />" << std::endl
         << "</msgDebug>" << std::endl
         << std::endl
+        << "<msgTracing enable=\"true\">" << std::endl
+        << "    <sampleInterval value=\"1k\" />" << std::endl
+        << "    <ringSize value=\"256\" />" << std::endl
+        << "</msgTracing>" << std::endl
+        << std::endl
+        << "<profiling enable=\"false\" />" << std::endl
+        << std::endl
+        << "<spillover enable=\"true\">" << std::endl
+        << "    <path value=\"/spill/path\" />" << std::endl
+        << "    <maxDiskBytes value=\"256m\" />" << std::endl
+        << "    <segmentSize value=\"16m\" />" << std::endl
+        << "    <highWatermarkPercent value=\"80\" />" << std::endl
+        << "    <lowWatermarkPercent value=\"40\" />" << std::endl
+        << "</spillover>" << std::endl
+        << std::endl
+        << "<journal enable=\"true\">" << std::endl
+        << "    <path value=\"/journal/path\" />" << std::endl
+        << "    <segmentSize value=\"8m\" />" << std::endl
+        << "    <syncPolicy value=\"always\" />" << std::endl
+        << "    <syncInterval value=\"250\" />" << std::endl
+        << "    <maxPendingBytes value=\"16m\" />" << std::endl
+        << "</journal>" << std::endl
+        << std::endl
         << "<logging>" << std::endl
         << "    <level value=\"INFO\" />" << std::endl
         << "    <stdoutStderr enable=\"true\" />" << std::endl
@@ -225,6 +264,9 @@ namespace {
         << "        <mode value=\"0664\" />" << std::endl
         << "    </file>" << std::endl
         << "    <logDiscards enable=\"false\" />" << std::endl
+        << "    <asyncWrites enable=\"false\" threadBufferSize=\"64k\" />"
+        << std::endl
+        << "    <memoryStats interval=\"60\" />" << std::endl
         << "</logging>" << std::endl
         << std::endl
         << "    <initialBrokers>" << std::endl
@@ -243,6 +285,7 @@ namespace {
     }
 
     ASSERT_EQ(conf.BatchConf.ProduceRequestDataLimit, 100U);
+    ASSERT_TRUE(conf.BatchConf.ProduceRequestPacking);
     ASSERT_EQ(conf.BatchConf.MessageMaxBytes, 200U);
     ASSERT_TRUE(conf.BatchConf.CombinedTopicsBatchingEnabled);
     TBatchConf::TBatchValues values = conf.BatchConf.CombinedTopicsConfig;
@@ -252,6 +295,7 @@ namespace {
     ASSERT_EQ(*values.OptMsgCount, 100U);
     ASSERT_TRUE(values.OptByteCount.has_value());
     ASSERT_EQ(*values.OptByteCount, 200U);
+    ASSERT_EQ(values.LingerTargetBytes, 0U);
     ASSERT_TRUE(conf.BatchConf.DefaultTopicAction ==
         TBatchConf::TTopicAction::PerTopic);
     values = conf.BatchConf.DefaultTopicConfig;
@@ -260,6 +304,8 @@ namespace {
     ASSERT_FALSE(values.OptMsgCount.has_value());
     ASSERT_TRUE(values.OptByteCount.has_value());
     ASSERT_EQ(*values.OptByteCount, 20U * 1024U);
+    ASSERT_EQ(values.LingerTargetBytes, 64U * 1024U);
+    ASSERT_EQ(values.MinLingerTime, 2U);
 
     ASSERT_EQ(conf.BatchConf.TopicConfigs.size(), 2U);
 
@@ -291,7 +337,7 @@ namespace {
                 TCompressionType::Snappy);
     ASSERT_EQ(conf.CompressionConf.DefaultTopicConfig.MinSize, 1024U);
     ASSERT_FALSE(conf.CompressionConf.DefaultTopicConfig.Level.has_value());
-    ASSERT_EQ(conf.CompressionConf.TopicConfigs.size(), 6U);
+    ASSERT_EQ(conf.CompressionConf.TopicConfigs.size(), 7U);
 
     TCompressionConf::TTopicMap::const_iterator comp_topic_iter =
         conf.CompressionConf.TopicConfigs.find("topic1");
@@ -332,6 +378,18 @@ namespace {
     ASSERT_TRUE(comp_topic_iter->second.Level.has_value());
     ASSERT_EQ(*comp_topic_iter->second.Level, 5);
 
+    comp_topic_iter = conf.CompressionConf.TopicConfigs.find("topic7");
+    ASSERT_TRUE(comp_topic_iter != conf.CompressionConf.TopicConfigs.end());
+    ASSERT_TRUE(comp_topic_iter->second.Type == TCompressionType::Zstd);
+    ASSERT_TRUE(comp_topic_iter->second.MinSize == 512U);
+    ASSERT_TRUE(comp_topic_iter->second.Level.has_value());
+    ASSERT_EQ(*comp_topic_iter->second.Level, 9);
+
+    ASSERT_TRUE(conf.CompressionConf.AdaptiveConf.Enable);
+    ASSERT_EQ(conf.CompressionConf.AdaptiveConf.MinSamples, 4U);
+    ASSERT_EQ(conf.CompressionConf.AdaptiveConf.RecheckInterval, 1024U);
+    ASSERT_EQ(conf.CompressionConf.AdaptiveConf.MaxNsPerByte, 20U);
+
     ASSERT_EQ(conf.TopicRateConf.DefaultTopicConfig.Interval, 10000U);
     ASSERT_TRUE(conf.TopicRateConf.DefaultTopicConfig.MaxCount.has_value());
     ASSERT_EQ(*conf.TopicRateConf.DefaultTopicConfig.MaxCount, 500U);
@@ -376,30 +434,57 @@ namespace {
     ASSERT_EQ(conf.MsgDeliveryConf.PauseRateLimitInitial, 6500U);
     ASSERT_EQ(conf.MsgDeliveryConf.PauseRateLimitMaxDouble, 3U);
     ASSERT_EQ(conf.MsgDeliveryConf.MinPauseDelay, 4500U);
+    ASSERT_EQ(conf.MsgDeliveryConf.ConnectorEventLoops, 4U);
+    ASSERT_TRUE(conf.MsgDeliveryConf.PartitionRetry);
+    ASSERT_EQ(conf.MsgDeliveryConf.PartitionRetryDelay, 250U);
 
     ASSERT_EQ(conf.HttpInterfaceConf.Port, 3456U);
     ASSERT_TRUE(conf.HttpInterfaceConf.LoopbackOnly);
     ASSERT_EQ(conf.HttpInterfaceConf.DiscardReportInterval, 750U);
     ASSERT_EQ(conf.HttpInterfaceConf.BadMsgPrefixSize, 512U);
+    ASSERT_EQ(conf.HttpInterfaceConf.MaxQueueStatsTopics, 1000U);
 
     ASSERT_EQ(conf.DiscardLoggingConf.Path, "/discard/logging/path");
     ASSERT_EQ(conf.DiscardLoggingConf.MaxFileSize, 2U * 1024U * 1024U);
     ASSERT_EQ(conf.DiscardLoggingConf.MaxArchiveSize, 64U * 1024U * 1024U);
     ASSERT_EQ(conf.DiscardLoggingConf.MaxMsgPrefixSize, 384U);
+    ASSERT_TRUE(conf.DiscardLoggingConf.Format ==
+        TDiscardLoggingConf::TFormat::Binary);
 
     ASSERT_EQ(conf.KafkaConfigConf.ClientId, "test client");
     ASSERT_EQ(conf.KafkaConfigConf.ReplicationTimeout, 9000U);
+    ASSERT_EQ(conf.KafkaConfigConf.ProduceApiVersion, 3U);
+    ASSERT_TRUE(conf.KafkaConfigConf.ApiVersionRequest);
 
     ASSERT_EQ(conf.MsgDebugConf.Path, "/msg/debug/path");
     ASSERT_EQ(conf.MsgDebugConf.TimeLimit, 45U);
     ASSERT_EQ(conf.MsgDebugConf.ByteLimit, 512U * 1024U * 1024U);
 
+    ASSERT_EQ(conf.MsgTracingConf.SampleInterval, 1024U);
+    ASSERT_EQ(conf.MsgTracingConf.RingSize, 256U);
+    ASSERT_FALSE(conf.ProfilingConf.Enable);
+
+    ASSERT_EQ(conf.SpilloverConf.Path, "/spill/path");
+    ASSERT_EQ(conf.SpilloverConf.MaxDiskBytes, 256U * 1024U * 1024U);
+    ASSERT_EQ(conf.SpilloverConf.SegmentSize, 16U * 1024U * 1024U);
+    ASSERT_EQ(conf.SpilloverConf.HighWatermarkPercent, 80U);
+    ASSERT_EQ(conf.SpilloverConf.LowWatermarkPercent, 40U);
+    ASSERT_EQ(conf.JournalConf.Path, "/journal/path");
+    ASSERT_EQ(conf.JournalConf.SegmentSize, 8U * 1024U * 1024U);
+    ASSERT_TRUE(conf.JournalConf.SyncPolicy ==
+        TJournalConf::TSyncPolicy::Always);
+    ASSERT_EQ(conf.JournalConf.SyncInterval, 250U);
+    ASSERT_EQ(conf.JournalConf.MaxPendingBytes, 16U * 1024U * 1024U);
+
     ASSERT_EQ(conf.LoggingConf.Common.Pri, TPri::INFO);
     ASSERT_TRUE(conf.LoggingConf.Common.EnableStdoutStderr);
     ASSERT_FALSE(conf.LoggingConf.Common.EnableSyslog);
     ASSERT_EQ(conf.LoggingConf.Common.FilePath, "/log/file/path");
     ASSERT_TRUE(conf.LoggingConf.Common.FileMode.has_value());
     ASSERT_EQ(*conf.LoggingConf.Common.FileMode, 0664U);
+    ASSERT_FALSE(conf.LoggingConf.AsyncWrites);
+    ASSERT_EQ(conf.LoggingConf.AsyncThreadBufferSize, 64U * 1024U);
+    ASSERT_EQ(conf.LoggingConf.MemoryStatsInterval, 60U);
 
     ASSERT_EQ(conf.InitialBrokers.size(), 2U);
     ASSERT_EQ(conf.InitialBrokers[0].Host, "host1");
@@ -24,6 +24,19 @@
 using namespace Dory;
 using namespace Dory::Conf;
 
+bool TDiscardLoggingConf::StringToFormat(const std::string &s,
+    TFormat &result) noexcept {
+  if (s == "text") {
+    result = TFormat::Text;
+  } else if (s == "binary") {
+    result = TFormat::Binary;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
 void TDiscardLoggingConf::SetPath(const std::string &path) {
   if (!path.empty() && (path[0] != '/')) {
     throw TDiscardLoggingRelativePath();
@@ -39,8 +39,23 @@ namespace Dory {
     };  // TDiscardLoggingRelativePath
 
     struct TDiscardLoggingConf final {
+      enum class TFormat {
+        /* One line of text per entry, with base64 encoded keys and values. */
+        Text,
+
+        /* Length-prefixed binary records.  See <dory/binary_discard_log.h>. */
+        Binary
+      };  // TFormat
+
+      /* Return true on success, or false if 's' is not the name of a
+         format. */
+      static bool StringToFormat(const std::string &s,
+          TFormat &result) noexcept;
+
       std::string Path;
 
+      TFormat Format = TFormat::Text;
+
       size_t MaxFileSize = 1024 * 1024;
 
       size_t MaxArchiveSize = 32 * 1024 * 1024;
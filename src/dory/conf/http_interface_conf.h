@@ -55,6 +55,10 @@ namespace Dory {
 
       size_t BadMsgPrefixSize = 256;
 
+      /* Maximum number of distinct topics tracked for the per-topic queue
+         stats reported by /queues, /memory, and /metrics. */
+      size_t MaxQueueStatsTopics = 65536;
+
       void SetPort(in_port_t port);
 
       void SetDiscardReportInterval(size_t value);
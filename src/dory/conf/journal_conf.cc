@@ -0,0 +1,48 @@
+/* <dory/conf/journal_conf.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/conf/journal_conf.h>.
+ */
+
+#include <dory/conf/journal_conf.h>
+
+using namespace Dory;
+using namespace Dory::Conf;
+
+bool TJournalConf::StringToSyncPolicy(const std::string &s,
+    TSyncPolicy &result) noexcept {
+  if (s == "none") {
+    result = TSyncPolicy::None;
+  } else if (s == "interval") {
+    result = TSyncPolicy::Interval;
+  } else if (s == "always") {
+    result = TSyncPolicy::Always;
+  } else {
+    return false;
+  }
+
+  return true;
+}
+
+void TJournalConf::SetPath(const std::string &path) {
+  if (!path.empty() && (path[0] != '/')) {
+    throw TJournalRelativePath();
+  }
+
+  Path = path;
+}
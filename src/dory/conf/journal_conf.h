@@ -0,0 +1,81 @@
+/* <dory/conf/journal_conf.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class representing write-ahead journal section from Dory's config file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <dory/conf/conf_error.h>
+
+namespace Dory {
+
+  namespace Conf {
+
+    class TJournalRelativePath final : public TConfError {
+      public:
+      TJournalRelativePath()
+          : TConfError("Journal path must be absolute") {
+      }
+    };  // TJournalRelativePath
+
+    struct TJournalConf final {
+      /* Determines when journal writes are flushed to disk with
+         fdatasync(). */
+      enum class TSyncPolicy {
+        /* Never.  Journal contents survive a crash of dory, but not a crash
+           of the operating system. */
+        None,
+
+        /* At most once per sync interval. */
+        Interval,
+
+        /* After each group commit. */
+        Always
+      };  // TSyncPolicy
+
+      /* Return true on success, or false if 's' is not the name of a
+         policy. */
+      static bool StringToSyncPolicy(const std::string &s,
+          TSyncPolicy &result) noexcept;
+
+      /* Directory for journal segment files.  Empty if journaling is
+         disabled. */
+      std::string Path;
+
+      size_t SegmentSize = 64 * 1024 * 1024;
+
+      TSyncPolicy SyncPolicy = TSyncPolicy::Interval;
+
+      /* Milliseconds. */
+      size_t SyncInterval = 100;
+
+      /* Maximum bytes of append records waiting to be written.  Messages
+         that arrive when this is reached are routed without being
+         journaled. */
+      size_t MaxPendingBytes = 64 * 1024 * 1024;
+
+      void SetPath(const std::string &path);
+    };  // TJournalConf
+
+  };  // Conf
+
+}  // Dory
@@ -23,6 +23,8 @@
 
 #include <limits>
 
+#include <dory/kafka_proto/produce/version_util.h>
+
 using namespace Dory;
 using namespace Dory::Conf;
 
@@ -33,3 +35,11 @@ void TKafkaConfigConf::SetReplicationTimeout(size_t value) {
 
   ReplicationTimeout = value;
 }
+
+void TKafkaConfigConf::SetProduceApiVersion(size_t value) {
+  if (!KafkaProto::Produce::IsProduceApiVersionSupported(value)) {
+    throw TKafkaConfigUnsupportedProduceApiVersion();
+  }
+
+  ProduceApiVersion = value;
+}
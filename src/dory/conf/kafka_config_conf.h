@@ -37,12 +37,31 @@ namespace Dory {
       }
     };  // TKafkaConfigInvalidReplicationTimeout
 
+    class TKafkaConfigUnsupportedProduceApiVersion final : public TConfError {
+      public:
+      TKafkaConfigUnsupportedProduceApiVersion()
+          : TConfError("Unsupported produce API version") {
+      }
+    };  // TKafkaConfigUnsupportedProduceApiVersion
+
     struct TKafkaConfigConf final {
       std::string ClientId = "dory";
 
       size_t ReplicationTimeout = 10000;
 
+      /* Version of the Kafka produce API to use.  Version 3 and later use the
+         RecordBatch message format, which requires Kafka 0.11 or newer. */
+      size_t ProduceApiVersion = 0;
+
+      /* If true, send an ApiVersions request to each broker after connecting,
+         and use the highest produce and metadata API versions supported by
+         both dory and the broker, ignoring 'ProduceApiVersion'.  Requires
+         Kafka 0.10 or newer. */
+      bool ApiVersionRequest = false;
+
       void SetReplicationTimeout(size_t value);
+
+      void SetProduceApiVersion(size_t value);
     };  // TKafkaConfigConf
 
   };  // Conf
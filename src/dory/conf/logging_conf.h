@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <cstddef>
+
 #include <dory/conf/common_logging_conf.h>
 
 namespace Dory {
@@ -31,6 +33,17 @@ namespace Dory {
       TCommonLoggingConf Common;
 
       bool LogDiscards = true;
+
+      /* If true, logfile writes (including debug logfiles) are buffered per
+         thread and done by a background thread. */
+      bool AsyncWrites = true;
+
+      /* Maximum bytes buffered per thread when 'AsyncWrites' is true. */
+      size_t AsyncThreadBufferSize = 256 * 1024;
+
+      /* Interval in seconds between log entries reporting buffer pool and
+         message memory usage.  0 disables these entries. */
+      size_t MemoryStatsInterval = 300;
     };  // TLoggingConf
 
   }  // Conf
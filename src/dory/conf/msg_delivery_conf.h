@@ -47,6 +47,13 @@ namespace Dory {
       size_t PauseRateLimitMaxDouble = 4;
 
       size_t MinPauseDelay = 5000;
+
+      /* 0 means one connector thread per broker. */
+      size_t ConnectorEventLoops = 0;
+
+      bool PartitionRetry = false;
+
+      size_t PartitionRetryDelay = 1000;
     };  // TMsgDeliveryConf
 
   };  // Conf
@@ -0,0 +1,41 @@
+/* <dory/conf/msg_tracing_conf.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class representing message tracing section from Dory's config file.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace Dory {
+
+  namespace Conf {
+
+    struct TMsgTracingConf final {
+      /* Trace 1 in every 'SampleInterval' messages.  0 means tracing is
+         disabled. */
+      size_t SampleInterval = 0;
+
+      /* Number of traces of recently processed messages to keep. */
+      size_t RingSize = 1024;
+    };  // TMsgTracingConf
+
+  };  // Conf
+
+}  // Dory
@@ -0,0 +1,36 @@
+/* <dory/conf/profiling_conf.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class representing profiling section from Dory's config file.
+ */
+
+#pragma once
+
+namespace Dory {
+
+  namespace Conf {
+
+    struct TProfilingConf final {
+      /* If true, the router and connector threads keep track of how much time
+         they spend in each phase of their work. */
+      bool Enable = true;
+    };  // TProfilingConf
+
+  };  // Conf
+
+}  // Dory
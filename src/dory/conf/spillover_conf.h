@@ -0,0 +1,60 @@
+/* <dory/conf/spillover_conf.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class representing disk spillover section from Dory's config file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include <dory/conf/conf_error.h>
+
+namespace Dory {
+
+  namespace Conf {
+
+    class TSpilloverRelativePath final : public TConfError {
+      public:
+      TSpilloverRelativePath()
+          : TConfError("Spillover path must be absolute") {
+      }
+    };  // TSpilloverRelativePath
+
+    struct TSpilloverConf final {
+      /* Directory for spill segment files.  Empty if spillover is disabled. */
+      std::string Path;
+
+      size_t MaxDiskBytes = 1024 * 1024 * 1024;
+
+      size_t SegmentSize = 64 * 1024 * 1024;
+
+      /* Start spilling when buffer pool usage reaches this percentage. */
+      size_t HighWatermarkPercent = 90;
+
+      /* Replay spilled messages while buffer pool usage is below this
+         percentage. */
+      size_t LowWatermarkPercent = 50;
+
+      void SetPath(const std::string &path);
+    };  // TSpilloverConf
+
+  };  // Conf
+
+}  // Dory
@@ -34,6 +34,7 @@
 #include <base/wr/fd_util.h>
 #include <base/wr/time_util.h>
 #include <dory/util/msg_util.h>
+#include <log/async_log_sink.h>
 #include <log/log.h>
 #include <third_party/base64/base64.h>
 
@@ -140,6 +141,13 @@ void TDebugLogger::LogMsg(const TMsg &msg) {
     return;
   }
 
+  /* 'Settings' owns 'LogFd', so holding it keeps the file open until the
+     entry is written. */
+  if (GetAsyncLogSink().Write(LogFd, Settings, LogEntry.data(),
+      LogEntry.size())) {
+    return;
+  }
+
   ssize_t ret = Wr::write(LogFd, LogEntry.data(), LogEntry.size());
 
   if (ret < 0) {
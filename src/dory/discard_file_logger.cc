@@ -28,7 +28,7 @@
 #include <cerrno>
 #include <cstdlib>
 #include <cstring>
-#include <sstream>
+#include <limits>
 
 #include <boost/lexical_cast.hpp>
 #include <fcntl.h>
@@ -36,6 +36,7 @@
 #include <sys/stat.h>
 #include <sys/types.h>
 
+#include <base/counter.h>
 #include <base/dir_iter.h>
 #include <base/error_util.h>
 #include <base/gettid.h>
@@ -45,42 +46,20 @@
 #include <base/wr/file_util.h>
 #include <dory/util/msg_util.h>
 #include <log/log.h>
-#include <third_party/base64/base64.h>
 
 using namespace Base;
 using namespace Dory;
 using namespace Dory::Util;
 using namespace Log;
 
-static std::string ComposeLogEntry(TMsg::TTimestamp timestamp,
-    const char *event, const char *info, const std::string &topic,
-    const void *key, size_t key_size, const void *msg, size_t msg_size) {
-  assert(event);
-  assert(info);
-  assert(key || (key_size == 0));
-  assert(msg || (msg_size == 0));
-  uint64_t now = GetEpochMilliseconds();
-  std::string encoded_key;
+DEFINE_COUNTER(DiscardLogEntryDropQueueFull);
+DEFINE_COUNTER(DiscardLogEntryWritten);
+DEFINE_COUNTER(DiscardLogWrite);
+DEFINE_COUNTER(DiscardLogWriterWakeup);
 
-  if (key_size) {
-    encoded_key = base64_encode(reinterpret_cast<const unsigned char *>(key),
-        static_cast<unsigned int>(key_size));
-  }
-
-  std::string encoded_msg;
-
-  if (msg_size) {
-    encoded_msg = base64_encode(reinterpret_cast<const unsigned char *>(msg),
-        static_cast<unsigned int>(msg_size));
-  }
-
-  std::ostringstream os;
-  os << "now: " << now << " ts: " << timestamp << " event: " << event
-      << " info: " << info << " topic: " << topic.size() << "[" << topic
-      << "] key: " << encoded_key.size() << "[" << encoded_key << "] msg: "
-      << encoded_msg.size() << "[" << encoded_msg << "]\n";
-  return os.str();
-}
+/* The writer thread writes its buffer once it reaches this size, even if more
+   entries are queued. */
+static const size_t WRITE_BUF_FLUSH_SIZE = 256 * 1024;
 
 static void CreateDir(const char *dir) {
   assert(dir);
@@ -112,7 +91,8 @@ TDiscardFileLogger::~TDiscardFileLogger() {
 }
 
 void TDiscardFileLogger::Init(const char *log_path, uint64_t max_file_size,
-    uint64_t max_archive_size, size_t max_msg_prefix_len) {
+    uint64_t max_archive_size, size_t max_msg_prefix_len, TFormat format,
+    size_t queue_size) {
   /* Will contain absolute path of directory containing logfile. */
   std::string log_dir;
 
@@ -149,13 +129,35 @@ void TDiscardFileLogger::Init(const char *log_path, uint64_t max_file_size,
   LogFilename = std::move(log_filename);
   MaxFileSize = max_file_size;
   MaxArchiveSize = max_archive_size;
+  Format = format;
   Enabled = true;
   CheckMaxFileSize(0);
+
+  if (Enabled && (Format == TFormat::Binary) && FileSize) {
+    /* A binary logfile must start with a file header, and topic definitions
+       from an earlier run are unknown, so start a new file. */
+    CheckMaxFileSize(std::numeric_limits<uint64_t>::max());
+  }
+
   ArchiveCleaner->SendCleanRequest();
+
+  if (Enabled) {
+    Queue.reset(new TMpscRing<TDiscardLogEntry>(queue_size));
+    Writer.reset(new TWriter(*this));
+    Writer->Start();
+  }
 }
 
 void TDiscardFileLogger::Shutdown() {
   std::lock_guard<std::mutex> lock(Mutex);
+
+  if (Writer) {
+    /* The writer drains the queue before exiting. */
+    Writer->RequestShutdown();
+    Writer->Join();
+    Writer.reset();
+  }
+
   DisableLogging();
 
   if (ArchiveCleaner) {
@@ -165,26 +167,29 @@ void TDiscardFileLogger::Shutdown() {
   }
 }
 
-static const char *ReasonToBlurb(TDiscardFileLogger::TDiscardReason reason) {
+static TDiscardLogInfo ReasonToInfo(
+    TDiscardFileLogger::TDiscardReason reason) {
   switch (reason) {
     case TDiscardFileLogger::TDiscardReason::Bug:
       break;
     case TDiscardFileLogger::TDiscardReason::FailedDeliveryAttemptLimit:
-      return "DELIVERY_ATTEMPT_LIMIT";
+      return TDiscardLogInfo::DeliveryAttemptLimit;
     case TDiscardFileLogger::TDiscardReason::KafkaErrorAck:
-      return "KAFKA_ERROR_ACK";
+      return TDiscardLogInfo::KafkaErrorAck;
     case TDiscardFileLogger::TDiscardReason::ServerShutdown:
-      return "SERVER_SHUTDOWN";
+      return TDiscardLogInfo::ServerShutdown;
     case TDiscardFileLogger::TDiscardReason::NoAvailablePartitions:
-      return "NO_AVAILABLE_PARTITIONS";
+      return TDiscardLogInfo::NoAvailablePartitions;
     case TDiscardFileLogger::TDiscardReason::RateLimit:
-      return "RATE_LIMIT";
+      return TDiscardLogInfo::RateLimit;
     case TDiscardFileLogger::TDiscardReason::FailedTopicAutocreate:
-      return "TOPIC_AUTOCREATE_FAIL";
+      return TDiscardLogInfo::TopicAutocreateFail;
+    case TDiscardFileLogger::TDiscardReason::FailedSpill:
+      return TDiscardLogInfo::SpillFail;
     NO_DEFAULT_CASE;
   }
 
-  return "BUG";
+  return TDiscardLogInfo::Bug;
 }
 
 void TDiscardFileLogger::LogDiscard(const TMsg &msg, TDiscardReason reason) {
@@ -192,17 +197,11 @@ void TDiscardFileLogger::LogDiscard(const TMsg &msg, TDiscardReason reason) {
     return;  // fast path for case where logging is disabled
   }
 
-  std::vector<uint8_t> key_buf;
-  WriteKey(key_buf, 0, msg);
-  EnforceMaxPrefixLen(key_buf);
-  std::vector<uint8_t> value_buf;
-  WriteValue(value_buf, 0, msg);
-  EnforceMaxPrefixLen(value_buf);
-  const uint8_t *key_buf_begin = key_buf.empty() ? nullptr : &key_buf[0];
-  const uint8_t *value_buf_begin = value_buf.empty() ? nullptr : &value_buf[0];
-  WriteToLog(ComposeLogEntry(msg.GetTimestamp(), "DISC", ReasonToBlurb(reason),
-                 msg.GetTopic(), key_buf_begin, key_buf.size(),
-                 value_buf_begin, value_buf.size()));
+  TDiscardLogEntry entry;
+  entry.Event = TDiscardLogEvent::Discard;
+  entry.Info = ReasonToInfo(reason);
+  CopyKeyAndValue(msg, entry);
+  Enqueue(std::move(entry));
 }
 
 void TDiscardFileLogger::LogDuplicate(const TMsg &msg) {
@@ -210,17 +209,11 @@ void TDiscardFileLogger::LogDuplicate(const TMsg &msg) {
     return;  // fast path for case where logging is disabled
   }
 
-  std::vector<uint8_t> key_buf;
-  WriteKey(key_buf, 0, msg);
-  EnforceMaxPrefixLen(key_buf);
-  std::vector<uint8_t> value_buf;
-  WriteValue(value_buf, 0, msg);
-  EnforceMaxPrefixLen(value_buf);
-  const uint8_t *key_buf_begin = key_buf.empty() ? nullptr : &key_buf[0];
-  const uint8_t *value_buf_begin = value_buf.empty() ? nullptr : &value_buf[0];
-  WriteToLog(ComposeLogEntry(msg.GetTimestamp(), "DUP", "NONE", msg.GetTopic(),
-                 key_buf_begin, key_buf.size(), value_buf_begin,
-                 value_buf.size()));
+  TDiscardLogEntry entry;
+  entry.Event = TDiscardLogEvent::Duplicate;
+  entry.Info = TDiscardLogInfo::None;
+  CopyKeyAndValue(msg, entry);
+  Enqueue(std::move(entry));
 }
 
 void TDiscardFileLogger::LogNoMemDiscard(TMsg::TTimestamp timestamp,
@@ -237,14 +230,21 @@ void TDiscardFileLogger::LogNoMemDiscard(TMsg::TTimestamp timestamp,
     return;  // fast path for case where logging is disabled
   }
 
-  const std::string topic(topic_begin, topic_end);
-  size_t key_size = reinterpret_cast<const uint8_t *>(key_end) -
-      reinterpret_cast<const uint8_t *>(key_begin);
-  size_t value_size = reinterpret_cast<const uint8_t *>(value_end) -
-      reinterpret_cast<const uint8_t *>(value_begin);
-  WriteToLog(ComposeLogEntry(timestamp, "DISC", "NO_MEM", topic, key_begin,
-                 std::min(key_size, MaxMsgPrefixLen), value_begin,
-                 std::min(value_size, MaxMsgPrefixLen)));
+  TDiscardLogEntry entry;
+  entry.Now = GetEpochMilliseconds();
+  entry.Timestamp = timestamp;
+  entry.Event = TDiscardLogEvent::Discard;
+  entry.Info = TDiscardLogInfo::NoMem;
+  entry.Topic.assign(topic_begin, topic_end);
+  const auto *key = reinterpret_cast<const uint8_t *>(key_begin);
+  const auto *value = reinterpret_cast<const uint8_t *>(value_begin);
+  entry.KeySize = static_cast<size_t>(
+      reinterpret_cast<const uint8_t *>(key_end) - key);
+  entry.Key.assign(key, EnforceMaxPrefixLen(key_begin, key_end));
+  entry.ValueSize = static_cast<size_t>(
+      reinterpret_cast<const uint8_t *>(value_end) - value);
+  entry.Value.assign(value, EnforceMaxPrefixLen(value_begin, value_end));
+  Enqueue(std::move(entry));
 }
 
 void TDiscardFileLogger::LogMalformedMsgDiscard(const void *msg_begin,
@@ -253,11 +253,17 @@ void TDiscardFileLogger::LogMalformedMsgDiscard(const void *msg_begin,
     return;  // fast path for case where logging is disabled
   }
 
-  size_t msg_size = reinterpret_cast<const uint8_t *>(msg_end) -
-      reinterpret_cast<const uint8_t *>(msg_begin);
-  WriteToLog(ComposeLogEntry(GetEpochMilliseconds(), "DISC", "MALFORMED",
-                 std::string(), nullptr, 0, msg_begin, std::min(msg_size,
-                 MaxMsgPrefixLen)));
+  TDiscardLogEntry entry;
+  entry.Now = GetEpochMilliseconds();
+  entry.Timestamp = entry.Now;
+  entry.Event = TDiscardLogEvent::Discard;
+  entry.Info = TDiscardLogInfo::Malformed;
+  entry.ValueSize = static_cast<size_t>(
+      reinterpret_cast<const uint8_t *>(msg_end) -
+      reinterpret_cast<const uint8_t *>(msg_begin));
+  entry.Value.assign(reinterpret_cast<const uint8_t *>(msg_begin),
+      EnforceMaxPrefixLen(msg_begin, msg_end));
+  Enqueue(std::move(entry));
 }
 
 void TDiscardFileLogger::LogUncleanDisconnectMsgDiscard(bool is_tcp,
@@ -266,11 +272,18 @@ void TDiscardFileLogger::LogUncleanDisconnectMsgDiscard(bool is_tcp,
     return;  // fast path for case where logging is disabled
   }
 
-  size_t msg_size = reinterpret_cast<const uint8_t *>(msg_end) -
-      reinterpret_cast<const uint8_t *>(msg_begin);
-  WriteToLog(ComposeLogEntry(GetEpochMilliseconds(), "DISC",
-      is_tcp ? "UNCLEAN_T" : "UNCLEAN_U", std::string(), nullptr, 0, msg_begin,
-      std::min(msg_size, MaxMsgPrefixLen)));
+  TDiscardLogEntry entry;
+  entry.Now = GetEpochMilliseconds();
+  entry.Timestamp = entry.Now;
+  entry.Event = TDiscardLogEvent::Discard;
+  entry.Info = is_tcp ?
+      TDiscardLogInfo::UncleanTcp : TDiscardLogInfo::UncleanUnix;
+  entry.ValueSize = static_cast<size_t>(
+      reinterpret_cast<const uint8_t *>(msg_end) -
+      reinterpret_cast<const uint8_t *>(msg_begin));
+  entry.Value.assign(reinterpret_cast<const uint8_t *>(msg_begin),
+      EnforceMaxPrefixLen(msg_begin, msg_end));
+  Enqueue(std::move(entry));
 }
 
 void TDiscardFileLogger::LogUnsupportedApiKeyDiscard(const void *msg_begin,
@@ -279,14 +292,19 @@ void TDiscardFileLogger::LogUnsupportedApiKeyDiscard(const void *msg_begin,
     return;  // fast path for case where logging is disabled
   }
 
-  std::ostringstream os;
-  os << "API_KEY(" << api_key << ")";
-  std::string info(os.str());
-  size_t msg_size = reinterpret_cast<const uint8_t *>(msg_end) -
-      reinterpret_cast<const uint8_t *>(msg_begin);
-  WriteToLog(ComposeLogEntry(GetEpochMilliseconds(), "DISC", info.c_str(),
-                 std::string(), nullptr, 0, msg_begin,
-                 std::min(msg_size, MaxMsgPrefixLen)));
+  TDiscardLogEntry entry;
+  entry.Now = GetEpochMilliseconds();
+  entry.Timestamp = entry.Now;
+  entry.Event = TDiscardLogEvent::Discard;
+  entry.Info = TDiscardLogInfo::ApiKey;
+  entry.HasInfoArg = true;
+  entry.InfoArg = api_key;
+  entry.ValueSize = static_cast<size_t>(
+      reinterpret_cast<const uint8_t *>(msg_end) -
+      reinterpret_cast<const uint8_t *>(msg_begin));
+  entry.Value.assign(reinterpret_cast<const uint8_t *>(msg_begin),
+      EnforceMaxPrefixLen(msg_begin, msg_end));
+  Enqueue(std::move(entry));
 }
 
 void TDiscardFileLogger::LogUnsupportedMsgVersionDiscard(const void *msg_begin,
@@ -295,14 +313,19 @@ void TDiscardFileLogger::LogUnsupportedMsgVersionDiscard(const void *msg_begin,
     return;  // fast path for case where logging is disabled
   }
 
-  std::ostringstream os;
-  os << "VERSION(" << version << ")";
-  std::string info(os.str());
-  size_t msg_size = reinterpret_cast<const uint8_t *>(msg_end) -
-      reinterpret_cast<const uint8_t *>(msg_begin);
-  WriteToLog(ComposeLogEntry(GetEpochMilliseconds(), "DISC", info.c_str(),
-                 std::string(), nullptr, 0, msg_begin,
-                 std::min(msg_size, MaxMsgPrefixLen)));
+  TDiscardLogEntry entry;
+  entry.Now = GetEpochMilliseconds();
+  entry.Timestamp = entry.Now;
+  entry.Event = TDiscardLogEvent::Discard;
+  entry.Info = TDiscardLogInfo::Version;
+  entry.HasInfoArg = true;
+  entry.InfoArg = version;
+  entry.ValueSize = static_cast<size_t>(
+      reinterpret_cast<const uint8_t *>(msg_end) -
+      reinterpret_cast<const uint8_t *>(msg_begin));
+  entry.Value.assign(reinterpret_cast<const uint8_t *>(msg_begin),
+      EnforceMaxPrefixLen(msg_begin, msg_end));
+  Enqueue(std::move(entry));
 }
 
 void TDiscardFileLogger::LogBadTopicDiscard(TMsg::TTimestamp timestamp,
@@ -319,14 +342,21 @@ void TDiscardFileLogger::LogBadTopicDiscard(TMsg::TTimestamp timestamp,
     return;  // fast path for case where logging is disabled
   }
 
-  const std::string topic(topic_begin, topic_end);
-  size_t key_size = reinterpret_cast<const uint8_t *>(key_end) -
-      reinterpret_cast<const uint8_t *>(key_begin);
-  size_t value_size = reinterpret_cast<const uint8_t *>(value_end) -
-      reinterpret_cast<const uint8_t *>(value_begin);
-  WriteToLog(ComposeLogEntry(timestamp, "DISC", "BAD_TOPIC", topic, key_begin,
-                 std::min(key_size, MaxMsgPrefixLen), value_begin,
-                 std::min(value_size, MaxMsgPrefixLen)));
+  TDiscardLogEntry entry;
+  entry.Now = GetEpochMilliseconds();
+  entry.Timestamp = timestamp;
+  entry.Event = TDiscardLogEvent::Discard;
+  entry.Info = TDiscardLogInfo::BadTopic;
+  entry.Topic.assign(topic_begin, topic_end);
+  const auto *key = reinterpret_cast<const uint8_t *>(key_begin);
+  const auto *value = reinterpret_cast<const uint8_t *>(value_begin);
+  entry.KeySize = static_cast<size_t>(
+      reinterpret_cast<const uint8_t *>(key_end) - key);
+  entry.Key.assign(key, EnforceMaxPrefixLen(key_begin, key_end));
+  entry.ValueSize = static_cast<size_t>(
+      reinterpret_cast<const uint8_t *>(value_end) - value);
+  entry.Value.assign(value, EnforceMaxPrefixLen(value_begin, value_end));
+  Enqueue(std::move(entry));
 }
 
 void TDiscardFileLogger::LogBadTopicDiscard(const TMsg &msg) {
@@ -334,17 +364,11 @@ void TDiscardFileLogger::LogBadTopicDiscard(const TMsg &msg) {
     return;  // fast path for case where logging is disabled
   }
 
-  std::vector<uint8_t> key_buf;
-  WriteKey(key_buf, 0, msg);
-  EnforceMaxPrefixLen(key_buf);
-  std::vector<uint8_t> value_buf;
-  WriteValue(value_buf, 0, msg);
-  EnforceMaxPrefixLen(value_buf);
-  const uint8_t *key_buf_begin = key_buf.empty() ? nullptr : &key_buf[0];
-  const uint8_t *value_buf_begin = value_buf.empty() ? nullptr : &value_buf[0];
-  WriteToLog(ComposeLogEntry(msg.GetTimestamp(), "DISC", "BAD_TOPIC",
-                 msg.GetTopic(), key_buf_begin, key_buf.size(),
-                 value_buf_begin, value_buf.size()));
+  TDiscardLogEntry entry;
+  entry.Event = TDiscardLogEvent::Discard;
+  entry.Info = TDiscardLogInfo::BadTopic;
+  CopyKeyAndValue(msg, entry);
+  Enqueue(std::move(entry));
 }
 
 void TDiscardFileLogger::LogLongMsgDiscard(const TMsg &msg) {
@@ -352,17 +376,92 @@ void TDiscardFileLogger::LogLongMsgDiscard(const TMsg &msg) {
     return;  // fast path for case where logging is disabled
   }
 
-  std::vector<uint8_t> key_buf;
-  WriteKey(key_buf, 0, msg);
-  EnforceMaxPrefixLen(key_buf);
-  std::vector<uint8_t> value_buf;
-  WriteValue(value_buf, 0, msg);
-  EnforceMaxPrefixLen(value_buf);
-  const uint8_t *key_buf_begin = key_buf.empty() ? nullptr : &key_buf[0];
-  const uint8_t *value_buf_begin = value_buf.empty() ? nullptr : &value_buf[0];
-  WriteToLog(ComposeLogEntry(msg.GetTimestamp(), "DISC", "LONG_MSG",
-                 msg.GetTopic(), key_buf_begin, key_buf.size(),
-                 value_buf_begin, value_buf.size()));
+  TDiscardLogEntry entry;
+  entry.Event = TDiscardLogEvent::Discard;
+  entry.Info = TDiscardLogInfo::LongMsg;
+  CopyKeyAndValue(msg, entry);
+  Enqueue(std::move(entry));
+}
+
+TDiscardFileLogger::TWriter::~TWriter() {
+  /* This will shut down the thread if something unexpected happens. */
+  ShutdownOnDestroy();
+}
+
+void TDiscardFileLogger::TWriter::Run() {
+  int tid = static_cast<int>(Gettid());
+  LOG(TPri::INFO) << "Discard log writer thread " << tid << " started";
+  bool caught_fatal_exception = false;
+
+  try {
+    DoRun();
+  } catch (const std::exception &x) {
+    caught_fatal_exception = true;
+    LOG(TPri::ERR) << "Fatal error in discard log writer thread " << tid
+        << ": " << x.what();
+  } catch (...) {
+    caught_fatal_exception = true;
+    LOG(TPri::ERR) << "Fatal unknown error in discard log writer thread "
+        << tid;
+  }
+
+  if (caught_fatal_exception) {
+    /* Logging threads will stop queueing entries. */
+    Logger.DisableLogging();
+  }
+
+  LOG(TPri::INFO) << "Discard log writer thread " << tid << " finished "
+      << (caught_fatal_exception ? "on error" : "normally");
+}
+
+void TDiscardFileLogger::TWriter::DoRun() {
+  std::array<struct pollfd, 2> events;
+  struct pollfd &shutdown_request_event = events[0];
+  struct pollfd &write_request_event = events[1];
+  shutdown_request_event.fd = GetShutdownRequestFd();
+  shutdown_request_event.events = POLLIN;
+  write_request_event.fd = Logger.WriteRequestSem.GetFd();
+  write_request_event.events = POLLIN;
+
+  for (; ; ) {
+    Logger.WriteQueuedEntries();
+
+    /* Announce that we are going to sleep, and then check the queue again.
+       A logging thread either sees the announcement after queueing its entry,
+       and wakes us, or queued its entry before our check. */
+    Logger.WriterSleeping.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (Logger.Queue->HasItem()) {
+      Logger.WriterSleeping.store(false);
+      continue;
+    }
+
+    for (auto &item : events) {
+      item.revents = 0;
+    }
+
+    /* We should have all signals blocked, so treat EINTR as fatal.  The
+       timeout covers a logging thread that was preempted between claiming and
+       filling a queue slot. */
+    int ret = Wr::poll(Wr::TDisp::AddFatal, {EINTR}, &events[0],
+        events.size(), 1000);
+    Logger.WriterSleeping.store(false);
+
+    if (shutdown_request_event.revents) {
+      LOG(TPri::INFO) << "Discard log writer thread got shutdown request";
+      size_t count = Logger.WriteQueuedEntries();
+      LOG(TPri::INFO) << "Discard log writer thread wrote " << count
+          << " remaining entries on shutdown";
+      break;
+    }
+
+    if (ret) {
+      assert(write_request_event.revents);
+      DiscardLogWriterWakeup.Increment();
+      Logger.WriteRequestSem.Pop();
+    }
+  }
 }
 
 TDiscardFileLogger::TArchiveCleaner::TArchiveCleaner(uint64_t max_archive_size,
@@ -735,8 +834,10 @@ bool TDiscardFileLogger::CheckMaxFileSize(uint64_t next_entry_size) {
     return false;
   }
 
-  if ((static_cast<uint64_t>(stat_buf.st_size) <= MaxFileSize) &&
-      ((MaxFileSize - stat_buf.st_size) >= next_entry_size)) {
+  FileSize = static_cast<uint64_t>(stat_buf.st_size);
+
+  if ((FileSize <= MaxFileSize) &&
+      ((MaxFileSize - FileSize) >= next_entry_size)) {
     return false;
   }
 
@@ -755,44 +856,145 @@ bool TDiscardFileLogger::CheckMaxFileSize(uint64_t next_entry_size) {
   }
 
   LogFd = OpenLogPath(LogPath.c_str());
-  return LogFd.IsOpen();
+  FileSize = 0;
+
+  if (!LogFd.IsOpen()) {
+    DisableLogging();
+    return false;
+  }
+
+  return true;
+}
+
+void TDiscardFileLogger::CopyKeyAndValue(const TMsg &msg,
+    TDiscardLogEntry &entry) {
+  entry.Now = GetEpochMilliseconds();
+  entry.Timestamp = msg.GetTimestamp();
+  entry.Topic = msg.GetTopic();
+  entry.HasPartitionKey =
+      (msg.GetRoutingType() == TMsg::TRoutingType::PartitionKey);
+  entry.PartitionKey = entry.HasPartitionKey ? msg.GetPartitionKey() : 0;
+  WriteKey(entry.Key, 0, msg);
+  entry.KeySize = entry.Key.size();
+  EnforceMaxPrefixLen(entry.Key);
+  WriteValue(entry.Value, 0, msg);
+  entry.ValueSize = entry.Value.size();
+  EnforceMaxPrefixLen(entry.Value);
 }
 
-void TDiscardFileLogger::WriteToLog(const std::string &log_entry) {
-  if (log_entry.empty()) {
+void TDiscardFileLogger::Enqueue(TDiscardLogEntry &&entry) {
+  assert(Queue);
+
+  if (!Queue->TryPush(std::move(entry))) {
+    /* Drop the entry rather than blocking the caller. */
+    DiscardLogEntryDropQueueFull.Increment();
+    LOG_R(TPri::WARNING, std::chrono::seconds(30))
+        << "Dropping discard log entries because writer thread is behind";
     return;
   }
 
-  std::lock_guard<std::mutex> lock(Mutex);
+  /* Pairs with the fence in TWriter::DoRun(). */
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (WriterSleeping.load(std::memory_order_relaxed) &&
+      WriterSleeping.exchange(false)) {
+    WriteRequestSem.Push();
+  }
+}
+
+void TDiscardFileLogger::EncodeEntry(const TDiscardLogEntry &entry) {
+  EntryBuf.clear();
 
-  /* No other thread can change 'Enabled' while we hold 'Mutex'.  Even if we
-     just checked 'Enabled' before grabbing 'Mutex', test it again in case it
-     changed. */
+  if (Format == TFormat::Binary) {
+    if (FileSize == 0 && WriteBuf.empty()) {
+      Encoder.StartFile(EntryBuf);
+    }
+
+    Encoder.Encode(entry, EntryBuf);
+  } else {
+    AppendDiscardLogText(entry, EntryBuf);
+  }
+}
+
+void TDiscardFileLogger::BufferEntry(const TDiscardLogEntry &entry) {
   if (!Enabled) {
     return;
   }
 
   assert(LogFd.IsOpen());
   assert(ArchiveCleaner);
+  EncodeEntry(entry);
+
+  if ((FileSize + WriteBuf.size() + EntryBuf.size()) > MaxFileSize) {
+    FlushWriteBuf();
 
-  if (CheckMaxFileSize(log_entry.size())) {
-    if (ArchiveCleaner->GetShutdownWaitFd().IsReadable()) {
-      LOG(TPri::WARNING) << "Disabling discard file logging because discard "
-          << "log cleaner thread shut down unexpectedly";
-      DisableLogging();
+    if (!Enabled) {
       return;
     }
 
-    ArchiveCleaner->SendCleanRequest();
+    if (CheckMaxFileSize(EntryBuf.size())) {
+      if (ArchiveCleaner->GetShutdownWaitFd().IsReadable()) {
+        LOG(TPri::WARNING) << "Disabling discard file logging because "
+            << "discard log cleaner thread shut down unexpectedly";
+        DisableLogging();
+        return;
+      }
+
+      ArchiveCleaner->SendCleanRequest();
+
+      /* A binary entry must be encoded again for the new file, since its
+         topic definitions start over. */
+      EncodeEntry(entry);
+    }
+
+    if (!Enabled) {
+      return;
+    }
   }
 
-  ssize_t ret = Wr::write(LogFd, log_entry.data(), log_entry.size());
+  WriteBuf += EntryBuf;
+  DiscardLogEntryWritten.Increment();
+}
 
-  if (ret < 0) {
-    LOG_ERRNO(TPri::ERR, errno) << "Failed to write to discard logfile: ";
-  } else if (static_cast<size_t>(ret) < log_entry.size()) {
-    LOG(TPri::ERR)
-        << "write() to discard logfile returned short count: expected "
-        << log_entry.size() << " actual " << ret;
+void TDiscardFileLogger::FlushWriteBuf() {
+  if (WriteBuf.empty()) {
+    return;
   }
+
+  if (Enabled) {
+    DiscardLogWrite.Increment();
+    ssize_t ret = Wr::write(LogFd, WriteBuf.data(), WriteBuf.size());
+
+    if (ret < 0) {
+      LOG_ERRNO(TPri::ERR, errno) << "Failed to write to discard logfile: ";
+    } else {
+      FileSize += static_cast<size_t>(ret);
+
+      if (static_cast<size_t>(ret) < WriteBuf.size()) {
+        LOG(TPri::ERR)
+            << "write() to discard logfile returned short count: expected "
+            << WriteBuf.size() << " actual " << ret;
+      }
+    }
+  }
+
+  WriteBuf.clear();
+}
+
+size_t TDiscardFileLogger::WriteQueuedEntries() {
+  assert(Queue);
+  size_t count = 0;
+  TDiscardLogEntry entry;
+
+  while (Queue->TryPop(entry)) {
+    BufferEntry(entry);
+    ++count;
+
+    if (WriteBuf.size() >= WRITE_BUF_FLUSH_SIZE) {
+      FlushWriteBuf();
+    }
+  }
+
+  FlushWriteBuf();
+  return count;
 }
@@ -21,6 +21,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <limits>
@@ -32,8 +33,12 @@
 
 #include <base/event_semaphore.h>
 #include <base/fd.h>
+#include <base/mpsc_ring.h>
 #include <base/no_copy_semantics.h>
 #include <base/thrower.h>
+#include <dory/binary_discard_log.h>
+#include <dory/conf/discard_logging_conf.h>
+#include <dory/discard_log_entry.h>
 #include <dory/msg.h>
 #include <thread/fd_managed_thread.h>
 
@@ -44,7 +49,13 @@ namespace Dory {
      within dory rather than relying on logrotate eliminates any possibility
      of a log entry getting split across files.  Deleting old logfiles is done
      in a separate thread, since this may be a slow operation and we don't want
-     the input thread to get delayed. */
+     the input thread to get delayed.
+
+     Logging methods don't do any I/O.  They copy the entry's contents into a
+     bounded lock-free queue, and a writer thread formats queued entries and
+     writes them with one write() per batch.  The writer also handles logfile
+     rotation.  If the queue is full, the entry is dropped and counted, since
+     blocking threads that are discarding messages would make things worse. */
   class TDiscardFileLogger final {
     NO_COPY_SEMANTICS(TDiscardFileLogger);
 
@@ -65,9 +76,15 @@ namespace Dory {
       ServerShutdown,
       NoAvailablePartitions,
       RateLimit,
-      FailedTopicAutocreate
+      FailedTopicAutocreate,
+      FailedSpill
     };
 
+    using TFormat = Conf::TDiscardLoggingConf::TFormat;
+
+    /* Default maximum number of entries waiting for the writer thread. */
+    static const size_t DEFAULT_QUEUE_SIZE = 16 * 1024;
+
     TDiscardFileLogger() = default;
 
     ~TDiscardFileLogger();
@@ -99,13 +116,23 @@ namespace Dory {
        an integer number of milliseconds since the epoch.  If the combined size
        of all old logfiles exceeds 'max_archive_size', then old logfiles are
        deleted in order from oldest to newest until 'max_archive_size' is no
-       longer exceeded. */
-    void Init(const char *log_path, uint64_t max_file_size,
-              uint64_t max_archive_size, size_t max_msg_prefix_len);
+       longer exceeded.
+
+       'format' specifies text or binary logfiles.  In binary format, an
+       existing logfile is renamed as described above, so each file starts
+       with a header.
 
-    /* Call this to disable logging and shut down the thread that deletes old
-       logfiles.  It is harmless to call this method once or multiple times,
-       even if Init() has never been called. */
+       'queue_size' specifies the maximum number of entries waiting to be
+       written.  It is rounded up to a power of 2. */
+    void Init(const char *log_path, uint64_t max_file_size,
+              uint64_t max_archive_size, size_t max_msg_prefix_len,
+              TFormat format = TFormat::Text,
+              size_t queue_size = DEFAULT_QUEUE_SIZE);
+
+    /* Call this to disable logging and shut down the writer thread and the
+       thread that deletes old logfiles.  Entries queued before the call are
+       written first.  It is harmless to call this method once or multiple
+       times, even if Init() has never been called. */
     void Shutdown();
 
     /* Write a log entry indicating that 'msg' is being discarded for the
@@ -223,6 +250,26 @@ namespace Dory {
       Base::TEventSemaphore CleanRequestSem;
     };  // TArchiveCleaner
 
+    /* Thread that formats and writes queued log entries. */
+    class TWriter final : public Thread::TFdManagedThread {
+      NO_COPY_SEMANTICS(TWriter);
+
+      public:
+      explicit TWriter(TDiscardFileLogger &logger)
+          : Logger(logger) {
+      }
+
+      ~TWriter() override;
+
+      protected:
+      void Run() override;
+
+      private:
+      void DoRun();
+
+      TDiscardFileLogger &Logger;
+    };  // TWriter
+
     static void ParseLogPath(const char *log_path, std::string &log_dir,
         std::string &log_filename);
 
@@ -237,20 +284,52 @@ namespace Dory {
 
     bool CheckMaxFileSize(uint64_t next_entry_size);
 
-    void WriteToLog(const std::string &log_entry);
+    /* Called by logging threads.  Copy key and value of 'msg' into
+       'entry'. */
+    void CopyKeyAndValue(const TMsg &msg, TDiscardLogEntry &entry);
+
+    /* Called by logging threads.  Queue 'entry' for the writer thread. */
+    void Enqueue(TDiscardLogEntry &&entry);
+
+    /* Called by writer thread.  Encode 'entry' into 'EntryBuf' in the
+       configured format. */
+    void EncodeEntry(const TDiscardLogEntry &entry);
+
+    /* Called by writer thread.  Encode 'entry' and append it to 'WriteBuf',
+       first writing out 'WriteBuf' and starting a new logfile if necessary. */
+    void BufferEntry(const TDiscardLogEntry &entry);
+
+    /* Called by writer thread. */
+    void FlushWriteBuf();
+
+    /* Called by writer thread.  Write and remove queued entries until the
+       queue is empty, and return the number written. */
+    size_t WriteQueuedEntries();
 
     /* Upper bound in bytes on the key or value size of a discarded message to
        log.  Keys or values longer than this length will be truncated. */
     size_t MaxMsgPrefixLen = std::numeric_limits<size_t>::max();
 
-    /* Protects everything below.  However, reads of boolean 'Enabled' value
-       may occur without acquiring 'Mutex' */
+    /* Serializes calls to Shutdown(). */
     std::mutex Mutex;
 
-    /* Indicates whether logging is enabled.  Threads may read this value
-       without holding 'Mutex', but value is never modified without holding
-       'Mutex'. */
-    bool Enabled = false;
+    /* Indicates whether logging is enabled.  Cleared by Shutdown() or by the
+       writer thread on error. */
+    std::atomic<bool> Enabled{false};
+
+    /* Entries waiting for the writer thread. */
+    std::unique_ptr<Base::TMpscRing<TDiscardLogEntry>> Queue;
+
+    /* Set by the writer thread before it sleeps.  A logging thread that
+       clears it after queueing an entry pushes 'WriteRequestSem'. */
+    std::atomic<bool> WriterSleeping{false};
+
+    Base::TEventSemaphore WriteRequestSem;
+
+    std::unique_ptr<TWriter> Writer;
+
+    /* Members below are set by Init().  After that, only the writer thread
+       uses them until Shutdown() stops it. */
 
     /* Thread that deletes old logfiles. */
     std::unique_ptr<TArchiveCleaner> ArchiveCleaner;
@@ -273,8 +352,22 @@ namespace Dory {
        violated until log cleaning thread runs. */
     uint64_t MaxArchiveSize = 0;
 
+    TFormat Format = TFormat::Text;
+
+    /* Tracks topic definitions in the current logfile, in binary format. */
+    TBinaryDiscardLogEncoder Encoder;
+
     /* Descriptor for logfile. */
     Base::TFd LogFd;
+
+    /* Size in bytes of logfile, not including 'WriteBuf'. */
+    uint64_t FileSize = 0;
+
+    /* Encoded entries not yet written. */
+    std::string WriteBuf;
+
+    /* Holds a single encoded entry, to avoid allocating memory for each. */
+    std::string EntryBuf;
   };  // TDiscardFileLogger
 
 }  // Dory
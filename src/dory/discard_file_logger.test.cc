@@ -0,0 +1,225 @@
+/* <dory/discard_file_logger.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2013-2014 if(we)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit test for <dory/discard_file_logger.h>
+ */
+
+#include <dory/discard_file_logger.h>
+
+#include <cstddef>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+
+#include <base/dir_iter.h>
+#include <base/fd.h>
+#include <base/file_reader.h>
+#include <base/tmp_dir.h>
+#include <base/tmp_file.h>
+#include <base/wr/file_util.h>
+#include <dory/binary_discard_log.h>
+#include <dory/msg_creator.h>
+#include <dory/test_util/misc_util.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::TestUtil;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TDiscardFileLogger. */
+  class TDiscardFileLoggerTest : public ::testing::Test {
+    protected:
+    TDiscardFileLoggerTest() = default;
+
+    ~TDiscardFileLoggerTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TDiscardFileLoggerTest
+
+  size_t CountLines(const std::string &s, const char *substr) {
+    size_t count = 0;
+
+    for (size_t pos = s.find(substr); pos != std::string::npos;
+         pos = s.find(substr, pos + 1)) {
+      ++count;
+    }
+
+    return count;
+  }
+
+  TEST_F(TDiscardFileLoggerTest, ManyThreadsTest) {
+    const size_t thread_count = 4;
+    const size_t msgs_per_thread = 500;
+    TTmpDir tmp_dir("/tmp/discard_file_logger_test.XXXXXX", true);
+    std::string log_path = tmp_dir.GetName() + "/discard.log";
+    TDiscardFileLogger logger;
+    logger.Init(log_path.c_str(), 1024 * 1024 * 1024, 1024 * 1024 * 1024,
+        1024, TDiscardFileLogger::TFormat::Text, 64);
+    TTestMsgCreator mc;
+    std::vector<std::vector<TMsg::TPtr>> msgs(thread_count);
+
+    for (size_t i = 0; i < thread_count; ++i) {
+      for (size_t j = 0; j < msgs_per_thread; ++j) {
+        msgs[i].push_back(mc.NewMsg("topic" + std::to_string(i), "value", 0,
+            true));
+      }
+    }
+
+    /* The queue is empty, so these won't be dropped. */
+    const char bad_topic[] = "bad";
+    logger.LogBadTopicDiscard(0, bad_topic, bad_topic + 3, nullptr, nullptr,
+        nullptr, nullptr);
+    logger.LogUnsupportedApiKeyDiscard(nullptr, nullptr, 7);
+
+    std::vector<std::thread> threads;
+
+    for (auto &msg_vec : msgs) {
+      threads.emplace_back(
+          [&logger, &msg_vec] {
+            for (auto &msg : msg_vec) {
+              logger.LogDiscard(msg,
+                  TDiscardFileLogger::TDiscardReason::KafkaErrorAck);
+              logger.LogDuplicate(msg);
+            }
+          });
+    }
+
+    for (auto &t : threads) {
+      t.join();
+    }
+
+    /* Everything queued gets written on shutdown. */
+    logger.Shutdown();
+    std::string contents = TFileReader(log_path.c_str()).ReadIntoString();
+    size_t disc = CountLines(contents, "event: DISC info: KAFKA_ERROR_ACK");
+    size_t dup = CountLines(contents, "event: DUP info: NONE");
+    ASSERT_EQ(CountLines(contents, "\n"), disc + dup + 2);
+    ASSERT_EQ(CountLines(contents, "info: BAD_TOPIC topic: 3[bad]"), 1U);
+    ASSERT_EQ(CountLines(contents, "info: API_KEY(7) topic: 0[]"), 1U);
+
+    /* The queue is small, so some entries may have been dropped, but not all
+       of them. */
+    ASSERT_GT(disc, 0U);
+    ASSERT_LE(disc, thread_count * msgs_per_thread);
+    ASSERT_LE(dup, thread_count * msgs_per_thread);
+  }
+
+  TEST_F(TDiscardFileLoggerTest, RotationTest) {
+    TTmpDir tmp_dir("/tmp/discard_file_logger_test.XXXXXX", true);
+    std::string log_path = tmp_dir.GetName() + "/discard.log";
+    TDiscardFileLogger logger;
+    logger.Init(log_path.c_str(), 1024, 1024 * 1024, 1024);
+    TTestMsgCreator mc;
+    TMsg::TPtr msg = mc.NewMsg("topic", std::string(100, 'x'), 0, true);
+
+    for (size_t i = 0; i < 30; ++i) {
+      logger.LogDiscard(msg, TDiscardFileLogger::TDiscardReason::RateLimit);
+    }
+
+    logger.Shutdown();
+    size_t file_count = 0;
+
+    for (TDirIter iter(tmp_dir.GetName().c_str()); iter; ++iter) {
+      if (iter.GetKind() == TDirIter::File) {
+        ++file_count;
+        std::string path = tmp_dir.GetName() + "/" + iter.GetName();
+        ASSERT_LE(TFileReader(path.c_str()).GetSize(), 1024U);
+      }
+    }
+
+    ASSERT_GT(file_count, 1U);
+  }
+
+  TEST_F(TDiscardFileLoggerTest, BinaryRotationTest) {
+    TTmpDir tmp_dir("/tmp/discard_file_logger_test.XXXXXX", true);
+    std::string log_path = tmp_dir.GetName() + "/discard.log";
+    TDiscardFileLogger logger;
+    logger.Init(log_path.c_str(), 1024, 1024 * 1024, 1024,
+        TDiscardFileLogger::TFormat::Binary);
+    TTestMsgCreator mc;
+    TMsg::TPtr msg = mc.NewMsg("topic", std::string(100, 'x'), 0, true);
+    const std::string topic("topic");
+    const std::string value(100, 'y');
+    TMsg::TPtr key_msg = TMsgCreator::CreatePartitionKeyMsg(42, 0,
+        topic.data(), topic.data() + topic.size(), nullptr, 0, value.data(),
+        value.size(), false, *mc.Pool, mc.MsgStateTracker);
+    SetProcessed(key_msg);
+
+    for (size_t i = 0; i < 30; ++i) {
+      logger.LogDiscard((i % 2) ? key_msg : msg,
+          TDiscardFileLogger::TDiscardReason::RateLimit);
+    }
+
+    logger.Shutdown();
+    size_t file_count = 0;
+    size_t entry_count = 0;
+
+    /* Each file must be readable on its own. */
+    for (TDirIter iter(tmp_dir.GetName().c_str()); iter; ++iter) {
+      if (iter.GetKind() == TDirIter::File) {
+        ++file_count;
+        std::string path = tmp_dir.GetName() + "/" + iter.GetName();
+        ASSERT_LE(TFileReader(path.c_str()).GetSize(), 1024U);
+        TFd fd(Wr::open(path.c_str(), O_RDONLY));
+        ASSERT_TRUE(fd.IsOpen());
+        TBinaryDiscardLogReader reader(fd);
+        TDiscardLogEntry entry;
+
+        while (reader.Read(entry)) {
+          ++entry_count;
+          ASSERT_EQ(entry.Event, TDiscardLogEvent::Discard);
+          ASSERT_EQ(entry.Info, TDiscardLogInfo::RateLimit);
+          ASSERT_EQ(entry.Topic, "topic");
+          ASSERT_EQ(entry.Value.size(), 100U);
+          ASSERT_EQ(entry.ValueSize, 100U);
+          ASSERT_FALSE(entry.IsTruncated());
+
+          /* The partition key is kept, so reinjected messages are routed as
+             before. */
+          const bool has_key = (entry.Value[0] == 'y');
+          ASSERT_EQ(entry.HasPartitionKey, has_key);
+          ASSERT_EQ(entry.PartitionKey, has_key ? 42 : 0);
+        }
+      }
+    }
+
+    /* Archived files are named by time in milliseconds, so a file may be
+       replaced by a newer one renamed within the same millisecond. */
+    ASSERT_GT(file_count, 1U);
+    ASSERT_GT(entry_count, 0U);
+    ASSERT_LE(entry_count, 30U);
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
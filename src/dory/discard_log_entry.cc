@@ -0,0 +1,142 @@
+/* <dory/discard_log_entry.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/discard_log_entry.h>.
+ */
+
+#include <dory/discard_log_entry.h>
+
+#include <base/no_default_case.h>
+#include <third_party/base64/base64.h>
+
+using namespace Dory;
+
+const char *Dory::ToString(TDiscardLogEvent event) noexcept {
+  switch (event) {
+    case TDiscardLogEvent::Discard: {
+      return "DISC";
+    }
+    case TDiscardLogEvent::Duplicate: {
+      return "DUP";
+    }
+    NO_DEFAULT_CASE;
+  }
+
+  return "BUG";
+}
+
+const char *Dory::ToString(TDiscardLogInfo info) noexcept {
+  switch (info) {
+    case TDiscardLogInfo::None: {
+      return "NONE";
+    }
+    case TDiscardLogInfo::Bug: {
+      return "BUG";
+    }
+    case TDiscardLogInfo::DeliveryAttemptLimit: {
+      return "DELIVERY_ATTEMPT_LIMIT";
+    }
+    case TDiscardLogInfo::KafkaErrorAck: {
+      return "KAFKA_ERROR_ACK";
+    }
+    case TDiscardLogInfo::ServerShutdown: {
+      return "SERVER_SHUTDOWN";
+    }
+    case TDiscardLogInfo::NoAvailablePartitions: {
+      return "NO_AVAILABLE_PARTITIONS";
+    }
+    case TDiscardLogInfo::RateLimit: {
+      return "RATE_LIMIT";
+    }
+    case TDiscardLogInfo::TopicAutocreateFail: {
+      return "TOPIC_AUTOCREATE_FAIL";
+    }
+    case TDiscardLogInfo::NoMem: {
+      return "NO_MEM";
+    }
+    case TDiscardLogInfo::Malformed: {
+      return "MALFORMED";
+    }
+    case TDiscardLogInfo::UncleanTcp: {
+      return "UNCLEAN_T";
+    }
+    case TDiscardLogInfo::UncleanUnix: {
+      return "UNCLEAN_U";
+    }
+    case TDiscardLogInfo::ApiKey: {
+      return "API_KEY";
+    }
+    case TDiscardLogInfo::Version: {
+      return "VERSION";
+    }
+    case TDiscardLogInfo::BadTopic: {
+      return "BAD_TOPIC";
+    }
+    case TDiscardLogInfo::LongMsg: {
+      return "LONG_MSG";
+    }
+    case TDiscardLogInfo::SpillFail: {
+      return "SPILL_FAIL";
+    }
+    NO_DEFAULT_CASE;
+  }
+
+  return "BUG";
+}
+
+static void AppendEncoded(const std::vector<uint8_t> &data,
+    std::string &out) {
+  std::string encoded;
+
+  if (!data.empty()) {
+    encoded = base64_encode(&data[0], static_cast<unsigned int>(data.size()));
+  }
+
+  out += std::to_string(encoded.size());
+  out += "[";
+  out += encoded;
+  out += "]";
+}
+
+void Dory::AppendDiscardLogText(const TDiscardLogEntry &entry,
+    std::string &out) {
+  out += "now: ";
+  out += std::to_string(entry.Now);
+  out += " ts: ";
+  out += std::to_string(entry.Timestamp);
+  out += " event: ";
+  out += ToString(entry.Event);
+  out += " info: ";
+  out += ToString(entry.Info);
+
+  if (entry.HasInfoArg) {
+    out += "(";
+    out += std::to_string(entry.InfoArg);
+    out += ")";
+  }
+
+  out += " topic: ";
+  out += std::to_string(entry.Topic.size());
+  out += "[";
+  out += entry.Topic;
+  out += "] key: ";
+  AppendEncoded(entry.Key, out);
+  out += " msg: ";
+  AppendEncoded(entry.Value, out);
+  out += "\n";
+}
@@ -0,0 +1,117 @@
+/* <dory/discard_log_entry.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Contents of a discard logfile entry, and its text representation.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Dory {
+
+  /* Kind of event that a discard logfile entry records.  Values appear in
+     binary discard logfiles, so they must not change. */
+  enum class TDiscardLogEvent : uint8_t {
+    Discard = 0,
+    Duplicate = 1
+  };  // TDiscardLogEvent
+
+  /* Detail about the event, such as the reason for a discard.  Values appear
+     in binary discard logfiles, so they must not change. */
+  enum class TDiscardLogInfo : uint8_t {
+    None = 0,
+    Bug = 1,
+    DeliveryAttemptLimit = 2,
+    KafkaErrorAck = 3,
+    ServerShutdown = 4,
+    NoAvailablePartitions = 5,
+    RateLimit = 6,
+    TopicAutocreateFail = 7,
+    NoMem = 8,
+    Malformed = 9,
+    UncleanTcp = 10,
+    UncleanUnix = 11,
+    ApiKey = 12,
+    Version = 13,
+    BadTopic = 14,
+    LongMsg = 15,
+    SpillFail = 16
+  };  // TDiscardLogInfo
+
+  /* Highest valid value of TDiscardLogInfo. */
+  const uint8_t MAX_DISCARD_LOG_INFO =
+      static_cast<uint8_t>(TDiscardLogInfo::SpillFail);
+
+  const char *ToString(TDiscardLogEvent event) noexcept;
+
+  const char *ToString(TDiscardLogInfo info) noexcept;
+
+  struct TDiscardLogEntry {
+    /* Time when entry was logged, in milliseconds since the epoch. */
+    uint64_t Now = 0;
+
+    /* Message timestamp. */
+    int64_t Timestamp = 0;
+
+    TDiscardLogEvent Event = TDiscardLogEvent::Discard;
+
+    TDiscardLogInfo Info = TDiscardLogInfo::None;
+
+    /* If true, 'InfoArg' qualifies 'Info', such as the unsupported version
+       for TDiscardLogInfo::Version. */
+    bool HasInfoArg = false;
+
+    int32_t InfoArg = 0;
+
+    /* Empty for entries such as malformed messages, whose topics are
+       unknown. */
+    std::string Topic;
+
+    /* If true, the message was sent as a PartitionKey message, and
+       'PartitionKey' is its partition key.  Otherwise it was sent as an
+       AnyPartition message, or its routing is unknown. */
+    bool HasPartitionKey = false;
+
+    int32_t PartitionKey = 0;
+
+    /* Key and value, possibly truncated to the maximum message prefix size.
+       For entries such as malformed messages, 'Value' holds a prefix of the
+       raw message. */
+    std::vector<uint8_t> Key;
+
+    std::vector<uint8_t> Value;
+
+    /* Sizes before truncation. */
+    size_t KeySize = 0;
+
+    size_t ValueSize = 0;
+
+    bool IsTruncated() const noexcept {
+      return (Key.size() < KeySize) || (Value.size() < ValueSize);
+    }
+  };  // TDiscardLogEntry
+
+  /* Append the text logfile representation of 'entry', including the trailing
+     newline, to 'out'. */
+  void AppendDiscardLogText(const TDiscardLogEntry &entry, std::string &out);
+
+}  // Dory
@@ -0,0 +1,339 @@
+/* <dory/discard_reader/dory_discard_reader.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Offline reader for binary discard logfiles.  Prints entries in the text
+   discard log format, or sends discarded messages back to Dory.
+ */
+
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <netinet/in.h>
+
+#include <base/basename.h>
+#include <base/fd.h>
+#include <base/no_default_case.h>
+#include <base/wr/file_util.h>
+#include <dory/binary_discard_log.h>
+#include <dory/build_id.h>
+#include <dory/client/dory_client.h>
+#include <dory/client/status_codes.h>
+#include <dory/client/tcp_sender.h>
+#include <dory/client/unix_dg_sender.h>
+#include <dory/client/unix_stream_sender.h>
+#include <dory/discard_log_entry.h>
+#include <dory/util/invalid_arg_error.h>
+#include <tclap/CmdLine.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Client;
+using namespace Dory::Util;
+
+struct TCmdLineArgs {
+  /* Throws TInvalidArgError on error parsing args. */
+  TCmdLineArgs(int argc, const char *const argv[]);
+
+  /* Binary discard logfiles to read, in order. */
+  std::vector<std::string> InputFiles;
+
+  /* For UNIX domain datagram socket input to Dory. */
+  std::string SocketPath;
+
+  /* For UNIX domain stream socket input to Dory. */
+  std::string StreamSocketPath;
+
+  /* For local TCP input to Dory. */
+  std::optional<in_port_t> Port;
+
+  bool IncludeDuplicates = false;
+
+  bool AllowTruncated = false;
+
+  /* True if messages are sent to Dory rather than printed. */
+  bool Reinject = false;
+};  // TCmdLineArgs
+
+static void ParseArgs(int argc, const char *const argv[],
+    TCmdLineArgs &args) {
+  using namespace TCLAP;
+  const std::string prog_name = Basename(argv[0]);
+  std::vector<const char *> arg_vec(&argv[0], &argv[0] + argc);
+  arg_vec[0] = prog_name.c_str();
+
+  try {
+    CmdLine cmd("Utility for reading binary Dory discard logfiles.  By "
+        "default, entries are printed in the text discard log format.  If a "
+        "socket or port is specified, discarded messages are sent to Dory "
+        "instead.", ' ', dory_build_id);
+    ValueArg<decltype(args.SocketPath)> arg_socket_path("", "socket-path",
+        "Pathname of UNIX domain datagram socket for sending messages to "
+        "Dory.",
+        false, args.SocketPath, "PATH");
+    cmd.add(arg_socket_path);
+    ValueArg<decltype(args.StreamSocketPath)> arg_stream_socket_path("",
+        "stream-socket-path",
+        "Pathname of UNIX domain stream socket for sending messages to Dory.",
+        false, args.StreamSocketPath, "PATH");
+    cmd.add(arg_stream_socket_path);
+    ValueArg<std::remove_reference<decltype(*args.Port)>::type>
+        arg_port("", "port", "Local TCP port for sending messages to Dory.",
+        false, 0, "PORT");
+    cmd.add(arg_port);
+    SwitchArg arg_include_duplicates("", "include-duplicates",
+        "When sending messages to Dory, also send messages logged as "
+        "possible duplicates.", cmd, args.IncludeDuplicates);
+    SwitchArg arg_allow_truncated("", "allow-truncated",
+        "When sending messages to Dory, also send messages whose key or "
+        "value was truncated to the configured maximum prefix size.", cmd,
+        args.AllowTruncated);
+    UnlabeledMultiArg<std::string> arg_input_files("files",
+        "Binary discard logfiles.", true, "FILE");
+    cmd.add(arg_input_files);
+    cmd.parse(argc, &arg_vec[0]);
+    args.InputFiles = arg_input_files.getValue();
+    args.SocketPath = arg_socket_path.getValue();
+    args.StreamSocketPath = arg_stream_socket_path.getValue();
+    size_t output_type_count = 0;
+
+    if (arg_port.isSet()) {
+      in_port_t port = arg_port.getValue();
+
+      if (port < 1) {
+        throw TInvalidArgError("Invalid port");
+      }
+
+      args.Port.emplace(port);
+      ++output_type_count;
+    }
+
+    if (arg_socket_path.isSet()) {
+      ++output_type_count;
+    }
+
+    if (arg_stream_socket_path.isSet()) {
+      ++output_type_count;
+    }
+
+    if (output_type_count > 1) {
+      throw TInvalidArgError(
+          "At most one of (--socket-path, --stream-socket-path, --port) "
+          "options may be specified.");
+    }
+
+    args.Reinject = (output_type_count != 0);
+    args.IncludeDuplicates = arg_include_duplicates.getValue();
+    args.AllowTruncated = arg_allow_truncated.getValue();
+  } catch (const ArgException &x) {
+    throw TInvalidArgError(x.error(), x.argId());
+  }
+}
+
+TCmdLineArgs::TCmdLineArgs(int argc, const char *const argv[]) {
+  ParseArgs(argc, argv, *this);
+}
+
+static std::unique_ptr<TClientSenderBase> CreateSender(
+    const TCmdLineArgs &cfg) {
+  if (!cfg.SocketPath.empty()) {
+    return std::unique_ptr<TClientSenderBase>(
+        new TUnixDgSender(cfg.SocketPath.c_str()));
+  }
+
+  if (!cfg.StreamSocketPath.empty()) {
+    return std::unique_ptr<TClientSenderBase>(
+        new TUnixStreamSender(cfg.StreamSocketPath.c_str()));
+  }
+
+  assert(cfg.Port.has_value());
+  return std::unique_ptr<TClientSenderBase>(new TTcpSender(*cfg.Port));
+}
+
+/* Counts reported when the program finishes. */
+struct TStats {
+  size_t Read = 0;
+
+  size_t Sent = 0;
+
+  size_t SkippedDuplicate = 0;
+
+  size_t SkippedTruncated = 0;
+
+  /* Entries with no topic, such as malformed messages. */
+  size_t SkippedNoTopic = 0;
+
+  size_t SkippedTooLarge = 0;
+};  // TStats
+
+/* Return true if 'entry' should be sent to Dory. */
+static bool ShouldSend(const TDiscardLogEntry &entry,
+    const TCmdLineArgs &cfg, TStats &stats) {
+  if (entry.Topic.empty()) {
+    ++stats.SkippedNoTopic;
+    return false;
+  }
+
+  if ((entry.Event == TDiscardLogEvent::Duplicate) &&
+      !cfg.IncludeDuplicates) {
+    ++stats.SkippedDuplicate;
+    return false;
+  }
+
+  if (entry.IsTruncated() && !cfg.AllowTruncated) {
+    ++stats.SkippedTruncated;
+    return false;
+  }
+
+  return true;
+}
+
+/* Write a message for 'entry' into 'buf', preserving its original timestamp
+   and partition key.  Return false if the message is too large to send. */
+static bool CreateDg(std::vector<uint8_t> &buf,
+    const TDiscardLogEntry &entry) {
+  size_t msg_size = 0;
+  const int size_ret = entry.HasPartitionKey ?
+      dory_find_partition_key_msg_size(entry.Topic.size(), entry.Key.size(),
+          entry.Value.size(), &msg_size) :
+      dory_find_any_partition_msg_size(entry.Topic.size(), entry.Key.size(),
+          entry.Value.size(), &msg_size);
+
+  switch (size_ret) {
+    case DORY_OK:
+      break;
+    case DORY_TOPIC_TOO_LARGE:
+    case DORY_MSG_TOO_LARGE:
+      return false;
+    NO_DEFAULT_CASE;
+  }
+
+  buf.resize(msg_size);
+  const void *key = entry.Key.empty() ? nullptr : &entry.Key[0];
+  const void *value = entry.Value.empty() ? nullptr : &entry.Value[0];
+  [[maybe_unused]] int ret = entry.HasPartitionKey ?
+      dory_write_partition_key_msg(&buf[0], buf.size(), entry.PartitionKey,
+          entry.Topic.c_str(), entry.Timestamp, key, entry.Key.size(), value,
+          entry.Value.size()) :
+      dory_write_any_partition_msg(&buf[0], buf.size(), entry.Topic.c_str(),
+          entry.Timestamp, key, entry.Key.size(), value, entry.Value.size());
+  assert(ret == DORY_OK);
+  return true;
+}
+
+static int DoryDiscardReaderMain(int argc, const char *const argv[]) {
+  std::unique_ptr<TCmdLineArgs> args;
+
+  try {
+    args.reset(new TCmdLineArgs(argc, argv));
+  } catch (const TInvalidArgError &x) {
+    /* Error parsing command line arguments. */
+    std::cerr << x.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::unique_ptr<TClientSenderBase> sender;
+
+  if (args->Reinject) {
+    sender = CreateSender(*args);
+    sender->PrepareToSend();
+  }
+
+  TStats stats;
+  TDiscardLogEntry entry;
+  std::vector<uint8_t> dg_buf;
+  std::string text;
+
+  for (const std::string &path : args->InputFiles) {
+    const int fd_value = Wr::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (fd_value < 0) {
+      std::cerr << "error: failed to open " << path << ": "
+          << std::strerror(errno) << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    TFd fd(fd_value);
+
+    TBinaryDiscardLogReader reader(fd);
+
+    try {
+      while (reader.Read(entry)) {
+        ++stats.Read;
+
+        if (!args->Reinject) {
+          text.clear();
+          AppendDiscardLogText(entry, text);
+          std::cout << text;
+          continue;
+        }
+
+        if (!ShouldSend(entry, *args, stats)) {
+          continue;
+        }
+
+        if (!CreateDg(dg_buf, entry)) {
+          ++stats.SkippedTooLarge;
+          continue;
+        }
+
+        sender->Send(&dg_buf[0], dg_buf.size());
+        ++stats.Sent;
+      }
+    } catch (const TBinaryDiscardLogReader::TBadDiscardLog &x) {
+      /* Report the problem and go on to the next file, since a file that dory
+         was writing when it was copied may end in a partial record. */
+      std::cerr << "error: " << path << ": " << x.what() << std::endl;
+    }
+  }
+
+  std::cout.flush();
+
+  if (args->Reinject) {
+    std::cerr << stats.Read << " entries read, " << stats.Sent
+        << " messages sent, skipped " << stats.SkippedDuplicate
+        << " duplicate, " << stats.SkippedTruncated << " truncated, "
+        << stats.SkippedNoTopic << " without topic, "
+        << stats.SkippedTooLarge << " too large" << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, const char *const argv[]) {
+  try {
+    return DoryDiscardReaderMain(argc, argv);
+  } catch (const std::exception &ex) {
+    std::cerr << "error: " << ex.what() << std::endl;
+  } catch (...) {
+    std::cerr << "error: unknown exception" << std::endl;
+  }
+
+  return EXIT_FAILURE;
+}
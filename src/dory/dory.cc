@@ -37,6 +37,7 @@
 #include <dory/util/dory_xml_init.h>
 #include <dory/util/invalid_arg_error.h>
 #include <dory/util/misc_util.h>
+#include <log/async_log_sink.h>
 #include <log/log.h>
 #include <log_util/init_logging.h>
 #include <server/daemonize.h>
@@ -137,6 +138,12 @@ static int DoryMain(int argc, char *const argv[]) {
      https://pubs.opengroup.org/onlinepubs/9699919799/functions/fork.html ). */
   TSignalHandlerThreadStarter signal_handler_starter;
 
+  /* Start this after the signal handler thread, so the background thread
+     inherits a mask with all signals blocked. */
+  if (conf.LoggingConf.AsyncWrites) {
+    GetAsyncLogSink().Start(conf.LoggingConf.AsyncThreadBufferSize);
+  }
+
   TDoryServer::PrepareForInit(conf);
   std::unique_ptr<TDoryServer> dory;
 
@@ -159,7 +166,10 @@ static int DoryMain(int argc, char *const argv[]) {
         << "SO_SNDBUF above the default value.";
   }
 
-  return dory->Run();
+  const int ret = dory->Run();
+  dory.reset();
+  GetAsyncLogSink().Stop();
+  return ret;
 }
 
 int main(int argc, char *argv[]) {
@@ -122,6 +122,11 @@ namespace {
       TcpInputActive = true;
     }
 
+    void UseConnectorEventLoops(size_t count) {
+      assert(!IsStarted());
+      ConnectorEventLoops = count;
+    }
+
     const char *GetUnixDgSocketName() const {
       return UnixDgSocketName.c_str();
     }
@@ -162,6 +167,8 @@ namespace {
 
     bool TcpInputActive = false;
 
+    size_t ConnectorEventLoops = 0;
+
     in_port_t BrokerPort = 0;
 
     size_t MsgBufferMax = 0;
@@ -270,8 +277,17 @@ namespace {
         << "        <allowLargeUnixDatagrams value=\"false\" />" << std::endl
         << "        <maxStreamMsgSize value = \"512k\" />" << std::endl
         << "    </inputConfig>" << std::endl
-        << std::endl
-        << "    <httpInterface>" << std::endl
+        << std::endl;
+
+    if (ConnectorEventLoops) {
+      os << "    <msgDelivery>" << std::endl
+          << "        <connectorEventLoops value=\"" << ConnectorEventLoops
+          << "\" />" << std::endl
+          << "    </msgDelivery>" << std::endl
+          << std::endl;
+    }
+
+    os  << "    <httpInterface>" << std::endl
         << "        <port value=\"9090\" />" << std::endl
         << "        <loopbackOnly value=\"true\" />" << std::endl
         << "        <discardReportInterval value=\"600\" />" << std::endl
@@ -592,6 +608,92 @@ namespace {
     ASSERT_EQ(server.GetDoryReturnValue(), EXIT_SUCCESS);
   }
 
+  TEST_F(TDoryTest, ConnectorEventLoopTest) {
+    std::string topic("scooby_doo");
+    std::vector<std::string> kafka_config;
+    CreateKafkaConfig(3, topic.c_str(), 3, kafka_config);
+    TMockKafkaConfig kafka(kafka_config);
+    kafka.StartKafka();
+    Dory::MockKafkaServer::TMainThread &mock_kafka = *kafka.MainThread;
+    in_port_t port = mock_kafka.VirtualPortToPhys(10000);
+    assert(port);
+    TDoryTestServer server(port, 1024 * 1024);
+    server.UseUnixDgSocket();
+
+    /* Two event loops for three brokers, so one event loop handles two
+       connections. */
+    server.UseConnectorEventLoops(2);
+
+    bool started = server.SyncStart();
+    ASSERT_TRUE(started);
+    TDoryServer *dory = server.GetDory();
+    TDoryClientSocket sock;
+    int ret = sock.Bind(server.GetUnixDgSocketName());
+    ASSERT_EQ(ret, DORY_OK);
+    std::vector<std::string> expected_msgs;
+    std::vector<uint8_t> dg_buf;
+
+    for (size_t i = 0; i < 6; ++i) {
+      std::string body("msg ");
+      body += std::to_string(i);
+      expected_msgs.push_back(body);
+      MakeDg(dg_buf, topic, body);
+      ret = sock.Send(&dg_buf[0], dg_buf.size());
+      ASSERT_EQ(ret, DORY_OK);
+    }
+
+    for (size_t i = 0; (dory->GetAckCount() < 6) && (i < 3000); ++i) {
+      SleepMilliseconds(10);
+    }
+
+    ASSERT_EQ(dory->GetAckCount(), 6U);
+    using TTracker = TReceivedRequestTracker;
+    std::list<TTracker::TRequestInfo> received;
+
+    for (size_t i = 0; i < 3000; ++i) {
+      mock_kafka.NonblockingGetHandledRequests(received);
+
+      for (auto &item : received) {
+        if (item.MetadataRequestInfo) {
+          ASSERT_EQ(item.MetadataRequestInfo->ReturnedErrorCode, 0);
+        } else if (item.ProduceRequestInfo) {
+          const TTracker::TProduceRequestInfo &info = *item.ProduceRequestInfo;
+          ASSERT_EQ(info.Topic, topic);
+          ASSERT_EQ(info.ReturnedErrorCode, 0);
+          auto iter = std::find(expected_msgs.begin(), expected_msgs.end(),
+                                info.FirstMsgValue);
+
+          if (iter == expected_msgs.end()) {
+            ASSERT_TRUE(false);
+          } else {
+            expected_msgs.erase(iter);
+          }
+        } else {
+          ASSERT_TRUE(false);
+        }
+      }
+
+      received.clear();
+
+      if (expected_msgs.empty()) {
+        break;
+      }
+
+      SleepMilliseconds(10);
+    }
+
+    ASSERT_TRUE(expected_msgs.empty());
+
+    TAnomalyTracker::TInfo bad_stuff;
+    dory->GetAnomalyTracker().GetInfo(bad_stuff);
+    ASSERT_EQ(bad_stuff.DiscardTopicMap.size(), 0U);
+    ASSERT_EQ(bad_stuff.DuplicateTopicMap.size(), 0U);
+
+    server.RequestShutdown();
+    server.Join();
+    ASSERT_EQ(server.GetDoryReturnValue(), EXIT_SUCCESS);
+  }
+
   TEST_F(TDoryTest, KeyValueTest) {
     std::string topic("scooby_doo");
     std::vector<std::string> kafka_config;
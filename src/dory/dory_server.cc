@@ -29,7 +29,9 @@
 #include <ctime>
 #include <limits>
 #include <memory>
+#include <optional>
 #include <set>
+#include <system_error>
 
 #include <arpa/inet.h>
 #include <poll.h>
@@ -150,6 +152,10 @@ TDoryServer::TDoryServer(TCmdLineArgs &&args, TConf &&conf,
       Pool(PoolBlockSize,
            ComputeBlockCount(Conf.InputConfigConf.MaxBuffer, PoolBlockSize),
            Capped::TPool::TSync::Mutexed),
+      Profiler(Conf.ProfilingConf.Enable),
+      MsgTracer(Conf.MsgTracingConf.SampleInterval,
+          Conf.MsgTracingConf.RingSize),
+      MemoryTelemetry(Pool, MsgStateTracker),
       AnomalyTracker(DiscardFileLogger,
           Conf.HttpInterfaceConf.DiscardReportInterval,
           Conf.HttpInterfaceConf.BadMsgPrefixSize),
@@ -157,10 +163,18 @@ TDoryServer::TDoryServer(TCmdLineArgs &&args, TConf &&conf,
       DebugSetup(Conf.MsgDebugConf.Path.c_str(), Conf.MsgDebugConf.TimeLimit,
                  Conf.MsgDebugConf.ByteLimit),
       Dispatcher(CmdLineArgs, Conf, MsgStateTracker, AnomalyTracker,
-          DebugSetup),
-      RouterThread(CmdLineArgs, Conf, AnomalyTracker, MsgStateTracker,
-          DebugSetup, Dispatcher),
+          DebugSetup, ApiVersionStats, CompressionStats, LingerStats,
+          LatencyStats, Profiler),
+      RouterThread(CmdLineArgs, Conf, Pool, AnomalyTracker, MsgStateTracker,
+          DebugSetup, ApiVersionStats, LingerStats, Profiler, Dispatcher),
       MetadataTimestamp(RouterThread.GetMetadataTimestamp()) {
+  MsgStateTracker.SetMaxTopics(Conf.HttpInterfaceConf.MaxQueueStatsTopics);
+  MsgStateTracker.SetLatencyStats(&LatencyStats);
+
+  if (MsgTracer.IsEnabled()) {
+    MsgStateTracker.SetTracer(&MsgTracer);
+  }
+
   if (!Conf.InputSourcesConf.UnixStreamPath.empty() ||
       Conf.InputSourcesConf.LocalTcpPort) {
     /* Create thread pool if UNIX stream or TCP input is enabled. */
@@ -227,8 +241,9 @@ int TDoryServer::Run() {
      want this to happen _after_ the message handling threads have shut down.
    */
   TWebInterface web_interface(StatusPort, MsgStateTracker, AnomalyTracker,
-      MetadataTimestamp, RouterThread.GetMetadataUpdateRequestSem(),
-      DebugSetup);
+      MetadataTimestamp, ApiVersionStats, CompressionStats, LingerStats,
+      LatencyStats, MsgTracer, MemoryTelemetry, Profiler, Pool,
+      RouterThread.GetMetadataUpdateRequestSem(), DebugSetup);
 
   bool no_error = StartMsgHandlingThreads();
 
@@ -274,7 +289,27 @@ bool TDoryServer::StartMsgHandlingThreads() {
     DiscardFileLogger.Init(Conf.DiscardLoggingConf.Path.c_str(),
         static_cast<uint64_t>(Conf.DiscardLoggingConf.MaxFileSize),
         static_cast<uint64_t>(Conf.DiscardLoggingConf.MaxArchiveSize),
-        Conf.DiscardLoggingConf.MaxMsgPrefixSize);
+        Conf.DiscardLoggingConf.MaxMsgPrefixSize,
+        Conf.DiscardLoggingConf.Format);
+  }
+
+  if (!Conf.JournalConf.Path.empty()) {
+    /* This must be done before starting any thread that creates or disposes
+       of messages.  Any messages recovered from a previous run are replayed
+       by the router thread once it has metadata. */
+    try {
+      Journal.reset(new Journal::TJournal(Conf.JournalConf.Path,
+          Conf.JournalConf.SegmentSize, Conf.JournalConf.SyncPolicy,
+          Conf.JournalConf.SyncInterval, Conf.JournalConf.MaxPendingBytes));
+    } catch (const std::system_error &x) {
+      LOG(TPri::ERR) << "Failed to initialize journal in directory ["
+          << Conf.JournalConf.Path << "]: " << x.what();
+      return false;
+    }
+
+    Journal->Start();
+    MsgStateTracker.SetJournal(Journal.get());
+    RouterThread.SetJournal(Journal.get());
   }
 
   if (StreamClientWorkerPool) {
@@ -355,7 +390,14 @@ bool TDoryServer::HandleEvents() {
   TTimerFd discard_query_check_timer(
       1000 * (1 + Conf.HttpInterfaceConf.DiscardReportInterval));
 
-  std::array<struct pollfd, 8> events;
+  /* This is for periodically logging memory usage. */
+  std::optional<TTimerFd> memory_stats_timer;
+
+  if (Conf.LoggingConf.MemoryStatsInterval) {
+    memory_stats_timer.emplace(1000 * Conf.LoggingConf.MemoryStatsInterval);
+  }
+
+  std::array<struct pollfd, 9> events;
   struct pollfd &discard_query_check = events[0];
   struct pollfd &unix_dg_input_agent_error = events[1];
   struct pollfd &unix_stream_input_agent_error = events[2];
@@ -364,6 +406,7 @@ bool TDoryServer::HandleEvents() {
   struct pollfd &shutdown_request = events[5];
   struct pollfd &worker_pool_worker_error = events[6];
   struct pollfd &worker_pool_fatal_error = events[7];
+  struct pollfd &memory_stats_log = events[8];
   discard_query_check.fd = discard_query_check_timer.GetFd();
   discard_query_check.events = POLLIN;
   unix_dg_input_agent_error.fd = UnixDgInputAgent ?
@@ -390,6 +433,9 @@ bool TDoryServer::HandleEvents() {
 
   worker_pool_worker_error.events = POLLIN;
   worker_pool_fatal_error.events = POLLIN;
+  memory_stats_log.fd = memory_stats_timer ?
+      int(memory_stats_timer->GetFd()) : -1;
+  memory_stats_log.events = POLLIN;
   bool fatal_error = false;
 
   for (; ; ) {
@@ -452,6 +498,11 @@ bool TDoryServer::HandleEvents() {
       AnomalyTracker.CheckGetInfoRate();
     }
 
+    if (memory_stats_log.revents) {
+      memory_stats_timer->Pop();
+      MemoryTelemetry.LogStats();
+    }
+
     if (shutdown_request.revents) {
       LOG(TPri::NOTICE) << "Got shutdown signal while server running";
       break;
@@ -559,6 +610,14 @@ bool TDoryServer::Shutdown() {
   assert(!router_thread_started || msg_list.empty());
   DiscardFinalMsgs(msg_list);
 
+  if (Journal && Journal->IsStarted()) {
+    /* The journal writer thread writes any pending retirements before it
+       terminates. */
+    LOG(TPri::NOTICE) << "Shutting down journal writer thread";
+    Journal->RequestShutdown();
+    Journal->Join();
+  }
+
   LOG(TPri::NOTICE) << "Dory shutdown finished";
 
   /* Let the DiscardFileLogger destructor disable discard file logging.  Then
@@ -40,6 +40,8 @@
 #include <base/thrower.h>
 #include <capped/pool.h>
 #include <dory/anomaly_tracker.h>
+#include <dory/api_version_stats.h>
+#include <dory/compression_stats.h>
 #include <dory/batch/batch_config_builder.h>
 #include <dory/batch/global_batch_config.h>
 #include <dory/cmd_line_args.h>
@@ -47,10 +49,16 @@
 #include <dory/conf/conf.h>
 #include <dory/debug/debug_setup.h>
 #include <dory/discard_file_logger.h>
+#include <dory/journal/journal.h>
+#include <dory/latency_stats.h>
+#include <dory/linger_stats.h>
+#include <dory/memory_telemetry.h>
 #include <dory/unix_dg_input_agent.h>
 #include <dory/metadata_timestamp.h>
 #include <dory/msg_dispatch/kafka_dispatcher.h>
 #include <dory/msg_state_tracker.h>
+#include <dory/msg_tracer.h>
+#include <dory/profiler.h>
 #include <dory/router_thread.h>
 #include <dory/stream_client_handler.h>
 #include <dory/stream_client_work_fn.h>
@@ -156,8 +164,30 @@ namespace Dory {
        that might generate discards has been destroyed. */
     TDiscardFileLogger DiscardFileLogger;
 
+    /* Write-ahead journal, or null if journaling is disabled.  This is
+       declared before everything that appends or retires messages so it gets
+       destroyed after them. */
+    std::unique_ptr<Journal::TJournal> Journal;
+
+    /* Message pipeline and produce request latency histograms, for the web
+       interface.  This is declared before everything that records to it so it
+       gets destroyed after them. */
+    TLatencyStats LatencyStats;
+
+    /* Router and connector thread time in phase totals, for the web
+       interface.  This is declared before the threads that record to it so it
+       gets destroyed after them. */
+    TProfiler Profiler;
+
+    /* Sampled message traces, for the web interface.  This is declared before
+       everything that records to it so it gets destroyed after them. */
+    TMsgTracer MsgTracer;
+
     TMsgStateTracker MsgStateTracker;
 
+    /* Reports buffer pool and message memory usage. */
+    TMemoryTelemetry MemoryTelemetry;
+
     /* For tracking discarded messages and possible duplicates. */
     TAnomalyTracker AnomalyTracker;
 
@@ -171,6 +201,15 @@ namespace Dory {
 
     Debug::TDebugSetup DebugSetup;
 
+    /* Kafka API versions in use for each broker, for the web interface. */
+    TApiVersionStats ApiVersionStats;
+
+    /* Per-topic adaptive compression decisions, for the web interface. */
+    TCompressionStats CompressionStats;
+
+    /* Adaptive batching time limits, for the web interface. */
+    TLingerStats LingerStats;
+
     MsgDispatch::TKafkaDispatcher Dispatcher;
 
     TRouterThread RouterThread;
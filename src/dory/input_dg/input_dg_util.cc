@@ -70,29 +70,37 @@ TMsg::TPtr Dory::InputDg::BuildMsgFromDg(const void *dg, size_t dg_size,
   const uint8_t *versioned_part_end = versioned_part_begin +
       (dg_size - fixed_part_size);
 
+  TMsg::TPtr msg;
+
   switch (api_key) {
     case 256: {
-      return BuildAnyPartitionMsgFromDg(dg_bytes, dg_size, api_version,
+      msg = BuildAnyPartitionMsgFromDg(dg_bytes, dg_size, api_version,
           versioned_part_begin, versioned_part_end, pool, anomaly_tracker,
           msg_state_tracker, log_discard);
+      break;
     }
     case 257: {
-      return BuildPartitionKeyMsgFromDg(dg_bytes, dg_size, api_version,
+      msg = BuildPartitionKeyMsgFromDg(dg_bytes, dg_size, api_version,
           versioned_part_begin, versioned_part_end, pool, anomaly_tracker,
           msg_state_tracker, log_discard);
+      break;
     }
     default: {
-      break;
+      if (log_discard) {
+        LOG_R(TPri::ERR, std::chrono::seconds(30)) <<
+            "Discarding message with unsupported API key: " << api_key;
+      }
+
+      anomaly_tracker.TrackUnsupportedApiKeyDiscard(dg_bytes,
+          dg_bytes + dg_size, api_key);
+      InputAgentDiscardMsgUnsupportedApiKey.Increment();
+      return TMsg::TPtr();
     }
   }
 
-  if (log_discard) {
-    LOG_R(TPri::ERR, std::chrono::seconds(30)) <<
-        "Discarding message with unsupported API key: " << api_key;
+  if (msg) {
+    msg_state_tracker.SampleForTrace(*msg);
   }
 
-  anomaly_tracker.TrackUnsupportedApiKeyDiscard(dg_bytes, dg_bytes + dg_size,
-      api_key);
-  InputAgentDiscardMsgUnsupportedApiKey.Increment();
-  return TMsg::TPtr();
+  return msg;
 }
@@ -0,0 +1,821 @@
+/* <dory/journal/journal.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/journal/journal.h>.
+ */
+
+#include <dory/journal/journal.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <base/counter.h>
+#include <base/crc.h>
+#include <base/dir_iter.h>
+#include <base/error_util.h>
+#include <base/field_access.h>
+#include <base/gettid.h>
+#include <base/no_default_case.h>
+#include <base/time_util.h>
+#include <base/wr/fd_util.h>
+#include <base/wr/file_util.h>
+#include <dory/msg_state_tracker.h>
+#include <dory/util/msg_record.h>
+#include <log/log.h>
+
+using namespace Base;
+using namespace Capped;
+using namespace Dory;
+using namespace Dory::Journal;
+using namespace Dory::Util;
+using namespace Log;
+
+DEFINE_COUNTER(JournalBytesWrite);
+DEFINE_COUNTER(JournalError);
+DEFINE_COUNTER(JournalMsgAppend);
+DEFINE_COUNTER(JournalMsgRecover);
+DEFINE_COUNTER(JournalMsgReplay);
+DEFINE_COUNTER(JournalMsgRetire);
+DEFINE_COUNTER(JournalMsgTooLarge);
+DEFINE_COUNTER(JournalPendingFull);
+DEFINE_COUNTER(JournalRecoveryBadSegment);
+DEFINE_COUNTER(JournalRecoveryTruncated);
+DEFINE_COUNTER(JournalRetireUnknown);
+DEFINE_COUNTER(JournalSegmentCreate);
+DEFINE_COUNTER(JournalSegmentDelete);
+DEFINE_COUNTER(JournalSync);
+DEFINE_COUNTER(JournalTruncatePartialWrite);
+DEFINE_COUNTER(JournalWrite);
+
+static const char SEGMENT_PREFIX[] = "journal.";
+
+static const uint32_t SEGMENT_MAGIC = 0x444a524e;  // "DJRN"
+
+static const uint32_t SEGMENT_VERSION = 1;
+
+static const size_t SEGMENT_HEADER_SIZE = 8;
+
+/* Payload size (4 bytes) followed by CRC-32C of payload (4 bytes). */
+static const size_t RECORD_HEADER_SIZE = 8;
+
+static const uint8_t RECORD_TYPE_APPEND = 1;
+
+static const uint8_t RECORD_TYPE_RETIRE = 2;
+
+/* Record type (1 byte) followed by sequence number (8 bytes). */
+static const size_t APPEND_PREFIX_SIZE = 9;
+
+/* Record type (1 byte) followed by count (4 bytes). */
+static const size_t RETIRE_PREFIX_SIZE = 5;
+
+TJournal::TJournal(const std::string &dir, size_t segment_size,
+    TSyncPolicy sync_policy, size_t sync_interval, size_t max_pending_bytes)
+    : Dir(dir),
+      SegmentSize(segment_size),
+      SyncPolicy(sync_policy),
+      SyncInterval(sync_interval),
+      MaxPendingBytes(max_pending_bytes),
+      DataSem(0, true) {
+  assert(SegmentSize > SEGMENT_HEADER_SIZE);
+  Recover();
+  AddSegment();
+  LastSyncTime = GetEpochMilliseconds();
+}
+
+TJournal::~TJournal() {
+  /* This will shut down the thread if something unexpected happens. */
+  ShutdownOnDestroy();
+}
+
+TMsg::TPtr TJournal::GetRecoveredMsg(TPool &pool,
+    TMsgStateTracker &msg_state_tracker) {
+  if (RecoveredMsgs.empty()) {
+    return TMsg::TPtr();
+  }
+
+  const auto iter = RecoveredMsgs.begin();
+  const TRecoveredMsg &item = iter->second;
+  RecoveredBuf.resize(item.Size);
+  const ssize_t ret = IfLt0(pread(RecoveredFds[item.FdIndex],
+      &RecoveredBuf[0], item.Size, item.Offset));
+
+  if (static_cast<size_t>(ret) != item.Size) {
+    ThrowSystemError(EIO);
+  }
+
+  TMsgRecord rec;
+
+  /* The record was validated during recovery. */
+  if (!ReadMsgRecord(&RecoveredBuf[0], RecoveredBuf.size(), rec)) {
+    assert(false);
+    ThrowSystemError(EIO);
+  }
+
+  TMsg::TPtr msg = CreateMsgFromRecord(rec, pool, msg_state_tracker);
+  msg->SetJournalSeq(iter->first);
+  RecoveredMsgs.erase(iter);
+  JournalMsgReplay.Increment();
+
+  if (RecoveredMsgs.empty()) {
+    RecoveredFds.clear();
+    RecoveredBuf.clear();
+    RecoveredBuf.shrink_to_fit();
+  }
+
+  return msg;
+}
+
+bool TJournal::Append(TMsg &msg) {
+  assert(msg.GetJournalSeq() == 0);
+
+  if (!MsgRecordCanHold(msg)) {
+    JournalMsgTooLarge.Increment();
+    return false;
+  }
+
+  const size_t payload_size = APPEND_PREFIX_SIZE + ComputeMsgRecordSize(msg);
+
+  if (payload_size > std::numeric_limits<uint32_t>::max()) {
+    JournalMsgTooLarge.Increment();
+    return false;
+  }
+
+  const uint64_t seq = NextSeq;
+  ++NextSeq;
+
+  /* Serialize and compute the checksum before taking the mutex, so threads
+     retiring messages aren't kept waiting. */
+  AppendBuf.resize(RECORD_HEADER_SIZE + payload_size);
+  uint8_t *payload = &AppendBuf[RECORD_HEADER_SIZE];
+  payload[0] = RECORD_TYPE_APPEND;
+  WriteUint64ToHeader(payload + 1, seq);
+  WriteMsgRecord(payload + APPEND_PREFIX_SIZE, msg);
+  WriteUint32ToHeader(&AppendBuf[0], static_cast<uint32_t>(payload_size));
+  WriteUint32ToHeader(&AppendBuf[4], ComputeCrc32c(payload, payload_size));
+
+  std::lock_guard<std::mutex> lock(Mutex);
+
+  if ((PendingAppends.size() + AppendBuf.size()) > MaxPendingBytes) {
+    /* The writer thread has fallen behind.  We are the only appending
+       thread, so the sequence number can be reused. */
+    --NextSeq;
+    JournalPendingFull.Increment();
+    return false;
+  }
+
+  msg.SetJournalSeq(seq);
+  PendingAppends.insert(PendingAppends.end(), AppendBuf.begin(),
+      AppendBuf.end());
+
+  if (PendingAppendCount == 0) {
+    PendingFirstSeq = seq;
+  }
+
+  ++PendingAppendCount;
+  PendingLastSeq = seq;
+  SignalDataPending();
+  JournalMsgAppend.Increment();
+  return true;
+}
+
+void TJournal::Retire(const TMsg &msg) {
+  const uint64_t seq = msg.GetJournalSeq();
+
+  if (seq) {
+    std::lock_guard<std::mutex> lock(Mutex);
+    PendingRetirements.push_back(seq);
+    SignalDataPending();
+  }
+}
+
+void TJournal::Retire(const std::list<TMsg::TPtr> &msg_list) {
+  std::lock_guard<std::mutex> lock(Mutex);
+  const size_t old_size = PendingRetirements.size();
+
+  for (const TMsg::TPtr &msg : msg_list) {
+    assert(msg);
+    const uint64_t seq = msg->GetJournalSeq();
+
+    if (seq) {
+      PendingRetirements.push_back(seq);
+    }
+  }
+
+  if (PendingRetirements.size() != old_size) {
+    SignalDataPending();
+  }
+}
+
+void TJournal::Flush() {
+  assert(IsStarted());
+  uint64_t target = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    /* Wait for the batch containing the current pending data if there is
+       any, or else for the batch currently being written. */
+    target = (PendingAppendCount || !PendingRetirements.empty()) ?
+        (BatchesTaken + 1) : BatchesTaken;
+
+    if (BatchesDone >= target) {
+      return;
+    }
+
+    FlushWaiting = true;
+    SignalDataPending();
+  }
+
+  for (; ; ) {
+    FlushDoneSem.Pop();
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    if (BatchesDone >= target) {
+      FlushWaiting = false;
+      break;
+    }
+  }
+}
+
+void TJournal::Run() {
+  const int tid = static_cast<int>(Gettid());
+  LOG(TPri::NOTICE) << "Journal writer thread " << tid << " started";
+  bool caught_fatal_exception = false;
+
+  try {
+    DoRun();
+  } catch (const std::exception &x) {
+    caught_fatal_exception = true;
+    LOG(TPri::ERR) << "Fatal error in journal writer thread " << tid << ": "
+        << x.what();
+  } catch (...) {
+    caught_fatal_exception = true;
+    LOG(TPri::ERR) << "Fatal unknown error in journal writer thread " << tid;
+  }
+
+  LOG(TPri::NOTICE) << "Journal writer thread " << tid << " finished "
+      << (caught_fatal_exception ? "on error" : "normally");
+}
+
+void TJournal::Recover() {
+  std::vector<std::pair<uint64_t, std::string>> segments;
+  const size_t prefix_len = std::strlen(SEGMENT_PREFIX);
+
+  for (TDirIter iter(Dir.c_str()); iter; ++iter) {
+    if (iter.GetKind() != TDirIter::File) {
+      continue;
+    }
+
+    const char *name = iter.GetName();
+
+    if (std::strncmp(name, SEGMENT_PREFIX, prefix_len) ||
+        !std::isdigit(name[prefix_len])) {
+      continue;
+    }
+
+    segments.emplace_back(std::strtoull(name + prefix_len, nullptr, 10),
+        Dir + "/" + name);
+  }
+
+  std::sort(segments.begin(), segments.end());
+
+  /* Maps the sequence number of each unretired message to the index of its
+     segment in 'Segments'. */
+  std::map<uint64_t, size_t> seq_to_segment;
+
+  for (const auto &item : segments) {
+    RecoverSegment(item.first, item.second, seq_to_segment);
+    NextSegmentNumber = item.first + 1;
+  }
+
+  for (const auto &item : seq_to_segment) {
+    ++Segments[item.second].LiveCount;
+  }
+
+  /* Segments with nothing left to replay are deleted once the writer thread
+     has started, as a side effect of the first batch it writes.  Delete the
+     leading ones now so they don't linger if nothing is written. */
+  while (!Segments.empty() && (Segments.front().LiveCount == 0)) {
+    DeleteFrontSegment();
+  }
+
+  if (!Segments.empty()) {
+    NextSeq = Segments.back().LastSeq + 1;
+  }
+
+  JournalMsgRecover.Increment(RecoveredMsgs.size());
+
+  if (!RecoveredMsgs.empty()) {
+    LOG(TPri::NOTICE) << "Recovered " << RecoveredMsgs.size()
+        << " unacknowledged messages in " << Segments.size()
+        << " journal segment files from [" << Dir << "]";
+  }
+}
+
+void TJournal::RecoverSegment(uint64_t number, const std::string &path,
+    std::map<uint64_t, size_t> &seq_to_segment) {
+  TFd fd;
+  std::vector<uint8_t> buf;
+
+  try {
+    fd = Wr::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    IfLt0(Wr::fstat(fd, &st));
+    buf.resize(static_cast<size_t>(st.st_size));
+
+    for (size_t offset = 0; offset < buf.size(); ) {
+      const ssize_t ret = IfLt0(pread(fd, &buf[offset], buf.size() - offset,
+          static_cast<off_t>(offset)));
+
+      if (ret == 0) {
+        buf.resize(offset);
+        break;
+      }
+
+      offset += static_cast<size_t>(ret);
+    }
+  } catch (const std::system_error &x) {
+    JournalRecoveryBadSegment.Increment();
+    LOG(TPri::ERR) << "Failed to read journal segment file [" << path
+        << "]: " << x.what();
+    return;
+  }
+
+  if ((buf.size() < SEGMENT_HEADER_SIZE) ||
+      (ReadUint32FromHeader(&buf[0]) != SEGMENT_MAGIC) ||
+      (ReadUint32FromHeader(&buf[4]) != SEGMENT_VERSION)) {
+    JournalRecoveryBadSegment.Increment();
+    LOG(TPri::ERR) << "Bad journal segment file [" << path << "]: deleting";
+    fd.Reset();
+    Wr::unlink(path.c_str());
+    return;
+  }
+
+  TSegment seg;
+  seg.Number = number;
+  seg.Path = path;
+  seg.Size = buf.size();
+  seg.LastSeq = Segments.empty() ? 0 : Segments.back().LastSeq;
+  seg.FirstSeq = seg.LastSeq + 1;
+  const size_t segment_index = Segments.size();
+  const size_t fd_index = RecoveredFds.size();
+  bool has_recovered_msgs = false;
+  size_t offset = SEGMENT_HEADER_SIZE;
+
+  while (offset < buf.size()) {
+    if ((buf.size() - offset) < RECORD_HEADER_SIZE) {
+      break;
+    }
+
+    const size_t payload_size = ReadUint32FromHeader(&buf[offset]);
+    const uint8_t *payload = &buf[offset + RECORD_HEADER_SIZE];
+
+    if ((payload_size == 0) ||
+        (payload_size > (buf.size() - offset - RECORD_HEADER_SIZE)) ||
+        (ReadUint32FromHeader(&buf[offset + 4]) !=
+            ComputeCrc32c(payload, payload_size))) {
+      break;
+    }
+
+    bool ok = false;
+
+    if (payload[0] == RECORD_TYPE_APPEND) {
+      TMsgRecord rec;
+
+      if ((payload_size >= APPEND_PREFIX_SIZE) &&
+          ReadMsgRecord(payload + APPEND_PREFIX_SIZE,
+              payload_size - APPEND_PREFIX_SIZE, rec)) {
+        const uint64_t seq = ReadUint64FromHeader(payload + 1);
+
+        if (seq > seg.LastSeq) {
+          ok = true;
+
+          if (seg.FirstSeq > seg.LastSeq) {
+            seg.FirstSeq = seq;
+          }
+
+          seg.LastSeq = seq;
+          seq_to_segment[seq] = segment_index;
+          TRecoveredMsg &item = RecoveredMsgs[seq];
+          item.FdIndex = fd_index;
+          item.Offset = static_cast<off_t>(
+              offset + RECORD_HEADER_SIZE + APPEND_PREFIX_SIZE);
+          item.Size = static_cast<uint32_t>(
+              payload_size - APPEND_PREFIX_SIZE);
+          has_recovered_msgs = true;
+        }
+      }
+    } else if ((payload[0] == RECORD_TYPE_RETIRE) &&
+        (payload_size >= RETIRE_PREFIX_SIZE)) {
+      const size_t count = ReadUint32FromHeader(payload + 1);
+
+      if ((payload_size - RETIRE_PREFIX_SIZE) == (count * 8)) {
+        ok = true;
+
+        for (size_t i = 0; i < count; ++i) {
+          const uint64_t seq = ReadUint64FromHeader(
+              payload + RETIRE_PREFIX_SIZE + (i * 8));
+          seq_to_segment.erase(seq);
+          RecoveredMsgs.erase(seq);
+        }
+      }
+    }
+
+    if (!ok) {
+      break;
+    }
+
+    offset += RECORD_HEADER_SIZE + payload_size;
+  }
+
+  if (offset < buf.size()) {
+    /* Most likely a record that was only partially written when dory
+       crashed.  Nothing after it can be trusted.  We never append to a
+       recovered segment, so the bad data is left in place and skipped again
+       if we crash before the segment is deleted. */
+    JournalRecoveryTruncated.Increment();
+    LOG(TPri::WARNING) << "Discarded bad data at offset " << offset
+        << " of journal segment file [" << path << "]";
+  }
+
+  if (has_recovered_msgs) {
+    RecoveredFds.push_back(std::move(fd));
+  }
+
+  Segments.push_back(std::move(seg));
+}
+
+void TJournal::AddSegment() {
+  TSegment seg;
+  seg.Number = NextSegmentNumber;
+  seg.Path = Dir + "/" + SEGMENT_PREFIX + std::to_string(seg.Number);
+  seg.Fd = Wr::open(seg.Path.c_str(),
+      O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+  uint8_t header[SEGMENT_HEADER_SIZE];
+  WriteUint32ToHeader(header, SEGMENT_MAGIC);
+  WriteUint32ToHeader(header + 4, SEGMENT_VERSION);
+
+  try {
+    if (IfLt0(pwrite(seg.Fd, header, sizeof(header), 0)) !=
+        static_cast<ssize_t>(sizeof(header))) {
+      ThrowSystemError(EIO);
+    }
+  } catch (...) {
+    seg.Fd.Reset();
+    Wr::unlink(seg.Path.c_str());
+    throw;
+  }
+
+  seg.Size = SEGMENT_HEADER_SIZE;
+  seg.LastSeq = Segments.empty() ? 0 : Segments.back().LastSeq;
+  seg.FirstSeq = seg.LastSeq + 1;
+
+  if (SyncPolicy != TSyncPolicy::None) {
+    /* Make the new directory entry durable, so a later sync of the file's
+       contents isn't wasted. */
+    try {
+      TFd dir_fd(Wr::open(Dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+      IfLt0(fsync(dir_fd));
+    } catch (const std::system_error &x) {
+      LOG(TPri::ERR) << "Failed to sync journal directory [" << Dir << "]: "
+          << x.what();
+    }
+  }
+
+  ++NextSegmentNumber;
+  Segments.push_back(std::move(seg));
+  JournalSegmentCreate.Increment();
+}
+
+void TJournal::RotateSegment() {
+  if (Dirty && (SyncPolicy != TSyncPolicy::None)) {
+    Sync();
+  }
+
+  try {
+    AddSegment();
+  } catch (const std::system_error &x) {
+    /* Keep writing to the current segment.  We will try again on the next
+       batch. */
+    JournalError.Increment();
+    LOG_R(TPri::ERR, std::chrono::seconds(30))
+        << "Failed to create journal segment file in [" << Dir << "]: "
+        << x.what();
+    return;
+  }
+
+  Segments[Segments.size() - 2].Fd.Reset();
+}
+
+void TJournal::DeleteFrontSegment() {
+  assert(!Segments.empty());
+  const std::string path = Segments.front().Path;
+  Segments.pop_front();
+
+  if (Wr::unlink(path.c_str()) < 0) {
+    LOG_ERRNO(TPri::ERR, errno) << "Failed to delete journal segment file ["
+        << path << "]: ";
+  }
+
+  JournalSegmentDelete.Increment();
+}
+
+void TJournal::SignalDataPending() {
+  if (!DataSignaled) {
+    DataSignaled = true;
+    DataSem.Push();
+  }
+}
+
+void TJournal::DoRun() {
+  std::array<struct pollfd, 2> events;
+  struct pollfd &shutdown_request_event = events[0];
+  struct pollfd &data_event = events[1];
+  shutdown_request_event.fd = GetShutdownRequestFd();
+  shutdown_request_event.events = POLLIN;
+  data_event.fd = DataSem.GetFd();
+  data_event.events = POLLIN;
+
+  for (; ; ) {
+    for (auto &item : events) {
+      item.revents = 0;
+    }
+
+    int timeout = -1;
+
+    if (Dirty && (SyncPolicy == TSyncPolicy::Interval)) {
+      const uint64_t elapsed = GetEpochMilliseconds() - LastSyncTime;
+      timeout = (elapsed >= SyncInterval) ?
+          0 : static_cast<int>(SyncInterval - elapsed);
+    }
+
+    /* We should have all signals blocked, so treat EINTR as fatal. */
+    const int ret = Wr::poll(Wr::TDisp::AddFatal, {EINTR}, &events[0],
+        events.size(), timeout);
+    assert(ret >= 0);
+
+    if (shutdown_request_event.revents) {
+      /* Write whatever is still pending, so messages retired before
+         shutdown aren't replayed on the next startup. */
+      WriteBatch();
+
+      if (Dirty && (SyncPolicy != TSyncPolicy::None)) {
+        Sync();
+      }
+
+      break;
+    }
+
+    if (data_event.revents) {
+      DataSem.Pop();
+      WriteBatch();
+    }
+
+    if (Dirty && (SyncPolicy == TSyncPolicy::Interval) &&
+        ((GetEpochMilliseconds() - LastSyncTime) >= SyncInterval)) {
+      Sync();
+    }
+  }
+}
+
+bool TJournal::WriteBatch() {
+  std::vector<uint8_t> appends;
+  std::vector<uint64_t> retirements;
+  size_t append_count = 0;
+  uint64_t first_seq = 0;
+  uint64_t last_seq = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    appends.swap(PendingAppends);
+    retirements.swap(PendingRetirements);
+    append_count = PendingAppendCount;
+    first_seq = PendingFirstSeq;
+    last_seq = PendingLastSeq;
+    PendingAppendCount = 0;
+    DataSignaled = false;
+    ++BatchesTaken;
+  }
+
+  const bool has_data = !appends.empty() || !retirements.empty();
+
+  if (has_data) {
+    if ((Segments.back().Size >= SegmentSize) || Segments.back().Torn) {
+      RotateSegment();
+    }
+
+    std::vector<uint8_t> retire_record;
+
+    if (!retirements.empty()) {
+      const size_t payload_size = RETIRE_PREFIX_SIZE +
+          (retirements.size() * 8);
+      retire_record.resize(RECORD_HEADER_SIZE + payload_size);
+      uint8_t *payload = &retire_record[RECORD_HEADER_SIZE];
+      payload[0] = RECORD_TYPE_RETIRE;
+      WriteUint32ToHeader(payload + 1,
+          static_cast<uint32_t>(retirements.size()));
+
+      for (size_t i = 0; i < retirements.size(); ++i) {
+        WriteUint64ToHeader(payload + RETIRE_PREFIX_SIZE + (i * 8),
+            retirements[i]);
+      }
+
+      WriteUint32ToHeader(&retire_record[0],
+          static_cast<uint32_t>(payload_size));
+      WriteUint32ToHeader(&retire_record[4],
+          ComputeCrc32c(payload, payload_size));
+    }
+
+    /* Append records precede the retire record, since a message may be
+       retired in the same batch it was appended in. */
+    std::array<struct iovec, 2> iov;
+    size_t iov_count = 0;
+
+    if (!appends.empty()) {
+      iov[iov_count].iov_base = &appends[0];
+      iov[iov_count].iov_len = appends.size();
+      ++iov_count;
+    }
+
+    if (!retire_record.empty()) {
+      iov[iov_count].iov_base = &retire_record[0];
+      iov[iov_count].iov_len = retire_record.size();
+      ++iov_count;
+    }
+
+    const size_t good_size = Segments.back().Size;
+
+    try {
+      if (Segments.back().Torn) {
+        /* RotateSegment() failed above. */
+        ThrowSystemError(EIO);
+      }
+
+      WriteAll(&iov[0], iov_count);
+    } catch (const std::system_error &x) {
+      /* The messages are still delivered.  They just won't be recovered if
+         we crash. */
+      JournalError.Increment();
+      LOG_R(TPri::ERR, std::chrono::seconds(30))
+          << "Failed to write journal segment file ["
+          << Segments.back().Path << "]: " << x.what();
+      DiscardPartialWrite(good_size);
+    }
+
+    TSegment &seg = Segments.back();
+
+    if (append_count) {
+      if (seg.FirstSeq > seg.LastSeq) {
+        seg.FirstSeq = first_seq;
+      }
+
+      seg.LastSeq = last_seq;
+      seg.LiveCount += append_count;
+    }
+
+    if (SyncPolicy == TSyncPolicy::Always) {
+      Sync();
+    }
+
+    ApplyRetirements(retirements);
+  }
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  ++BatchesDone;
+
+  if (FlushWaiting) {
+    FlushDoneSem.Push();
+  }
+
+  return has_data;
+}
+
+void TJournal::WriteAll(const struct iovec *iov, size_t iov_count) {
+  assert(iov_count <= IOV_MAX);
+  TSegment &seg = Segments.back();
+  std::array<struct iovec, 2> remaining;
+  assert(iov_count <= remaining.size());
+  std::copy(iov, iov + iov_count, remaining.begin());
+  size_t index = 0;
+
+  while (index < iov_count) {
+    const ssize_t ret = pwritev(seg.Fd, &remaining[index],
+        static_cast<int>(iov_count - index), static_cast<off_t>(seg.Size));
+
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      ThrowSystemError(errno);
+    }
+
+    JournalWrite.Increment();
+    JournalBytesWrite.Increment(static_cast<uint32_t>(ret));
+    seg.Size += static_cast<size_t>(ret);
+    Dirty = true;
+
+    /* Skip past what was written, in case of a partial write. */
+    for (auto n = static_cast<size_t>(ret); n; ) {
+      struct iovec &v = remaining[index];
+
+      if (n >= v.iov_len) {
+        n -= v.iov_len;
+        ++index;
+      } else {
+        v.iov_base = static_cast<uint8_t *>(v.iov_base) + n;
+        v.iov_len -= n;
+        n = 0;
+      }
+    }
+  }
+}
+
+void TJournal::DiscardPartialWrite(size_t good_size) {
+  TSegment &seg = Segments.back();
+
+  if (seg.Torn || (seg.Size == good_size)) {
+    return;
+  }
+
+  JournalTruncatePartialWrite.Increment();
+
+  if (ftruncate(seg.Fd, static_cast<off_t>(good_size)) == 0) {
+    seg.Size = good_size;
+    return;
+  }
+
+  /* Stop writing to the segment.  The next batch goes to a new one. */
+  LOG_ERRNO_R(TPri::ERR, errno, std::chrono::seconds(30))
+      << "Failed to truncate journal segment file [" << seg.Path << "]: ";
+  seg.Torn = true;
+}
+
+void TJournal::Sync() {
+  if (fdatasync(Segments.back().Fd) < 0) {
+    JournalError.Increment();
+    LOG_ERRNO_R(TPri::ERR, errno, std::chrono::seconds(30))
+        << "Failed to sync journal segment file [" << Segments.back().Path
+        << "]: ";
+  }
+
+  JournalSync.Increment();
+  Dirty = false;
+  LastSyncTime = GetEpochMilliseconds();
+}
+
+void TJournal::ApplyRetirements(const std::vector<uint64_t> &seqs) {
+  for (uint64_t seq : seqs) {
+    /* Find the first segment whose last sequence number is at least 'seq'.
+       The segment holds 'seq' only if its range includes 'seq'. */
+    const auto iter = std::lower_bound(Segments.begin(), Segments.end(), seq,
+        [](const TSegment &seg, uint64_t value) {
+          return seg.LastSeq < value;
+        });
+
+    if ((iter == Segments.end()) || (seq < iter->FirstSeq) ||
+        (iter->LiveCount == 0)) {
+      JournalRetireUnknown.Increment();
+      continue;
+    }
+
+    --iter->LiveCount;
+    JournalMsgRetire.Increment();
+  }
+
+  /* The last segment is the one being written to. */
+  while ((Segments.size() > 1) && (Segments.front().LiveCount == 0)) {
+    DeleteFrontSegment();
+  }
+}
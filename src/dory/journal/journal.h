@@ -0,0 +1,298 @@
+/* <dory/journal/journal.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Crash-recoverable write-ahead journal for messages accepted by dory.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <base/event_semaphore.h>
+#include <base/fd.h>
+#include <base/no_copy_semantics.h>
+#include <capped/pool.h>
+#include <dory/conf/journal_conf.h>
+#include <dory/msg.h>
+#include <thread/fd_managed_thread.h>
+
+namespace Dory {
+
+  class TMsgStateTracker;
+
+  namespace Journal {
+
+    /* A write-ahead journal of messages that dory has accepted but Kafka has
+       not yet acknowledged.  The router thread appends each message before
+       routing it, and the message is retired once it leaves dory (either
+       because Kafka acknowledged it or because it was discarded).  If dory
+       crashes, the messages that were appended but not retired are recovered
+       on the next startup and replayed through the router.  Delivery is
+       therefore at least once: a message whose retirement didn't reach disk
+       before a crash is sent again.
+
+       The journal is stored as a sequence of append-only segment files named
+       "journal.N" within a single directory.  Each file consists of an 8 byte
+       header (magic number and format version) followed by records, each as
+       follows:
+
+           payload size (4 bytes)
+           CRC-32C of payload (4 bytes)
+           payload
+
+       The first payload byte gives the record type.  An append record
+       contains a message's 8 byte journal sequence number followed by the
+       message (see <dory/util/msg_record.h>).  A retire record contains a 4
+       byte count followed by that many 8 byte sequence numbers.  All integers
+       are stored in network byte order.
+
+       Appends and retirements are queued in memory, and a dedicated writer
+       thread writes everything queued since its last write with a single
+       pwritev() call (group commit).  Depending on the sync policy, it then
+       calls fdatasync().  A segment is deleted once all of its messages have
+       been retired and all older segments have been deleted.  Deletion in
+       order guarantees that a retire record is never lost while its append
+       record still exists. */
+    class TJournal final : public Thread::TFdManagedThread {
+      NO_COPY_SEMANTICS(TJournal);
+
+      public:
+      using TSyncPolicy = Conf::TJournalConf::TSyncPolicy;
+
+      static const size_t DEFAULT_MAX_PENDING_BYTES = 64 * 1024 * 1024;
+
+      /* Use directory 'dir', which must exist, to store segments.  A new
+         segment is started once the current one reaches 'segment_size'
+         bytes.  'sync_interval' is in milliseconds, and is used only with
+         TSyncPolicy::Interval.  Append() fails once 'max_pending_bytes' of
+         append records are waiting for the writer thread.  Recovers any
+         segments left behind by a previous run.  Throws std::system_error
+         on failure to create the first segment. */
+      TJournal(const std::string &dir, size_t segment_size,
+          TSyncPolicy sync_policy, size_t sync_interval,
+          size_t max_pending_bytes = DEFAULT_MAX_PENDING_BYTES);
+
+      ~TJournal() override;
+
+      /* Return true if there are recovered messages that haven't yet been
+         obtained by GetRecoveredMsg(). */
+      bool HasRecoveredMsgs() const noexcept {
+        return !RecoveredMsgs.empty();
+      }
+
+      size_t GetRecoveredMsgCount() const noexcept {
+        return RecoveredMsgs.size();
+      }
+
+      /* Return the oldest recovered message as a newly created message
+         allocated from 'pool', or nullptr if there are none left.  The
+         message keeps its journal sequence number from the previous run, so
+         it is retired like any other message.  Throws
+         Capped::TMemoryCapReached, leaving the message available, if 'pool'
+         doesn't have enough space.  Must be called only by the thread that
+         calls Append(). */
+      TMsg::TPtr GetRecoveredMsg(Capped::TPool &pool,
+          TMsgStateTracker &msg_state_tracker);
+
+      /* Assign a journal sequence number to 'msg' and queue it for writing.
+         Return false if the message can't be journaled, either because it
+         is too large or because the writer thread has fallen too far behind.
+         Must be called from
+         only one thread (the router thread), since sequence numbers must be
+         written in increasing order. */
+      bool Append(TMsg &msg);
+
+      /* Queue retirement of 'msg', which has left dory.  Does nothing if
+         'msg' has no journal sequence number.  May be called from any
+         thread. */
+      void Retire(const TMsg &msg);
+
+      /* Same as above, but retire an entire list of messages. */
+      void Retire(const std::list<TMsg::TPtr> &msg_list);
+
+      /* Block until everything queued so far has been written, and synced if
+         required by the sync policy.  The writer thread must be running.  Only
+         one thread may call this at a time.  Used by test and benchmark
+         code. */
+      void Flush();
+
+      /* Return the number of segment files.  Must not be called while the
+         writer thread is running. */
+      size_t GetSegmentCount() const noexcept {
+        return Segments.size();
+      }
+
+      protected:
+      void Run() override;
+
+      private:
+      struct TSegment {
+        uint64_t Number = 0;
+
+        std::string Path;
+
+        /* Open only for the current (last) segment. */
+        Base::TFd Fd;
+
+        size_t Size = 0;
+
+        /* Sequence numbers of the first and last messages appended to this
+           segment.  For a segment with no appends, FirstSeq is one greater
+           than LastSeq, and LastSeq equals the previous segment's LastSeq.
+           Thus LastSeq is nondecreasing across segments. */
+        uint64_t FirstSeq = 1;
+
+        uint64_t LastSeq = 0;
+
+        /* Number of appended messages not yet retired. */
+        size_t LiveCount = 0;
+
+        /* True if a failed write left a partial record at the end of the
+           segment that couldn't be truncated away.  Nothing more may be
+           written to the segment, since recovery stops at the partial
+           record. */
+        bool Torn = false;
+      };  // TSegment
+
+      /* Location of a recovered message within a segment file. */
+      struct TRecoveredMsg {
+        /* Index into 'RecoveredFds'. */
+        size_t FdIndex = 0;
+
+        off_t Offset = 0;
+
+        uint32_t Size = 0;
+      };  // TRecoveredMsg
+
+      void Recover();
+
+      /* Parse the segment file with the given number and path, adding its
+         contents to 'Segments' and 'RecoveredMsgs'. */
+      void RecoverSegment(uint64_t number, const std::string &path,
+          std::map<uint64_t, size_t> &seq_to_segment);
+
+      /* Throws std::system_error on failure to create the segment. */
+      void AddSegment();
+
+      /* Start a new segment, and stop writing to the current one. */
+      void RotateSegment();
+
+      void DeleteFrontSegment();
+
+      /* Must be called with 'Mutex' held. */
+      void SignalDataPending();
+
+      void DoRun();
+
+      /* Write everything queued since the last call.  Return true if
+         anything was written. */
+      bool WriteBatch();
+
+      void WriteAll(const struct iovec *iov, size_t iov_count);
+
+      /* Called after a failed write to the current segment, which was
+         'good_size' bytes before the write.  Remove any partially written
+         data, so that records written later are recoverable. */
+      void DiscardPartialWrite(size_t good_size);
+
+      void Sync();
+
+      /* Update live counts for retired sequence numbers, and delete segments
+         that are no longer needed. */
+      void ApplyRetirements(const std::vector<uint64_t> &seqs);
+
+      const std::string Dir;
+
+      const size_t SegmentSize;
+
+      const TSyncPolicy SyncPolicy;
+
+      const size_t SyncInterval;
+
+      const size_t MaxPendingBytes;
+
+      /* Used only by the appending thread. */
+      uint64_t NextSeq = 1;
+
+      /* Used only by the appending thread. */
+      std::vector<uint8_t> AppendBuf;
+
+      /* Protects the pending data below. */
+      std::mutex Mutex;
+
+      /* Append records waiting to be written. */
+      std::vector<uint8_t> PendingAppends;
+
+      size_t PendingAppendCount = 0;
+
+      uint64_t PendingFirstSeq = 0;
+
+      uint64_t PendingLastSeq = 0;
+
+      /* Sequence numbers waiting to be written in a retire record. */
+      std::vector<uint64_t> PendingRetirements;
+
+      /* True if 'DataSem' has been pushed since the writer last took the
+         pending data. */
+      bool DataSignaled = false;
+
+      /* Number of batches taken by the writer, and number of batches fully
+         written.  Used by Flush(). */
+      uint64_t BatchesTaken = 0;
+
+      uint64_t BatchesDone = 0;
+
+      bool FlushWaiting = false;
+
+      Base::TEventSemaphore DataSem;
+
+      Base::TEventSemaphore FlushDoneSem;
+
+      /* Segments ordered by number.  Only the last one is written to.  Owned
+         by the writer thread once it has started. */
+      std::deque<TSegment> Segments;
+
+      uint64_t NextSegmentNumber = 0;
+
+      /* True if data has been written since the last sync. */
+      bool Dirty = false;
+
+      uint64_t LastSyncTime = 0;
+
+      /* Recovered messages not yet replayed, keyed by sequence number.  Used
+         only by the appending thread once the writer thread has started. */
+      std::map<uint64_t, TRecoveredMsg> RecoveredMsgs;
+
+      std::vector<Base::TFd> RecoveredFds;
+
+      std::vector<uint8_t> RecoveredBuf;
+    };  // TJournal
+
+  }  // Journal
+
+}  // Dory
@@ -0,0 +1,443 @@
+/* <dory/journal/journal.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/journal/journal.h>.
+ */
+
+#include <dory/journal/journal.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <string>
+#include <vector>
+
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <base/tmp_dir.h>
+#include <base/tmp_file.h>
+#include <capped/pool.h>
+#include <dory/msg.h>
+#include <dory/test_util/misc_util.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Capped;
+using namespace Dory;
+using namespace Dory::Journal;
+using namespace Dory::TestUtil;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TJournal. */
+  class TJournalTest : public ::testing::Test {
+    protected:
+    TJournalTest() = default;
+
+    ~TJournalTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TJournalTest
+
+  std::string MakeValue(size_t n) {
+    return std::string("value ") + std::to_string(n);
+  }
+
+  /* Return the path of the journal segment file with the highest number in
+     'dir'. */
+  std::string GetNewestSegment(const std::string &dir) {
+    std::string newest;
+
+    for (size_t i = 0; i < 1000; ++i) {
+      std::string path = dir + "/journal." + std::to_string(i);
+
+      if (access(path.c_str(), F_OK) == 0) {
+        newest = path;
+      }
+    }
+
+    return newest;
+  }
+
+  size_t CountSegments(const std::string &dir) {
+    size_t count = 0;
+
+    for (size_t i = 0; i < 1000; ++i) {
+      std::string path = dir + "/journal." + std::to_string(i);
+
+      if (access(path.c_str(), F_OK) == 0) {
+        ++count;
+      }
+    }
+
+    return count;
+  }
+
+  TEST_F(TJournalTest, AppendRetireRecover) {
+    TTmpDir dir("/tmp/journal_test.XXXXXX", true);
+    TTestMsgCreator mc;
+    const size_t count = 100;
+    uint64_t max_seq = 0;
+
+    {
+      TJournal journal(dir.GetName(), 64 * 1024,
+          TJournal::TSyncPolicy::Interval, 10);
+      ASSERT_FALSE(journal.HasRecoveredMsgs());
+      journal.Start();
+
+      for (size_t i = 0; i < count; ++i) {
+        TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(i),
+            static_cast<TMsg::TTimestamp>(i), true);
+        ASSERT_TRUE(journal.Append(*msg));
+        ASSERT_GT(msg->GetJournalSeq(), max_seq);
+        max_seq = msg->GetJournalSeq();
+
+        /* Retire the even numbered messages, some before and some after
+           they have been written. */
+        if ((i % 2) == 0) {
+          if ((i % 4) == 0) {
+            journal.Flush();
+          }
+
+          journal.Retire(*msg);
+        }
+      }
+
+      journal.Flush();
+      journal.RequestShutdown();
+      journal.Join();
+    }
+
+    {
+      TJournal journal(dir.GetName(), 64 * 1024,
+          TJournal::TSyncPolicy::Always, 10);
+      ASSERT_EQ(journal.GetRecoveredMsgCount(), count / 2);
+      journal.Start();
+      std::list<TMsg::TPtr> msg_list;
+
+      for (size_t i = 1; i < count; i += 2) {
+        TMsg::TPtr msg = journal.GetRecoveredMsg(*mc.Pool, mc.MsgStateTracker);
+        ASSERT_TRUE(!!msg);
+        ASSERT_EQ(msg->GetTopic(), "topic");
+        ASSERT_TRUE(ValueEquals(msg, MakeValue(i)));
+        ASSERT_EQ(msg->GetTimestamp(), static_cast<TMsg::TTimestamp>(i));
+        ASSERT_GT(msg->GetJournalSeq(), 0U);
+        ASSERT_LE(msg->GetJournalSeq(), max_seq);
+        msg_list.push_back(std::move(msg));
+      }
+
+      ASSERT_FALSE(journal.HasRecoveredMsgs());
+      ASSERT_FALSE(journal.GetRecoveredMsg(*mc.Pool, mc.MsgStateTracker));
+
+      /* New messages get sequence numbers beyond the recovered ones. */
+      TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(count), 0, true);
+      ASSERT_TRUE(journal.Append(*msg));
+      ASSERT_GT(msg->GetJournalSeq(), max_seq);
+
+      /* Retire all but the first recovered message. */
+      TMsg::TPtr first = std::move(msg_list.front());
+      msg_list.pop_front();
+      journal.Retire(msg_list);
+      journal.Retire(*msg);
+      SetProcessed(std::move(msg_list));
+      SetProcessed(msg);
+      SetProcessed(first);
+      journal.Flush();
+      journal.RequestShutdown();
+      journal.Join();
+    }
+
+    TJournal journal(dir.GetName(), 64 * 1024, TJournal::TSyncPolicy::None,
+        10);
+    ASSERT_EQ(journal.GetRecoveredMsgCount(), 1U);
+    TMsg::TPtr msg = journal.GetRecoveredMsg(*mc.Pool, mc.MsgStateTracker);
+    ASSERT_TRUE(!!msg);
+    SetProcessed(msg);
+    ASSERT_TRUE(ValueEquals(msg, MakeValue(1)));
+  }
+
+  TEST_F(TJournalTest, SegmentDeletion) {
+    TTmpDir dir("/tmp/journal_test.XXXXXX", true);
+    TTestMsgCreator mc;
+    std::list<TMsg::TPtr> msg_list;
+
+    {
+      TJournal journal(dir.GetName(), 4096, TJournal::TSyncPolicy::None, 10);
+      journal.Start();
+
+      for (size_t i = 0; i < 500; ++i) {
+        msg_list.push_back(mc.NewMsg("topic", MakeValue(i), 0, true));
+        ASSERT_TRUE(journal.Append(*msg_list.back()));
+
+        if ((i % 10) == 0) {
+          journal.Flush();
+        }
+      }
+
+      journal.Flush();
+      ASSERT_GT(CountSegments(dir.GetName()), 3U);
+
+      /* Retiring the newer messages doesn't allow any segments to be
+         deleted, since the oldest one still has a live message. */
+      TMsg::TPtr oldest = std::move(msg_list.front());
+      msg_list.pop_front();
+      journal.Retire(msg_list);
+      SetProcessed(std::move(msg_list));
+      journal.Flush();
+      ASSERT_GT(CountSegments(dir.GetName()), 3U);
+
+      journal.Retire(*oldest);
+      SetProcessed(oldest);
+      journal.Flush();
+      ASSERT_EQ(CountSegments(dir.GetName()), 1U);
+      journal.RequestShutdown();
+      journal.Join();
+      ASSERT_EQ(journal.GetSegmentCount(), 1U);
+    }
+
+    /* Nothing is recovered, and the old segment is deleted. */
+    TJournal journal(dir.GetName(), 4096, TJournal::TSyncPolicy::None, 10);
+    ASSERT_FALSE(journal.HasRecoveredMsgs());
+    ASSERT_EQ(journal.GetSegmentCount(), 1U);
+    ASSERT_EQ(CountSegments(dir.GetName()), 1U);
+  }
+
+  TEST_F(TJournalTest, TornRecord) {
+    TTmpDir dir("/tmp/journal_test.XXXXXX", true);
+    TTestMsgCreator mc;
+    const size_t count = 10;
+
+    {
+      TJournal journal(dir.GetName(), 64 * 1024,
+          TJournal::TSyncPolicy::Always, 10);
+      journal.Start();
+
+      for (size_t i = 0; i < count; ++i) {
+        TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(i), 0, true);
+        ASSERT_TRUE(journal.Append(*msg));
+        SetProcessed(msg);
+        journal.Flush();
+      }
+
+      journal.RequestShutdown();
+      journal.Join();
+    }
+
+    /* Simulate a crash in the middle of writing the last record. */
+    std::string newest = GetNewestSegment(dir.GetName());
+    ASSERT_FALSE(newest.empty());
+    struct stat st;
+    ASSERT_EQ(stat(newest.c_str(), &st), 0);
+    ASSERT_EQ(truncate(newest.c_str(), st.st_size - 3), 0);
+
+    {
+      TJournal journal(dir.GetName(), 64 * 1024,
+          TJournal::TSyncPolicy::Always, 10);
+      ASSERT_EQ(journal.GetRecoveredMsgCount(), count - 1);
+
+      for (size_t i = 0; i < (count - 1); ++i) {
+        TMsg::TPtr msg = journal.GetRecoveredMsg(*mc.Pool, mc.MsgStateTracker);
+        ASSERT_TRUE(!!msg);
+        SetProcessed(msg);
+        ASSERT_TRUE(ValueEquals(msg, MakeValue(i)));
+      }
+    }
+
+    /* Messages not retired are recovered again after another restart, and
+       a corrupted record hides everything after it in its segment. */
+    {
+      std::string path = dir.GetName() + "/journal.0";
+      FILE *f = std::fopen(path.c_str(), "r+");
+      ASSERT_TRUE(f != nullptr);
+      ASSERT_EQ(std::fseek(f, 40, SEEK_SET), 0);
+      const int c = std::fgetc(f);
+      ASSERT_EQ(std::fseek(f, 40, SEEK_SET), 0);
+      std::fputc(c ^ 0xff, f);
+      std::fclose(f);
+    }
+
+    TJournal journal(dir.GetName(), 64 * 1024, TJournal::TSyncPolicy::Always,
+        10);
+    ASSERT_EQ(journal.GetRecoveredMsgCount(), 0U);
+  }
+
+  TEST_F(TJournalTest, PartialWrite) {
+    TTmpDir dir("/tmp/journal_test.XXXXXX", true);
+    TTestMsgCreator mc;
+    const size_t count = 10;
+
+    {
+      TJournal journal(dir.GetName(), 64 * 1024, TJournal::TSyncPolicy::None,
+          10);
+      journal.Start();
+
+      for (size_t i = 0; i < (count / 2); ++i) {
+        TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(i), 0, true);
+        ASSERT_TRUE(journal.Append(*msg));
+        SetProcessed(msg);
+      }
+
+      journal.Flush();
+
+      /* Limit the file size so the next write is partial and then fails with
+         EFBIG, as it might with ENOSPC. */
+      struct stat st;
+      ASSERT_EQ(stat(GetNewestSegment(dir.GetName()).c_str(), &st), 0);
+      struct rlimit old_limit;
+      ASSERT_EQ(getrlimit(RLIMIT_FSIZE, &old_limit), 0);
+      struct rlimit new_limit = old_limit;
+      new_limit.rlim_cur = static_cast<rlim_t>(st.st_size) + 100;
+      const auto old_handler = signal(SIGXFSZ, SIG_IGN);
+      ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &new_limit), 0);
+      TMsg::TPtr big_msg = mc.NewMsg("topic", std::string(1000, 'x'), 0,
+          true);
+      ASSERT_TRUE(journal.Append(*big_msg));
+      SetProcessed(big_msg);
+      journal.Flush();
+      ASSERT_EQ(setrlimit(RLIMIT_FSIZE, &old_limit), 0);
+      signal(SIGXFSZ, old_handler);
+
+      /* Records written after the failure must still be recoverable. */
+      for (size_t i = count / 2; i < count; ++i) {
+        TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(i), 0, true);
+        ASSERT_TRUE(journal.Append(*msg));
+        SetProcessed(msg);
+      }
+
+      journal.RequestShutdown();
+      journal.Join();
+    }
+
+    TJournal journal(dir.GetName(), 64 * 1024, TJournal::TSyncPolicy::None,
+        10);
+    ASSERT_EQ(journal.GetRecoveredMsgCount(), count);
+
+    for (size_t i = 0; i < count; ++i) {
+      TMsg::TPtr msg = journal.GetRecoveredMsg(*mc.Pool, mc.MsgStateTracker);
+      ASSERT_TRUE(!!msg);
+      SetProcessed(msg);
+      ASSERT_TRUE(ValueEquals(msg, MakeValue(i)));
+    }
+  }
+
+  TEST_F(TJournalTest, PendingLimit) {
+    TTmpDir dir("/tmp/journal_test.XXXXXX", true);
+    TTestMsgCreator mc;
+    std::vector<std::string> journaled;
+
+    {
+      /* With the writer thread not yet running, appends accumulate until
+         the limit is reached. */
+      TJournal journal(dir.GetName(), 64 * 1024, TJournal::TSyncPolicy::None,
+          10, 1024);
+      size_t i = 0;
+
+      for (; ; ++i) {
+        TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(i), 0, true);
+        const bool ok = journal.Append(*msg);
+        SetProcessed(msg);
+
+        if (!ok) {
+          ASSERT_EQ(msg->GetJournalSeq(), 0U);
+          break;
+        }
+
+        journaled.push_back(MakeValue(i));
+      }
+
+      ASSERT_FALSE(journaled.empty());
+      journal.Start();
+      journal.Flush();
+
+      /* Once the writer catches up, appends succeed again. */
+      ++i;
+      TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(i), 0, true);
+      ASSERT_TRUE(journal.Append(*msg));
+      SetProcessed(msg);
+      journaled.push_back(MakeValue(i));
+      journal.RequestShutdown();
+      journal.Join();
+    }
+
+    /* Sequence numbers of rejected messages are reused, so everything
+       journaled is recovered in order. */
+    TJournal journal(dir.GetName(), 64 * 1024, TJournal::TSyncPolicy::None,
+        10);
+    ASSERT_EQ(journal.GetRecoveredMsgCount(), journaled.size());
+
+    for (const std::string &value : journaled) {
+      TMsg::TPtr msg = journal.GetRecoveredMsg(*mc.Pool, mc.MsgStateTracker);
+      ASSERT_TRUE(!!msg);
+      SetProcessed(msg);
+      ASSERT_TRUE(ValueEquals(msg, value));
+    }
+  }
+
+  TEST_F(TJournalTest, PoolFull) {
+    TTmpDir dir("/tmp/journal_test.XXXXXX", true);
+    TTestMsgCreator mc;
+
+    {
+      TJournal journal(dir.GetName(), 64 * 1024,
+          TJournal::TSyncPolicy::None, 10);
+      journal.Start();
+      TMsg::TPtr msg = mc.NewMsg("topic", std::string(256, 'x'), 0, true);
+      ASSERT_TRUE(journal.Append(*msg));
+      SetProcessed(msg);
+      journal.RequestShutdown();
+      journal.Join();
+    }
+
+    TJournal journal(dir.GetName(), 64 * 1024, TJournal::TSyncPolicy::None,
+        10);
+    TPool small_pool(64, 2, TPool::TSync::Unguarded);
+    bool threw = false;
+
+    try {
+      journal.GetRecoveredMsg(small_pool, mc.MsgStateTracker);
+    } catch (const TMemoryCapReached &) {
+      threw = true;
+    }
+
+    /* The message stays available until memory is available. */
+    ASSERT_TRUE(threw);
+    ASSERT_EQ(journal.GetRecoveredMsgCount(), 1U);
+    TMsg::TPtr msg = journal.GetRecoveredMsg(*mc.Pool, mc.MsgStateTracker);
+    ASSERT_TRUE(!!msg);
+    SetProcessed(msg);
+    ASSERT_TRUE(ValueEquals(msg, std::string(256, 'x')));
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
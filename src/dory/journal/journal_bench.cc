@@ -0,0 +1,228 @@
+/* <dory/journal/journal_bench.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Benchmark program that measures write-ahead journal throughput under each
+   sync policy.
+ */
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <base/basename.h>
+#include <base/tmp_dir.h>
+#include <capped/pool.h>
+#include <dory/build_id.h>
+#include <dory/conf/journal_conf.h>
+#include <dory/journal/journal.h>
+#include <dory/msg.h>
+#include <dory/msg_creator.h>
+#include <dory/msg_state_tracker.h>
+#include <dory/util/invalid_arg_error.h>
+#include <tclap/CmdLine.h>
+
+using namespace Base;
+using namespace Capped;
+using namespace Dory;
+using namespace Dory::Conf;
+using namespace Dory::Journal;
+using namespace Dory::Util;
+
+struct TCmdLineArgs {
+  /* Throws TInvalidArgError on error parsing args. */
+  TCmdLineArgs(int argc, const char *const argv[]);
+
+  std::string Dir = "/tmp";
+
+  std::string SyncPolicy = "all";
+
+  size_t MsgCount = 100000;
+
+  size_t MsgSize = 256;
+
+  size_t Window = 10000;
+
+  size_t SegmentSize = 64 * 1024 * 1024;
+
+  size_t SyncInterval = 100;
+};  // TCmdLineArgs
+
+static void ParseArgs(int argc, const char *const argv[], TCmdLineArgs &args) {
+  using namespace TCLAP;
+  const std::string prog_name = Basename(argv[0]);
+  std::vector<const char *> arg_vec(&argv[0], &argv[0] + argc);
+  arg_vec[0] = prog_name.c_str();
+
+  try {
+    CmdLine cmd(
+        "Benchmark for measuring write-ahead journal throughput with each "
+        "sync policy", ' ', dory_build_id);
+    ValueArg<decltype(args.Dir)> arg_dir("", "dir",
+        "Directory in which to create temporary journal directories.  Use a "
+        "directory on the filesystem you intend to use for the journal.",
+        false, args.Dir, "DIR");
+    cmd.add(arg_dir);
+    ValueArg<decltype(args.SyncPolicy)> arg_sync_policy("", "sync-policy",
+        "Sync policy to measure: none, interval, always, or all.", false,
+        args.SyncPolicy, "POLICY");
+    cmd.add(arg_sync_policy);
+    ValueArg<decltype(args.MsgCount)> arg_msg_count("", "msg-count",
+        "Number of messages to journal for each sync policy.", false,
+        args.MsgCount, "COUNT");
+    cmd.add(arg_msg_count);
+    ValueArg<decltype(args.MsgSize)> arg_msg_size("", "msg-size",
+        "Message value size in bytes.", false, args.MsgSize, "BYTES");
+    cmd.add(arg_msg_size);
+    ValueArg<decltype(args.Window)> arg_window("", "window",
+        "Number of messages awaiting acknowledgement.  Once this many have "
+        "been journaled, each new message causes the oldest one to be "
+        "retired.", false, args.Window, "COUNT");
+    cmd.add(arg_window);
+    ValueArg<decltype(args.SegmentSize)> arg_segment_size("", "segment-size",
+        "Journal segment size in bytes.", false, args.SegmentSize, "BYTES");
+    cmd.add(arg_segment_size);
+    ValueArg<decltype(args.SyncInterval)> arg_sync_interval("",
+        "sync-interval", "Sync interval in milliseconds for the interval "
+        "policy.", false, args.SyncInterval, "MS");
+    cmd.add(arg_sync_interval);
+    cmd.parse(argc, &arg_vec[0]);
+    args.Dir = arg_dir.getValue();
+    args.SyncPolicy = arg_sync_policy.getValue();
+    args.MsgCount = arg_msg_count.getValue();
+    args.MsgSize = arg_msg_size.getValue();
+    args.Window = arg_window.getValue();
+    args.SegmentSize = arg_segment_size.getValue();
+    args.SyncInterval = arg_sync_interval.getValue();
+  } catch (const ArgException &x) {
+    throw TInvalidArgError(x.error(), x.argId());
+  }
+
+  TJournalConf::TSyncPolicy policy = TJournalConf::TSyncPolicy::None;
+
+  if ((args.SyncPolicy != "all") &&
+      !TJournalConf::StringToSyncPolicy(args.SyncPolicy, policy)) {
+    throw TInvalidArgError("Invalid sync policy", "sync-policy");
+  }
+
+  if (args.Window == 0) {
+    throw TInvalidArgError("Window must be positive", "window");
+  }
+
+  if (args.SegmentSize < 4096) {
+    throw TInvalidArgError("Segment size must be at least 4096",
+        "segment-size");
+  }
+}
+
+TCmdLineArgs::TCmdLineArgs(int argc, const char *const argv[]) {
+  ParseArgs(argc, argv, *this);
+}
+
+static void RunOne(const TCmdLineArgs &args, const std::string &policy_name,
+    TJournalConf::TSyncPolicy policy) {
+  const std::string topic("journal_bench");
+  const std::string value(args.MsgSize, 'x');
+  const size_t block_size = 128;
+  const size_t blocks_per_msg = (args.MsgSize + block_size) / block_size;
+  TPool pool(block_size, (args.Window + 1) * blocks_per_msg,
+      TPool::TSync::Mutexed);
+  TTmpDir dir((args.Dir + "/journal_bench.XXXXXX").c_str(), true);
+  TJournal journal(dir.GetName(), args.SegmentSize, policy,
+      args.SyncInterval);
+  TMsgStateTracker msg_state_tracker;
+  msg_state_tracker.SetJournal(&journal);
+  journal.Start();
+  std::deque<TMsg::TPtr> in_flight;
+  const auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < args.MsgCount; ++i) {
+    if (in_flight.size() == args.Window) {
+      msg_state_tracker.MsgEnterProcessed(*in_flight.front());
+      in_flight.pop_front();
+    }
+
+    TMsg::TPtr msg = TMsgCreator::CreateAnyPartitionMsg(
+        static_cast<TMsg::TTimestamp>(i), topic.data(),
+        topic.data() + topic.size(), nullptr, 0, value.data(), value.size(),
+        false, pool, msg_state_tracker);
+    journal.Append(*msg);
+    in_flight.push_back(std::move(msg));
+  }
+
+  journal.Flush();
+  const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count();
+
+  for (TMsg::TPtr &msg : in_flight) {
+    msg_state_tracker.MsgEnterProcessed(*msg);
+  }
+
+  in_flight.clear();
+  journal.RequestShutdown();
+  journal.Join();
+  const double seconds = static_cast<double>(elapsed) / 1000000.0;
+  const double msgs_per_sec = (seconds > 0.0) ?
+      (static_cast<double>(args.MsgCount) / seconds) : 0.0;
+  const double mb_per_sec = msgs_per_sec *
+      static_cast<double>(args.MsgSize) / (1024.0 * 1024.0);
+  std::cout << policy_name << ": " << args.MsgCount << " messages in "
+      << (elapsed / 1000) << " ms, " << static_cast<uint64_t>(msgs_per_sec)
+      << " messages/sec, " << mb_per_sec << " MiB/sec of message data"
+      << std::endl;
+}
+
+static int journal_bench_main(int argc, const char *const *argv) {
+  const TCmdLineArgs args(argc, argv);
+  const std::vector<std::pair<std::string, TJournalConf::TSyncPolicy>>
+      policies = {
+        {"none", TJournalConf::TSyncPolicy::None},
+        {"interval", TJournalConf::TSyncPolicy::Interval},
+        {"always", TJournalConf::TSyncPolicy::Always}
+      };
+
+  for (const auto &item : policies) {
+    if ((args.SyncPolicy == "all") || (args.SyncPolicy == item.first)) {
+      RunOne(args, item.first, item.second);
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, const char *const *argv) {
+  int ret = EXIT_SUCCESS;
+
+  try {
+    ret = journal_bench_main(argc, argv);
+  } catch (const std::exception &ex) {
+    std::cerr << "error: " << ex.what() << std::endl;
+    ret = EXIT_FAILURE;
+  } catch (...) {
+    std::cerr << "error: uncaught unknown exception" << std::endl;
+    ret = EXIT_FAILURE;
+  }
+
+  return ret;
+}
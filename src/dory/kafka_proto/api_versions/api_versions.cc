@@ -0,0 +1,65 @@
+/* <dory/kafka_proto/api_versions/api_versions.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/kafka_proto/api_versions/api_versions.h>.
+ */
+
+#include <dory/kafka_proto/api_versions/api_versions.h>
+
+using namespace Dory;
+using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::ApiVersions;
+
+const TApiVersionRange *Dory::KafkaProto::ApiVersions::FindApiVersionRange(
+    const std::vector<TApiVersionRange> &broker_versions,
+    int16_t api_key) noexcept {
+  for (const TApiVersionRange &item : broker_versions) {
+    if (item.ApiKey == api_key) {
+      return &item;
+    }
+  }
+
+  return nullptr;
+}
+
+std::optional<size_t>
+Dory::KafkaProto::ApiVersions::ChooseHighestCommonVersion(
+    const std::vector<size_t> &supported_versions,
+    const std::vector<TApiVersionRange> &broker_versions,
+    int16_t api_key) noexcept {
+  const TApiVersionRange *range = FindApiVersionRange(broker_versions,
+      api_key);
+
+  if ((range == nullptr) || (range->MinVersion < 0) ||
+      (range->MaxVersion < range->MinVersion)) {
+    return std::nullopt;
+  }
+
+  const auto min_version = static_cast<size_t>(range->MinVersion);
+  const auto max_version = static_cast<size_t>(range->MaxVersion);
+
+  for (auto iter = supported_versions.rbegin();
+       iter != supported_versions.rend();
+       ++iter) {
+    if ((*iter >= min_version) && (*iter <= max_version)) {
+      return *iter;
+    }
+  }
+
+  return std::nullopt;
+}
@@ -0,0 +1,95 @@
+/* <dory/kafka_proto/api_versions/api_versions.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Version-independent definitions for the Kafka ApiVersions API, which a
+   client uses to learn which versions of each API a broker supports.  The
+   ApiVersions API requires Kafka 0.10 or newer.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace ApiVersions {
+
+      /* Kafka API keys that Dory cares about. */
+      const int16_t PRODUCE_API_KEY = 0;
+
+      const int16_t METADATA_API_KEY = 3;
+
+      const int16_t API_VERSIONS_API_KEY = 18;
+
+      class TBadApiVersionsResponse : public std::runtime_error {
+        protected:
+        explicit TBadApiVersionsResponse(const char *msg)
+            : std::runtime_error(msg) {
+        }
+
+        public:
+        ~TBadApiVersionsResponse() override = default;
+      };  // TBadApiVersionsResponse
+
+      /* One item from the API list of an ApiVersions response: the range of
+         versions of a single API that a broker supports. */
+      struct TApiVersionRange {
+        int16_t ApiKey = 0;
+
+        int16_t MinVersion = 0;
+
+        int16_t MaxVersion = 0;
+
+        TApiVersionRange() = default;
+
+        TApiVersionRange(int16_t api_key, int16_t min_version,
+            int16_t max_version) noexcept
+            : ApiKey(api_key),
+              MinVersion(min_version),
+              MaxVersion(max_version) {
+        }
+      };  // TApiVersionRange
+
+      /* Return a pointer to the item in 'broker_versions' for API key
+         'api_key', or nullptr if the broker does not list the API. */
+      const TApiVersionRange *FindApiVersionRange(
+          const std::vector<TApiVersionRange> &broker_versions,
+          int16_t api_key) noexcept;
+
+      /* 'supported_versions' is a list of the versions of some API that Dory
+         supports, sorted in ascending order (for instance, as returned by
+         Produce::GetSupportedProduceApiVersions()).  'broker_versions' is the
+         API list from a broker's ApiVersions response.  Return the highest
+         version of API 'api_key' that both Dory and the broker support, or
+         std::nullopt if there is no such version. */
+      std::optional<size_t> ChooseHighestCommonVersion(
+          const std::vector<size_t> &supported_versions,
+          const std::vector<TApiVersionRange> &broker_versions,
+          int16_t api_key) noexcept;
+
+    }  // ApiVersions
+
+  }  // KafkaProto
+
+}  // Dory
@@ -0,0 +1,189 @@
+/* <dory/kafka_proto/api_versions/v0/api_versions.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for version 0 of the Kafka ApiVersions request and response, and
+   for <dory/kafka_proto/api_versions/api_versions.h>.
+ */
+
+#include <dory/kafka_proto/api_versions/v0/api_versions_request_writer.h>
+#include <dory/kafka_proto/api_versions/v0/api_versions_response_reader.h>
+#include <dory/kafka_proto/api_versions/v0/api_versions_response_writer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <base/field_access.h>
+#include <base/tmp_file.h>
+#include <dory/kafka_proto/api_versions/api_versions.h>
+#include <dory/kafka_proto/request_response.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::ApiVersions;
+using namespace Dory::KafkaProto::ApiVersions::V0;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing ApiVersions requests and responses. */
+  class TApiVersionsTest : public ::testing::Test {
+    protected:
+    TApiVersionsTest() = default;
+
+    ~TApiVersionsTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TApiVersionsTest
+
+  TEST_F(TApiVersionsTest, RequestTest) {
+    using THdr = TApiVersionsRequestFields;
+    std::vector<uint8_t> buf;
+    TApiVersionsRequestWriter().WriteRequest(buf, 12345);
+    const size_t expected_size = THdr::REQUEST_SIZE;
+    ASSERT_EQ(buf.size(), expected_size);
+    ASSERT_EQ(GetRequestOrResponseSize(&buf[0]), buf.size());
+    ASSERT_EQ(ReadInt16FromHeader(&buf[THdr::API_KEY_OFFSET]),
+              API_VERSIONS_API_KEY);
+    ASSERT_EQ(ReadInt16FromHeader(&buf[THdr::API_VERSION_OFFSET]), 0);
+    ASSERT_EQ(ReadInt32FromHeader(&buf[THdr::CORRELATION_ID_OFFSET]), 12345);
+    ASSERT_EQ(ReadInt16FromHeader(&buf[THdr::CLIENT_ID_LENGTH_OFFSET]), -1);
+  }
+
+  TEST_F(TApiVersionsTest, ResponseTest) {
+    const std::vector<TApiVersionRange> versions = {
+      TApiVersionRange(PRODUCE_API_KEY, 0, 7),
+      TApiVersionRange(METADATA_API_KEY, 0, 5),
+      TApiVersionRange(API_VERSIONS_API_KEY, 0, 1)
+    };
+    std::vector<uint8_t> buf;
+    TApiVersionsResponseWriter().WriteResponse(buf, 42, 0, versions);
+    ASSERT_EQ(GetRequestOrResponseSize(&buf[0]), buf.size());
+    TApiVersionsResponseReader reader(&buf[0], buf.size());
+    ASSERT_EQ(reader.GetCorrelationId(), 42);
+    ASSERT_EQ(reader.GetErrorCode(), 0);
+    const std::vector<TApiVersionRange> &result = reader.GetApiVersions();
+    ASSERT_EQ(result.size(), versions.size());
+
+    for (size_t i = 0; i < versions.size(); ++i) {
+      ASSERT_EQ(result[i].ApiKey, versions[i].ApiKey);
+      ASSERT_EQ(result[i].MinVersion, versions[i].MinVersion);
+      ASSERT_EQ(result[i].MaxVersion, versions[i].MaxVersion);
+    }
+
+    /* Empty API list with error code (as sent by a broker that doesn't
+       support the requested ApiVersions version). */
+    TApiVersionsResponseWriter().WriteResponse(buf, 43, 35, {});
+    TApiVersionsResponseReader reader2(&buf[0], buf.size());
+    ASSERT_EQ(reader2.GetCorrelationId(), 43);
+    ASSERT_EQ(reader2.GetErrorCode(), 35);
+    ASSERT_TRUE(reader2.GetApiVersions().empty());
+  }
+
+  TEST_F(TApiVersionsTest, BadResponseTest) {
+    using TIncomplete =
+        TApiVersionsResponseReader::TIncompleteApiVersionsResponse;
+    const std::vector<TApiVersionRange> versions = {
+      TApiVersionRange(PRODUCE_API_KEY, 0, 7),
+      TApiVersionRange(METADATA_API_KEY, 0, 5)
+    };
+    std::vector<uint8_t> buf;
+    TApiVersionsResponseWriter().WriteResponse(buf, 1, 0, versions);
+    bool threw = false;
+
+    try {
+      TApiVersionsResponseReader reader(&buf[0], buf.size() - 1);
+    } catch (const TIncomplete &) {
+      threw = true;
+    }
+
+    ASSERT_TRUE(threw);
+    threw = false;
+
+    try {
+      TApiVersionsResponseReader reader(&buf[0],
+          TApiVersionsResponseReader::MinSize() - 1);
+    } catch (const TIncomplete &) {
+      threw = true;
+    }
+
+    ASSERT_TRUE(threw);
+    WriteInt32ToHeader(&buf[TApiVersionsResponseFields::API_COUNT_OFFSET], -1);
+    threw = false;
+
+    try {
+      TApiVersionsResponseReader reader(&buf[0], buf.size());
+    } catch (const TBadApiVersionsResponse &) {
+      threw = true;
+    }
+
+    ASSERT_TRUE(threw);
+  }
+
+  TEST_F(TApiVersionsTest, ChooseVersionTest) {
+    const std::vector<size_t> supported = { 0, 3 };
+    std::vector<TApiVersionRange> broker = {
+      TApiVersionRange(PRODUCE_API_KEY, 0, 7),
+      TApiVersionRange(METADATA_API_KEY, 0, 5)
+    };
+    std::optional<size_t> v = ChooseHighestCommonVersion(supported, broker,
+        PRODUCE_API_KEY);
+    ASSERT_TRUE(v.has_value());
+    ASSERT_EQ(*v, 3U);
+
+    /* Broker too old for v3. */
+    broker[0].MaxVersion = 2;
+    v = ChooseHighestCommonVersion(supported, broker, PRODUCE_API_KEY);
+    ASSERT_TRUE(v.has_value());
+    ASSERT_EQ(*v, 0U);
+
+    /* Broker has dropped support for old versions. */
+    broker[0].MinVersion = 1;
+    broker[0].MaxVersion = 9;
+    v = ChooseHighestCommonVersion(supported, broker, PRODUCE_API_KEY);
+    ASSERT_TRUE(v.has_value());
+    ASSERT_EQ(*v, 3U);
+
+    /* No common version. */
+    broker[0].MinVersion = 4;
+    v = ChooseHighestCommonVersion(supported, broker, PRODUCE_API_KEY);
+    ASSERT_FALSE(v.has_value());
+
+    /* API not listed by broker. */
+    v = ChooseHighestCommonVersion(supported, broker, API_VERSIONS_API_KEY);
+    ASSERT_FALSE(v.has_value());
+    ASSERT_EQ(FindApiVersionRange(broker, API_VERSIONS_API_KEY), nullptr);
+    ASSERT_EQ(FindApiVersionRange(broker, METADATA_API_KEY), &broker[1]);
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
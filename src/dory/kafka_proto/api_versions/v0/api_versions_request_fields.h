@@ -0,0 +1,81 @@
+/* <dory/kafka_proto/api_versions/v0/api_versions_request_fields.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Field sizes and offsets for version 0 of the Kafka ApiVersions request.  The
+   request consists only of the standard request header.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <dory/kafka_proto/api_versions/api_versions.h>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace ApiVersions {
+
+      namespace V0 {
+
+        class TApiVersionsRequestFields final {
+          public:
+          static const size_t REQUEST_SIZE_SIZE = 4;
+
+          static const size_t API_KEY_SIZE = 2;
+
+          static const size_t API_VERSION_SIZE = 2;
+
+          static const size_t CORRELATION_ID_SIZE = 4;
+
+          static const size_t CLIENT_ID_LENGTH_SIZE = 2;
+
+          static const size_t REQUEST_SIZE_OFFSET = 0;
+
+          static const size_t API_KEY_OFFSET =
+              REQUEST_SIZE_OFFSET + REQUEST_SIZE_SIZE;
+
+          static const size_t API_VERSION_OFFSET = API_KEY_OFFSET +
+              API_KEY_SIZE;
+
+          static const size_t CORRELATION_ID_OFFSET =
+              API_VERSION_OFFSET + API_VERSION_SIZE;
+
+          static const size_t CLIENT_ID_LENGTH_OFFSET =
+              CORRELATION_ID_OFFSET + CORRELATION_ID_SIZE;
+
+          /* Total size of a request with an empty client ID. */
+          static const size_t REQUEST_SIZE =
+              CLIENT_ID_LENGTH_OFFSET + CLIENT_ID_LENGTH_SIZE;
+
+          static const int16_t API_KEY = API_VERSIONS_API_KEY;
+
+          static const int16_t API_VERSION = 0;
+
+          static const int16_t EMPTY_STRING_LENGTH = -1;
+        };  // TApiVersionsRequestFields
+
+      }  // V0
+
+    }  // ApiVersions
+
+  }  // KafkaProto
+
+}  // Dory
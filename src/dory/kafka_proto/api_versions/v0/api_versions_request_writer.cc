@@ -0,0 +1,40 @@
+/* <dory/kafka_proto/api_versions/v0/api_versions_request_writer.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/kafka_proto/api_versions/v0/api_versions_request_writer.h>.
+ */
+
+#include <dory/kafka_proto/api_versions/v0/api_versions_request_writer.h>
+
+#include <base/field_access.h>
+
+using namespace Dory;
+using namespace Dory::KafkaProto::ApiVersions::V0;
+
+void TApiVersionsRequestWriter::WriteRequest(std::vector<uint8_t> &result,
+    int32_t correlation_id) {
+  result.resize(THdr::REQUEST_SIZE);
+  uint8_t *buf = &result[0];
+  WriteInt32ToHeader(buf,
+      static_cast<int32_t>(THdr::REQUEST_SIZE - THdr::REQUEST_SIZE_SIZE));
+  WriteInt16ToHeader(buf + THdr::API_KEY_OFFSET, THdr::API_KEY);
+  WriteInt16ToHeader(buf + THdr::API_VERSION_OFFSET, THdr::API_VERSION);
+  WriteInt32ToHeader(buf + THdr::CORRELATION_ID_OFFSET, correlation_id);
+  WriteInt16ToHeader(buf + THdr::CLIENT_ID_LENGTH_OFFSET,
+                     THdr::EMPTY_STRING_LENGTH);
+}
@@ -0,0 +1,81 @@
+/* <dory/kafka_proto/api_versions/v0/api_versions_response_fields.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Field sizes and offsets for version 0 of the Kafka ApiVersions response.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace ApiVersions {
+
+      namespace V0 {
+
+        class TApiVersionsResponseFields final {
+          public:
+          static const size_t RESPONSE_SIZE_SIZE = 4;
+
+          static const size_t CORRELATION_ID_SIZE = 4;
+
+          static const size_t ERROR_CODE_SIZE = 2;
+
+          static const size_t API_COUNT_SIZE = 4;
+
+          static const size_t API_KEY_SIZE = 2;
+
+          static const size_t MIN_VERSION_SIZE = 2;
+
+          static const size_t MAX_VERSION_SIZE = 2;
+
+          static const size_t CORRELATION_ID_OFFSET = RESPONSE_SIZE_SIZE;
+
+          static const size_t ERROR_CODE_OFFSET =
+              CORRELATION_ID_OFFSET + CORRELATION_ID_SIZE;
+
+          static const size_t API_COUNT_OFFSET =
+              ERROR_CODE_OFFSET + ERROR_CODE_SIZE;
+
+          static const size_t API_LIST_OFFSET =
+              API_COUNT_OFFSET + API_COUNT_SIZE;
+
+          /* Offsets below are relative to the start of an API list item. */
+
+          static const size_t API_KEY_OFFSET = 0;
+
+          static const size_t MIN_VERSION_OFFSET =
+              API_KEY_OFFSET + API_KEY_SIZE;
+
+          static const size_t MAX_VERSION_OFFSET =
+              MIN_VERSION_OFFSET + MIN_VERSION_SIZE;
+
+          static const size_t API_ITEM_SIZE =
+              MAX_VERSION_OFFSET + MAX_VERSION_SIZE;
+        };  // TApiVersionsResponseFields
+
+      }  // V0
+
+    }  // ApiVersions
+
+  }  // KafkaProto
+
+}  // Dory
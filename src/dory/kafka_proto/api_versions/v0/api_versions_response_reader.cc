@@ -0,0 +1,74 @@
+/* <dory/kafka_proto/api_versions/v0/api_versions_response_reader.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements
+   <dory/kafka_proto/api_versions/v0/api_versions_response_reader.h>.
+ */
+
+#include <dory/kafka_proto/api_versions/v0/api_versions_response_reader.h>
+
+#include <cassert>
+
+#include <base/counter.h>
+#include <base/field_access.h>
+
+using namespace Dory;
+using namespace Dory::KafkaProto::ApiVersions;
+using namespace Dory::KafkaProto::ApiVersions::V0;
+
+DEFINE_COUNTER(ApiVersionsResponseIncomplete1);
+DEFINE_COUNTER(ApiVersionsResponseIncomplete2);
+DEFINE_COUNTER(ApiVersionsResponseNegativeApiCount);
+
+TApiVersionsResponseReader::TApiVersionsResponseReader(const void *buf,
+    size_t buf_size) {
+  assert(buf);
+  const auto *pos = reinterpret_cast<const uint8_t *>(buf);
+
+  if (buf_size < MinSize()) {
+    ApiVersionsResponseIncomplete1.Increment();
+    THROW_ERROR(TIncompleteApiVersionsResponse);
+  }
+
+  CorrelationId = ReadInt32FromHeader(pos + THdr::CORRELATION_ID_OFFSET);
+  ErrorCode = ReadInt16FromHeader(pos + THdr::ERROR_CODE_OFFSET);
+  const int32_t api_count = ReadInt32FromHeader(pos + THdr::API_COUNT_OFFSET);
+
+  if (api_count < 0) {
+    ApiVersionsResponseNegativeApiCount.Increment();
+    THROW_ERROR(TNegativeApiCount);
+  }
+
+  const auto count = static_cast<size_t>(api_count);
+
+  if (((buf_size - THdr::API_LIST_OFFSET) / THdr::API_ITEM_SIZE) < count) {
+    ApiVersionsResponseIncomplete2.Increment();
+    THROW_ERROR(TIncompleteApiVersionsResponse);
+  }
+
+  ApiVersionList.reserve(count);
+  pos += THdr::API_LIST_OFFSET;
+
+  for (size_t i = 0; i < count; ++i) {
+    ApiVersionList.emplace_back(
+        ReadInt16FromHeader(pos + THdr::API_KEY_OFFSET),
+        ReadInt16FromHeader(pos + THdr::MIN_VERSION_OFFSET),
+        ReadInt16FromHeader(pos + THdr::MAX_VERSION_OFFSET));
+    pos += THdr::API_ITEM_SIZE;
+  }
+}
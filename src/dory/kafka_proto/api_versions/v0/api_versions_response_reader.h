@@ -0,0 +1,91 @@
+/* <dory/kafka_proto/api_versions/v0/api_versions_response_reader.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class for parsing a version 0 Kafka ApiVersions response.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <base/thrower.h>
+#include <dory/kafka_proto/api_versions/api_versions.h>
+#include <dory/kafka_proto/api_versions/v0/api_versions_response_fields.h>
+#include <dory/kafka_proto/request_response.h>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace ApiVersions {
+
+      namespace V0 {
+
+        class TApiVersionsResponseReader final {
+          NO_COPY_SEMANTICS(TApiVersionsResponseReader);
+
+          using THdr = TApiVersionsResponseFields;
+
+          public:
+          DEFINE_ERROR(TIncompleteApiVersionsResponse,
+              TBadApiVersionsResponse,
+              "Kafka ApiVersions response is incomplete");
+
+          DEFINE_ERROR(TNegativeApiCount, TBadApiVersionsResponse,
+              "Kafka ApiVersions response has negative API count");
+
+          static size_t MinSize() {
+            return THdr::API_LIST_OFFSET;
+          }
+
+          /* 'buf' points to a complete response, starting with the size
+             field.  The entire response is parsed here.  Throws a subclass of
+             TBadApiVersionsResponse if the response is malformed. */
+          TApiVersionsResponseReader(const void *buf, size_t buf_size);
+
+          int32_t GetCorrelationId() const noexcept {
+            return CorrelationId;
+          }
+
+          int16_t GetErrorCode() const noexcept {
+            return ErrorCode;
+          }
+
+          const std::vector<TApiVersionRange> &
+          GetApiVersions() const noexcept {
+            return ApiVersionList;
+          }
+
+          private:
+          int32_t CorrelationId = 0;
+
+          int16_t ErrorCode = 0;
+
+          std::vector<TApiVersionRange> ApiVersionList;
+        };  // TApiVersionsResponseReader
+
+      }  // V0
+
+    }  // ApiVersions
+
+  }  // KafkaProto
+
+}  // Dory
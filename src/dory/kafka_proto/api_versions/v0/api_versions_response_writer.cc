@@ -0,0 +1,52 @@
+/* <dory/kafka_proto/api_versions/v0/api_versions_response_writer.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements
+   <dory/kafka_proto/api_versions/v0/api_versions_response_writer.h>.
+ */
+
+#include <dory/kafka_proto/api_versions/v0/api_versions_response_writer.h>
+
+#include <base/field_access.h>
+
+using namespace Dory;
+using namespace Dory::KafkaProto::ApiVersions;
+using namespace Dory::KafkaProto::ApiVersions::V0;
+
+void TApiVersionsResponseWriter::WriteResponse(std::vector<uint8_t> &out,
+    int32_t correlation_id, int16_t error_code,
+    const std::vector<TApiVersionRange> &api_versions) {
+  const size_t size = THdr::API_LIST_OFFSET +
+      (api_versions.size() * THdr::API_ITEM_SIZE);
+  out.resize(size);
+  uint8_t *pos = &out[0];
+  WriteInt32ToHeader(pos,
+      static_cast<int32_t>(size - THdr::RESPONSE_SIZE_SIZE));
+  WriteInt32ToHeader(pos + THdr::CORRELATION_ID_OFFSET, correlation_id);
+  WriteInt16ToHeader(pos + THdr::ERROR_CODE_OFFSET, error_code);
+  WriteInt32ToHeader(pos + THdr::API_COUNT_OFFSET,
+      static_cast<int32_t>(api_versions.size()));
+  pos += THdr::API_LIST_OFFSET;
+
+  for (const TApiVersionRange &item : api_versions) {
+    WriteInt16ToHeader(pos + THdr::API_KEY_OFFSET, item.ApiKey);
+    WriteInt16ToHeader(pos + THdr::MIN_VERSION_OFFSET, item.MinVersion);
+    WriteInt16ToHeader(pos + THdr::MAX_VERSION_OFFSET, item.MaxVersion);
+    pos += THdr::API_ITEM_SIZE;
+  }
+}
@@ -0,0 +1,61 @@
+/* <dory/kafka_proto/api_versions/v0/api_versions_response_writer.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class for writing a version 0 Kafka ApiVersions response.  Used by the mock
+   Kafka server.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <dory/kafka_proto/api_versions/api_versions.h>
+#include <dory/kafka_proto/api_versions/v0/api_versions_response_fields.h>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace ApiVersions {
+
+      namespace V0 {
+
+        class TApiVersionsResponseWriter final {
+          NO_COPY_SEMANTICS(TApiVersionsResponseWriter);
+
+          using THdr = TApiVersionsResponseFields;
+
+          public:
+          TApiVersionsResponseWriter() = default;
+
+          /* Write a response to 'out', which will be resized to contain it.
+           */
+          void WriteResponse(std::vector<uint8_t> &out, int32_t correlation_id,
+              int16_t error_code,
+              const std::vector<TApiVersionRange> &api_versions);
+        };  // TApiVersionsResponseWriter
+
+      }  // V0
+
+    }  // ApiVersions
+
+  }  // KafkaProto
+
+}  // Dory
@@ -38,6 +38,29 @@ namespace Dory {
         NO_COPY_SEMANTICS(TMsgSetWriterApi);
 
         public:
+        /* Serialized form of a message, minus its key and value.  The
+           complete message consists of 'BeforeKey', then the key, then
+           'BeforeValue', then the value, then 'AfterValue'. */
+        struct TMsgFraming {
+          static const size_t MAX_PART_SIZE = 32;
+
+          uint8_t BeforeKey[MAX_PART_SIZE];
+
+          size_t BeforeKeySize = 0;
+
+          uint8_t BeforeValue[MAX_PART_SIZE];
+
+          size_t BeforeValueSize = 0;
+
+          uint8_t AfterValue[MAX_PART_SIZE];
+
+          size_t AfterValueSize = 0;
+
+          size_t GetOverheadSize() const noexcept {
+            return BeforeKeySize + BeforeValueSize + AfterValueSize;
+          }
+        };  // TMsgFraming
+
         virtual ~TMsgSetWriterApi() = default;
 
         virtual void Reset() = 0;
@@ -50,8 +73,11 @@ namespace Dory {
         virtual void OpenMsgSet(std::vector<uint8_t> &result_buf,
             bool append) = 0;
 
+        /* Parameter 'timestamp' is the message timestamp in milliseconds
+           since the epoch.  Protocol versions whose message format has no
+           timestamps ignore it. */
         virtual void OpenMsg(Compress::TCompressionType compression_type,
-            size_t key_size, size_t value_size) = 0;
+            int64_t timestamp, size_t key_size, size_t value_size) = 0;
 
         virtual size_t GetCurrentMsgKeyOffset() const = 0;
 
@@ -64,11 +90,29 @@ namespace Dory {
         virtual void CloseMsg() = 0;
 
         virtual void AddMsg(Compress::TCompressionType compression_type,
-            const uint8_t *key_begin, const uint8_t *key_end,
-            const uint8_t *value_begin, const uint8_t *value_end) = 0;
+            int64_t timestamp, const uint8_t *key_begin,
+            const uint8_t *key_end, const uint8_t *value_begin,
+            const uint8_t *value_end) = 0;
 
         virtual size_t CloseMsgSet() = 0;
 
+        /* Return true if FrameMsg() is supported.  Message formats that
+           contain a checksum of each message can't be framed, since the
+           checksum must be written before the key and value are seen. */
+        virtual bool SupportsMsgFraming() const noexcept = 0;
+
+        /* As an alternative to OpenMsgSet() ... CloseMsgSet(), compute the
+           framing for the message at position 'msg_index' in a message set
+           whose first message has timestamp 'first_timestamp'.  Concatenating
+           the framed messages with their keys and values gives the same
+           result as serializing them with OpenMsg() and CloseMsg().  This
+           lets a message set be streamed directly to a compressor without
+           copying keys and values into a buffer first.  Must only be called
+           if SupportsMsgFraming() returns true. */
+        virtual void FrameMsg(size_t msg_index, int64_t first_timestamp,
+            int64_t timestamp, size_t key_size, size_t value_size,
+            TMsgFraming &framing) const = 0;
+
         protected:
         TMsgSetWriterApi() = default;
       };  // TMsgSetWriterApi
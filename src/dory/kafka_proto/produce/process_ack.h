@@ -0,0 +1,45 @@
+/* <dory/kafka_proto/produce/process_ack.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2013-2014 if(we)
+   Copyright 2017 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Error code handling for Kafka produce responses, which is shared by all
+   supported versions of the produce protocol.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <dory/kafka_proto/produce/produce_protocol.h>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace Produce {
+
+      /* Examine error code 'ack_value' from a produce response, update the
+         appropriate counters, and return the action to take for the
+         corresponding message set. */
+      TProduceProtocol::TAckResultAction ProcessProduceAck(int16_t ack_value);
+
+    }  // Produce
+
+  }  // KafkaProto
+
+}  // Dory
@@ -32,6 +32,7 @@
 #include <string>
 
 #include <base/no_copy_semantics.h>
+#include <dory/compress/compression_type.h>
 #include <dory/kafka_proto/produce/msg_set_writer_api.h>
 #include <dory/kafka_proto/produce/produce_request_writer_api.h>
 #include <dory/kafka_proto/produce/produce_response_reader_api.h>
@@ -62,6 +63,13 @@ namespace Dory {
           return Constants.SingleMsgOverhead;
         }
 
+        /* Return the number of bytes of fixed overhead for a message set,
+           beyond the per-message overhead reported by
+           GetSingleMsgOverhead(). */
+        size_t GetMsgSetOverhead() const {
+          return Constants.MsgSetOverhead;
+        }
+
         /* Return a pointer to a newly created produce request writer object.
            Caller assumes responsibility for deleting object. */
         virtual std::unique_ptr<TProduceRequestWriterApi>
@@ -79,11 +87,22 @@ namespace Dory {
 
         virtual TAckResultAction ProcessAck(int16_t ack_value) const = 0;
 
+        /* Return true if message sets compressed with the given compression
+           type can be sent using this protocol version, or false otherwise.
+           For instance, zstd requires version 7 or later. */
+        virtual bool SupportsCompressionType(
+            Compress::TCompressionType type) const noexcept = 0;
+
         protected:
         struct TConstants {
           /* This is the number of bytes of overhead for a single message in a
              produce request. */
           size_t SingleMsgOverhead;
+
+          /* This is the number of bytes of overhead for a message set in a
+             produce request, not counting the overhead of the messages it
+             contains. */
+          size_t MsgSetOverhead;
         };
 
         explicit TProduceProtocol(const TConstants &constants)
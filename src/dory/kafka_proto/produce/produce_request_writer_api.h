@@ -52,8 +52,24 @@ namespace Dory {
 
         virtual void OpenMsgSet(int32_t partition) = 0;
 
+        /* Parameter 'timestamp' is the message timestamp in milliseconds
+           since the epoch.  Protocol versions whose message format has no
+           timestamps ignore it. */
         virtual void OpenMsg(Compress::TCompressionType compression_type,
-            size_t key_size, size_t value_size) = 0;
+            int64_t timestamp, size_t key_size, size_t value_size) = 0;
+
+        /* Open a message whose value will contain a compressed message set
+           serialized by a TMsgSetWriterApi object for the same protocol
+           version.  'msg_count' is the number of messages in the compressed
+           message set.  'first_timestamp' is the timestamp of its first
+           message, and 'max_timestamp' is the largest timestamp of any of its
+           messages.  Space is reserved for 'value_size' bytes of compressed
+           data, which the caller may shrink by calling AdjustValueSize()
+           before calling CloseMsg(). */
+        virtual void OpenCompressedMsg(
+            Compress::TCompressionType compression_type, size_t msg_count,
+            int64_t first_timestamp, int64_t max_timestamp,
+            size_t value_size) = 0;
 
         virtual size_t GetCurrentMsgKeyOffset() const = 0;
 
@@ -66,8 +82,9 @@ namespace Dory {
         virtual void CloseMsg() = 0;
 
         virtual void AddMsg(Compress::TCompressionType compression_type,
-            const uint8_t *key_begin, const uint8_t *key_end,
-            const uint8_t *value_begin, const uint8_t *value_end) = 0;
+            int64_t timestamp, const uint8_t *key_begin,
+            const uint8_t *key_end, const uint8_t *value_begin,
+            const uint8_t *value_end) = 0;
 
         virtual void CloseMsgSet() = 0;
 
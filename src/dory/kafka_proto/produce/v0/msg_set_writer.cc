@@ -24,6 +24,7 @@
 #include <limits>
 
 #include <base/crc.h>
+#include <base/error_util.h>
 #include <base/no_default_case.h>
 
 using namespace Base;
@@ -88,6 +89,11 @@ static int8_t XlateCompressionType(TCompressionType compression_type) {
       attr = PRC::LZ4_COMPRESSION_ATTR;
       break;
     }
+    case TCompressionType::Zstd: {
+      /* Messages with magic byte 0 can't carry zstd compressed data.  Callers
+         are expected to check TProduceProtocol::SupportsCompressionType(). */
+      Die("Zstd compression is not supported by produce API version 0");
+    }
     NO_DEFAULT_CASE;
   }
 
@@ -95,7 +101,7 @@ static int8_t XlateCompressionType(TCompressionType compression_type) {
 }
 
 void TMsgSetWriter::OpenMsg(TCompressionType compression_type,
-    size_t key_size, size_t value_size) {
+    int64_t /*timestamp*/, size_t key_size, size_t value_size) {
   assert(State == TState::InMsgSet);
   assert(Buf);
   assert(key_size <= static_cast<size_t>(std::numeric_limits<int32_t>::max()));
@@ -200,7 +206,7 @@ void TMsgSetWriter::CloseMsg() {
 }
 
 void TMsgSetWriter::AddMsg(TCompressionType compression_type,
-    const uint8_t *key_begin, const uint8_t *key_end,
+    int64_t timestamp, const uint8_t *key_begin, const uint8_t *key_end,
     const uint8_t *value_begin, const uint8_t *value_end) {
   assert(State == TState::InMsgSet);
   assert(Buf);
@@ -213,7 +219,7 @@ void TMsgSetWriter::AddMsg(TCompressionType compression_type,
   size_t value_size = value_end - value_begin;
   assert(value_size <=
       static_cast<size_t>(std::numeric_limits<int32_t>::max()));
-  OpenMsg(compression_type, key_size, value_size);
+  OpenMsg(compression_type, timestamp, key_size, value_size);
 
   if (key_size) {
     std::memcpy(&(*Buf)[GetCurrentMsgKeyOffset()], key_begin, key_size);
@@ -236,3 +242,9 @@ size_t TMsgSetWriter::CloseMsgSet() {
       static_cast<size_t>(std::numeric_limits<int32_t>::max()));
   return MsgSetSize;
 }
+
+void TMsgSetWriter::FrameMsg(size_t /*msg_index*/, int64_t /*first_timestamp*/,
+    int64_t /*timestamp*/, size_t /*key_size*/, size_t /*value_size*/,
+    TMsgFraming & /*framing*/) const {
+  Die("Message framing is not supported by produce API version 0");
+}
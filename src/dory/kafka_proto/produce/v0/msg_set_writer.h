@@ -56,7 +56,7 @@ namespace Dory {
               bool append) override;
 
           void OpenMsg(Compress::TCompressionType compression_type,
-              size_t key_size, size_t value_size) override;
+              int64_t timestamp, size_t key_size, size_t value_size) override;
 
           size_t GetCurrentMsgKeyOffset() const override;
 
@@ -69,11 +69,22 @@ namespace Dory {
           void CloseMsg() override;
 
           void AddMsg(Compress::TCompressionType compression_type,
-              const uint8_t *key_begin, const uint8_t *key_end,
-              const uint8_t *value_begin, const uint8_t *value_end) override;
+              int64_t timestamp, const uint8_t *key_begin,
+              const uint8_t *key_end, const uint8_t *value_begin,
+              const uint8_t *value_end) override;
 
           size_t CloseMsgSet() override;
 
+          /* Each message contains a CRC that covers its key and value, so
+             framing isn't possible. */
+          bool SupportsMsgFraming() const noexcept override {
+            return false;
+          }
+
+          void FrameMsg(size_t msg_index, int64_t first_timestamp,
+              int64_t timestamp, size_t key_size, size_t value_size,
+              TMsgFraming &framing) const override;
+
           private:
           using PRC = TProduceRequestConstants;
 
@@ -61,6 +61,9 @@ namespace Dory {
 
           TAckResultAction ProcessAck(int16_t ack_value) const override;
 
+          bool SupportsCompressionType(
+              Compress::TCompressionType type) const noexcept override;
+
           private:
           static TConstants ComputeConstants();
         };  // TProduceProto
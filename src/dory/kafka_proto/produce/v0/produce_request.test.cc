@@ -147,8 +147,8 @@ namespace {
                 const auto *value_begin =
                     reinterpret_cast<const uint8_t *>(values[kk].data());
                 const uint8_t *value_end = value_begin + values[kk].size();
-                writer.AddMsg(TCompressionType::None, key_begin, key_end,
-                    value_begin, value_end);
+                writer.AddMsg(TCompressionType::None, 0, key_begin,
+                    key_end, value_begin, value_end);
               }
 
               writer.CloseMsgSet();
@@ -161,8 +161,8 @@ namespace {
                 const auto *value_begin =
                     reinterpret_cast<const uint8_t *>(values[kk].data());
                 const uint8_t *value_end = value_begin + values[kk].size();
-                writer.AddMsg(TCompressionType::Gzip, key_begin, key_end,
-                    value_begin, value_end);
+                writer.AddMsg(TCompressionType::Gzip, 0, key_begin,
+                    key_end, value_begin, value_end);
               }
 
               writer.CloseMsgSet();
@@ -175,8 +175,8 @@ namespace {
                 const auto *value_begin =
                     reinterpret_cast<const uint8_t *>(values[kk].data());
                 const uint8_t *value_end = value_begin + values[kk].size();
-                writer.AddMsg(TCompressionType::Snappy, key_begin, key_end,
-                    value_begin, value_end);
+                writer.AddMsg(TCompressionType::Snappy, 0, key_begin,
+                    key_end, value_begin, value_end);
               }
 
               writer.CloseMsgSet();
@@ -189,8 +189,8 @@ namespace {
                 const auto *value_begin =
                     reinterpret_cast<const uint8_t *>(values[kk].data());
                 const uint8_t *value_end = value_begin + values[kk].size();
-                writer.AddMsg(TCompressionType::Lz4, key_begin, key_end,
-                    value_begin, value_end);
+                writer.AddMsg(TCompressionType::Lz4, 0, key_begin,
+                    key_end, value_begin, value_end);
               }
 
               writer.CloseMsgSet();
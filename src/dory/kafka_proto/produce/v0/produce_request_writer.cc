@@ -128,13 +128,24 @@ void TProduceRequestWriter::OpenMsgSet(int32_t partition) {
 }
 
 void TProduceRequestWriter::OpenMsg(TCompressionType compression_type,
-    size_t key_size, size_t value_size) {
+    int64_t timestamp, size_t key_size, size_t value_size) {
   assert(State == TState::InMsgSet);
   assert(Buf);
   assert(key_size <= static_cast<size_t>(std::numeric_limits<int32_t>::max()));
   assert(value_size <=
       static_cast<size_t>(std::numeric_limits<int32_t>::max()));
-  MsgSetWriter.OpenMsg(compression_type, key_size, value_size);
+  MsgSetWriter.OpenMsg(compression_type, timestamp, key_size, value_size);
+}
+
+void TProduceRequestWriter::OpenCompressedMsg(
+    TCompressionType compression_type, size_t /*msg_count*/,
+    int64_t first_timestamp, int64_t /*max_timestamp*/, size_t value_size) {
+  assert(compression_type != TCompressionType::None);
+
+  /* In version 0 of the protocol, a compressed message set is encapsulated
+     within a single message with an empty key, whose attributes indicate the
+     compression type. */
+  OpenMsg(compression_type, first_timestamp, 0, value_size);
 }
 
 size_t TProduceRequestWriter::GetCurrentMsgKeyOffset() const {
@@ -168,12 +179,12 @@ void TProduceRequestWriter::CloseMsg() {
 }
 
 void TProduceRequestWriter::AddMsg(TCompressionType compression_type,
-    const uint8_t *key_begin, const uint8_t *key_end,
+    int64_t timestamp, const uint8_t *key_begin, const uint8_t *key_end,
     const uint8_t *value_begin, const uint8_t *value_end) {
   assert(State == TState::InMsgSet);
   assert(Buf);
-  MsgSetWriter.AddMsg(compression_type, key_begin, key_end, value_begin,
-      value_end);
+  MsgSetWriter.AddMsg(compression_type, timestamp, key_begin, key_end,
+      value_begin, value_end);
 }
 
 void TProduceRequestWriter::CloseMsgSet() {
@@ -63,7 +63,11 @@ namespace Dory {
           void OpenMsgSet(int32_t partition) override;
 
           void OpenMsg(Compress::TCompressionType compression_type,
-              size_t key_size, size_t value_size) override;
+              int64_t timestamp, size_t key_size, size_t value_size) override;
+
+          void OpenCompressedMsg(Compress::TCompressionType compression_type,
+              size_t msg_count, int64_t first_timestamp,
+              int64_t max_timestamp, size_t value_size) override;
 
           size_t GetCurrentMsgKeyOffset() const override;
 
@@ -76,8 +80,9 @@ namespace Dory {
           void CloseMsg() override;
 
           void AddMsg(Compress::TCompressionType compression_type,
-              const uint8_t *key_begin, const uint8_t *key_end,
-              const uint8_t *value_begin, const uint8_t *value_end) override;
+              int64_t timestamp, const uint8_t *key_begin,
+              const uint8_t *key_end, const uint8_t *value_begin,
+              const uint8_t *value_end) override;
 
           void CloseMsgSet() override;
 
@@ -0,0 +1,233 @@
+/* <dory/kafka_proto/produce/v3/msg_set_reader.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/kafka_proto/produce/v3/msg_set_reader.h>.
+ */
+
+#include <dory/kafka_proto/produce/v3/msg_set_reader.h>
+
+#include <cassert>
+#include <stdexcept>
+
+#include <dory/kafka_proto/varint.h>
+
+using namespace Dory;
+using namespace Dory::Compress;
+using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::Produce;
+using namespace Dory::KafkaProto::Produce::V3;
+
+TMsgSetReader::TMsgSetReader() {
+  Clear();
+}
+
+void TMsgSetReader::Clear() {
+  Begin = nullptr;
+  End = nullptr;
+  CurrentMsg = nullptr;
+  CurrentMsgEnd = nullptr;
+  CurrentMsgTimestampDelta = 0;
+  CurrentMsgOffsetDelta = 0;
+  CurrentMsgKeyBegin = nullptr;
+  CurrentMsgKeyEnd = nullptr;
+  CurrentMsgValueBegin = nullptr;
+  CurrentMsgValueEnd = nullptr;
+}
+
+void TMsgSetReader::SetMsgSet(const void *msg_set, size_t msg_set_size) {
+  Clear();
+  Begin = reinterpret_cast<const uint8_t *>(msg_set);
+  End = Begin + msg_set_size;
+}
+
+bool TMsgSetReader::FirstMsg() {
+  assert(Begin);
+  assert(End >= Begin);
+  CurrentMsg = Begin;
+
+  if (CurrentMsg < End) {
+    InitCurrentMsg();
+    return true;
+  }
+
+  return false;
+}
+
+bool TMsgSetReader::NextMsg() {
+  assert(Begin);
+  assert(End >= Begin);
+
+  if (CurrentMsg == nullptr) {
+    return FirstMsg();
+  }
+
+  assert(CurrentMsg >= Begin);
+
+  if (CurrentMsg >= End) {
+    throw std::range_error(
+        "Invalid message location while iterating over Kafka message set");
+  }
+
+  assert(CurrentMsgEnd <= End);
+  CurrentMsg = CurrentMsgEnd;
+
+  if (CurrentMsg < End) {
+    InitCurrentMsg();
+    return true;
+  }
+
+  CurrentMsgEnd = nullptr;
+  CurrentMsgTimestampDelta = 0;
+  CurrentMsgOffsetDelta = 0;
+  CurrentMsgKeyBegin = nullptr;
+  CurrentMsgKeyEnd = nullptr;
+  CurrentMsgValueBegin = nullptr;
+  CurrentMsgValueEnd = nullptr;
+  return false;
+}
+
+bool TMsgSetReader::CurrentMsgCrcIsOk() const {
+  assert((CurrentMsg >= Begin) && (CurrentMsg < End));
+  return true;
+}
+
+TCompressionType TMsgSetReader::GetCurrentMsgCompressionType() const {
+  assert((CurrentMsg >= Begin) && (CurrentMsg < End));
+  return TCompressionType::None;
+}
+
+const uint8_t *TMsgSetReader::GetCurrentMsgKeyBegin() const {
+  assert((CurrentMsg >= Begin) && (CurrentMsg < End));
+  return CurrentMsgKeyBegin;
+}
+
+const uint8_t *TMsgSetReader::GetCurrentMsgKeyEnd() const {
+  assert((CurrentMsg >= Begin) && (CurrentMsg < End));
+  return CurrentMsgKeyEnd;
+}
+
+const uint8_t *TMsgSetReader::GetCurrentMsgValueBegin() const {
+  assert((CurrentMsg >= Begin) && (CurrentMsg < End));
+  return CurrentMsgValueBegin;
+}
+
+const uint8_t *TMsgSetReader::GetCurrentMsgValueEnd() const {
+  assert((CurrentMsg >= Begin) && (CurrentMsg < End));
+  return CurrentMsgValueEnd;
+}
+
+int64_t TMsgSetReader::GetCurrentMsgTimestampDelta() const {
+  assert((CurrentMsg >= Begin) && (CurrentMsg < End));
+  return CurrentMsgTimestampDelta;
+}
+
+int32_t TMsgSetReader::GetCurrentMsgOffsetDelta() const {
+  assert((CurrentMsg >= Begin) && (CurrentMsg < End));
+  return CurrentMsgOffsetDelta;
+}
+
+void TMsgSetReader::InitCurrentMsg() {
+  assert(Begin);
+  assert(End > Begin);
+  assert(CurrentMsg >= Begin);
+  int32_t body_size = 0;
+  size_t n = ReadVarint(CurrentMsg, End, body_size);
+
+  if (n == 0) {
+    THROW_ERROR(TMsgSetTruncated);
+  }
+
+  const uint8_t *pos = CurrentMsg + n;
+
+  if (body_size < PRC::RECORD_ATTRIBUTES_SIZE) {
+    THROW_ERROR(TBadMsgSize);
+  }
+
+  if (body_size > (End - pos)) {
+    THROW_ERROR(TMsgSetTruncated);
+  }
+
+  CurrentMsgEnd = pos + body_size;
+  pos += PRC::RECORD_ATTRIBUTES_SIZE;  // skip attributes (currently unused)
+  n = ReadVarlong(pos, CurrentMsgEnd, CurrentMsgTimestampDelta);
+
+  if (n == 0) {
+    THROW_ERROR(TBadMsgSize);
+  }
+
+  pos += n;
+  n = ReadVarint(pos, CurrentMsgEnd, CurrentMsgOffsetDelta);
+
+  if (n == 0) {
+    THROW_ERROR(TBadMsgSize);
+  }
+
+  pos += n;
+  int32_t key_size = 0;
+  n = ReadVarint(pos, CurrentMsgEnd, key_size);
+
+  if (n == 0) {
+    THROW_ERROR(TBadMsgKeySize);
+  }
+
+  pos += n;
+
+  /* A value of -1 indicates a length of 0. */
+  if (key_size == -1) {
+    key_size = 0;
+  }
+
+  if ((key_size < 0) || (key_size > (CurrentMsgEnd - pos))) {
+    THROW_ERROR(TBadMsgKeySize);
+  }
+
+  CurrentMsgKeyBegin = pos;
+  CurrentMsgKeyEnd = pos + key_size;
+  pos = CurrentMsgKeyEnd;
+  int32_t value_size = 0;
+  n = ReadVarint(pos, CurrentMsgEnd, value_size);
+
+  if (n == 0) {
+    THROW_ERROR(TBadMsgValueSize);
+  }
+
+  pos += n;
+
+  /* A value of -1 indicates a length of 0. */
+  if (value_size == -1) {
+    value_size = 0;
+  }
+
+  if ((value_size < 0) || (value_size > (CurrentMsgEnd - pos))) {
+    THROW_ERROR(TBadMsgValueSize);
+  }
+
+  CurrentMsgValueBegin = pos;
+  CurrentMsgValueEnd = pos + value_size;
+  pos = CurrentMsgValueEnd;
+
+  /* Headers are not exposed, but verify that the header count is present and
+     consistent with the record size. */
+  int32_t header_count = 0;
+  n = ReadVarint(pos, CurrentMsgEnd, header_count);
+
+  if ((n == 0) || (header_count < 0) ||
+      ((header_count == 0) && ((pos + n) != CurrentMsgEnd))) {
+    THROW_ERROR(TBadMsgHeaders);
+  }
+}
@@ -0,0 +1,295 @@
+/* <dory/kafka_proto/produce/v3/msg_set_writer.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/kafka_proto/produce/v3/msg_set_writer.h>.
+ */
+
+#include <dory/kafka_proto/produce/v3/msg_set_writer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <dory/kafka_proto/varint.h>
+
+using namespace Dory;
+using namespace Dory::Compress;
+using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::Produce::V3;
+
+TMsgSetWriter::TMsgSetWriter() {
+  Reset();
+}
+
+void TMsgSetWriter::Reset() {
+  Buf = nullptr;
+  State = TState::Idle;
+  MsgSetSize = 0;
+  FirstMsgOffset = 0;
+  MsgCount = 0;
+  FirstTimestamp = 0;
+  MaxTimestamp = 0;
+  CurrentMsgOffset = 0;
+  CurrentMsgKeyOffset = 0;
+  CurrentMsgValueOffset = 0;
+  CurrentMsgKeySize = 0;
+  CurrentMsgValueSize = 0;
+  CurrentMsgTimestamp = 0;
+}
+
+void TMsgSetWriter::OpenMsgSet(std::vector<uint8_t> &result_buf, bool append) {
+  /* Make sure we start in a sane state.  This guards against cases where an
+     exception previously thrown by this object leaves it in a bad state and we
+     later reuse it for another produce request. */
+  Reset();
+
+  assert(State == TState::Idle);
+
+  if (!append) {
+    result_buf.clear();
+  }
+
+  Buf = &result_buf;
+  FirstMsgOffset = Buf->size();
+  State = TState::InMsgSet;
+}
+
+size_t TMsgSetWriter::ComputeRecordBodySize(int64_t timestamp_delta,
+    int32_t offset_delta, size_t key_size, size_t value_size) {
+  return size_t(PRC::RECORD_ATTRIBUTES_SIZE) +
+      GetVarlongSize(timestamp_delta) + GetVarintSize(offset_delta) +
+      GetVarintSize(LenFieldValue(key_size)) + key_size +
+      GetVarintSize(LenFieldValue(value_size)) + value_size +
+      GetVarintSize(0);  // header count
+}
+
+void TMsgSetWriter::OpenMsg(TCompressionType compression_type,
+    int64_t timestamp, size_t key_size, size_t value_size) {
+  assert(State == TState::InMsgSet);
+  assert(Buf);
+  assert(compression_type == TCompressionType::None);
+  assert(key_size <= static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  assert(value_size <=
+      static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+
+  if (MsgCount == 0) {
+    FirstTimestamp = timestamp;
+  }
+
+  int64_t timestamp_delta = timestamp - FirstTimestamp;
+  auto offset_delta = static_cast<int32_t>(MsgCount);
+  size_t body_size = ComputeRecordBodySize(timestamp_delta, offset_delta,
+      key_size, value_size);
+  CurrentMsgOffset = Buf->size();
+
+  /* Allocate space for everything except the trailing header count, which
+     CloseMsg() appends.  That way the value is always at the end of the
+     buffer while the record is open. */
+  size_t msg_size = GetVarintSize(static_cast<int32_t>(body_size)) +
+      body_size - GetVarintSize(0);
+  Buf->resize(CurrentMsgOffset + msg_size);
+  uint8_t *pos = &(*Buf)[CurrentMsgOffset];
+  pos += WriteVarint(pos, static_cast<int32_t>(body_size));  // record length
+  *pos++ = 0;  // attributes (currently unused)
+  pos += WriteVarlong(pos, timestamp_delta);
+  pos += WriteVarint(pos, offset_delta);
+  pos += WriteVarint(pos, LenFieldValue(key_size));
+  CurrentMsgKeyOffset = CurrentMsgOffset + (pos - &(*Buf)[CurrentMsgOffset]);
+  pos += key_size;  // skip space for key
+  pos += WriteVarint(pos, LenFieldValue(value_size));
+  CurrentMsgValueOffset = CurrentMsgOffset +
+      (pos - &(*Buf)[CurrentMsgOffset]);
+  assert((CurrentMsgValueOffset + value_size) == Buf->size());
+  CurrentMsgKeySize = key_size;
+  CurrentMsgValueSize = value_size;
+  CurrentMsgTimestamp = timestamp;
+  State = TState::InMsg;
+}
+
+size_t TMsgSetWriter::GetCurrentMsgKeyOffset() const {
+  assert(State == TState::InMsg);
+  assert(Buf);
+  assert(CurrentMsgKeyOffset > CurrentMsgOffset);
+  return CurrentMsgKeyOffset;
+}
+
+size_t TMsgSetWriter::GetCurrentMsgValueOffset() const {
+  assert(State == TState::InMsg);
+  assert(Buf);
+  assert(CurrentMsgValueOffset > CurrentMsgOffset);
+  return CurrentMsgValueOffset;
+}
+
+void TMsgSetWriter::AdjustValueSize(size_t new_size) {
+  assert(State == TState::InMsg);
+  assert(Buf);
+  assert(new_size <= static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+
+  if (new_size == CurrentMsgValueSize) {
+    return;
+  }
+
+  /* Changing the value size may change the sizes of both the record length
+     field and the value length field, so everything between them may need to
+     shift.  The record length field is first in the record, and the value
+     length field immediately precedes the value. */
+  uint8_t *msg = &(*Buf)[CurrentMsgOffset];
+  int32_t old_body_size = 0;
+  size_t old_len_size = ReadVarint(msg, msg + MAX_VARINT_SIZE, old_body_size);
+  assert(old_len_size);
+  size_t old_value_len_size =
+      GetVarintSize(LenFieldValue(CurrentMsgValueSize));
+  size_t mid_offset = CurrentMsgOffset + old_len_size;
+  size_t mid_size = CurrentMsgValueOffset - old_value_len_size - mid_offset;
+  size_t new_body_size = static_cast<size_t>(old_body_size) -
+      old_value_len_size - CurrentMsgValueSize +
+      GetVarintSize(LenFieldValue(new_size)) + new_size;
+  size_t new_len_size = GetVarintSize(static_cast<int32_t>(new_body_size));
+  size_t new_mid_offset = CurrentMsgOffset + new_len_size;
+  size_t new_value_offset = new_mid_offset + mid_size +
+      GetVarintSize(LenFieldValue(new_size));
+  size_t preserved_value_size = std::min(CurrentMsgValueSize, new_size);
+
+  if (new_size > CurrentMsgValueSize) {
+    /* Growing: move the later region first. */
+    Buf->resize(new_value_offset + new_size);
+    std::memmove(&(*Buf)[new_value_offset], &(*Buf)[CurrentMsgValueOffset],
+        preserved_value_size);
+    std::memmove(&(*Buf)[new_mid_offset], &(*Buf)[mid_offset], mid_size);
+  } else {
+    /* Shrinking: move the earlier region first. */
+    std::memmove(&(*Buf)[new_mid_offset], &(*Buf)[mid_offset], mid_size);
+    std::memmove(&(*Buf)[new_value_offset], &(*Buf)[CurrentMsgValueOffset],
+        preserved_value_size);
+    Buf->resize(new_value_offset + new_size);
+  }
+
+  WriteVarint(&(*Buf)[CurrentMsgOffset],
+      static_cast<int32_t>(new_body_size));
+  WriteVarint(&(*Buf)[new_mid_offset + mid_size], LenFieldValue(new_size));
+  CurrentMsgKeyOffset = CurrentMsgKeyOffset - mid_offset + new_mid_offset;
+  CurrentMsgValueOffset = new_value_offset;
+  CurrentMsgValueSize = new_size;
+}
+
+void TMsgSetWriter::RollbackOpenMsg() {
+  assert(State == TState::InMsg);
+  assert(Buf);
+  assert(CurrentMsgKeyOffset > CurrentMsgOffset);
+  assert(CurrentMsgValueOffset > CurrentMsgOffset);
+  Buf->resize(CurrentMsgOffset);
+  CurrentMsgOffset = 0;
+  CurrentMsgKeyOffset = 0;
+  CurrentMsgValueOffset = 0;
+  CurrentMsgKeySize = 0;
+  CurrentMsgValueSize = 0;
+  CurrentMsgTimestamp = 0;
+  State = TState::InMsgSet;
+}
+
+void TMsgSetWriter::CloseMsg() {
+  assert(State == TState::InMsg);
+  assert(Buf);
+  assert(CurrentMsgKeyOffset > CurrentMsgOffset);
+  assert(CurrentMsgValueOffset > CurrentMsgOffset);
+  assert(Buf->size() >= CurrentMsgValueOffset);
+  assert((Buf->size() - CurrentMsgValueOffset) == CurrentMsgValueSize);
+  size_t header_count_offset = Buf->size();
+  Buf->resize(header_count_offset + GetVarintSize(0));
+  WriteVarint(&(*Buf)[header_count_offset], 0);  // header count
+  MsgSetSize += Buf->size() - CurrentMsgOffset;
+
+  if ((MsgCount == 0) || (CurrentMsgTimestamp > MaxTimestamp)) {
+    MaxTimestamp = CurrentMsgTimestamp;
+  }
+
+  CurrentMsgOffset = 0;
+  CurrentMsgKeyOffset = 0;
+  CurrentMsgValueOffset = 0;
+  CurrentMsgKeySize = 0;
+  CurrentMsgValueSize = 0;
+  CurrentMsgTimestamp = 0;
+  ++MsgCount;
+  State = TState::InMsgSet;
+}
+
+void TMsgSetWriter::AddMsg(TCompressionType compression_type,
+    int64_t timestamp, const uint8_t *key_begin, const uint8_t *key_end,
+    const uint8_t *value_begin, const uint8_t *value_end) {
+  assert(State == TState::InMsgSet);
+  assert(Buf);
+  assert(key_begin || (!key_begin && !key_end));
+  assert(key_end >= key_begin);
+  size_t key_size = key_end - key_begin;
+  assert(key_size <= static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  assert(value_begin || (!value_begin && !value_end));
+  assert(value_end >= value_begin);
+  size_t value_size = value_end - value_begin;
+  assert(value_size <=
+      static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  OpenMsg(compression_type, timestamp, key_size, value_size);
+
+  if (key_size) {
+    std::memcpy(&(*Buf)[GetCurrentMsgKeyOffset()], key_begin, key_size);
+  }
+
+  if (value_size) {
+    std::memcpy(&(*Buf)[GetCurrentMsgValueOffset()], value_begin, value_size);
+  }
+
+  CloseMsg();
+}
+
+void TMsgSetWriter::FrameMsg(size_t msg_index, int64_t first_timestamp,
+    int64_t timestamp, size_t key_size, size_t value_size,
+    TMsgFraming &framing) const {
+  assert(key_size <= static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  assert(value_size <=
+      static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  static_assert(TMsgFraming::MAX_PART_SIZE >=
+      ((3 * MAX_VARINT_SIZE) + size_t(PRC::RECORD_ATTRIBUTES_SIZE) +
+          MAX_VARLONG_SIZE),
+      "TMsgFraming::MAX_PART_SIZE is too small");
+
+  /* Same layout as written by OpenMsg() and CloseMsg(). */
+  int64_t timestamp_delta = timestamp - first_timestamp;
+  auto offset_delta = static_cast<int32_t>(msg_index);
+  size_t body_size = ComputeRecordBodySize(timestamp_delta, offset_delta,
+      key_size, value_size);
+  uint8_t *pos = framing.BeforeKey;
+  pos += WriteVarint(pos, static_cast<int32_t>(body_size));  // record length
+  *pos++ = 0;  // attributes (currently unused)
+  pos += WriteVarlong(pos, timestamp_delta);
+  pos += WriteVarint(pos, offset_delta);
+  pos += WriteVarint(pos, LenFieldValue(key_size));
+  framing.BeforeKeySize = static_cast<size_t>(pos - framing.BeforeKey);
+  framing.BeforeValueSize =
+      WriteVarint(framing.BeforeValue, LenFieldValue(value_size));
+  framing.AfterValueSize = WriteVarint(framing.AfterValue, 0);  // header count
+}
+
+size_t TMsgSetWriter::CloseMsgSet() {
+  assert(State == TState::InMsgSet);
+  assert(Buf);
+  assert(Buf->size() >= FirstMsgOffset);
+  assert(MsgSetSize == (Buf->size() - FirstMsgOffset));
+  State = TState::Idle;
+  assert(MsgSetSize <=
+      static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  return MsgSetSize;
+}
@@ -0,0 +1,164 @@
+/* <dory/kafka_proto/produce/v3/msg_set_writer.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class for writing a sequence of version 3 records (the contents of a
+   RecordBatch, minus the batch header) to a caller-supplied growable buffer of
+   type std::vector<uint8_t>.  The batch header is written by
+   TProduceRequestWriter, which uses this class internally.  When writing a
+   message set to be compressed, the output of this class is the data to
+   compress.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <dory/compress/compression_type.h>
+#include <dory/kafka_proto/produce/msg_set_writer_api.h>
+#include <dory/kafka_proto/produce/v3/produce_request_constants.h>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace Produce {
+
+      namespace V3 {
+
+        class TMsgSetWriter final : public TMsgSetWriterApi {
+          NO_COPY_SEMANTICS(TMsgSetWriter);
+
+          public:
+          TMsgSetWriter();
+
+          ~TMsgSetWriter() override = default;
+
+          void Reset() override;
+
+          void OpenMsgSet(std::vector<uint8_t> &result_buf,
+              bool append) override;
+
+          /* Records have no individual compression type, so
+             'compression_type' must be TCompressionType::None. */
+          void OpenMsg(Compress::TCompressionType compression_type,
+              int64_t timestamp, size_t key_size, size_t value_size) override;
+
+          size_t GetCurrentMsgKeyOffset() const override;
+
+          size_t GetCurrentMsgValueOffset() const override;
+
+          void AdjustValueSize(size_t new_size) override;
+
+          void RollbackOpenMsg() override;
+
+          void CloseMsg() override;
+
+          void AddMsg(Compress::TCompressionType compression_type,
+              int64_t timestamp, const uint8_t *key_begin,
+              const uint8_t *key_end, const uint8_t *value_begin,
+              const uint8_t *value_end) override;
+
+          size_t CloseMsgSet() override;
+
+          bool SupportsMsgFraming() const noexcept override {
+            return true;
+          }
+
+          void FrameMsg(size_t msg_index, int64_t first_timestamp,
+              int64_t timestamp, size_t key_size, size_t value_size,
+              TMsgFraming &framing) const override;
+
+          /* Return the number of records closed so far in the current (or
+             most recently closed) message set. */
+          size_t GetMsgCount() const noexcept {
+            return MsgCount;
+          }
+
+          /* Return the timestamp of the first record in the current (or most
+             recently closed) message set.  Record timestamps are written as
+             deltas relative to this value.  Returns -1 if the message set is
+             empty. */
+          int64_t GetFirstTimestamp() const noexcept {
+            return MsgCount ? FirstTimestamp : -1;
+          }
+
+          /* Return the maximum timestamp of all records in the current (or
+             most recently closed) message set.  Returns -1 if the message set
+             is empty. */
+          int64_t GetMaxTimestamp() const noexcept {
+            return MsgCount ? MaxTimestamp : -1;
+          }
+
+          private:
+          using PRC = TProduceRequestConstants;
+
+          enum class TState {
+            Idle,
+            InMsgSet,
+            InMsg
+          };  // TState
+
+          /* Return the size of a record body (everything after the record
+             length field), including the trailing header count. */
+          static size_t ComputeRecordBodySize(int64_t timestamp_delta,
+              int32_t offset_delta, size_t key_size, size_t value_size);
+
+          /* Return the value of the length field for a key or value of size
+             'len'.  Here, -1 indicates a length of 0. */
+          static int32_t LenFieldValue(size_t len) noexcept {
+            return static_cast<int32_t>(len ? len : -1);
+          }
+
+          std::vector<uint8_t> *Buf;
+
+          TState State;
+
+          size_t MsgSetSize;
+
+          size_t FirstMsgOffset;
+
+          size_t MsgCount;
+
+          int64_t FirstTimestamp;
+
+          int64_t MaxTimestamp;
+
+          size_t CurrentMsgOffset;
+
+          size_t CurrentMsgKeyOffset;
+
+          size_t CurrentMsgValueOffset;
+
+          size_t CurrentMsgKeySize;
+
+          size_t CurrentMsgValueSize;
+
+          int64_t CurrentMsgTimestamp;
+        };  // TMsgSetWriter
+
+      }  // V3
+
+    }  // Produce
+
+  }  // KafkaProto
+
+}  // Dory
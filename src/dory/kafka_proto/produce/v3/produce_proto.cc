@@ -0,0 +1,69 @@
+/* <dory/kafka_proto/produce/v3/produce_proto.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/kafka_proto/produce/v3/produce_proto.h>.
+ */
+
+#include <dory/kafka_proto/produce/v3/produce_proto.h>
+
+#include <dory/kafka_proto/produce/process_ack.h>
+#include <dory/kafka_proto/produce/v3/msg_set_writer.h>
+#include <dory/kafka_proto/produce/v3/produce_request_constants.h>
+#include <dory/kafka_proto/produce/v3/produce_request_writer.h>
+#include <dory/kafka_proto/produce/v3/produce_response_reader.h>
+
+using namespace Dory;
+using namespace Dory::Compress;
+using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::Produce;
+using namespace Dory::KafkaProto::Produce::V3;
+
+std::unique_ptr<TProduceRequestWriterApi>
+TProduceProto::CreateProduceRequestWriter() const {
+  return std::unique_ptr<TProduceRequestWriterApi>(
+      new TProduceRequestWriter(ApiVersion));
+}
+
+std::unique_ptr<TMsgSetWriterApi>
+TProduceProto::CreateMsgSetWriter() const {
+  return std::unique_ptr<TMsgSetWriterApi>(new TMsgSetWriter);
+}
+
+std::unique_ptr<TProduceResponseReaderApi>
+TProduceProto::CreateProduceResponseReader() const {
+  return std::unique_ptr<TProduceResponseReaderApi>(
+      new TProduceResponseReader(ApiVersion));
+}
+
+TProduceProtocol::TAckResultAction
+TProduceProto::ProcessAck(int16_t ack_value) const {
+  return ProcessProduceAck(ack_value);
+}
+
+bool TProduceProto::SupportsCompressionType(
+    TCompressionType type) const noexcept {
+  return (type != TCompressionType::Zstd) || (ApiVersion >= 7);
+}
+
+TProduceProtocol::TConstants TProduceProto::ComputeConstants() {
+  using PRC = TProduceRequestConstants;
+
+  /* Record fields are variable length, so use the worst case. */
+  return {size_t(PRC::MAX_RECORD_OVERHEAD),
+      size_t(PRC::RECORD_BATCH_HEADER_SIZE)};
+}
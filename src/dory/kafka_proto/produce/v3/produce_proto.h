@@ -0,0 +1,83 @@
+/* <dory/kafka_proto/produce/v3/produce_proto.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Kafka produce protocol version 3 implementation class.
+ */
+
+#pragma once
+
+#include <dory/kafka_proto/produce/produce_protocol.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#include <base/no_copy_semantics.h>
+#include <base/thrower.h>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace Produce {
+
+      namespace V3 {
+
+        class TProduceProto final : public TProduceProtocol {
+          NO_COPY_SEMANTICS(TProduceProto);
+
+          public:
+          /* Versions 3 through 7 share the record batch request format, so
+             this class implements all of them.  Only 3 and 7 are exposed as
+             supported versions, since 7 is the first version that permits
+             zstd compression. */
+          explicit TProduceProto(int16_t api_version = 3)
+              : TProduceProtocol(ComputeConstants()),
+                ApiVersion(api_version) {
+          }
+
+          ~TProduceProto() override = default;
+
+          std::unique_ptr<TProduceRequestWriterApi>
+          CreateProduceRequestWriter() const override;
+
+          std::unique_ptr<TMsgSetWriterApi>
+          CreateMsgSetWriter() const override;
+
+          std::unique_ptr<TProduceResponseReaderApi>
+          CreateProduceResponseReader() const override;
+
+          TAckResultAction ProcessAck(int16_t ack_value) const override;
+
+          bool SupportsCompressionType(
+              Compress::TCompressionType type) const noexcept override;
+
+          private:
+          static TConstants ComputeConstants();
+
+          const int16_t ApiVersion;
+        };  // TProduceProto
+
+      }  // V3
+
+    }  // Produce
+
+  }  // KafkaProto
+
+}  // Dory
@@ -0,0 +1,447 @@
+/* <dory/kafka_proto/produce/v3/produce_request.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/kafka_proto/produce/v3/produce_request_reader.h> and
+   <dory/kafka_proto/produce/v3/produce_request_writer.h>.
+ */
+
+#include <dory/kafka_proto/produce/v3/produce_request_reader.h>
+#include <dory/kafka_proto/produce/v3/produce_request_writer.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <base/tmp_file.h>
+#include <dory/compress/compression_type.h>
+#include <dory/kafka_proto/produce/v3/msg_set_reader.h>
+#include <dory/kafka_proto/produce/v3/msg_set_writer.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Compress;
+using namespace Dory::KafkaProto::Produce::V3;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing classes TProduceRequestReader and
+     TProduceRequestWriter. */
+  class TProduceRequestTest : public ::testing::Test {
+    protected:
+    TProduceRequestTest() = default;
+
+    ~TProduceRequestTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TProduceRequestTest
+
+  TEST_F(TProduceRequestTest, ProduceRequestTest1) {
+    std::vector<uint8_t> buf;
+    TProduceRequestWriter writer;
+    std::string client_id("client id");
+    writer.OpenRequest(buf, 1234567, client_id.data(),
+        client_id.data() + client_id.size(), 3, 100);
+    writer.CloseRequest();
+    ASSERT_EQ(buf.size(), 35U);
+    TProduceRequestReader reader;
+    reader.SetRequest(&buf[0], buf.size());
+    ASSERT_EQ(reader.GetCorrelationId(), 1234567);
+    std::string client_id_copy(reader.GetClientIdBegin(),
+        reader.GetClientIdEnd());
+    ASSERT_EQ(client_id_copy, client_id);
+    ASSERT_EQ(reader.GetRequiredAcks(), 3);
+    ASSERT_EQ(reader.GetReplicationTimeout(), 100);
+    ASSERT_EQ(reader.GetNumTopics(), 0U);
+    ASSERT_EQ(reader.FirstTopic(), false);
+  }
+
+  TEST_F(TProduceRequestTest, ProduceRequestTest2) {
+    std::vector<std::string> topics;
+    topics.emplace_back("Scooby Doo");
+    topics.emplace_back("The Flintstones");
+    topics.emplace_back("The Ramones");
+    std::vector<int32_t> partitions;
+    partitions.push_back(5);
+    partitions.push_back(10);
+    partitions.push_back(15);
+    std::vector<std::string> msgs;
+    msgs.emplace_back("Scooby dooby doo");
+    msgs.emplace_back("");
+    msgs.emplace_back("Gabba gabba hey");
+    std::vector<std::string> values;
+    values.emplace_back("Value: Scooby dooby doo");
+    values.emplace_back("Value: Yabba dabba doo");
+    values.emplace_back("");
+    std::vector<int64_t> timestamps;
+    timestamps.push_back(1500000000000);
+    timestamps.push_back(1500000000300);
+    timestamps.push_back(1499999999900);
+
+    for (size_t i = 1; i <= topics.size(); ++i) {
+      for (size_t j = 1; j <= partitions.size(); ++j) {
+        for (size_t k = 0; k <= msgs.size(); ++k) {
+          std::vector<uint8_t> buf;
+          TProduceRequestWriter writer;
+          writer.OpenRequest(buf, 1234567, nullptr, nullptr, 3, 100);
+
+          for (size_t ii = 0; ii < i; ++ii) {
+            const char *t = topics[ii].data();
+            writer.OpenTopic(t, t + topics[ii].size());
+
+            for (size_t jj = 0; jj < j; ++jj) {
+              writer.OpenMsgSet(partitions[jj]);
+
+              for (size_t kk = 0; kk < k; ++kk) {
+                const auto *key_begin =
+                    reinterpret_cast<const uint8_t *>(msgs[kk].data());
+                const uint8_t *key_end = key_begin + msgs[kk].size();
+                const auto *value_begin =
+                    reinterpret_cast<const uint8_t *>(values[kk].data());
+                const uint8_t *value_end = value_begin + values[kk].size();
+                writer.AddMsg(TCompressionType::None, timestamps[kk],
+                    key_begin, key_end, value_begin, value_end);
+              }
+
+              writer.CloseMsgSet();
+            }
+
+            writer.CloseTopic();
+          }
+
+          writer.CloseRequest();
+          TProduceRequestReader reader;
+          reader.SetRequest(&buf[0], buf.size());
+          ASSERT_EQ(reader.GetCorrelationId(), 1234567);
+          ASSERT_TRUE(reader.GetClientIdEnd() == reader.GetClientIdBegin());
+          ASSERT_EQ(reader.GetRequiredAcks(), 3);
+          ASSERT_EQ(reader.GetReplicationTimeout(), 100);
+          ASSERT_EQ(reader.GetNumTopics(), i);
+
+          for (size_t ii = 0; ii < i; ++ii) {
+            ASSERT_TRUE(reader.NextTopic());
+            std::string t(reader.GetCurrentTopicNameBegin(),
+                reader.GetCurrentTopicNameEnd());
+            ASSERT_EQ(t, topics[ii]);
+            ASSERT_EQ(reader.GetNumMsgSetsInCurrentTopic(), j);
+
+            for (size_t jj = 0; jj < j; ++jj) {
+              ASSERT_TRUE(reader.NextMsgSetInTopic());
+              ASSERT_EQ(reader.GetPartitionOfCurrentMsgSet(), partitions[jj]);
+              ASSERT_EQ(reader.GetRecordCountOfCurrentMsgSet(),
+                  static_cast<int32_t>(k));
+
+              if (k) {
+                ASSERT_EQ(reader.GetFirstTimestampOfCurrentMsgSet(),
+                    timestamps[0]);
+                ASSERT_EQ(reader.GetMaxTimestampOfCurrentMsgSet(),
+                    (k > 1) ? timestamps[1] : timestamps[0]);
+              } else {
+                ASSERT_EQ(reader.GetFirstTimestampOfCurrentMsgSet(), -1);
+                ASSERT_EQ(reader.GetMaxTimestampOfCurrentMsgSet(), -1);
+              }
+
+              for (size_t kk = 0; kk < k; ++kk) {
+                ASSERT_TRUE(reader.NextMsgInMsgSet());
+                ASSERT_TRUE(reader.CurrentMsgCrcIsOk());
+                ASSERT_EQ(reader.GetCurrentMsgCompressionType(),
+                    TCompressionType::None);
+                ASSERT_EQ(reader.GetCurrentMsgTimestamp(), timestamps[kk]);
+                std::string key(reader.GetCurrentMsgKeyBegin(),
+                    reader.GetCurrentMsgKeyEnd());
+                std::string value(reader.GetCurrentMsgValueBegin(),
+                    reader.GetCurrentMsgValueEnd());
+                ASSERT_EQ(key, msgs[kk]);
+                ASSERT_EQ(value, values[kk]);
+              }
+
+              ASSERT_FALSE(reader.NextMsgInMsgSet());
+            }
+
+            ASSERT_FALSE(reader.NextMsgSetInTopic());
+          }
+
+          ASSERT_FALSE(reader.NextTopic());
+        }
+      }
+    }
+  }
+
+  TEST_F(TProduceRequestTest, CompressedBatchTest) {
+    /* Write a set of records the way they would be written prior to
+       compression.  The test doesn't actually compress anything, since it
+       only cares about how the data is framed. */
+    std::vector<uint8_t> records;
+    TMsgSetWriter msg_set_writer;
+    msg_set_writer.OpenMsgSet(records, false);
+    std::string key_1("key 1"), value_1("value 1");
+    std::string value_2("value 2");
+    msg_set_writer.AddMsg(TCompressionType::None, 1000,
+        reinterpret_cast<const uint8_t *>(key_1.data()),
+        reinterpret_cast<const uint8_t *>(key_1.data()) + key_1.size(),
+        reinterpret_cast<const uint8_t *>(value_1.data()),
+        reinterpret_cast<const uint8_t *>(value_1.data()) + value_1.size());
+    msg_set_writer.AddMsg(TCompressionType::None, 1500, nullptr, nullptr,
+        reinterpret_cast<const uint8_t *>(value_2.data()),
+        reinterpret_cast<const uint8_t *>(value_2.data()) + value_2.size());
+    size_t records_size = msg_set_writer.CloseMsgSet();
+    ASSERT_EQ(records_size, records.size());
+    ASSERT_EQ(msg_set_writer.GetMsgCount(), 2U);
+    ASSERT_EQ(msg_set_writer.GetFirstTimestamp(), 1000);
+    ASSERT_EQ(msg_set_writer.GetMaxTimestamp(), 1500);
+
+    std::vector<uint8_t> buf;
+    TProduceRequestWriter writer;
+    writer.OpenRequest(buf, 5, nullptr, nullptr, -1, 100);
+    std::string topic("topic");
+    writer.OpenTopic(topic.data(), topic.data() + topic.size());
+    writer.OpenMsgSet(7);
+
+    /* Reserve more space than needed and then shrink it, as is done when the
+       actual compressed size is not known in advance. */
+    writer.OpenCompressedMsg(TCompressionType::Gzip, 2, 1000, 1500,
+        records.size() + 100);
+    size_t value_offset = writer.GetCurrentMsgValueOffset();
+    ASSERT_EQ(writer.GetCurrentMsgKeyOffset(), value_offset);
+    ASSERT_EQ(buf.size(), value_offset + records.size() + 100);
+    std::memcpy(&buf[value_offset], &records[0], records.size());
+    writer.AdjustValueSize(records.size());
+    writer.CloseMsg();
+    writer.CloseMsgSet();
+    writer.CloseTopic();
+    writer.CloseRequest();
+
+    TProduceRequestReader reader;
+    reader.SetRequest(&buf[0], buf.size());
+    ASSERT_EQ(reader.GetCorrelationId(), 5);
+    ASSERT_EQ(reader.GetNumTopics(), 1U);
+    ASSERT_TRUE(reader.FirstTopic());
+    ASSERT_TRUE(reader.FirstMsgSetInTopic());
+    ASSERT_EQ(reader.GetPartitionOfCurrentMsgSet(), 7);
+    ASSERT_EQ(reader.GetRecordCountOfCurrentMsgSet(), 2);
+    ASSERT_EQ(reader.GetFirstTimestampOfCurrentMsgSet(), 1000);
+    ASSERT_EQ(reader.GetMaxTimestampOfCurrentMsgSet(), 1500);
+    ASSERT_TRUE(reader.FirstMsgInMsgSet());
+    ASSERT_TRUE(reader.CurrentMsgCrcIsOk());
+    ASSERT_EQ(reader.GetCurrentMsgCompressionType(), TCompressionType::Gzip);
+    ASSERT_TRUE(reader.GetCurrentMsgKeyBegin() ==
+        reader.GetCurrentMsgKeyEnd());
+    std::vector<uint8_t> value(reader.GetCurrentMsgValueBegin(),
+        reader.GetCurrentMsgValueEnd());
+    ASSERT_EQ(value, records);
+    ASSERT_FALSE(reader.NextMsgInMsgSet());
+    ASSERT_FALSE(reader.NextMsgSetInTopic());
+    ASSERT_FALSE(reader.NextTopic());
+
+    /* Read the "decompressed" records. */
+    TMsgSetReader msg_set_reader;
+    msg_set_reader.SetMsgSet(&value[0], value.size());
+    ASSERT_TRUE(msg_set_reader.FirstMsg());
+    ASSERT_EQ(msg_set_reader.GetCurrentMsgTimestampDelta(), 0);
+    ASSERT_EQ(msg_set_reader.GetCurrentMsgOffsetDelta(), 0);
+    ASSERT_EQ(std::string(msg_set_reader.GetCurrentMsgKeyBegin(),
+        msg_set_reader.GetCurrentMsgKeyEnd()), key_1);
+    ASSERT_EQ(std::string(msg_set_reader.GetCurrentMsgValueBegin(),
+        msg_set_reader.GetCurrentMsgValueEnd()), value_1);
+    ASSERT_TRUE(msg_set_reader.NextMsg());
+    ASSERT_EQ(msg_set_reader.GetCurrentMsgTimestampDelta(), 500);
+    ASSERT_EQ(msg_set_reader.GetCurrentMsgOffsetDelta(), 1);
+    ASSERT_TRUE(msg_set_reader.GetCurrentMsgKeyBegin() ==
+        msg_set_reader.GetCurrentMsgKeyEnd());
+    ASSERT_EQ(std::string(msg_set_reader.GetCurrentMsgValueBegin(),
+        msg_set_reader.GetCurrentMsgValueEnd()), value_2);
+    ASSERT_FALSE(msg_set_reader.NextMsg());
+  }
+
+  TEST_F(TProduceRequestTest, ZstdV7Test) {
+    /* Version 7 uses the same request format as version 3, but allows zstd
+       compression. */
+    std::vector<uint8_t> records(64, 'x');
+    std::vector<uint8_t> buf;
+    TProduceRequestWriter writer(7);
+    writer.OpenRequest(buf, 9, nullptr, nullptr, -1, 100);
+    std::string topic("topic");
+    writer.OpenTopic(topic.data(), topic.data() + topic.size());
+    writer.OpenMsgSet(3);
+    writer.OpenCompressedMsg(TCompressionType::Zstd, 4, 2000, 2500,
+        records.size());
+    size_t value_offset = writer.GetCurrentMsgValueOffset();
+    std::memcpy(&buf[value_offset], &records[0], records.size());
+    writer.CloseMsg();
+    writer.CloseMsgSet();
+    writer.CloseTopic();
+    writer.CloseRequest();
+
+    /* A reader expecting version 3 rejects the request. */
+    bool threw = false;
+
+    try {
+      TProduceRequestReader v3_reader;
+      v3_reader.SetRequest(&buf[0], buf.size());
+    } catch (const TProduceRequestReader::TBadApiVersion &) {
+      threw = true;
+    }
+
+    ASSERT_TRUE(threw);
+
+    TProduceRequestReader reader(7);
+    reader.SetRequest(&buf[0], buf.size());
+    ASSERT_EQ(reader.GetCorrelationId(), 9);
+    ASSERT_TRUE(reader.FirstTopic());
+    ASSERT_TRUE(reader.FirstMsgSetInTopic());
+    ASSERT_EQ(reader.GetPartitionOfCurrentMsgSet(), 3);
+    ASSERT_EQ(reader.GetRecordCountOfCurrentMsgSet(), 4);
+    ASSERT_TRUE(reader.FirstMsgInMsgSet());
+    ASSERT_TRUE(reader.CurrentMsgCrcIsOk());
+    ASSERT_EQ(reader.GetCurrentMsgCompressionType(), TCompressionType::Zstd);
+    std::vector<uint8_t> value(reader.GetCurrentMsgValueBegin(),
+        reader.GetCurrentMsgValueEnd());
+    ASSERT_EQ(value, records);
+    ASSERT_FALSE(reader.NextMsgInMsgSet());
+  }
+
+  TEST_F(TProduceRequestTest, AdjustValueSizeTest) {
+    /* Grow and shrink values across sizes where the varint length fields
+       change size, making sure the record stays well formed. */
+    const size_t sizes[][2] = {
+      {10, 100}, {60, 70}, {10, 300}, {300, 10}, {100, 0}, {0, 20000},
+      {20000, 50}
+    };
+
+    for (const auto &s : sizes) {
+      std::vector<uint8_t> buf;
+      TMsgSetWriter writer;
+      writer.OpenMsgSet(buf, false);
+      std::string key("some key");
+      writer.OpenMsg(TCompressionType::None, 123, key.size(), s[0]);
+      std::memcpy(&buf[writer.GetCurrentMsgKeyOffset()], key.data(),
+          key.size());
+      writer.AdjustValueSize(s[1]);
+      ASSERT_EQ(buf.size(), writer.GetCurrentMsgValueOffset() + s[1]);
+      std::string value(s[1], 'x');
+
+      if (!value.empty()) {
+        std::memcpy(&buf[writer.GetCurrentMsgValueOffset()], value.data(),
+            value.size());
+      }
+
+      writer.CloseMsg();
+      ASSERT_EQ(writer.CloseMsgSet(), buf.size());
+
+      TMsgSetReader reader;
+      reader.SetMsgSet(&buf[0], buf.size());
+      ASSERT_TRUE(reader.FirstMsg());
+      ASSERT_EQ(std::string(reader.GetCurrentMsgKeyBegin(),
+          reader.GetCurrentMsgKeyEnd()), key);
+      ASSERT_EQ(std::string(reader.GetCurrentMsgValueBegin(),
+          reader.GetCurrentMsgValueEnd()), value);
+      ASSERT_FALSE(reader.NextMsg());
+    }
+  }
+
+  TEST_F(TProduceRequestTest, FrameMsgTest) {
+    /* Framed messages concatenated with their keys and values must match the
+       output of OpenMsg() and CloseMsg(). */
+    struct TItem {
+      int64_t Timestamp;
+      std::string Key;
+      std::string Value;
+    };
+    const std::vector<TItem> items = {
+      {1000, "", "first value"}, {1005, "key", ""}, {990, "", ""},
+      {2000000, "another key", std::string(300, 'v')},
+      {1001, std::string(200, 'k'), std::string(20000, 'w')}
+    };
+    std::vector<uint8_t> expected;
+    TMsgSetWriter writer;
+    ASSERT_TRUE(writer.SupportsMsgFraming());
+    writer.OpenMsgSet(expected, false);
+
+    for (const TItem &item : items) {
+      const auto *key = reinterpret_cast<const uint8_t *>(item.Key.data());
+      const auto *value = reinterpret_cast<const uint8_t *>(item.Value.data());
+      writer.AddMsg(TCompressionType::None, item.Timestamp,
+          item.Key.empty() ? nullptr : key,
+          item.Key.empty() ? nullptr : key + item.Key.size(),
+          item.Value.empty() ? nullptr : value,
+          item.Value.empty() ? nullptr : value + item.Value.size());
+    }
+
+    writer.CloseMsgSet();
+    std::vector<uint8_t> framed;
+    TMsgSetWriter::TMsgFraming framing;
+
+    for (size_t i = 0; i < items.size(); ++i) {
+      const TItem &item = items[i];
+      writer.FrameMsg(i, items[0].Timestamp, item.Timestamp, item.Key.size(),
+          item.Value.size(), framing);
+      framed.insert(framed.end(), framing.BeforeKey,
+          framing.BeforeKey + framing.BeforeKeySize);
+      framed.insert(framed.end(), item.Key.begin(), item.Key.end());
+      framed.insert(framed.end(), framing.BeforeValue,
+          framing.BeforeValue + framing.BeforeValueSize);
+      framed.insert(framed.end(), item.Value.begin(), item.Value.end());
+      framed.insert(framed.end(), framing.AfterValue,
+          framing.AfterValue + framing.AfterValueSize);
+    }
+
+    ASSERT_EQ(framed, expected);
+  }
+
+  TEST_F(TProduceRequestTest, BadCrcTest) {
+    std::vector<uint8_t> buf;
+    TProduceRequestWriter writer;
+    writer.OpenRequest(buf, 1, nullptr, nullptr, 1, 100);
+    std::string topic("topic");
+    writer.OpenTopic(topic.data(), topic.data() + topic.size());
+    writer.OpenMsgSet(0);
+    std::string value("value");
+    writer.AddMsg(TCompressionType::None, 1000, nullptr, nullptr,
+        reinterpret_cast<const uint8_t *>(value.data()),
+        reinterpret_cast<const uint8_t *>(value.data()) + value.size());
+    writer.CloseMsgSet();
+    writer.CloseTopic();
+    writer.CloseRequest();
+
+    /* Corrupt the last byte of the value, which is covered by the batch CRC.
+       The last byte of the request is the record's header count. */
+    ASSERT_EQ(buf[buf.size() - 2], 'e');
+    buf[buf.size() - 2] = 'x';
+    TProduceRequestReader reader;
+    reader.SetRequest(&buf[0], buf.size());
+    ASSERT_TRUE(reader.FirstTopic());
+    ASSERT_TRUE(reader.FirstMsgSetInTopic());
+    ASSERT_TRUE(reader.FirstMsgInMsgSet());
+    ASSERT_FALSE(reader.CurrentMsgCrcIsOk());
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,195 @@
+/* <dory/kafka_proto/produce/v3/produce_request_constants.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Constants related to Kafka produce protocol version 3 requests.  Version 3
+   is the first version that uses the RecordBatch (magic value 2) format for
+   message sets.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <dory/kafka_proto/varint.h>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace Produce {
+
+      namespace V3 {
+
+        class TProduceRequestConstants {
+          public:
+          enum { API_KEY_SIZE = 2 };
+
+          enum { API_VERSION_SIZE = 2 };
+
+          enum { CORRELATION_ID_SIZE = 4 };
+
+          enum { CLIENT_ID_LEN_SIZE = 2 };
+
+          enum { TRANSACTIONAL_ID_LEN_SIZE = 2 };
+
+          enum { REQUIRED_ACKS_SIZE = 2 };
+
+          enum { REPLICATION_TIMEOUT_SIZE = 4 };
+
+          enum { TOPIC_COUNT_SIZE = 4 };
+
+          enum { TOPIC_NAME_LEN_SIZE = 2 };
+
+          enum { PARTITION_COUNT_SIZE = 4 };
+
+          enum { PARTITION_SIZE = 4 };
+
+          enum { MSG_SET_SIZE_SIZE = 4 };
+
+          /* Fields of the record batch header, in the order they appear. */
+
+          enum { BASE_OFFSET_SIZE = 8 };
+
+          enum { BATCH_LENGTH_SIZE = 4 };
+
+          enum { PARTITION_LEADER_EPOCH_SIZE = 4 };
+
+          enum { MAGIC_BYTE_SIZE = 1 };
+
+          enum { CRC_SIZE = 4 };
+
+          enum { ATTRIBUTES_SIZE = 2 };
+
+          enum { LAST_OFFSET_DELTA_SIZE = 4 };
+
+          enum { FIRST_TIMESTAMP_SIZE = 8 };
+
+          enum { MAX_TIMESTAMP_SIZE = 8 };
+
+          enum { PRODUCER_ID_SIZE = 8 };
+
+          enum { PRODUCER_EPOCH_SIZE = 2 };
+
+          enum { BASE_SEQUENCE_SIZE = 4 };
+
+          enum { RECORD_COUNT_SIZE = 4 };
+
+          /* Offsets of record batch header fields, relative to the start of
+             the batch. */
+
+          enum { BATCH_LENGTH_OFFSET = size_t(BASE_OFFSET_SIZE) };
+
+          enum {
+            PARTITION_LEADER_EPOCH_OFFSET =
+                size_t(BATCH_LENGTH_OFFSET) + size_t(BATCH_LENGTH_SIZE)
+          };
+
+          enum {
+            MAGIC_BYTE_OFFSET = size_t(PARTITION_LEADER_EPOCH_OFFSET) +
+                size_t(PARTITION_LEADER_EPOCH_SIZE)
+          };
+
+          enum {
+            CRC_OFFSET = size_t(MAGIC_BYTE_OFFSET) + size_t(MAGIC_BYTE_SIZE)
+          };
+
+          enum { ATTRIBUTES_OFFSET = size_t(CRC_OFFSET) + size_t(CRC_SIZE) };
+
+          enum {
+            LAST_OFFSET_DELTA_OFFSET =
+                size_t(ATTRIBUTES_OFFSET) + size_t(ATTRIBUTES_SIZE)
+          };
+
+          enum {
+            FIRST_TIMESTAMP_OFFSET = size_t(LAST_OFFSET_DELTA_OFFSET) +
+                size_t(LAST_OFFSET_DELTA_SIZE)
+          };
+
+          enum {
+            MAX_TIMESTAMP_OFFSET =
+                size_t(FIRST_TIMESTAMP_OFFSET) + size_t(FIRST_TIMESTAMP_SIZE)
+          };
+
+          enum {
+            PRODUCER_ID_OFFSET =
+                size_t(MAX_TIMESTAMP_OFFSET) + size_t(MAX_TIMESTAMP_SIZE)
+          };
+
+          enum {
+            PRODUCER_EPOCH_OFFSET =
+                size_t(PRODUCER_ID_OFFSET) + size_t(PRODUCER_ID_SIZE)
+          };
+
+          enum {
+            BASE_SEQUENCE_OFFSET =
+                size_t(PRODUCER_EPOCH_OFFSET) + size_t(PRODUCER_EPOCH_SIZE)
+          };
+
+          enum {
+            RECORD_COUNT_OFFSET =
+                size_t(BASE_SEQUENCE_OFFSET) + size_t(BASE_SEQUENCE_SIZE)
+          };
+
+          enum {
+            RECORD_BATCH_HEADER_SIZE =
+                size_t(RECORD_COUNT_OFFSET) + size_t(RECORD_COUNT_SIZE)
+          };
+
+          /* The batch length field counts everything after itself. */
+          enum {
+            BATCH_LENGTH_EXCLUDED_SIZE =
+                size_t(BASE_OFFSET_SIZE) + size_t(BATCH_LENGTH_SIZE)
+          };
+
+          enum { MAGIC_VALUE = 2 };
+
+          /* Size of the attributes field of an individual record (as opposed
+             to the batch attributes above). */
+          enum { RECORD_ATTRIBUTES_SIZE = 1 };
+
+          /* Worst case number of bytes of overhead for a single record with no
+             headers: length, attributes, timestamp delta, offset delta, key
+             length, value length, and header count. */
+          enum {
+            MAX_RECORD_OVERHEAD = MAX_VARINT_SIZE +
+                size_t(RECORD_ATTRIBUTES_SIZE) + MAX_VARLONG_SIZE +
+                MAX_VARINT_SIZE + MAX_VARINT_SIZE + MAX_VARINT_SIZE + 1
+          };
+
+          /* The lower 3 bits of the batch attributes field specify the
+             compression type. */
+          enum { COMPRESSION_ATTR_MASK = 0x07 };
+
+          enum {
+            NO_COMPRESSION_ATTR = 0,
+            GZIP_COMPRESSION_ATTR = 1,
+            SNAPPY_COMPRESSION_ATTR = 2,
+            LZ4_COMPRESSION_ATTR = 3,
+
+            /* Only valid for produce API versions >= 7. */
+            ZSTD_COMPRESSION_ATTR = 4
+          };
+        };  // TProduceRequestConstants
+
+      }  // V3
+
+    }  // Produce
+
+  }  // KafkaProto
+
+}  // Dory
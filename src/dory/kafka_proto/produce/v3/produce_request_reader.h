@@ -0,0 +1,235 @@
+/* <dory/kafka_proto/produce/v3/produce_request_reader.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class for reading the contents of a version 3 produce request.  Each
+   message set is expected to contain a single RecordBatch.  If the batch is
+   compressed, it is presented as a single message with an empty key, whose
+   value is the compressed records and whose compression type is taken from
+   the batch attributes.  This mirrors how a version 0 compressed message set
+   appears, so callers can decompress the value and read the result with
+   <dory/kafka_proto/produce/v3/msg_set_reader.h>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <base/thrower.h>
+#include <dory/compress/compression_type.h>
+#include <dory/kafka_proto/produce/produce_request_reader_api.h>
+#include <dory/kafka_proto/produce/v3/msg_set_reader.h>
+#include <dory/kafka_proto/produce/v3/produce_request_constants.h>
+#include <dory/kafka_proto/request_response.h>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace Produce {
+
+      namespace V3 {
+
+        class TProduceRequestReader final : public TProduceRequestReaderApi {
+          public:
+          DEFINE_ERROR(TBadRequestSize, TBadProduceRequest,
+              "Produce request has bad size field");
+
+          DEFINE_ERROR(TRequestTruncated, TBadProduceRequest,
+              "Produce request is truncated");
+
+          DEFINE_ERROR(TBadApiKey, TBadProduceRequest,
+              "Produce request has bad API key");
+
+          DEFINE_ERROR(TBadApiVersion, TBadProduceRequest,
+              "Produce request has bad API version");
+
+          DEFINE_ERROR(TBadClientIdLen, TBadProduceRequest,
+              "Produce request has invalid client ID length");
+
+          DEFINE_ERROR(TBadTopicCount, TBadProduceRequest,
+              "Produce request has invalid topic count");
+
+          DEFINE_ERROR(TBadTopicNameLen, TBadProduceRequest,
+              "Produce request has invalid topic name length");
+
+          DEFINE_ERROR(TBadPartitionCount, TBadProduceRequest,
+              "Produce request has invalid partition count");
+
+          DEFINE_ERROR(TBadTransactionalIdLen, TBadProduceRequest,
+              "Produce request has invalid transactional ID length");
+
+          DEFINE_ERROR(TBadRecordBatch, TBadProduceRequest,
+              "Produce request has invalid record batch");
+
+          DEFINE_ERROR(TBadMagicByte, TBadProduceRequest,
+              "Produce request has record batch with bad magic byte");
+
+          DEFINE_ERROR(TUnknownCompressionType, TBadProduceRequest,
+              "Produce request has record batch with unknown compression "
+              "type");
+
+          /* 'api_version' is the version expected in the request header.
+             Later protocol versions that share the version 3 request format
+             can reuse this class by specifying their version here. */
+          explicit TProduceRequestReader(int16_t api_version = 3);
+
+          ~TProduceRequestReader() override = default;
+
+          void Clear() override;
+
+          void SetRequest(const void *request, size_t request_size) override;
+
+          int32_t GetCorrelationId() const override;
+
+          const char *GetClientIdBegin() const override;
+
+          const char *GetClientIdEnd() const override;
+
+          int16_t GetRequiredAcks() const override;
+
+          int32_t GetReplicationTimeout() const override;
+
+          size_t GetNumTopics() const override;
+
+          bool FirstTopic() override;
+
+          bool NextTopic() override;
+
+          const char *GetCurrentTopicNameBegin() const override;
+
+          const char *GetCurrentTopicNameEnd() const override;
+
+          size_t GetNumMsgSetsInCurrentTopic() const override;
+
+          bool FirstMsgSetInTopic() override;
+
+          bool NextMsgSetInTopic() override;
+
+          int32_t GetPartitionOfCurrentMsgSet() const override;
+
+          bool FirstMsgInMsgSet() override;
+
+          bool NextMsgInMsgSet() override;
+
+          bool CurrentMsgCrcIsOk() const override;
+
+          Compress::TCompressionType
+          GetCurrentMsgCompressionType() const override;
+
+          const uint8_t *GetCurrentMsgKeyBegin() const override;
+
+          const uint8_t *GetCurrentMsgKeyEnd() const override;
+
+          const uint8_t *GetCurrentMsgValueBegin() const override;
+
+          const uint8_t *GetCurrentMsgValueEnd() const override;
+
+          /* Return the record count from the current message set's batch
+             header. */
+          int32_t GetRecordCountOfCurrentMsgSet() const;
+
+          /* Return the first timestamp from the current message set's batch
+             header. */
+          int64_t GetFirstTimestampOfCurrentMsgSet() const;
+
+          /* Return the max timestamp from the current message set's batch
+             header. */
+          int64_t GetMaxTimestampOfCurrentMsgSet() const;
+
+          /* Return the timestamp of the current message.  For a compressed
+             batch, this is the first timestamp from the batch header. */
+          int64_t GetCurrentMsgTimestamp() const;
+
+          private:
+          using PRC = TProduceRequestConstants;
+
+          static size_t MinSize() {
+            return REQUEST_OR_RESPONSE_SIZE_SIZE + PRC::API_KEY_SIZE +
+                PRC::API_VERSION_SIZE + PRC::CORRELATION_ID_SIZE +
+                PRC::CLIENT_ID_LEN_SIZE + PRC::TRANSACTIONAL_ID_LEN_SIZE +
+                PRC::REQUIRED_ACKS_SIZE + PRC::REPLICATION_TIMEOUT_SIZE +
+                PRC::TOPIC_COUNT_SIZE;
+          }
+
+          void InitCurrentTopic();
+
+          void InitCurrentPartition();
+
+          const int16_t ApiVersion;
+
+          const uint8_t *Begin;
+
+          const uint8_t *End;
+
+          size_t Size;
+
+          int16_t ClientIdLen;
+
+          int16_t TransactionalIdLen;
+
+          size_t RequiredAcksOffset;
+
+          int32_t NumTopics;
+
+          int32_t CurrentTopicIndex;
+
+          const uint8_t *CurrentTopicBegin;
+
+          const uint8_t *CurrentTopicNameEnd;
+
+          int32_t NumPartitionsInTopic;
+
+          int32_t CurrentPartitionIndexInTopic;
+
+          const uint8_t *CurrentPartitionBegin;
+
+          const uint8_t *PartitionMsgSetBegin;
+
+          const uint8_t *PartitionMsgSetEnd;
+
+          /* The following are taken from the current message set's record
+             batch header. */
+
+          bool BatchCrcOk;
+
+          Compress::TCompressionType BatchCompressionType;
+
+          int32_t BatchRecordCount;
+
+          int64_t BatchFirstTimestamp;
+
+          int64_t BatchMaxTimestamp;
+
+          const uint8_t *BatchRecordsBegin;
+
+          /* For a compressed batch, this is -1 before FirstMsgInMsgSet() is
+             called, 0 while positioned at the single compressed message, and
+             1 after NextMsgInMsgSet() moves past it. */
+          int CompressedMsgIndex;
+
+          TMsgSetReader MsgSetReader;
+        };  // TProduceRequestReader
+
+      }  // V3
+
+    }  //  Produce
+
+  }  // KafkaProto
+
+}  // Dory
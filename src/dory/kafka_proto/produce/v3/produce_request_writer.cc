@@ -0,0 +1,383 @@
+/* <dory/kafka_proto/produce/v3/produce_request_writer.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/kafka_proto/produce/v3/produce_request_writer.h>.
+ */
+
+#include <dory/kafka_proto/produce/v3/produce_request_writer.h>
+
+#include <limits>
+
+#include <base/crc.h>
+#include <base/no_default_case.h>
+#include <dory/kafka_proto/request_response.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Compress;
+using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::Produce::V3;
+
+TProduceRequestWriter::TProduceRequestWriter(int16_t api_version)
+    : ApiVersion(api_version) {
+  Reset();
+}
+
+void TProduceRequestWriter::Reset() {
+  Buf = nullptr;
+  State = TState::Idle;
+  AtOffset = 0;
+  TopicCountOffset = 0;
+  FirstTopicOffset = 0;
+  CurrentTopicOffset = 0;
+  CurrentTopicPartitionCountOffset = 0;
+  TopicCount = 0;
+  FirstPartitionOffset = 0;
+  CurrentPartitionOffset = 0;
+  PartitionCount = 0;
+  CurrentBatchOffset = 0;
+  CompressionType = TCompressionType::None;
+  CompressedMsgCount = 0;
+  CompressedFirstTimestamp = 0;
+  CompressedMaxTimestamp = 0;
+  CompressedValueOffset = 0;
+  MsgSetWriter.Reset();
+}
+
+void TProduceRequestWriter::OpenRequest(std::vector<uint8_t> &result_buf,
+    int32_t corr_id, const char *client_id_begin, const char *client_id_end,
+    int16_t required_acks, int32_t replication_timeout) {
+  /* Make sure we start in a sane state. */
+  Reset();
+
+  assert(State == TState::Idle);
+  assert(client_id_begin || (!client_id_begin && !client_id_end));
+  assert(client_id_end >= client_id_begin);
+  size_t client_id_len = client_id_end - client_id_begin;
+  assert(client_id_len <=
+      static_cast<size_t>(std::numeric_limits<int16_t>::max()));
+  Buf = &result_buf;
+  assert(Buf);
+  Buf->resize(REQUEST_OR_RESPONSE_SIZE_SIZE + PRC::API_KEY_SIZE +
+      PRC::API_VERSION_SIZE + PRC::CORRELATION_ID_SIZE +
+      PRC::CLIENT_ID_LEN_SIZE + client_id_len +
+      PRC::TRANSACTIONAL_ID_LEN_SIZE + PRC::REQUIRED_ACKS_SIZE +
+      PRC::REPLICATION_TIMEOUT_SIZE + PRC::TOPIC_COUNT_SIZE);
+  AtOffset = REQUEST_OR_RESPONSE_SIZE_SIZE;  // skip produce request size field
+  WriteInt16AtOffset(0);  // API key
+  WriteInt16AtOffset(ApiVersion);  // API version
+  WriteInt32AtOffset(corr_id);  // correlation ID
+
+  /* Write client ID length.  Here, -1 indicates a length of 0. */
+  WriteInt16AtOffset(static_cast<int16_t>(client_id_len ? client_id_len : -1));
+
+  WriteDataAtOffset(client_id_begin, client_id_len);  // client ID
+
+  /* Write transactional ID length.  We are not a transactional producer, so
+     this is always null (-1). */
+  WriteInt16AtOffset(-1);
+
+  WriteInt16AtOffset(required_acks);  // required ACKs
+  WriteInt32AtOffset(replication_timeout);  // replication timeout
+  TopicCountOffset = AtOffset;
+  AtOffset += PRC::TOPIC_COUNT_SIZE;  // skip topic count field
+  State = TState::InRequest;
+}
+
+void TProduceRequestWriter::OpenTopic(const char *topic_name_begin,
+    const char *topic_name_end) {
+  assert(State == TState::InRequest);
+  assert(topic_name_begin);
+  assert(topic_name_end > topic_name_begin);
+  size_t topic_name_len = topic_name_end - topic_name_begin;
+  assert(Buf);
+  FirstPartitionOffset = 0;
+  CurrentPartitionOffset = 0;
+  PartitionCount = 0;
+  Buf->resize(Buf->size() + PRC::TOPIC_NAME_LEN_SIZE + topic_name_len +
+      PRC::PARTITION_COUNT_SIZE);  // size of partition count field
+  CurrentTopicOffset = AtOffset;
+
+  if (TopicCount == 0) {
+    FirstTopicOffset = AtOffset;
+  }
+
+  /* Here, -1 indicates a length of 0. */
+  WriteInt16AtOffset(
+      static_cast<int16_t>(topic_name_len ? topic_name_len : -1));
+
+  WriteDataAtOffset(topic_name_begin, topic_name_len);
+  CurrentTopicPartitionCountOffset = AtOffset;
+  AtOffset += PRC::PARTITION_COUNT_SIZE;  // skip partition count field;
+  State = TState::InTopic;
+}
+
+void TProduceRequestWriter::OpenMsgSet(int32_t partition) {
+  assert(State == TState::InTopic);
+  assert(Buf);
+  Buf->resize(Buf->size() + PRC::PARTITION_SIZE + PRC::MSG_SET_SIZE_SIZE +
+      PRC::RECORD_BATCH_HEADER_SIZE);
+  CurrentPartitionOffset = AtOffset;
+
+  if (PartitionCount == 0) {
+    FirstPartitionOffset = AtOffset;
+  }
+
+  WriteInt32AtOffset(partition);
+  AtOffset += PRC::MSG_SET_SIZE_SIZE;  // skip message set size field
+
+  /* The batch header is filled in by CloseMsgSet(), once we know the records
+     it contains. */
+  CurrentBatchOffset = AtOffset;
+  AtOffset += PRC::RECORD_BATCH_HEADER_SIZE;
+
+  CompressionType = TCompressionType::None;
+  CompressedMsgCount = 0;
+  CompressedFirstTimestamp = 0;
+  CompressedMaxTimestamp = 0;
+  CompressedValueOffset = 0;
+  MsgSetWriter.OpenMsgSet(*Buf, true);
+  State = TState::InMsgSet;
+}
+
+void TProduceRequestWriter::OpenMsg(TCompressionType compression_type,
+    int64_t timestamp, size_t key_size, size_t value_size) {
+  assert(State == TState::InMsgSet);
+  assert(Buf);
+  assert(key_size <= static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  assert(value_size <=
+      static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  MsgSetWriter.OpenMsg(compression_type, timestamp, key_size, value_size);
+}
+
+void TProduceRequestWriter::OpenCompressedMsg(
+    TCompressionType compression_type, size_t msg_count,
+    int64_t first_timestamp, int64_t max_timestamp, size_t value_size) {
+  assert(State == TState::InMsgSet);
+  assert(Buf);
+  assert(compression_type != TCompressionType::None);
+  assert(msg_count > 0);
+  assert(msg_count <=
+      static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  assert(value_size <=
+      static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+
+  /* A compressed record batch contains only the compressed records, so
+     nothing else may be in the message set. */
+  assert(MsgSetWriter.GetMsgCount() == 0);
+
+  CompressionType = compression_type;
+  CompressedMsgCount = msg_count;
+  CompressedFirstTimestamp = first_timestamp;
+  CompressedMaxTimestamp = max_timestamp;
+  CompressedValueOffset = Buf->size();
+  Buf->resize(CompressedValueOffset + value_size);
+  State = TState::InCompressedMsg;
+}
+
+size_t TProduceRequestWriter::GetCurrentMsgKeyOffset() const {
+  assert(Buf);
+
+  if (State == TState::InCompressedMsg) {
+    /* The compressed data has no key, so report an empty key located just
+       before the value. */
+    return CompressedValueOffset;
+  }
+
+  assert(State == TState::InMsgSet);
+  return MsgSetWriter.GetCurrentMsgKeyOffset();
+}
+
+size_t TProduceRequestWriter::GetCurrentMsgValueOffset() const {
+  assert(Buf);
+
+  if (State == TState::InCompressedMsg) {
+    return CompressedValueOffset;
+  }
+
+  assert(State == TState::InMsgSet);
+  return MsgSetWriter.GetCurrentMsgValueOffset();
+}
+
+void TProduceRequestWriter::AdjustValueSize(size_t new_size) {
+  assert(Buf);
+
+  if (State == TState::InCompressedMsg) {
+    assert(new_size <=
+        static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+    Buf->resize(CompressedValueOffset + new_size);
+    return;
+  }
+
+  assert(State == TState::InMsgSet);
+  MsgSetWriter.AdjustValueSize(new_size);
+}
+
+void TProduceRequestWriter::RollbackOpenMsg() {
+  assert(Buf);
+
+  if (State == TState::InCompressedMsg) {
+    Buf->resize(CompressedValueOffset);
+    CompressionType = TCompressionType::None;
+    CompressedMsgCount = 0;
+    CompressedFirstTimestamp = 0;
+    CompressedMaxTimestamp = 0;
+    CompressedValueOffset = 0;
+    State = TState::InMsgSet;
+    return;
+  }
+
+  assert(State == TState::InMsgSet);
+  MsgSetWriter.RollbackOpenMsg();
+}
+
+void TProduceRequestWriter::CloseMsg() {
+  assert(Buf);
+
+  if (State == TState::InCompressedMsg) {
+    State = TState::AfterCompressedMsg;
+    return;
+  }
+
+  assert(State == TState::InMsgSet);
+  MsgSetWriter.CloseMsg();
+}
+
+void TProduceRequestWriter::AddMsg(TCompressionType compression_type,
+    int64_t timestamp, const uint8_t *key_begin, const uint8_t *key_end,
+    const uint8_t *value_begin, const uint8_t *value_end) {
+  assert(State == TState::InMsgSet);
+  assert(Buf);
+  MsgSetWriter.AddMsg(compression_type, timestamp, key_begin, key_end,
+      value_begin, value_end);
+}
+
+static int16_t XlateCompressionType(TCompressionType compression_type) {
+  using PRC = TProduceRequestConstants;
+  auto attr = PRC::NO_COMPRESSION_ATTR;
+
+  switch (compression_type) {
+    case TCompressionType::None: {
+      break;
+    }
+    case TCompressionType::Gzip: {
+      attr = PRC::GZIP_COMPRESSION_ATTR;
+      break;
+    }
+    case TCompressionType::Snappy: {
+      attr = PRC::SNAPPY_COMPRESSION_ATTR;
+      break;
+    }
+    case TCompressionType::Lz4: {
+      attr = PRC::LZ4_COMPRESSION_ATTR;
+      break;
+    }
+    case TCompressionType::Zstd: {
+      attr = PRC::ZSTD_COMPRESSION_ATTR;
+      break;
+    }
+    NO_DEFAULT_CASE;
+  }
+
+  return static_cast<int16_t>(attr);
+}
+
+void TProduceRequestWriter::CloseMsgSet() {
+  assert((State == TState::InMsgSet) ||
+      (State == TState::AfterCompressedMsg));
+  assert(Buf);
+  size_t msg_count = 0;
+  int64_t first_timestamp = -1;
+  int64_t max_timestamp = -1;
+
+  if (State == TState::AfterCompressedMsg) {
+    msg_count = CompressedMsgCount;
+    first_timestamp = CompressedFirstTimestamp;
+    max_timestamp = CompressedMaxTimestamp;
+  } else {
+    MsgSetWriter.CloseMsgSet();
+    msg_count = MsgSetWriter.GetMsgCount();
+    first_timestamp = MsgSetWriter.GetFirstTimestamp();
+    max_timestamp = MsgSetWriter.GetMaxTimestamp();
+  }
+
+  assert(Buf->size() >= (CurrentBatchOffset + PRC::RECORD_BATCH_HEADER_SIZE));
+  size_t batch_size = Buf->size() - CurrentBatchOffset;
+  assert(batch_size <=
+      static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+  AtOffset = CurrentBatchOffset;
+  WriteInt64AtOffset(0);  // base offset (assigned by broker)
+  WriteInt32AtOffset(
+      static_cast<int32_t>(batch_size - PRC::BATCH_LENGTH_EXCLUDED_SIZE));
+  WriteInt32AtOffset(-1);  // partition leader epoch
+  WriteInt8AtOffset(PRC::MAGIC_VALUE);
+  size_t crc_offset = AtOffset;
+  AtOffset += PRC::CRC_SIZE;  // skip CRC field
+  WriteInt16AtOffset(XlateCompressionType(CompressionType));  // attributes
+
+  /* Last offset delta.  For an empty batch, this is -1. */
+  WriteInt32AtOffset(static_cast<int32_t>(msg_count) - 1);
+
+  WriteInt64AtOffset(first_timestamp);
+  WriteInt64AtOffset(max_timestamp);
+  WriteInt64AtOffset(-1);  // producer ID
+  WriteInt16AtOffset(-1);  // producer epoch
+  WriteInt32AtOffset(-1);  // base sequence
+  WriteInt32AtOffset(static_cast<int32_t>(msg_count));  // record count
+  assert(AtOffset == (CurrentBatchOffset + PRC::RECORD_BATCH_HEADER_SIZE));
+
+  /* The CRC covers everything from the attributes field to the end of the
+     batch. */
+  size_t crc_area_offset = CurrentBatchOffset + PRC::ATTRIBUTES_OFFSET;
+  uint32_t crc = ComputeCrc32c(&(*Buf)[crc_area_offset],
+      Buf->size() - crc_area_offset);
+  WriteInt32(crc_offset, static_cast<int32_t>(crc));
+
+  AtOffset = Buf->size();
+  WriteInt32(CurrentPartitionOffset + PRC::PARTITION_SIZE,
+      static_cast<int32_t>(batch_size));
+  ++PartitionCount;
+  State = TState::InTopic;
+}
+
+void TProduceRequestWriter::CloseTopic() {
+  assert(State == TState::InTopic);
+  assert(Buf);
+  WriteInt32(CurrentTopicPartitionCountOffset,
+      static_cast<int32_t>(PartitionCount));
+  ++TopicCount;
+  State = TState::InRequest;
+}
+
+void TProduceRequestWriter::CloseRequest() {
+  assert(State == TState::InRequest);
+  assert(Buf);
+  WriteInt32(TopicCountOffset, static_cast<int32_t>(TopicCount));
+  size_t total_request_size = Buf->size();
+  assert(total_request_size > REQUEST_OR_RESPONSE_SIZE_SIZE);
+
+  /* The request size field contains the size of the entire request minus the
+     size of the request size field itself. */
+  size_t request_size_field_value = total_request_size - 4;
+  assert(request_size_field_value <=
+      static_cast<size_t>(std::numeric_limits<int32_t>::max()));
+
+  WriteInt32(0, static_cast<int32_t>(request_size_field_value));
+  Buf = nullptr;
+  State = TState::Idle;
+}
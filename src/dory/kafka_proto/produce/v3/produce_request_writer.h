@@ -0,0 +1,213 @@
+/* <dory/kafka_proto/produce/v3/produce_request_writer.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class for writing a version 3 produce request to a caller-supplied growable
+   buffer of type std::vector<uint8_t>.  Each message set is written as a
+   single RecordBatch.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <base/field_access.h>
+#include <base/no_copy_semantics.h>
+#include <dory/compress/compression_type.h>
+#include <dory/kafka_proto/produce/produce_request_writer_api.h>
+#include <dory/kafka_proto/produce/v3/msg_set_writer.h>
+#include <dory/kafka_proto/produce/v3/produce_request_constants.h>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace Produce {
+
+      namespace V3 {
+
+        class TProduceRequestWriter final : public TProduceRequestWriterApi {
+          NO_COPY_SEMANTICS(TProduceRequestWriter);
+
+          public:
+          /* 'api_version' is the version written to the request header.
+             Later protocol versions that share the version 3 request format
+             can reuse this class by specifying their version here. */
+          explicit TProduceRequestWriter(int16_t api_version = 3);
+
+          ~TProduceRequestWriter() override = default;
+
+          void Reset() override;
+
+          void OpenRequest(std::vector<uint8_t> &result_buf, int32_t corr_id,
+              const char *client_id_begin, const char *client_id_end,
+              int16_t required_acks, int32_t replication_timeout) override;
+
+          void OpenTopic(const char *topic_name_begin,
+              const char *topic_name_end) override;
+
+          void OpenMsgSet(int32_t partition) override;
+
+          void OpenMsg(Compress::TCompressionType compression_type,
+              int64_t timestamp, size_t key_size, size_t value_size) override;
+
+          void OpenCompressedMsg(Compress::TCompressionType compression_type,
+              size_t msg_count, int64_t first_timestamp,
+              int64_t max_timestamp, size_t value_size) override;
+
+          size_t GetCurrentMsgKeyOffset() const override;
+
+          size_t GetCurrentMsgValueOffset() const override;
+
+          void AdjustValueSize(size_t new_size) override;
+
+          void RollbackOpenMsg() override;
+
+          void CloseMsg() override;
+
+          void AddMsg(Compress::TCompressionType compression_type,
+              int64_t timestamp, const uint8_t *key_begin,
+              const uint8_t *key_end, const uint8_t *value_begin,
+              const uint8_t *value_end) override;
+
+          void CloseMsgSet() override;
+
+          void CloseTopic() override;
+
+          void CloseRequest() override;
+
+          private:
+          using PRC = TProduceRequestConstants;
+
+          enum class TState {
+            Idle,
+            InRequest,
+            InTopic,
+            InMsgSet,
+            InCompressedMsg,
+            AfterCompressedMsg
+          };  // TState
+
+          void WriteInt8(size_t offset, int8_t value) {
+            assert(Buf);
+            assert(Buf->size() > offset);
+            (*Buf)[offset] = static_cast<uint8_t>(value);
+          }
+
+          void WriteInt8AtOffset(int8_t value) {
+            WriteInt8(AtOffset, value);
+            ++AtOffset;
+          }
+
+          void WriteInt16(size_t offset, int16_t value) {
+            assert(Buf);
+            assert(Buf->size() > (offset + 1));
+            WriteInt16ToHeader(&(*Buf)[offset], value);
+          }
+
+          void WriteInt16AtOffset(int16_t value) {
+            WriteInt16(AtOffset, value);
+            AtOffset += 2;
+          }
+
+          void WriteInt32(size_t offset, int32_t value) {
+            assert(Buf);
+            assert(Buf->size() > (offset + 3));
+            WriteInt32ToHeader(&(*Buf)[offset], value);
+          }
+
+          void WriteInt32AtOffset(int32_t value) {
+            WriteInt32(AtOffset, value);
+            AtOffset += 4;
+          }
+
+          void WriteInt64(size_t offset, int64_t value) {
+            assert(Buf);
+            assert(Buf->size() > (offset + 7));
+            WriteInt64ToHeader(&(*Buf)[offset], value);
+          }
+
+          void WriteInt64AtOffset(int64_t value) {
+            WriteInt64(AtOffset, value);
+            AtOffset += 8;
+          }
+
+          void WriteData(size_t offset, const void *data, size_t data_size) {
+            assert(Buf);
+            assert(Buf->size() > (offset + data_size - 1));
+            std::memcpy(&(*Buf)[offset], data, data_size);
+          }
+
+          void WriteDataAtOffset(const void *data, size_t data_size) {
+            WriteData(AtOffset, data, data_size);
+            AtOffset += data_size;
+          }
+
+          const int16_t ApiVersion;
+
+          std::vector<uint8_t> *Buf;
+
+          TState State;
+
+          size_t AtOffset;
+
+          size_t TopicCountOffset;
+
+          size_t FirstTopicOffset;
+
+          size_t CurrentTopicOffset;
+
+          size_t CurrentTopicPartitionCountOffset;
+
+          size_t TopicCount;
+
+          size_t FirstPartitionOffset;
+
+          size_t CurrentPartitionOffset;
+
+          size_t PartitionCount;
+
+          /* Offset of the current message set's record batch header. */
+          size_t CurrentBatchOffset;
+
+          /* The remaining fields are used only when the current message set
+             contains a compressed set of records. */
+
+          Compress::TCompressionType CompressionType;
+
+          size_t CompressedMsgCount;
+
+          int64_t CompressedFirstTimestamp;
+
+          int64_t CompressedMaxTimestamp;
+
+          size_t CompressedValueOffset;
+
+          TMsgSetWriter MsgSetWriter;
+        };  // TProduceRequestWriter
+
+      }  // V3
+
+    }  // Produce
+
+  }  // KafkaProto
+
+}  // Dory
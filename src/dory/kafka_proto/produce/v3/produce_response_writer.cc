@@ -0,0 +1,164 @@
+/* <dory/kafka_proto/produce/v3/produce_response_writer.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/kafka_proto/produce/v3/produce_response_writer.h>.
+ */
+
+#include <dory/kafka_proto/produce/v3/produce_response_writer.h>
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+#include <base/field_access.h>
+#include <dory/kafka_proto/request_response.h>
+
+using namespace Dory;
+using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::Produce::V3;
+
+TProduceResponseWriter::TProduceResponseWriter(int16_t api_version)
+    : BytesPerPartition(PARTITION_SIZE + ERROR_CODE_SIZE + OFFSET_SIZE +
+          LOG_APPEND_TIME_SIZE +
+          ((api_version >= 5) ? LOG_START_OFFSET_SIZE : 0)) {
+  Reset();
+}
+
+void TProduceResponseWriter::Reset() {
+  OutBuf = nullptr;
+  TopicStarted = false;
+  CurrentTopicOffset = 0;
+  CurrentTopicIndex = 0;
+  PartitionCountOffset = 0;
+  CurrentPartitionOffset = 0;
+  CurrentPartitionIndex = 0;
+}
+
+void TProduceResponseWriter::OpenResponse(std::vector<uint8_t> &out,
+    int32_t correlation_id) {
+  /* Make sure we start in a sane state. */
+  Reset();
+
+  assert(OutBuf == nullptr);
+  assert(!TopicStarted);
+  OutBuf = &out;
+  CurrentTopicOffset = REQUEST_OR_RESPONSE_SIZE_SIZE + CORRELATION_ID_SIZE +
+      TOPIC_COUNT_SIZE;
+  out.resize(CurrentTopicOffset);
+  WriteInt32ToHeader(&out[REQUEST_OR_RESPONSE_SIZE_SIZE], correlation_id);
+}
+
+void TProduceResponseWriter::OpenTopic(const char *topic_begin,
+    const char *topic_end) {
+  assert(topic_begin);
+  assert(topic_end >= topic_begin);
+  assert(OutBuf);
+  assert(!TopicStarted);
+  assert(CurrentTopicOffset >= REQUEST_OR_RESPONSE_SIZE_SIZE +
+      CORRELATION_ID_SIZE + TOPIC_COUNT_SIZE);
+  assert((topic_end - topic_begin) <=
+      static_cast<ptrdiff_t>(std::numeric_limits<int16_t>::max()));
+  std::vector<uint8_t> &out = *OutBuf;
+  auto topic_len = static_cast<int16_t>(topic_end - topic_begin);
+  out.resize(out.size() + TOPIC_NAME_LENGTH_SIZE + topic_len +
+      PARTITION_COUNT_SIZE);
+  WriteInt16ToHeader(&out[CurrentTopicOffset],
+      topic_len ? topic_len : int16_t(-1));
+  std::memcpy(&out[CurrentTopicOffset + TOPIC_NAME_LENGTH_SIZE], topic_begin,
+      static_cast<size_t>(topic_len));
+  PartitionCountOffset = CurrentTopicOffset + TOPIC_NAME_LENGTH_SIZE +
+      topic_len;
+  CurrentPartitionOffset = PartitionCountOffset + PARTITION_COUNT_SIZE;
+  CurrentPartitionIndex = 0;
+  TopicStarted = true;
+}
+
+void TProduceResponseWriter::AddPartition(int32_t partition,
+    int16_t error_code, int64_t offset) {
+  assert(partition >= 0);
+  assert(offset >= 0);
+  assert(OutBuf);
+  assert(TopicStarted);
+  assert(CurrentTopicOffset >= REQUEST_OR_RESPONSE_SIZE_SIZE +
+      CORRELATION_ID_SIZE + TOPIC_COUNT_SIZE);
+  assert(CurrentPartitionOffset > CurrentTopicOffset);
+  std::vector<uint8_t> &out = *OutBuf;
+  out.resize(out.size() + BytesPerPartition);
+  WriteInt32ToHeader(&out[CurrentPartitionOffset], partition);
+  WriteInt16ToHeader(&out[CurrentPartitionOffset + PARTITION_SIZE],
+      error_code);
+  WriteInt64ToHeader(&out[CurrentPartitionOffset + PARTITION_SIZE +
+      ERROR_CODE_SIZE], offset);
+
+  /* Log append time is -1 unless the topic is configured to use
+     LogAppendTime. */
+  WriteInt64ToHeader(&out[CurrentPartitionOffset + PARTITION_SIZE +
+      ERROR_CODE_SIZE + OFFSET_SIZE], -1);
+
+  if (BytesPerPartition > (PARTITION_SIZE + ERROR_CODE_SIZE + OFFSET_SIZE +
+      LOG_APPEND_TIME_SIZE)) {
+    /* Log start offset: we don't track this, so just report 0. */
+    WriteInt64ToHeader(&out[CurrentPartitionOffset + PARTITION_SIZE +
+        ERROR_CODE_SIZE + OFFSET_SIZE + LOG_APPEND_TIME_SIZE], 0);
+  }
+
+  CurrentPartitionOffset += BytesPerPartition;
+  ++CurrentPartitionIndex;
+}
+
+void TProduceResponseWriter::CloseTopic() {
+  assert(OutBuf);
+  assert(TopicStarted);
+  assert(CurrentTopicOffset >= REQUEST_OR_RESPONSE_SIZE_SIZE +
+      CORRELATION_ID_SIZE + TOPIC_COUNT_SIZE);
+  assert(PartitionCountOffset > CurrentTopicOffset);
+  assert(CurrentPartitionOffset >=
+      PartitionCountOffset + PARTITION_COUNT_SIZE);
+  std::vector<uint8_t> &out = *OutBuf;
+  WriteInt32ToHeader(&out[PartitionCountOffset],
+      static_cast<int32_t>(CurrentPartitionIndex));
+  CurrentTopicOffset = CurrentPartitionOffset;
+  ++CurrentTopicIndex;
+  PartitionCountOffset = 0;
+  CurrentPartitionOffset = 0;
+  CurrentPartitionIndex = 0;
+  TopicStarted = false;
+}
+
+void TProduceResponseWriter::CloseResponse() {
+  assert(OutBuf);
+  assert(!TopicStarted);
+  assert(CurrentTopicOffset >= REQUEST_OR_RESPONSE_SIZE_SIZE +
+      CORRELATION_ID_SIZE + TOPIC_COUNT_SIZE);
+  std::vector<uint8_t> &out = *OutBuf;
+  WriteInt32ToHeader(&out[REQUEST_OR_RESPONSE_SIZE_SIZE + CORRELATION_ID_SIZE],
+      static_cast<int32_t>(CurrentTopicIndex));
+  assert(out.size() == CurrentTopicOffset);
+  out.resize(out.size() + THROTTLE_TIME_SIZE);
+  WriteInt32ToHeader(&out[CurrentTopicOffset], 0);  // throttle time
+  assert(out.size() > REQUEST_OR_RESPONSE_SIZE_SIZE);
+  WriteInt32ToHeader(&out[0],
+      static_cast<int32_t>(out.size() - REQUEST_OR_RESPONSE_SIZE_SIZE));
+  TopicStarted = false;
+  CurrentTopicOffset = 0;
+  CurrentTopicIndex = 0;
+  PartitionCountOffset = 0;
+  CurrentPartitionOffset = 0;
+  CurrentPartitionIndex = 0;
+  OutBuf = nullptr;
+}
@@ -0,0 +1,106 @@
+/* <dory/kafka_proto/produce/v3/produce_response_writer.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class for creating a version 3 Kafka produce response.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <dory/kafka_proto/produce/produce_response_writer_api.h>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    namespace Produce {
+
+      namespace V3 {
+
+        class TProduceResponseWriter final : public TProduceResponseWriterApi {
+          NO_COPY_SEMANTICS(TProduceResponseWriter);
+
+          public:
+          /* Versions 5 and later add a log start offset to each partition.
+             Otherwise the response format is the same as version 3. */
+          explicit TProduceResponseWriter(int16_t api_version = 3);
+
+          void Reset() override;
+
+          void OpenResponse(std::vector<uint8_t> &out,
+              int32_t correlation_id) override;
+
+          void OpenTopic(const char *topic_begin,
+              const char *topic_end) override;
+
+          void AddPartition(int32_t partition, int16_t error_code,
+              int64_t offset) override;
+
+          void CloseTopic() override;
+
+          void CloseResponse() override;
+
+          private:
+          static const size_t CORRELATION_ID_SIZE = 4;
+
+          static const size_t TOPIC_COUNT_SIZE = 4;
+
+          static const size_t TOPIC_NAME_LENGTH_SIZE = 2;
+
+          static const size_t PARTITION_COUNT_SIZE = 4;
+
+          static const size_t PARTITION_SIZE = 4;
+
+          static const size_t ERROR_CODE_SIZE = 2;
+
+          static const size_t OFFSET_SIZE = 8;
+
+          static const size_t LOG_APPEND_TIME_SIZE = 8;
+
+          static const size_t LOG_START_OFFSET_SIZE = 8;
+
+          static const size_t THROTTLE_TIME_SIZE = 4;
+
+          const size_t BytesPerPartition;
+
+          std::vector<uint8_t> *OutBuf;
+
+          bool TopicStarted;
+
+          size_t CurrentTopicOffset;
+
+          size_t CurrentTopicIndex;
+
+          size_t PartitionCountOffset;
+
+          size_t CurrentPartitionOffset;
+
+          size_t CurrentPartitionIndex;
+        };  // TProduceResponseWriter
+
+      }  // V3
+
+    }  // Produce
+
+  }  // KafkaProto
+
+}  // Dory
@@ -25,6 +25,7 @@
 #include <algorithm>
 
 #include <dory/kafka_proto/produce/v0/produce_proto.h>
+#include <dory/kafka_proto/produce/v3/produce_proto.h>
 
 using namespace Dory;
 using namespace Dory::KafkaProto;
@@ -36,12 +37,17 @@ TProduceProtocol *Dory::KafkaProto::Produce::ChooseProduceProto(
     return new Dory::KafkaProto::Produce::V0::TProduceProto;
   }
 
+  if ((api_version == 3) || (api_version == 7)) {
+    return new Dory::KafkaProto::Produce::V3::TProduceProto(
+        static_cast<int16_t>(api_version));
+  }
+
   return nullptr;  // unsupported API version
 }
 
 const std::vector<size_t> &
 Dory::KafkaProto::Produce::GetSupportedProduceApiVersions() {
-  static const std::vector<size_t> supported_versions = { 0 };
+  static const std::vector<size_t> supported_versions = { 0, 3, 7 };
   return supported_versions;
 }
 
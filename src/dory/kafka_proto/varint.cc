@@ -0,0 +1,122 @@
+/* <dory/kafka_proto/varint.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/kafka_proto/varint.h>.
+ */
+
+#include <dory/kafka_proto/varint.h>
+
+#include <cassert>
+
+using namespace Dory;
+using namespace Dory::KafkaProto;
+
+static inline uint64_t ZigzagEncode(int64_t value) noexcept {
+  return (static_cast<uint64_t>(value) << 1) ^
+      static_cast<uint64_t>(value >> 63);
+}
+
+static inline int64_t ZigzagDecode(uint64_t value) noexcept {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+static size_t GetUnsignedSize(uint64_t value) noexcept {
+  size_t size = 1;
+
+  for (; value >= 0x80; value >>= 7) {
+    ++size;
+  }
+
+  return size;
+}
+
+static size_t WriteUnsigned(uint8_t *dst, uint64_t value) noexcept {
+  assert(dst);
+  size_t size = 0;
+
+  for (; value >= 0x80; value >>= 7) {
+    dst[size++] = static_cast<uint8_t>(value | 0x80);
+  }
+
+  dst[size++] = static_cast<uint8_t>(value);
+  return size;
+}
+
+static size_t ReadUnsigned(const uint8_t *begin, const uint8_t *end,
+    size_t max_size, uint64_t &result) noexcept {
+  assert(begin || (begin == end));
+  uint64_t value = 0;
+
+  for (size_t i = 0; i < max_size; ++i) {
+    if ((begin + i) >= end) {
+      break;  // truncated
+    }
+
+    uint8_t b = begin[i];
+    value |= static_cast<uint64_t>(b & 0x7f) << (7 * i);
+
+    if ((b & 0x80) == 0) {
+      result = value;
+      return i + 1;
+    }
+  }
+
+  return 0;
+}
+
+size_t Dory::KafkaProto::GetVarintSize(int32_t value) noexcept {
+  return GetUnsignedSize(static_cast<uint32_t>(ZigzagEncode(value)));
+}
+
+size_t Dory::KafkaProto::GetVarlongSize(int64_t value) noexcept {
+  return GetUnsignedSize(ZigzagEncode(value));
+}
+
+size_t Dory::KafkaProto::WriteVarint(uint8_t *dst, int32_t value) noexcept {
+  return WriteUnsigned(dst, static_cast<uint32_t>(ZigzagEncode(value)));
+}
+
+size_t Dory::KafkaProto::WriteVarlong(uint8_t *dst, int64_t value) noexcept {
+  return WriteUnsigned(dst, ZigzagEncode(value));
+}
+
+size_t Dory::KafkaProto::ReadVarint(const uint8_t *begin, const uint8_t *end,
+    int32_t &result) noexcept {
+  uint64_t value = 0;
+  size_t size = ReadUnsigned(begin, end, MAX_VARINT_SIZE, value);
+
+  if (size && (value <= 0xffffffff)) {
+    result = static_cast<int32_t>(ZigzagDecode(value));
+    return size;
+  }
+
+  return 0;
+}
+
+size_t Dory::KafkaProto::ReadVarlong(const uint8_t *begin, const uint8_t *end,
+    int64_t &result) noexcept {
+  uint64_t value = 0;
+  size_t size = ReadUnsigned(begin, end, MAX_VARLONG_SIZE, value);
+
+  if (size) {
+    result = ZigzagDecode(value);
+    return size;
+  }
+
+  return 0;
+}
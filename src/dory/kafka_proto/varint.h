@@ -0,0 +1,73 @@
+/* <dory/kafka_proto/varint.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Functions for reading and writing the variable length zigzag-encoded
+   integers used by newer versions of the Kafka wire format (for instance, the
+   record fields inside a RecordBatch).  The encoding is the same as that of
+   Google Protocol Buffers sint32 and sint64 values.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Dory {
+
+  namespace KafkaProto {
+
+    /* Maximum size in bytes of a serialized 32-bit varint. */
+    const size_t MAX_VARINT_SIZE = 5;
+
+    /* Maximum size in bytes of a serialized 64-bit varlong. */
+    const size_t MAX_VARLONG_SIZE = 10;
+
+    /* Return the number of bytes required to serialize 'value' as a varint. */
+    size_t GetVarintSize(int32_t value) noexcept;
+
+    /* Return the number of bytes required to serialize 'value' as a
+       varlong. */
+    size_t GetVarlongSize(int64_t value) noexcept;
+
+    /* Serialize 'value' as a varint to 'dst', which must have space for at
+       least GetVarintSize(value) bytes.  Return the number of bytes
+       written. */
+    size_t WriteVarint(uint8_t *dst, int32_t value) noexcept;
+
+    /* Serialize 'value' as a varlong to 'dst', which must have space for at
+       least GetVarlongSize(value) bytes.  Return the number of bytes
+       written. */
+    size_t WriteVarlong(uint8_t *dst, int64_t value) noexcept;
+
+    /* Read a varint from the buffer starting at 'begin' and ending at 'end'.
+       On success, store the value in 'result' and return the number of bytes
+       consumed.  Return 0 if the buffer is truncated or contains a varint that
+       is too long. */
+    size_t ReadVarint(const uint8_t *begin, const uint8_t *end,
+        int32_t &result) noexcept;
+
+    /* Read a varlong from the buffer starting at 'begin' and ending at 'end'.
+       On success, store the value in 'result' and return the number of bytes
+       consumed.  Return 0 if the buffer is truncated or contains a varlong
+       that is too long. */
+    size_t ReadVarlong(const uint8_t *begin, const uint8_t *end,
+        int64_t &result) noexcept;
+
+  }  // KafkaProto
+
+}  // Dory
@@ -0,0 +1,113 @@
+/* <dory/kafka_proto/varint.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/kafka_proto/varint.h>.
+ */
+
+#include <dory/kafka_proto/varint.h>
+
+#include <cstdint>
+#include <limits>
+
+#include <base/tmp_file.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::KafkaProto;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing varint functions. */
+  class TVarintTest : public ::testing::Test {
+    protected:
+    TVarintTest() = default;
+
+    ~TVarintTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TVarintTest
+
+  TEST_F(TVarintTest, VarintTest) {
+    const int32_t values[] = {
+      0, -1, 1, 63, -64, 64, -65, 8191, 8192, -8193,
+      std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min()
+    };
+    const size_t sizes[] = { 1, 1, 1, 1, 1, 2, 2, 2, 3, 3, 5, 5 };
+
+    for (size_t i = 0; i < (sizeof(values) / sizeof(values[0])); ++i) {
+      uint8_t buf[MAX_VARINT_SIZE];
+      ASSERT_EQ(GetVarintSize(values[i]), sizes[i]);
+      ASSERT_EQ(WriteVarint(buf, values[i]), sizes[i]);
+      int32_t result = 0;
+      ASSERT_EQ(ReadVarint(buf, buf + sizes[i], result), sizes[i]);
+      ASSERT_EQ(result, values[i]);
+
+      /* Truncated input is detected. */
+      ASSERT_EQ(ReadVarint(buf, buf + sizes[i] - 1, result), 0U);
+    }
+
+    /* Zigzag encoding: -1 is 0x01 and 1 is 0x02. */
+    uint8_t buf[MAX_VARINT_SIZE];
+    WriteVarint(buf, -1);
+    ASSERT_EQ(buf[0], 0x01);
+    WriteVarint(buf, 1);
+    ASSERT_EQ(buf[0], 0x02);
+  }
+
+  TEST_F(TVarintTest, VarlongTest) {
+    const int64_t values[] = {
+      0, -1, 1, 300, -300, 1500000000000LL,
+      std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min()
+    };
+
+    for (int64_t value : values) {
+      uint8_t buf[MAX_VARLONG_SIZE];
+      size_t size = GetVarlongSize(value);
+      ASSERT_EQ(WriteVarlong(buf, value), size);
+      int64_t result = 0;
+      ASSERT_EQ(ReadVarlong(buf, buf + size, result), size);
+      ASSERT_EQ(result, value);
+      ASSERT_EQ(ReadVarlong(buf, buf + size - 1, result), 0U);
+    }
+
+    ASSERT_EQ(GetVarlongSize(std::numeric_limits<int64_t>::min()),
+        MAX_VARLONG_SIZE);
+  }
+
+  TEST_F(TVarintTest, OverlongTest) {
+    /* Six bytes with continuation bits set is too long for a varint. */
+    const uint8_t buf[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x01 };
+    int32_t result = 0;
+    ASSERT_EQ(ReadVarint(buf, buf + sizeof(buf), result), 0U);
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
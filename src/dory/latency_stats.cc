@@ -0,0 +1,87 @@
+/* <dory/latency_stats.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/latency_stats.h>.
+ */
+
+#include <dory/latency_stats.h>
+
+#include <base/no_default_case.h>
+
+using namespace Dory;
+using namespace Dory::Util;
+
+const char *TLatencyStats::ToString(TStage stage) noexcept {
+  switch (stage) {
+    case TStage::New: {
+      return "new";
+    }
+    case TStage::Batching: {
+      return "batching";
+    }
+    case TStage::SendWait: {
+      return "send_wait";
+    }
+    case TStage::AckWait: {
+      return "ack_wait";
+    }
+    case TStage::Total: {
+      return "total";
+    }
+    NO_DEFAULT_CASE;
+  }
+
+  return "unknown";
+}
+
+TLatencyHistogram &TLatencyStats::GetBrokerRttHistogram(long broker_id) {
+  std::lock_guard<std::mutex> lock(Mutex);
+  std::unique_ptr<TLatencyHistogram> &h = BrokerRttHistograms[broker_id];
+
+  if (!h) {
+    h.reset(new TLatencyHistogram);
+  }
+
+  return *h;
+}
+
+std::vector<std::pair<TLatencyStats::TStage, TLatencySnapshot>>
+TLatencyStats::GetStageSnapshots() const {
+  std::vector<std::pair<TStage, TLatencySnapshot>> result;
+  result.reserve(STAGE_COUNT);
+
+  for (size_t i = 0; i < STAGE_COUNT; ++i) {
+    result.emplace_back(static_cast<TStage>(i),
+        StageHistograms[i].GetSnapshot());
+  }
+
+  return result;
+}
+
+std::vector<std::pair<long, TLatencySnapshot>>
+TLatencyStats::GetBrokerRttSnapshots() const {
+  std::vector<std::pair<long, TLatencySnapshot>> result;
+  std::lock_guard<std::mutex> lock(Mutex);
+  result.reserve(BrokerRttHistograms.size());
+
+  for (const auto &item : BrokerRttHistograms) {
+    result.emplace_back(item.first, item.second->GetSnapshot());
+  }
+
+  return result;
+}
@@ -0,0 +1,94 @@
+/* <dory/latency_stats.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Latency histograms for the message pipeline, for reporting by the web
+   interface.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <dory/util/latency_histogram.h>
+
+namespace Dory {
+
+  /* Keeps track of how long messages spend in each stage of processing, and
+     how long produce requests wait for ACKs from each broker.  All values are
+     in microseconds.  The router thread and connector threads record values
+     here, and Mongoose reports them. */
+  class TLatencyStats final {
+    NO_COPY_SEMANTICS(TLatencyStats);
+
+    public:
+    /* Each of the first four stages is the time a message spends in the
+       TMsg::TState of the same name.  'Total' is the time from message
+       creation until the message enters TMsg::TState::Processed, due to either
+       successful delivery or discard. */
+    enum class TStage {
+      New,
+      Batching,
+      SendWait,
+      AckWait,
+      Total
+    };  // TStage
+
+    static const size_t STAGE_COUNT = 5;
+
+    static const char *ToString(TStage stage) noexcept;
+
+    TLatencyStats() = default;
+
+    void RecordStage(TStage stage, uint64_t usec) noexcept {
+      StageHistograms[static_cast<size_t>(stage)].Record(usec);
+    }
+
+    /* Return the histogram for produce request round trip times to the broker
+       with Kafka ID 'broker_id', creating it if necessary.  The histogram
+       remains valid for the lifetime of this object.  Called by a connector
+       thread when it starts, and recorded to only by that thread. */
+    Util::TLatencyHistogram &GetBrokerRttHistogram(long broker_id);
+
+    /* Called by Mongoose thread.  Results are in TStage order. */
+    std::vector<std::pair<TStage, Util::TLatencySnapshot>>
+    GetStageSnapshots() const;
+
+    /* Called by Mongoose thread.  Results are sorted by broker ID. */
+    std::vector<std::pair<long, Util::TLatencySnapshot>>
+    GetBrokerRttSnapshots() const;
+
+    private:
+    std::array<Util::TShardedLatencyHistogram, STAGE_COUNT> StageHistograms;
+
+    /* Protects 'BrokerRttHistograms' from concurrent access.  The histograms
+       themselves need no locking. */
+    mutable std::mutex Mutex;
+
+    std::map<long, std::unique_ptr<Util::TLatencyHistogram>>
+        BrokerRttHistograms;
+  };  // TLatencyStats
+
+}  // Dory
@@ -0,0 +1,58 @@
+/* <dory/linger_stats.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/linger_stats.h>.
+ */
+
+#include <dory/linger_stats.h>
+
+#include <base/time_util.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Batch;
+
+void TLingerStats::Update(const std::string &topic,
+    std::optional<long> broker_id, const TAdaptiveLinger &linger) {
+  TTopicInfo info;
+  info.Topic = topic;
+  info.BrokerId = broker_id;
+  info.MinTimeLimit = linger.GetMinTimeLimit();
+  info.MaxTimeLimit = linger.GetMaxTimeLimit();
+  info.TargetBytes = linger.GetTargetBytes();
+  info.TimeLimit = linger.GetTimeLimit();
+  info.ByteRate = linger.GetByteRate();
+  info.AckLatency = linger.GetAckLatency();
+  info.UpdateTime = GetEpochMilliseconds();
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  TopicInfoMap[std::make_pair(topic, broker_id)] = std::move(info);
+}
+
+std::vector<TLingerStats::TTopicInfo> TLingerStats::GetTopicInfo() const {
+  std::vector<TTopicInfo> result;
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  result.reserve(TopicInfoMap.size());
+
+  for (const auto &item : TopicInfoMap) {
+    result.push_back(item.second);
+  }
+
+  return result;
+}
@@ -0,0 +1,94 @@
+/* <dory/linger_stats.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Adaptive batching time limit (linger) statistics, for reporting via the web
+   interface.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <dory/batch/adaptive_linger.h>
+
+namespace Dory {
+
+  /* Keeps track of the batching time limits chosen by adaptive linger.  The
+     router thread and connector threads record info here, and Mongoose
+     reports it, so thread synchronization is necessary. */
+  class TLingerStats final {
+    NO_COPY_SEMANTICS(TLingerStats);
+
+    public:
+    struct TTopicInfo {
+      /* Empty for a combined topics batcher. */
+      std::string Topic;
+
+      /* Kafka ID of broker whose connector thread does the batching, or empty
+         if the router thread does the batching. */
+      std::optional<long> BrokerId;
+
+      /* Configured bounds and target batch size. */
+      size_t MinTimeLimit = 0;
+
+      size_t MaxTimeLimit = 0;
+
+      size_t TargetBytes = 0;
+
+      /* Time limit currently in effect, in milliseconds. */
+      size_t TimeLimit = 0;
+
+      /* Smoothed message data arrival rate in bytes per second. */
+      double ByteRate = 0.0;
+
+      /* Most recently observed broker ACK latency in milliseconds. */
+      size_t AckLatency = 0;
+
+      /* Milliseconds since the epoch of most recent update. */
+      uint64_t UpdateTime = 0;
+    };  // TTopicInfo
+
+    TLingerStats() = default;
+
+    /* Called by a batching thread when 'linger' recomputes its time limit.
+       'topic' is empty for a combined topics batcher, and 'broker_id' is
+       empty if the caller is the router thread. */
+    void Update(const std::string &topic, std::optional<long> broker_id,
+        const Batch::TAdaptiveLinger &linger);
+
+    /* Called by Mongoose thread.  Results are sorted by topic and broker ID,
+       with router thread results before connector thread results. */
+    std::vector<TTopicInfo> GetTopicInfo() const;
+
+    private:
+    /* Protects 'TopicInfoMap' from concurrent access. */
+    mutable std::mutex Mutex;
+
+    std::map<std::pair<std::string, std::optional<long>>, TTopicInfo>
+        TopicInfoMap;
+  };  // TLingerStats
+
+}  // Dory
@@ -0,0 +1,141 @@
+/* <dory/memory_telemetry.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/memory_telemetry.h>.
+ */
+
+#include <dory/memory_telemetry.h>
+
+#include <algorithm>
+#include <iomanip>
+
+#include <base/time_util.h>
+#include <log/log.h>
+
+using namespace Base;
+using namespace Capped;
+using namespace Dory;
+using namespace Log;
+
+size_t TMemoryTelemetry::TSnapshot::GetPayloadBytes() const noexcept {
+  return static_cast<size_t>(New.Bytes + Batching.Bytes + SendWait.Bytes +
+      AckWait.Bytes);
+}
+
+size_t TMemoryTelemetry::TSnapshot::GetMsgCount() const noexcept {
+  return static_cast<size_t>(New.MsgCount + Batching.MsgCount +
+      SendWait.MsgCount + AckWait.MsgCount);
+}
+
+double TMemoryTelemetry::TSnapshot::GetUsedPercent() const noexcept {
+  return BlockCount ?
+      ((100.0 * static_cast<double>(AllocatedBlockCount)) /
+          static_cast<double>(BlockCount)) :
+      0.0;
+}
+
+double TMemoryTelemetry::TSnapshot::GetFragmentationPercent() const noexcept {
+  const size_t allocated_bytes = AllocatedBlockCount * BlockSize;
+
+  if (allocated_bytes == 0) {
+    return 0.0;
+  }
+
+  /* The counts are read at slightly different times, so the payload may
+     briefly appear larger than the allocated space. */
+  const size_t payload_bytes = std::min(GetPayloadBytes(), allocated_bytes);
+  return (100.0 * static_cast<double>(allocated_bytes - payload_bytes)) /
+      static_cast<double>(allocated_bytes);
+}
+
+TMemoryTelemetry::TMemoryTelemetry(const TPool &pool,
+    const TMsgStateTracker &msg_state_tracker)
+    : Pool(pool),
+      MsgStateTracker(msg_state_tracker),
+      RateStartTime(GetMonotonicRawMilliseconds()),
+      RateStartAllocCount(pool.GetTotalAllocCount()) {
+}
+
+TMemoryTelemetry::TSnapshot TMemoryTelemetry::GetSnapshot() const {
+  TSnapshot result;
+  result.Time = GetEpochSeconds();
+  result.BlockSize = Pool.GetBlockSize();
+  result.BlockCount = Pool.GetBlockCount();
+  result.AllocatedBlockCount = Pool.GetAllocatedBlockCount();
+  result.PeakAllocatedBlockCount = Pool.GetPeakAllocatedBlockCount();
+  result.TotalAllocCount = Pool.GetTotalAllocCount();
+  result.AllocFailureCount = Pool.GetAllocFailureCount();
+  const uint64_t now = GetMonotonicRawMilliseconds();
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    if (now > RateStartTime) {
+      result.AllocRate =
+          (1000.0 * static_cast<double>(
+              result.TotalAllocCount - RateStartAllocCount)) /
+          static_cast<double>(now - RateStartTime);
+    }
+  }
+
+  MsgStateTracker.GetStats(result.Topics, result.New.MsgCount,
+      result.New.Bytes);
+
+  for (const auto &item : result.Topics) {
+    const TMsgStateTracker::TTopicStats &stats = item.second;
+    result.Batching.MsgCount += stats.BatchingCount;
+    result.Batching.Bytes += stats.BatchingBytes;
+    result.SendWait.MsgCount += stats.SendWaitCount;
+    result.SendWait.Bytes += stats.SendWaitBytes;
+    result.AckWait.MsgCount += stats.AckWaitCount;
+    result.AckWait.Bytes += stats.AckWaitBytes;
+  }
+
+  auto topic_bytes = [](const TMsgStateTracker::TTopicStatsItem &item) {
+    return item.second.BatchingBytes + item.second.SendWaitBytes +
+        item.second.AckWaitBytes;
+  };
+  std::sort(result.Topics.begin(), result.Topics.end(),
+      [&topic_bytes](const TMsgStateTracker::TTopicStatsItem &x,
+          const TMsgStateTracker::TTopicStatsItem &y) {
+        return topic_bytes(x) > topic_bytes(y);
+      });
+  return result;
+}
+
+void TMemoryTelemetry::LogStats() {
+  const TSnapshot snapshot = GetSnapshot();
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    RateStartTime = GetMonotonicRawMilliseconds();
+    RateStartAllocCount = snapshot.TotalAllocCount;
+  }
+
+  LOG(TPri::NOTICE) << std::fixed << std::setprecision(1)
+      << "Memory: pool blocks used " << snapshot.AllocatedBlockCount << " of "
+      << snapshot.BlockCount << " (" << snapshot.GetUsedPercent()
+      << "%), peak " << snapshot.PeakAllocatedBlockCount
+      << ", message bytes " << snapshot.GetPayloadBytes()
+      << ", fragmentation " << snapshot.GetFragmentationPercent()
+      << "%, allocation rate " << snapshot.AllocRate
+      << " blocks/s, allocation failures " << snapshot.AllocFailureCount
+      << ", messages " << snapshot.GetMsgCount()
+      << ", estimated message overhead " << snapshot.GetMsgOverheadBytes()
+      << " bytes";
+}
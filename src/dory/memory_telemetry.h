@@ -0,0 +1,132 @@
+/* <dory/memory_telemetry.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class for reporting buffer pool and message memory usage.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <capped/pool.h>
+#include <dory/msg_state_tracker.h>
+
+namespace Dory {
+
+  /* Reports how much of the buffer pool is in use, and by what, so we can see
+     how close we are to discarding messages with TMemoryCapReached.  Message
+     contents are stored in pool blocks, and are broken down by message state
+     and topic using the byte counts kept by TMsgStateTracker.  Memory used by
+     TMsg objects and the lists that hold them comes from the heap rather than
+     the pool, and is estimated from the message counts.  Everything is read
+     from counters that are maintained anyway, so taking a snapshot is cheap
+     and doesn't slow down message processing. */
+  class TMemoryTelemetry final {
+    NO_COPY_SEMANTICS(TMemoryTelemetry);
+
+    public:
+    /* Estimated heap memory used by each message outside the pool: the TMsg
+       object and the std::list node that holds it. */
+    static constexpr size_t MSG_OVERHEAD_BYTES =
+        sizeof(TMsg) + (3 * sizeof(void *));
+
+    struct TStateUsage {
+      long MsgCount = 0;
+
+      /* Total key and value bytes. */
+      long Bytes = 0;
+    };  // TStateUsage
+
+    struct TSnapshot {
+      /* Seconds since the epoch. */
+      uint64_t Time = 0;
+
+      size_t BlockSize = 0;
+
+      size_t BlockCount = 0;
+
+      size_t AllocatedBlockCount = 0;
+
+      size_t PeakAllocatedBlockCount = 0;
+
+      uint64_t TotalAllocCount = 0;
+
+      uint64_t AllocFailureCount = 0;
+
+      /* Blocks allocated per second since the last call to LogStats(), or
+         since we were created if LogStats() hasn't been called. */
+      double AllocRate = 0;
+
+      TStateUsage New;
+
+      TStateUsage Batching;
+
+      TStateUsage SendWait;
+
+      TStateUsage AckWait;
+
+      /* Usage by topic for topics with messages past state New, largest
+         first. */
+      std::vector<TMsgStateTracker::TTopicStatsItem> Topics;
+
+      /* Total key and value bytes of all messages. */
+      size_t GetPayloadBytes() const noexcept;
+
+      size_t GetMsgCount() const noexcept;
+
+      /* Estimated heap memory used by messages outside the pool. */
+      size_t GetMsgOverheadBytes() const noexcept {
+        return GetMsgCount() * MSG_OVERHEAD_BYTES;
+      }
+
+      /* Percentage of pool blocks that are in use. */
+      double GetUsedPercent() const noexcept;
+
+      /* Percentage of the allocated pool bytes that don't hold message
+         contents, due to block headers and partially filled last blocks. */
+      double GetFragmentationPercent() const noexcept;
+    };  // TSnapshot
+
+    TMemoryTelemetry(const Capped::TPool &pool,
+        const TMsgStateTracker &msg_state_tracker);
+
+    TSnapshot GetSnapshot() const;
+
+    /* Write a one line summary to the log.  Called periodically. */
+    void LogStats();
+
+    private:
+    const Capped::TPool &Pool;
+
+    const TMsgStateTracker &MsgStateTracker;
+
+    /* Protects the members below. */
+    mutable std::mutex Mutex;
+
+    /* Monotonic raw time in milliseconds and pool allocation count when the
+       allocation rate was last reset. */
+    uint64_t RateStartTime;
+
+    uint64_t RateStartAllocCount;
+  };  // TMemoryTelemetry
+
+}  // Dory
@@ -0,0 +1,122 @@
+/* <dory/memory_telemetry.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/memory_telemetry.h>.
+ */
+
+#include <dory/memory_telemetry.h>
+
+#include <list>
+#include <string>
+
+#include <base/tmp_file.h>
+#include <dory/msg.h>
+#include <dory/test_util/misc_util.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::TestUtil;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TMemoryTelemetry. */
+  class TMemoryTelemetryTest : public ::testing::Test {
+    protected:
+    TMemoryTelemetryTest() = default;
+
+    ~TMemoryTelemetryTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TMemoryTelemetryTest
+
+  TEST_F(TMemoryTelemetryTest, Snapshot) {
+    TTestMsgCreator mc;
+    TMsgStateTracker &tracker = mc.MsgStateTracker;
+    TMemoryTelemetry telemetry(*mc.Pool, tracker);
+    TMemoryTelemetry::TSnapshot snapshot = telemetry.GetSnapshot();
+    ASSERT_EQ(snapshot.AllocatedBlockCount, 0U);
+    ASSERT_EQ(snapshot.GetMsgCount(), 0U);
+    ASSERT_EQ(snapshot.GetFragmentationPercent(), 0.0);
+
+    /* Pool blocks are 64 bytes, with 56 bytes of data each.  A 100 byte value
+       needs 2 blocks. */
+    const std::string value(100, 'x');
+    std::list<TMsg::TPtr> msgs1, msgs2;
+    msgs1.push_back(mc.NewMsg("topic1", value, 0));
+    msgs1.push_back(mc.NewMsg("topic1", value, 0));
+    msgs2.push_back(mc.NewMsg("topic2", value, 0));
+    TMsg::TPtr new_msg = mc.NewMsg("topic2", value, 0);
+    tracker.MsgEnterSendWait(msgs1);
+    tracker.MsgEnterSendWait(msgs2);
+    tracker.MsgEnterAckWait(msgs2);
+
+    snapshot = telemetry.GetSnapshot();
+    ASSERT_EQ(snapshot.BlockSize, 64U);
+    ASSERT_EQ(snapshot.AllocatedBlockCount, 8U);
+    ASSERT_EQ(snapshot.PeakAllocatedBlockCount, 8U);
+    ASSERT_EQ(snapshot.TotalAllocCount, 8U);
+    ASSERT_EQ(snapshot.AllocFailureCount, 0U);
+    ASSERT_EQ(snapshot.New.MsgCount, 1);
+    ASSERT_EQ(snapshot.New.Bytes, 100);
+    ASSERT_EQ(snapshot.SendWait.MsgCount, 2);
+    ASSERT_EQ(snapshot.SendWait.Bytes, 200);
+    ASSERT_EQ(snapshot.AckWait.MsgCount, 1);
+    ASSERT_EQ(snapshot.AckWait.Bytes, 100);
+    ASSERT_EQ(snapshot.GetPayloadBytes(), 400U);
+    ASSERT_EQ(snapshot.GetMsgCount(), 4U);
+    ASSERT_EQ(snapshot.GetMsgOverheadBytes(),
+        4U * TMemoryTelemetry::MSG_OVERHEAD_BYTES);
+
+    /* 512 bytes allocated, holding 400 bytes of message data. */
+    ASSERT_DOUBLE_EQ(snapshot.GetFragmentationPercent(), 21.875);
+
+    /* Largest topic first. */
+    ASSERT_EQ(snapshot.Topics.size(), 2U);
+    ASSERT_EQ(snapshot.Topics[0].first, "topic1");
+    ASSERT_EQ(snapshot.Topics[1].first, "topic2");
+
+    telemetry.LogStats();
+    tracker.MsgEnterProcessed(msgs1);
+    tracker.MsgEnterProcessed(msgs2);
+    tracker.MsgEnterProcessed(*new_msg);
+    msgs1.clear();
+    msgs2.clear();
+    new_msg.reset();
+
+    snapshot = telemetry.GetSnapshot();
+    ASSERT_EQ(snapshot.AllocatedBlockCount, 0U);
+    ASSERT_EQ(snapshot.PeakAllocatedBlockCount, 8U);
+    ASSERT_EQ(snapshot.GetMsgCount(), 0U);
+    ASSERT_TRUE(snapshot.Topics.empty());
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
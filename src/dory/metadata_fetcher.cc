@@ -23,6 +23,7 @@
 
 #include <cassert>
 #include <cstddef>
+#include <optional>
 #include <system_error>
 
 #include <poll.h>
@@ -34,8 +35,11 @@
 #include <base/system_error_codes.h>
 #include <base/time_util.h>
 #include <base/wr/fd_util.h>
+#include <dory/kafka_proto/api_versions/api_versions.h>
+#include <dory/kafka_proto/metadata/version_util.h>
 #include <dory/kafka_proto/request_response.h>
 #include <dory/util/connect_to_host.h>
+#include <dory/util/get_broker_api_versions.h>
 #include <dory/util/poll_array.h>
 #include <log/log.h>
 #include <socket/db/error.h>
@@ -43,6 +47,7 @@
 using namespace Base;
 using namespace Dory;
 using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::ApiVersions;
 using namespace Dory::KafkaProto::Metadata;
 using namespace Dory::Util;
 using namespace Log;
@@ -51,6 +56,7 @@ DEFINE_COUNTER(BadMetadataResponse);
 DEFINE_COUNTER(BadMetadataResponseSize);
 DEFINE_COUNTER(MetadataHasEmptyBrokerList);
 DEFINE_COUNTER(MetadataHasEmptyTopicList);
+DEFINE_COUNTER(MetadataNoCommonApiVersion);
 DEFINE_COUNTER(MetadataResponseReadLostTcpConnection);
 DEFINE_COUNTER(MetadataResponseReadSuccess);
 DEFINE_COUNTER(MetadataResponseReadTimeout);
@@ -68,14 +74,21 @@ CreateMetadataRequest(const TMetadataProtocol &metadata_protocol) {
   return result;
 }
 
-TMetadataFetcher::TMetadataFetcher(const TMetadataProtocol *metadata_protocol)
-    : MetadataProtocol(metadata_protocol),
-      MetadataRequest(CreateMetadataRequest(*metadata_protocol)),
+TMetadataFetcher::TMetadataFetcher(size_t metadata_api_version,
+    TApiVersionStats &api_version_stats, bool api_version_request,
+    int api_versions_timeout_ms)
+    : ApiVersionStats(api_version_stats),
+      ApiVersionRequest(api_version_request),
+      ApiVersionsTimeout(api_versions_timeout_ms),
+      MetadataApiVersion(metadata_api_version),
+      MetadataProtocol(ChooseMetadataProto(metadata_api_version)),
       /* Note: The max message body size value is a loose upper bound to guard
          against a response with a ridiculously large size field. */
       StreamReader(false, true, 4 * 1024 * 1024, 64 * 1024) {
   static_assert(sizeof(TStreamReaderType::TSizeFieldType) ==
       REQUEST_OR_RESPONSE_SIZE_SIZE, "Wrong size field size for StreamReader");
+  assert(MetadataProtocol);
+  MetadataRequest = CreateMetadataRequest(*MetadataProtocol);
 }
 
 bool TMetadataFetcher::Connect(const char *host_name, in_port_t port) {
@@ -99,6 +112,11 @@ bool TMetadataFetcher::Connect(const char *host_name, in_port_t port) {
     return false;
   }
 
+  if (!NegotiateApiVersion(host_name, port)) {
+    Disconnect();
+    return false;
+  }
+
   StreamReader.Reset(Sock);
   return true;
 }
@@ -204,6 +222,49 @@ TMetadataFetcher::TopicAutocreate(const char *topic, int timeout_ms) {
                    TTopicAutocreateResult::Fail;
 }
 
+bool TMetadataFetcher::NegotiateApiVersion(const char *host_name,
+    in_port_t port) {
+  if (!ApiVersionRequest) {
+    ApiVersionStats.RecordMetadataApiVersion(host_name, port, {},
+        MetadataApiVersion);
+    return true;
+  }
+
+  auto broker_versions = GetBrokerApiVersions(Sock, ApiVersionsTimeout);
+
+  if (!broker_versions) {
+    LOG(TPri::ERR) << "Failed to get API versions from host " << host_name
+        << " port " << port << " for metadata";
+    return false;
+  }
+
+  std::optional<size_t> version = ChooseHighestCommonVersion(
+      GetSupportedMetadataApiVersions(), *broker_versions, METADATA_API_KEY);
+
+  if (!version) {
+    MetadataNoCommonApiVersion.Increment();
+    LOG(TPri::ERR) << "Host " << host_name << " port " << port
+        << " supports no metadata API version that dory supports";
+    return false;
+  }
+
+  SetMetadataApiVersion(*version);
+  ApiVersionStats.RecordMetadataApiVersion(host_name, port, *broker_versions,
+      *version);
+  return true;
+}
+
+void TMetadataFetcher::SetMetadataApiVersion(size_t api_version) {
+  if (api_version != MetadataApiVersion) {
+    LOG(TPri::NOTICE) << "Switching from metadata API version "
+        << MetadataApiVersion << " to " << api_version;
+    MetadataProtocol = ChooseMetadataProto(api_version);
+    assert(MetadataProtocol);
+    MetadataRequest = CreateMetadataRequest(*MetadataProtocol);
+    MetadataApiVersion = api_version;
+  }
+}
+
 bool TMetadataFetcher::SendRequest(const std::vector<uint8_t> &request,
     int timeout_ms) {
   StartSendMetadataRequest.Increment();
@@ -31,6 +31,7 @@
 #include <base/fd.h>
 #include <base/no_copy_semantics.h>
 #include <base/stream_msg_with_size_reader.h>
+#include <dory/api_version_stats.h>
 #include <dory/kafka_proto/metadata/metadata_protocol.h>
 #include <dory/metadata.h>
 
@@ -56,10 +57,19 @@ namespace Dory {
       TMetadataFetcher &Fetcher;
     };  // TDisconnecter
 
-    explicit TMetadataFetcher(
-        const KafkaProto::Metadata::TMetadataProtocol *metadata_protocol);
-
-    /* Return true on success or false on failure. */
+    /* 'metadata_api_version' gives the metadata API version to use.  If
+       'api_version_request' is true, then Connect() sends an ApiVersions
+       request to the broker, and switches to the highest metadata API version
+       supported by both dory and the broker.  'api_versions_timeout_ms' gives
+       the timeout in milliseconds for the ApiVersions request.  Either way,
+       the metadata API version used for each broker is recorded in
+       'api_version_stats'. */
+    TMetadataFetcher(size_t metadata_api_version,
+        TApiVersionStats &api_version_stats, bool api_version_request,
+        int api_versions_timeout_ms);
+
+    /* Return true on success or false on failure.  Failure to negotiate a
+       metadata API version counts as failure. */
     bool Connect(const char *host_name, in_port_t port);
 
     /* Return true on success or false on failure. */
@@ -95,18 +105,29 @@ namespace Dory {
     TTopicAutocreateResult TopicAutocreate(const char *topic, int timeout_ms);
 
     private:
+    bool NegotiateApiVersion(const char *host_name, in_port_t port);
+
+    void SetMetadataApiVersion(size_t api_version);
+
     bool SendRequest(const std::vector<uint8_t> &request, int timeout_ms);
 
     bool ReadResponse(int timeout_ms);
 
-    const std::unique_ptr<const KafkaProto::Metadata::TMetadataProtocol>
+    TApiVersionStats &ApiVersionStats;
+
+    const bool ApiVersionRequest;
+
+    const int ApiVersionsTimeout;
+
+    size_t MetadataApiVersion;
+
+    std::unique_ptr<const KafkaProto::Metadata::TMetadataProtocol>
         MetadataProtocol;
 
     /* This is the all topics metadata request that we send to a broker.  It is
        always the same sequence of bytes (since we always use a correlation ID
-       of 0), so we may as well make it a constant and initialize it in the
-       constructor. */
-    const std::vector<uint8_t> MetadataRequest;
+       of 0), so we create it once for the metadata API version in use. */
+    std::vector<uint8_t> MetadataRequest;
 
     Base::TFd Sock;
 
@@ -0,0 +1,365 @@
+/* <dory/metrics_renderer.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/metrics_renderer.h>.
+ */
+
+#include <dory/metrics_renderer.h>
+
+#include <charconv>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+#include <base/counter.h>
+#include <base/piece.h>
+#include <dory/build_id.h>
+#include <server/url_decode.h>
+
+using namespace Base;
+using namespace Capped;
+using namespace Dory;
+using namespace Server;
+
+void TMetricsRenderer::TTopicFilter::Parse(const char *query_string) {
+  Topics.clear();
+  Prefixes.clear();
+
+  if (query_string == nullptr) {
+    return;
+  }
+
+  std::string value;
+
+  for (const char *pos = query_string; *pos; ) {
+    const char *end = std::strchr(pos, '&');
+
+    if (end == nullptr) {
+      end = pos + std::strlen(pos);
+    }
+
+    const char *eq = static_cast<const char *>(
+        std::memchr(pos, '=', static_cast<size_t>(end - pos)));
+
+    if (end != pos) {
+      if (eq == nullptr) {
+        THROW_ERROR(TBadMetricsQuery) << "Parameter has no value: "
+            << std::string(pos, end);
+      }
+
+      const std::string name(pos, eq);
+      UrlDecode(TPiece<const char>(eq + 1, end), value);
+
+      if (name == "topic") {
+        Topics.push_back(value);
+      } else if (name == "topic_prefix") {
+        Prefixes.push_back(value);
+      } else {
+        THROW_ERROR(TBadMetricsQuery) << "Unknown parameter: " << name;
+      }
+    }
+
+    pos = *end ? (end + 1) : end;
+  }
+}
+
+bool TMetricsRenderer::TTopicFilter::Matches(
+    const std::string &topic) const noexcept {
+  if (Topics.empty() && Prefixes.empty()) {
+    return true;
+  }
+
+  for (const std::string &t : Topics) {
+    if (topic == t) {
+      return true;
+    }
+  }
+
+  for (const std::string &p : Prefixes) {
+    if (!topic.compare(0, p.size(), p)) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+TMetricsRenderer::TMetricsRenderer(const TMsgStateTracker &msg_state_tracker,
+    const TAnomalyTracker &anomaly_tracker, const TPool &pool)
+    : MsgStateTracker(msg_state_tracker),
+      AnomalyTracker(anomaly_tracker),
+      Pool(pool) {
+}
+
+const std::string &TMetricsRenderer::Render(const char *query_string) {
+  TopicFilter.Parse(query_string);
+  Buf.clear();
+  WriteHelp("dory_info", "gauge", "Always 1, labeled with the version");
+  WriteSample("dory_info", "version", dory_build_id, 1);
+  /* Clients can't reset the counters, so the counter reset time is when dory
+     started. */
+  WriteHelp("dory_start_time_seconds", "gauge",
+      "Time when dory started, in seconds since the epoch");
+  WriteSample("dory_start_time_seconds",
+      static_cast<uint64_t>(TCounter::GetResetTime()));
+  WriteCounters();
+  WriteQueueStats();
+  WritePoolStats();
+  WriteDiscardStats();
+  return Buf;
+}
+
+void TMetricsRenderer::WriteHelp(const char *name, const char *type,
+    const char *help) {
+  Buf += "# HELP ";
+  Buf += name;
+  Buf += ' ';
+  Buf += help;
+  Buf += "\n# TYPE ";
+  Buf += name;
+  Buf += ' ';
+  Buf += type;
+  Buf += '\n';
+}
+
+void TMetricsRenderer::WriteSample(const char *name, uint64_t value) {
+  Buf += name;
+  Buf += ' ';
+  WriteValue(value);
+}
+
+void TMetricsRenderer::WriteSample(const char *name, const char *label_name,
+    const std::string &label_value, uint64_t value) {
+  Buf += name;
+  Buf += '{';
+  Buf += label_name;
+  Buf += "=\"";
+  WriteLabelValue(label_value);
+  Buf += "\"} ";
+  WriteValue(value);
+}
+
+void TMetricsRenderer::WriteSample(const char *name,
+    const char *label1_name, const std::string &label1_value,
+    const char *label2_name, const char *label2_value, int64_t value) {
+  Buf += name;
+  Buf += '{';
+  Buf += label1_name;
+  Buf += "=\"";
+  WriteLabelValue(label1_value);
+  Buf += "\",";
+  Buf += label2_name;
+  Buf += "=\"";
+  Buf += label2_value;
+  Buf += "\"} ";
+  WriteValue(value);
+}
+
+void TMetricsRenderer::WriteLabelValue(const std::string &value) {
+  for (char c : value) {
+    switch (c) {
+      case '\\': {
+        Buf += "\\\\";
+        break;
+      }
+      case '"': {
+        Buf += "\\\"";
+        break;
+      }
+      case '\n': {
+        Buf += "\\n";
+        break;
+      }
+      default: {
+        Buf += c;
+        break;
+      }
+    }
+  }
+}
+
+void TMetricsRenderer::WriteValue(int64_t value) {
+  char tmp[24];
+  const std::to_chars_result result =
+      std::to_chars(tmp, tmp + sizeof(tmp), value);
+  Buf.append(tmp, result.ptr);
+  Buf += '\n';
+}
+
+void TMetricsRenderer::WriteValue(uint64_t value) {
+  char tmp[24];
+  const std::to_chars_result result =
+      std::to_chars(tmp, tmp + sizeof(tmp), value);
+  Buf.append(tmp, result.ptr);
+  Buf += '\n';
+}
+
+void TMetricsRenderer::WriteCounters() {
+  TCounter::Sample();
+  WriteHelp("dory_counter_total", "counter",
+      "Dory's internal counters, as reported by /counters/json");
+
+  for (const TCounter *counter = TCounter::GetFirstCounter();
+       counter != nullptr;
+       counter = counter->GetNextCounter()) {
+    Buf += "dory_counter_total{name=\"";
+    Buf += counter->GetName();
+    Buf += "\"} ";
+    WriteValue(counter->GetCount());
+  }
+}
+
+void TMetricsRenderer::WriteQueueStats() {
+  long new_count = 0;
+  long new_bytes = 0;
+  MsgStateTracker.GetStats(TopicStats, new_count, new_bytes);
+  WriteHelp("dory_new_msgs", "gauge",
+      "Messages not yet batched or routed to a broker");
+  WriteSample("dory_new_msgs",
+      static_cast<uint64_t>((new_count < 0) ? 0 : new_count));
+  WriteHelp("dory_new_msg_bytes", "gauge",
+      "Key and value bytes of messages not yet batched or routed to a broker");
+  WriteSample("dory_new_msg_bytes",
+      static_cast<uint64_t>((new_bytes < 0) ? 0 : new_bytes));
+  WriteHelp("dory_queued_msgs", "gauge",
+      "Messages being batched, waiting to be sent, or waiting for an ACK");
+
+  for (const auto &item : TopicStats) {
+    if (TopicFilter.Matches(item.first)) {
+      WriteSample("dory_queued_msgs", "topic", item.first, "state",
+          "batching", item.second.BatchingCount);
+      WriteSample("dory_queued_msgs", "topic", item.first, "state",
+          "send_wait", item.second.SendWaitCount);
+      WriteSample("dory_queued_msgs", "topic", item.first, "state",
+          "ack_wait", item.second.AckWaitCount);
+    }
+  }
+
+  WriteHelp("dory_queued_msg_bytes", "gauge",
+      "Key and value bytes of messages in dory_queued_msgs");
+
+  for (const auto &item : TopicStats) {
+    if (TopicFilter.Matches(item.first)) {
+      WriteSample("dory_queued_msg_bytes", "topic", item.first, "state",
+          "batching", item.second.BatchingBytes);
+      WriteSample("dory_queued_msg_bytes", "topic", item.first, "state",
+          "send_wait", item.second.SendWaitBytes);
+      WriteSample("dory_queued_msg_bytes", "topic", item.first, "state",
+          "ack_wait", item.second.AckWaitBytes);
+    }
+  }
+}
+
+void TMetricsRenderer::WritePoolStats() {
+  WriteHelp("dory_pool_block_size_bytes", "gauge",
+      "Size of each message buffer pool block");
+  WriteSample("dory_pool_block_size_bytes", Pool.GetBlockSize());
+  WriteHelp("dory_pool_blocks", "gauge",
+      "Number of message buffer pool blocks");
+  WriteSample("dory_pool_blocks", Pool.GetBlockCount());
+  WriteHelp("dory_pool_allocated_blocks", "gauge",
+      "Number of allocated message buffer pool blocks");
+  WriteSample("dory_pool_allocated_blocks", Pool.GetAllocatedBlockCount());
+  WriteHelp("dory_pool_peak_allocated_blocks", "gauge",
+      "Largest number of message buffer pool blocks allocated at once");
+  WriteSample("dory_pool_peak_allocated_blocks",
+      Pool.GetPeakAllocatedBlockCount());
+  WriteHelp("dory_pool_block_allocs_total", "counter",
+      "Message buffer pool blocks allocated");
+  WriteSample("dory_pool_block_allocs_total", Pool.GetTotalAllocCount());
+  WriteHelp("dory_pool_alloc_failures_total", "counter",
+      "Message buffer pool allocations that failed because the pool was "
+      "exhausted");
+  WriteSample("dory_pool_alloc_failures_total", Pool.GetAllocFailureCount());
+}
+
+template <typename TTopicMap>
+void TMetricsRenderer::WriteTopicMap(const char *name,
+    const TTopicMap &topic_map) {
+  for (const auto &item : topic_map) {
+    if (TopicFilter.Matches(item.first)) {
+      if constexpr (std::is_same_v<TTopicMap,
+          TAnomalyTracker::TRateLimitMap>) {
+        WriteSample(name, "topic", item.first, item.second);
+      } else {
+        WriteSample(name, "topic", item.first, item.second.Count);
+      }
+    }
+  }
+}
+
+void TMetricsRenderer::WriteDiscardStats() {
+  TAnomalyTracker::TInfo current_unused;
+  std::shared_ptr<const TAnomalyTracker::TInfo> info =
+      AnomalyTracker.GetInfo(current_unused);
+
+  /* Report the most recently completed discard reporting interval, as
+     /discards/json does.  There is none during the first interval. */
+  if (!info) {
+    return;
+  }
+
+  WriteHelp("dory_discard_report_id", "gauge",
+      "ID of the most recently completed discard report");
+  WriteSample("dory_discard_report_id", info->GetReportId());
+  WriteHelp("dory_discard_report_start_time_seconds", "gauge",
+      "Start of the most recently completed discard report");
+  WriteSample("dory_discard_report_start_time_seconds",
+      info->GetStartTime());
+  WriteHelp("dory_discard_report_interval_seconds", "gauge",
+      "Length of each discard reporting interval");
+  WriteSample("dory_discard_report_interval_seconds",
+      AnomalyTracker.GetReportInterval());
+  WriteHelp("dory_report_discarded_msgs", "gauge",
+      "Messages with valid topics discarded during the report interval");
+  WriteTopicMap("dory_report_discarded_msgs", info->DiscardTopicMap);
+  WriteHelp("dory_report_possible_duplicate_msgs", "gauge",
+      "Possibly duplicated messages during the report interval");
+  WriteTopicMap("dory_report_possible_duplicate_msgs",
+      info->DuplicateTopicMap);
+  WriteHelp("dory_report_rate_limit_discarded_msgs", "gauge",
+      "Messages discarded by rate limiting during the report interval");
+  WriteTopicMap("dory_report_rate_limit_discarded_msgs",
+      info->RateLimitDiscardMap);
+  WriteHelp("dory_report_malformed_msgs", "gauge",
+      "Malformed messages discarded during the report interval");
+  WriteSample("dory_report_malformed_msgs", info->MalformedMsgCount);
+  WriteHelp("dory_report_bad_topic_msgs", "gauge",
+      "Messages with bad topics discarded during the report interval");
+  WriteSample("dory_report_bad_topic_msgs", info->BadTopicMsgCount);
+  WriteHelp("dory_report_unsupported_api_key_msgs", "gauge",
+      "Messages with unsupported API keys discarded during the report "
+      "interval");
+  WriteSample("dory_report_unsupported_api_key_msgs",
+      info->UnsupportedApiKeyMsgCount);
+  WriteHelp("dory_report_unsupported_version_msgs", "gauge",
+      "Messages with unsupported versions discarded during the report "
+      "interval");
+  WriteSample("dory_report_unsupported_version_msgs",
+      info->UnsupportedVersionMsgCount);
+  WriteHelp("dory_report_unix_stream_unclean_disconnects", "gauge",
+      "UNIX stream clients that disconnected with a partial message during "
+      "the report interval");
+  WriteSample("dory_report_unix_stream_unclean_disconnects",
+      info->UnixStreamUncleanDisconnectCount);
+  WriteHelp("dory_report_tcp_unclean_disconnects", "gauge",
+      "TCP clients that disconnected with a partial message during the "
+      "report interval");
+  WriteSample("dory_report_tcp_unclean_disconnects",
+      info->TcpUncleanDisconnectCount);
+}
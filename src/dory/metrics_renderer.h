@@ -0,0 +1,128 @@
+/* <dory/metrics_renderer.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Renders Dory's status in the Prometheus text exposition format.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <base/thrower.h>
+#include <capped/pool.h>
+#include <dory/anomaly_tracker.h>
+#include <dory/msg_state_tracker.h>
+
+namespace Dory {
+
+  /* Renders counters, per-topic queue stats, discard info, and buffer pool
+     usage in the Prometheus text exposition format, for the web interface's
+     /metrics page.  Output is appended directly to a buffer that is reused
+     across requests, rather than built with a std::ostringstream and then
+     copied, so a scrape of a server with many topics and counters allocates
+     little once the buffers have grown to their working sizes.  Not thread
+     safe, which is fine since the web interface handles one request at a
+     time. */
+  class TMetricsRenderer final {
+    NO_COPY_SEMANTICS(TMetricsRenderer);
+
+    public:
+    DEFINE_ERROR(TBadMetricsQuery, std::runtime_error,
+                 "Invalid /metrics query string");
+
+    /* Selects topics for per-topic metrics, based on the query string of a
+       /metrics request.  Each "topic=name" parameter selects a topic by name,
+       and each "topic_prefix=prefix" parameter selects all topics whose names
+       start with the given prefix.  If there are no such parameters, all
+       topics are selected. */
+    class TTopicFilter final {
+      public:
+      TTopicFilter() = default;
+
+      /* Replace the current selection with the one given by 'query_string',
+         which may be null.  Throws TBadMetricsQuery on an unknown parameter,
+         or Server::TUrlDecodeError on a badly encoded value. */
+      void Parse(const char *query_string);
+
+      bool Matches(const std::string &topic) const noexcept;
+
+      private:
+      std::vector<std::string> Topics;
+
+      std::vector<std::string> Prefixes;
+    };  // TTopicFilter
+
+    TMetricsRenderer(const TMsgStateTracker &msg_state_tracker,
+        const TAnomalyTracker &anomaly_tracker, const Capped::TPool &pool);
+
+    /* Render the metrics selected by 'query_string', which may be null.  The
+       result is valid until the next call.  Throws as described for
+       TTopicFilter::Parse(). */
+    const std::string &Render(const char *query_string);
+
+    private:
+    void WriteHelp(const char *name, const char *type, const char *help);
+
+    void WriteSample(const char *name, uint64_t value);
+
+    void WriteSample(const char *name, const char *label_name,
+        const std::string &label_value, uint64_t value);
+
+    void WriteSample(const char *name, const char *label1_name,
+        const std::string &label1_value, const char *label2_name,
+        const char *label2_value, int64_t value);
+
+    void WriteLabelValue(const std::string &value);
+
+    void WriteValue(int64_t value);
+
+    void WriteValue(uint64_t value);
+
+    void WriteCounters();
+
+    void WriteQueueStats();
+
+    void WritePoolStats();
+
+    void WriteDiscardStats();
+
+    /* Write per-topic samples of metric 'name' from 'topic_map', which is
+       either TAnomalyTracker::TMap or TAnomalyTracker::TRateLimitMap. */
+    template <typename TTopicMap>
+    void WriteTopicMap(const char *name, const TTopicMap &topic_map);
+
+    const TMsgStateTracker &MsgStateTracker;
+
+    const TAnomalyTracker &AnomalyTracker;
+
+    const Capped::TPool &Pool;
+
+    TTopicFilter TopicFilter;
+
+    /* Reused across requests, so they keep their capacity. */
+    std::string Buf;
+
+    std::vector<TMsgStateTracker::TTopicStatsItem> TopicStats;
+  };  // TMetricsRenderer
+
+}  // Dory
@@ -0,0 +1,156 @@
+/* <dory/metrics_renderer.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/metrics_renderer.h>.
+ */
+
+#include <dory/metrics_renderer.h>
+
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <string>
+
+#include <base/tmp_file.h>
+#include <dory/anomaly_tracker.h>
+#include <dory/discard_file_logger.h>
+#include <dory/msg.h>
+#include <dory/test_util/misc_util.h>
+#include <server/url_decode.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::TestUtil;
+using namespace Server;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TMetricsRenderer. */
+  class TMetricsRendererTest : public ::testing::Test {
+    protected:
+    TMetricsRendererTest() = default;
+
+    ~TMetricsRendererTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TMetricsRendererTest
+
+  bool Contains(const std::string &s, const std::string &line) {
+    return s.find(line + "\n") != std::string::npos;
+  }
+
+  TEST_F(TMetricsRendererTest, TopicFilter) {
+    TMetricsRenderer::TTopicFilter filter;
+    filter.Parse(nullptr);
+    ASSERT_TRUE(filter.Matches("anything"));
+    filter.Parse("");
+    ASSERT_TRUE(filter.Matches("anything"));
+    filter.Parse("topic=t1&topic_prefix=web%5F&topic=a+b");
+    ASSERT_TRUE(filter.Matches("t1"));
+    ASSERT_FALSE(filter.Matches("t10"));
+    ASSERT_TRUE(filter.Matches("web_clicks"));
+    ASSERT_FALSE(filter.Matches("webclicks"));
+    ASSERT_TRUE(filter.Matches("a b"));
+    filter.Parse("topic=t1&");
+    ASSERT_TRUE(filter.Matches("t1"));
+    ASSERT_FALSE(filter.Matches("t2"));
+    ASSERT_THROW(filter.Parse("bogus=1"),
+        TMetricsRenderer::TBadMetricsQuery);
+    ASSERT_THROW(filter.Parse("topic"), TMetricsRenderer::TBadMetricsQuery);
+    ASSERT_THROW(filter.Parse("topic=%zz"), TUrlDecodeError);
+  }
+
+  TEST_F(TMetricsRendererTest, Render) {
+    TTestMsgCreator mc;
+    TMsgStateTracker &tracker = mc.MsgStateTracker;
+    uint64_t now = 1000;
+    TDiscardFileLogger discard_file_logger;
+    TAnomalyTracker anomaly_tracker(discard_file_logger, 60,
+        std::numeric_limits<size_t>::max(), [&now] { return now; });
+    TMetricsRenderer renderer(tracker, anomaly_tracker, *mc.Pool);
+
+    std::list<TMsg::TPtr> msgs;
+    msgs.push_back(mc.NewMsg("topic1", "value", 0));
+    tracker.MsgEnterBatching(*msgs.back());
+    msgs.push_back(mc.NewMsg("topic1", "value", 0));
+    tracker.MsgEnterSendWait(*msgs.back());
+    tracker.MsgEnterAckWait(*msgs.back());
+    msgs.push_back(mc.NewMsg("quoted\"topic", "value", 0));
+    tracker.MsgEnterSendWait(*msgs.back());
+    msgs.push_back(mc.NewMsg("topic2", "value", 0));
+
+    TMsg::TPtr discard = mc.NewMsg("topic2", "value", 0);
+    tracker.MsgEnterProcessed(*discard);
+    anomaly_tracker.TrackDiscard(discard,
+        TAnomalyTracker::TDiscardReason::KafkaErrorAck);
+
+    /* No discard report has been completed yet. */
+    std::string out = renderer.Render(nullptr);
+    ASSERT_TRUE(Contains(out, "dory_new_msgs 1"));
+    ASSERT_TRUE(Contains(out,
+        "dory_queued_msgs{topic=\"topic1\",state=\"batching\"} 1"));
+    ASSERT_TRUE(Contains(out,
+        "dory_queued_msgs{topic=\"topic1\",state=\"ack_wait\"} 1"));
+    ASSERT_TRUE(Contains(out,
+        "dory_queued_msgs{topic=\"quoted\\\"topic\",state=\"send_wait\"} 1"));
+    ASSERT_TRUE(Contains(out,
+        "dory_queued_msg_bytes{topic=\"topic1\",state=\"ack_wait\"} 5"));
+    ASSERT_TRUE(Contains(out, "dory_pool_block_size_bytes 64"));
+    ASSERT_TRUE(Contains(out, "dory_pool_alloc_failures_total 0"));
+    ASSERT_TRUE(Contains(out, "# TYPE dory_counter_total counter"));
+    ASSERT_TRUE(out.find("dory_counter_total{name=\"MsgCreate\"} ") !=
+        std::string::npos);
+    ASSERT_TRUE(out.find("dory_report_") == std::string::npos);
+
+    now += 60;
+    out = renderer.Render("topic=topic1");
+    ASSERT_TRUE(Contains(out,
+        "dory_queued_msgs{topic=\"topic1\",state=\"batching\"} 1"));
+    ASSERT_TRUE(out.find("quoted") == std::string::npos);
+    ASSERT_TRUE(out.find("topic2") == std::string::npos);
+    ASSERT_TRUE(Contains(out, "dory_discard_report_interval_seconds 60"));
+
+    out = renderer.Render("topic_prefix=topic");
+    ASSERT_TRUE(Contains(out,
+        "dory_report_discarded_msgs{topic=\"topic2\"} 1"));
+    ASSERT_TRUE(out.find("quoted") == std::string::npos);
+
+    for (auto &msg : msgs) {
+      if (msg->GetState() == TMsg::TState::Batching) {
+        tracker.MsgEnterSendWait(*msg);
+      }
+
+      tracker.MsgEnterProcessed(*msg);
+    }
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
@@ -29,6 +29,8 @@
 #include <base/gettid.h>
 #include <base/no_default_case.h>
 #include <dory/compress/compression_type.h>
+#include <dory/kafka_proto/api_versions/v0/api_versions_request_fields.h>
+#include <dory/kafka_proto/api_versions/v0/api_versions_response_writer.h>
 #include <dory/kafka_proto/produce/msg_set_reader_api.h>
 #include <dory/mock_kafka_server/cmd.h>
 #include <log/log.h>
@@ -37,6 +39,8 @@
 using namespace Base;
 using namespace Dory;
 using namespace Dory::Compress;
+using namespace Dory::KafkaProto::ApiVersions;
+using namespace Dory::KafkaProto::ApiVersions::V0;
 using namespace Dory::KafkaProto::Produce;
 using namespace Dory::MockKafkaServer;
 using namespace Dory::MockKafkaServer::ProdReq;
@@ -223,6 +227,9 @@ TSingleClientHandlerBase::GetRequestType() {
     case 3: {
       return TRequestType::MetadataRequest;
     }
+    case 18: {
+      return TRequestType::ApiVersionsRequest;
+    }
     default: {
       break;
     }
@@ -696,6 +703,65 @@ bool TSingleClientHandlerBase::HandleMetadataRequest() {
   return true;
 }
 
+bool TSingleClientHandlerBase::HandleApiVersionsRequest() {
+  using THdr = TApiVersionsRequestFields;
+
+  if (InputBuf.size() < THdr::REQUEST_SIZE) {
+    Out << "Error: Got short ApiVersions request" << std::endl;
+    return false;
+  }
+
+  const int32_t corr_id =
+      ReadInt32FromHeader(&InputBuf[THdr::CORRELATION_ID_OFFSET]);
+  const int16_t api_version =
+      ReadInt16FromHeader(&InputBuf[THdr::API_VERSION_OFFSET]);
+
+  /* Like a real broker, respond to an unsupported request version with error
+     UNSUPPORTED_VERSION (35) and an empty API list. */
+  const int16_t error = (api_version == THdr::API_VERSION) ? 0 : 35;
+  std::vector<TApiVersionRange> api_versions;
+
+  if (error == 0) {
+    api_versions = GetSupportedApiVersions();
+  }
+
+  if (CmdLineArgs.QuietLevel <= 1) {
+    Out << "Info: Got ApiVersions request " << ApiVersionsRequestCount
+        << " version " << api_version << " corr ID " << corr_id
+        << ": responding with error " << error << std::endl;
+  }
+
+  TApiVersionsResponseWriter().WriteResponse(OutputBuf, corr_id, error,
+      api_versions);
+
+  switch (TryWriteExactlyOrShutdown(ClientSocket, &OutputBuf[0],
+                                    OutputBuf.size())) {
+    case TIoResult::Success: {
+      break;
+    }
+    case TIoResult::Disconnected: {
+      Out << "Error: Got disconnected from client while sending ApiVersions "
+          << "response" << std::endl;
+      return false;
+    }
+    case TIoResult::UnexpectedEnd:
+    case TIoResult::EmptyReadUnexpectedEnd: {
+      Out << "Error: Got disconnected unexpectedly from client while sending "
+             "ApiVersions response"
+          << std::endl;
+      return false;
+    }
+    case TIoResult::GotShutdownRequest: {
+      Out << "Info: Got shutdown request while sending ApiVersions response"
+          << std::endl;
+      return false;
+    }
+    NO_DEFAULT_CASE;
+  }
+
+  return true;
+}
+
 const TSetup::TPartition *TSingleClientHandlerBase::FindPartition(
     const std::string &topic, int32_t partition) const {
   auto iter = Setup.Topics.find(topic);
@@ -724,6 +790,7 @@ void TSingleClientHandlerBase::DoRun() {
   const TSetup::TPort &port = Setup.Ports[PortOffset];
   ProduceRequestCount = 0;
   MetadataRequestCount = 0;
+  ApiVersionsRequestCount = 0;
   MsgSetCount = 0;
   MsgCount = 0;
   const TFd &shutdown_request_fd = GetShutdownRequestFd();
@@ -783,6 +850,11 @@ void TSingleClientHandlerBase::DoRun() {
         done = !HandleMetadataRequest();
         break;
       }
+      case TRequestType::ApiVersionsRequest: {
+        ++ApiVersionsRequestCount;
+        done = !HandleApiVersionsRequest();
+        break;
+      }
       NO_DEFAULT_CASE;
     }
 
@@ -797,6 +869,7 @@ void TSingleClientHandlerBase::DoRun() {
         << "final counts:" << std::endl
         << "produce requests: " << ProduceRequestCount << std::endl
         << "metadata requests: " << MetadataRequestCount << std::endl
+        << "ApiVersions requests: " << ApiVersionsRequestCount << std::endl
         << "message sets: " << MsgSetCount << std::endl
         << "messages: " << MsgCount << std::endl
         << std::endl;
@@ -33,6 +33,7 @@
 
 #include <base/fd.h>
 #include <base/no_copy_semantics.h>
+#include <dory/kafka_proto/api_versions/api_versions.h>
 #include <dory/kafka_proto/produce/msg_set_reader_api.h>
 #include <dory/kafka_proto/produce/produce_request_reader_api.h>
 #include <dory/kafka_proto/produce/produce_response_writer_api.h>
@@ -75,7 +76,8 @@ namespace Dory {
       enum class TRequestType {
         UnknownRequest,
         ProduceRequest,
-        MetadataRequest
+        MetadataRequest,
+        ApiVersionsRequest
       };  // TRequestType
 
       struct TMetadataRequest {
@@ -107,6 +109,11 @@ namespace Dory {
       virtual Dory::KafkaProto::Produce::TProduceResponseWriterApi &
       GetProduceResponseWriter() = 0;
 
+      /* Return the API list to send in an ApiVersions response: the API
+         versions that the mock server supports. */
+      virtual std::vector<KafkaProto::ApiVersions::TApiVersionRange>
+      GetSupportedApiVersions() const = 0;
+
       virtual bool ValidateMetadataRequestHeader() = 0;
 
       virtual bool ValidateMetadataRequest(TMetadataRequest &request) = 0;
@@ -180,6 +187,8 @@ namespace Dory {
 
       bool HandleMetadataRequest();
 
+      bool HandleApiVersionsRequest();
+
       const TSetup::TPartition *FindPartition(const std::string &topic,
           int32_t partition) const;
 
@@ -191,6 +200,8 @@ namespace Dory {
 
       size_t MetadataRequestCount = 0;
 
+      size_t ApiVersionsRequestCount = 0;
+
       size_t MsgSetCount = 0;
 
       size_t MsgCount = 0;
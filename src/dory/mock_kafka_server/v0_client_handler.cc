@@ -41,6 +41,7 @@ using namespace Base;
 using namespace Socket;
 using namespace Dory;
 using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::ApiVersions;
 using namespace Dory::KafkaProto::Metadata::V0;
 using namespace Dory::KafkaProto::Produce;
 using namespace Dory::KafkaProto::Produce::V0;
@@ -63,6 +64,15 @@ TProduceResponseWriterApi &TV0ClientHandler::GetProduceResponseWriter() {
   return ProduceResponseWriter;
 }
 
+std::vector<TApiVersionRange>
+TV0ClientHandler::GetSupportedApiVersions() const {
+  return {
+    TApiVersionRange(PRODUCE_API_KEY, 0, 0),
+    TApiVersionRange(METADATA_API_KEY, 0, 0),
+    TApiVersionRange(API_VERSIONS_API_KEY, 0, 0)
+  };
+}
+
 bool TV0ClientHandler::ValidateMetadataRequestHeader() {
   try {
     OptMetadataRequestReader.emplace(&InputBuf[0], InputBuf.size());
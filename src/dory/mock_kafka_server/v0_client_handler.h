@@ -69,6 +69,9 @@ namespace Dory {
       Dory::KafkaProto::Produce::TProduceResponseWriterApi &
       GetProduceResponseWriter() override;
 
+      std::vector<KafkaProto::ApiVersions::TApiVersionRange>
+      GetSupportedApiVersions() const override;
+
       bool ValidateMetadataRequestHeader() override;
 
       bool ValidateMetadataRequest(TMetadataRequest &request) override;
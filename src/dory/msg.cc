@@ -81,7 +81,9 @@ TMsg::TMsg(TRoutingType routing_type, int32_t partition_key,
     : RoutingType(routing_type),
       PartitionKey(partition_key),
       Timestamp(timestamp),
-      CreationTimestamp(GetMonotonicRawMilliseconds()),
+      CreationTimestampUsec(GetMonotonicRawMicroseconds()),
+      CreationTimestamp(CreationTimestampUsec / 1000),
+      StateTimestampUsec(CreationTimestampUsec),
       Topic(reinterpret_cast<const char *>(topic_begin),
             reinterpret_cast<const char *>(topic_end)),
       KeyAndValue(MakeKeyAndValue(key, key_size, value, value_size, pool)),
@@ -96,6 +96,35 @@ namespace Dory {
       return CreationTimestamp;
     }
 
+    /* Same clock as GetCreationTimestamp(), but in microseconds.  Used for
+       latency histograms. */
+    uint64_t GetCreationTimestampUsec() const noexcept {
+      return CreationTimestampUsec;
+    }
+
+    /* Return the monotonic raw time in microseconds when the message entered
+       its current state.  Maintained by TMsgStateTracker when latency
+       tracking is enabled. */
+    uint64_t GetStateTimestampUsec() const noexcept {
+      return StateTimestampUsec;
+    }
+
+    void SetStateTimestampUsec(uint64_t timestamp) noexcept {
+      StateTimestampUsec = timestamp;
+    }
+
+    /* Returns the index assigned to the message's topic by TMsgStateTracker,
+       or NO_TOPIC_STATS_INDEX if none has been assigned yet. */
+    size_t GetTopicStatsIndex() const noexcept {
+      return TopicStatsIndex;
+    }
+
+    void SetTopicStatsIndex(size_t index) noexcept {
+      TopicStatsIndex = index;
+    }
+
+    static constexpr size_t NO_TOPIC_STATS_INDEX = ~size_t(0);
+
     /* Accessor for the Kafka topic string. */
     const std::string &GetTopic() const noexcept {
       return Topic;
@@ -146,10 +175,62 @@ namespace Dory {
       return State;
     }
 
+    /* Returns the sequence number of the message's write-ahead journal entry,
+       or 0 if the message has not been journaled. */
+    uint64_t GetJournalSeq() const noexcept {
+      return JournalSeq;
+    }
+
+    void SetJournalSeq(uint64_t seq) noexcept {
+      JournalSeq = seq;
+    }
+
     void SetState(TState state) noexcept {
       State = state;
     }
 
+    /* Times at which a message selected for tracing by TMsgTracer entered
+       each stage of processing.  All times are monotonic raw microseconds, on
+       the same clock as GetCreationTimestampUsec(), which gives the time the
+       message was received.  A time of 0 indicates that the message has not
+       reached the stage.  If a message enters a stage more than once, as
+       happens when it is resent, the most recent time is kept. */
+    struct TTrace {
+      uint64_t Id = 0;
+
+      /* Entered state TState::Batching. */
+      uint64_t BatchedUsec = 0;
+
+      /* Entered state TState::SendWait. */
+      uint64_t DispatchedUsec = 0;
+
+      /* Entered state TState::AckWait. */
+      uint64_t SentUsec = 0;
+
+      /* Entered state TState::Processed. */
+      uint64_t ProcessedUsec = 0;
+    };  // TTrace
+
+    bool IsTraced() const noexcept {
+      return Trace != nullptr;
+    }
+
+    /* Returns null if the message is not traced. */
+    TTrace *GetTrace() noexcept {
+      return Trace.get();
+    }
+
+    /* Returns null if the message is not traced. */
+    const TTrace *GetTrace() const noexcept {
+      return Trace.get();
+    }
+
+    /* Select the message for tracing, with trace ID 'id'. */
+    void StartTrace(uint64_t id) {
+      Trace = std::make_unique<TTrace>();
+      Trace->Id = id;
+    }
+
     ~TMsg();
 
     private:
@@ -185,17 +266,23 @@ namespace Dory {
     /* Message timestamp from input UNIX domain datagram. */
     const TTimestamp Timestamp;
 
-    /* This timestamp is used for per-topic message rate limiting, and is set
-       based on a call to clock_gettime() with a clock type of
-       CLOCK_MONOTONIC_RAW.  We use this clock type specifically because it is
-       unaffected by changes made to the system wall clock.  If we used
-       CLOCK_REALTIME and someone manually set the clock back, this could cause
-       large numbers of discards until the clock catches back up to its
-       previous setting.  We don't use the timestamp value provided by the
-       client's input UNIX domain datagram because we have no idea what kind of
-       clock was used to generate that timestamp. */
+    /* This timestamp is used for per-topic message rate limiting and latency
+       tracking, and is set in microseconds based on a call to clock_gettime()
+       with a clock type of CLOCK_MONOTONIC_RAW.  We use this clock type
+       specifically because it is unaffected by changes made to the system
+       wall clock.  If we used CLOCK_REALTIME and someone manually set the
+       clock back, this could cause large numbers of discards until the clock
+       catches back up to its previous setting.  We don't use the timestamp
+       value provided by the client's input UNIX domain datagram because we
+       have no idea what kind of clock was used to generate that timestamp. */
+    const uint64_t CreationTimestampUsec;
+
+    /* Same as 'CreationTimestampUsec', but in milliseconds. */
     const uint64_t CreationTimestamp;
 
+    /* See GetStateTimestampUsec(). */
+    uint64_t StateTimestampUsec;
+
     /* State of message.  Destructor verifies that value is TState::Processed.
      */
     TState State = TState::New;
@@ -203,6 +290,17 @@ namespace Dory {
     /* Number of failed deliveries. */
     size_t FailedDeliveryAttemptCount = 0;
 
+    /* See GetJournalSeq(). */
+    uint64_t JournalSeq = 0;
+
+    /* See GetTopicStatsIndex(). */
+    size_t TopicStatsIndex = NO_TOPIC_STATS_INDEX;
+
+    /* Null unless the message is traced.  Only a small sample of messages
+       are traced, so the trace is allocated separately to keep untraced
+       messages small. */
+    std::unique_ptr<TTrace> Trace;
+
     /* The Kafka topic to deliver to. */
     const std::string Topic;
 
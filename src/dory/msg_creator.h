@@ -53,7 +53,7 @@ namespace Dory {
         TMsgStateTracker &msg_state_tracker) {
       TMsg::TPtr msg = TMsg::CreateAnyPartitionMsg(timestamp, topic_begin,
           topic_end, key, key_size, value, value_size, body_truncated, pool);
-      msg_state_tracker.MsgEnterNew();
+      msg_state_tracker.MsgEnterNew(*msg);
       return msg;
     }
 
@@ -65,7 +65,7 @@ namespace Dory {
       TMsg::TPtr msg = TMsg::CreatePartitionKeyMsg(partition_key, timestamp,
           topic_begin, topic_end, key, key_size, value, value_size,
           body_truncated, pool);
-      msg_state_tracker.MsgEnterNew();
+      msg_state_tracker.MsgEnterNew(*msg);
       return msg;
     }
   };  // TMsgCreator
@@ -0,0 +1,167 @@
+/* <dory/msg_dispatch/adaptive_compression.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/msg_dispatch/adaptive_compression.h>.
+ */
+
+#include <dory/msg_dispatch/adaptive_compression.h>
+
+#include <base/no_default_case.h>
+
+using namespace Dory;
+using namespace Dory::Conf;
+using namespace Dory::MsgDispatch;
+
+/* Weight given to each new sample when updating the moving averages. */
+static const double SAMPLE_WEIGHT = 0.125;
+
+TAdaptiveCompression::TAdaptiveCompression(
+    const TCompressionConf::TAdaptiveConf &conf, float max_compression_ratio,
+    std::optional<int> level, std::optional<int> fastest_level) noexcept
+    : MinSamples(conf.MinSamples ? conf.MinSamples : 1),
+      RecheckInterval(conf.RecheckInterval ? conf.RecheckInterval : 1),
+      MaxNsPerByte(conf.MaxNsPerByte),
+      MaxCompressionRatio(max_compression_ratio),
+      FastestLevel(fastest_level),
+      Level(level) {
+}
+
+bool TAdaptiveCompression::ShouldCompress() noexcept {
+  if (State != TState::Skipping) {
+    return true;
+  }
+
+  if (++SinceLastSample >= RecheckInterval) {
+    /* Compress this one as a sample, to see whether the data has become
+       compressible. */
+    SinceLastSample = 0;
+    return true;
+  }
+
+  ++SkipCount;
+  return false;
+}
+
+void TAdaptiveCompression::RecordResult(size_t uncompressed_size,
+    size_t compressed_size, uint64_t elapsed_ns) noexcept {
+  if (uncompressed_size == 0) {
+    return;
+  }
+
+  switch (State) {
+    case TState::Learning: {
+      UpdateAverages(uncompressed_size, compressed_size, elapsed_ns);
+
+      if (SampleCount < MinSamples) {
+        break;
+      }
+
+      if (AvgRatio > MaxCompressionRatio) {
+        State = TState::Skipping;
+        SinceLastSample = 0;
+      } else if (IsOverCpuBudget()) {
+        /* Try again with the fastest level. */
+        Level = FastestLevel;
+        LevelReduced = true;
+        Relearn();
+      } else {
+        State = TState::Compressing;
+      }
+
+      break;
+    }
+    case TState::Compressing: {
+      UpdateAverages(uncompressed_size, compressed_size, elapsed_ns);
+
+      if (AvgRatio > MaxCompressionRatio) {
+        State = TState::Skipping;
+        SinceLastSample = 0;
+      } else if (IsOverCpuBudget()) {
+        Level = FastestLevel;
+        LevelReduced = true;
+        Relearn();
+      }
+
+      break;
+    }
+    case TState::Skipping: {
+      const double ratio = static_cast<double>(compressed_size) /
+          static_cast<double>(uncompressed_size);
+
+      if (ratio <= MaxCompressionRatio) {
+        /* The data looks compressible again.  Start over, since the old
+           averages describe data we no longer see. */
+        Relearn();
+      }
+
+      UpdateAverages(uncompressed_size, compressed_size, elapsed_ns);
+
+      break;
+    }
+    NO_DEFAULT_CASE;
+  }
+}
+
+void TAdaptiveCompression::Relearn() noexcept {
+  State = TState::Learning;
+  AvgRatio = 0.0;
+  AvgNsPerByte = 0.0;
+  SampleCount = 0;
+  SinceLastSample = 0;
+}
+
+void TAdaptiveCompression::UpdateAverages(size_t uncompressed_size,
+    size_t compressed_size, uint64_t elapsed_ns) noexcept {
+  const double size = static_cast<double>(uncompressed_size);
+  const double ratio = static_cast<double>(compressed_size) / size;
+  const double ns_per_byte = static_cast<double>(elapsed_ns) / size;
+
+  if (SampleCount == 0) {
+    AvgRatio = ratio;
+    AvgNsPerByte = ns_per_byte;
+  } else {
+    AvgRatio += SAMPLE_WEIGHT * (ratio - AvgRatio);
+    AvgNsPerByte += SAMPLE_WEIGHT * (ns_per_byte - AvgNsPerByte);
+  }
+
+  ++SampleCount;
+}
+
+bool TAdaptiveCompression::IsOverCpuBudget() const noexcept {
+  return (MaxNsPerByte != 0) && !LevelReduced && FastestLevel.has_value() &&
+      (Level != FastestLevel) &&
+      (AvgNsPerByte > static_cast<double>(MaxNsPerByte));
+}
+
+const char *Dory::MsgDispatch::ToString(
+    TAdaptiveCompression::TState state) noexcept {
+  switch (state) {
+    case TAdaptiveCompression::TState::Learning: {
+      break;
+    }
+    case TAdaptiveCompression::TState::Compressing: {
+      return "compressing";
+    }
+    case TAdaptiveCompression::TState::Skipping: {
+      return "skipping";
+    }
+    NO_DEFAULT_CASE;
+  }
+
+  return "learning";
+}
@@ -0,0 +1,154 @@
+/* <dory/msg_dispatch/adaptive_compression.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Per-topic adaptive compression decisions, based on observed compression
+   ratio and CPU cost.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include <dory/conf/compression_conf.h>
+
+namespace Dory {
+
+  namespace MsgDispatch {
+
+    /* Tracks moving averages of compression ratio and compression time per
+       uncompressed byte for a single topic, and uses them to decide whether
+       message sets for the topic are worth compressing.  A topic whose data
+       is consistently incompressible stops being compressed, except for an
+       occasional sample message set that is compressed to detect a change in
+       the data.  If a CPU budget is configured and compression of the topic
+       exceeds it, the topic is switched to the fastest compression level its
+       codec supports.  Each connector thread has its own instance per topic,
+       so no synchronization is done. */
+    class TAdaptiveCompression final {
+      public:
+      enum class TState {
+        /* Collecting samples before making a decision. */
+        Learning,
+
+        /* Data compresses well enough.  Compress every message set. */
+        Compressing,
+
+        /* Data doesn't compress well enough.  Only compress samples. */
+        Skipping
+      };  // TState
+
+      /* 'max_compression_ratio' is the ratio (compressed size / uncompressed
+         size) above which compression is considered a waste.  'level' is the
+         configured compression level and 'fastest_level' is the fastest level
+         supported by the topic's codec (both are empty for a codec that
+         doesn't support levels). */
+      TAdaptiveCompression(const Conf::TCompressionConf::TAdaptiveConf &conf,
+          float max_compression_ratio, std::optional<int> level,
+          std::optional<int> fastest_level) noexcept;
+
+      /* Called for each message set that is large enough to compress.  A
+         return value of false indicates that the message set should be sent
+         uncompressed without trying to compress it. */
+      bool ShouldCompress() noexcept;
+
+      /* Report the result of compressing a message set.  'elapsed_ns' is the
+         time in nanoseconds spent doing the compression. */
+      void RecordResult(size_t uncompressed_size, size_t compressed_size,
+          uint64_t elapsed_ns) noexcept;
+
+      /* Compression level to use for the next message set. */
+      std::optional<int> GetLevel() const noexcept {
+        return Level;
+      }
+
+      /* Returns true if the level was reduced to meet the CPU budget. */
+      bool IsLevelReduced() const noexcept {
+        return LevelReduced;
+      }
+
+      TState GetState() const noexcept {
+        return State;
+      }
+
+      double GetAvgRatio() const noexcept {
+        return AvgRatio;
+      }
+
+      double GetAvgNsPerByte() const noexcept {
+        return AvgNsPerByte;
+      }
+
+      /* Returns number of samples collected since the averages were last
+         reset. */
+      size_t GetSampleCount() const noexcept {
+        return SampleCount;
+      }
+
+      /* Returns the number of message sets for which ShouldCompress() has
+         returned false since the last call, and resets the count to 0. */
+      size_t TakeSkipCount() noexcept {
+        const size_t result = SkipCount;
+        SkipCount = 0;
+        return result;
+      }
+
+      private:
+      void Relearn() noexcept;
+
+      void UpdateAverages(size_t uncompressed_size, size_t compressed_size,
+          uint64_t elapsed_ns) noexcept;
+
+      bool IsOverCpuBudget() const noexcept;
+
+      const size_t MinSamples;
+
+      const size_t RecheckInterval;
+
+      const size_t MaxNsPerByte;
+
+      const float MaxCompressionRatio;
+
+      const std::optional<int> FastestLevel;
+
+      std::optional<int> Level;
+
+      bool LevelReduced = false;
+
+      TState State = TState::Learning;
+
+      /* Exponentially weighted moving averages. */
+      double AvgRatio = 0.0;
+
+      double AvgNsPerByte = 0.0;
+
+      size_t SampleCount = 0;
+
+      /* Number of message sets skipped since the last sample was taken while
+         in state Skipping. */
+      size_t SinceLastSample = 0;
+
+      size_t SkipCount = 0;
+    };  // TAdaptiveCompression
+
+    const char *ToString(TAdaptiveCompression::TState state) noexcept;
+
+  }  // MsgDispatch
+
+}  // Dory
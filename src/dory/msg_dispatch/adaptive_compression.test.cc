@@ -0,0 +1,164 @@
+/* <dory/msg_dispatch/adaptive_compression.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/msg_dispatch/adaptive_compression.h>.
+ */
+
+#include <dory/msg_dispatch/adaptive_compression.h>
+
+#include <cstddef>
+#include <optional>
+
+#include <base/tmp_file.h>
+#include <dory/conf/compression_conf.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Conf;
+using namespace Dory::MsgDispatch;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TAdaptiveCompression. */
+  class TAdaptiveCompressionTest : public ::testing::Test {
+    protected:
+    TAdaptiveCompressionTest() = default;
+
+    ~TAdaptiveCompressionTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TAdaptiveCompressionTest
+
+  TCompressionConf::TAdaptiveConf MakeConf(size_t min_samples,
+      size_t recheck_interval, size_t max_ns_per_byte) {
+    TCompressionConf::TAdaptiveConf conf;
+    conf.Enable = true;
+    conf.MinSamples = min_samples;
+    conf.RecheckInterval = recheck_interval;
+    conf.MaxNsPerByte = max_ns_per_byte;
+    return conf;
+  }
+
+  TEST_F(TAdaptiveCompressionTest, CompressibleTest) {
+    using TState = TAdaptiveCompression::TState;
+    TAdaptiveCompression ac(MakeConf(4, 10, 0), 0.75f, 6, 1);
+    ASSERT_EQ(ac.GetState(), TState::Learning);
+
+    for (size_t i = 0; i < 3; ++i) {
+      ASSERT_TRUE(ac.ShouldCompress());
+      ac.RecordResult(1000, 300, 5000);
+      ASSERT_EQ(ac.GetState(), TState::Learning);
+    }
+
+    ASSERT_TRUE(ac.ShouldCompress());
+    ac.RecordResult(1000, 300, 5000);
+    ASSERT_EQ(ac.GetState(), TState::Compressing);
+    ASSERT_EQ(ac.GetSampleCount(), 4U);
+    ASSERT_DOUBLE_EQ(ac.GetAvgRatio(), 0.3);
+    ASSERT_DOUBLE_EQ(ac.GetAvgNsPerByte(), 5.0);
+    ASSERT_EQ(ac.GetLevel(), std::optional<int>(6));
+    ASSERT_FALSE(ac.IsLevelReduced());
+    ASSERT_EQ(ac.TakeSkipCount(), 0U);
+  }
+
+  TEST_F(TAdaptiveCompressionTest, IncompressibleTest) {
+    using TState = TAdaptiveCompression::TState;
+    TAdaptiveCompression ac(MakeConf(2, 5, 0), 0.75f, std::nullopt,
+        std::nullopt);
+
+    for (size_t i = 0; i < 2; ++i) {
+      ASSERT_TRUE(ac.ShouldCompress());
+      ac.RecordResult(1000, 990, 1000);
+    }
+
+    ASSERT_EQ(ac.GetState(), TState::Skipping);
+
+    /* Every 5th message set gets compressed as a sample. */
+    for (size_t i = 0; i < 4; ++i) {
+      ASSERT_FALSE(ac.ShouldCompress());
+    }
+
+    ASSERT_TRUE(ac.ShouldCompress());
+    ASSERT_EQ(ac.TakeSkipCount(), 4U);
+    ASSERT_EQ(ac.TakeSkipCount(), 0U);
+    ac.RecordResult(1000, 995, 1000);
+    ASSERT_EQ(ac.GetState(), TState::Skipping);
+
+    for (size_t i = 0; i < 4; ++i) {
+      ASSERT_FALSE(ac.ShouldCompress());
+    }
+
+    /* The data has become compressible. */
+    ASSERT_TRUE(ac.ShouldCompress());
+    ac.RecordResult(1000, 200, 1000);
+    ASSERT_EQ(ac.GetState(), TState::Learning);
+    ASSERT_EQ(ac.GetSampleCount(), 1U);
+    ASSERT_DOUBLE_EQ(ac.GetAvgRatio(), 0.2);
+    ASSERT_TRUE(ac.ShouldCompress());
+    ac.RecordResult(1000, 200, 1000);
+    ASSERT_EQ(ac.GetState(), TState::Compressing);
+  }
+
+  TEST_F(TAdaptiveCompressionTest, CpuBudgetTest) {
+    using TState = TAdaptiveCompression::TState;
+    TAdaptiveCompression ac(MakeConf(2, 10, 20), 0.75f, 9, 1);
+
+    for (size_t i = 0; i < 2; ++i) {
+      ASSERT_TRUE(ac.ShouldCompress());
+      ac.RecordResult(1000, 300, 50000);
+    }
+
+    /* Too slow, so switch to the fastest level and start over. */
+    ASSERT_EQ(ac.GetState(), TState::Learning);
+    ASSERT_EQ(ac.GetLevel(), std::optional<int>(1));
+    ASSERT_TRUE(ac.IsLevelReduced());
+    ASSERT_EQ(ac.GetSampleCount(), 0U);
+
+    /* Still too slow at the fastest level.  There is nothing more to try, so
+       keep compressing. */
+    for (size_t i = 0; i < 2; ++i) {
+      ASSERT_TRUE(ac.ShouldCompress());
+      ac.RecordResult(1000, 400, 40000);
+    }
+
+    ASSERT_EQ(ac.GetState(), TState::Compressing);
+    ASSERT_EQ(ac.GetLevel(), std::optional<int>(1));
+  }
+
+  TEST_F(TAdaptiveCompressionTest, ToStringTest) {
+    using TState = TAdaptiveCompression::TState;
+    ASSERT_STREQ(ToString(TState::Learning), "learning");
+    ASSERT_STREQ(ToString(TState::Compressing), "compressing");
+    ASSERT_STREQ(ToString(TState::Skipping), "skipping");
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
@@ -23,8 +23,10 @@
 
 #include <algorithm>
 #include <cassert>
+#include <string>
 
 #include <base/counter.h>
+#include <base/time_util.h>
 #include <dory/msg_state_tracker.h>
 
 using namespace Base;
@@ -40,6 +42,9 @@ DEFINE_COUNTER(NoBatchAnyPartition);
 DEFINE_COUNTER(NoBatchPartitionKey);
 DEFINE_COUNTER(PerTopicBatchPartitionKey);
 
+/* Weight given to each new sample in moving average of broker ACK latency. */
+static const double ACK_LATENCY_WEIGHT = 0.25;
+
 static std::optional<TMsg::TTimestamp>
 min_opt_ts(const std::optional<TMsg::TTimestamp> &t1,
     const std::optional<TMsg::TTimestamp> &t2) {
@@ -60,148 +65,50 @@ min_opt_ts(const std::optional<TMsg::TTimestamp> &t1,
 
 TBrokerMsgQueue::TBrokerMsgQueue(const TGlobalBatchConfig &batch_config,
     TMsgStateTracker &msg_state_tracker)
-    : PerTopicBatcher(batch_config.GetPerTopicConfig()),
+    : PerTopicBatcher(batch_config.GetPerTopicConfig(),
+          TPerTopicBatcher::TGrouping::ByPartition),
       CombinedTopicsBatcher(batch_config.GetCombinedTopicsConfig()),
       MsgStateTracker(msg_state_tracker) {
 }
 
-void TBrokerMsgQueue::Put(TMsg::TTimestamp now, TMsg::TPtr &&msg) {
+void TBrokerMsgQueue::Put(TMsg::TTimestamp /*now*/, TMsg::TPtr &&msg) {
   assert(msg);
-  TExpiryStatus per_topic_status, combined_topics_status;
-  bool ready_list_empty_initial = false;
-  bool ready_list_empty_final = false;
-
-  {
-    std::lock_guard<std::mutex> lock(Mutex);
-    ready_list_empty_initial = ReadyList.empty();
-    TryBatchPerTopic(now, std::move(msg), per_topic_status);
-
-    if (msg) {
-      TMsg::TRoutingType routing_type = msg->GetRoutingType();
-      TryBatchCombinedTopics(now, std::move(msg), combined_topics_status);
-
-      if (msg) {
-        MsgStateTracker.MsgEnterSendWait(*msg);
-        std::list<TMsg::TPtr> single_item_list;
-        single_item_list.push_back(std::move(msg));
-        ReadyList.push_back(std::move(single_item_list));
-
-        if (routing_type == TMsg::TRoutingType::PartitionKey) {
-          NoBatchPartitionKey.Increment();
-        } else {
-          assert(routing_type == TMsg::TRoutingType::AnyPartition);
-          NoBatchAnyPartition.Increment();
-        }
-      } else {
-        if (routing_type == TMsg::TRoutingType::PartitionKey) {
-          CombinedTopicsBatchPartitionKey.Increment();
-        } else {
-          assert(routing_type == TMsg::TRoutingType::AnyPartition);
-          CombinedTopicsBatchAnyPartition.Increment();
-        }
-      }
-    } else {
-      PerTopicBatchPartitionKey.Increment();
-      combined_topics_status.OptInitialExpiry =
-          CombinedTopicsBatcher.GetNextCompleteTime();
-      combined_topics_status.OptFinalExpiry =
-          combined_topics_status.OptInitialExpiry;
-    }
-
-    ready_list_empty_final = ReadyList.empty();
-  }
-
-  bool notify = (ready_list_empty_initial && !ready_list_empty_final);
-
-  if (!notify) {
-    auto min_initial_expiry = min_opt_ts(per_topic_status.OptInitialExpiry,
-        combined_topics_status.OptInitialExpiry);
-    auto min_final_expiry = min_opt_ts(per_topic_status.OptFinalExpiry,
-        combined_topics_status.OptFinalExpiry);
-
-    if (min_final_expiry &&
-        (!min_initial_expiry || (*min_final_expiry < *min_initial_expiry))) {
-      notify = true;
-    }
-  }
-
-  if (notify) {
-    BrokerMsgQueueNotify.Increment();
-    SenderNotify.Push();
-  } else {
-    BrokerMsgQueueSkipNotify.Increment();
-  }
+  TStagedItem item;
+  item.Msg = std::move(msg);
+  Stage(std::move(item));
 }
 
-void TBrokerMsgQueue::PutNow(TMsg::TTimestamp now, TMsg::TPtr &&msg) {
+void TBrokerMsgQueue::PutNow(TMsg::TTimestamp /*now*/, TMsg::TPtr &&msg) {
   assert(msg);
   MsgStateTracker.MsgEnterSendWait(*msg);
-  std::list<TMsg::TPtr> single_item_list;
-  single_item_list.push_back(std::move(msg));
-  TExpiryStatus per_topic_status, combined_topics_status;
-  bool was_empty = false;
-
-  {
-    std::lock_guard<std::mutex> lock(Mutex);
-    was_empty = ReadyList.empty();
-
-    /* Transfer any ready batches from the batchers to 'ReadyList'. */
-    CheckBothBatchers(now, per_topic_status, combined_topics_status);
-
-    ReadyList.push_back(std::move(single_item_list));
-  }
-
-  if (was_empty) {
-    BrokerMsgQueueNotify.Increment();
-    SenderNotify.Push();
-  } else {
-    BrokerMsgQueueSkipNotify.Increment();
-  }
+  TStagedItem item;
+  item.Msg = std::move(msg);
+  item.Now = true;
+  Stage(std::move(item));
 }
 
-void TBrokerMsgQueue::PutNow(TMsg::TTimestamp now,
+void TBrokerMsgQueue::PutNow(TMsg::TTimestamp /*now*/,
     std::list<std::list<TMsg::TPtr>> &&batch) {
   if (batch.empty()) {
     return;
   }
 
   MsgStateTracker.MsgEnterSendWait(batch);
-  TExpiryStatus per_topic_status, combined_topics_status;
-  bool was_empty = false;
-
-  {
-    std::lock_guard<std::mutex> lock(Mutex);
-    was_empty = ReadyList.empty();
-
-    /* Transfer any ready batches from the batchers to 'ReadyList'. */
-    CheckBothBatchers(now, per_topic_status, combined_topics_status);
-
-    ReadyList.splice(ReadyList.end(), std::move(batch));
-    assert(!ReadyList.empty());
-  }
-
-  if (was_empty) {
-    BrokerMsgQueueNotify.Increment();
-    SenderNotify.Push();
-  } else {
-    BrokerMsgQueueSkipNotify.Increment();
-  }
+  TStagedItem item;
+  item.Batch = std::move(batch);
+  Stage(std::move(item));
 }
 
 bool TBrokerMsgQueue::NonblockingGet(TMsg::TTimestamp now,
     TMsg::TTimestamp &next_batch_complete_time,
     std::list<std::list<TMsg::TPtr>> &ready_msgs) {
+  ProcessStagedItems(now);
   TExpiryStatus per_topic_status, combined_topics_status;
 
-  {
-    std::lock_guard<std::mutex> lock(Mutex);
-
-    /* Transfer any ready batches from the batchers to 'ReadyList'. */
-    CheckBothBatchers(now, per_topic_status, combined_topics_status);
-
-    ready_msgs.splice(ready_msgs.end(), std::move(ReadyList));
-  }
+  /* Transfer any ready batches from the batchers to 'ReadyList'. */
+  CheckBothBatchers(now, per_topic_status, combined_topics_status);
 
+  ready_msgs.splice(ready_msgs.end(), std::move(ReadyList));
   auto opt_next_expiry = min_opt_ts(per_topic_status.OptFinalExpiry,
       combined_topics_status.OptFinalExpiry);
 
@@ -214,53 +121,124 @@ bool TBrokerMsgQueue::NonblockingGet(TMsg::TTimestamp now,
 }
 
 std::list<std::list<TMsg::TPtr>> TBrokerMsgQueue::GetAllOnShutdown() {
-  std::lock_guard<std::mutex> lock(Mutex);
+  ProcessStagedItems(GetEpochMilliseconds());
   return GetAllMsgs();
 }
 
 std::list<std::list<TMsg::TPtr>> TBrokerMsgQueue::Reset() {
   SenderNotify.Reset();
+  ProcessStagedItems(GetEpochMilliseconds());
   return GetAllMsgs();
 }
 
-void TBrokerMsgQueue::TryBatchPerTopic(TMsg::TTimestamp now,
-    TMsg::TPtr &&msg_ptr, TExpiryStatus &expiry_status) {
-  expiry_status.Clear();
+void TBrokerMsgQueue::ReportAckLatency(uint64_t ack_latency) noexcept {
+  const auto sample = static_cast<double>(ack_latency);
+  AvgAckLatency = (AvgAckLatency < 0.0) ? sample :
+      (ACK_LATENCY_WEIGHT * sample) +
+          ((1.0 - ACK_LATENCY_WEIGHT) * AvgAckLatency);
+  const auto avg = static_cast<size_t>(AvgAckLatency + 0.5);
+  PerTopicBatcher.SetAckLatency(avg);
+  CombinedTopicsBatcher.SetAckLatency(avg);
+}
+
+void TBrokerMsgQueue::Stage(TStagedItem &&item) {
+  /* The connector thread empties the staging area each time it handles a
+     notification, so it only needs to be notified when the staging area
+     becomes nonempty.  It computes any change in batch expiry itself when it
+     processes the staged items. */
+  if (Staging.Push(std::move(item))) {
+    BrokerMsgQueueNotify.Increment();
+    SenderNotify.Push();
+  } else {
+    BrokerMsgQueueSkipNotify.Increment();
+  }
+}
 
-  if (!PerTopicBatcher.IsEnabled()) {
+void TBrokerMsgQueue::ProcessStagedItems(TMsg::TTimestamp now) {
+  Staging.Consume(
+      [this, now](TStagedItem &&item) {
+        if (!item.Msg) {
+          assert(!item.Batch.empty());
+          ReadyList.splice(ReadyList.end(), std::move(item.Batch));
+        } else if (item.Now) {
+          std::list<TMsg::TPtr> single_item_list;
+          single_item_list.push_back(std::move(item.Msg));
+          ReadyList.push_back(std::move(single_item_list));
+        } else {
+          BatchMsg(now, std::move(item.Msg));
+        }
+      });
+}
+
+void TBrokerMsgQueue::BatchMsg(TMsg::TTimestamp now, TMsg::TPtr &&msg) {
+  assert(msg);
+  TMsg::TRoutingType routing_type = msg->GetRoutingType();
+  TryBatchPerTopic(now, std::move(msg));
+
+  if (!msg) {
+    PerTopicBatchPartitionKey.Increment();
     return;
   }
 
-  expiry_status.OptInitialExpiry = PerTopicBatcher.GetNextCompleteTime();
+  TryBatchCombinedTopics(now, std::move(msg));
 
-  if (msg_ptr->GetRoutingType() == TMsg::TRoutingType::PartitionKey) {
-    TMsg &msg = *msg_ptr;
-    std::list<std::list<TMsg::TPtr>> batch_list =
-        PerTopicBatcher.AddMsg(std::move(msg_ptr), now);
-
-    /* Note: msg_ptr may still contain the message here, since the batcher only
-       accepts messages when appropriate.  If msg_ptr is empty, then the
-       batcher now contains the message so we transition its state to batching.
-     */
-    if (!msg_ptr) {
-      MsgStateTracker.MsgEnterBatching(msg);
+  if (!msg) {
+    if (routing_type == TMsg::TRoutingType::PartitionKey) {
+      CombinedTopicsBatchPartitionKey.Increment();
+    } else {
+      assert(routing_type == TMsg::TRoutingType::AnyPartition);
+      CombinedTopicsBatchAnyPartition.Increment();
     }
 
-    MsgStateTracker.MsgEnterSendWait(batch_list);
-    ReadyList.splice(ReadyList.end(), std::move(batch_list));
-    expiry_status.OptFinalExpiry = PerTopicBatcher.GetNextCompleteTime();
+    return;
+  }
+
+  MsgStateTracker.MsgEnterSendWait(*msg);
+  std::list<TMsg::TPtr> single_item_list;
+  single_item_list.push_back(std::move(msg));
+  ReadyList.push_back(std::move(single_item_list));
+
+  if (routing_type == TMsg::TRoutingType::PartitionKey) {
+    NoBatchPartitionKey.Increment();
   } else {
-    expiry_status.OptFinalExpiry = expiry_status.OptInitialExpiry;
+    assert(routing_type == TMsg::TRoutingType::AnyPartition);
+    NoBatchAnyPartition.Increment();
   }
 }
 
+void TBrokerMsgQueue::TryBatchPerTopic(TMsg::TTimestamp now,
+    TMsg::TPtr &&msg_ptr) {
+  if (!PerTopicBatcher.IsEnabled() ||
+      (msg_ptr->GetRoutingType() != TMsg::TRoutingType::PartitionKey)) {
+    return;
+  }
+
+  TMsg &msg = *msg_ptr;
+  std::list<std::list<TMsg::TPtr>> batch_list =
+      PerTopicBatcher.AddMsg(std::move(msg_ptr), now);
+
+  /* Note: msg_ptr may still contain the message here, since the batcher only
+     accepts messages when appropriate.  If msg_ptr is empty, then the batcher
+     now contains the message so we transition its state to batching. */
+  if (!msg_ptr) {
+    MsgStateTracker.MsgEnterBatching(msg);
+  }
+
+  MsgStateTracker.MsgEnterSendWait(batch_list);
+  ReadyList.splice(ReadyList.end(), std::move(batch_list));
+}
+
 void TBrokerMsgQueue::TryBatchCombinedTopics(TMsg::TTimestamp now,
-    TMsg::TPtr &&msg_ptr, TExpiryStatus &expiry_status) {
-  expiry_status.OptInitialExpiry = CombinedTopicsBatcher.GetNextCompleteTime();
+    TMsg::TPtr &&msg_ptr) {
   TMsg &msg = *msg_ptr;
   std::list<std::list<TMsg::TPtr>> batch_list =
       CombinedTopicsBatcher.AddMsg(std::move(msg_ptr), now);
 
+  if (CombinedTopicsBatcher.TakeLingerUpdate() && LingerStats) {
+    LingerStats->Update(std::string(), LingerStatsBrokerId,
+        *CombinedTopicsBatcher.GetAdaptiveLinger());
+  }
+
   /* Note: msg_ptr may still contain the message here, since the batcher only
      accepts messages when appropriate.  If msg_ptr is empty, then the batcher
      now contains the message so we transition its state to batching.
@@ -271,7 +249,6 @@ void TBrokerMsgQueue::TryBatchCombinedTopics(TMsg::TTimestamp now,
 
   MsgStateTracker.MsgEnterSendWait(batch_list);
   ReadyList.splice(ReadyList.end(), std::move(batch_list));
-  expiry_status.OptFinalExpiry = CombinedTopicsBatcher.GetNextCompleteTime();
 }
 
 std::list<std::list<TMsg::TPtr>>
@@ -17,24 +17,25 @@
    ----------------------------------------------------------------------------
 
    A queue of messages waiting to be sent to a broker.  Each connector thread
-   maintains one of these.  Broker-level batching is done here.
+   maintains one of these.  Broker-level batching is done here, by the
+   connector thread.
  */
 
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <list>
-#include <mutex>
 #include <optional>
-#include <string>
-#include <unordered_set>
 
 #include <base/event_semaphore.h>
 #include <base/fd.h>
 #include <base/no_copy_semantics.h>
+#include <base/spsc_queue.h>
 #include <dory/batch/combined_topics_batcher.h>
 #include <dory/batch/global_batch_config.h>
 #include <dory/batch/per_topic_batcher.h>
+#include <dory/linger_stats.h>
 #include <dory/msg.h>
 #include <dory/msg_state_tracker.h>
 
@@ -49,31 +50,19 @@ namespace Dory {
       TBrokerMsgQueue(const Batch::TGlobalBatchConfig &batch_config,
           TMsgStateTracker &msg_state_tracker);
 
-      /* Returns an FD that becomes readable when an incoming message or batch
-         of messages from the router thread triggers one of the following
-         conditions:
-
-             1.  The queue of messages ready to be immediately sent becomes
-                 nonempty.
-
-             2.  A batching time limit becomes set when no time limit was
-                 previously set, or the time limit changes to an earlier value.
-       */
+      /* Returns an FD that becomes readable when the router thread puts
+         messages into the queue while its staging area is empty.  The
+         connector thread then calls Get(), which moves everything out of the
+         staging area, so the next message put into the queue will make the FD
+         readable again. */
       const Base::TFd &GetSenderNotifyFd() {
         return SenderNotify.GetFd();
       }
 
-      /* Put 'msg' into the queue, batching it at the broker level if
-         appropriate.  The FD returned by GetSenderNotifyFd() will become
-         readable if this triggers at least one of the following conditions:
-
-             1.  The batcher expiration time changes (or becomes defined due to
-                 the batcher becoming nonempty).
-
-             2.  The ready list was previously empty and now is nonempty.
-
-         In either case, the queue needs attention from its connector thread.
-       */
+      /* Put 'msg' into the queue, to be batched at the broker level if
+         appropriate.  This is called only by the router thread, and doesn't
+         block or acquire any locks.  Batching is done by the connector thread
+         when it gets the message from the queue. */
       void Put(TMsg::TTimestamp now, TMsg::TPtr &&msg);
 
       /* Same as above, but 'msg' bypasses broker-level batching. */
@@ -108,17 +97,43 @@ namespace Dory {
                           TMsg::TTimestamp &next_batch_complete_time,
                           std::list<std::list<TMsg::TPtr>> &ready_msgs);
 
-      /* Get entire contents of batcher and ready list, regardless of batch
-         state.  Avoid popping the semaphore. */
+      /* Report adaptive linger time limits to 'stats', with 'broker_id'
+         identifying this queue.  This must be called before the connector
+         thread starts. */
+      void SetLingerStats(TLingerStats *stats, long broker_id) noexcept {
+        LingerStats = stats;
+        LingerStatsBrokerId = broker_id;
+        PerTopicBatcher.SetLingerStats(stats, broker_id);
+      }
+
+      /* Called by connector thread when it gets a produce response, with
+         'ack_latency' giving the time in milliseconds since the corresponding
+         request was sent.  Batchers with adaptive linger enabled use a moving
+         average of this. */
+      void ReportAckLatency(uint64_t ack_latency) noexcept;
+
+      /* Get entire contents of staging area, batcher, and ready list,
+         regardless of batch state.  Avoid popping the semaphore. */
       std::list<std::list<TMsg::TPtr>> GetAllOnShutdown();
 
       /* Reset the queue to its initial state and return all messages it
          formerly contained.  Intended to be called _after_ the connector
-         thread has been shut down, and therefore does _not_ acquire 'Mutex'.
-       */
+         thread has been shut down. */
       std::list<std::list<TMsg::TPtr>> Reset();
 
       private:
+      /* An item passed from the router thread to the connector thread. */
+      struct TStagedItem {
+        /* A single message, or null if the item is a batch. */
+        TMsg::TPtr Msg;
+
+        /* True if 'Msg' should bypass broker-level batching. */
+        bool Now = false;
+
+        /* Per-topic lists of messages that bypass broker-level batching. */
+        std::list<std::list<TMsg::TPtr>> Batch;
+      };  // TStagedItem
+
       struct TExpiryStatus {
         std::optional<TMsg::TTimestamp> OptInitialExpiry;
 
@@ -130,11 +145,17 @@ namespace Dory {
         }
       };  // TExpiryStatus
 
-      void TryBatchPerTopic(TMsg::TTimestamp now, TMsg::TPtr &&msg_ptr,
-          TExpiryStatus &expiry_status);
+      void Stage(TStagedItem &&item);
 
-      void TryBatchCombinedTopics(TMsg::TTimestamp now, TMsg::TPtr &&msg_ptr,
-          TExpiryStatus &expiry_status);
+      /* Called by connector thread to move all items from 'Staging' into the
+         batchers or 'ReadyList'. */
+      void ProcessStagedItems(TMsg::TTimestamp now);
+
+      void BatchMsg(TMsg::TTimestamp now, TMsg::TPtr &&msg);
+
+      void TryBatchPerTopic(TMsg::TTimestamp now, TMsg::TPtr &&msg_ptr);
+
+      void TryBatchCombinedTopics(TMsg::TTimestamp now, TMsg::TPtr &&msg_ptr);
 
       std::list<std::list<TMsg::TPtr>>
       CheckPerTopicBatcher(TMsg::TTimestamp now, TExpiryStatus &expiry_status);
@@ -153,13 +174,19 @@ namespace Dory {
          the queue needs attention. */
       Base::TEventSemaphore SenderNotify;
 
-      /* Protects 'PerTopicBatcher', 'CombinedTopicsBatcher', and 'ReadyList'
-         from concurrent access by router thread and kafka dispatcher connector
-         threads. */
-      std::mutex Mutex;
+      /* The router thread puts messages here, and the connector thread takes
+         them out.  This is the only state shared by the two threads, so they
+         don't contend for a lock on each message. */
+      Base::TSpscQueue<TStagedItem> Staging;
+
+      /* The remaining members are accessed only by the connector thread. */
 
       /* Per-topic batching for PartitionKey messages is done here.  Per-topic
-         batching for AnyPartition messages is done by the router thread. */
+         batching for AnyPartition messages is done by the router thread.
+         Since the router thread has already chosen a partition for each
+         PartitionKey message, batches are kept per partition.  Batching limits
+         then apply to each partition's message set in a produce request,
+         rather than being spread across all of a topic's partitions. */
       Batch::TPerTopicBatcher PerTopicBatcher;
 
       /* Messages being batched at the broker level, not on a per-topic basis.
@@ -170,6 +197,14 @@ namespace Dory {
       std::list<std::list<TMsg::TPtr>> ReadyList;
 
       TMsgStateTracker &MsgStateTracker;
+
+      /* Moving average of broker ACK latency in milliseconds.  Negative until
+         the first ACK. */
+      double AvgAckLatency = -1.0;
+
+      TLingerStats *LingerStats = nullptr;
+
+      long LingerStatsBrokerId = 0;
     };  // TBrokerMsgQueue
 
   }  // MsgDispatch
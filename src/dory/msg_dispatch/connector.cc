@@ -40,10 +40,14 @@
 #include <base/time_util.h>
 #include <base/wr/fd_util.h>
 #include <base/wr/net_util.h>
+#include <dory/kafka_proto/api_versions/api_versions.h>
+#include <dory/kafka_proto/produce/version_util.h>
 #include <dory/kafka_proto/request_response.h>
 #include <dory/msg_dispatch/produce_response_processor.h>
 #include <dory/msg_state_tracker.h>
+#include <dory/profiler.h>
 #include <dory/util/connect_to_host.h>
+#include <dory/util/get_broker_api_versions.h>
 #include <log/log.h>
 #include <socket/db/error.h>
 
@@ -55,6 +59,7 @@ using namespace Dory;
 using namespace Dory::Batch;
 using namespace Dory::Debug;
 using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::ApiVersions;
 using namespace Dory::KafkaProto::Produce;
 using namespace Dory::MsgDispatch;
 using namespace Dory::Util;
@@ -71,6 +76,10 @@ DEFINE_COUNTER(ConnectorConnectSuccess);
 DEFINE_COUNTER(ConnectorDoSocketRead);
 DEFINE_COUNTER(ConnectorFinishRun);
 DEFINE_COUNTER(ConnectorFinishWaitShutdownAck);
+DEFINE_COUNTER(ConnectorGetApiVersionsFail);
+DEFINE_COUNTER(ConnectorMetadataUpdate);
+DEFINE_COUNTER(ConnectorNoCommonProduceApiVersion);
+DEFINE_COUNTER(ConnectorParkUnsendableMsgs);
 DEFINE_COUNTER(ConnectorSocketBrokerClose);
 DEFINE_COUNTER(ConnectorSocketError);
 DEFINE_COUNTER(ConnectorSocketReadSuccess);
@@ -91,7 +100,8 @@ TConnector::TConnector(size_t my_broker_index, TDispatcherSharedState &ds)
       InputQueue(ds.BatchConfig, ds.MsgStateTracker),
       /* TODO: rethink DebugLogger stuff */
       RequestFactory(ds.Conf, ds.BatchConfig, ds.Conf.CompressionConf,
-                     ds.ProduceProtocol, my_broker_index),
+                     ds.ProduceProtocol, my_broker_index,
+                     ds.CompressionStats),
       ResponseReader(ds.ProduceProtocol->CreateProduceResponseReader()),
       /* Note: The max message body size value is a loose upper bound to guard
          against a response with a ridiculously large size field. */
@@ -111,7 +121,10 @@ TConnector::~TConnector() {
 void TConnector::SetMetadata(const std::shared_ptr<TMetadata> &md) {
   assert(md);
   Metadata = md;
+  MetadataGeneration = Ds.PublishedMetadata.GetGeneration();
   RequestFactory.Init(Ds.Conf.CompressionConf, md);
+  InputQueue.SetLingerStats(&Ds.LingerStats, MyBrokerId());
+  RttHistogram = &Ds.LatencyStats.GetBrokerRttHistogram(MyBrokerId());
 }
 
 void TConnector::StartSlowShutdown(uint64_t start_time) {
@@ -214,6 +227,8 @@ void TConnector::Run() {
     broker_id = MyBrokerId();
     LOG(TPri::NOTICE) << "Connector thread " << Gettid() << " (index "
         << MyBrokerIndex << " broker " << broker_id << ") started";
+    TProfiler::TThreadBinding profile(Ds.Profiler,
+        "connector broker " + std::to_string(broker_id));
     DoRun();
   } catch (const TShutdownOnDestroy &) {
     /* Nothing to do here. */
@@ -271,10 +286,58 @@ bool TConnector::DoConnect() {
   return true;
 }
 
+bool TConnector::ChooseProduceApiVersion() {
+  const TMetadata::TBroker &broker = MyBroker();
+  const Conf::TConf &conf = Ds.Conf;
+
+  if (!conf.KafkaConfigConf.ApiVersionRequest) {
+    Ds.ApiVersionStats.RecordProduceApiVersion(broker.GetHostname(),
+        broker.GetPort(), broker.GetId(), {},
+        conf.KafkaConfigConf.ProduceApiVersion);
+    return true;
+  }
+
+  auto broker_versions = GetBrokerApiVersions(Sock,
+      static_cast<int>(conf.MsgDeliveryConf.KafkaSocketTimeout * 1000));
+
+  if (!broker_versions) {
+    ConnectorGetApiVersionsFail.Increment();
+    LOG(TPri::ERR) << "Starting pause on failure to get API versions from "
+        << "broker " << broker.GetId();
+    return false;
+  }
+
+  std::optional<size_t> version = ChooseHighestCommonVersion(
+      GetSupportedProduceApiVersions(), *broker_versions, PRODUCE_API_KEY);
+
+  if (!version) {
+    ConnectorNoCommonProduceApiVersion.Increment();
+    LOG(TPri::ERR) << "Starting pause: broker " << broker.GetId()
+        << " supports no produce API version that dory supports";
+    return false;
+  }
+
+  std::shared_ptr<TProduceProtocol> protocol(ChooseProduceProto(*version));
+  assert(protocol);
+  RequestFactory.SetProduceProtocol(protocol);
+  ResponseReader = protocol->CreateProduceResponseReader();
+  Ds.ApiVersionStats.RecordProduceApiVersion(broker.GetHostname(),
+      broker.GetPort(), broker.GetId(), *broker_versions, *version);
+  LOG(TPri::NOTICE) << "Connector thread " << Gettid() << " (index "
+      << MyBrokerIndex << " broker " << broker.GetId()
+      << ") using produce API version " << *version;
+  return true;
+}
+
 bool TConnector::ConnectToBroker() {
   ConnectorStartConnect.Increment();
   bool success = DoConnect();
 
+  if (success && !ChooseProduceApiVersion()) {
+    Sock.Reset();
+    success = false;
+  }
+
   if (success) {
     ConnectorConnectSuccess.Increment();
   } else {
@@ -321,7 +384,12 @@ void TConnector::HandleShutdownRequest() {
   }
 
   assert(OptShutdownCmd);
-  const TShutdownCmd &cmd = *OptShutdownCmd;
+  ApplyShutdownCmd(*OptShutdownCmd);
+  ShutdownAck.Push();
+  ClearShutdownRequest();
+}
+
+void TConnector::ApplyShutdownCmd(const TShutdownCmd &cmd) {
   bool is_fast = !cmd.OptSlowShutdownStartTime;
 
   if (is_fast) {
@@ -346,8 +414,6 @@ void TConnector::HandleShutdownRequest() {
   LOG(TPri::NOTICE) << "Connector thread " << Gettid() << " (index "
       << MyBrokerIndex << " broker " << MyBrokerId() << ") sending ACK for "
       << (is_fast ? "fast" : "slow") << " shutdown";
-  ShutdownAck.Push();
-  ClearShutdownRequest();
 }
 
 void TConnector::SetPauseInProgress() {
@@ -363,6 +429,7 @@ void TConnector::HandlePauseDetected() {
 }
 
 void TConnector::CheckInputQueue(uint64_t now, bool pop_sem) {
+  TProfiler::TPhaseScope input_phase(TProfiler::TPhase::InputQueue);
   ConnectorCheckInputQueue.Increment();
   std::list<std::list<TMsg::TPtr>> ready_msgs;
   TMsg::TTimestamp expiry = 0;
@@ -378,6 +445,51 @@ void TConnector::CheckInputQueue(uint64_t now, bool pop_sem) {
   RequestFactory.Put(std::move(ready_msgs));
 }
 
+void TConnector::ParkUnsendableMsgs(std::list<std::list<TMsg::TPtr>> &batch) {
+  std::list<std::list<TMsg::TPtr>> to_park =
+      TakeUnsendableMsgs(batch, *Metadata, MyBrokerIndex);
+
+  if (!to_park.empty()) {
+    ConnectorParkUnsendableMsgs.Increment();
+    LOG_R(TPri::WARNING, std::chrono::seconds(30)) << "Connector thread "
+        << Gettid() << " (index " << MyBrokerIndex << " broker "
+        << MyBrokerId() << ") returning msgs for topic(s) no longer led by "
+        << "broker to router thread after metadata update";
+    Ds.MsgStateTracker.MsgEnterSendWait(to_park);
+    Ds.PartitionRetryQueue.Put(std::move(to_park));
+  }
+}
+
+void TConnector::CheckMetadataUpdate(uint64_t now) {
+  std::shared_ptr<TMetadata> md =
+      Ds.PublishedMetadata.GetIfNewer(MetadataGeneration);
+
+  if (!md) {
+    return;
+  }
+
+  assert(md->GetBrokers() == Metadata->GetBrokers());
+  ConnectorMetadataUpdate.Increment();
+  LOG(TPri::NOTICE) << "Connector thread " << Gettid() << " (index "
+      << MyBrokerIndex << " broker " << MyBrokerId()
+      << ") switching to updated metadata without restart";
+  Metadata = md;
+  RequestFactory.UpdateMetadata(md);
+
+  /* The router thread switches to new metadata before publishing it, so any
+     message it routed based on the old metadata is already either in our
+     input queue or in 'RequestFactory'.  Some of these messages may now be
+     unsendable from here, so check once all messages that are ready to send.
+     Messages routed after this point are based on the new metadata, and need
+     no checking.  Partial batches stay in the input queue so that a metadata
+     update doesn't cut them short.  If any of them turn out to be unsendable,
+     the broker's error ACK sends them to the partition retry queue. */
+  CheckInputQueue(now, false);
+  std::list<std::list<TMsg::TPtr>> queued = RequestFactory.GetAll();
+  ParkUnsendableMsgs(queued);
+  RequestFactory.Put(std::move(queued));
+}
+
 bool TConnector::TrySendProduceRequest() {
   ssize_t ret = Wr::send(Wr::TDisp::Nonfatal, LostTcpConnectionErrorCodes,
       Sock, SendBuf.Data(), SendBuf.DataSize(), MSG_NOSIGNAL);
@@ -406,6 +518,7 @@ bool TConnector::HandleSockWriteReady() {
   /* See whether we are starting a new produce request, or continuing a
      partially sent one. */
   if (!SendInProgress()) {
+    TProfiler::TPhaseScope build_phase(TProfiler::TPhase::RequestBuild);
     std::vector<uint8_t> buf(SendBuf.TakeStorage());
 
     // Assigning directly to CurrentRequest would be simpler, but causes a
@@ -425,6 +538,8 @@ bool TConnector::HandleSockWriteReady() {
     assert(!SendBuf.DataIsEmpty());
   }
 
+  TProfiler::TPhaseScope send_phase(TProfiler::TPhase::Send);
+
   if (!TrySendProduceRequest()) {
     /* Socket error on attempted send: pause has been initiated.  Leave
        'CurrentRequest' in place, and the messages it contains will be
@@ -456,6 +571,7 @@ bool TConnector::HandleSockWriteReady() {
 
     if (ack_expected) {
       AckWaitQueue.emplace_back(std::move(*CurrentRequest));
+      AckWaitSendTimes.push_back(GetMonotonicRawMicroseconds());
     }
 
     CurrentRequest.reset();
@@ -471,8 +587,21 @@ bool TConnector::ProcessSingleProduceResponse() {
   bool pause = false;
   TProduceRequest request(std::move(AckWaitQueue.front()));
   AckWaitQueue.pop_front();
+  assert(!AckWaitSendTimes.empty());
+  const uint64_t send_time = AckWaitSendTimes.front();
+  AckWaitSendTimes.pop_front();
+  const uint64_t now = GetMonotonicRawMicroseconds();
+  const uint64_t rtt = (now > send_time) ? (now - send_time) : 0;
+  assert(RttHistogram);
+  RttHistogram->Record(rtt);
+  InputQueue.ReportAckLatency(rtt / 1000);
+
+  /* Partition retry is disabled once a shutdown is in progress.  The
+     dispatcher will soon be restarted or stopped anyway, so fall back to the
+     normal pause handling. */
   TProduceResponseProcessor processor(*ResponseReader, Ds, DebugLoggerReceive,
-      MyBrokerIndex, MyBrokerId());
+      MyBrokerIndex, MyBrokerId(),
+      Ds.Conf.MsgDeliveryConf.PartitionRetry && !OptInProgressShutdown);
 
   try {
     switch (processor.ProcessResponse(request, StreamReader.GetReadyMsg(),
@@ -554,6 +683,8 @@ bool TConnector::ProcessSingleProduceResponse() {
            loop will call us again when appropriate. */
 bool TConnector::HandleSockReadReady() {
   assert(!AckWaitQueue.empty());
+  TProfiler::TPhaseScope response_phase(
+      TProfiler::TPhase::ResponseProcessing);
   TStreamMsgReader::TState reader_state = TStreamMsgReader::TState::AtEnd;
 
   try {
@@ -624,6 +755,7 @@ bool TConnector::HandleSockReadReady() {
 }
 
 bool TConnector::PrepareForPoll(uint64_t now, int &poll_timeout) {
+  CheckMetadataUpdate(now);
   poll_timeout = -1;
   bool need_sock_write = false;
   bool need_sock_read = !AckWaitQueue.empty();
@@ -721,15 +853,73 @@ bool TConnector::PrepareForPoll(uint64_t now, int &poll_timeout) {
   return true;
 }
 
-void TConnector::DoRun() {
+bool TConnector::StartConnection() {
   OkShutdown = false;
-  long broker_id = MyBrokerId();
 
   if (!ConnectToBroker()) {
-    return;
+    return false;
   }
 
   StreamReader.Reset(Sock);
+  return true;
+}
+
+bool TConnector::HandleEvents(uint64_t start_time, uint64_t finish_time,
+    bool timed_out) {
+  if (timed_out) {
+    if ((MainLoopPollArray[TMainLoopPollItem::SockIo].fd >= 0) &&
+        ((finish_time - start_time) >=
+            (Ds.Conf.MsgDeliveryConf.KafkaSocketTimeout * 1000))) {
+      LOG(TPri::ERR) << "Connector thread " << Gettid() << " (index "
+          << MyBrokerIndex << " broker " << MyBrokerId()
+          << ") starting pause due to socket timeout in main loop";
+      ConnectorSocketTimeout.Increment();
+      Ds.PauseButton.Push();
+      return false;
+    }
+
+    if (OptInProgressShutdown &&
+        (finish_time >= OptInProgressShutdown->Deadline)) {
+      OkShutdown = true;
+      LOG(TPri::NOTICE) << "Connector thread " << Gettid() << " (index "
+          << MyBrokerIndex << " broker " << MyBrokerId()
+          << ") finishing on shutdown time limit expiration";
+      return false;
+    }
+
+    /* Handle batch time limit expiry. */
+    CheckInputQueue(finish_time, false);
+  } else if (MainLoopPollArray[TMainLoopPollItem::ShutdownRequest].revents) {
+    /* Give this FD the highest priority since we must shut down immediately
+       if 'Destroying' is set. */
+    HandleShutdownRequest();
+    /* Handle other FDs in next iteration. */
+  } else if (MainLoopPollArray[TMainLoopPollItem::PauseButton].revents) {
+    HandlePauseDetected();
+    /* Handle other FDs in next iteration. */
+  } else {
+    if (MainLoopPollArray[TMainLoopPollItem::InputQueue].revents) {
+      CheckInputQueue(finish_time, true);
+    }
+
+    short sock_events = MainLoopPollArray[TMainLoopPollItem::SockIo].revents;
+
+    if ((sock_events & POLLOUT) && !HandleSockWriteReady()) {
+      return false;  // socket error on send
+    }
+
+    if ((sock_events & POLLIN) && !HandleSockReadReady()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void TConnector::DoRun() {
+  if (!StartConnection()) {
+    return;
+  }
 
   for (; ; ) {
     int poll_timeout = -1;
@@ -740,60 +930,25 @@ void TConnector::DoRun() {
       break;
     }
 
-    /* Treat EINTR as fatal, since this thread should have signals masked. */
-    const int ret = Wr::poll(Wr::TDisp::AddFatal, {EINTR}, MainLoopPollArray,
-      MainLoopPollArray.Size(), poll_timeout);
+    int ret = 0;
+
+    {
+      TProfiler::TPhaseScope wait_phase(TProfiler::TPhase::Wait);
+
+      /* Treat EINTR as fatal, since this thread should have signals
+         masked. */
+      ret = Wr::poll(Wr::TDisp::AddFatal, {EINTR}, MainLoopPollArray,
+          MainLoopPollArray.Size(), poll_timeout);
+    }
+
     assert(ret >= 0);
 
     /* Handle possibly nonmonotonic clock.
        TODO: Use monotonic clock instead. */
     uint64_t finish_time = std::max(start_time, GetEpochMilliseconds());
 
-    if (ret == 0) {  // poll() timed out
-      if ((MainLoopPollArray[TMainLoopPollItem::SockIo].fd >= 0) &&
-          ((finish_time - start_time) >=
-              (Ds.Conf.MsgDeliveryConf.KafkaSocketTimeout * 1000))) {
-        LOG(TPri::ERR) << "Connector thread " << Gettid() << " (index "
-            << MyBrokerIndex << " broker " << broker_id
-            << ") starting pause due to socket timeout in main loop";
-        ConnectorSocketTimeout.Increment();
-        Ds.PauseButton.Push();
-        break;
-      }
-
-      if (OptInProgressShutdown &&
-          (finish_time >= OptInProgressShutdown->Deadline)) {
-        OkShutdown = true;
-        LOG(TPri::NOTICE) << "Connector thread " << Gettid() << " (index "
-            << MyBrokerIndex << " broker " << broker_id
-            << ") finishing on shutdown time limit expiration";
-        break;
-      }
-
-      /* Handle batch time limit expiry. */
-      CheckInputQueue(finish_time, false);
-    } else if (MainLoopPollArray[TMainLoopPollItem::ShutdownRequest].revents) {
-      /* Give this FD the highest priority since we must shut down immediately
-         if 'Destroying' is set. */
-      HandleShutdownRequest();
-      /* Handle other FDs in next iteration. */
-    } else if (MainLoopPollArray[TMainLoopPollItem::PauseButton].revents) {
-      HandlePauseDetected();
-      /* Handle other FDs in next iteration. */
-    } else {
-      if (MainLoopPollArray[TMainLoopPollItem::InputQueue].revents) {
-        CheckInputQueue(finish_time, true);
-      }
-
-      short sock_events = MainLoopPollArray[TMainLoopPollItem::SockIo].revents;
-
-      if ((sock_events & POLLOUT) && !HandleSockWriteReady()) {
-        break;  // socket error on send
-      }
-
-      if ((sock_events & POLLIN) && !HandleSockReadReady()) {
-        break;
-      }
+    if (!HandleEvents(start_time, finish_time, ret == 0)) {
+      break;
     }
   }
 }
@@ -26,6 +26,7 @@
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <list>
 #include <memory>
 #include <optional>
@@ -46,6 +47,7 @@
 #include <dory/msg_dispatch/common.h>
 #include <dory/msg_dispatch/dispatcher_shared_state.h>
 #include <dory/msg_dispatch/produce_request_factory.h>
+#include <dory/util/latency_histogram.h>
 #include <dory/util/poll_array.h>
 #include <thread/fd_managed_thread.h>
 
@@ -53,12 +55,19 @@ namespace Dory {
 
   namespace MsgDispatch {
 
+    class TConnectorEventLoop;
+
     /* This class handles a TCP connection between Dory and a single Kafka
        broker.  It uses a single thread for building and sending produce
-       requests, as well as receiving and processing produce responses.  */
+       requests, as well as receiving and processing produce responses.  When
+       connector event loops are configured, the thread is never started.
+       Instead, a TConnectorEventLoop drives the connector's main loop logic
+       along with that of other connectors sharing the same thread.  */
     class TConnector final : public Thread::TFdManagedThread {
       NO_COPY_SEMANTICS(TConnector);
 
+      friend class TConnectorEventLoop;
+
       public:
       TConnector(size_t my_broker_index, TDispatcherSharedState &ds);
 
@@ -120,18 +129,37 @@ namespace Dory {
 
       bool DoConnect();
 
+      /* Called after connecting to broker.  If API version negotiation is
+         enabled, ask the broker which produce API versions it supports, and
+         switch to the highest version supported by both dory and the broker.
+         Return true on success or false on failure. */
+      bool ChooseProduceApiVersion();
+
       bool ConnectToBroker();
 
       void SetFastShutdownState();
 
       void HandleShutdownRequest();
 
+      /* Enter the fast or slow shutdown state specified by 'cmd'. */
+      void ApplyShutdownCmd(const TShutdownCmd &cmd);
+
       void SetPauseInProgress();
 
       void HandlePauseDetected();
 
       void CheckInputQueue(uint64_t now, bool pop_sem);
 
+      /* After a metadata update without restart, move any messages in
+         'batch' that can no longer be sent to our broker (see
+         TakeUnsendableMsgs()) to the partition retry queue for rerouting by
+         the router thread. */
+      void ParkUnsendableMsgs(std::list<std::list<TMsg::TPtr>> &batch);
+
+      /* Switch to new metadata published by the router thread, if any.
+         'now' is the current time in milliseconds since the epoch. */
+      void CheckMetadataUpdate(uint64_t now);
+
       bool TrySendProduceRequest();
 
       bool HandleSockWriteReady();
@@ -142,6 +170,18 @@ namespace Dory {
 
       bool PrepareForPoll(uint64_t now, int &poll_timeout);
 
+      /* Connect to broker and prepare for main loop.  Return true on success
+         or false on failure. */
+      bool StartConnection();
+
+      /* Handle the results of waiting on the FDs in 'MainLoopPollArray', which
+         started at 'start_time' and finished at 'finish_time'.  'timed_out'
+         indicates that none of the FDs became ready before the timeout
+         computed by PrepareForPoll() expired.  Return false if the connector
+         is finished, or true otherwise. */
+      bool HandleEvents(uint64_t start_time, uint64_t finish_time,
+          bool timed_out);
+
       void DoRun();
 
       /* TCP socket to Kafka broker. */
@@ -195,6 +235,9 @@ namespace Dory {
 
       std::shared_ptr<TMetadata> Metadata;
 
+      /* Generation number (see TPublishedMetadata) of 'Metadata'. */
+      uint64_t MetadataGeneration = 0;
+
       /* This becomes known when a batch time limit is set for messages being
          batched inside the 'InputQueue' member for this connector thread (see
          below).  Once the time limit expires, we extract all ready messages
@@ -278,6 +321,14 @@ namespace Dory {
       /* FIFO queue of sent produce requests waiting for responses. */
       std::list<TProduceRequest> AckWaitQueue;
 
+      /* Monotonic raw time in microseconds when each request in
+         'AckWaitQueue' was sent. */
+      std::deque<uint64_t> AckWaitSendTimes;
+
+      /* Produce request round trip times for our broker are recorded here.
+         Set when we get our metadata. */
+      Util::TLatencyHistogram *RttHistogram = nullptr;
+
       /* Messages that we got no ACK for, and need to be rerouted after pause
          finishes.  The router thread will reroute these and report them as
          possible duplicates. */
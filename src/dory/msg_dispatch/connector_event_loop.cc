@@ -0,0 +1,468 @@
+/* <dory/msg_dispatch/connector_event_loop.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/msg_dispatch/connector_event_loop.h>.
+ */
+
+#include <dory/msg_dispatch/connector_event_loop.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <exception>
+#include <limits>
+#include <string>
+
+#include <poll.h>
+
+#include <base/counter.h>
+#include <base/error_util.h>
+#include <base/gettid.h>
+#include <base/on_destroy.h>
+#include <base/time_util.h>
+#include <base/wr/fd_util.h>
+#include <dory/profiler.h>
+#include <log/log.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::MsgDispatch;
+using namespace Log;
+
+DEFINE_COUNTER(ConnectorEventLoopConnectorFinished);
+DEFINE_COUNTER(ConnectorEventLoopFinishRun);
+DEFINE_COUNTER(ConnectorEventLoopFinishWaitShutdownAck);
+DEFINE_COUNTER(ConnectorEventLoopSkipConnectOnPause);
+DEFINE_COUNTER(ConnectorEventLoopStartFastShutdown);
+DEFINE_COUNTER(ConnectorEventLoopStartRun);
+DEFINE_COUNTER(ConnectorEventLoopStartSlowShutdown);
+DEFINE_COUNTER(ConnectorEventLoopStartWaitShutdownAck);
+DEFINE_COUNTER(ConnectorEventLoopWakeup);
+
+/* Epoll tags for the event loop's own FDs.  Tags for connector FDs are
+   (2 * slot index) for the socket and (2 * slot index + 1) for the input
+   queue. */
+static const uint64_t SHUTDOWN_REQUEST_TAG =
+    std::numeric_limits<uint64_t>::max();
+
+static const uint64_t PAUSE_BUTTON_TAG = SHUTDOWN_REQUEST_TAG - 1;
+
+static const uint32_t EPOLL_READ_EVENTS = EPOLLIN;
+
+static uint32_t PollToEpollEvents(short events) noexcept {
+  uint32_t result = 0;
+
+  if (events & POLLIN) {
+    result |= EPOLLIN;
+  }
+
+  if (events & POLLOUT) {
+    result |= EPOLLOUT;
+  }
+
+  return result;
+}
+
+static short EpollToPollEvents(uint32_t events) noexcept {
+  short result = 0;
+
+  if (events & EPOLLIN) {
+    result |= POLLIN;
+  }
+
+  if (events & EPOLLOUT) {
+    result |= POLLOUT;
+  }
+
+  if (events & EPOLLERR) {
+    result |= POLLERR;
+  }
+
+  if (events & EPOLLHUP) {
+    result |= POLLHUP;
+  }
+
+  return result;
+}
+
+TConnectorEventLoop::TConnectorEventLoop(size_t my_index,
+    TDispatcherSharedState &ds)
+    : MyIndex(my_index),
+      Ds(ds),
+      Epoll(Wr::epoll_create1(EPOLL_CLOEXEC)) {
+}
+
+TConnectorEventLoop::~TConnectorEventLoop() {
+  /* This will shut down the thread if something unexpected happens.  Setting
+     the 'Destroying' flag tells the thread to shut down immediately when it
+     gets the shutdown request. */
+  Destroying = true;
+  ShutdownOnDestroy();
+}
+
+void TConnectorEventLoop::AddConnector(TConnector &connector) {
+  assert(!IsStarted());
+  assert(!connector.IsStarted());
+  assert(connector.Metadata);
+  Slots.emplace_back(connector);
+}
+
+void TConnectorEventLoop::StartSlowShutdown(uint64_t start_time) {
+  assert(IsStarted());
+  assert(!OptShutdownCmd.has_value());
+  ConnectorEventLoopStartSlowShutdown.Increment();
+  LOG(TPri::NOTICE)
+      << "Sending slow shutdown request to connector event loop thread "
+      << "(index " << MyIndex << ")";
+  OptShutdownCmd.emplace(start_time);
+  RequestShutdown();
+}
+
+void TConnectorEventLoop::StartFastShutdown() {
+  assert(IsStarted());
+  assert(!OptShutdownCmd.has_value());
+  ConnectorEventLoopStartFastShutdown.Increment();
+  LOG(TPri::NOTICE)
+      << "Sending fast shutdown request to connector event loop thread "
+      << "(index " << MyIndex << ")";
+  OptShutdownCmd.emplace();
+  RequestShutdown();
+}
+
+void TConnectorEventLoop::WaitForShutdownAck() {
+  ConnectorEventLoopStartWaitShutdownAck.Increment();
+  LOG(TPri::NOTICE)
+      << "Waiting for shutdown ACK from connector event loop thread (index "
+      << MyIndex << ")";
+
+  /* In addition to waiting for the shutdown ACK, we must wait for shutdown
+     finished, since the thread may have started shutting down on its own
+     immediately before we sent the shutdown request. */
+  static const size_t POLL_ARRAY_SIZE = 2;
+  struct pollfd poll_array[POLL_ARRAY_SIZE];
+  poll_array[0].fd = ShutdownAck.GetFd();
+  poll_array[0].events = POLLIN;
+  poll_array[0].revents = 0;
+  poll_array[1].fd = GetShutdownWaitFd();
+  poll_array[1].events = POLLIN;
+  poll_array[1].revents = 0;
+
+  /* Treat EINTR as fatal, since this thread should have signals masked. */
+  const int ret = Wr::poll(Wr::TDisp::AddFatal, {EINTR}, poll_array,
+      POLL_ARRAY_SIZE, -1);
+  assert(ret > 0);
+
+  const char *blurb = poll_array[0].revents ?
+      "shutdown ACK" : "shutdown finished notification";
+  LOG(TPri::NOTICE) << "Got " << blurb
+      << " from connector event loop thread (index " << MyIndex << ")";
+  ConnectorEventLoopFinishWaitShutdownAck.Increment();
+  OptShutdownCmd.reset();
+}
+
+void TConnectorEventLoop::Run() {
+  ConnectorEventLoopStartRun.Increment();
+
+  try {
+    auto close_sockets = OnDestroy(
+        [this]() noexcept {
+          /* Close TCP connections to brokers if open. */
+          for (TSlot &slot : Slots) {
+            slot.Connector->Sock.Reset();
+          }
+        });
+    LOG(TPri::NOTICE) << "Connector event loop thread " << Gettid()
+        << " (index " << MyIndex << ") started with " << Slots.size()
+        << " connectors";
+    TProfiler::TThreadBinding profile(Ds.Profiler,
+        "connector event loop " + std::to_string(MyIndex));
+    DoRun();
+  } catch (const TShutdownOnDestroy &) {
+    /* Nothing to do here. */
+  } catch (const std::exception &x) {
+    LOG(TPri::ERR) << "Fatal error in connector event loop thread "
+        << Gettid() << " (index " << MyIndex << "): " << x.what();
+    Die("Terminating on fatal error");
+  } catch (...) {
+    LOG(TPri::ERR) << "Fatal unknown error in connector event loop thread "
+        << Gettid() << " (index " << MyIndex << ")";
+    Die("Terminating on fatal error");
+  }
+
+  LOG(TPri::NOTICE) << "Connector event loop thread " << Gettid()
+      << " (index " << MyIndex << ") finished";
+  Ds.MarkThreadFinished();
+  ConnectorEventLoopFinishRun.Increment();
+}
+
+void TConnectorEventLoop::StartConnections() {
+  for (TSlot &slot : Slots) {
+    TConnector &c = *slot.Connector;
+
+    if (Ds.PauseButton.GetFd().IsReadable()) {
+      /* Another connector has already started a pause, so there is no point
+         in connecting.  A connector in this situation would immediately
+         detect the pause and finish with nothing sent. */
+      ConnectorEventLoopSkipConnectOnPause.Increment();
+      LOG(TPri::NOTICE) << "Connector event loop thread " << Gettid()
+          << " (index " << MyIndex << ") skipping connect to broker "
+          << c.MyBrokerId() << " on pause";
+      c.PauseInProgress = true;
+      continue;
+    }
+
+    if (c.StartConnection()) {
+      slot.Active = true;
+      ++ActiveCount;
+    }
+  }
+}
+
+void TConnectorEventLoop::UpdateRegistration(int fd, uint64_t tag,
+    uint32_t &registered, uint32_t wanted) {
+  if (wanted == registered) {
+    return;
+  }
+
+  epoll_event event{};
+  event.events = wanted;
+  event.data.u64 = tag;
+  int op = EPOLL_CTL_MOD;
+
+  if (registered == 0) {
+    op = EPOLL_CTL_ADD;
+  } else if (wanted == 0) {
+    op = EPOLL_CTL_DEL;
+  }
+
+  Wr::epoll_ctl(Epoll, op, fd, &event);
+  registered = wanted;
+}
+
+void TConnectorEventLoop::PrepareSlot(size_t slot_index, uint64_t now) {
+  TSlot &slot = Slots[slot_index];
+  assert(slot.Active);
+  TConnector &c = *slot.Connector;
+  int poll_timeout = -1;
+
+  if (!c.PrepareForPoll(now, poll_timeout)) {
+    c.OkShutdown = true;
+    FinishSlot(slot_index);
+    return;
+  }
+
+  slot.NeedPrepare = false;
+  slot.WaitStart = now;
+  slot.OptDeadline.reset();
+
+  if (poll_timeout >= 0) {
+    slot.OptDeadline.emplace(now + static_cast<uint64_t>(poll_timeout));
+  }
+
+  const struct pollfd &sock_item = c.MainLoopPollArray[TPollItem::SockIo];
+  const struct pollfd &input_item =
+      c.MainLoopPollArray[TPollItem::InputQueue];
+  UpdateRegistration(c.Sock, 2 * slot_index, slot.SockEvents,
+      (sock_item.fd < 0) ? 0 : PollToEpollEvents(sock_item.events));
+  UpdateRegistration(c.InputQueue.GetSenderNotifyFd(), (2 * slot_index) + 1,
+      slot.InputEvents, (input_item.fd < 0) ? 0 : EPOLL_READ_EVENTS);
+}
+
+void TConnectorEventLoop::FinishSlot(size_t slot_index) {
+  TSlot &slot = Slots[slot_index];
+  assert(slot.Active);
+  TConnector &c = *slot.Connector;
+  UpdateRegistration(c.Sock, 2 * slot_index, slot.SockEvents, 0);
+  UpdateRegistration(c.InputQueue.GetSenderNotifyFd(), (2 * slot_index) + 1,
+      slot.InputEvents, 0);
+  c.Sock.Reset();  // close TCP connection to broker
+  slot.Active = false;
+  assert(ActiveCount);
+  --ActiveCount;
+  ConnectorEventLoopConnectorFinished.Increment();
+  LOG(TPri::NOTICE) << "Connector event loop thread " << Gettid()
+      << " (index " << MyIndex << ") connector for broker index "
+      << c.MyBrokerIndex << " (broker " << c.MyBrokerId() << ") finished "
+      << (c.OkShutdown ? "normally" : "on error");
+}
+
+void TConnectorEventLoop::UpdatePauseRegistration() {
+  /* The pause button stays readable once pushed, so we must stop monitoring
+     it once every remaining connector has detected the pause.  Otherwise we
+     would spin. */
+  bool want_pause = false;
+
+  for (const TSlot &slot : Slots) {
+    if (slot.Active &&
+        (slot.Connector->MainLoopPollArray[TPollItem::PauseButton].fd >= 0)) {
+      want_pause = true;
+      break;
+    }
+  }
+
+  UpdateRegistration(Ds.PauseButton.GetFd(), PAUSE_BUTTON_TAG, PauseEvents,
+      want_pause ? EPOLL_READ_EVENTS : 0);
+}
+
+int TConnectorEventLoop::ComputeTimeout(uint64_t now) const {
+  int timeout = -1;
+
+  for (const TSlot &slot : Slots) {
+    if (slot.Active && slot.OptDeadline) {
+      const uint64_t deadline = *slot.OptDeadline;
+      const uint64_t remaining = std::min<uint64_t>(
+          (now >= deadline) ? 0 : (deadline - now),
+          static_cast<uint64_t>(std::numeric_limits<int>::max()));
+      timeout = (timeout < 0) ? static_cast<int>(remaining) :
+          std::min(timeout, static_cast<int>(remaining));
+    }
+  }
+
+  return timeout;
+}
+
+void TConnectorEventLoop::HandleShutdownRequest() {
+  if (Destroying) {
+    throw TShutdownOnDestroy();
+  }
+
+  assert(OptShutdownCmd);
+  const TShutdownCmd &cmd = *OptShutdownCmd;
+
+  for (TSlot &slot : Slots) {
+    if (slot.Active) {
+      slot.Connector->ApplyShutdownCmd(cmd);
+      slot.NeedPrepare = true;
+    }
+  }
+
+  LOG(TPri::NOTICE) << "Connector event loop thread " << Gettid()
+      << " (index " << MyIndex << ") sending ACK for "
+      << (cmd.OptSlowShutdownStartTime ? "slow" : "fast") << " shutdown";
+  ShutdownAck.Push();
+  ClearShutdownRequest();
+}
+
+void TConnectorEventLoop::DoRun() {
+  StartConnections();
+  uint32_t shutdown_events = 0;
+  UpdateRegistration(GetShutdownRequestFd(), SHUTDOWN_REQUEST_TAG,
+      shutdown_events, EPOLL_READ_EVENTS);
+  EventBuf.resize((2 * Slots.size()) + 2);
+
+  for (; ; ) {
+    uint64_t start_time = GetEpochMilliseconds();
+
+    for (size_t i = 0; i < Slots.size(); ++i) {
+      if (Slots[i].Active && Slots[i].NeedPrepare) {
+        PrepareSlot(i, start_time);
+      }
+    }
+
+    if (ActiveCount == 0) {
+      break;
+    }
+
+    UpdatePauseRegistration();
+
+    const int timeout = ComputeTimeout(start_time);
+    int ret = 0;
+
+    {
+      TProfiler::TPhaseScope wait_phase(TProfiler::TPhase::Wait);
+
+      /* Treat EINTR as fatal, since this thread should have signals
+         masked. */
+      ret = Wr::epoll_wait(Wr::TDisp::AddFatal, {EINTR}, Epoll,
+          EventBuf.data(), static_cast<int>(EventBuf.size()), timeout);
+    }
+
+    assert(ret >= 0);
+    ConnectorEventLoopWakeup.Increment();
+
+    /* Handle possibly nonmonotonic clock.
+       TODO: Use monotonic clock instead. */
+    uint64_t finish_time = std::max(start_time, GetEpochMilliseconds());
+
+    for (TSlot &slot : Slots) {
+      slot.SockRevents = 0;
+      slot.InputReady = false;
+    }
+
+    bool shutdown_request = false;
+    bool pause_detected = false;
+
+    for (int i = 0; i < ret; ++i) {
+      const epoll_event &event = EventBuf[static_cast<size_t>(i)];
+      const uint64_t tag = event.data.u64;
+
+      if (tag == SHUTDOWN_REQUEST_TAG) {
+        shutdown_request = true;
+      } else if (tag == PAUSE_BUTTON_TAG) {
+        pause_detected = true;
+      } else {
+        TSlot &slot = Slots[tag / 2];
+
+        if (tag % 2) {
+          slot.InputReady = true;
+        } else {
+          slot.SockRevents = EpollToPollEvents(event.events);
+        }
+      }
+    }
+
+    if (shutdown_request) {
+      /* Give this FD the highest priority since we must shut down immediately
+         if 'Destroying' is set.  Handle other FDs in next iteration. */
+      HandleShutdownRequest();
+      continue;
+    }
+
+    for (size_t i = 0; i < Slots.size(); ++i) {
+      TSlot &slot = Slots[i];
+
+      if (!slot.Active) {
+        continue;
+      }
+
+      TConnector &c = *slot.Connector;
+      struct pollfd &pause_item = c.MainLoopPollArray[TPollItem::PauseButton];
+      c.MainLoopPollArray[TPollItem::SockIo].revents = slot.SockRevents;
+      c.MainLoopPollArray[TPollItem::ShutdownRequest].revents = 0;
+      pause_item.revents = (pause_detected && (pause_item.fd >= 0)) ?
+          POLLIN : 0;
+      c.MainLoopPollArray[TPollItem::InputQueue].revents =
+          slot.InputReady ? POLLIN : 0;
+      const bool got_event = slot.SockRevents || slot.InputReady ||
+          pause_item.revents;
+      const bool timed_out = !got_event && slot.OptDeadline &&
+          (finish_time >= *slot.OptDeadline);
+
+      if (!got_event && !timed_out) {
+        /* Keep waiting for this connector without restarting its timeout. */
+        continue;
+      }
+
+      slot.NeedPrepare = true;
+
+      if (!c.HandleEvents(slot.WaitStart, finish_time, timed_out)) {
+        FinishSlot(i);
+      }
+    }
+  }
+}
@@ -0,0 +1,166 @@
+/* <dory/msg_dispatch/connector_event_loop.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Event loop thread that drives the connections to several Kafka brokers.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <sys/epoll.h>
+
+#include <base/event_semaphore.h>
+#include <base/fd.h>
+#include <base/no_copy_semantics.h>
+#include <dory/msg_dispatch/common.h>
+#include <dory/msg_dispatch/connector.h>
+#include <dory/msg_dispatch/dispatcher_shared_state.h>
+#include <thread/fd_managed_thread.h>
+
+namespace Dory {
+
+  namespace MsgDispatch {
+
+    /* Instead of each TConnector running in its own thread, this class drives
+       the main loop logic of several connectors from a single thread using
+       epoll.  The connectors are never started as threads.  This allows a
+       large number of brokers to be handled by a small fixed number of
+       threads.  Connecting to each broker and negotiating its produce API
+       version still block, and are done one connector at a time when the
+       event loop starts. */
+    class TConnectorEventLoop final : public Thread::TFdManagedThread {
+      NO_COPY_SEMANTICS(TConnectorEventLoop);
+
+      public:
+      TConnectorEventLoop(size_t my_index, TDispatcherSharedState &ds);
+
+      ~TConnectorEventLoop() override;
+
+      /* This must be called before starting the thread.  'connector' must
+         have its metadata set, must not be started, and must outlive the
+         event loop. */
+      void AddConnector(TConnector &connector);
+
+      size_t GetConnectorCount() const noexcept {
+        return Slots.size();
+      }
+
+      void StartSlowShutdown(uint64_t start_time);
+
+      void StartFastShutdown();
+
+      void WaitForShutdownAck();
+
+      protected:
+      void Run() override;
+
+      private:
+      using TPollItem = TConnector::TMainLoopPollItem;
+
+      /* Event loop state for a single connector. */
+      struct TSlot final {
+        explicit TSlot(TConnector &connector)
+            : Connector(&connector) {
+        }
+
+        TConnector *Connector;
+
+        /* True if the connector is connected and has not yet finished. */
+        bool Active = false;
+
+        /* True if TConnector::PrepareForPoll() must be called before waiting
+           for events on the connector's behalf again. */
+        bool NeedPrepare = true;
+
+        /* Time when we started waiting for events for this connector. */
+        uint64_t WaitStart = 0;
+
+        /* Time when the connector's poll timeout expires, if any. */
+        std::optional<uint64_t> OptDeadline;
+
+        /* Epoll events currently registered for connector's socket and input
+           queue notification FD. */
+        uint32_t SockEvents = 0;
+
+        uint32_t InputEvents = 0;
+
+        /* Results of most recent wait. */
+        short SockRevents = 0;
+
+        bool InputReady = false;
+      };  // TSlot
+
+      void StartConnections();
+
+      void UpdateRegistration(int fd, uint64_t tag, uint32_t &registered,
+          uint32_t wanted);
+
+      void PrepareSlot(size_t slot_index, uint64_t now);
+
+      void FinishSlot(size_t slot_index);
+
+      void UpdatePauseRegistration();
+
+      int ComputeTimeout(uint64_t now) const;
+
+      void HandleShutdownRequest();
+
+      void DoRun();
+
+      /* The TKafkaDispatcher object maintains a vector of
+         TConnectorEventLoop objects.  Here we store the vector index of this
+         event loop. */
+      const size_t MyIndex;
+
+      /* Dispatcher state shared by all connectors and event loops. */
+      TDispatcherSharedState &Ds;
+
+      std::vector<TSlot> Slots;
+
+      /* Number of slots whose 'Active' flag is set. */
+      size_t ActiveCount = 0;
+
+      Base::TFd Epoll;
+
+      std::vector<epoll_event> EventBuf;
+
+      /* Epoll events currently registered for the dispatcher's pause button.
+       */
+      uint32_t PauseEvents = 0;
+
+      /* This flag is only set on destructor invocation.  If the event loop
+         thread is still executing at this point, then a fatal error has
+         occurred, so it must shut down immediately. */
+      bool Destroying = false;
+
+      /* Known when the router thread has sent a fast or slow shutdown command,
+         which the event loop thread has not yet received. */
+      std::optional<TShutdownCmd> OptShutdownCmd;
+
+      /* Event loop thread pushes this to acknowledge receipt of shutdown
+         request (but continues executing until shutdown finished). */
+      Base::TEventSemaphore ShutdownAck;
+    };  // TConnectorEventLoop
+
+  }  // MsgDispatch
+
+}  // Dory
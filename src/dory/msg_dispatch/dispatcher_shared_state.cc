@@ -41,12 +41,20 @@ DEFINE_COUNTER(AllDispatcherThreadsFinished);
 
 TDispatcherSharedState::TDispatcherSharedState(const TCmdLineArgs &args,
      const TConf &conf, TMsgStateTracker &msg_state_tracker,
-     TAnomalyTracker &anomaly_tracker, const TDebugSetup &debug_setup)
+     TAnomalyTracker &anomaly_tracker, const TDebugSetup &debug_setup,
+     TApiVersionStats &api_version_stats,
+     TCompressionStats &compression_stats, TLingerStats &linger_stats,
+     TLatencyStats &latency_stats, TProfiler &profiler)
     : CmdLineArgs(args),
       Conf(conf),
       MsgStateTracker(msg_state_tracker),
       AnomalyTracker(anomaly_tracker),
       DebugSetup(debug_setup),
+      ApiVersionStats(api_version_stats),
+      CompressionStats(compression_stats),
+      LingerStats(linger_stats),
+      LatencyStats(latency_stats),
+      Profiler(profiler),
       BatchConfig(TBatchConfigBuilder().BuildFromConf(conf.BatchConf)) {
 }
 
@@ -85,10 +93,10 @@ void TDispatcherSharedState::Discard(std::list<std::list<TMsg::TPtr>> &&batch,
 }
 
 void TDispatcherSharedState::MarkAllThreadsRunning(
-    size_t in_service_broker_count) {
+    size_t thread_count) {
   assert(RunningThreadCount.load() == 0);
   assert(!ShutdownFinished.GetFd().IsReadable());
-  std::atomic_store(&RunningThreadCount, in_service_broker_count);
+  std::atomic_store(&RunningThreadCount, thread_count);
 }
 
 void TDispatcherSharedState::MarkThreadFinished() {
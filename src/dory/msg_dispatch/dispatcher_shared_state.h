@@ -29,13 +29,20 @@
 #include <base/event_semaphore.h>
 #include <base/no_copy_semantics.h>
 #include <dory/anomaly_tracker.h>
+#include <dory/api_version_stats.h>
 #include <dory/batch/global_batch_config.h>
 #include <dory/cmd_line_args.h>
+#include <dory/compression_stats.h>
 #include <dory/conf/conf.h>
 #include <dory/debug/debug_setup.h>
 #include <dory/kafka_proto/produce/produce_protocol.h>
+#include <dory/latency_stats.h>
+#include <dory/linger_stats.h>
 #include <dory/msg.h>
+#include <dory/msg_dispatch/partition_retry_queue.h>
+#include <dory/msg_dispatch/published_metadata.h>
 #include <dory/msg_state_tracker.h>
+#include <dory/profiler.h>
 #include <dory/util/pause_button.h>
 
 namespace Dory {
@@ -57,14 +64,37 @@ namespace Dory {
 
       const Debug::TDebugSetup &DebugSetup;
 
+      TApiVersionStats &ApiVersionStats;
+
+      TCompressionStats &CompressionStats;
+
+      TLingerStats &LingerStats;
+
+      TLatencyStats &LatencyStats;
+
+      TProfiler &Profiler;
+
       Util::TPauseButton PauseButton;
 
+      /* Message sets parked by connector threads for rerouting by the router
+         thread when partition retry is enabled. */
+      TPartitionRetryQueue PartitionRetryQueue;
+
+      /* Metadata published by the router thread for connector threads to pick
+         up without a dispatcher restart.  The broker list must be identical
+         to that of the metadata the connectors were started with. */
+      TPublishedMetadata PublishedMetadata;
+
       const Batch::TGlobalBatchConfig BatchConfig;
 
       TDispatcherSharedState(const TCmdLineArgs &args,
           const Conf::TConf &conf, TMsgStateTracker &msg_state_tracker,
           TAnomalyTracker &anomaly_tracker,
-          const Debug::TDebugSetup &debug_setup);
+          const Debug::TDebugSetup &debug_setup,
+          TApiVersionStats &api_version_stats,
+          TCompressionStats &compression_stats,
+          TLingerStats &linger_stats, TLatencyStats &latency_stats,
+          TProfiler &profiler);
 
       size_t GetAckCount() const noexcept {
         return AckCount.load();
@@ -90,7 +120,7 @@ namespace Dory {
         return RunningThreadCount.load();
       }
 
-      void MarkAllThreadsRunning(size_t in_service_broker_count);
+      void MarkAllThreadsRunning(size_t thread_count);
 
       /* Called by connector threads when finished shutting down. */
       void MarkThreadFinished();
@@ -21,6 +21,8 @@
 
 #include <dory/msg_dispatch/kafka_dispatcher.h>
 
+#include <algorithm>
+
 #include <base/counter.h>
 #include <log/log.h>
 
@@ -45,6 +47,7 @@ DEFINE_COUNTER(StartDispatcherFastShutdown);
 DEFINE_COUNTER(StartDispatcherJoinAll);
 DEFINE_COUNTER(StartDispatcherSlowShutdown);
 DEFINE_COUNTER(StartKafkaDispatcher);
+DEFINE_COUNTER(UpdateDispatcherMetadata);
 
 void TKafkaDispatcher::SetProduceProtocol(
     TProduceProtocol *protocol) noexcept {
@@ -83,19 +86,45 @@ void TKafkaDispatcher::Start(const std::shared_ptr<TMetadata> &md) {
      ones.  Doing things this way makes the connector implementation simpler
      and less susceptible to bugs being introduced. */
 
+  EventLoops.clear();
   Connectors.clear();
+  Ds.PublishedMetadata.Publish(md);
   Connectors.resize(num_in_service);
-  Ds.MarkAllThreadsRunning(num_in_service);
+  const size_t loop_count = std::min(
+      Ds.Conf.MsgDeliveryConf.ConnectorEventLoops, num_in_service);
+  Ds.MarkAllThreadsRunning(loop_count ? loop_count : num_in_service);
 
   for (size_t i = 0; i < Connectors.size(); ++i) {
     assert(brokers[i].IsInService());
     std::unique_ptr<TConnector> &broker_ptr = Connectors[i];
     assert(!broker_ptr);
     broker_ptr.reset(new TConnector(i, Ds));
-    LOG(TPri::NOTICE) << "Starting connector thread for broker index " << i
-        << " (Kafka ID " << brokers[i].GetId() << ")";
     broker_ptr->SetMetadata(md);
-    broker_ptr->Start();
+
+    if (loop_count == 0) {
+      LOG(TPri::NOTICE) << "Starting connector thread for broker index " << i
+          << " (Kafka ID " << brokers[i].GetId() << ")";
+      broker_ptr->Start();
+    }
+  }
+
+  if (loop_count) {
+    EventLoops.resize(loop_count);
+
+    for (size_t i = 0; i < EventLoops.size(); ++i) {
+      EventLoops[i].reset(new TConnectorEventLoop(i, Ds));
+    }
+
+    /* Shard the brokers across the event loops. */
+    for (size_t i = 0; i < Connectors.size(); ++i) {
+      EventLoops[i % loop_count]->AddConnector(*Connectors[i]);
+    }
+
+    for (size_t i = 0; i < EventLoops.size(); ++i) {
+      LOG(TPri::NOTICE) << "Starting connector event loop thread index " << i
+          << " for " << EventLoops[i]->GetConnectorCount() << " brokers";
+      EventLoops[i]->Start();
+    }
   }
 
   for (size_t i = Connectors.size(); i < brokers.size(); ++i) {
@@ -182,6 +211,16 @@ void TKafkaDispatcher::StartSlowShutdown(uint64_t start_time) {
 
   if (Connectors.empty()) {
     Ds.HandleAllThreadsFinished();
+  } else if (!EventLoops.empty()) {
+    for (std::unique_ptr<TConnectorEventLoop> &loop : EventLoops) {
+      assert(loop);
+      loop->StartSlowShutdown(start_time);
+    }
+
+    for (std::unique_ptr<TConnectorEventLoop> &loop : EventLoops) {
+      assert(loop);
+      loop->WaitForShutdownAck();
+    }
   } else {
     for (std::unique_ptr<TConnector> &c : Connectors) {
       assert(c);
@@ -203,6 +242,16 @@ void TKafkaDispatcher::StartFastShutdown() {
 
   if (Connectors.empty()) {
     Ds.HandleAllThreadsFinished();
+  } else if (!EventLoops.empty()) {
+    for (std::unique_ptr<TConnectorEventLoop> &loop : EventLoops) {
+      assert(loop);
+      loop->StartFastShutdown();
+    }
+
+    for (std::unique_ptr<TConnectorEventLoop> &loop : EventLoops) {
+      assert(loop);
+      loop->WaitForShutdownAck();
+    }
   } else {
     for (std::unique_ptr<TConnector> &c : Connectors) {
       assert(c);
@@ -232,9 +281,18 @@ void TKafkaDispatcher::JoinAll() {
   LOG(TPri::NOTICE) << "Start waiting for dispatcher shutdown status";
   bool ok_shutdown = true;
 
+  for (std::unique_ptr<TConnectorEventLoop> &loop : EventLoops) {
+    assert(loop);
+    loop->Join();
+  }
+
   for (std::unique_ptr<TConnector> &c : Connectors) {
     assert(c);
-    c->Join();
+
+    if (EventLoops.empty()) {
+      c->Join();
+    }
+
     c->CleanupAfterJoin();
 
     if (!c->ShutdownWasOk()) {
@@ -288,6 +346,22 @@ TKafkaDispatcher::GetSendWaitQueueAfterShutdown(size_t broker_index) {
   return Connectors[broker_index]->GetSendWaitQueueAfterShutdown();
 }
 
+void TKafkaDispatcher::UpdateMetadata(const std::shared_ptr<TMetadata> &md) {
+  assert(md);
+  assert(State == TState::Started);
+  UpdateDispatcherMetadata.Increment();
+  LOG(TPri::NOTICE) << "Publishing updated metadata to connectors";
+  Ds.PublishedMetadata.Publish(md);
+}
+
+const TFd &TKafkaDispatcher::GetPartitionRetryFd() const noexcept {
+  return Ds.PartitionRetryQueue.GetFd();
+}
+
+std::list<std::list<TMsg::TPtr>> TKafkaDispatcher::TakePartitionRetryMsgs() {
+  return Ds.PartitionRetryQueue.TakeAll();
+}
+
 size_t TKafkaDispatcher::GetAckCount() const noexcept {
   return Ds.GetAckCount();
 }
@@ -33,19 +33,25 @@
 #include <base/fd.h>
 #include <base/no_copy_semantics.h>
 #include <dory/anomaly_tracker.h>
+#include <dory/api_version_stats.h>
 #include <dory/batch/batch_config_builder.h>
 #include <dory/batch/global_batch_config.h>
 #include <dory/cmd_line_args.h>
+#include <dory/compression_stats.h>
 #include <dory/conf/compression_conf.h>
 #include <dory/conf/conf.h>
 #include <dory/debug/debug_setup.h>
 #include <dory/kafka_proto/produce/produce_protocol.h>
+#include <dory/latency_stats.h>
+#include <dory/linger_stats.h>
 #include <dory/metadata.h>
 #include <dory/msg.h>
 #include <dory/msg_dispatch/connector.h>
+#include <dory/msg_dispatch/connector_event_loop.h>
 #include <dory/msg_dispatch/dispatcher_shared_state.h>
 #include <dory/msg_dispatch/kafka_dispatcher_api.h>
 #include <dory/msg_state_tracker.h>
+#include <dory/profiler.h>
 
 namespace Dory {
 
@@ -58,8 +64,14 @@ namespace Dory {
       TKafkaDispatcher(const TCmdLineArgs &args, const Conf::TConf &conf,
           TMsgStateTracker &msg_state_tracker,
           TAnomalyTracker &anomaly_tracker,
-          const Debug::TDebugSetup &debug_setup)
-          : Ds(args, conf, msg_state_tracker, anomaly_tracker, debug_setup) {
+          const Debug::TDebugSetup &debug_setup,
+          TApiVersionStats &api_version_stats,
+          TCompressionStats &compression_stats,
+          TLingerStats &linger_stats,
+          TLatencyStats &latency_stats, TProfiler &profiler)
+          : Ds(args, conf, msg_state_tracker, anomaly_tracker, debug_setup,
+               api_version_stats, compression_stats, linger_stats,
+               latency_stats, profiler) {
       }
 
       ~TKafkaDispatcher() override = default;
@@ -98,6 +110,12 @@ namespace Dory {
       std::list<std::list<TMsg::TPtr>>
       GetSendWaitQueueAfterShutdown(size_t broker_index) override;
 
+      void UpdateMetadata(const std::shared_ptr<TMetadata> &md) override;
+
+      const Base::TFd &GetPartitionRetryFd() const noexcept override;
+
+      std::list<std::list<TMsg::TPtr>> TakePartitionRetryMsgs() override;
+
       size_t GetAckCount() const noexcept override;
 
       private:
@@ -108,6 +126,12 @@ namespace Dory {
       bool OkShutdown = true;
 
       std::vector<std::unique_ptr<TConnector>> Connectors;
+
+      /* Empty unless connector event loops are configured, in which case
+         these threads drive the connectors, which are not started as threads
+         themselves.  Declared after 'Connectors' so the event loops are
+         destroyed first. */
+      std::vector<std::unique_ptr<TConnectorEventLoop>> EventLoops;
     };  // TKafkaDispatcher
 
   }  // MsgDispatch
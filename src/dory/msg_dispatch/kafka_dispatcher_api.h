@@ -138,6 +138,21 @@ namespace Dory {
       virtual std::list<std::list<TMsg::TPtr>>
       GetSendWaitQueueAfterShutdown(size_t broker_index) = 0;
 
+      /* Give the running connector threads new metadata without restarting
+         the dispatcher.  The broker list of 'md' must be identical to that of
+         the metadata passed to Start().  Each connector thread switches to
+         the new metadata before it next builds a produce request. */
+      virtual void UpdateMetadata(const std::shared_ptr<TMetadata> &md) = 0;
+
+      /* Becomes readable when connector threads have parked messages for
+         partition retry (see msgDelivery/partitionRetry in the config file).
+       */
+      virtual const Base::TFd &GetPartitionRetryFd() const noexcept = 0;
+
+      /* Get all messages parked for partition retry.  The router thread
+         reroutes these once it has checked the metadata for their topics. */
+      virtual std::list<std::list<TMsg::TPtr>> TakePartitionRetryMsgs() = 0;
+
       /* For testing. */
       virtual size_t GetAckCount() const noexcept = 0;
 
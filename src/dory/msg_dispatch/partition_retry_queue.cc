@@ -0,0 +1,128 @@
+/* <dory/msg_dispatch/partition_retry_queue.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/msg_dispatch/partition_retry_queue.h>.
+ */
+
+#include <dory/msg_dispatch/partition_retry_queue.h>
+
+#include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::MsgDispatch;
+
+void TPartitionRetryQueue::Put(std::list<TMsg::TPtr> &&msg_set) {
+  assert(!msg_set.empty());
+  std::list<TMsg::TPtr> tmp(std::move(msg_set));
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  const bool was_empty = MsgSets.empty();
+  MsgSets.push_back(std::move(tmp));
+
+  if (was_empty) {
+    NonemptySem.Push();
+  }
+}
+
+void TPartitionRetryQueue::Put(std::list<std::list<TMsg::TPtr>> &&msg_sets) {
+  if (msg_sets.empty()) {
+    return;
+  }
+
+  std::list<std::list<TMsg::TPtr>> tmp(std::move(msg_sets));
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  const bool was_empty = MsgSets.empty();
+  MsgSets.splice(MsgSets.end(), std::move(tmp));
+
+  if (was_empty) {
+    NonemptySem.Push();
+  }
+}
+
+std::list<std::list<TMsg::TPtr>> TPartitionRetryQueue::TakeAll() {
+  std::list<std::list<TMsg::TPtr>> result;
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  result.swap(MsgSets);
+  NonemptySem.Reset();
+  return result;
+}
+
+static bool IsSendable(const TMsg &msg, const TMetadata &md,
+    size_t broker_index) {
+  if (msg.GetRoutingType() == TMsg::TRoutingType::AnyPartition) {
+    size_t num_choices = 0;
+    return (md.FindPartitionChoices(msg.GetTopic(), broker_index,
+        num_choices) != nullptr);
+  }
+
+  const int topic_index = md.FindTopicIndex(msg.GetTopic());
+
+  if (topic_index < 0) {
+    return false;
+  }
+
+  const std::vector<TMetadata::TPartition> &partitions =
+      md.GetTopics()[static_cast<size_t>(topic_index)].GetOkPartitions();
+
+  for (const TMetadata::TPartition &p : partitions) {
+    if (p.GetId() == msg.GetPartition()) {
+      return (p.GetBrokerIndex() == broker_index);
+    }
+  }
+
+  return false;
+}
+
+std::list<std::list<TMsg::TPtr>> Dory::MsgDispatch::TakeUnsendableMsgs(
+    std::list<std::list<TMsg::TPtr>> &batch, const TMetadata &md,
+    size_t broker_index) {
+  std::list<std::list<TMsg::TPtr>> result;
+
+  for (auto iter = batch.begin(), next = iter; iter != batch.end();
+      iter = next) {
+    ++next;
+    std::list<TMsg::TPtr> &msg_list = *iter;
+    std::list<TMsg::TPtr> unsendable;
+
+    for (auto msg_iter = msg_list.begin(), msg_next = msg_iter;
+        msg_iter != msg_list.end();
+        msg_iter = msg_next) {
+      ++msg_next;
+
+      if (!IsSendable(**msg_iter, md, broker_index)) {
+        unsendable.splice(unsendable.end(), msg_list, msg_iter);
+      }
+    }
+
+    if (!unsendable.empty()) {
+      result.push_back(std::move(unsendable));
+    }
+
+    if (msg_list.empty()) {
+      batch.erase(iter);
+    }
+  }
+
+  return result;
+}
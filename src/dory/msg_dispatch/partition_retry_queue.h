@@ -0,0 +1,88 @@
+/* <dory/msg_dispatch/partition_retry_queue.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Queue of message sets that connector threads hand back to the router thread
+   for rerouting after a partition-level error ACK.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+
+#include <base/event_semaphore.h>
+#include <base/fd.h>
+#include <base/no_copy_semantics.h>
+#include <dory/metadata.h>
+#include <dory/msg.h>
+
+namespace Dory {
+
+  namespace MsgDispatch {
+
+    /* When partition retry is enabled, a connector thread that gets an error
+       ACK indicating that a partition's leader may have moved parks the
+       failed message set here instead of pausing the dispatcher.  The router
+       thread monitors the FD returned by GetFd(), refreshes the metadata for
+       the affected topics, and reroutes the messages.  Meanwhile, other
+       partitions keep flowing. */
+    class TPartitionRetryQueue final {
+      NO_COPY_SEMANTICS(TPartitionRetryQueue);
+
+      public:
+      TPartitionRetryQueue() = default;
+
+      /* Called by connector threads. */
+      void Put(std::list<TMsg::TPtr> &&msg_set);
+
+      /* Called by connector threads. */
+      void Put(std::list<std::list<TMsg::TPtr>> &&msg_sets);
+
+      /* Called by router thread.  Return all queued message sets and make the
+         FD returned by GetFd() unreadable. */
+      std::list<std::list<TMsg::TPtr>> TakeAll();
+
+      /* Becomes readable when the queue is nonempty. */
+      const Base::TFd &GetFd() const noexcept {
+        return NonemptySem.GetFd();
+      }
+
+      private:
+      std::mutex Mutex;
+
+      std::list<std::list<TMsg::TPtr>> MsgSets;
+
+      Base::TEventSemaphore NonemptySem;
+    };  // TPartitionRetryQueue
+
+    /* Called by a connector thread after switching to metadata 'md' without
+       a restart.  Remove from 'batch' and return all messages that can no
+       longer be sent to the broker at index 'broker_index' in
+       md.GetBrokers().  An AnyPartition message is unsendable if its topic
+       has no partitions led by the broker.  A PartitionKey message is
+       unsendable if its partition is not among the topic's OK partitions
+       led by the broker.  Message lists left empty are removed from 'batch'.
+     */
+    std::list<std::list<TMsg::TPtr>> TakeUnsendableMsgs(
+        std::list<std::list<TMsg::TPtr>> &batch, const TMetadata &md,
+        size_t broker_index);
+
+  }  // MsgDispatch
+
+}  // Dory
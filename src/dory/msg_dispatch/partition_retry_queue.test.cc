@@ -0,0 +1,226 @@
+/* <dory/msg_dispatch/partition_retry_queue.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/msg_dispatch/partition_retry_queue.h>.
+ */
+
+#include <dory/msg_dispatch/partition_retry_queue.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <base/tmp_file.h>
+#include <capped/reader.h>
+#include <dory/metadata.h>
+#include <dory/msg.h>
+#include <dory/msg_creator.h>
+#include <dory/test_util/misc_util.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::MsgDispatch;
+using namespace Dory::TestUtil;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TPartitionRetryQueue. */
+  class TPartitionRetryQueueTest : public ::testing::Test {
+    protected:
+    TPartitionRetryQueueTest() = default;
+
+    ~TPartitionRetryQueueTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TPartitionRetryQueueTest
+
+  TMsg::TPtr NewKeyMsg(TTestMsgCreator &mc, const std::string &topic,
+      int32_t partition, const std::string &value) {
+    TMsg::TPtr msg = TMsgCreator::CreatePartitionKeyMsg(partition, 0,
+        topic.data(), topic.data() + topic.size(), nullptr, 0, value.data(),
+        value.size(), false, *mc.Pool, mc.MsgStateTracker);
+    msg->SetPartition(partition);
+    return msg;
+  }
+
+  /* For each message list in 'msg_sets', return an item consisting of the
+     values of its messages separated by spaces.  Mark all messages as
+     processed. */
+  std::vector<std::string> Describe(
+      std::list<std::list<TMsg::TPtr>> &&msg_sets) {
+    std::vector<std::string> result;
+
+    for (const std::list<TMsg::TPtr> &msg_list :
+        SetProcessed(std::move(msg_sets))) {
+      std::string item;
+
+      for (const TMsg::TPtr &msg : msg_list) {
+        Capped::TReader reader(&msg->GetKeyAndValue());
+        reader.Skip(msg->GetKeySize());
+        std::vector<char> buf(msg->GetValueSize());
+        reader.Read(&buf[0], buf.size());
+
+        if (!item.empty()) {
+          item += ' ';
+        }
+
+        item.append(buf.begin(), buf.end());
+      }
+
+      result.push_back(item);
+    }
+
+    return result;
+  }
+
+  size_t FindBrokerIndex(const TMetadata &md, int32_t broker_id) {
+    const std::vector<TMetadata::TBroker> &brokers = md.GetBrokers();
+
+    for (size_t i = 0; i < brokers.size(); ++i) {
+      if (brokers[i].GetId() == broker_id) {
+        return i;
+      }
+    }
+
+    ADD_FAILURE() << "broker " << broker_id << " not found";
+    return 0;
+  }
+
+  TEST_F(TPartitionRetryQueueTest, PutAndTakeAll) {
+    TTestMsgCreator mc;
+    TPartitionRetryQueue queue;
+    ASSERT_FALSE(queue.GetFd().IsReadableIntr());
+    ASSERT_TRUE(queue.TakeAll().empty());
+
+    /* Putting an empty list of message sets is a no-op. */
+    queue.Put(std::list<std::list<TMsg::TPtr>>());
+    ASSERT_FALSE(queue.GetFd().IsReadableIntr());
+
+    std::list<TMsg::TPtr> msg_set;
+    msg_set.push_back(mc.NewMsg("t1", "a1", 0));
+    msg_set.push_back(mc.NewMsg("t1", "a2", 0));
+    queue.Put(std::move(msg_set));
+    ASSERT_TRUE(queue.GetFd().IsReadableIntr());
+
+    std::list<std::list<TMsg::TPtr>> msg_sets;
+    msg_sets.emplace_back();
+    msg_sets.back().push_back(mc.NewMsg("t2", "b1", 0));
+    msg_sets.emplace_back();
+    msg_sets.back().push_back(mc.NewMsg("t3", "c1", 0));
+    queue.Put(std::move(msg_sets));
+    ASSERT_TRUE(queue.GetFd().IsReadableIntr());
+
+    ASSERT_EQ(Describe(queue.TakeAll()),
+        std::vector<std::string>({"a1 a2", "b1", "c1"}));
+    ASSERT_FALSE(queue.GetFd().IsReadableIntr());
+    ASSERT_TRUE(queue.TakeAll().empty());
+
+    /* The queue becomes readable again after being emptied. */
+    msg_set.push_back(mc.NewMsg("t1", "a3", 0));
+    queue.Put(std::move(msg_set));
+    ASSERT_TRUE(queue.GetFd().IsReadableIntr());
+    ASSERT_EQ(Describe(queue.TakeAll()), std::vector<std::string>({"a3"}));
+    ASSERT_FALSE(queue.GetFd().IsReadableIntr());
+  }
+
+  TEST_F(TPartitionRetryQueueTest, TakeUnsendableMsgs) {
+    TMetadata::TBuilder builder;
+    builder.OpenBrokerList();
+    builder.AddBroker(1, "host1", 9092);
+    builder.AddBroker(2, "host2", 9092);
+    builder.CloseBrokerList();
+    ASSERT_TRUE(builder.OpenTopic("t1"));
+    builder.AddPartitionToTopic(0, 1, true, 0);
+    builder.AddPartitionToTopic(1, 2, true, 0);
+    builder.AddPartitionToTopic(2, 1, false, 5);  // out of service partition
+    builder.CloseTopic();
+    ASSERT_TRUE(builder.OpenTopic("t2"));
+    builder.AddPartitionToTopic(0, 2, true, 0);
+    builder.CloseTopic();
+    std::unique_ptr<TMetadata> md(builder.Build());
+    ASSERT_TRUE(!!md);
+    const size_t broker_index = FindBrokerIndex(*md, 1);
+
+    TTestMsgCreator mc;
+    std::list<std::list<TMsg::TPtr>> batch;
+
+    /* Topic t1 has a partition led by broker 1, but t2 does not. */
+    batch.emplace_back();
+    batch.back().push_back(mc.NewMsg("t1", "any_t1_a", 0));
+    batch.back().push_back(mc.NewMsg("t1", "any_t1_b", 0));
+    batch.emplace_back();
+    batch.back().push_back(mc.NewMsg("t2", "any_t2", 0));
+
+    /* Only partition 0 of t1 is OK and led by broker 1.  Partition 1 has
+       moved to broker 2, partition 2 is out of service, partition 3 doesn't
+       exist, and topic t3 doesn't exist. */
+    batch.emplace_back();
+    batch.back().push_back(NewKeyMsg(mc, "t1", 0, "key_t1_p0_a"));
+    batch.back().push_back(NewKeyMsg(mc, "t1", 1, "key_t1_p1"));
+    batch.back().push_back(NewKeyMsg(mc, "t1", 0, "key_t1_p0_b"));
+    batch.back().push_back(NewKeyMsg(mc, "t1", 2, "key_t1_p2"));
+    batch.back().push_back(NewKeyMsg(mc, "t1", 3, "key_t1_p3"));
+    batch.emplace_back();
+    batch.back().push_back(NewKeyMsg(mc, "t3", 0, "key_t3_p0"));
+
+    std::list<std::list<TMsg::TPtr>> unsendable =
+        TakeUnsendableMsgs(batch, *md, broker_index);
+    ASSERT_EQ(Describe(std::move(unsendable)),
+        std::vector<std::string>({"any_t2", "key_t1_p1 key_t1_p2 key_t1_p3",
+            "key_t3_p0"}));
+
+    /* Emptied message lists are removed from the batch, and order is
+       preserved for the rest. */
+    ASSERT_EQ(Describe(std::move(batch)),
+        std::vector<std::string>({"any_t1_a any_t1_b",
+            "key_t1_p0_a key_t1_p0_b"}));
+
+    /* From broker 2's point of view, the AnyPartition messages for t1 and t2
+       are sendable, along with the message for partition 1 of t1. */
+    batch.emplace_back();
+    batch.back().push_back(mc.NewMsg("t1", "any_t1", 0));
+    batch.emplace_back();
+    batch.back().push_back(mc.NewMsg("t2", "any_t2", 0));
+    batch.emplace_back();
+    batch.back().push_back(NewKeyMsg(mc, "t1", 0, "key_t1_p0"));
+    batch.back().push_back(NewKeyMsg(mc, "t1", 1, "key_t1_p1"));
+    unsendable = TakeUnsendableMsgs(batch, *md, FindBrokerIndex(*md, 2));
+    ASSERT_EQ(Describe(std::move(unsendable)),
+        std::vector<std::string>({"key_t1_p0"}));
+    ASSERT_EQ(Describe(std::move(batch)),
+        std::vector<std::string>({"any_t1", "any_t2", "key_t1_p1"}));
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
@@ -21,10 +21,14 @@
 
 #include <dory/msg_dispatch/produce_request_factory.h>
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <unordered_set>
 
 #include <base/counter.h>
 #include <base/no_default_case.h>
+#include <dory/profiler.h>
 #include <log/log.h>
 
 using namespace Base;
@@ -44,8 +48,24 @@ DEFINE_COUNTER(BugMsgSetEmpty);
 DEFINE_COUNTER(BugMultiPartitionGroupEmpty);
 DEFINE_COUNTER(MsgSetCompressionError);
 DEFINE_COUNTER(MsgSetCompressionNo);
+DEFINE_COUNTER(MsgSetCompressionSkipped);
+DEFINE_COUNTER(MsgSetCompressionStreamed);
 DEFINE_COUNTER(MsgSetCompressionYes);
 DEFINE_COUNTER(MsgSetNotCompressible);
+DEFINE_COUNTER(MsgSetUnsupportedCompressionType);
+DEFINE_COUNTER(ProduceRequestFill00To10);
+DEFINE_COUNTER(ProduceRequestFill10To20);
+DEFINE_COUNTER(ProduceRequestFill20To30);
+DEFINE_COUNTER(ProduceRequestFill30To40);
+DEFINE_COUNTER(ProduceRequestFill40To50);
+DEFINE_COUNTER(ProduceRequestFill50To60);
+DEFINE_COUNTER(ProduceRequestFill60To70);
+DEFINE_COUNTER(ProduceRequestFill70To80);
+DEFINE_COUNTER(ProduceRequestFill80To90);
+DEFINE_COUNTER(ProduceRequestFill90To100);
+DEFINE_COUNTER(ProduceRequestFillFull);
+DEFINE_COUNTER(ProduceRequestPackedMsg);
+DEFINE_COUNTER(ProduceRequestPackingSkipBatch);
 DEFINE_COUNTER(SerializeMsg);
 DEFINE_COUNTER(SerializeMsgSet);
 DEFINE_COUNTER(SerializeProduceRequest);
@@ -55,14 +75,18 @@ TProduceRequestFactory::TProduceRequestFactory(const TConf &conf,
     const TGlobalBatchConfig &batch_config,
     const TCompressionConf &compression_conf,
     const std::shared_ptr<TProduceProtocol> &produce_protocol,
-    size_t broker_index)
+    size_t broker_index, TCompressionStats &compression_stats)
     : Conf(conf),
       BrokerIndex(broker_index),
       ProduceProtocol(produce_protocol),
       ProduceRequestDataLimit(batch_config.GetProduceRequestDataLimit()),
+      RequestPacking(conf.BatchConf.ProduceRequestPacking),
       MessageMaxBytes(batch_config.GetMessageMaxBytes()),
       SingleMsgOverhead(produce_protocol->GetSingleMsgOverhead()),
+      MsgSetOverhead(produce_protocol->GetMsgSetOverhead()),
       MaxCompressionRatio(compression_conf.SizeThresholdPercent / 100.0f),
+      AdaptiveConf(compression_conf.AdaptiveConf),
+      CompressionStats(compression_stats),
       RequestWriter(produce_protocol->CreateProduceRequestWriter()),
       MsgSetWriter(produce_protocol->CreateMsgSetWriter()),
       DefaultTopicCompressionInfo(compression_conf.DefaultTopicConfig) {
@@ -74,11 +98,34 @@ void TProduceRequestFactory::Init(
     const std::shared_ptr<TMetadata> &md) {
   DefaultTopicCompressionInfo =
       TCompressionInfo(compression_conf.DefaultTopicConfig);
+  AdaptiveConf = compression_conf.AdaptiveConf;
   Metadata = md;
   CorrIdCounter = 0;
   InitTopicDataMap(compression_conf);
 }
 
+void TProduceRequestFactory::SetProduceProtocol(
+    const std::shared_ptr<TProduceProtocol> &produce_protocol) {
+  assert(produce_protocol);
+  ProduceProtocol = produce_protocol;
+  SingleMsgOverhead = produce_protocol->GetSingleMsgOverhead();
+  MsgSetOverhead = produce_protocol->GetMsgSetOverhead();
+  RequestWriter = produce_protocol->CreateProduceRequestWriter();
+  MsgSetWriter = produce_protocol->CreateMsgSetWriter();
+}
+
+void TProduceRequestFactory::UpdateMetadata(
+    const std::shared_ptr<TMetadata> &md) {
+  assert(md);
+  assert(Metadata);
+  assert(md->GetBrokers().size() == Metadata->GetBrokers().size());
+  Metadata = md;
+
+  for (auto &item : TopicDataMap) {
+    item.second.AnyPartitionChooser.ClearChoice();
+  }
+}
+
 void TProduceRequestFactory::Reset() {
   Metadata.reset();
   CorrIdCounter = 0;
@@ -117,8 +164,8 @@ std::optional<TProduceRequest> TProduceRequestFactory::BuildRequest(
 
     for (const auto &partition_group_elem : partition_group) {
       RequestWriter->OpenMsgSet(partition_group_elem.first);
-      WriteOneMsgSet(partition_group_elem.second,
-          GetTopicData(topic).CompressionInfo, dst);
+      WriteOneMsgSet(topic, partition_group_elem.second, GetTopicData(topic),
+          dst);
       RequestWriter->CloseMsgSet();
       SerializeMsgSet.Increment();
     }
@@ -198,12 +245,12 @@ TProduceRequestFactory::GetTopicData(const std::string &topic) {
 /* This function should _never_ get called.  It's a damage containment
    mechanism in case of a bug. */
 static bool MultipleTopicBugFixup(
-    std::list<std::list<TMsg::TPtr>> &input_queue) {
+    std::list<std::list<TMsg::TPtr>> &input_queue,
+    std::list<std::list<TMsg::TPtr>>::iterator iter) {
   BugMsgListMultipleTopics.Increment();
   LOG_R(TPri::ERR, std::chrono::seconds(30))
       << "Bug!!! Msg list has multiple topics";
   assert(false);
-  auto iter = input_queue.begin();
   assert(iter != input_queue.end());
   std::list<TMsg::TPtr> single_item_list;
   single_item_list.splice(single_item_list.begin(), *iter,
@@ -211,13 +258,32 @@ static bool MultipleTopicBugFixup(
   auto next_iter = iter;
   ++next_iter;
   input_queue.insert(next_iter, std::move(single_item_list));
+  return iter->empty();
+}
 
-  if (iter->empty()) {
-    input_queue.pop_front();
-    return true;
+/* Histogram of how full produce requests are, relative to
+   produceRequestDataLimit, in buckets of 10 percent. */
+static TCounter * const FillCounters[] = {
+  &ProduceRequestFill00To10, &ProduceRequestFill10To20,
+  &ProduceRequestFill20To30, &ProduceRequestFill30To40,
+  &ProduceRequestFill40To50, &ProduceRequestFill50To60,
+  &ProduceRequestFill60To70, &ProduceRequestFill70To80,
+  &ProduceRequestFill80To90, &ProduceRequestFill90To100
+};
+
+static void RecordFillRatio(size_t data_size, size_t data_limit) {
+  if (data_limit == 0) {
+    /* Batch combining is disabled, so fill ratio is meaningless. */
+    return;
   }
 
-  return false;
+  if (data_size >= data_limit) {
+    ProduceRequestFillFull.Increment();
+    return;
+  }
+
+  const size_t num_buckets = sizeof(FillCounters) / sizeof(*FillCounters);
+  FillCounters[(data_size * num_buckets) / data_limit]->Increment();
 }
 
 static void SanityCheckRequestContents(TAllTopics &contents) {
@@ -282,7 +348,7 @@ size_t TProduceRequestFactory::AddFirstMsg(TAllTopics &result) {
 
   if (topic_data.CompressionInfo.CompressionCodec) {
     assert(msg_set.DataSize == 0);
-    msg_set.DataSize = data_size + SingleMsgOverhead;
+    msg_set.DataSize = data_size + SingleMsgOverhead + MsgSetOverhead;
   }
 
   msg_set.Contents.push_back(std::move(msg_ptr));
@@ -347,47 +413,79 @@ TAllTopics TProduceRequestFactory::BuildRequestContents() {
      the limit.  We don't check 'MessageMaxBytes' here because no single
      message that large will get this far. */
   if (result_data_size < ProduceRequestDataLimit) {
-    bool result_full = false;
-
-    while (!InputQueue.empty()) {
-      std::list<TMsg::TPtr> &next_batch = InputQueue.front();
+    /* When packing is enabled, these are the topics with a batch that we
+       couldn't fully consume.  Messages for these topics in later batches must
+       stay out of this request, since they would otherwise get ahead of the
+       messages left behind. */
+    std::unordered_set<std::string> blocked_topics;
+    size_t skip_count = 0;
+    auto iter = InputQueue.begin();
+
+    while (iter != InputQueue.end()) {
+      std::list<TMsg::TPtr> &next_batch = *iter;
       assert(!next_batch.empty());
       const std::string &topic = next_batch.front()->GetTopic();
-      TTopicData &topic_data = GetTopicData(topic);
+      bool batch_full = !blocked_topics.empty() && blocked_topics.count(topic);
 
-      for (; ; ) {
-        TMsg::TPtr &msg_ptr = next_batch.front();
+      if (!batch_full) {
+        TTopicData &topic_data = GetTopicData(topic);
 
-        if (msg_ptr->GetTopic() != topic) {
-          /* We should _never_ get here. */
-          if (MultipleTopicBugFixup(InputQueue)) {
-            break;
+        for (; ; ) {
+          TMsg::TPtr &msg_ptr = next_batch.front();
+
+          if (msg_ptr->GetTopic() != topic) {
+            /* We should _never_ get here. */
+            if (MultipleTopicBugFixup(InputQueue, iter)) {
+              break;
+            }
+
+            continue;
           }
 
-          continue;
-        }
+          batch_full = !TryConsumeFrontMsg(next_batch, topic, topic_data,
+                                           result_data_size, result);
 
-        result_full = !TryConsumeFrontMsg(next_batch, topic, topic_data,
-                                          result_data_size, result);
+          if (batch_full) {
+            break;
+          }
 
-        if (result_full) {
-          break;
-        }
+          if (!blocked_topics.empty()) {
+            ProduceRequestPackedMsg.Increment();
+          }
 
-        next_batch.pop_front();
+          next_batch.pop_front();
 
-        if (next_batch.empty()) {
-          InputQueue.pop_front();
-          break;
+          if (next_batch.empty()) {
+            break;
+          }
         }
       }
 
-      if (result_full) {
+      if (next_batch.empty()) {
+        iter = InputQueue.erase(iter);
+        continue;
+      }
+
+      assert(batch_full);
+
+      /* Without packing, the request is done once a batch doesn't fit.  With
+         packing, skip the batch and try to fill the remaining space with
+         later batches for other topics.  To bound the work done per request,
+         give up after skipping PACKING_MAX_SKIP batches. */
+      if (!RequestPacking || (result_data_size >= ProduceRequestDataLimit) ||
+          (skip_count >= PACKING_MAX_SKIP)) {
         break;
       }
+
+      ProduceRequestPackingSkipBatch.Increment();
+      ++skip_count;
+      blocked_topics.insert(topic);
+      ++iter;
     }
   }
 
+  RecordFillRatio(result_data_size, ProduceRequestDataLimit);
+
   for (auto &elem : result) {
     GetTopicData(elem.first).AnyPartitionChooser.ClearChoice();
   }
@@ -404,7 +502,8 @@ void TProduceRequestFactory::SerializeUncompressedMsgSet(
     const TMsg &msg = *msg_ptr;
     size_t key_size = msg.GetKeySize();
     size_t value_size = msg.GetValueSize();
-    RequestWriter->OpenMsg(TCompressionType::None, key_size, value_size);
+    RequestWriter->OpenMsg(TCompressionType::None, msg.GetTimestamp(),
+        key_size, value_size);
     size_t key_offset = RequestWriter->GetCurrentMsgKeyOffset();
     assert(dst.size() >= key_offset);
     assert((dst.size() - key_offset) >= key_size);
@@ -418,16 +517,18 @@ void TProduceRequestFactory::SerializeUncompressedMsgSet(
   }
 }
 
-void TProduceRequestFactory::SerializeToCompressionBuf(
+TMsg::TTimestamp TProduceRequestFactory::SerializeToCompressionBuf(
     const std::list<TMsg::TPtr> &msg_set) {
   assert(!msg_set.empty());
   MsgSetWriter->OpenMsgSet(CompressionBuf, false);
+  TMsg::TTimestamp max_timestamp = msg_set.front()->GetTimestamp();
 
   for (const TMsg::TPtr &msg_ptr : msg_set) {
     const TMsg &msg = *msg_ptr;
     size_t key_size = msg.GetKeySize();
     size_t value_size = msg.GetValueSize();
-    MsgSetWriter->OpenMsg(TCompressionType::None, key_size, value_size);
+    MsgSetWriter->OpenMsg(TCompressionType::None, msg.GetTimestamp(),
+        key_size, value_size);
     size_t key_offset = MsgSetWriter->GetCurrentMsgKeyOffset();
     assert(CompressionBuf.size() >= key_offset);
     assert((CompressionBuf.size() - key_offset) >= key_size);
@@ -437,41 +538,252 @@ void TProduceRequestFactory::SerializeToCompressionBuf(
     WriteKey(&CompressionBuf[0] + key_offset, msg);
     WriteValue(&CompressionBuf[0] + value_offset, msg);
     MsgSetWriter->CloseMsg();
+    max_timestamp = std::max(max_timestamp, msg.GetTimestamp());
     SerializeMsg.Increment();
   }
 
   MsgSetWriter->CloseMsgSet();
+  return max_timestamp;
+}
+
+TCompressionCodecApi::TStreamCompressor *
+TProduceRequestFactory::GetStreamCompressor(TCompressionType type,
+    const TCompressionCodecApi &codec) {
+  if (!MsgSetWriter->SupportsMsgFraming()) {
+    return nullptr;
+  }
+
+  auto iter = StreamCompressors.find(type);
+
+  if (iter == StreamCompressors.end()) {
+    /* The result is null if the codec doesn't support streaming.  Remember
+       that too, so we don't keep asking. */
+    iter = StreamCompressors.insert(
+        std::make_pair(type, codec.CreateStreamCompressor())).first;
+  }
+
+  return iter->second.get();
+}
+
+TMsg::TTimestamp TProduceRequestFactory::FrameMsgSet(
+    const std::list<TMsg::TPtr> &msg_set, size_t &uncompressed_size) {
+  assert(!msg_set.empty());
+  MsgFramings.resize(msg_set.size());
+  const TMsg::TTimestamp first_timestamp = msg_set.front()->GetTimestamp();
+  TMsg::TTimestamp max_timestamp = first_timestamp;
+  uncompressed_size = 0;
+  size_t i = 0;
+
+  for (const TMsg::TPtr &msg_ptr : msg_set) {
+    const TMsg &msg = *msg_ptr;
+    TMsgSetWriterApi::TMsgFraming &framing = MsgFramings[i];
+    MsgSetWriter->FrameMsg(i, first_timestamp, msg.GetTimestamp(),
+        msg.GetKeySize(), msg.GetValueSize(), framing);
+    uncompressed_size += framing.GetOverheadSize() +
+        msg.GetKeyAndValue().Size();
+    max_timestamp = std::max(max_timestamp, msg.GetTimestamp());
+    ++i;
+  }
+
+  return max_timestamp;
+}
+
+namespace {
+
+  /* Context for StreamKeyAndValueBlock(). */
+  struct TStreamBlockContext {
+    TCompressionCodecApi::TStreamCompressor *Stream;
+
+    const TMsgSetWriterApi::TMsgFraming *Framing;
+
+    /* Number of key bytes not yet written to 'Stream'. */
+    size_t KeyBytesLeft;
+  };  // TStreamBlockContext
+
+}  // namespace
+
+/* Callback for Capped::TBlob::ForEachBlock().  A message blob contains the
+   key followed by the value, so the framing that goes between them is written
+   once the last key byte has been written. */
+static bool StreamKeyAndValueBlock(const void *data, size_t size,
+    TStreamBlockContext *ctx) {
+  const auto *pos = reinterpret_cast<const uint8_t *>(data);
+
+  if (ctx->KeyBytesLeft) {
+    size_t key_part = std::min(size, ctx->KeyBytesLeft);
+    ctx->Stream->Write(pos, key_part);
+    pos += key_part;
+    size -= key_part;
+    ctx->KeyBytesLeft -= key_part;
+
+    if (ctx->KeyBytesLeft == 0) {
+      ctx->Stream->Write(ctx->Framing->BeforeValue,
+          ctx->Framing->BeforeValueSize);
+    }
+  }
+
+  ctx->Stream->Write(pos, size);
+  return true;
+}
+
+size_t TProduceRequestFactory::StreamCompressMsgSet(
+    TCompressionCodecApi::TStreamCompressor &stream,
+    const std::list<TMsg::TPtr> &msg_set, size_t uncompressed_size,
+    std::optional<int> level, std::vector<uint8_t> &dst) {
+  assert(MsgFramings.size() == msg_set.size());
+  stream.Begin(dst, uncompressed_size, level);
+  size_t i = 0;
+
+  for (const TMsg::TPtr &msg_ptr : msg_set) {
+    const TMsg &msg = *msg_ptr;
+    const TMsgSetWriterApi::TMsgFraming &framing = MsgFramings[i];
+    stream.Write(framing.BeforeKey, framing.BeforeKeySize);
+    TStreamBlockContext ctx = { &stream, &framing, msg.GetKeySize() };
+
+    if (ctx.KeyBytesLeft == 0) {
+      stream.Write(framing.BeforeValue, framing.BeforeValueSize);
+    }
+
+    msg.GetKeyAndValue().ForEachBlock(StreamKeyAndValueBlock, &ctx);
+    stream.Write(framing.AfterValue, framing.AfterValueSize);
+    SerializeMsg.Increment();
+    ++i;
+  }
+
+  MsgSetCompressionStreamed.Increment();
+  return stream.Finish();
+}
+
+bool TProduceRequestFactory::ShouldCompress(TTopicData &topic_data) {
+  if (!AdaptiveConf.Enable) {
+    return true;
+  }
+
+  const TCompressionInfo &info = topic_data.CompressionInfo;
+  assert(info.CompressionCodec);
+
+  if (!topic_data.AdaptiveCompression.has_value()) {
+    topic_data.AdaptiveCompression.emplace(AdaptiveConf, MaxCompressionRatio,
+        info.CompressionLevel,
+        info.CompressionCodec->GetFastestCompressionLevel());
+  }
+
+  if (topic_data.AdaptiveCompression->ShouldCompress()) {
+    return true;
+  }
+
+  MsgSetCompressionSkipped.Increment();
+  return false;
 }
 
-void TProduceRequestFactory::WriteOneMsgSet(const TMsgSet &msg_set,
-    const TCompressionInfo &info, std::vector<uint8_t> &dst) {
-  if (info.CompressionCodec && (msg_set.DataSize >= info.MinCompressionSize)) {
-    SerializeToCompressionBuf(msg_set.Contents);
+void TProduceRequestFactory::RecordCompressionResult(const std::string &topic,
+    TTopicData &topic_data, size_t uncompressed_size, size_t compressed_size,
+    uint64_t elapsed_ns, bool sent_compressed) {
+  if (!topic_data.AdaptiveCompression.has_value()) {
+    return;
+  }
+
+  TAdaptiveCompression &adaptive = *topic_data.AdaptiveCompression;
+  adaptive.RecordResult(uncompressed_size, compressed_size, elapsed_ns);
+  TCompressionStats::TTopicInfo stats;
+  stats.Topic = topic;
+  assert(Metadata);
+  assert(BrokerIndex < Metadata->GetBrokers().size());
+  stats.BrokerId = Metadata->GetBrokers()[BrokerIndex].GetId();
+  stats.Type = topic_data.CompressionInfo.CompressionType;
+  stats.ConfiguredLevel = topic_data.CompressionInfo.CompressionLevel;
+  stats.Level = adaptive.GetLevel();
+  stats.State = ToString(adaptive.GetState());
+  stats.AvgRatio = adaptive.GetAvgRatio();
+  stats.AvgNsPerByte = adaptive.GetAvgNsPerByte();
+  stats.SampleCount = adaptive.GetSampleCount();
+  stats.CompressedCount = sent_compressed ? 1 : 0;
+  stats.NotCompressibleCount = sent_compressed ? 0 : 1;
+  stats.SkippedCount = adaptive.TakeSkipCount();
+  CompressionStats.Update(stats);
+}
+
+void TProduceRequestFactory::WriteOneMsgSet(const std::string &topic,
+    const TMsgSet &msg_set, TTopicData &topic_data,
+    std::vector<uint8_t> &dst) {
+  const TCompressionInfo &info = topic_data.CompressionInfo;
+
+  if (info.CompressionCodec &&
+      !ProduceProtocol->SupportsCompressionType(info.CompressionType)) {
+    /* This happens when a topic is configured for zstd compression, but the
+       broker we negotiated with doesn't support a new enough produce API
+       version.  Send the data uncompressed rather than have the broker reject
+       it. */
+    MsgSetUnsupportedCompressionType.Increment();
+    LOG_R(TPri::WARNING, std::chrono::seconds(30))
+        << "Sending message set uncompressed since produce API version does "
+        << "not support compression type " << ToString(info.CompressionType);
+  } else if (info.CompressionCodec &&
+      (msg_set.DataSize >= info.MinCompressionSize) &&
+      ShouldCompress(topic_data)) {
     assert(info.CompressionCodec);
     const TCompressionCodecApi &codec = *info.CompressionCodec;
+    const std::optional<int> level = topic_data.AdaptiveCompression ?
+        topic_data.AdaptiveCompression->GetLevel() : info.CompressionLevel;
+    TCompressionCodecApi::TStreamCompressor *stream = nullptr;
     bool msg_opened = false;
 
     try {
-      /* Kafka compresses individual message sets.  A message set is compressed
-         and encapsulated within a single message whose attributes are set to
-         indicate that it contains a compressed message set. */
-      size_t max_compressed_size = codec.ComputeCompressedResultBufSpace(
-          &CompressionBuf[0], CompressionBuf.size(), info.CompressionLevel);
-      RequestWriter->OpenMsg(info.CompressionType, 0,
-          max_compressed_size);
+      /* If possible, stream the message set directly from the message blobs
+         into the compressor, which writes straight into 'dst'.  Otherwise
+         serialize the message set to 'CompressionBuf' and compress it from
+         there into worst-case sized space reserved in 'dst'. */
+      stream = GetStreamCompressor(info.CompressionType, codec);
+      size_t uncompressed_size = 0;
+      TMsg::TTimestamp max_timestamp = 0;
+      size_t max_compressed_size = 0;
+
+      if (stream) {
+        max_timestamp = FrameMsgSet(msg_set.Contents, uncompressed_size);
+      } else {
+        max_timestamp = SerializeToCompressionBuf(msg_set.Contents);
+        uncompressed_size = CompressionBuf.size();
+        max_compressed_size = codec.ComputeCompressedResultBufSpace(
+            &CompressionBuf[0], CompressionBuf.size(), level);
+      }
+
+      /* Kafka compresses individual message sets.  Depending on the protocol
+         version, a compressed message set is either encapsulated within a
+         single message whose attributes are set to indicate that it contains a
+         compressed message set, or written as the body of a record batch
+         whose attributes indicate compression. */
+      RequestWriter->OpenCompressedMsg(info.CompressionType,
+          msg_set.Contents.size(), msg_set.Contents.front()->GetTimestamp(),
+          max_timestamp, max_compressed_size);
       msg_opened = true;
       size_t value_offset = RequestWriter->GetCurrentMsgValueOffset();
       assert(dst.size() >= value_offset);
       assert((dst.size() - value_offset) == max_compressed_size);
-      size_t compressed_size = codec.Compress(&CompressionBuf[0],
-          CompressionBuf.size(), &dst[value_offset], max_compressed_size,
-          info.CompressionLevel);
+      const auto start = std::chrono::steady_clock::now();
+      size_t compressed_size = 0;
+
+      {
+        TProfiler::TPhaseScope compression_phase(
+            TProfiler::TPhase::Compression);
+        compressed_size = stream ?
+            StreamCompressMsgSet(*stream, msg_set.Contents, uncompressed_size,
+                level, dst) :
+            codec.Compress(&CompressionBuf[0], CompressionBuf.size(),
+                &dst[value_offset], max_compressed_size, level);
+      }
+
+      const auto elapsed_ns = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - start).count());
       /* If we get this far, compression finished without errors. */
 
       float compression_ratio = static_cast<float>(compressed_size) /
-          static_cast<float>(CompressionBuf.size());
+          static_cast<float>(uncompressed_size);
+      const bool send_compressed = (compression_ratio <= MaxCompressionRatio);
+      RecordCompressionResult(topic, topic_data, uncompressed_size,
+          compressed_size, elapsed_ns, send_compressed);
 
-      if (compression_ratio <= MaxCompressionRatio) {
+      if (send_compressed) {
         /* Send the data compressed. */
         RequestWriter->AdjustValueSize(compressed_size);
         RequestWriter->CloseMsg();
@@ -481,12 +793,10 @@ void TProduceRequestFactory::WriteOneMsgSet(const TMsgSet &msg_set,
 
       /* If we get here, we wasted some CPU cycles on data that didn't compress
          very well.  Send it uncompressed so the broker avoids wasting more CPU
-         cycles dealing with the compression.
-
-         TODO: Add a per-topic compression statistics reporting feature to
-         Dory's web interface.  This would facilitate identifying topics that
-         don't compress very well, so Dory's compression config can be
-         adjusted. */
+         cycles dealing with the compression.  If adaptive compression is
+         enabled, it will stop trying to compress the topic if this keeps
+         happening.  Its per-topic statistics are available from Dory's web
+         interface. */
       RequestWriter->RollbackOpenMsg();
       MsgSetNotCompressible.Increment();
     } catch (const TCompressionCodecApi::TError &x) {
@@ -494,6 +804,10 @@ void TProduceRequestFactory::WriteOneMsgSet(const TMsgSet &msg_set,
       LOG_R(TPri::ERR, std::chrono::seconds(30))
           << "Error compressing message set: " << x.what();
 
+      if (stream) {
+        stream->Abort();
+      }
+
       if (msg_opened) {
         RequestWriter->RollbackOpenMsg();
       }
@@ -25,6 +25,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <list>
+#include <map>
 #include <memory>
 #include <optional>
 #include <string>
@@ -37,6 +38,7 @@
 #include <dory/compress/compression_codec_api.h>
 #include <dory/compress/compression_type.h>
 #include <dory/compress/get_compression_codec.h>
+#include <dory/compression_stats.h>
 #include <dory/conf/compression_conf.h>
 #include <dory/conf/conf.h>
 #include <dory/debug/debug_logger.h>
@@ -45,6 +47,7 @@
 #include <dory/kafka_proto/produce/produce_request_writer_api.h>
 #include <dory/metadata.h>
 #include <dory/msg.h>
+#include <dory/msg_dispatch/adaptive_compression.h>
 #include <dory/msg_dispatch/any_partition_chooser.h>
 #include <dory/msg_dispatch/common.h>
 #include <dory/util/msg_util.h>
@@ -57,16 +60,32 @@ namespace Dory {
       NO_COPY_SEMANTICS(TProduceRequestFactory);
 
       public:
+      /* Maximum number of batches BuildRequest() will skip over when packing
+         a request. */
+      static const size_t PACKING_MAX_SKIP = 64;
+
       TProduceRequestFactory(const Conf::TConf &conf,
           const Batch::TGlobalBatchConfig &batch_config,
           const Conf::TCompressionConf &compression_conf,
           const std::shared_ptr<KafkaProto::Produce::TProduceProtocol>
               &produce_protocol,
-          size_t broker_index);
+          size_t broker_index, TCompressionStats &compression_stats);
 
       void Init(const Conf::TCompressionConf &compression_conf,
                 const std::shared_ptr<TMetadata> &md);
 
+      /* Replace the produce protocol passed to the constructor.  Called by
+         the connector thread once it has negotiated a produce API version
+         with its broker, before any produce requests are built. */
+      void SetProduceProtocol(
+          const std::shared_ptr<KafkaProto::Produce::TProduceProtocol>
+              &produce_protocol);
+
+      /* Replace the metadata passed to Init() while messages may still be
+         queued.  Partition choices for AnyPartition messages are made again
+         based on the new metadata. */
+      void UpdateMetadata(const std::shared_ptr<TMetadata> &md);
+
       void Reset();
 
       bool IsEmpty() const {
@@ -150,6 +169,11 @@ namespace Dory {
 
         TAnyPartitionChooser AnyPartitionChooser;
 
+        /* This is only used when adaptive compression is enabled.  It is
+           created when the topic's first message set large enough to compress
+           is seen. */
+        std::optional<TAdaptiveCompression> AdaptiveCompression;
+
         explicit TTopicData(const Conf::TCompressionConf::TConf &conf);
 
         explicit TTopicData(const TCompressionInfo &info);
@@ -170,34 +194,80 @@ namespace Dory {
       void SerializeUncompressedMsgSet(const std::list<TMsg::TPtr> &msg_set,
           std::vector<uint8_t> &dst);
 
-      void SerializeToCompressionBuf(const std::list<TMsg::TPtr> &msg_set);
-
-      void WriteOneMsgSet(const TMsgSet &msg_set, const TCompressionInfo &info,
-          std::vector<uint8_t> &dst);
+      /* Serialize 'msg_set' to 'CompressionBuf' and return the maximum
+         timestamp of the messages it contains. */
+      TMsg::TTimestamp SerializeToCompressionBuf(
+          const std::list<TMsg::TPtr> &msg_set);
+
+      /* Return a stream compressor for compression type 'type', or null if
+         either the codec or the produce protocol's message format doesn't
+         support streaming. */
+      Compress::TCompressionCodecApi::TStreamCompressor *GetStreamCompressor(
+          Compress::TCompressionType type,
+          const Compress::TCompressionCodecApi &codec);
+
+      /* Compute framing for each message in 'msg_set', storing the results in
+         'MsgFramings'.  Set 'uncompressed_size' to the serialized size of the
+         message set, and return the maximum timestamp of the messages it
+         contains. */
+      TMsg::TTimestamp FrameMsgSet(const std::list<TMsg::TPtr> &msg_set,
+          size_t &uncompressed_size);
+
+      /* Compress 'msg_set', which FrameMsgSet() has been called for, by
+         streaming message framing, keys, and values directly from the
+         messages into 'stream'.  The compressed result is appended to 'dst'.
+         Return its size. */
+      size_t StreamCompressMsgSet(
+          Compress::TCompressionCodecApi::TStreamCompressor &stream,
+          const std::list<TMsg::TPtr> &msg_set, size_t uncompressed_size,
+          std::optional<int> level, std::vector<uint8_t> &dst);
+
+      /* Returns false if adaptive compression has decided that the next
+         message set for the topic should be sent uncompressed without trying
+         to compress it. */
+      bool ShouldCompress(TTopicData &topic_data);
+
+      /* Update adaptive compression state for a topic after compressing a
+         message set, and report the result via 'CompressionStats'. */
+      void RecordCompressionResult(const std::string &topic,
+          TTopicData &topic_data, size_t uncompressed_size,
+          size_t compressed_size, uint64_t elapsed_ns, bool sent_compressed);
+
+      void WriteOneMsgSet(const std::string &topic, const TMsgSet &msg_set,
+          TTopicData &topic_data, std::vector<uint8_t> &dst);
 
       const Conf::TConf &Conf;
 
       const size_t BrokerIndex;
 
-      const std::shared_ptr<KafkaProto::Produce::TProduceProtocol>
-          ProduceProtocol;
+      std::shared_ptr<KafkaProto::Produce::TProduceProtocol> ProduceProtocol;
 
       const size_t ProduceRequestDataLimit;
 
+      /* If true, BuildRequestContents() tries to fill the space left by a
+         batch that doesn't fit with later batches for other topics.  See
+         produceRequestPacking in the config file. */
+      const bool RequestPacking;
+
       const size_t MessageMaxBytes;
 
-      const size_t SingleMsgOverhead;
+      size_t SingleMsgOverhead;
+
+      size_t MsgSetOverhead;
 
       /* If (compressed message set size / uncompressed message set size)
          exceeds this value, then we send it uncompressed so the broker avoids
          spending CPU cycles dealing with the compression. */
       const float MaxCompressionRatio;
 
-      const std::unique_ptr<KafkaProto::Produce::TProduceRequestWriterApi>
+      Conf::TCompressionConf::TAdaptiveConf AdaptiveConf;
+
+      TCompressionStats &CompressionStats;
+
+      std::unique_ptr<KafkaProto::Produce::TProduceRequestWriterApi>
           RequestWriter;
 
-      const std::unique_ptr<KafkaProto::Produce::TMsgSetWriterApi>
-          MsgSetWriter;
+      std::unique_ptr<KafkaProto::Produce::TMsgSetWriterApi> MsgSetWriter;
 
       TCompressionInfo DefaultTopicCompressionInfo;
 
@@ -214,8 +284,19 @@ namespace Dory {
 
       /* Compression work area.  A message set is first written here, and then
          compressed into the destination buffer for the serialized produce
-         request. */
+         request.  This is only used when a message set can't be streamed
+         into the compressor. */
       std::vector<uint8_t> CompressionBuf;
+
+      /* Stream compressors, created on first use.  A null value indicates a
+         compression type whose codec doesn't support streaming. */
+      std::map<Compress::TCompressionType,
+          std::unique_ptr<Compress::TCompressionCodecApi::TStreamCompressor>>
+          StreamCompressors;
+
+      /* Framing for each message in the message set being streamed. */
+      std::vector<KafkaProto::Produce::TMsgSetWriterApi::TMsgFraming>
+          MsgFramings;
     };  // TProduceRequestFactory
 
   }  // MsgDispatch
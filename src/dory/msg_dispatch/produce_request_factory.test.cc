@@ -0,0 +1,274 @@
+/* <dory/msg_dispatch/produce_request_factory.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/msg_dispatch/produce_request_factory.h>.
+ */
+
+#include <dory/msg_dispatch/produce_request_factory.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <base/tmp_file.h>
+#include <dory/batch/combined_topics_batcher.h>
+#include <dory/batch/global_batch_config.h>
+#include <dory/batch/per_topic_batcher.h>
+#include <dory/compression_stats.h>
+#include <dory/conf/conf.h>
+#include <dory/kafka_proto/produce/produce_protocol.h>
+#include <dory/kafka_proto/produce/version_util.h>
+#include <dory/metadata.h>
+#include <dory/msg.h>
+#include <dory/msg_creator.h>
+#include <dory/msg_dispatch/common.h>
+#include <dory/test_util/misc_util.h>
+#include <dory/util/msg_util.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Batch;
+using namespace Dory::KafkaProto::Produce;
+using namespace Dory::MsgDispatch;
+using namespace Dory::TestUtil;
+using namespace Dory::Util;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TProduceRequestFactory. */
+  class TProduceRequestFactoryTest : public ::testing::Test {
+    protected:
+    TProduceRequestFactoryTest() = default;
+
+    ~TProduceRequestFactoryTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TProduceRequestFactoryTest
+
+  /* A produce request factory for broker index 0, along with the state it
+     references. */
+  struct TTestFactory final {
+    NO_COPY_SEMANTICS(TTestFactory);
+
+    Conf::TConf Conf;
+
+    TCompressionStats CompressionStats;
+
+    std::unique_ptr<TProduceRequestFactory> Factory;
+
+    TTestFactory(size_t data_limit, bool packing) {
+      Conf.BatchConf.ProduceRequestPacking = packing;
+      TGlobalBatchConfig batch_config(
+          std::shared_ptr<TPerTopicBatcher::TConfig>(),
+          TCombinedTopicsBatcher::TConfig(), data_limit, 1024 * 1024);
+      std::shared_ptr<TProduceProtocol> protocol(ChooseProduceProto(0));
+      Factory = std::make_unique<TProduceRequestFactory>(Conf, batch_config,
+          Conf.CompressionConf, protocol, 0, CompressionStats);
+      TMetadata::TBuilder builder;
+      builder.OpenBrokerList();
+      builder.AddBroker(1, "host1", 9092);
+      builder.CloseBrokerList();
+      Factory->Init(Conf.CompressionConf, builder.Build());
+    }
+  };  // TTestFactory
+
+  /* Create a message for 'topic' and 'partition' whose value is 'size'
+     bytes, starting with 'tag'. */
+  TMsg::TPtr NewMsg(TTestMsgCreator &mc, const std::string &topic,
+      int32_t partition, const std::string &tag, size_t size) {
+    std::string value(tag);
+    value.resize(size, '.');
+    TMsg::TPtr msg = TMsgCreator::CreatePartitionKeyMsg(partition, 0,
+        topic.data(), topic.data() + topic.size(), nullptr, 0, value.data(),
+        value.size(), false, *mc.Pool, mc.MsgStateTracker);
+    msg->SetPartition(partition);
+    SetProcessed(msg);
+    return msg;
+  }
+
+  /* Build a request from 'factory'.  For each message set in the request,
+     add an item to 'msg_sets' consisting of the message set's topic and
+     partition, followed by the tags of the messages it contains in order.
+     Return the total size of the message values. */
+  size_t BuildRequest(TProduceRequestFactory &factory,
+      std::vector<std::string> &msg_sets) {
+    msg_sets.clear();
+    std::vector<uint8_t> buf;
+    auto request = factory.BuildRequest(buf);
+    EXPECT_TRUE(request.has_value());
+    size_t data_size = 0;
+
+    if (!request) {
+      return data_size;
+    }
+
+    for (const auto &topic_elem : request->second) {
+      for (const auto &group_elem : topic_elem.second) {
+        std::string item = topic_elem.first + "/" +
+            std::to_string(group_elem.first) + ":";
+
+        for (const TMsg::TPtr &msg : group_elem.second.Contents) {
+          std::vector<uint8_t> value_buf;
+          WriteValue(value_buf, 0, *msg);
+          std::string value(value_buf.begin(), value_buf.end());
+          item += " " + value.substr(0, value.find('.'));
+          data_size += msg->GetValueSize();
+        }
+
+        msg_sets.push_back(item);
+      }
+    }
+
+    return data_size;
+  }
+
+  TEST_F(TProduceRequestFactoryTest, PackingKeepsOrder) {
+    TTestMsgCreator mc;
+    TTestFactory tf(100, true);
+    TProduceRequestFactory &factory = *tf.Factory;
+    std::list<TMsg::TPtr> batch;
+    batch.push_back(NewMsg(mc, "a", 0, "a1", 40));
+    batch.push_back(NewMsg(mc, "a", 1, "a2", 40));
+    batch.push_back(NewMsg(mc, "a", 0, "a3", 40));
+    factory.Put(std::move(batch));
+    batch.clear();
+    batch.push_back(NewMsg(mc, "b", 0, "b1", 10));
+    factory.Put(std::move(batch));
+    batch.clear();
+    batch.push_back(NewMsg(mc, "a", 0, "a4", 5));
+    batch.push_back(NewMsg(mc, "a", 1, "a5", 5));
+    factory.Put(std::move(batch));
+
+    /* Message a3 doesn't fit, so the batch for topic b is packed into the
+       space left over.  Messages a4 and a5 would also fit, but must stay out
+       of the request since they would get ahead of a3 for partition 0. */
+    std::vector<std::string> msg_sets;
+    ASSERT_EQ(BuildRequest(factory, msg_sets), 90U);
+    ASSERT_EQ(msg_sets,
+        std::vector<std::string>({"a/0: a1", "a/1: a2", "b/0: b1"}));
+    ASSERT_EQ(BuildRequest(factory, msg_sets), 50U);
+    ASSERT_EQ(msg_sets,
+        std::vector<std::string>({"a/0: a3 a4", "a/1: a5"}));
+    ASSERT_TRUE(factory.IsEmpty());
+  }
+
+  TEST_F(TProduceRequestFactoryTest, PackingSkipLimit) {
+    const size_t max_skip = TProduceRequestFactory::PACKING_MAX_SKIP;
+
+    for (size_t num_skipped = max_skip; num_skipped <= (max_skip + 1);
+         ++num_skipped) {
+      TTestMsgCreator mc;
+      TTestFactory tf(100, true);
+      TProduceRequestFactory &factory = *tf.Factory;
+      std::list<TMsg::TPtr> batch;
+      batch.push_back(NewMsg(mc, "first", 0, "first", 90));
+      factory.Put(std::move(batch));
+
+      /* Batches that don't fit in the space left by the first batch. */
+      for (size_t i = 0; i < num_skipped; ++i) {
+        batch.clear();
+        batch.push_back(NewMsg(mc, "big" + std::to_string(i), 0, "big", 20));
+        factory.Put(std::move(batch));
+      }
+
+      batch.clear();
+      batch.push_back(NewMsg(mc, "small", 0, "small", 10));
+      factory.Put(std::move(batch));
+
+      /* The last batch is packed only if reaching it requires skipping no
+         more than PACKING_MAX_SKIP batches. */
+      std::vector<std::string> msg_sets;
+      size_t data_size = BuildRequest(factory, msg_sets);
+
+      if (num_skipped <= max_skip) {
+        ASSERT_EQ(data_size, 100U);
+        ASSERT_EQ(msg_sets,
+            std::vector<std::string>({"first/0: first", "small/0: small"}));
+      } else {
+        ASSERT_EQ(data_size, 90U);
+        ASSERT_EQ(msg_sets, std::vector<std::string>({"first/0: first"}));
+      }
+
+      /* The remaining batches are sent in their original order. */
+      while (!factory.IsEmpty()) {
+        BuildRequest(factory, msg_sets);
+      }
+    }
+  }
+
+  TEST_F(TProduceRequestFactoryTest, PackingFillsRequest) {
+    for (bool packing : {false, true}) {
+      TTestMsgCreator mc;
+      TTestFactory tf(100, packing);
+      TProduceRequestFactory &factory = *tf.Factory;
+      std::list<TMsg::TPtr> batch;
+      batch.push_back(NewMsg(mc, "a", 0, "a1", 60));
+      batch.push_back(NewMsg(mc, "a", 0, "a2", 60));
+      factory.Put(std::move(batch));
+      batch.clear();
+      batch.push_back(NewMsg(mc, "b", 0, "b1", 30));
+      factory.Put(std::move(batch));
+      batch.clear();
+      batch.push_back(NewMsg(mc, "c", 0, "c1", 20));
+      factory.Put(std::move(batch));
+      batch.clear();
+      batch.push_back(NewMsg(mc, "d", 0, "d1", 10));
+      factory.Put(std::move(batch));
+      std::vector<std::string> msg_sets;
+
+      if (packing) {
+        /* Later batches that fit fill the request up to the limit. */
+        ASSERT_EQ(BuildRequest(factory, msg_sets), 100U);
+        ASSERT_EQ(msg_sets,
+            std::vector<std::string>({"a/0: a1", "b/0: b1", "d/0: d1"}));
+        ASSERT_EQ(BuildRequest(factory, msg_sets), 80U);
+        ASSERT_EQ(msg_sets, std::vector<std::string>({"a/0: a2", "c/0: c1"}));
+      } else {
+        /* Without packing, the request ends at the first batch that doesn't
+           fit. */
+        ASSERT_EQ(BuildRequest(factory, msg_sets), 60U);
+        ASSERT_EQ(msg_sets, std::vector<std::string>({"a/0: a1"}));
+        ASSERT_EQ(BuildRequest(factory, msg_sets), 90U);
+        ASSERT_EQ(msg_sets, std::vector<std::string>({"a/0: a2", "b/0: b1"}));
+        ASSERT_EQ(BuildRequest(factory, msg_sets), 30U);
+        ASSERT_EQ(msg_sets, std::vector<std::string>({"c/0: c1", "d/0: d1"}));
+      }
+
+      ASSERT_TRUE(factory.IsEmpty());
+    }
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
@@ -39,11 +39,13 @@ using namespace Log;
 DEFINE_COUNTER(ConnectorGotDiscardAck);
 DEFINE_COUNTER(ConnectorGotDiscardAndPauseAck);
 DEFINE_COUNTER(ConnectorGotOkProduceResponse);
+DEFINE_COUNTER(ConnectorGotPartitionRetryAck);
 DEFINE_COUNTER(ConnectorGotPauseAck);
 DEFINE_COUNTER(ConnectorGotResendAck);
 DEFINE_COUNTER(ConnectorGotSuccessfulAck);
 DEFINE_COUNTER(ConnectorQueueImmediateResendMsgSet);
 DEFINE_COUNTER(ConnectorQueueNoAckMsgs);
+DEFINE_COUNTER(ConnectorQueuePartitionRetryMsgSet);
 DEFINE_COUNTER(ConnectorQueuePauseAndResendMsgSet);
 DEFINE_COUNTER(CorrelationIdMismatch);
 DEFINE_COUNTER(DiscardOnFailedDeliveryAttemptLimit);
@@ -168,6 +170,22 @@ void TProduceResponseProcessor::ProcessPauseAndResendMsgSet(
   }
 }
 
+void TProduceResponseProcessor::ProcessPartitionRetryMsgSet(
+    std::list<TMsg::TPtr> &&msg_set, const std::string &topic) {
+  assert(!msg_set.empty());
+  CountFailedDeliveryAttempt(msg_set, topic);
+
+  if (!msg_set.empty()) {
+    ConnectorQueuePartitionRetryMsgSet.Increment();
+    LOG_R(TPri::ERR, std::chrono::seconds(30)) << "Connector thread "
+        << Gettid() << " (index " << MyBrokerIndex << " broker " << MyBrokerId
+        << ") queueing msg set (topic: [" << topic << "] partition "
+        << msg_set.front()->GetPartition() << ") for partition retry";
+    Ds.MsgStateTracker.MsgEnterSendWait(msg_set);
+    Ds.PartitionRetryQueue.Put(std::move(msg_set));
+  }
+}
+
 void TProduceResponseProcessor::ProcessNoAckMsgs(TAllTopics &all_topics) {
   std::list<std::list<TMsg::TPtr>> tmp;
   EmptyAllTopics(all_topics, tmp);
@@ -225,6 +243,20 @@ bool TProduceResponseProcessor::ProcessOneAck(std::list<TMsg::TPtr> &&msg_set,
       break;
     }
     case TAckResultAction::Pause: {
+      if (PartitionRetry) {
+        ConnectorGotPartitionRetryAck.Increment();
+        LOG_R(TPri::ERR, std::chrono::seconds(30)) << "Connector thread "
+            << Gettid() << " (index " << MyBrokerIndex << " broker "
+            << MyBrokerId
+            << ") got ACK error that triggers partition retry without pause";
+
+        /* Only this message set goes back to the router thread, which will
+           check the topic's metadata and reroute it.  Messages for other
+           partitions keep flowing. */
+        ProcessPartitionRetryMsgSet(std::move(msg_set), topic);
+        break;
+      }
+
       ConnectorGotPauseAck.Increment();
       LOG_R(TPri::ERR, std::chrono::seconds(30)) << "Connector thread "
           << Gettid() << " (index " << MyBrokerIndex << " broker "
@@ -57,12 +57,17 @@ namespace Dory {
         PauseAndFinishNow
       };  // TAction
 
+      /* If 'partition_retry' is true, a message set that gets an error ACK
+         which would normally trigger a pause is instead handed to the router
+         thread through the partition retry queue, without pausing. */
       TProduceResponseProcessor(
           KafkaProto::Produce::TProduceResponseReaderApi &response_reader,
           TDispatcherSharedState &ds, Debug::TDebugLogger &debug_logger,
-          unsigned long my_broker_index, long my_broker_id)
+          unsigned long my_broker_index, long my_broker_id,
+          bool partition_retry = false)
           : MyBrokerIndex(my_broker_index),
             MyBrokerId(my_broker_id),
+            PartitionRetry(partition_retry),
             Ds(ds),
             ResponseReader(response_reader),
             DebugLogger(debug_logger) {
@@ -132,6 +137,9 @@ namespace Dory {
       void ProcessPauseAndResendMsgSet(std::list<TMsg::TPtr> &&msg_set,
           const std::string &topic);
 
+      void ProcessPartitionRetryMsgSet(std::list<TMsg::TPtr> &&msg_set,
+          const std::string &topic);
+
       void ProcessNoAckMsgs(TAllTopics &all_topics);
 
       bool ProcessOneAck(std::list<TMsg::TPtr> &&msg_set, int16_t ack,
@@ -143,6 +151,8 @@ namespace Dory {
 
       const long MyBrokerId;
 
+      const bool PartitionRetry;
+
       TDispatcherSharedState &Ds;
 
       KafkaProto::Produce::TProduceResponseReaderApi &ResponseReader;
@@ -0,0 +1,45 @@
+/* <dory/msg_dispatch/published_metadata.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/msg_dispatch/published_metadata.h>.
+ */
+
+#include <dory/msg_dispatch/published_metadata.h>
+
+#include <cassert>
+
+using namespace Dory;
+using namespace Dory::MsgDispatch;
+
+void TPublishedMetadata::Publish(const std::shared_ptr<TMetadata> &md) {
+  assert(md);
+  std::lock_guard<std::mutex> lock(Mutex);
+  Metadata = md;
+  ++Generation;
+}
+
+std::shared_ptr<TMetadata> TPublishedMetadata::GetIfNewer(
+    uint64_t &generation) {
+  if (Generation.load() == generation) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  generation = Generation.load();
+  return Metadata;
+}
@@ -0,0 +1,72 @@
+/* <dory/msg_dispatch/published_metadata.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Handoff of updated metadata from the router thread to running connector
+   threads.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include <base/no_copy_semantics.h>
+#include <dory/metadata.h>
+
+namespace Dory {
+
+  namespace MsgDispatch {
+
+    /* The router thread calls Publish() to make new metadata available to
+       connector threads, which poll for it by calling GetIfNewer() at the
+       top of each iteration of their event loops.  Each call to Publish()
+       increments a generation number, so a connector can cheaply detect an
+       update without acquiring the mutex. */
+    class TPublishedMetadata final {
+      NO_COPY_SEMANTICS(TPublishedMetadata);
+
+      public:
+      TPublishedMetadata() = default;
+
+      /* Called by router thread. */
+      void Publish(const std::shared_ptr<TMetadata> &md);
+
+      /* Incremented each time Publish() is called. */
+      uint64_t GetGeneration() const noexcept {
+        return Generation.load();
+      }
+
+      /* Called by connector threads.  If the current generation differs from
+         'generation', return the most recently published metadata and set
+         'generation' to its generation number.  Otherwise return nullptr and
+         leave 'generation' unchanged. */
+      std::shared_ptr<TMetadata> GetIfNewer(uint64_t &generation);
+
+      private:
+      std::mutex Mutex;
+
+      std::shared_ptr<TMetadata> Metadata;
+
+      std::atomic<uint64_t> Generation{0};
+    };  // TPublishedMetadata
+
+  }  // MsgDispatch
+
+}  // Dory
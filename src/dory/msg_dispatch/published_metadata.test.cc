@@ -0,0 +1,146 @@
+/* <dory/msg_dispatch/published_metadata.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/msg_dispatch/published_metadata.h>.
+ */
+
+#include <dory/msg_dispatch/published_metadata.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <base/tmp_file.h>
+#include <dory/metadata.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::MsgDispatch;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TPublishedMetadata. */
+  class TPublishedMetadataTest : public ::testing::Test {
+    protected:
+    TPublishedMetadataTest() = default;
+
+    ~TPublishedMetadataTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TPublishedMetadataTest
+
+  std::shared_ptr<TMetadata> NewMetadata() {
+    TMetadata::TBuilder builder;
+    builder.OpenBrokerList();
+    builder.AddBroker(1, "host1", 9092);
+    builder.CloseBrokerList();
+    return builder.Build();
+  }
+
+  TEST_F(TPublishedMetadataTest, GenerationHandoff) {
+    TPublishedMetadata published;
+    ASSERT_EQ(published.GetGeneration(), 0U);
+
+    /* Nothing has been published yet. */
+    uint64_t generation = 0;
+    ASSERT_FALSE(published.GetIfNewer(generation));
+    ASSERT_EQ(generation, 0U);
+
+    std::shared_ptr<TMetadata> md1 = NewMetadata();
+    published.Publish(md1);
+    ASSERT_EQ(published.GetGeneration(), 1U);
+
+    /* A connector started with the current generation sees no update. */
+    uint64_t started_generation = published.GetGeneration();
+    ASSERT_FALSE(published.GetIfNewer(started_generation));
+    ASSERT_EQ(started_generation, 1U);
+
+    ASSERT_EQ(published.GetIfNewer(generation), md1);
+    ASSERT_EQ(generation, 1U);
+    ASSERT_FALSE(published.GetIfNewer(generation));
+    ASSERT_EQ(generation, 1U);
+
+    /* A consumer that falls behind gets only the most recent metadata. */
+    std::shared_ptr<TMetadata> md2 = NewMetadata();
+    std::shared_ptr<TMetadata> md3 = NewMetadata();
+    published.Publish(md2);
+    published.Publish(md3);
+    ASSERT_EQ(published.GetGeneration(), 3U);
+    ASSERT_EQ(published.GetIfNewer(generation), md3);
+    ASSERT_EQ(generation, 3U);
+    ASSERT_FALSE(published.GetIfNewer(generation));
+    ASSERT_EQ(published.GetIfNewer(started_generation), md3);
+    ASSERT_EQ(started_generation, 3U);
+  }
+
+  TEST_F(TPublishedMetadataTest, ConcurrentHandoff) {
+    const size_t num_updates = 1000;
+    std::vector<std::shared_ptr<TMetadata>> mds;
+
+    for (size_t i = 0; i < num_updates; ++i) {
+      mds.push_back(NewMetadata());
+    }
+
+    TPublishedMetadata published;
+    std::thread publisher([&published, &mds] {
+      for (const std::shared_ptr<TMetadata> &md : mds) {
+        published.Publish(md);
+      }
+    });
+
+    /* Each metadata object must always be returned along with the generation
+       number it was published with, and generation numbers must never go
+       backward. */
+    uint64_t generation = 0;
+    bool ok = true;
+
+    while (generation < num_updates) {
+      const uint64_t prev_generation = generation;
+      std::shared_ptr<TMetadata> md = published.GetIfNewer(generation);
+
+      if (md) {
+        ok = ok && (generation > prev_generation) &&
+            (generation <= num_updates) && (md == mds[generation - 1]);
+      } else {
+        ok = ok && (generation == prev_generation);
+      }
+    }
+
+    publisher.join();
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(generation, num_updates);
+    ASSERT_FALSE(published.GetIfNewer(generation));
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
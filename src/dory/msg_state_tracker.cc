@@ -21,33 +21,96 @@
 
 #include <dory/msg_state_tracker.h>
 
+#include <algorithm>
 #include <cassert>
 
+#include <base/counter.h>
 #include <base/no_default_case.h>
+#include <base/time_util.h>
+#include <dory/journal/journal.h>
 #include <log/log.h>
 
 using namespace Base;
 using namespace Dory;
 using namespace Log;
 
-void TMsgStateTracker::MsgEnterNew() noexcept {
-  std::lock_guard<std::mutex> lock(Mutex);
-  ++NewCount;
-  assert(NewCount > 0);
+DEFINE_COUNTER(MsgStateTrackerTooManyTopics);
+
+namespace {
+
+  std::atomic<uint64_t> NextTrackerId{1};
+
+}
+
+TMsgStateTracker::TThreadState::TThreadState(size_t chunk_count)
+    : ChunkCount(chunk_count),
+      Chunks(new std::atomic<TTopicChunk *>[chunk_count]) {
+  for (size_t i = 0; i < ChunkCount; ++i) {
+    Chunks[i].store(nullptr, std::memory_order_relaxed);
+  }
+}
+
+TMsgStateTracker::TThreadState::~TThreadState() {
+  for (size_t i = 0; i < ChunkCount; ++i) {
+    delete Chunks[i].load(std::memory_order_relaxed);
+  }
+}
+
+void TMsgStateTracker::TThreadStateHolder::Reset() noexcept {
+  if (State) {
+    State->Retired.store(true, std::memory_order_release);
+    State.reset();
+  }
+
+  TrackerId = 0;
+}
+
+TMsgStateTracker::TMsgStateTracker()
+    : Id(NextTrackerId.fetch_add(1, std::memory_order_relaxed)) {
+}
+
+void TMsgStateTracker::SetMaxTopics(size_t max_topics) noexcept {
+  MaxTopics = max_topics;
+}
+
+void TMsgStateTracker::MsgEnterNew(const TMsg &msg) noexcept {
+  TThreadState &state = GetThreadState();
+  AddDelta(state.NewDelta, 1);
+  AddDelta(state.NewBytesDelta, GetMsgBytes(msg));
 }
 
 void TMsgStateTracker::MsgEnterBatching(TMsg &msg) {
+  if (LatencyStats) {
+    RecordLatency(msg, TMsg::TState::Batching, GetMonotonicRawMicroseconds());
+  }
+
+  if (msg.IsTraced()) {
+    RecordTraceStage(msg, TMsg::TState::Batching);
+  }
+
   TDeltaComputer comp;
-  comp.CountBatchingEntered(msg.GetState());
+  comp.CountBatchingEntered(msg);
   msg.SetState(TMsg::TState::Batching);
-  UpdateStats(msg.GetTopic(), comp);
+  TThreadState &state = GetThreadState();
+  UpdateStats(state, comp.HasTopicDelta() ?
+      GetTopicIndex(state, msg) : TMsg::NO_TOPIC_STATS_INDEX, comp);
 }
 
 void TMsgStateTracker::MsgEnterSendWait(TMsg &msg) {
+  if (LatencyStats) {
+    RecordLatency(msg, TMsg::TState::SendWait, GetMonotonicRawMicroseconds());
+  }
+
+  if (msg.IsTraced()) {
+    RecordTraceStage(msg, TMsg::TState::SendWait);
+  }
+
   TDeltaComputer comp;
-  comp.CountSendWaitEntered(msg.GetState());
+  comp.CountSendWaitEntered(msg);
   msg.SetState(TMsg::TState::SendWait);
-  UpdateStats(msg.GetTopic(), comp);
+  TThreadState &state = GetThreadState();
+  UpdateStats(state, comp.HasTopicDelta() ?
+      GetTopicIndex(state, msg) : TMsg::NO_TOPIC_STATS_INDEX, comp);
 }
 
 void TMsgStateTracker::MsgEnterSendWait(
@@ -56,18 +119,30 @@ void TMsgStateTracker::MsgEnterSendWait(
     return;
   }
 
-  const std::string &topic = msg_list.front()->GetTopic();
+  TThreadState &state = GetThreadState();
+  const size_t topic_index = GetTopicIndex(state, *msg_list.front());
   TDeltaComputer comp;
+  const uint64_t now = LatencyStats ? GetMonotonicRawMicroseconds() : 0;
 
   for (auto &msg_ptr : msg_list) {
     assert(msg_ptr);
     TMsg &msg = *msg_ptr;
-    assert(msg.GetTopic() == topic);
-    comp.CountSendWaitEntered(msg.GetState());
+    assert(msg.GetTopic() == msg_list.front()->GetTopic());
+    msg.SetTopicStatsIndex(topic_index);
+
+    if (LatencyStats) {
+      RecordLatency(msg, TMsg::TState::SendWait, now);
+    }
+
+    if (msg.IsTraced()) {
+      RecordTraceStage(msg, TMsg::TState::SendWait);
+    }
+
+    comp.CountSendWaitEntered(msg);
     msg.SetState(TMsg::TState::SendWait);
   }
 
-  UpdateStats(topic, comp);
+  UpdateStats(state, topic_index, comp);
 }
 
 void TMsgStateTracker::MsgEnterSendWait(
@@ -78,10 +153,20 @@ void TMsgStateTracker::MsgEnterSendWait(
 }
 
 void TMsgStateTracker::MsgEnterAckWait(TMsg &msg) {
+  if (LatencyStats) {
+    RecordLatency(msg, TMsg::TState::AckWait, GetMonotonicRawMicroseconds());
+  }
+
+  if (msg.IsTraced()) {
+    RecordTraceStage(msg, TMsg::TState::AckWait);
+  }
+
   TDeltaComputer comp;
-  comp.CountAckWaitEntered(msg.GetState());
+  comp.CountAckWaitEntered(msg);
   msg.SetState(TMsg::TState::AckWait);
-  UpdateStats(msg.GetTopic(), comp);
+  TThreadState &state = GetThreadState();
+  UpdateStats(state, comp.HasTopicDelta() ?
+      GetTopicIndex(state, msg) : TMsg::NO_TOPIC_STATS_INDEX, comp);
 }
 
 void TMsgStateTracker::MsgEnterAckWait(const std::list<TMsg::TPtr> &msg_list) {
@@ -89,18 +174,30 @@ void TMsgStateTracker::MsgEnterAckWait(const std::list<TMsg::TPtr> &msg_list) {
     return;
   }
 
-  const std::string &topic = msg_list.front()->GetTopic();
+  TThreadState &state = GetThreadState();
+  const size_t topic_index = GetTopicIndex(state, *msg_list.front());
   TDeltaComputer comp;
+  const uint64_t now = LatencyStats ? GetMonotonicRawMicroseconds() : 0;
 
   for (auto &msg_ptr : msg_list) {
     assert(msg_ptr);
     TMsg &msg = *msg_ptr;
-    assert(msg.GetTopic() == topic);
-    comp.CountAckWaitEntered(msg.GetState());
+    assert(msg.GetTopic() == msg_list.front()->GetTopic());
+    msg.SetTopicStatsIndex(topic_index);
+
+    if (LatencyStats) {
+      RecordLatency(msg, TMsg::TState::AckWait, now);
+    }
+
+    if (msg.IsTraced()) {
+      RecordTraceStage(msg, TMsg::TState::AckWait);
+    }
+
+    comp.CountAckWaitEntered(msg);
     msg.SetState(TMsg::TState::AckWait);
   }
 
-  UpdateStats(topic, comp);
+  UpdateStats(state, topic_index, comp);
 }
 
 void TMsgStateTracker::MsgEnterAckWait(
@@ -111,10 +208,24 @@ void TMsgStateTracker::MsgEnterAckWait(
 }
 
 void TMsgStateTracker::MsgEnterProcessed(TMsg &msg) {
+  if (Journal) {
+    Journal->Retire(msg);
+  }
+
+  if (LatencyStats) {
+    RecordLatency(msg, TMsg::TState::Processed, GetMonotonicRawMicroseconds());
+  }
+
+  if (msg.IsTraced()) {
+    RecordTraceStage(msg, TMsg::TState::Processed);
+  }
+
   TDeltaComputer comp;
-  comp.CountProcessedEntered(msg.GetState());
+  comp.CountProcessedEntered(msg);
   msg.SetState(TMsg::TState::Processed);
-  UpdateStats(msg.GetTopic(), comp);
+  TThreadState &state = GetThreadState();
+  UpdateStats(state, comp.HasTopicDelta() ?
+      GetTopicIndex(state, msg) : TMsg::NO_TOPIC_STATS_INDEX, comp);
 }
 
 void TMsgStateTracker::MsgEnterProcessed(
@@ -123,18 +234,34 @@ void TMsgStateTracker::MsgEnterProcessed(
     return;
   }
 
-  const std::string &topic = msg_list.front()->GetTopic();
+  if (Journal) {
+    Journal->Retire(msg_list);
+  }
+
+  TThreadState &state = GetThreadState();
+  const size_t topic_index = GetTopicIndex(state, *msg_list.front());
   TDeltaComputer comp;
+  const uint64_t now = LatencyStats ? GetMonotonicRawMicroseconds() : 0;
 
   for (auto &msg_ptr : msg_list) {
     assert(msg_ptr);
     TMsg &msg = *msg_ptr;
-    assert(msg.GetTopic() == topic);
-    comp.CountProcessedEntered(msg.GetState());
+    assert(msg.GetTopic() == msg_list.front()->GetTopic());
+    msg.SetTopicStatsIndex(topic_index);
+
+    if (LatencyStats) {
+      RecordLatency(msg, TMsg::TState::Processed, now);
+    }
+
+    if (msg.IsTraced()) {
+      RecordTraceStage(msg, TMsg::TState::Processed);
+    }
+
+    comp.CountProcessedEntered(msg);
     msg.SetState(TMsg::TState::Processed);
   }
 
-  UpdateStats(topic, comp);
+  UpdateStats(state, topic_index, comp);
 }
 
 void TMsgStateTracker::MsgEnterProcessed(
@@ -146,44 +273,211 @@ void TMsgStateTracker::MsgEnterProcessed(
 
 void TMsgStateTracker::GetStats(std::vector<TTopicStatsItem> &result,
     long &new_count) const {
+  long new_bytes = 0;
+  GetStats(result, new_count, new_bytes);
+}
+
+void TMsgStateTracker::GetStats(std::vector<TTopicStatsItem> &result,
+    long &new_count, long &new_bytes) const {
   result.clear();
+  std::vector<TTopicStats> totals;
+  std::vector<std::string> topic_names;
+  long new_total = 0;
+  long new_bytes_total = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    topic_names = TopicNames;
+    totals = FoldedTopicStats;
+    totals.resize(topic_names.size());
+    new_total = FoldedNewCount;
+    new_bytes_total = FoldedNewBytes;
+
+    for (const auto &state : ThreadStates) {
+      new_total += state->NewDelta.load(std::memory_order_relaxed);
+      new_bytes_total += state->NewBytesDelta.load(std::memory_order_relaxed);
+
+      for (size_t i = 0; i < state->ChunkCount; ++i) {
+        const TTopicChunk *chunk =
+            state->Chunks[i].load(std::memory_order_acquire);
+
+        if (chunk == nullptr) {
+          continue;
+        }
+
+        const size_t base = i * TOPIC_CHUNK_SIZE;
+
+        for (size_t j = 0;
+             (j < TOPIC_CHUNK_SIZE) && ((base + j) < totals.size()); ++j) {
+          const TTopicDeltas &d = (*chunk)[j];
+          TTopicStats &t = totals[base + j];
+          AddDeltas(t, d);
+        }
+      }
+    }
+  }
+
+  /* Since we read the threads' deltas at slightly different times, a message
+     that just moved between threads may be counted in neither state or in
+     both.  Don't report transient negative counts. */
+  for (size_t i = 0; i < totals.size(); ++i) {
+    TTopicStats &t = totals[i];
+    t.BatchingCount = std::max(t.BatchingCount, 0L);
+    t.SendWaitCount = std::max(t.SendWaitCount, 0L);
+    t.AckWaitCount = std::max(t.AckWaitCount, 0L);
+    t.BatchingBytes = std::max(t.BatchingBytes, 0L);
+    t.SendWaitBytes = std::max(t.SendWaitBytes, 0L);
+    t.AckWaitBytes = std::max(t.AckWaitBytes, 0L);
+
+    if (t.BatchingCount || t.SendWaitCount || t.AckWaitCount) {
+      result.emplace_back(std::make_pair(std::move(topic_names[i]), t));
+    }
+  }
+
+  new_count = std::max(new_total, 0L);
+  new_bytes = std::max(new_bytes_total, 0L);
+}
 
+void TMsgStateTracker::FoldRetiredThreads() {
   std::lock_guard<std::mutex> lock(Mutex);
+  FoldedTopicStats.resize(TopicNames.size());
 
-  for (const auto &item : TopicStats) {
-    const TTopicStats &stats = item.second.TopicStats;
+  for (auto iter = ThreadStates.begin(); iter != ThreadStates.end(); ) {
+    TThreadState &state = **iter;
 
-    if (stats.BatchingCount || stats.SendWaitCount || stats.AckWaitCount) {
-      result.emplace_back(std::make_pair(item.first, stats));
+    if (!state.Retired.load(std::memory_order_acquire)) {
+      ++iter;
+      continue;
     }
+
+    /* The owning thread is gone, so its deltas are final. */
+    FoldedNewCount += state.NewDelta.load(std::memory_order_relaxed);
+    FoldedNewBytes += state.NewBytesDelta.load(std::memory_order_relaxed);
+
+    for (size_t i = 0; i < state.ChunkCount; ++i) {
+      const TTopicChunk *chunk =
+          state.Chunks[i].load(std::memory_order_acquire);
+
+      if (chunk == nullptr) {
+        continue;
+      }
+
+      const size_t base = i * TOPIC_CHUNK_SIZE;
+
+      for (size_t j = 0;
+           (j < TOPIC_CHUNK_SIZE) && ((base + j) < FoldedTopicStats.size());
+           ++j) {
+        const TTopicDeltas &d = (*chunk)[j];
+        AddDeltas(FoldedTopicStats[base + j], d);
+      }
+    }
+
+    iter = ThreadStates.erase(iter);
   }
+}
 
-  new_count = NewCount;
+void TMsgStateTracker::AddDeltas(TTopicStats &stats,
+    const TTopicDeltas &deltas) noexcept {
+  stats.BatchingCount += deltas.Batching.load(std::memory_order_relaxed);
+  stats.SendWaitCount += deltas.SendWait.load(std::memory_order_relaxed);
+  stats.AckWaitCount += deltas.AckWait.load(std::memory_order_relaxed);
+  stats.BatchingBytes +=
+      deltas.BatchingBytes.load(std::memory_order_relaxed);
+  stats.SendWaitBytes +=
+      deltas.SendWaitBytes.load(std::memory_order_relaxed);
+  stats.AckWaitBytes += deltas.AckWaitBytes.load(std::memory_order_relaxed);
 }
 
-void TMsgStateTracker::PruneTopics(const TTopicExistsFn &topic_exists_fn) {
-  std::lock_guard<std::mutex> lock(Mutex);
+void TMsgStateTracker::RecordLatency(TMsg &msg, TMsg::TState new_state,
+    uint64_t now) noexcept {
+  assert(LatencyStats);
+  const TMsg::TState prev_state = msg.GetState();
 
-  for (auto iter = TopicStats.begin(); iter != TopicStats.end(); ) {
-    TTopicStatsWrapper &w = iter->second;
-    w.OkToDelete = !topic_exists_fn(iter->first);
+  if (prev_state == new_state) {
+    /* A message reentering SendWait keeps its original entry time. */
+    return;
+  }
 
-    if (w.OkToDelete && (w.TopicStats.BatchingCount == 0) &&
-        (w.TopicStats.SendWaitCount == 0) &&
-        (w.TopicStats.AckWaitCount == 0)) {
-      iter = TopicStats.erase(iter);
-    } else {
-      ++iter;
+  const uint64_t start = msg.GetStateTimestampUsec();
+  const uint64_t elapsed = (now > start) ? (now - start) : 0;
+
+  switch (prev_state) {
+    case TMsg::TState::New: {
+      LatencyStats->RecordStage(TLatencyStats::TStage::New, elapsed);
+      break;
+    }
+    case TMsg::TState::Batching: {
+      LatencyStats->RecordStage(TLatencyStats::TStage::Batching, elapsed);
+      break;
+    }
+    case TMsg::TState::SendWait: {
+      LatencyStats->RecordStage(TLatencyStats::TStage::SendWait, elapsed);
+      break;
     }
+    case TMsg::TState::AckWait: {
+      LatencyStats->RecordStage(TLatencyStats::TStage::AckWait, elapsed);
+      break;
+    }
+    case TMsg::TState::Processed: {
+      /* Invalid transition.  TDeltaComputer reports it. */
+      break;
+    }
+    NO_DEFAULT_CASE;
+  }
+
+  if (new_state == TMsg::TState::Processed) {
+    const uint64_t created = msg.GetCreationTimestampUsec();
+    LatencyStats->RecordStage(TLatencyStats::TStage::Total,
+        (now > created) ? (now - created) : 0);
+  }
+
+  msg.SetStateTimestampUsec(now);
+}
+
+void TMsgStateTracker::RecordTraceStage(TMsg &msg, TMsg::TState new_state) {
+  TMsg::TTrace *trace = msg.GetTrace();
+  assert(trace);
+  const uint64_t now = GetMonotonicRawMicroseconds();
+
+  switch (new_state) {
+    case TMsg::TState::New: {
+      break;
+    }
+    case TMsg::TState::Batching: {
+      trace->BatchedUsec = now;
+      break;
+    }
+    case TMsg::TState::SendWait: {
+      trace->DispatchedUsec = now;
+      break;
+    }
+    case TMsg::TState::AckWait: {
+      trace->SentUsec = now;
+      break;
+    }
+    case TMsg::TState::Processed: {
+      trace->ProcessedUsec = now;
+
+      if (Tracer) {
+        Tracer->Record(msg);
+      }
+
+      break;
+    }
+    NO_DEFAULT_CASE;
   }
 }
 
 void TMsgStateTracker::TDeltaComputer::CountBatchingEntered(
-    TMsg::TState prev_state) noexcept {
-  switch (prev_state) {
+    const TMsg &msg) noexcept {
+  const long bytes = GetMsgBytes(msg);
+
+  switch (msg.GetState()) {
     case TMsg::TState::New: {
       --NewDelta;
+      NewBytesDelta -= bytes;
       ++BatchingDelta;
+      BatchingBytesDelta += bytes;
       break;
     }
     case TMsg::TState::Batching: {
@@ -215,16 +509,22 @@ void TMsgStateTracker::TDeltaComputer::CountBatchingEntered(
 }
 
 void TMsgStateTracker::TDeltaComputer::CountSendWaitEntered(
-    TMsg::TState prev_state) noexcept {
-  switch (prev_state) {
+    const TMsg &msg) noexcept {
+  const long bytes = GetMsgBytes(msg);
+
+  switch (msg.GetState()) {
     case TMsg::TState::New: {
       --NewDelta;
+      NewBytesDelta -= bytes;
       ++SendWaitDelta;
+      SendWaitBytesDelta += bytes;
       break;
     }
     case TMsg::TState::Batching: {
       --BatchingDelta;
+      BatchingBytesDelta -= bytes;
       ++SendWaitDelta;
+      SendWaitBytesDelta += bytes;
       break;
     }
     case TMsg::TState::SendWait: {
@@ -232,7 +532,9 @@ void TMsgStateTracker::TDeltaComputer::CountSendWaitEntered(
     }
     case TMsg::TState::AckWait: {
       --AckWaitDelta;
+      AckWaitBytesDelta -= bytes;
       ++SendWaitDelta;
+      SendWaitBytesDelta += bytes;
       break;
     }
     case TMsg::TState::Processed: {
@@ -246,8 +548,10 @@ void TMsgStateTracker::TDeltaComputer::CountSendWaitEntered(
 }
 
 void TMsgStateTracker::TDeltaComputer::CountAckWaitEntered(
-    TMsg::TState prev_state) noexcept {
-  switch (prev_state) {
+    const TMsg &msg) noexcept {
+  const long bytes = GetMsgBytes(msg);
+
+  switch (msg.GetState()) {
     case TMsg::TState::New: {
       LOG_R(TPri::ERR, std::chrono::seconds(30))
           << "Bug: Cannot enter state 'AckWait' from 'New'";
@@ -262,7 +566,9 @@ void TMsgStateTracker::TDeltaComputer::CountAckWaitEntered(
     }
     case TMsg::TState::SendWait: {
       --SendWaitDelta;
+      SendWaitBytesDelta -= bytes;
       ++AckWaitDelta;
+      AckWaitBytesDelta += bytes;
       break;
     }
     case TMsg::TState::AckWait: {
@@ -282,10 +588,13 @@ void TMsgStateTracker::TDeltaComputer::CountAckWaitEntered(
 }
 
 void TMsgStateTracker::TDeltaComputer::CountProcessedEntered(
-    TMsg::TState prev_state) noexcept {
-  switch (prev_state) {
+    const TMsg &msg) noexcept {
+  const long bytes = GetMsgBytes(msg);
+
+  switch (msg.GetState()) {
     case TMsg::TState::New: {
       --NewDelta;
+      NewBytesDelta -= bytes;
       break;
     }
     case TMsg::TState::Batching: {
@@ -296,10 +605,12 @@ void TMsgStateTracker::TDeltaComputer::CountProcessedEntered(
     }
     case TMsg::TState::SendWait: {
       --SendWaitDelta;
+      SendWaitBytesDelta -= bytes;
       break;
     }
     case TMsg::TState::AckWait: {
       --AckWaitDelta;
+      AckWaitBytesDelta -= bytes;
       break;
     }
     case TMsg::TState::Processed: {
@@ -312,43 +623,102 @@ void TMsgStateTracker::TDeltaComputer::CountProcessedEntered(
   }
 }
 
-void TMsgStateTracker::UpdateStats(const std::string &topic,
-    const TDeltaComputer &comp) {
-  long new_delta = comp.GetNewDelta();
-  long batching_delta = comp.GetBatchingDelta();
-  long send_wait_delta = comp.GetSendWaitDelta();
-  long ack_wait_delta = comp.GetAckWaitDelta();
+TMsgStateTracker::TThreadState &TMsgStateTracker::GetThreadState() {
+  static thread_local TThreadStateHolder holder;
 
-  std::lock_guard<std::mutex> lock(Mutex);
+  if (holder.TrackerId != Id) {
+    /* First use of this tracker by the calling thread, or the thread last used
+       a different tracker (only in tests). */
+    holder.Reset();
+    auto state = std::make_shared<TThreadState>(
+        (MaxTopics + TOPIC_CHUNK_SIZE - 1) / TOPIC_CHUNK_SIZE);
 
-  if (batching_delta || send_wait_delta || ack_wait_delta) {
-    /* We could accomplish the same thing with a single call to
-       TopicStats.insert(), but this way we avoid creation of a temporary
-       string in the common case where the map already contains the topic. */
-    auto iter = TopicStats.find(topic);
-
-    if (iter == TopicStats.end()) {
-      auto result = TopicStats.insert(
-          std::make_pair(topic, TTopicStatsWrapper()));
-      assert(result.second);
-      iter = result.first;
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      ThreadStates.push_back(state);
     }
 
-    assert(iter != TopicStats.end());
-    TTopicStatsWrapper &w = iter->second;
-    w.TopicStats.BatchingCount += batching_delta;
-    assert(w.TopicStats.BatchingCount >= 0);
-    w.TopicStats.SendWaitCount += send_wait_delta;
-    assert(w.TopicStats.SendWaitCount >= 0);
-    w.TopicStats.AckWaitCount += ack_wait_delta;
-    assert(w.TopicStats.AckWaitCount >= 0);
+    holder.State = std::move(state);
+    holder.TrackerId = Id;
+  }
+
+  return *holder.State;
+}
+
+size_t TMsgStateTracker::GetTopicIndex(TThreadState &state, TMsg &msg) {
+  size_t index = msg.GetTopicStatsIndex();
+
+  if (index != TMsg::NO_TOPIC_STATS_INDEX) {
+    return index;
+  }
 
-    if (w.OkToDelete && (w.TopicStats.BatchingCount == 0) &&
-        (w.TopicStats.SendWaitCount == 0) &&
-        (w.TopicStats.AckWaitCount == 0)) {
-      TopicStats.erase(iter);
+  const std::string &topic = msg.GetTopic();
+  auto iter = state.TopicIndexCache.find(topic);
+
+  if (iter != state.TopicIndexCache.end()) {
+    index = iter->second;
+  } else {
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      auto map_iter = TopicIndexMap.find(topic);
+
+      if (map_iter == TopicIndexMap.end()) {
+        index = TopicNames.size();
+        TopicNames.push_back(topic);
+        TopicIndexMap.insert(std::make_pair(topic, index));
+      } else {
+        index = map_iter->second;
+      }
     }
+
+    state.TopicIndexCache.insert(std::make_pair(topic, index));
+  }
+
+  msg.SetTopicStatsIndex(index);
+  return index;
+}
+
+TMsgStateTracker::TTopicDeltas *TMsgStateTracker::GetTopicDeltas(
+    TThreadState &state, size_t topic_index) const {
+  const size_t chunk_index = topic_index / TOPIC_CHUNK_SIZE;
+
+  if ((topic_index >= MaxTopics) || (chunk_index >= state.ChunkCount)) {
+    MsgStateTrackerTooManyTopics.Increment();
+    LOG_R(TPri::ERR, std::chrono::seconds(30))
+        << "Too many topics for message state tracking: not tracking topic "
+        << "index " << topic_index << " (limit " << MaxTopics << ")";
+    return nullptr;
+  }
+
+  std::atomic<TTopicChunk *> &slot = state.Chunks[chunk_index];
+  TTopicChunk *chunk = slot.load(std::memory_order_relaxed);
+
+  if (chunk == nullptr) {
+    chunk = new TTopicChunk;
+    slot.store(chunk, std::memory_order_release);
   }
 
-  NewCount += new_delta;
+  return &(*chunk)[topic_index % TOPIC_CHUNK_SIZE];
+}
+
+void TMsgStateTracker::UpdateStats(TThreadState &state, size_t topic_index,
+    const TDeltaComputer &comp) {
+  AddDelta(state.NewDelta, comp.GetNewDelta());
+  AddDelta(state.NewBytesDelta, comp.GetNewBytesDelta());
+
+  if (!comp.HasTopicDelta()) {
+    return;
+  }
+
+  assert(topic_index != TMsg::NO_TOPIC_STATS_INDEX);
+  TTopicDeltas *deltas = GetTopicDeltas(state, topic_index);
+
+  if (deltas) {
+    AddDelta(deltas->Batching, comp.GetBatchingDelta());
+    AddDelta(deltas->SendWait, comp.GetSendWaitDelta());
+    AddDelta(deltas->AckWait, comp.GetAckWaitDelta());
+    AddDelta(deltas->BatchingBytes, comp.GetBatchingBytesDelta());
+    AddDelta(deltas->SendWaitBytes, comp.GetSendWaitBytesDelta());
+    AddDelta(deltas->AckWaitBytes, comp.GetAckWaitBytesDelta());
+  }
 }
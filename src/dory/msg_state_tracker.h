@@ -21,8 +21,12 @@
 
 #pragma once
 
-#include <functional>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <list>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_map>
@@ -30,12 +34,31 @@
 #include <vector>
 
 #include <base/no_copy_semantics.h>
+#include <dory/latency_stats.h>
 #include <dory/msg.h>
+#include <dory/msg_tracer.h>
 
 namespace Dory {
 
+  namespace Journal {
+
+    class TJournal;
+
+  }  // Journal
+
   /* Singleton class for tracking info on message states.  If Kafka starts
-     falling behind, this lets us see which topics are lagging. */
+     falling behind, this lets us see which topics are lagging.
+
+     State changes happen for every message in the input, router, and
+     connector threads, so they must not contend on a shared lock.  Each
+     thread therefore accumulates its own deltas, which are merged on read.
+     Topics are assigned dense indexes, which are cached in the messages, so
+     recording a state change usually amounts to a few adds into the calling
+     thread's per-topic array.  A thread's deltas may be negative, since a
+     message may enter a state in one thread and leave it in another.
+     Readers sum the deltas of all threads without stopping them.  The
+     results are therefore approximate while messages are in flight, but
+     exact once things are quiet. */
   class TMsgStateTracker final {
     NO_COPY_SEMANTICS(TMsgStateTracker);
 
@@ -47,14 +70,61 @@ namespace Dory {
 
       long AckWaitCount = 0;
 
+      /* Total key and value bytes of the messages counted above.  These are
+         stored in blocks from the buffer pool. */
+      long BatchingBytes = 0;
+
+      long SendWaitBytes = 0;
+
+      long AckWaitBytes = 0;
+
       TTopicStats() noexcept = default;
     };  // TTopicStats
 
-    TMsgStateTracker() = default;
+    /* Default value for SetMaxTopics(). */
+    static constexpr size_t DEFAULT_MAX_TOPICS = 65536;
+
+    TMsgStateTracker();
+
+    /* Track stats for at most 'max_topics' topics.  Topic indexes are cached
+       in messages and are never reused, so this limits the number of
+       distinct topics seen over the life of the process.  State changes for
+       later topics are counted by the MsgStateTrackerTooManyTopics counter
+       instead.  Must be called before any other threads use the tracker. */
+    void SetMaxTopics(size_t max_topics) noexcept;
+
+    /* If 'journal' is not null, messages that enter state
+       TMsg::TState::Processed are retired from it.  Must be called before
+       any other threads use the tracker. */
+    void SetJournal(Journal::TJournal *journal) noexcept {
+      Journal = journal;
+    }
+
+    /* If 'latency_stats' is not null, the time each message spends in each
+       state is recorded there.  Must be called before any other threads use
+       the tracker. */
+    void SetLatencyStats(TLatencyStats *latency_stats) noexcept {
+      LatencyStats = latency_stats;
+    }
+
+    /* If 'tracer' is not null, it selects newly created messages for tracing,
+       and each traced message records the time it enters each state.  Must
+       be called before any other threads use the tracker. */
+    void SetTracer(TMsgTracer *tracer) noexcept {
+      Tracer = tracer;
+    }
+
+    /* Called once for each newly created message, to decide whether to trace
+       it. */
+    void SampleForTrace(TMsg &msg) {
+      if (Tracer) {
+        Tracer->SampleForTrace(msg);
+      }
+    }
 
-    /* A brand new message has been created.  Update our stats to indicate
+    /* Brand new message 'msg' has been created.  Update our stats to indicate
        this. */
-    void MsgEnterNew() noexcept;
+    void MsgEnterNew(const TMsg &msg) noexcept;
 
     /* Set the state of 'msg' to TMsg::TState::Batching and update our stats to
        reflect this.  This indicates that the message is being batched. */
@@ -93,8 +163,9 @@ namespace Dory {
 
     /* Set the state of 'msg' to TMsg::TState::Processed and update our stats
        to reflect this.  This is called when a message is just about to be
-       destroyed (due to either successful delivery or discard).  Do not call
-       this from a destructor, since it may throw. */
+       destroyed (due to either successful delivery or discard).  If a journal
+       was provided, the message is also retired from it.  Do not call this
+       from a destructor, since it may throw. */
     void MsgEnterProcessed(TMsg &msg);
 
     /* Same as above, but process an entire list of messages.  All messages in
@@ -118,17 +189,16 @@ namespace Dory {
     void GetStats(std::vector<TTopicStatsItem> &topic_stats,
                   long &new_count) const;
 
-    /* A topic name is passed as a parameter.  Function returns true if topic
-       is present in metadata or false otherwise. */
-    using TTopicExistsFn = std::function<bool(const std::string &)>;
+    /* Same as above, but also set 'new_bytes' to the total key and value
+       bytes of messages with state TMsg::TState::New. */
+    void GetStats(std::vector<TTopicStatsItem> &topic_stats,
+                  long &new_count, long &new_bytes) const;
 
-    /* When metadata is updated, this is called to identify topics in our stats
-       that are no longer present in the metadata.  Any such topics whose
-       counts are both 0 are deleted immediately.  Any such topics with at
-       least one nonzero count is marked for deletion once its counts reach 0.
-       'topic_exists_fn' indicates whether a topic is present in the new
-       metadata. */
-    void PruneTopics(const TTopicExistsFn &topic_exists_fn);
+    /* Fold the deltas of threads that have exited into the totals, so their
+       memory can be freed.  Called periodically (when metadata is updated).
+       Topics whose counts are all 0, such as deleted topics, are already
+       left out of the stats returned by GetStats(). */
+    void FoldRetiredThreads();
 
     private:
     class TDeltaComputer final {
@@ -151,13 +221,35 @@ namespace Dory {
         return AckWaitDelta;
       }
 
-      void CountBatchingEntered(TMsg::TState prev_state) noexcept;
+      long GetNewBytesDelta() const noexcept {
+        return NewBytesDelta;
+      }
+
+      long GetBatchingBytesDelta() const noexcept {
+        return BatchingBytesDelta;
+      }
 
-      void CountSendWaitEntered(TMsg::TState prev_state) noexcept;
+      long GetSendWaitBytesDelta() const noexcept {
+        return SendWaitBytesDelta;
+      }
 
-      void CountAckWaitEntered(TMsg::TState prev_state) noexcept;
+      long GetAckWaitBytesDelta() const noexcept {
+        return AckWaitBytesDelta;
+      }
+
+      bool HasTopicDelta() const noexcept {
+        return BatchingDelta || SendWaitDelta || AckWaitDelta;
+      }
 
-      void CountProcessedEntered(TMsg::TState prev_state) noexcept;
+      /* Each of these counts a transition of 'msg' from its current state.
+       */
+      void CountBatchingEntered(const TMsg &msg) noexcept;
+
+      void CountSendWaitEntered(const TMsg &msg) noexcept;
+
+      void CountAckWaitEntered(const TMsg &msg) noexcept;
+
+      void CountProcessedEntered(const TMsg &msg) noexcept;
 
       private:
       long NewDelta = 0;
@@ -167,30 +259,153 @@ namespace Dory {
       long SendWaitDelta = 0;
 
       long AckWaitDelta = 0;
+
+      long NewBytesDelta = 0;
+
+      long BatchingBytesDelta = 0;
+
+      long SendWaitBytesDelta = 0;
+
+      long AckWaitBytesDelta = 0;
     };  // TDeltaComputer
 
-    struct TTopicStatsWrapper {
-      TTopicStats TopicStats;
+    /* One thread's deltas for a single topic.  Only the owning thread writes
+       these, so it updates them with a relaxed load and store rather than an
+       atomic add.  Atomics are used only so that readers can safely see
+       values that may be slightly stale. */
+    struct TTopicDeltas {
+      std::atomic<long> Batching{0};
+
+      std::atomic<long> SendWait{0};
+
+      std::atomic<long> AckWait{0};
+
+      std::atomic<long> BatchingBytes{0};
+
+      std::atomic<long> SendWaitBytes{0};
+
+      std::atomic<long> AckWaitBytes{0};
+    };  // TTopicDeltas
+
+    static constexpr size_t TOPIC_CHUNK_SIZE = 64;
+
+    using TTopicChunk = std::array<TTopicDeltas, TOPIC_CHUNK_SIZE>;
 
-      /* A true value indicates that this topic is no longer present in the
-         metadata, and can therefore be deleted from our stats once its counts
-         reach 0. */
-      bool OkToDelete = false;
+    /* Deltas recorded by one thread.  Per-topic deltas are stored in chunks
+       so the owning thread can add topics without moving existing deltas
+       that readers may be looking at. */
+    struct TThreadState {
+      std::atomic<long> NewDelta{0};
 
-      TTopicStatsWrapper() = default;
-    };  // TTopicStatsWrapper
+      std::atomic<long> NewBytesDelta{0};
 
-    void UpdateStats(const std::string &topic, const TDeltaComputer &comp);
+      const size_t ChunkCount;
 
-    /* Protects 'TopicStats' and 'NewCount'. */
+      /* 'ChunkCount' items.  Chunk i holds topic indexes
+         [i * TOPIC_CHUNK_SIZE, (i + 1) * TOPIC_CHUNK_SIZE).  Allocated by the
+         owning thread on demand, and freed by our destructor. */
+      std::unique_ptr<std::atomic<TTopicChunk *>[]> Chunks;
+
+      /* Set when the owning thread exits, so we can fold the deltas into the
+         totals and free this. */
+      std::atomic<bool> Retired{false};
+
+      /* Accessed only by the owning thread.  Maps topics to indexes, to avoid
+         going to the shared topic registry. */
+      std::unordered_map<std::string, size_t> TopicIndexCache;
+
+      explicit TThreadState(size_t chunk_count);
+
+      ~TThreadState();
+    };  // TThreadState
+
+    /* Thread local pointer to the calling thread's state for the tracker it
+       most recently used.  Marks the state retired on thread exit. */
+    struct TThreadStateHolder {
+      uint64_t TrackerId = 0;
+
+      std::shared_ptr<TThreadState> State;
+
+      void Reset() noexcept;
+
+      ~TThreadStateHolder() {
+        Reset();
+      }
+    };  // TThreadStateHolder
+
+    static long GetMsgBytes(const TMsg &msg) noexcept {
+      return static_cast<long>(msg.GetKeyAndValue().Size());
+    }
+
+    /* Add 'deltas' into 'stats'. */
+    static void AddDeltas(TTopicStats &stats,
+        const TTopicDeltas &deltas) noexcept;
+
+    static void AddDelta(std::atomic<long> &value, long delta) noexcept {
+      if (delta) {
+        value.store(value.load(std::memory_order_relaxed) + delta,
+            std::memory_order_relaxed);
+      }
+    }
+
+    /* Return the calling thread's state, registering it if necessary. */
+    TThreadState &GetThreadState();
+
+    /* Return the index of the topic of 'msg', and cache it in 'msg'. */
+    size_t GetTopicIndex(TThreadState &state, TMsg &msg);
+
+    /* Return the deltas for topic 'topic_index' in 'state', allocating them if
+       necessary.  Returns null if there are too many topics. */
+    TTopicDeltas *GetTopicDeltas(TThreadState &state,
+        size_t topic_index) const;
+
+    void UpdateStats(TThreadState &state, size_t topic_index,
+        const TDeltaComputer &comp);
+
+    /* Record the time 'msg' spent in its current state, given that it enters
+       'new_state' at monotonic raw time 'now' (in microseconds).  Must only be
+       called if 'LatencyStats' is not null. */
+    void RecordLatency(TMsg &msg, TMsg::TState new_state,
+        uint64_t now) noexcept;
+
+    /* Record in the trace of 'msg' the time it enters 'new_state'.  Once it
+       enters TMsg::TState::Processed, give the trace to 'Tracer'.  Must only
+       be called if 'msg' is traced. */
+    void RecordTraceStage(TMsg &msg, TMsg::TState new_state);
+
+    Journal::TJournal *Journal = nullptr;
+
+    TLatencyStats *LatencyStats = nullptr;
+
+    TMsgTracer *Tracer = nullptr;
+
+    /* Distinguishes this tracker from others in the thread local state.  Never
+       reused, unlike our address. */
+    const uint64_t Id;
+
+    size_t MaxTopics = DEFAULT_MAX_TOPICS;
+
+    /* Protects the members below.  Never acquired on the fast path. */
     mutable std::mutex Mutex;
 
-    /* Keys are topics, and values are per-topic stats. */
-    std::unordered_map<std::string, TTopicStatsWrapper> TopicStats;
+    /* Topic registry: index is topic index, and value is topic. */
+    std::vector<std::string> TopicNames;
+
+    /* Topic registry: key is topic, and value is topic index. */
+    std::unordered_map<std::string, size_t> TopicIndexMap;
+
+    /* States of all threads that have recorded anything. */
+    std::vector<std::shared_ptr<TThreadState>> ThreadStates;
+
+    /* Deltas of retired threads, folded in by FoldRetiredThreads().  Index is
+       topic index. */
+    std::vector<TTopicStats> FoldedTopicStats;
 
     /* Messages in state TMsg::TState::New are not broken down by topic, since
        some may have invalid topics. */
-    long NewCount = 0;
+    long FoldedNewCount = 0;
+
+    long FoldedNewBytes = 0;
   };  // TMsgStateTracker
 
 }  // Dory
@@ -0,0 +1,222 @@
+/* <dory/msg_state_tracker.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2013-2014 if(we)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit test for <dory/msg_state_tracker.h>
+ */
+
+#include <dory/msg_state_tracker.h>
+
+#include <algorithm>
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <base/tmp_file.h>
+#include <dory/msg.h>
+#include <dory/test_util/misc_util.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::TestUtil;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TMsgStateTracker. */
+  class TMsgStateTrackerTest : public ::testing::Test {
+    protected:
+    TMsgStateTrackerTest() = default;
+
+    ~TMsgStateTrackerTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TMsgStateTrackerTest
+
+  TMsgStateTracker::TTopicStats
+  FindTopic(const std::vector<TMsgStateTracker::TTopicStatsItem> &stats,
+      const std::string &topic) {
+    auto iter = std::find_if(stats.begin(), stats.end(),
+        [&topic](const TMsgStateTracker::TTopicStatsItem &item) {
+          return item.first == topic;
+        });
+    return (iter == stats.end()) ? TMsgStateTracker::TTopicStats() :
+        iter->second;
+  }
+
+  TEST_F(TMsgStateTrackerTest, SingleThread) {
+    TTestMsgCreator mc;
+    TMsgStateTracker &tracker = mc.MsgStateTracker;
+    std::vector<TMsgStateTracker::TTopicStatsItem> stats;
+    long new_count = 0;
+
+    TMsg::TPtr msg1 = mc.NewMsg("topic1", "value1", 0);
+    TMsg::TPtr msg2 = mc.NewMsg("topic1", "value2", 0);
+    TMsg::TPtr msg3 = mc.NewMsg("topic2", "value3", 0);
+    tracker.GetStats(stats, new_count);
+    ASSERT_EQ(new_count, 3);
+    ASSERT_TRUE(stats.empty());
+
+    long new_bytes = 0;
+    tracker.GetStats(stats, new_count, new_bytes);
+    ASSERT_EQ(new_bytes, 18);
+
+    tracker.MsgEnterBatching(*msg1);
+    tracker.MsgEnterBatching(*msg2);
+    tracker.MsgEnterSendWait(*msg3);
+    tracker.GetStats(stats, new_count, new_bytes);
+    ASSERT_EQ(new_count, 0);
+    ASSERT_EQ(new_bytes, 0);
+    ASSERT_EQ(stats.size(), 2U);
+    ASSERT_EQ(FindTopic(stats, "topic1").BatchingCount, 2);
+    ASSERT_EQ(FindTopic(stats, "topic1").BatchingBytes, 12);
+    ASSERT_EQ(FindTopic(stats, "topic2").SendWaitCount, 1);
+    ASSERT_EQ(FindTopic(stats, "topic2").SendWaitBytes, 6);
+
+    std::list<TMsg::TPtr> msg_list;
+    msg_list.push_back(std::move(msg1));
+    msg_list.push_back(std::move(msg2));
+    tracker.MsgEnterSendWait(msg_list);
+    tracker.MsgEnterAckWait(msg_list);
+    tracker.MsgEnterAckWait(*msg3);
+    tracker.GetStats(stats, new_count);
+    ASSERT_EQ(FindTopic(stats, "topic1").BatchingCount, 0);
+    ASSERT_EQ(FindTopic(stats, "topic1").AckWaitCount, 2);
+    ASSERT_EQ(FindTopic(stats, "topic1").BatchingBytes, 0);
+    ASSERT_EQ(FindTopic(stats, "topic1").AckWaitBytes, 12);
+    ASSERT_EQ(FindTopic(stats, "topic2").SendWaitCount, 0);
+    ASSERT_EQ(FindTopic(stats, "topic2").AckWaitCount, 1);
+
+    tracker.MsgEnterProcessed(msg_list);
+    tracker.MsgEnterProcessed(*msg3);
+    tracker.GetStats(stats, new_count);
+    ASSERT_EQ(new_count, 0);
+    ASSERT_TRUE(stats.empty());
+  }
+
+  TEST_F(TMsgStateTrackerTest, MaxTopics) {
+    TTestMsgCreator mc;
+    TMsgStateTracker &tracker = mc.MsgStateTracker;
+    tracker.SetMaxTopics(2);
+    std::vector<TMsgStateTracker::TTopicStatsItem> stats;
+    long new_count = 0;
+
+    std::list<TMsg::TPtr> msg_list;
+    msg_list.push_back(mc.NewMsg("topic1", "value1", 0));
+    msg_list.push_back(mc.NewMsg("topic2", "value2", 0));
+    msg_list.push_back(mc.NewMsg("topic3", "value3", 0));
+
+    for (TMsg::TPtr &msg : msg_list) {
+      tracker.MsgEnterSendWait(*msg);
+    }
+
+    /* Only the first two topics seen are tracked. */
+    tracker.GetStats(stats, new_count);
+    ASSERT_EQ(new_count, 0);
+    ASSERT_EQ(stats.size(), 2U);
+    ASSERT_EQ(FindTopic(stats, "topic1").SendWaitCount, 1);
+    ASSERT_EQ(FindTopic(stats, "topic2").SendWaitCount, 1);
+    ASSERT_EQ(FindTopic(stats, "topic3").SendWaitCount, 0);
+
+    for (TMsg::TPtr &msg : msg_list) {
+      tracker.MsgEnterProcessed(*msg);
+    }
+
+    tracker.GetStats(stats, new_count);
+    ASSERT_TRUE(stats.empty());
+  }
+
+  TEST_F(TMsgStateTrackerTest, ManyThreads) {
+    const size_t thread_count = 4;
+    const size_t msgs_per_thread = 500;
+    TTestMsgCreator mc;
+    TMsgStateTracker &tracker = mc.MsgStateTracker;
+    std::vector<std::list<TMsg::TPtr>> msg_lists(thread_count);
+
+    for (size_t i = 0; i < thread_count; ++i) {
+      for (size_t j = 0; j < msgs_per_thread; ++j) {
+        msg_lists[i].push_back(mc.NewMsg("topic" + std::to_string(j % 3),
+            "value", 0));
+      }
+    }
+
+    /* Messages enter state New in this thread, and move on in others, so the
+       threads' deltas only add up when combined. */
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < thread_count; ++i) {
+      threads.emplace_back(
+          [&tracker, &msg_lists, i] {
+            for (auto &msg : msg_lists[i]) {
+              tracker.MsgEnterBatching(*msg);
+              tracker.MsgEnterSendWait(*msg);
+            }
+          });
+    }
+
+    for (auto &t : threads) {
+      t.join();
+    }
+
+    std::vector<TMsgStateTracker::TTopicStatsItem> stats;
+    long new_count = 0;
+    tracker.GetStats(stats, new_count);
+    ASSERT_EQ(new_count, 0);
+    ASSERT_EQ(stats.size(), 3U);
+    long total = 0;
+
+    for (const auto &item : stats) {
+      ASSERT_EQ(item.second.BatchingCount, 0);
+      total += item.second.SendWaitCount;
+    }
+
+    ASSERT_EQ(total, static_cast<long>(thread_count * msgs_per_thread));
+
+    /* The exited threads' deltas get folded into the totals. */
+    tracker.FoldRetiredThreads();
+    tracker.GetStats(stats, new_count);
+    ASSERT_EQ(FindTopic(stats, "topic0").SendWaitCount +
+        FindTopic(stats, "topic1").SendWaitCount +
+        FindTopic(stats, "topic2").SendWaitCount,
+        static_cast<long>(thread_count * msgs_per_thread));
+
+    for (auto &msg_list : msg_lists) {
+      for (auto &msg : msg_list) {
+        tracker.MsgEnterProcessed(*msg);
+      }
+    }
+
+    tracker.GetStats(stats, new_count);
+    ASSERT_EQ(new_count, 0);
+    ASSERT_TRUE(stats.empty());
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
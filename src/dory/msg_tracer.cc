@@ -0,0 +1,121 @@
+/* <dory/msg_tracer.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/msg_tracer.h>.
+ */
+
+#include <dory/msg_tracer.h>
+
+#include <cassert>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#include <base/counter.h>
+
+using namespace Base;
+using namespace Dory;
+
+DEFINE_COUNTER(MsgTraceRecord);
+DEFINE_COUNTER(MsgTraceStart);
+
+TMsgTracer::TMsgTracer(size_t sample_interval, size_t ring_size)
+    : SampleInterval(sample_interval),
+      RingSize(ring_size) {
+}
+
+void TMsgTracer::SampleForTrace(TMsg &msg) {
+  if (!IsEnabled()) {
+    return;
+  }
+
+  /* Number of messages this thread must create before it selects one for
+     tracing.  0 indicates that the countdown has not yet been started.  The
+     countdown is started at a point that depends on the thread, so that
+     input threads that receive messages in lockstep don't all select the
+     same ones. */
+  static thread_local size_t countdown = 0;
+
+  if ((countdown == 0) || (countdown > SampleInterval)) {
+    countdown = 1 + (std::hash<std::thread::id>()(std::this_thread::get_id()) %
+        SampleInterval);
+  }
+
+  if (--countdown) {
+    return;
+  }
+
+  countdown = SampleInterval;
+  uint64_t id = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    id = NextTraceId++;
+  }
+
+  msg.StartTrace(id);
+  MsgTraceStart.Increment();
+}
+
+void TMsgTracer::Record(const TMsg &msg) {
+  const TMsg::TTrace *trace = msg.GetTrace();
+  assert(trace);
+
+  if (trace == nullptr) {
+    return;
+  }
+
+  TTraceRecord record;
+  record.Id = trace->Id;
+  record.Topic = msg.GetTopic();
+  record.Partition = msg.GetPartition();
+  record.KeySize = msg.GetKeySize();
+  record.ValueSize = msg.GetValueSize();
+  record.Timestamp = msg.GetTimestamp();
+  record.FailedDeliveryAttemptCount = msg.GetFailedDeliveryAttemptCount();
+  record.ReceivedUsec = msg.GetCreationTimestampUsec();
+  record.BatchedUsec = trace->BatchedUsec;
+  record.DispatchedUsec = trace->DispatchedUsec;
+  record.SentUsec = trace->SentUsec;
+  record.ProcessedUsec = trace->ProcessedUsec;
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    if (Ring.size() < RingSize) {
+      Ring.push_back(std::move(record));
+    } else if (RingSize) {
+      Ring[NextIndex] = std::move(record);
+      NextIndex = (NextIndex + 1) % RingSize;
+    }
+  }
+
+  MsgTraceRecord.Increment();
+}
+
+std::vector<TMsgTracer::TTraceRecord> TMsgTracer::GetTraces() const {
+  std::vector<TTraceRecord> result;
+  std::lock_guard<std::mutex> lock(Mutex);
+  result.reserve(Ring.size());
+
+  for (size_t i = 0; i < Ring.size(); ++i) {
+    result.push_back(Ring[(NextIndex + i) % Ring.size()]);
+  }
+
+  return result;
+}
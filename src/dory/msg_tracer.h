@@ -0,0 +1,123 @@
+/* <dory/msg_tracer.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class for sampling messages for tracing, and keeping the traces of
+   recently processed sampled messages.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <dory/msg.h>
+
+namespace Dory {
+
+  /* Selects 1 in every N messages for tracing.  A traced message records the
+     time it enters each stage of processing (see TMsg::TTrace), and when it
+     has been processed its trace is added to a fixed size ring buffer, which
+     can be viewed through the web interface.  This gives per-message timing
+     for busy topics, where enabling message debug logging for the entire
+     topic is impractical.  Untraced messages pay only the cost of a thread
+     local countdown when created, and a null pointer check on each state
+     change. */
+  class TMsgTracer final {
+    NO_COPY_SEMANTICS(TMsgTracer);
+
+    public:
+    /* Trace of a processed message. */
+    struct TTraceRecord {
+      uint64_t Id = 0;
+
+      std::string Topic;
+
+      int32_t Partition = 0;
+
+      size_t KeySize = 0;
+
+      size_t ValueSize = 0;
+
+      /* Client timestamp from the input datagram. */
+      TMsg::TTimestamp Timestamp = 0;
+
+      size_t FailedDeliveryAttemptCount = 0;
+
+      /* Stage times in monotonic raw microseconds.  See TMsg::TTrace. */
+      uint64_t ReceivedUsec = 0;
+
+      uint64_t BatchedUsec = 0;
+
+      uint64_t DispatchedUsec = 0;
+
+      uint64_t SentUsec = 0;
+
+      uint64_t ProcessedUsec = 0;
+    };  // TTraceRecord
+
+    /* Trace 1 in every 'sample_interval' messages, or no messages if
+       'sample_interval' is 0.  Keep the traces of the 'ring_size' most
+       recently processed traced messages. */
+    TMsgTracer(size_t sample_interval, size_t ring_size);
+
+    bool IsEnabled() const noexcept {
+      return (SampleInterval != 0) && (RingSize != 0);
+    }
+
+    size_t GetSampleInterval() const noexcept {
+      return SampleInterval;
+    }
+
+    size_t GetRingSize() const noexcept {
+      return RingSize;
+    }
+
+    /* Called once for each newly created message.  If the message is
+       selected for tracing, start its trace. */
+    void SampleForTrace(TMsg &msg);
+
+    /* Add the trace of 'msg' to the ring buffer, replacing the oldest trace if
+       the buffer is full.  Called when a traced message has entered state
+       TMsg::TState::Processed. */
+    void Record(const TMsg &msg);
+
+    /* Return the traces in the ring buffer, oldest first. */
+    std::vector<TTraceRecord> GetTraces() const;
+
+    private:
+    const size_t SampleInterval;
+
+    const size_t RingSize;
+
+    /* Protects the members below. */
+    mutable std::mutex Mutex;
+
+    std::vector<TTraceRecord> Ring;
+
+    /* Index in 'Ring' of the next trace to be written, once 'Ring' has reached
+       'RingSize' entries. */
+    size_t NextIndex = 0;
+
+    uint64_t NextTraceId = 1;
+  };  // TMsgTracer
+
+}  // Dory
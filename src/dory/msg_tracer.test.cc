@@ -0,0 +1,143 @@
+/* <dory/msg_tracer.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/msg_tracer.h>.
+ */
+
+#include <dory/msg_tracer.h>
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <base/tmp_file.h>
+#include <dory/msg.h>
+#include <dory/msg_state_tracker.h>
+#include <dory/test_util/misc_util.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::TestUtil;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TMsgTracer. */
+  class TMsgTracerTest : public ::testing::Test {
+    protected:
+    TMsgTracerTest() = default;
+
+    ~TMsgTracerTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TMsgTracerTest
+
+  TEST_F(TMsgTracerTest, Disabled) {
+    TTestMsgCreator mc;
+    TMsgTracer tracer(0, 16);
+    ASSERT_FALSE(tracer.IsEnabled());
+    std::list<TMsg::TPtr> msg_list;
+
+    for (size_t i = 0; i < 100; ++i) {
+      msg_list.push_back(mc.NewMsg("topic", "value", 0));
+      tracer.SampleForTrace(*msg_list.back());
+      ASSERT_FALSE(msg_list.back()->IsTraced());
+    }
+
+    mc.MsgStateTracker.MsgEnterProcessed(msg_list);
+    ASSERT_TRUE(tracer.GetTraces().empty());
+  }
+
+  TEST_F(TMsgTracerTest, SampleInterval) {
+    TTestMsgCreator mc;
+    TMsgTracer tracer(7, 16);
+    ASSERT_TRUE(tracer.IsEnabled());
+    std::list<TMsg::TPtr> msg_list;
+    size_t traced_count = 0;
+
+    for (size_t i = 0; i < 700; ++i) {
+      msg_list.push_back(mc.NewMsg("topic", "value", 0));
+      tracer.SampleForTrace(*msg_list.back());
+
+      if (msg_list.back()->IsTraced()) {
+        ++traced_count;
+      }
+    }
+
+    ASSERT_EQ(traced_count, 100U);
+    mc.MsgStateTracker.MsgEnterProcessed(msg_list);
+  }
+
+  TEST_F(TMsgTracerTest, Stages) {
+    TTestMsgCreator mc;
+    TMsgTracer tracer(1, 2);
+    TMsgStateTracker &tracker = mc.MsgStateTracker;
+    tracker.SetTracer(&tracer);
+    std::list<TMsg::TPtr> msg_list;
+
+    for (size_t i = 0; i < 3; ++i) {
+      TMsg::TPtr msg = mc.NewMsg("topic" + std::to_string(i), "value", 0);
+      tracker.SampleForTrace(*msg);
+      ASSERT_TRUE(msg->IsTraced());
+      tracker.MsgEnterBatching(*msg);
+      msg_list.push_back(std::move(msg));
+    }
+
+    ASSERT_TRUE(tracer.GetTraces().empty());
+
+    for (auto &msg : msg_list) {
+      tracker.MsgEnterSendWait(*msg);
+      tracker.MsgEnterAckWait(*msg);
+      msg->CountFailedDeliveryAttempt();
+      tracker.MsgEnterProcessed(*msg);
+    }
+
+    /* The ring holds only the last 2 traces. */
+    std::vector<TMsgTracer::TTraceRecord> traces = tracer.GetTraces();
+    ASSERT_EQ(traces.size(), 2U);
+    ASSERT_EQ(traces[0].Topic, "topic1");
+    ASSERT_EQ(traces[1].Topic, "topic2");
+    ASSERT_LT(traces[0].Id, traces[1].Id);
+
+    for (const TMsgTracer::TTraceRecord &trace : traces) {
+      ASSERT_EQ(trace.ValueSize, 5U);
+      ASSERT_EQ(trace.FailedDeliveryAttemptCount, 1U);
+      ASSERT_NE(trace.ReceivedUsec, 0U);
+      ASSERT_LE(trace.ReceivedUsec, trace.BatchedUsec);
+      ASSERT_LE(trace.BatchedUsec, trace.DispatchedUsec);
+      ASSERT_LE(trace.DispatchedUsec, trace.SentUsec);
+      ASSERT_LE(trace.SentUsec, trace.ProcessedUsec);
+    }
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
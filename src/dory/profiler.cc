@@ -0,0 +1,216 @@
+/* <dory/profiler.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/profiler.h>.
+ */
+
+#include <dory/profiler.h>
+
+#include <cassert>
+
+#include <time.h>
+
+#include <base/no_default_case.h>
+#include <base/wr/time_util.h>
+
+using namespace Base;
+using namespace Dory;
+
+thread_local TProfiler::TThreadProfile *TProfiler::Current = nullptr;
+
+static uint64_t ReadClockNsec(clockid_t clk_id) noexcept {
+  struct timespec t;
+  Wr::clock_gettime(clk_id, &t);
+  return (static_cast<uint64_t>(t.tv_sec) * 1000000000) +
+      static_cast<uint64_t>(t.tv_nsec);
+}
+
+/* Since the values are only written by a single thread, a plain load and
+   store is enough to update them. */
+static inline void AddTo(std::atomic<uint64_t> &total, uint64_t n) noexcept {
+  total.store(total.load(std::memory_order_relaxed) + n,
+      std::memory_order_relaxed);
+}
+
+const char *TProfiler::ToString(TPhase phase) noexcept {
+  switch (phase) {
+    case TPhase::Wait: {
+      return "wait";
+    }
+    case TPhase::Other: {
+      return "other";
+    }
+    case TPhase::MsgIntake: {
+      return "msg_intake";
+    }
+    case TPhase::Batching: {
+      return "batching";
+    }
+    case TPhase::Routing: {
+      return "routing";
+    }
+    case TPhase::PartitionRetry: {
+      return "partition_retry";
+    }
+    case TPhase::MetadataUpdate: {
+      return "metadata_update";
+    }
+    case TPhase::InputQueue: {
+      return "input_queue";
+    }
+    case TPhase::RequestBuild: {
+      return "request_build";
+    }
+    case TPhase::Compression: {
+      return "compression";
+    }
+    case TPhase::Send: {
+      return "send";
+    }
+    case TPhase::ResponseProcessing: {
+      return "response_processing";
+    }
+    NO_DEFAULT_CASE;
+  }
+
+  return "unknown";
+}
+
+uint64_t TProfiler::TThreadSnapshot::GetBusyNsec() const noexcept {
+  uint64_t result = 0;
+
+  for (size_t i = 0; i < PHASE_COUNT; ++i) {
+    if (static_cast<TPhase>(i) != TPhase::Wait) {
+      result += Phases[i].Nsec;
+    }
+  }
+
+  return result;
+}
+
+void TProfiler::TThreadProfile::EnterPhase(TPhase phase) noexcept {
+  const uint64_t now = ReadClockNsec(CLOCK_MONOTONIC);
+  AddPhaseTime(now);
+  const TPhase old_phase = GetPhase();
+
+  if ((old_phase == TPhase::Wait) && (phase != TPhase::Wait)) {
+    CpuStart = ReadClockNsec(CLOCK_THREAD_CPUTIME_ID);
+  } else if ((old_phase != TPhase::Wait) && (phase == TPhase::Wait)) {
+    AddTo(CpuNsec, ReadClockNsec(CLOCK_THREAD_CPUTIME_ID) - CpuStart);
+  }
+
+  Phase.store(phase, std::memory_order_relaxed);
+  PhaseStart.store(now, std::memory_order_relaxed);
+  AddTo(PhaseCount[static_cast<size_t>(phase)], 1);
+}
+
+void TProfiler::TThreadProfile::Start() noexcept {
+  assert(!Running.load());
+  Phase.store(TPhase::Other, std::memory_order_relaxed);
+  PhaseStart.store(ReadClockNsec(CLOCK_MONOTONIC), std::memory_order_relaxed);
+  CpuStart = ReadClockNsec(CLOCK_THREAD_CPUTIME_ID);
+  AddTo(PhaseCount[static_cast<size_t>(TPhase::Other)], 1);
+  Running.store(true);
+}
+
+void TProfiler::TThreadProfile::Stop() noexcept {
+  AddPhaseTime(ReadClockNsec(CLOCK_MONOTONIC));
+
+  if (GetPhase() != TPhase::Wait) {
+    AddTo(CpuNsec, ReadClockNsec(CLOCK_THREAD_CPUTIME_ID) - CpuStart);
+  }
+
+  Running.store(false);
+}
+
+void TProfiler::TThreadProfile::AddPhaseTime(uint64_t now) noexcept {
+  const uint64_t start = PhaseStart.load(std::memory_order_relaxed);
+
+  if (now > start) {
+    AddTo(PhaseNsec[static_cast<size_t>(GetPhase())], now - start);
+  }
+}
+
+TProfiler::TThreadSnapshot
+TProfiler::TThreadProfile::GetSnapshot(uint64_t now) const noexcept {
+  TThreadSnapshot result;
+  result.Running = Running.load();
+  result.CpuNsec = CpuNsec.load(std::memory_order_relaxed);
+
+  for (size_t i = 0; i < PHASE_COUNT; ++i) {
+    result.Phases[i].Nsec = PhaseNsec[i].load(std::memory_order_relaxed);
+    result.Phases[i].Count = PhaseCount[i].load(std::memory_order_relaxed);
+  }
+
+  if (result.Running) {
+    /* Include the time so far in the current phase, so that a thread that
+       has been waiting a long time doesn't appear to have stopped.  The
+       thread may change phase while we do this, which can make the result
+       slightly inaccurate. */
+    const uint64_t start = PhaseStart.load(std::memory_order_relaxed);
+
+    if (now > start) {
+      result.Phases[static_cast<size_t>(GetPhase())].Nsec += now - start;
+    }
+  }
+
+  return result;
+}
+
+TProfiler::TThreadBinding::TThreadBinding(TProfiler &profiler,
+    const std::string &thread_name) {
+  if (!profiler.IsEnabled()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(profiler.Mutex);
+    std::unique_ptr<TThreadProfile> &p = profiler.Threads[thread_name];
+
+    if (!p) {
+      p.reset(new TThreadProfile);
+    }
+
+    Profile = p.get();
+  }
+
+  assert(Current == nullptr);
+  Current = Profile;
+  Profile->Start();
+}
+
+TProfiler::TThreadBinding::~TThreadBinding() {
+  if (Profile) {
+    Profile->Stop();
+    Current = nullptr;
+  }
+}
+
+std::vector<TProfiler::TThreadSnapshot> TProfiler::GetSnapshots() const {
+  std::vector<TThreadSnapshot> result;
+  const uint64_t now = ReadClockNsec(CLOCK_MONOTONIC);
+  std::lock_guard<std::mutex> lock(Mutex);
+  result.reserve(Threads.size());
+
+  for (const auto &item : Threads) {
+    result.push_back(item.second->GetSnapshot(now));
+    result.back().Name = item.first;
+  }
+
+  return result;
+}
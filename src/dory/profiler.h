@@ -0,0 +1,237 @@
+/* <dory/profiler.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Class for keeping track of how much time the router and connector threads
+   spend in each phase of their work.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+
+namespace Dory {
+
+  /* Built in profiling for the threads that move messages.  Each thread has a
+     current phase, and the time between phase changes is added to the total
+     for the phase it was in, so the totals show which stage of processing a
+     busy thread is spending its time on.  Phase changes are marked with
+     TPhaseScope objects placed in the code, so each one costs a read of the
+     monotonic clock, which the vDSO provides without a system call.  The
+     thread's CPU time (CLOCK_THREAD_CPUTIME_ID) is read only when it starts
+     or stops waiting for events, which happens once per main loop iteration.
+     Comparing CPU time with time spent outside the 'Wait' phase shows
+     whether a thread is CPU bound.  The totals are reported by the web
+     interface. */
+  class TProfiler final {
+    NO_COPY_SEMANTICS(TProfiler);
+
+    public:
+    enum class TPhase {
+      /* Waiting in poll() or epoll_wait() for something to do. */
+      Wait,
+
+      /* Anything not covered by another phase. */
+      Other,
+
+      /* Router thread: validation, journaling, and debug logging of new
+         messages. */
+      MsgIntake,
+
+      /* Router thread: per topic batching. */
+      Batching,
+
+      /* Router thread: choosing partitions and handing messages to connector
+         threads. */
+      Routing,
+
+      /* Router thread: rerouting messages after a partition error. */
+      PartitionRetry,
+
+      /* Router thread: fetching and applying new metadata. */
+      MetadataUpdate,
+
+      /* Connector threads: taking messages from the input queue. */
+      InputQueue,
+
+      /* Connector threads: serializing produce requests. */
+      RequestBuild,
+
+      /* Connector threads: compressing message sets. */
+      Compression,
+
+      /* Connector threads: sending produce requests. */
+      Send,
+
+      /* Connector threads: reading and processing produce responses. */
+      ResponseProcessing
+    };  // TPhase
+
+    static const size_t PHASE_COUNT = 12;
+
+    static const char *ToString(TPhase phase) noexcept;
+
+    /* Totals for a phase.  Times are in nanoseconds. */
+    struct TPhaseTotals {
+      uint64_t Nsec = 0;
+
+      /* Number of times the phase was entered. */
+      uint64_t Count = 0;
+    };  // TPhaseTotals
+
+    struct TThreadSnapshot {
+      std::string Name;
+
+      /* True if a thread is currently recording to this profile. */
+      bool Running = false;
+
+      /* CPU time used by the thread outside the 'Wait' phase. */
+      uint64_t CpuNsec = 0;
+
+      /* Indexed by TPhase. */
+      std::array<TPhaseTotals, PHASE_COUNT> Phases;
+
+      /* Total time outside the 'Wait' phase. */
+      uint64_t GetBusyNsec() const noexcept;
+    };  // TThreadSnapshot
+
+    /* Totals for a single named thread.  Only the thread bound to the profile
+       (see TThreadBinding) updates it, so the totals are plain loads and
+       stores rather than atomic read-modify-write operations.  They are
+       atomic only so the web interface can read them. */
+    class TThreadProfile final {
+      NO_COPY_SEMANTICS(TThreadProfile);
+
+      public:
+      TThreadProfile() = default;
+
+      TPhase GetPhase() const noexcept {
+        return Phase.load(std::memory_order_relaxed);
+      }
+
+      /* Add the time since the last phase change to the current phase, and
+         switch to 'phase'. */
+      void EnterPhase(TPhase phase) noexcept;
+
+      private:
+      friend class TProfiler;
+
+      void Start() noexcept;
+
+      void Stop() noexcept;
+
+      void AddPhaseTime(uint64_t now) noexcept;
+
+      TThreadSnapshot GetSnapshot(uint64_t now) const noexcept;
+
+      std::atomic<bool> Running{false};
+
+      std::atomic<TPhase> Phase{TPhase::Other};
+
+      /* Monotonic time when the current phase was entered. */
+      std::atomic<uint64_t> PhaseStart{0};
+
+      /* Thread CPU time when the thread last left the 'Wait' phase. */
+      uint64_t CpuStart = 0;
+
+      std::atomic<uint64_t> CpuNsec{0};
+
+      std::array<std::atomic<uint64_t>, PHASE_COUNT> PhaseNsec{};
+
+      std::array<std::atomic<uint64_t>, PHASE_COUNT> PhaseCount{};
+    };  // TThreadProfile
+
+    /* While one of these exists, TPhaseScope objects on the thread that
+       created it record to the profile with the given name.  Threads that
+       are restarted (for instance connector threads after a metadata update)
+       use the same name each time, so their totals accumulate.  At most one
+       thread at a time may be bound to a given name.  Does nothing if the
+       profiler is disabled. */
+    class TThreadBinding final {
+      NO_COPY_SEMANTICS(TThreadBinding);
+
+      public:
+      TThreadBinding(TProfiler &profiler, const std::string &thread_name);
+
+      ~TThreadBinding();
+
+      private:
+      TThreadProfile *Profile = nullptr;
+    };  // TThreadBinding
+
+    /* Enters the given phase for the lifetime of the object, and then
+       returns to the previous phase.  Does nothing on threads not bound to a
+       profile. */
+    class TPhaseScope final {
+      NO_COPY_SEMANTICS(TPhaseScope);
+
+      public:
+      explicit TPhaseScope(TPhase phase) noexcept
+          : Profile(Current) {
+        if (Profile) {
+          PrevPhase = Profile->GetPhase();
+          Profile->EnterPhase(phase);
+        }
+      }
+
+      ~TPhaseScope() {
+        if (Profile) {
+          Profile->EnterPhase(PrevPhase);
+        }
+      }
+
+      private:
+      TThreadProfile * const Profile;
+
+      TPhase PrevPhase = TPhase::Other;
+    };  // TPhaseScope
+
+    explicit TProfiler(bool enable)
+        : Enabled(enable) {
+    }
+
+    bool IsEnabled() const noexcept {
+      return Enabled;
+    }
+
+    /* Called by Mongoose thread.  Results are sorted by thread name. */
+    std::vector<TThreadSnapshot> GetSnapshots() const;
+
+    private:
+    /* Profile of the calling thread, or nullptr if not bound. */
+    static thread_local TThreadProfile *Current;
+
+    const bool Enabled;
+
+    /* Protects 'Threads' from concurrent access.  The profiles themselves
+       need no locking. */
+    mutable std::mutex Mutex;
+
+    std::map<std::string, std::unique_ptr<TThreadProfile>> Threads;
+  };  // TProfiler
+
+}  // Dory
@@ -0,0 +1,172 @@
+/* <dory/profiler.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <dory/profiler.h>.
+ */
+
+#include <dory/profiler.h>
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include <base/time_util.h>
+#include <base/tmp_file.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace ::TestUtil;
+
+namespace {
+
+  using TPhase = TProfiler::TPhase;
+
+  const TProfiler::TPhaseTotals &GetTotals(
+      const TProfiler::TThreadSnapshot &snapshot, TPhase phase) {
+    return snapshot.Phases[static_cast<size_t>(phase)];
+  }
+
+  /* The fixture for testing class TProfiler. */
+  class TProfilerTest : public ::testing::Test {
+    protected:
+    TProfilerTest() = default;
+
+    ~TProfilerTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TProfilerTest
+
+  TEST_F(TProfilerTest, Disabled) {
+    TProfiler profiler(false);
+    ASSERT_FALSE(profiler.IsEnabled());
+
+    {
+      TProfiler::TThreadBinding binding(profiler, "thread");
+      TProfiler::TPhaseScope phase(TPhase::Routing);
+    }
+
+    ASSERT_TRUE(profiler.GetSnapshots().empty());
+  }
+
+  TEST_F(TProfilerTest, Phases) {
+    TProfiler profiler(true);
+
+    /* Scopes on a thread with no binding are ignored. */
+    {
+      TProfiler::TPhaseScope phase(TPhase::Routing);
+    }
+
+    {
+      TProfiler::TThreadBinding binding(profiler, "thread");
+
+      {
+        TProfiler::TPhaseScope wait(TPhase::Wait);
+        SleepMilliseconds(20);
+      }
+
+      for (size_t i = 0; i < 3; ++i) {
+        TProfiler::TPhaseScope routing(TPhase::Routing);
+
+        {
+          TProfiler::TPhaseScope batching(TPhase::Batching);
+          SleepMilliseconds(10);
+        }
+      }
+
+      std::vector<TProfiler::TThreadSnapshot> snapshots =
+          profiler.GetSnapshots();
+      ASSERT_EQ(snapshots.size(), 1U);
+      ASSERT_EQ(snapshots[0].Name, "thread");
+      ASSERT_TRUE(snapshots[0].Running);
+    }
+
+    std::vector<TProfiler::TThreadSnapshot> snapshots =
+        profiler.GetSnapshots();
+    ASSERT_EQ(snapshots.size(), 1U);
+    const TProfiler::TThreadSnapshot &s = snapshots[0];
+    ASSERT_FALSE(s.Running);
+    ASSERT_EQ(GetTotals(s, TPhase::Wait).Count, 1U);
+    ASSERT_GE(GetTotals(s, TPhase::Wait).Nsec, 20U * 1000 * 1000);
+    ASSERT_EQ(GetTotals(s, TPhase::Routing).Count, 6U);
+    ASSERT_EQ(GetTotals(s, TPhase::Batching).Count, 3U);
+    ASSERT_GE(GetTotals(s, TPhase::Batching).Nsec, 30U * 1000 * 1000);
+
+    /* Entered once when the thread started, and once more after each
+       scope. */
+    ASSERT_EQ(GetTotals(s, TPhase::Other).Count, 5U);
+    ASSERT_EQ(GetTotals(s, TPhase::Send).Count, 0U);
+    ASSERT_EQ(GetTotals(s, TPhase::Send).Nsec, 0U);
+    ASSERT_GE(s.GetBusyNsec(), 30U * 1000 * 1000);
+
+    /* Sleeping doesn't use CPU time. */
+    ASSERT_LT(s.CpuNsec, s.GetBusyNsec());
+  }
+
+  TEST_F(TProfilerTest, Restart) {
+    TProfiler profiler(true);
+
+    auto thread_fn = [&profiler] {
+      TProfiler::TThreadBinding binding(profiler, "connector");
+      TProfiler::TPhaseScope phase(TPhase::Compression);
+      volatile size_t x = 0;
+
+      for (size_t i = 0; i < 1000000; ++i) {
+        x = x + i;
+      }
+    };
+
+    std::thread t1(thread_fn);
+    t1.join();
+    std::thread t2(thread_fn);
+    t2.join();
+
+    {
+      TProfiler::TThreadBinding binding(profiler, "router");
+    }
+
+    std::vector<TProfiler::TThreadSnapshot> snapshots =
+        profiler.GetSnapshots();
+    ASSERT_EQ(snapshots.size(), 2U);
+    ASSERT_EQ(snapshots[0].Name, "connector");
+    ASSERT_EQ(snapshots[1].Name, "router");
+    ASSERT_EQ(GetTotals(snapshots[0], TPhase::Compression).Count, 2U);
+    ASSERT_GT(GetTotals(snapshots[0], TPhase::Compression).Nsec, 0U);
+    ASSERT_GT(snapshots[0].CpuNsec, 0U);
+    ASSERT_EQ(GetTotals(snapshots[1], TPhase::Compression).Count, 0U);
+  }
+
+  TEST_F(TProfilerTest, PhaseNames) {
+    for (size_t i = 0; i < TProfiler::PHASE_COUNT; ++i) {
+      ASSERT_STRNE(TProfiler::ToString(static_cast<TPhase>(i)), "unknown");
+    }
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
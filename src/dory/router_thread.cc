@@ -21,6 +21,7 @@
 
 #include <dory/router_thread.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <exception>
 #include <limits>
@@ -33,8 +34,6 @@
 #include <base/no_default_case.h>
 #include <base/time_util.h>
 #include <base/wr/fd_util.h>
-#include <dory/kafka_proto/metadata/metadata_protocol.h>
-#include <dory/kafka_proto/metadata/version_util.h>
 #include <dory/kafka_proto/produce/produce_protocol.h>
 #include <dory/kafka_proto/produce/version_util.h>
 #include <dory/util/connect_to_host.h>
@@ -46,9 +45,9 @@ using namespace Dory;
 using namespace Dory::Batch;
 using namespace Dory::Conf;
 using namespace Dory::Debug;
-using namespace Dory::KafkaProto::Metadata;
 using namespace Dory::KafkaProto::Produce;
 using namespace Dory::MsgDispatch;
+using namespace Dory::Spill;
 using namespace Dory::Util;
 using namespace Log;
 
@@ -65,13 +64,21 @@ DEFINE_COUNTER(DiscardLongMsg);
 DEFINE_COUNTER(DiscardNoAvailablePartition);
 DEFINE_COUNTER(DiscardNoAvailablePartitionOnReroute);
 DEFINE_COUNTER(DiscardNoLongerAvailableTopicMsg);
+DEFINE_COUNTER(DiscardOnSpillFail);
 DEFINE_COUNTER(DiscardOnTopicAutocreateFail);
 DEFINE_COUNTER(FinishRefreshMetadata);
 DEFINE_COUNTER(GetMetadataFail);
 DEFINE_COUNTER(GetMetadataSuccess);
+DEFINE_COUNTER(JournalReplayBatch);
+DEFINE_COUNTER(JournalReplayPoolFull);
 DEFINE_COUNTER(MetadataChangedOnRefresh);
 DEFINE_COUNTER(MetadataUnchangedOnRefresh);
 DEFINE_COUNTER(MetadataUpdated);
+DEFINE_COUNTER(PartitionRetryDispatcherRestart);
+DEFINE_COUNTER(PartitionRetryLeadersChanged);
+DEFINE_COUNTER(PartitionRetryLeadersUnchanged);
+DEFINE_COUNTER(PartitionRetryLiveMetadataUpdate);
+DEFINE_COUNTER(PartitionRetryMsgsAvailable);
 DEFINE_COUNTER(PerTopicBatchAnyPartition);
 DEFINE_COUNTER(PossibleDuplicateMsg);
 DEFINE_COUNTER(RefreshMetadataSuccess);
@@ -83,6 +90,11 @@ DEFINE_COUNTER(RouteSingleAnyPartitionMsg);
 DEFINE_COUNTER(RouteSingleMsg);
 DEFINE_COUNTER(RouteSinglePartitionKeyMsg);
 DEFINE_COUNTER(SetBatchExpiry);
+DEFINE_COUNTER(SpillReplayBatch);
+DEFINE_COUNTER(SpillReplayPoolFull);
+DEFINE_COUNTER(SpillRouterMsg);
+DEFINE_COUNTER(SpillRouterMsgDuringOutage);
+DEFINE_COUNTER(StartPartitionRetry);
 DEFINE_COUNTER(StartRefreshMetadata);
 DEFINE_COUNTER(TopicHasNoAvailablePartitions);
 
@@ -90,6 +102,19 @@ static unsigned GetRandomNumber() {
   return std::rand();
 }
 
+/* Maximum number of messages to replay from the spill queue in a single main
+   loop iteration, so that input from the input thread isn't starved. */
+static const size_t SPILL_REPLAY_BATCH_SIZE = 1024;
+
+/* How often, in milliseconds, to check whether spilling or replay is needed
+   while no other events are occurring. */
+static const int SPILL_CHECK_INTERVAL = 100;
+
+/* Replay of recovered journal messages pauses while at least this percentage
+   of the buffer pool is in use, so that replay doesn't crowd out new
+   messages. */
+static const size_t JOURNAL_REPLAY_MAX_POOL_PERCENT = 50;
+
 TRouterThread::~TRouterThread() {
   /* This will shut down the thread if something unexpected happens.  Setting
      the 'Destroying' flag tells the thread to shut down immediately when it
@@ -103,6 +128,7 @@ void TRouterThread::Run() {
   LOG(TPri::NOTICE) << "Router thread " << tid << " started";
 
   try {
+    TProfiler::TThreadBinding profile(Profiler, "router");
     DoRun();
   } catch (const TShutdownOnDestroy &) {
     Die("TShutdownOnDestroy thrown from router thread");
@@ -120,21 +146,27 @@ void TRouterThread::Run() {
 }
 
 TRouterThread::TRouterThread(const TCmdLineArgs &args, const TConf &conf,
-    TAnomalyTracker &anomaly_tracker, TMsgStateTracker &msg_state_tracker,
+    Capped::TPool &pool, TAnomalyTracker &anomaly_tracker,
+    TMsgStateTracker &msg_state_tracker,
     const Batch::TGlobalBatchConfig &batch_config,
     const Debug::TDebugSetup &debug_setup,
-    MsgDispatch::TKafkaDispatcherApi &dispatcher)
+    TApiVersionStats &api_version_stats, TLingerStats &linger_stats,
+    TProfiler &profiler, MsgDispatch::TKafkaDispatcherApi &dispatcher)
     : CmdLineArgs(args),
       Conf(conf),
       MsgRateLimiter(conf.TopicRateConf),
       MessageMaxBytes(batch_config.GetMessageMaxBytes()),
+      Pool(pool),
       AnomalyTracker(anomaly_tracker),
       MsgStateTracker(msg_state_tracker),
       DebugSetup(debug_setup),
+      ApiVersionStats(api_version_stats),
+      Profiler(profiler),
       KnownBrokers(conf.InitialBrokers),
       PerTopicBatcher(batch_config.GetPerTopicConfig()),
       Dispatcher(dispatcher),
       DebugLogger(debug_setup, TDebugSetup::TLogId::MSG_RECEIVE) {
+  PerTopicBatcher.SetLingerStats(&linger_stats, std::nullopt);
 }
 
 size_t TRouterThread::ComputeRetryDelay(size_t mean_delay, size_t div) {
@@ -340,7 +372,8 @@ bool TRouterThread::ValidateNewMsg(TMsg::TPtr &msg) {
   }
 
   if (msg->BodyIsTruncated() ||
-      ((msg->GetKeyAndValue().Size() + SingleMsgOverhead) > MessageMaxBytes)) {
+      ((msg->GetKeyAndValue().Size() + SingleMsgOverhead + MsgSetOverhead) >
+          MessageMaxBytes)) {
     /* Check for truncation _after_ checking for topic existence.  If the topic
        doesn't exist, we treat it as a bad topic discard even if the message is
        also too long.  Perform this check _before_ assigning a partition so we
@@ -682,6 +715,10 @@ void TRouterThread::RouteFinalMsgs() {
     }
 
     if (msg) {
+      if (Journal && !msg->GetJournalSeq()) {
+        Journal->Append(*msg);
+      }
+
       DebugLogger.LogMsg(msg);
       RouteNow(std::move(msg));
     }
@@ -726,28 +763,48 @@ void TRouterThread::DiscardFinalMsgs() {
 }
 
 void TRouterThread::InitWireProtocol() {
-  /* This code is just a placeholder, since Dory currently supports only
-     version 0 of the metadata and produce wire protocols.  Eventually code
-     will go here that handles cases where a specific metadata or produce
-     protocol version was not specified as a command line arg.  In this case,
-     we will probe the Kafka cluster and choose the highest version supported
-     by both Dory and the Kafka brokers. */
+  /* Dory currently supports only version 0 of the metadata wire protocol.
+     Unless API version negotiation is enabled, the produce protocol version
+     comes from the config file.  With negotiation enabled, the metadata
+     fetcher and each connector thread probe the broker they talk to and
+     choose the highest version supported by both Dory and the broker. */
   const size_t metadata_api_version = 0;
-  std::unique_ptr<TMetadataProtocol> metadata_protocol(
-      ChooseMetadataProto(metadata_api_version));
-  assert(metadata_protocol);
-  const size_t produce_api_version = 0;
+  const bool api_version_request = Conf.KafkaConfigConf.ApiVersionRequest;
+  MetadataFetcher.reset(new TMetadataFetcher(metadata_api_version,
+      ApiVersionStats, api_version_request,
+      static_cast<int>(Conf.MsgDeliveryConf.KafkaSocketTimeout * 1000)));
+  const size_t produce_api_version = Conf.KafkaConfigConf.ProduceApiVersion;
   std::unique_ptr<TProduceProtocol> produce_protocol(
       ChooseProduceProto(produce_api_version));
   assert(produce_protocol);
-
-  MetadataFetcher.reset(new TMetadataFetcher(metadata_protocol.release()));
   SingleMsgOverhead = produce_protocol->GetSingleMsgOverhead();
+  MsgSetOverhead = produce_protocol->GetMsgSetOverhead();
+
+  if (api_version_request) {
+    /* We don't know in advance which produce API version each connector will
+       choose, so check message sizes against the worst case overhead. */
+    for (size_t version : GetSupportedProduceApiVersions()) {
+      std::unique_ptr<TProduceProtocol> p(ChooseProduceProto(version));
+      assert(p);
+      SingleMsgOverhead = std::max(SingleMsgOverhead,
+          p->GetSingleMsgOverhead());
+      MsgSetOverhead = std::max(MsgSetOverhead, p->GetMsgSetOverhead());
+    }
+  }
+
   Dispatcher.SetProduceProtocol(produce_protocol.release());
 }
 
 bool TRouterThread::Init() {
   InitWireProtocol();
+
+  if (!Conf.SpilloverConf.Path.empty()) {
+    /* Any messages left on disk by a previous run are recovered here, and
+       replayed once we have metadata. */
+    SpillQueue.reset(new TSpillQueue(Conf.SpilloverConf.Path,
+        Conf.SpilloverConf.SegmentSize, Conf.SpilloverConf.MaxDiskBytes));
+  }
+
   std::shared_ptr<TMetadata> meta;
 
   LOG(TPri::NOTICE) << "Router thread sending initial metadata request";
@@ -929,6 +986,11 @@ std::list<std::list<TMsg::TPtr>> TRouterThread::EmptyDispatcher() {
     broker_lists.resize(nonempty_count);
   }
 
+  /* Include any messages parked after partition-level error ACKs, so they
+     aren't lost when the dispatcher restarts or shuts down. */
+  result.splice(result.end(), Dispatcher.TakePartitionRetryMsgs());
+  result.splice(result.end(), PartitionRetryMsgs);
+  OptPartitionRetryTime.reset();
   return result;
 }
 
@@ -994,6 +1056,8 @@ void TRouterThread::DiscardOnShutdownDuringMetadataUpdate(
 }
 
 bool TRouterThread::HandleMetadataUpdate() {
+  TProfiler::TPhaseScope metadata_phase(TProfiler::TPhase::MetadataUpdate);
+
   if (MetadataUpdateRequestSem.GetFd().IsReadable()) {
     MetadataUpdateRequestSem.Pop();
     LOG(TPri::NOTICE)
@@ -1015,6 +1079,133 @@ bool TRouterThread::HandleMetadataUpdate() {
   return keep_running;
 }
 
+void TRouterThread::HandlePartitionRetryAvailable() {
+  std::list<std::list<TMsg::TPtr>> parked =
+      Dispatcher.TakePartitionRetryMsgs();
+
+  if (parked.empty()) {
+    return;
+  }
+
+  PartitionRetryMsgsAvailable.Increment();
+  PartitionRetryMsgs.splice(PartitionRetryMsgs.end(), parked);
+
+  if (!OptPartitionRetryTime) {
+    OptPartitionRetryTime.emplace(GetEpochMilliseconds() +
+        Conf.MsgDeliveryConf.PartitionRetryDelay);
+  }
+}
+
+bool TRouterThread::PartitionLeadersUnchanged(const TMetadata &probe,
+    const std::set<std::string> &topics) const {
+  assert(Metadata);
+
+  for (const std::string &topic : topics) {
+    int old_index = Metadata->FindTopicIndex(topic);
+    int new_index = probe.FindTopicIndex(topic);
+
+    if ((old_index < 0) || (new_index < 0)) {
+      return false;
+    }
+
+    const std::vector<TMetadata::TPartition> &old_partitions =
+        Metadata->GetTopics()[static_cast<size_t>(old_index)].
+            GetAllPartitions();
+    const std::vector<TMetadata::TPartition> &new_partitions =
+        probe.GetTopics()[static_cast<size_t>(new_index)].GetAllPartitions();
+
+    if (old_partitions.size() != new_partitions.size()) {
+      return false;
+    }
+
+    for (const TMetadata::TPartition &new_p : new_partitions) {
+      auto iter = std::find_if(old_partitions.begin(), old_partitions.end(),
+          [&new_p](const TMetadata::TPartition &old_p) {
+            return (old_p.GetId() == new_p.GetId());
+          });
+
+      if ((iter == old_partitions.end()) ||
+          (iter->GetErrorCode() != new_p.GetErrorCode()) ||
+          (Metadata->GetBrokers()[iter->GetBrokerIndex()].GetId() !=
+              probe.GetBrokers()[new_p.GetBrokerIndex()].GetId())) {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool TRouterThread::HandlePartitionRetry() {
+  assert(!ShutdownStartTime.has_value());
+  TProfiler::TPhaseScope retry_phase(TProfiler::TPhase::PartitionRetry);
+  OptPartitionRetryTime.reset();
+  std::list<std::list<TMsg::TPtr>> parked;
+  parked.swap(PartitionRetryMsgs);
+  parked.splice(parked.end(), Dispatcher.TakePartitionRetryMsgs());
+
+  if (parked.empty()) {
+    return true;
+  }
+
+  StartPartitionRetry.Increment();
+  std::set<std::string> topics;
+
+  for (const std::list<TMsg::TPtr> &msg_list : parked) {
+    assert(!msg_list.empty());
+    topics.insert(msg_list.front()->GetTopic());
+  }
+
+  /* Get metadata once per retry pass, and check all parked topics against
+     it.  If leaders changed, the same metadata is handed to the dispatcher
+     below. */
+  std::shared_ptr<TMetadata> md = TryGetMetadata();
+
+  if (md && PartitionLeadersUnchanged(*md, topics)) {
+    /* Most likely a transient error such as a request timeout on the broker
+       side.  Try the same partitions again. */
+    PartitionRetryLeadersUnchanged.Increment();
+    Reroute(std::move(parked));
+    return true;
+  }
+
+  PartitionRetryLeadersChanged.Increment();
+
+  if (md && (md->GetBrokers() == Metadata->GetBrokers())) {
+    /* The set of brokers is unchanged, so the connectors can keep running.
+       Hand the new metadata to the dispatcher, which lets each connector pick
+       it up without dropping its connection. */
+    PartitionRetryLiveMetadataUpdate.Increment();
+    LOG(TPri::NOTICE)
+        << "Router thread updating dispatcher metadata without restart";
+    SetMetadata(std::move(md), true);
+    Dispatcher.UpdateMetadata(Metadata);
+    Reroute(std::move(parked));
+    InitMetadataRefreshTimer();
+    return true;
+  }
+
+  /* Broker set changed, or full metadata fetch failed.  Fall back to
+     restarting the dispatcher, which will retry the metadata fetch as
+     necessary. */
+  if (md) {
+    MetadataTimestamp.RecordUpdate(true);
+  }
+
+  PartitionRetryDispatcherRestart.Increment();
+
+  if (!ReplaceMetadataOnRefresh(std::move(md))) {
+    /* Shutdown delay expired while getting metadata.  The dispatcher is
+       already shut down, so we are finished. */
+    DiscardOnShutdownDuringMetadataUpdate(std::move(parked));
+    DiscardOnShutdownDuringMetadataUpdate(EmptyDispatcher());
+    return false;
+  }
+
+  Reroute(std::move(parked));
+  return true;
+}
+
 void TRouterThread::ContinueShutdown() {
   NeedToContinueShutdown = false;
 
@@ -1038,8 +1229,34 @@ void TRouterThread::ContinueShutdown() {
 }
 
 int TRouterThread::ComputeMainLoopPollTimeout() {
+  int timeout = -1;  // infinite timeout
+
+  if (SpillQueue && !SpillQueue->IsEmpty() && !ShutdownStartTime) {
+    /* Replay immediately if the pool has room.  Otherwise check again
+       shortly, since the pool drains without any event we can poll for. */
+    timeout = PoolUsageAtLeast(Conf.SpilloverConf.LowWatermarkPercent) ?
+        SPILL_CHECK_INTERVAL : 0;
+  }
+
+  if (Journal && Journal->HasRecoveredMsgs() && !ShutdownStartTime) {
+    const int journal_timeout =
+        PoolUsageAtLeast(JOURNAL_REPLAY_MAX_POOL_PERCENT) ?
+            SPILL_CHECK_INTERVAL : 0;
+    timeout = (timeout < 0) ?
+        journal_timeout : std::min(timeout, journal_timeout);
+  }
+
+  if (OptPartitionRetryTime && !ShutdownStartTime) {
+    const uint64_t now = GetEpochMilliseconds();
+    const int retry_timeout = (*OptPartitionRetryTime <= now) ?
+        0 : static_cast<int>(std::min<uint64_t>(*OptPartitionRetryTime - now,
+            static_cast<uint64_t>(std::numeric_limits<int>::max())));
+    timeout = (timeout < 0) ?
+        retry_timeout : std::min(timeout, retry_timeout);
+  }
+
   if (!OptNextBatchExpiry) {
-    return -1;  // infinite timeout
+    return timeout;
   }
 
   auto expiry = static_cast<uint64_t>(*OptNextBatchExpiry);
@@ -1060,7 +1277,8 @@ int TRouterThread::ComputeMainLoopPollTimeout() {
     return 0;
   }
 
-  return static_cast<int>(delta);
+  return (timeout < 0) ?
+      static_cast<int>(delta) : std::min(timeout, static_cast<int>(delta));
 }
 
 void TRouterThread::InitMainLoopPollArray() {
@@ -1075,6 +1293,8 @@ void TRouterThread::InitMainLoopPollArray() {
       MainLoopPollArray[TMainLoopPollItem::MdRefresh];
   struct pollfd &shutdown_finished_item =
       MainLoopPollArray[TMainLoopPollItem::ShutdownFinished];
+  struct pollfd &partition_retry_item =
+      MainLoopPollArray[TMainLoopPollItem::PartitionRetry];
   bool shutdown_started = ShutdownStartTime.has_value();
   pause_item.fd = Dispatcher.GetPauseFd();
   pause_item.events = POLLIN;
@@ -1097,6 +1317,10 @@ void TRouterThread::InitMainLoopPollArray() {
       int(Dispatcher.GetShutdownWaitFd()) : -1;
   shutdown_finished_item.events = POLLIN;
   shutdown_finished_item.revents = 0;
+  partition_retry_item.fd = shutdown_started ?
+      -1 : int(Dispatcher.GetPartitionRetryFd());
+  partition_retry_item.events = POLLIN;
+  partition_retry_item.revents = 0;
 }
 
 void TRouterThread::DoRun() {
@@ -1114,10 +1338,17 @@ void TRouterThread::DoRun() {
     }
 
     InitMainLoopPollArray();
+    const int timeout = ComputeMainLoopPollTimeout();
+    int ret = 0;
+
+    {
+      TProfiler::TPhaseScope wait_phase(TProfiler::TPhase::Wait);
+
+      /* Treat EINTR as fatal since we should have all signals blocked. */
+      ret = Wr::poll(Wr::TDisp::AddFatal, {EINTR}, MainLoopPollArray,
+          MainLoopPollArray.Size(), timeout);
+    }
 
-    /* Treat EINTR as fatal since we should have all signals blocked. */
-    const int ret = Wr::poll(Wr::TDisp::AddFatal, {EINTR}, MainLoopPollArray,
-        MainLoopPollArray.Size(), ComputeMainLoopPollTimeout());
     assert(ret >= 0);
 
     if (MainLoopPollArray[TMainLoopPollItem::ShutdownRequest].revents) {
@@ -1144,6 +1375,16 @@ void TRouterThread::DoRun() {
       break;  // shutdown delay expired during metadata update
     }
 
+    if (MainLoopPollArray[TMainLoopPollItem::PartitionRetry].revents) {
+      HandlePartitionRetryAvailable();
+    }
+
+    if (OptPartitionRetryTime && !ShutdownStartTime &&
+        (GetEpochMilliseconds() >= *OptPartitionRetryTime) &&
+        !HandlePartitionRetry()) {
+      break;  // shutdown delay expired during metadata update
+    }
+
     uint64_t now = GetEpochMilliseconds();
 
     if (OptNextBatchExpiry &&
@@ -1154,6 +1395,16 @@ void TRouterThread::DoRun() {
     if (MainLoopPollArray[TMainLoopPollItem::MsgAvailable].revents) {
       HandleMsgAvailable(now);
     }
+
+    if (Journal && Journal->HasRecoveredMsgs() && !ShutdownStartTime &&
+        !PoolUsageAtLeast(JOURNAL_REPLAY_MAX_POOL_PERCENT)) {
+      ReplayJournalMsgs(now);
+    }
+
+    if (SpillQueue && !SpillQueue->IsEmpty() && !ShutdownStartTime &&
+        !PoolUsageAtLeast(Conf.SpilloverConf.LowWatermarkPercent)) {
+      ReplaySpilledMsgs(now);
+    }
   }
 
   Discard(PerTopicBatcher.GetAllBatches(),
@@ -1191,7 +1442,18 @@ void TRouterThread::HandleShutdownFinished() {
 void TRouterThread::HandleBatchExpiry(uint64_t now) {
   assert(PerTopicBatcher.IsEnabled());
   BatchExpiryDetected.Increment();
-  RouteAnyPartitionNow(PerTopicBatcher.GetCompleteBatches(now));
+  std::list<std::list<TMsg::TPtr>> complete_batches;
+
+  {
+    TProfiler::TPhaseScope batching_phase(TProfiler::TPhase::Batching);
+    complete_batches = PerTopicBatcher.GetCompleteBatches(now);
+  }
+
+  {
+    TProfiler::TPhaseScope routing_phase(TProfiler::TPhase::Routing);
+    RouteAnyPartitionNow(std::move(complete_batches));
+  }
+
   OptNextBatchExpiry = PerTopicBatcher.GetNextCompleteTime();
 
   if (OptNextBatchExpiry) {
@@ -1200,9 +1462,20 @@ void TRouterThread::HandleBatchExpiry(uint64_t now) {
 }
 
 void TRouterThread::HandleMsgAvailable(uint64_t now) {
+  TProfiler::TPhaseScope intake_phase(TProfiler::TPhase::MsgIntake);
   RouterThreadGetMsgList.Increment();
-  std::list<std::list<TMsg::TPtr>> ready_batches;
   std::list<TMsg::TPtr> msg_list = MsgChannel.Get();
+
+  if (ShouldSpill()) {
+    SpillMsgs(msg_list);
+  }
+
+  ProcessNewMsgs(std::move(msg_list), now);
+}
+
+void TRouterThread::ProcessNewMsgs(std::list<TMsg::TPtr> &&msg_list,
+    uint64_t now) {
+  std::list<std::list<TMsg::TPtr>> ready_batches;
   std::list<TMsg::TPtr> remaining;
   bool keep_running = true;
 
@@ -1221,6 +1494,12 @@ void TRouterThread::HandleMsgAvailable(uint64_t now) {
       continue;
     }
 
+    if (Journal && !msg_ptr->GetJournalSeq()) {
+      /* On failure, the message is still routed.  It just won't be recovered
+         if we crash. */
+      Journal->Append(*msg_ptr);
+    }
+
     DebugLogger.LogMsg(msg_ptr);
 
     /* For AnyPartition messages, per topic batching is done here, before we
@@ -1229,6 +1508,7 @@ void TRouterThread::HandleMsgAvailable(uint64_t now) {
        broker). */
     if ((msg_ptr->GetRoutingType() == TMsg::TRoutingType::AnyPartition) &&
         PerTopicBatcher.IsEnabled()) {
+      TProfiler::TPhaseScope batching_phase(TProfiler::TPhase::Batching);
       TMsg &msg = *msg_ptr;
       ready_batches.splice(ready_batches.end(),
                            PerTopicBatcher.AddMsg(std::move(msg_ptr), now));
@@ -1256,6 +1536,7 @@ void TRouterThread::HandleMsgAvailable(uint64_t now) {
   }
 
   if (keep_running) {
+    TProfiler::TPhaseScope routing_phase(TProfiler::TPhase::Routing);
     RouteAnyPartitionNow(std::move(ready_batches));
 
     for (TMsg::TPtr &msg_ptr : remaining) {
@@ -1275,6 +1556,141 @@ void TRouterThread::HandleMsgAvailable(uint64_t now) {
   }
 }
 
+void TRouterThread::SpillMsgs(std::list<TMsg::TPtr> &msg_list) {
+  assert(SpillQueue);
+
+  while (!msg_list.empty()) {
+    TMsg::TPtr &msg = msg_list.front();
+    assert(msg);
+
+    if (!SpillQueue->Put(*msg)) {
+      /* Disk cap reached, message too large, or I/O error. */
+      if (SpillQueue->IsEmpty()) {
+        /* Nothing older is waiting on disk, so the caller can handle the
+           rest of the messages normally without reordering them. */
+        break;
+      }
+
+      /* Routing the message now would put it ahead of older spilled
+         messages, so discard it. */
+      TMsg::TPtr to_discard(std::move(msg));
+      msg_list.pop_front();
+      Discard(std::move(to_discard),
+          TAnomalyTracker::TDiscardReason::FailedSpill);
+      DiscardOnSpillFail.Increment();
+      continue;
+    }
+
+    /* The message will be recreated when replayed, so this copy is done. */
+    MsgStateTracker.MsgEnterProcessed(*msg);
+    msg_list.pop_front();
+    SpillRouterMsg.Increment();
+  }
+}
+
+void TRouterThread::SpillQueuedMsgs() {
+  if (!ShouldSpill()) {
+    return;
+  }
+
+  std::list<TMsg::TPtr> msg_list = MsgChannel.NonblockingGet();
+
+  if (msg_list.empty()) {
+    return;
+  }
+
+  const size_t count = msg_list.size();
+  SpillMsgs(msg_list);
+  SpillRouterMsgDuringOutage.Increment(count - msg_list.size());
+
+  if (!msg_list.empty()) {
+    /* We can't route these without metadata, so give them back to the
+       channel.  They will be handled once metadata is available.  Put them
+       ahead of anything the input thread queued in the meantime. */
+    MsgChannel.PutFront(std::move(msg_list));
+  }
+}
+
+void TRouterThread::ReplaySpilledMsgs(uint64_t now) {
+  assert(SpillQueue);
+  std::list<TMsg::TPtr> msg_list;
+
+  try {
+    /* Stop at the high watermark so replay doesn't immediately cause new
+       messages to be spilled again. */
+    while ((msg_list.size() < SPILL_REPLAY_BATCH_SIZE) &&
+        !PoolUsageAtLeast(Conf.SpilloverConf.HighWatermarkPercent)) {
+      TMsg::TPtr msg = SpillQueue->Get(Pool, MsgStateTracker);
+
+      if (!msg) {
+        break;
+      }
+
+      msg_list.push_back(std::move(msg));
+    }
+  } catch (const Capped::TMemoryCapReached &) {
+    /* The message stays in the spill queue.  We will try again later. */
+    SpillReplayPoolFull.Increment();
+  }
+
+  if (!msg_list.empty()) {
+    SpillReplayBatch.Increment();
+    ProcessNewMsgs(std::move(msg_list), now);
+  }
+}
+
+void TRouterThread::ReplayJournalMsgs(uint64_t now) {
+  assert(Journal);
+  std::list<TMsg::TPtr> msg_list;
+
+  try {
+    while ((msg_list.size() < SPILL_REPLAY_BATCH_SIZE) &&
+        !PoolUsageAtLeast(JOURNAL_REPLAY_MAX_POOL_PERCENT)) {
+      TMsg::TPtr msg = Journal->GetRecoveredMsg(Pool, MsgStateTracker);
+
+      if (!msg) {
+        break;
+      }
+
+      msg_list.push_back(std::move(msg));
+    }
+  } catch (const Capped::TMemoryCapReached &) {
+    /* The message stays in the journal.  We will try again later. */
+    JournalReplayPoolFull.Increment();
+  }
+
+  if (!msg_list.empty()) {
+    JournalReplayBatch.Increment();
+    ProcessNewMsgs(std::move(msg_list), now);
+  }
+}
+
+bool TRouterThread::WaitForShutdownRequest(size_t delay) {
+  const TFd &shutdown_request_fd = GetShutdownRequestFd();
+
+  if (!SpillQueue) {
+    return shutdown_request_fd.IsReadable(static_cast<int>(delay));
+  }
+
+  const uint64_t deadline = GetEpochMilliseconds() + delay;
+
+  for (; ; ) {
+    SpillQueuedMsgs();
+    const uint64_t now = GetEpochMilliseconds();
+
+    if (now >= deadline) {
+      return false;
+    }
+
+    const uint64_t wait = std::min<uint64_t>(deadline - now,
+        SPILL_CHECK_INTERVAL);
+
+    if (shutdown_request_fd.IsReadable(static_cast<int>(wait))) {
+      return true;
+    }
+  }
+}
+
 bool TRouterThread::HandlePause() {
   /* Impose a delay before handling a pause that occurs shortly after a
      previous pause.  If something goes seriously wrong, this prevents us from
@@ -1412,7 +1828,6 @@ std::shared_ptr<TMetadata> TRouterThread::GetInitialMetadata() {
       Conf.MsgDeliveryConf.PauseRateLimitInitial,
       Conf.MsgDeliveryConf.PauseRateLimitMaxDouble,
       Conf.MsgDeliveryConf.MinPauseDelay, GetRandomNumber);
-  const TFd &shutdown_request_fd = GetShutdownRequestFd();
 
   for (; ; ) {
     /* TODO: Add shutdown request monitoring inside this call. */
@@ -1427,7 +1842,7 @@ std::shared_ptr<TMetadata> TRouterThread::GetInitialMetadata() {
         << "Initial metadata request failed for all known brokers, waiting "
         << delay << " ms before retry";
 
-    if (shutdown_request_fd.IsReadable(static_cast<int>(delay))) {
+    if (WaitForShutdownRequest(delay)) {
       break;  // got shutdown signal
     }
 
@@ -1445,9 +1860,8 @@ std::shared_ptr<TMetadata> TRouterThread::GetMetadataBeforeSlowShutdown() {
       Conf.MsgDeliveryConf.MinPauseDelay, GetRandomNumber);
 
   /* A slow shutdown is not currently in progress, so we will watch for a
-     shutdown notification while attempting to get metadata. */
-  const TFd &shutdown_request_fd = GetShutdownRequestFd();
-
+     shutdown notification while attempting to get metadata.  Meanwhile,
+     incoming messages are spilled to disk if the buffer pool fills. */
   for (; ; ) {
     /* TODO: Add shutdown request monitoring inside this call. */
     result = TryGetMetadata();
@@ -1460,7 +1874,7 @@ std::shared_ptr<TMetadata> TRouterThread::GetMetadataBeforeSlowShutdown() {
     LOG(TPri::ERR) << "Metadata request failed for all known brokers, waiting "
         << delay << " ms before retry (1)";
 
-    if (shutdown_request_fd.IsReadable(static_cast<int>(delay))) {
+    if (WaitForShutdownRequest(delay)) {
       /* We got a shutdown request while waiting to retry.  We will keep
          trying, but must stop once the deadline has expired. */
       StartShutdown();
@@ -1602,22 +2016,6 @@ void TRouterThread::SetMetadata(std::shared_ptr<TMetadata> &&meta,
         bool record_update) {
   assert(meta);
 
-  /* TODO: make this a lambda */
-  class t_topic_exists_fn final {
-    public:
-    explicit t_topic_exists_fn(const TMetadata &md)
-        : Md(md) {
-    }
-
-    /* Return true if 'topic' exists, or false otherwise. */
-    bool operator()(const std::string &topic) {
-      return (Md.FindTopicIndex(topic) >= 0);
-    }
-
-    private:
-    const TMetadata &Md;
-  };  // t_topic_exists_fn
-
   if (record_update) {
     MetadataTimestamp.RecordUpdate(true);
   }
@@ -1635,8 +2033,7 @@ void TRouterThread::SetMetadata(std::shared_ptr<TMetadata> &&meta,
   Metadata = std::move(meta);
   MetadataUpdated.Increment();
 
-  MsgStateTracker.PruneTopics(
-      TMsgStateTracker::TTopicExistsFn(t_topic_exists_fn(*Metadata)));
+  MsgStateTracker.FoldRetiredThreads();
 
   const std::unordered_map<std::string, size_t> &topic_name_map =
       Metadata->GetTopicNameMap();
@@ -29,6 +29,7 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <unordered_map>
@@ -41,7 +42,9 @@
 #include <base/fd.h>
 #include <base/no_copy_semantics.h>
 #include <base/timer_fd.h>
+#include <capped/pool.h>
 #include <dory/anomaly_tracker.h>
+#include <dory/api_version_stats.h>
 #include <dory/batch/batch_config_builder.h>
 #include <dory/batch/global_batch_config.h>
 #include <dory/batch/per_topic_batcher.h>
@@ -50,6 +53,8 @@
 #include <dory/conf/topic_rate_conf.h>
 #include <dory/debug/debug_logger.h>
 #include <dory/debug/debug_setup.h>
+#include <dory/journal/journal.h>
+#include <dory/linger_stats.h>
 #include <dory/metadata_timestamp.h>
 #include <dory/metadata.h>
 #include <dory/metadata_fetcher.h>
@@ -57,6 +62,8 @@
 #include <dory/msg_dispatch/kafka_dispatcher_api.h>
 #include <dory/msg_rate_limiter.h>
 #include <dory/msg_state_tracker.h>
+#include <dory/profiler.h>
+#include <dory/spill/spill_queue.h>
 #include <dory/util/dory_rate_limiter.h>
 #include <dory/util/host_and_port.h>
 #include <dory/util/poll_array.h>
@@ -70,12 +77,15 @@ namespace Dory {
 
     public:
     TRouterThread(const TCmdLineArgs &args, const Conf::TConf &conf,
-        TAnomalyTracker &anomaly_tracker, TMsgStateTracker &msg_state_tracker,
+        Capped::TPool &pool, TAnomalyTracker &anomaly_tracker,
+        TMsgStateTracker &msg_state_tracker,
         const Debug::TDebugSetup &debug_setup,
-        MsgDispatch::TKafkaDispatcherApi &dispatcher)
-        : TRouterThread(args, conf, anomaly_tracker, msg_state_tracker,
+        TApiVersionStats &api_version_stats, TLingerStats &linger_stats,
+        TProfiler &profiler, MsgDispatch::TKafkaDispatcherApi &dispatcher)
+        : TRouterThread(args, conf, pool, anomaly_tracker, msg_state_tracker,
               Batch::TBatchConfigBuilder().BuildFromConf(conf.BatchConf),
-              debug_setup, dispatcher) {
+              debug_setup, api_version_stats, linger_stats, profiler,
+              dispatcher) {
     }
 
     ~TRouterThread() override;
@@ -108,6 +118,14 @@ namespace Dory {
       return MetadataTimestamp;
     }
 
+    /* If 'journal' is not null, messages are appended to it before being
+       routed, and messages it recovered from a previous run are replayed.
+       Must be called before Start(). */
+    void SetJournal(Journal::TJournal *journal) noexcept {
+      assert(!IsStarted());
+      Journal = journal;
+    }
+
     /* Used by main thread during shutdown. */
     std::list<TMsg::TPtr> GetRemainingMsgs() {
       return MsgChannel.NonblockingGet();
@@ -130,10 +148,12 @@ namespace Dory {
 
     /* Public constructor delegates to this one. */
     TRouterThread(const TCmdLineArgs &args, const Conf::TConf &conf,
-        TAnomalyTracker &anomaly_tracker, TMsgStateTracker &msg_state_tracker,
+        Capped::TPool &pool, TAnomalyTracker &anomaly_tracker,
+        TMsgStateTracker &msg_state_tracker,
         const Batch::TGlobalBatchConfig &batch_config,
         const Debug::TDebugSetup &debug_setup,
-        MsgDispatch::TKafkaDispatcherApi &dispatcher);
+        TApiVersionStats &api_version_stats, TLingerStats &linger_stats,
+        TProfiler &profiler, MsgDispatch::TKafkaDispatcherApi &dispatcher);
 
     static size_t ComputeRetryDelay(size_t mean_delay, size_t div);
 
@@ -247,6 +267,22 @@ namespace Dory {
 
     bool HandleMetadataUpdate();
 
+    /* Take messages parked by the dispatcher after partition-level error ACKs,
+       and start the retry timer if it isn't already running. */
+    void HandlePartitionRetryAvailable();
+
+    /* Return true if the partition leaders for all topics in 'topics' are
+       the same in 'probe' as in our current metadata, or false if any of
+       them changed. */
+    bool PartitionLeadersUnchanged(const TMetadata &probe,
+        const std::set<std::string> &topics) const;
+
+    /* Reroute messages parked after partition-level error ACKs, updating
+       metadata first if the partition leaders changed.  Return true on
+       success, or false if we got a shutdown signal and the shutdown delay
+       expired while getting metadata. */
+    bool HandlePartitionRetry();
+
     void ContinueShutdown();
 
     int ComputeMainLoopPollTimeout();
@@ -261,6 +297,48 @@ namespace Dory {
 
     void HandleMsgAvailable(uint64_t now);
 
+    /* Validate, batch, and route 'msg_list', which contains messages either
+       just received from the input thread or replayed from the spill queue or
+       journal.  Messages not yet journaled are appended to the journal if
+       there is one. */
+    void ProcessNewMsgs(std::list<TMsg::TPtr> &&msg_list, uint64_t now);
+
+    /* Return true if at least 'percent' percent of the buffer pool is in
+       use. */
+    bool PoolUsageAtLeast(size_t percent) const noexcept {
+      return ((Pool.GetAllocatedBlockCount() * 100) >=
+          (Pool.GetBlockCount() * percent));
+    }
+
+    /* Return true if newly received messages should go to the spill queue
+       rather than being routed.  Once anything has been spilled, new messages
+       are spilled until the queue drains, so that ordering is preserved. */
+    bool ShouldSpill() const noexcept {
+      return SpillQueue && (!SpillQueue->IsEmpty() ||
+          PoolUsageAtLeast(Conf.SpilloverConf.HighWatermarkPercent));
+    }
+
+    /* Move messages from the front of 'msg_list' to the spill queue.  If a
+       message can't be spilled while older messages are in the spill queue,
+       discard it so it doesn't get ahead of them.  If the spill queue is
+       empty, stop at the message and leave it and the rest in 'msg_list'. */
+    void SpillMsgs(std::list<TMsg::TPtr> &msg_list);
+
+    /* Called while waiting for metadata.  If spilling is appropriate, spill
+       messages queued by the input thread, so they don't fill the buffer pool
+       while Kafka is unavailable. */
+    void SpillQueuedMsgs();
+
+    /* Replay a limited number of messages from the spill queue. */
+    void ReplaySpilledMsgs(uint64_t now);
+
+    /* Replay a limited number of messages recovered by the journal. */
+    void ReplayJournalMsgs(uint64_t now);
+
+    /* Wait up to 'delay' milliseconds for a shutdown request, returning true
+       if one arrived.  Spill messages while waiting, if necessary. */
+    bool WaitForShutdownRequest(size_t delay);
+
     bool HandlePause();
 
     void UpdateKnownBrokers(const TMetadata &md);
@@ -304,10 +382,18 @@ namespace Dory {
     /* Header overhead for a single message.  For checking message size. */
     size_t SingleMsgOverhead = 0;
 
+    /* Header overhead for a message set.  For checking message size. */
+    size_t MsgSetOverhead = 0;
+
     /* Maximum total message size (key + value + header space (see
-       'SingleMsgOverhead' above)) allowed by Kafka brokers. */
+       'SingleMsgOverhead' and 'MsgSetOverhead' above)) allowed by Kafka
+       brokers. */
     const size_t MessageMaxBytes;
 
+    /* Buffer pool for message contents.  Its usage determines when messages
+       are spilled to disk and replayed. */
+    Capped::TPool &Pool;
+
     /* For tracking discarded messages and possible duplicates. */
     TAnomalyTracker &AnomalyTracker;
 
@@ -315,6 +401,12 @@ namespace Dory {
 
     const Debug::TDebugSetup &DebugSetup;
 
+    /* Passed to 'MetadataFetcher', which records the metadata API version
+       used for each broker here. */
+    TApiVersionStats &ApiVersionStats;
+
+    TProfiler &Profiler;
+
     /* This becomes readable when the router thread has finished its
        initialization and is open for business. */
     Base::TEventSemaphore InitFinishedSem;
@@ -363,6 +455,15 @@ namespace Dory {
        indicates the earliest expiration time of any topic batch. */
     std::optional<TMsg::TTimestamp> OptNextBatchExpiry;
 
+    /* Messages parked by the dispatcher after partition-level error ACKs,
+       waiting to be rerouted once the partition retry delay expires. */
+    std::list<std::list<TMsg::TPtr>> PartitionRetryMsgs;
+
+    /* This becomes known when 'PartitionRetryMsgs' becomes nonempty.  It
+       indicates when the parked messages should be rerouted.  The units are
+       milliseconds since the epoch. */
+    std::optional<uint64_t> OptPartitionRetryTime;
+
     /* The dispatcher handles the details of sending messages and receiving
        ACKs.  Once we decide which broker a message goes to, the dispatcher
        handles the rest. */
@@ -374,10 +475,11 @@ namespace Dory {
       MsgAvailable = 2,
       MdUpdateRequest = 3,
       MdRefresh = 4,
-      ShutdownFinished = 5
+      ShutdownFinished = 5,
+      PartitionRetry = 6
     };  // TMainLoopPollItem
 
-    Util::TPollArray<TMainLoopPollItem, 6> MainLoopPollArray;
+    Util::TPollArray<TMainLoopPollItem, 7> MainLoopPollArray;
 
     /* This becomes known when a slow shutdown starts.  The units are
        milliseconds since the epoch. */
@@ -397,6 +499,14 @@ namespace Dory {
     /* Push to tell daemon to update its metadata. */
     Base::TEventSemaphore MetadataUpdateRequestSem;
 
+    /* Holds messages on disk when the buffer pool is nearly full.  Null if
+       spillover is disabled. */
+    std::unique_ptr<Spill::TSpillQueue> SpillQueue;
+
+    /* Write-ahead journal owned by the main thread.  Null if journaling is
+       disabled. */
+    Journal::TJournal *Journal = nullptr;
+
     Debug::TDebugLogger DebugLogger;
   };  // TRouterThread
 
@@ -0,0 +1,250 @@
+/* <dory/spill/spill_queue.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/spill/spill_queue.h>.
+ */
+
+#include <dory/spill/spill_queue.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <base/counter.h>
+#include <base/dir_iter.h>
+#include <base/wr/file_util.h>
+#include <log/log.h>
+
+using namespace Base;
+using namespace Capped;
+using namespace Dory;
+using namespace Dory::Spill;
+using namespace Dory::Util;
+using namespace Log;
+
+DEFINE_COUNTER(SpillBytesReplay);
+DEFINE_COUNTER(SpillBytesWrite);
+DEFINE_COUNTER(SpillError);
+DEFINE_COUNTER(SpillFull);
+DEFINE_COUNTER(SpillMsgReplay);
+DEFINE_COUNTER(SpillMsgTooLarge);
+DEFINE_COUNTER(SpillMsgWrite);
+DEFINE_COUNTER(SpillRecoveryBadSegment);
+DEFINE_COUNTER(SpillRecoveryTruncated);
+DEFINE_COUNTER(SpillSegmentCreate);
+DEFINE_COUNTER(SpillSegmentDelete);
+
+static const char SEGMENT_PREFIX[] = "spill.";
+
+TSpillQueue::TSpillQueue(const std::string &dir, size_t segment_size,
+    size_t max_disk_bytes)
+    : Dir(dir),
+      SegmentSize(segment_size),
+      MaxDiskBytes(max_disk_bytes) {
+  assert(SegmentSize > TSpillSegment::HEADER_SIZE);
+  Recover();
+}
+
+bool TSpillQueue::Put(const TMsg &msg) {
+  if (!MsgRecordCanHold(msg) ||
+      (TSpillSegment::ComputeRecordSize(msg) >
+          (SegmentSize - TSpillSegment::HEADER_SIZE))) {
+    SpillMsgTooLarge.Increment();
+    return false;
+  }
+
+  if (Segments.empty() || !Segments.back()->Append(msg)) {
+    if (!Segments.empty() && Segments.back()->IsEmpty()) {
+      /* The last segment was filled exactly to capacity and then fully
+         consumed, so the failed Append() above just sealed it.  Nothing will
+         ever be read from it again, so delete it now.  Since it was
+         consumed, it is also the first segment. */
+      assert(Segments.size() == 1);
+      DeleteFrontSegment();
+    }
+
+    if (!AddSegment()) {
+      return false;
+    }
+
+    if (!Segments.back()->Append(msg)) {
+      assert(false);
+      SpillError.Increment();
+      return false;
+    }
+  }
+
+  ++MsgCount;
+  SpillMsgWrite.Increment();
+  SpillBytesWrite.Increment(msg.GetKeySize() + msg.GetValueSize());
+  return true;
+}
+
+TMsg::TPtr TSpillQueue::Get(TPool &pool,
+    TMsgStateTracker &msg_state_tracker) {
+  if (IsEmpty()) {
+    return TMsg::TPtr();
+  }
+
+  /* Empty sealed segments are deleted as soon as they are consumed or
+     sealed, so the first segment is nonempty. */
+  assert(!Segments.empty());
+  TSpillSegment &seg = *Segments.front();
+  assert(!seg.IsEmpty());
+  TSpillSegment::TRecord rec;
+  seg.Peek(rec);
+  TMsg::TPtr msg = CreateMsgFromRecord(rec, pool, msg_state_tracker);
+  seg.Pop();
+  --MsgCount;
+  SpillMsgReplay.Increment();
+  SpillBytesReplay.Increment(rec.KeySize + rec.ValueSize);
+
+  if (seg.IsEmpty() && seg.IsSealed()) {
+    DeleteFrontSegment();
+  }
+
+  return msg;
+}
+
+void TSpillQueue::Recover() {
+  std::vector<std::string> names;
+  const size_t prefix_len = std::strlen(SEGMENT_PREFIX);
+
+  for (TDirIter iter(Dir.c_str()); iter; ++iter) {
+    if (iter.GetKind() != TDirIter::File) {
+      continue;
+    }
+
+    const char *name = iter.GetName();
+
+    if (std::strncmp(name, SEGMENT_PREFIX, prefix_len) ||
+        !std::isdigit(name[prefix_len])) {
+      continue;
+    }
+
+    names.push_back(name);
+  }
+
+  for (const std::string &name : names) {
+    std::string path = Dir + "/" + name;
+    std::unique_ptr<TSpillSegment> seg;
+    bool truncated = false;
+
+    try {
+      seg = TSpillSegment::Open(path, truncated);
+    } catch (const TSpillSegment::TBadSegment &x) {
+      SpillRecoveryBadSegment.Increment();
+      LOG(TPri::ERR) << x.what() << ": deleting";
+      Wr::unlink(path.c_str());
+      continue;
+    } catch (const std::system_error &x) {
+      SpillRecoveryBadSegment.Increment();
+      LOG(TPri::ERR) << "Failed to open spill segment file [" << path
+          << "]: " << x.what();
+      continue;
+    }
+
+    if (truncated) {
+      SpillRecoveryTruncated.Increment();
+      LOG(TPri::WARNING) << "Discarded bad data at end of spill segment file ["
+          << path << "]";
+    }
+
+    NextSequenceNumber = std::max(NextSequenceNumber,
+        seg->GetSequenceNumber() + 1);
+
+    if (seg->IsEmpty()) {
+      seg.reset();
+      Wr::unlink(path.c_str());
+      continue;
+    }
+
+    MsgCount += seg->GetMsgCount();
+    DiskBytes += seg->GetFileSize();
+    Segments.push_back(std::move(seg));
+  }
+
+  std::sort(Segments.begin(), Segments.end(),
+      [](const std::unique_ptr<TSpillSegment> &x,
+          const std::unique_ptr<TSpillSegment> &y) {
+        return x->GetSequenceNumber() < y->GetSequenceNumber();
+      });
+
+  if (MsgCount) {
+    LOG(TPri::NOTICE) << "Recovered " << MsgCount << " messages in "
+        << Segments.size() << " spill segment files from [" << Dir << "]";
+  }
+}
+
+bool TSpillQueue::AddSegment() {
+  if ((DiskBytes + SegmentSize) > MaxDiskBytes) {
+    SpillFull.Increment();
+    return false;
+  }
+
+  if (!Segments.empty()) {
+    /* The current last segment is full.  Push its contents to disk now,
+       rather than leaving it to the kernel, so a power failure loses as
+       little as possible. */
+    try {
+      Segments.back()->Sync();
+    } catch (const std::system_error &x) {
+      LOG_R(TPri::ERR, std::chrono::seconds(30))
+          << "Failed to sync spill segment file ["
+          << Segments.back()->GetPath() << "]: " << x.what();
+    }
+  }
+
+  const uint64_t seq = NextSequenceNumber;
+  std::string path = Dir + "/" + SEGMENT_PREFIX + std::to_string(seq);
+
+  try {
+    Segments.push_back(TSpillSegment::Create(path, seq, SegmentSize));
+  } catch (const std::system_error &x) {
+    SpillError.Increment();
+    LOG_R(TPri::ERR, std::chrono::seconds(30))
+        << "Failed to create spill segment file [" << path << "]: "
+        << x.what();
+    return false;
+  }
+
+  ++NextSequenceNumber;
+  DiskBytes += SegmentSize;
+  SpillSegmentCreate.Increment();
+  return true;
+}
+
+void TSpillQueue::DeleteFrontSegment() {
+  assert(!Segments.empty());
+  std::string path = Segments.front()->GetPath();
+  DiskBytes -= Segments.front()->GetFileSize();
+  Segments.pop_front();
+
+  if (Wr::unlink(path.c_str()) < 0) {
+    LOG_ERRNO(TPri::ERR, errno) << "Failed to delete spill segment file ["
+        << path << "]: ";
+  }
+
+  SpillSegmentDelete.Increment();
+}
@@ -0,0 +1,113 @@
+/* <dory/spill/spill_queue.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Disk spillover queue for messages that can't be held in memory while Kafka
+   is unavailable.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include <base/no_copy_semantics.h>
+#include <capped/pool.h>
+#include <dory/msg.h>
+#include <dory/msg_state_tracker.h>
+#include <dory/spill/spill_segment.h>
+
+namespace Dory {
+
+  namespace Spill {
+
+    /* A FIFO queue of messages stored in a sequence of TSpillSegment files
+       within a single directory.  Segment files are named "spill.N", where N
+       is the segment's sequence number.  Contents survive a restart: the
+       constructor recovers any segments left behind by a previous run, so
+       messages spilled before a shutdown or crash are replayed afterwards.
+       Not thread-safe: the router thread is the only user. */
+    class TSpillQueue final {
+      NO_COPY_SEMANTICS(TSpillQueue);
+
+      public:
+      /* Use directory 'dir', which must exist, to store segments of
+         'segment_size' bytes each, without exceeding a total of
+         'max_disk_bytes'. */
+      TSpillQueue(const std::string &dir, size_t segment_size,
+          size_t max_disk_bytes);
+
+      bool IsEmpty() const noexcept {
+        return (MsgCount == 0);
+      }
+
+      size_t GetMsgCount() const noexcept {
+        return MsgCount;
+      }
+
+      /* Return the total size of all segment files. */
+      size_t GetDiskBytes() const noexcept {
+        return DiskBytes;
+      }
+
+      /* Write a copy of 'msg' to disk.  Return true on success, or false if
+         the message couldn't be stored because the disk cap was reached, the
+         message is too large, or an I/O error occurred.  On success, the
+         caller is responsible for discarding 'msg'. */
+      bool Put(const TMsg &msg);
+
+      /* Remove the oldest message from the queue, and return it as a newly
+         created message allocated from 'pool'.  Return nullptr if the queue
+         is empty.  Throws Capped::TMemoryCapReached, leaving the message in
+         the queue, if 'pool' doesn't have enough space. */
+      TMsg::TPtr Get(Capped::TPool &pool,
+          TMsgStateTracker &msg_state_tracker);
+
+      private:
+      /* Recover segments left behind by a previous run. */
+      void Recover();
+
+      /* Return true if a new segment was successfully added. */
+      bool AddSegment();
+
+      /* Unlink the file for the first segment and remove it from the
+         queue. */
+      void DeleteFrontSegment();
+
+      const std::string Dir;
+
+      const size_t SegmentSize;
+
+      const size_t MaxDiskBytes;
+
+      /* Segments ordered by sequence number.  Only the last one may be
+         appended to, and messages are consumed from the first one. */
+      std::deque<std::unique_ptr<TSpillSegment>> Segments;
+
+      uint64_t NextSequenceNumber = 0;
+
+      size_t MsgCount = 0;
+
+      size_t DiskBytes = 0;
+    };  // TSpillQueue
+
+  }  // Spill
+
+}  // Dory
@@ -0,0 +1,298 @@
+/* <dory/spill/spill_queue.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2013-2014 if(we)
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+
+   Unit tests for <dory/spill/spill_queue.h> and
+   <dory/spill/spill_segment.h>.
+ */
+
+#include <dory/spill/spill_queue.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <base/fd.h>
+#include <base/tmp_dir.h>
+#include <base/tmp_file.h>
+#include <base/wr/fd_util.h>
+#include <base/wr/file_util.h>
+#include <capped/pool.h>
+#include <dory/msg.h>
+#include <dory/msg_creator.h>
+#include <dory/spill/spill_segment.h>
+#include <dory/test_util/misc_util.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Capped;
+using namespace Dory;
+using namespace Dory::Spill;
+using namespace Dory::TestUtil;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TSpillQueue. */
+  class TSpillQueueTest : public ::testing::Test {
+    protected:
+    TSpillQueueTest() = default;
+
+    ~TSpillQueueTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TSpillQueueTest
+
+  std::string MakeValue(size_t n) {
+    return std::string("value ") + std::to_string(n);
+  }
+
+  TEST_F(TSpillQueueTest, PutAndGet) {
+    TTmpDir dir("/tmp/spill_queue_test.XXXXXX", true);
+    TTestMsgCreator mc;
+    TSpillQueue queue(dir.GetName(), 4096, 3 * 4096);
+    ASSERT_TRUE(queue.IsEmpty());
+    ASSERT_FALSE(queue.Get(*mc.Pool, mc.MsgStateTracker));
+    size_t put_count = 0;
+
+    /* Fill until the disk cap is reached. */
+    for (; ; ++put_count) {
+      TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(put_count),
+          static_cast<TMsg::TTimestamp>(put_count), true);
+
+      if (!queue.Put(*msg)) {
+        break;
+      }
+    }
+
+    ASSERT_GT(put_count, 100U);
+    ASSERT_EQ(queue.GetMsgCount(), put_count);
+    ASSERT_EQ(queue.GetDiskBytes(), 3U * 4096U);
+
+    for (size_t i = 0; i < put_count; ++i) {
+      TMsg::TPtr msg = queue.Get(*mc.Pool, mc.MsgStateTracker);
+      ASSERT_TRUE(!!msg);
+      SetProcessed(msg);
+      ASSERT_EQ(msg->GetTopic(), "topic");
+      ASSERT_TRUE(ValueEquals(msg, MakeValue(i)));
+      ASSERT_EQ(msg->GetTimestamp(), static_cast<TMsg::TTimestamp>(i));
+    }
+
+    /* Segments are deleted once consumed. */
+    ASSERT_TRUE(queue.IsEmpty());
+    ASSERT_EQ(queue.GetDiskBytes(), 0U);
+
+    /* PartitionKey message with a key. */
+    std::string topic("other topic");
+    std::string key("key"), value("value");
+    TMsg::TPtr msg = TMsgCreator::CreatePartitionKeyMsg(12345, 6789,
+        topic.data(), topic.data() + topic.size(), key.data(), key.size(),
+        value.data(), value.size(), true, *mc.Pool, mc.MsgStateTracker);
+    SetProcessed(msg);
+    ASSERT_TRUE(queue.Put(*msg));
+    msg = queue.Get(*mc.Pool, mc.MsgStateTracker);
+    ASSERT_TRUE(!!msg);
+    SetProcessed(msg);
+    ASSERT_TRUE(msg->GetRoutingType() == TMsg::TRoutingType::PartitionKey);
+    ASSERT_EQ(msg->GetPartitionKey(), 12345);
+    ASSERT_EQ(msg->GetTimestamp(), 6789);
+    ASSERT_EQ(msg->GetTopic(), topic);
+    ASSERT_TRUE(KeyEquals(msg, key));
+    ASSERT_TRUE(ValueEquals(msg, value));
+    ASSERT_TRUE(msg->BodyIsTruncated());
+
+    /* A message that can never fit in a segment is rejected. */
+    msg = mc.NewMsg("topic", std::string(4096, 'x'), 0, true);
+    ASSERT_FALSE(queue.Put(*msg));
+  }
+
+  TEST_F(TSpillQueueTest, ExactlyFullSegment) {
+    TTmpDir dir("/tmp/spill_queue_test.XXXXXX", true);
+    TTestMsgCreator mc;
+    TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(0), 0, true);
+    SetProcessed(msg);
+
+    /* Room for exactly 2 messages per segment. */
+    const size_t segment_size = TSpillSegment::HEADER_SIZE +
+        (2 * TSpillSegment::ComputeRecordSize(*msg));
+    TSpillQueue queue(dir.GetName(), segment_size, segment_size);
+
+    /* Fill the segment to capacity, then drain it.  The segment isn't sealed
+       yet, since no append has failed. */
+    for (size_t i = 0; i < 2; ++i) {
+      msg = mc.NewMsg("topic", MakeValue(i), 0, true);
+      SetProcessed(msg);
+      ASSERT_TRUE(queue.Put(*msg));
+    }
+
+    for (size_t i = 0; i < 2; ++i) {
+      msg = queue.Get(*mc.Pool, mc.MsgStateTracker);
+      ASSERT_TRUE(!!msg);
+      SetProcessed(msg);
+      ASSERT_TRUE(ValueEquals(msg, MakeValue(i)));
+    }
+
+    ASSERT_TRUE(queue.IsEmpty());
+
+    /* This put seals the empty segment.  The empty segment must be deleted,
+       both so the disk cap leaves room for a new segment and so the next
+       Get() finds the message. */
+    msg = mc.NewMsg("topic", MakeValue(2), 0, true);
+    SetProcessed(msg);
+    ASSERT_TRUE(queue.Put(*msg));
+    ASSERT_EQ(queue.GetMsgCount(), 1U);
+    ASSERT_EQ(queue.GetDiskBytes(), segment_size);
+    msg = queue.Get(*mc.Pool, mc.MsgStateTracker);
+    ASSERT_TRUE(!!msg);
+    SetProcessed(msg);
+    ASSERT_TRUE(ValueEquals(msg, MakeValue(2)));
+    ASSERT_TRUE(queue.IsEmpty());
+    ASSERT_FALSE(queue.Get(*mc.Pool, mc.MsgStateTracker));
+  }
+
+  TEST_F(TSpillQueueTest, Recovery) {
+    TTmpDir dir("/tmp/spill_queue_test.XXXXXX", true);
+    TTestMsgCreator mc;
+    const size_t count = 200;
+    size_t consumed = 0;
+
+    {
+      TSpillQueue queue(dir.GetName(), 4096, 1024 * 1024);
+
+      for (size_t i = 0; i < count; ++i) {
+        TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(i), 0, true);
+        ASSERT_TRUE(queue.Put(*msg));
+      }
+
+      for (; consumed < 10; ++consumed) {
+        SetProcessed(queue.Get(*mc.Pool, mc.MsgStateTracker));
+      }
+    }
+
+    {
+      /* Messages consumed before the restart are not replayed. */
+      TSpillQueue queue(dir.GetName(), 4096, 1024 * 1024);
+      ASSERT_EQ(queue.GetMsgCount(), count - consumed);
+
+      for (; consumed < 20; ++consumed) {
+        TMsg::TPtr msg = queue.Get(*mc.Pool, mc.MsgStateTracker);
+        SetProcessed(msg);
+        ASSERT_TRUE(ValueEquals(msg, MakeValue(consumed)));
+      }
+
+      /* New messages go after the recovered ones. */
+      TMsg::TPtr msg = mc.NewMsg("topic", MakeValue(count), 0, true);
+      ASSERT_TRUE(queue.Put(*msg));
+    }
+
+    /* Corrupt the last record of the newest segment by flipping a byte near
+       the end of its data, and add a file with a bad header. */
+    std::string newest;
+    uint64_t newest_seq = 0;
+
+    for (uint64_t seq = 0; seq < 100; ++seq) {
+      std::string path = dir.GetName() + "/spill." + std::to_string(seq);
+
+      if (access(path.c_str(), F_OK) == 0) {
+        newest = path;
+        newest_seq = seq;
+      }
+    }
+
+    ASSERT_FALSE(newest.empty());
+
+    {
+      bool truncated = false;
+      std::unique_ptr<TSpillSegment> seg =
+          TSpillSegment::Open(newest, truncated);
+      ASSERT_FALSE(truncated);
+      ASSERT_EQ(seg->GetMsgCount(), 1U);
+    }
+
+    {
+      TFd fd(Wr::open(newest.c_str(), O_RDWR));
+      uint8_t byte = 0;
+      off_t pos = TSpillSegment::HEADER_SIZE + 10;
+      ASSERT_EQ(pread(fd, &byte, 1, pos), 1);
+      byte ^= 0xff;
+      ASSERT_EQ(pwrite(fd, &byte, 1, pos), 1);
+      std::string bad_path = dir.GetName() + "/spill." +
+          std::to_string(newest_seq + 1);
+      TFd bad_fd(Wr::open(bad_path.c_str(), O_RDWR | O_CREAT, 0600));
+      std::vector<uint8_t> junk(4096, 0x5a);
+      ASSERT_EQ(write(bad_fd, &junk[0], junk.size()),
+          static_cast<ssize_t>(junk.size()));
+    }
+
+    /* The corrupted message is lost, and the bad file is ignored. */
+    TSpillQueue queue(dir.GetName(), 4096, 1024 * 1024);
+    ASSERT_EQ(queue.GetMsgCount(), count - consumed);
+
+    for (; consumed < count; ++consumed) {
+      TMsg::TPtr msg = queue.Get(*mc.Pool, mc.MsgStateTracker);
+      ASSERT_TRUE(!!msg);
+      SetProcessed(msg);
+      ASSERT_TRUE(ValueEquals(msg, MakeValue(consumed)));
+    }
+
+    ASSERT_TRUE(queue.IsEmpty());
+  }
+
+  TEST_F(TSpillQueueTest, PoolFull) {
+    TTmpDir dir("/tmp/spill_queue_test.XXXXXX", true);
+    TTestMsgCreator mc;
+    TSpillQueue queue(dir.GetName(), 4096, 16 * 4096);
+    TMsg::TPtr msg = mc.NewMsg("topic", std::string(256, 'x'), 0, true);
+    ASSERT_TRUE(queue.Put(*msg));
+    msg.reset();
+    TPool small_pool(64, 2, TPool::TSync::Unguarded);
+    bool threw = false;
+
+    try {
+      queue.Get(small_pool, mc.MsgStateTracker);
+    } catch (const TMemoryCapReached &) {
+      threw = true;
+    }
+
+    /* The message stays queued until memory is available. */
+    ASSERT_TRUE(threw);
+    ASSERT_EQ(queue.GetMsgCount(), 1U);
+    ASSERT_EQ(small_pool.GetAllocatedBlockCount(), 0U);
+    msg = queue.Get(*mc.Pool, mc.MsgStateTracker);
+    ASSERT_TRUE(!!msg);
+    SetProcessed(msg);
+    ASSERT_TRUE(ValueEquals(msg, std::string(256, 'x')));
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,246 @@
+/* <dory/spill/spill_segment.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/spill/spill_segment.h>.
+ */
+
+#include <dory/spill/spill_segment.h>
+
+#include <cassert>
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <base/crc.h>
+#include <base/error_util.h>
+#include <base/field_access.h>
+#include <base/wr/file_util.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Spill;
+using namespace Dory::Util;
+
+static const uint32_t SEGMENT_MAGIC = 0x646f7279;  // "dory"
+
+static const uint32_t SEGMENT_VERSION = 1;
+
+static const size_t MAGIC_OFFSET = 0;
+
+static const size_t VERSION_OFFSET = 4;
+
+static const size_t SEQ_OFFSET = 8;
+
+static const size_t HEADER_CRC_OFFSET = 16;
+
+static const size_t READ_OFFSET_OFFSET = 24;
+
+/* Size of payload size and CRC fields preceding each record's payload. */
+static const size_t RECORD_HEADER_SIZE = 8;
+
+size_t TSpillSegment::ComputeRecordSize(const TMsg &msg) noexcept {
+  return RECORD_HEADER_SIZE + ComputeMsgRecordSize(msg);
+}
+
+static uint8_t *MapFile(int fd, size_t file_size) {
+  void *addr = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+      fd, 0);
+
+  if (addr == MAP_FAILED) {
+    ThrowSystemError(errno);
+  }
+
+  return reinterpret_cast<uint8_t *>(addr);
+}
+
+std::unique_ptr<TSpillSegment> TSpillSegment::Create(const std::string &path,
+    uint64_t seq, size_t file_size) {
+  assert(file_size > HEADER_SIZE);
+  TFd fd(Wr::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC,
+      S_IRUSR | S_IWUSR));
+
+  try {
+    /* Reserve the space up front.  With a sparse file, running out of disk
+       space while writing through the mapping would cause SIGBUS. */
+    IfNe0(posix_fallocate(fd, 0, static_cast<off_t>(file_size)));
+    uint8_t *map = MapFile(fd, file_size);
+    std::unique_ptr<TSpillSegment> result(
+        new TSpillSegment(path, std::move(fd), map, file_size, seq));
+    WriteUint32ToHeader(map + MAGIC_OFFSET, SEGMENT_MAGIC);
+    WriteUint32ToHeader(map + VERSION_OFFSET, SEGMENT_VERSION);
+    WriteUint64ToHeader(map + SEQ_OFFSET, seq);
+    WriteUint32ToHeader(map + HEADER_CRC_OFFSET,
+        ComputeCrc32(map, HEADER_CRC_OFFSET));
+    WriteUint64ToHeader(map + READ_OFFSET_OFFSET, HEADER_SIZE);
+    return result;
+  } catch (...) {
+    fd.Reset();
+    Wr::unlink(path.c_str());
+    throw;
+  }
+}
+
+std::unique_ptr<TSpillSegment> TSpillSegment::Open(const std::string &path,
+    bool &truncated) {
+  truncated = false;
+  TFd fd(Wr::open(path.c_str(), O_RDWR | O_CLOEXEC));
+  struct stat st;
+  IfLt0(Wr::fstat(fd, &st));
+
+  if (st.st_size <= static_cast<off_t>(HEADER_SIZE)) {
+    throw TBadSegment(path);
+  }
+
+  const auto file_size = static_cast<size_t>(st.st_size);
+  uint8_t *map = MapFile(fd, file_size);
+  std::unique_ptr<TSpillSegment> result(new TSpillSegment(path, std::move(fd),
+      map, file_size, ReadUint64FromHeader(map + SEQ_OFFSET)));
+
+  if ((ReadUint32FromHeader(map + MAGIC_OFFSET) != SEGMENT_MAGIC) ||
+      (ReadUint32FromHeader(map + VERSION_OFFSET) != SEGMENT_VERSION) ||
+      (ReadUint32FromHeader(map + HEADER_CRC_OFFSET) !=
+          ComputeCrc32(map, HEADER_CRC_OFFSET))) {
+    throw TBadSegment(path);
+  }
+
+  uint64_t read_offset = ReadUint64FromHeader(map + READ_OFFSET_OFFSET);
+
+  if ((read_offset < HEADER_SIZE) || (read_offset > file_size)) {
+    throw TBadSegment(path);
+  }
+
+  result->ReadOffset = static_cast<size_t>(read_offset);
+  result->WriteOffset = result->ReadOffset;
+
+  for (; ; ) {
+    size_t record_size = result->CheckRecord(result->WriteOffset);
+
+    if (record_size == 0) {
+      break;
+    }
+
+    result->WriteOffset += record_size;
+    ++result->MsgCount;
+  }
+
+  /* Anything other than zero fill past the last good record indicates a
+     partially written or corrupted record. */
+  if (((file_size - result->WriteOffset) >= RECORD_HEADER_SIZE) &&
+      (ReadUint32FromHeader(map + result->WriteOffset) != 0)) {
+    truncated = true;
+  }
+
+  /* Don't append to a recovered segment.  New messages go to a new segment,
+     which leaves any damaged region of this one untouched. */
+  result->Sealed = true;
+  return result;
+}
+
+TSpillSegment::~TSpillSegment() {
+  munmap(Map, FileSize);
+}
+
+bool TSpillSegment::Append(const TMsg &msg) {
+  assert(MsgRecordCanHold(msg));
+
+  if (Sealed) {
+    return false;
+  }
+
+  const size_t record_size = ComputeRecordSize(msg);
+
+  if (record_size > (FileSize - WriteOffset)) {
+    Sealed = true;
+    return false;
+  }
+
+  uint8_t * const rec = Map + WriteOffset;
+  uint8_t * const payload = rec + RECORD_HEADER_SIZE;
+  WriteMsgRecord(payload, msg);
+  const size_t payload_size = record_size - RECORD_HEADER_SIZE;
+  WriteUint32ToHeader(rec + 4, ComputeCrc32c(payload, payload_size));
+
+  /* Write the size last, so a reader never sees a nonzero size before the
+     rest of the record is present. */
+  WriteUint32ToHeader(rec, static_cast<uint32_t>(payload_size));
+  WriteOffset += record_size;
+  ++MsgCount;
+  return true;
+}
+
+void TSpillSegment::Peek(TRecord &record) const noexcept {
+  assert(!IsEmpty());
+  const uint8_t *rec = Map + ReadOffset;
+
+  /* Open() and Append() have already validated the record. */
+  if (!ReadMsgRecord(rec + RECORD_HEADER_SIZE, ReadUint32FromHeader(rec),
+      record)) {
+    assert(false);
+  }
+}
+
+void TSpillSegment::Pop() noexcept {
+  assert(!IsEmpty());
+  ReadOffset += RECORD_HEADER_SIZE + ReadUint32FromHeader(Map + ReadOffset);
+  assert(ReadOffset <= WriteOffset);
+  --MsgCount;
+  WriteUint64ToHeader(Map + READ_OFFSET_OFFSET, ReadOffset);
+}
+
+void TSpillSegment::Sync() {
+  IfLt0(msync(Map, FileSize, MS_SYNC));
+}
+
+TSpillSegment::TSpillSegment(const std::string &path, TFd &&fd, uint8_t *map,
+    size_t file_size, uint64_t seq)
+    : Path(path),
+      Fd(std::move(fd)),
+      Map(map),
+      FileSize(file_size),
+      SequenceNumber(seq) {
+}
+
+size_t TSpillSegment::CheckRecord(size_t offset) const noexcept {
+  if ((FileSize - offset) < (RECORD_HEADER_SIZE + MSG_RECORD_FIXED_SIZE)) {
+    return 0;
+  }
+
+  const uint8_t *rec = Map + offset;
+  const size_t payload_size = ReadUint32FromHeader(rec);
+
+  if ((payload_size < MSG_RECORD_FIXED_SIZE) ||
+      (payload_size > (FileSize - offset - RECORD_HEADER_SIZE))) {
+    return 0;
+  }
+
+  const uint8_t *payload = rec + RECORD_HEADER_SIZE;
+
+  if (ReadUint32FromHeader(rec + 4) != ComputeCrc32c(payload, payload_size)) {
+    return 0;
+  }
+
+  TRecord record;
+
+  if (!ReadMsgRecord(payload, payload_size, record)) {
+    return 0;
+  }
+
+  return RECORD_HEADER_SIZE + payload_size;
+}
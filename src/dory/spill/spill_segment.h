@@ -0,0 +1,174 @@
+/* <dory/spill/spill_segment.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Append-only memory-mapped segment file used by the disk spillover queue.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <base/fd.h>
+#include <base/no_copy_semantics.h>
+#include <dory/msg.h>
+#include <dory/util/msg_record.h>
+
+namespace Dory {
+
+  namespace Spill {
+
+    /* A fixed-size file, preallocated on creation and mapped into memory, that
+       holds a sequence of serialized messages.  Messages are appended at the
+       write offset and consumed in order from the read offset.  The file
+       layout is as follows:
+
+           header (HEADER_SIZE bytes):
+               magic number (4 bytes)
+               format version (4 bytes)
+               segment sequence number (8 bytes)
+               CRC-32 of the preceding 16 bytes (4 bytes)
+               unused (4 bytes)
+               read offset (8 bytes)
+               unused (remainder of header)
+
+           zero or more records, each as follows:
+               payload size (4 bytes)
+               CRC-32C of payload (4 bytes)
+               payload (see <dory/util/msg_record.h>)
+
+       All integers are stored in network byte order.  Since the file is
+       preallocated and therefore zero-filled, a payload size of 0 marks the
+       end of the records.  The write offset is not stored.  Instead, Open()
+       finds it by scanning the records following the read offset, and stops at
+       the first record whose CRC doesn't match.  Thus a record that was only
+       partially written when dory crashed is discarded, along with anything
+       following it. */
+    class TSpillSegment final {
+      NO_COPY_SEMANTICS(TSpillSegment);
+
+      public:
+      /* Thrown by Open() when a file doesn't have a valid segment header. */
+      class TBadSegment final : public std::runtime_error {
+        public:
+        explicit TBadSegment(const std::string &path)
+            : std::runtime_error(std::string("Bad spill segment file: ") +
+                  path) {
+        }
+      };  // TBadSegment
+
+      static const size_t HEADER_SIZE = 64;
+
+      /* A message read from the segment.  Pointers refer to the mapped file,
+         and are valid until the next call to Pop(). */
+      using TRecord = Util::TMsgRecord;
+
+      /* Return the number of bytes 'msg' occupies in a segment, including the
+         record header. */
+      static size_t ComputeRecordSize(const TMsg &msg) noexcept;
+
+      /* Create a new segment file of 'file_size' bytes at 'path'.  Fails if
+         the file already exists.  Throws std::system_error on failure
+         (including ENOSPC if the space can't be preallocated). */
+      static std::unique_ptr<TSpillSegment> Create(const std::string &path,
+          uint64_t seq, size_t file_size);
+
+      /* Open the existing segment file at 'path', recovering its read and
+         write offsets.  Throws TBadSegment if the header is invalid, or
+         std::system_error on failure to open or map the file.  On return,
+         'truncated' indicates whether a bad record was found and discarded. */
+      static std::unique_ptr<TSpillSegment> Open(const std::string &path,
+          bool &truncated);
+
+      ~TSpillSegment();
+
+      const std::string &GetPath() const noexcept {
+        return Path;
+      }
+
+      uint64_t GetSequenceNumber() const noexcept {
+        return SequenceNumber;
+      }
+
+      size_t GetFileSize() const noexcept {
+        return FileSize;
+      }
+
+      /* Return the number of messages that have been appended but not
+         popped. */
+      size_t GetMsgCount() const noexcept {
+        return MsgCount;
+      }
+
+      bool IsEmpty() const noexcept {
+        return (MsgCount == 0);
+      }
+
+      /* Return true if no more messages can be appended because a message
+         didn't fit. */
+      bool IsSealed() const noexcept {
+        return Sealed;
+      }
+
+      /* Append 'msg'.  Return true on success, or false if there isn't enough
+         space left, in which case the segment becomes sealed. */
+      bool Append(const TMsg &msg);
+
+      /* Fill in 'record' with the oldest message.  Segment must not be
+         empty. */
+      void Peek(TRecord &record) const noexcept;
+
+      /* Discard the oldest message.  Segment must not be empty. */
+      void Pop() noexcept;
+
+      /* Flush the mapped file contents to disk. */
+      void Sync();
+
+      private:
+      TSpillSegment(const std::string &path, Base::TFd &&fd, uint8_t *map,
+          size_t file_size, uint64_t seq);
+
+      /* Return the total size of the record at 'offset', or 0 if there is no
+         valid record there. */
+      size_t CheckRecord(size_t offset) const noexcept;
+
+      const std::string Path;
+
+      Base::TFd Fd;
+
+      uint8_t * const Map;
+
+      const size_t FileSize;
+
+      const uint64_t SequenceNumber;
+
+      size_t ReadOffset = HEADER_SIZE;
+
+      size_t WriteOffset = HEADER_SIZE;
+
+      size_t MsgCount = 0;
+
+      bool Sealed = false;
+    };  // TSpillSegment
+
+  }  // Spill
+
+}  // Dory
@@ -170,6 +170,35 @@ TMockKafkaDispatcher::GetSendWaitQueueAfterShutdown(size_t /*broker_index*/) {
 
 
 
+  return std::list<std::list<TMsg::TPtr>>();
+}
+
+void TMockKafkaDispatcher::UpdateMetadata(
+    const std::shared_ptr<TMetadata> & /*md*/) {
+
+
+
+
+
+}
+
+const TFd &TMockKafkaDispatcher::GetPartitionRetryFd() const noexcept {
+
+
+
+
+
+  static TFd placeholder;
+  return placeholder;
+}
+
+std::list<std::list<TMsg::TPtr>>
+TMockKafkaDispatcher::TakePartitionRetryMsgs() {
+
+
+
+
+
   return std::list<std::list<TMsg::TPtr>>();
 }
 
@@ -93,6 +93,12 @@ namespace Dory {
       std::list<std::list<TMsg::TPtr>>
       GetSendWaitQueueAfterShutdown(size_t broker_index) override;
 
+      void UpdateMetadata(const std::shared_ptr<TMetadata> &md) override;
+
+      const Base::TFd &GetPartitionRetryFd() const noexcept override;
+
+      std::list<std::list<TMsg::TPtr>> TakePartitionRetryMsgs() override;
+
       size_t GetAckCount() const noexcept override;
     };  // TMockKafkaDispatcher
 
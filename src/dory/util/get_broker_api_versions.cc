@@ -0,0 +1,142 @@
+/* <dory/util/get_broker_api_versions.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/util/get_broker_api_versions.h>.
+ */
+
+#include <dory/util/get_broker_api_versions.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <system_error>
+
+#include <base/counter.h>
+#include <base/io_util.h>
+#include <base/system_error_codes.h>
+#include <dory/kafka_proto/api_versions/v0/api_versions_request_writer.h>
+#include <dory/kafka_proto/api_versions/v0/api_versions_response_reader.h>
+#include <dory/kafka_proto/errors.h>
+#include <dory/kafka_proto/request_response.h>
+#include <log/log.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::KafkaProto;
+using namespace Dory::KafkaProto::ApiVersions;
+using namespace Dory::KafkaProto::ApiVersions::V0;
+using namespace Dory::Util;
+using namespace Log;
+
+DEFINE_COUNTER(ApiVersionsRequestFail);
+DEFINE_COUNTER(ApiVersionsRequestSuccess);
+DEFINE_COUNTER(ApiVersionsResponseBad);
+DEFINE_COUNTER(ApiVersionsResponseCorrelationIdMismatch);
+DEFINE_COUNTER(ApiVersionsResponseError);
+
+/* Loose upper bound on the response size, to guard against a response with a
+   ridiculously large size field.  Real responses are a few hundred bytes. */
+static const size_t MAX_RESPONSE_SIZE = 64 * 1024;
+
+static const int32_t API_VERSIONS_CORRELATION_ID = 0;
+
+std::optional<std::vector<TApiVersionRange>>
+Dory::Util::GetBrokerApiVersions(const TFd &sock, int timeout_ms) {
+  std::vector<uint8_t> buf;
+  TApiVersionsRequestWriter().WriteRequest(buf, API_VERSIONS_CORRELATION_ID);
+
+  try {
+    if (!TryWriteExactly(sock, &buf[0], buf.size(), timeout_ms)) {
+      ApiVersionsRequestFail.Increment();
+      LOG(TPri::ERR) << "Failed to send ApiVersions request";
+      return std::nullopt;
+    }
+
+    buf.resize(REQUEST_OR_RESPONSE_SIZE_SIZE);
+
+    if (!TryReadExactly(sock, &buf[0], buf.size(), timeout_ms)) {
+      ApiVersionsRequestFail.Increment();
+      LOG(TPri::ERR) << "Broker closed connection in response to ApiVersions "
+          << "request: broker may be older than Kafka 0.10";
+      return std::nullopt;
+    }
+
+    const size_t response_size = GetRequestOrResponseSize(&buf[0]);
+
+    if ((response_size < TApiVersionsResponseReader::MinSize()) ||
+        (response_size > MAX_RESPONSE_SIZE)) {
+      ApiVersionsResponseBad.Increment();
+      LOG(TPri::ERR) << "Got ApiVersions response with bad size: "
+          << response_size;
+      return std::nullopt;
+    }
+
+    buf.resize(response_size);
+
+    if (!TryReadExactly(sock, &buf[REQUEST_OR_RESPONSE_SIZE_SIZE],
+        response_size - REQUEST_OR_RESPONSE_SIZE_SIZE, timeout_ms)) {
+      throw TUnexpectedEnd();
+    }
+  } catch (const std::system_error &x) {
+    if (!LostTcpConnection(x) && (x.code().value() != ETIMEDOUT)) {
+      throw;  // anything else is fatal
+    }
+
+    ApiVersionsRequestFail.Increment();
+    LOG(TPri::ERR) << "ApiVersions request to broker failed: " << x.what();
+    return std::nullopt;
+  } catch (const TUnexpectedEnd &) {
+    ApiVersionsRequestFail.Increment();
+    LOG(TPri::ERR) << "Lost TCP connection to broker while getting "
+        << "ApiVersions response";
+    return std::nullopt;
+  } catch (const TBadRequestOrResponseSize &) {
+    ApiVersionsResponseBad.Increment();
+    LOG(TPri::ERR) << "Got ApiVersions response with bad size field";
+    return std::nullopt;
+  }
+
+  std::vector<TApiVersionRange> result;
+
+  try {
+    TApiVersionsResponseReader reader(&buf[0], buf.size());
+
+    if (reader.GetCorrelationId() != API_VERSIONS_CORRELATION_ID) {
+      ApiVersionsResponseCorrelationIdMismatch.Increment();
+      LOG(TPri::ERR) << "Got ApiVersions response with unexpected "
+          << "correlation ID " << reader.GetCorrelationId();
+      return std::nullopt;
+    }
+
+    if (reader.GetErrorCode() != 0) {
+      ApiVersionsResponseError.Increment();
+      LOG(TPri::ERR) << "Got ApiVersions response with error code "
+          << reader.GetErrorCode();
+      return std::nullopt;
+    }
+
+    result = reader.GetApiVersions();
+  } catch (const TBadApiVersionsResponse &x) {
+    ApiVersionsResponseBad.Increment();
+    LOG(TPri::ERR) << "Failed to parse ApiVersions response: " << x.what();
+    return std::nullopt;
+  }
+
+  ApiVersionsRequestSuccess.Increment();
+  return result;
+}
@@ -0,0 +1,47 @@
+/* <dory/util/get_broker_api_versions.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Function for asking a Kafka broker which versions of each API it supports.
+ */
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include <base/fd.h>
+#include <dory/kafka_proto/api_versions/api_versions.h>
+
+namespace Dory {
+
+  namespace Util {
+
+    /* Send a Kafka ApiVersions request over connected socket 'sock', and read
+       the response.  'timeout_ms' gives a timeout in milliseconds for each of
+       the send and receive steps.  On success, return the API list from the
+       broker's response.  On failure (lost connection, timeout, malformed
+       response, or error code in response), log an error and return
+       std::nullopt.  A broker older than Kafka 0.10 doesn't implement the
+       ApiVersions API, and will close the connection when it gets the request.
+     */
+    std::optional<std::vector<KafkaProto::ApiVersions::TApiVersionRange>>
+    GetBrokerApiVersions(const Base::TFd &sock, int timeout_ms);
+
+  }  // Util
+
+}  // Dory
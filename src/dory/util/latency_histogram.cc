@@ -0,0 +1,137 @@
+/* <dory/util/latency_histogram.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/util/latency_histogram.h>.
+ */
+
+#include <dory/util/latency_histogram.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+using namespace Dory;
+using namespace Dory::Util;
+
+TLatencySnapshot::TLatencySnapshot()
+    : Counts(TLatencyHistogram::BUCKET_COUNT, 0) {
+}
+
+uint64_t TLatencySnapshot::GetPercentile(double percentile) const noexcept {
+  if (Count == 0) {
+    return 0;
+  }
+
+  percentile = std::min(std::max(percentile, 0.0), 100.0);
+  auto rank = static_cast<uint64_t>(
+      std::ceil((percentile / 100.0) * static_cast<double>(Count)));
+  rank = std::max<uint64_t>(rank, 1);
+  uint64_t total = 0;
+
+  for (size_t i = 0; i < Counts.size(); ++i) {
+    total += Counts[i];
+
+    if (total >= rank) {
+      return std::min(TLatencyHistogram::BucketUpperBound(i), Max);
+    }
+  }
+
+  /* Possible if a snapshot raced with recording, so that 'Count' includes a
+     value whose bucket increment we missed. */
+  return Max;
+}
+
+void TLatencySnapshot::Merge(const TLatencySnapshot &that) noexcept {
+  assert(Counts.size() == that.Counts.size());
+
+  for (size_t i = 0; i < Counts.size(); ++i) {
+    Counts[i] += that.Counts[i];
+  }
+
+  Count += that.Count;
+  Sum += that.Sum;
+  Max = std::max(Max, that.Max);
+}
+
+size_t TLatencyHistogram::ValueToBucket(uint64_t value) noexcept {
+  static const uint64_t max_value = (uint64_t(1) << MAX_VALUE_BITS) - 1;
+  value = std::min(value, max_value);
+
+  if (value < (2 * SUB_BUCKET_HALF_COUNT)) {
+    return static_cast<size_t>(value);
+  }
+
+  const auto msb = static_cast<size_t>(63 - __builtin_clzll(value));
+  const size_t shift = msb - (SUB_BUCKET_BITS - 1);
+  return (shift * SUB_BUCKET_HALF_COUNT) + static_cast<size_t>(value >> shift);
+}
+
+uint64_t TLatencyHistogram::BucketUpperBound(size_t bucket) noexcept {
+  assert(bucket < BUCKET_COUNT);
+
+  if (bucket < (2 * SUB_BUCKET_HALF_COUNT)) {
+    return bucket;
+  }
+
+  const size_t shift = (bucket / SUB_BUCKET_HALF_COUNT) - 1;
+  const uint64_t sub_bucket =
+      (bucket % SUB_BUCKET_HALF_COUNT) + SUB_BUCKET_HALF_COUNT;
+  return ((sub_bucket + 1) << shift) - 1;
+}
+
+TLatencyHistogram::TLatencyHistogram() noexcept {
+  for (std::atomic<uint64_t> &bucket : Buckets) {
+    bucket.store(0, std::memory_order_relaxed);
+  }
+
+  Sum.store(0, std::memory_order_relaxed);
+  Max.store(0, std::memory_order_relaxed);
+}
+
+void TLatencyHistogram::Record(uint64_t value) noexcept {
+  Buckets[ValueToBucket(value)].fetch_add(1, std::memory_order_relaxed);
+  Sum.fetch_add(value, std::memory_order_relaxed);
+  uint64_t max = Max.load(std::memory_order_relaxed);
+
+  while ((value > max) &&
+      !Max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+  }
+}
+
+void TLatencyHistogram::AddTo(TLatencySnapshot &snapshot) const noexcept {
+  assert(snapshot.Counts.size() == BUCKET_COUNT);
+
+  for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+    const uint64_t count = Buckets[i].load(std::memory_order_relaxed);
+    snapshot.Counts[i] += count;
+    snapshot.Count += count;
+  }
+
+  snapshot.Sum += Sum.load(std::memory_order_relaxed);
+  snapshot.Max = std::max(snapshot.Max, Max.load(std::memory_order_relaxed));
+}
+
+TLatencySnapshot TShardedLatencyHistogram::GetSnapshot() const {
+  TLatencySnapshot snapshot;
+
+  for (const TShard &shard : Shards) {
+    shard.Histogram.AddTo(snapshot);
+  }
+
+  return snapshot;
+}
@@ -0,0 +1,171 @@
+/* <dory/util/latency_histogram.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   HDR-style latency histogram with lock-free recording.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+#include <base/thread_shard.h>
+
+namespace Dory {
+
+  namespace Util {
+
+    /* Point-in-time copy of the contents of one or more latency histograms.
+       Obtained from TLatencyHistogram or TShardedLatencyHistogram, and used
+       for reporting. */
+    class TLatencySnapshot final {
+      public:
+      TLatencySnapshot();
+
+      TLatencySnapshot(const TLatencySnapshot &) = default;
+
+      TLatencySnapshot(TLatencySnapshot &&) = default;
+
+      TLatencySnapshot &operator=(const TLatencySnapshot &) = default;
+
+      TLatencySnapshot &operator=(TLatencySnapshot &&) = default;
+
+      /* Return the number of recorded values. */
+      uint64_t GetCount() const noexcept {
+        return Count;
+      }
+
+      uint64_t GetMax() const noexcept {
+        return Max;
+      }
+
+      /* Return the mean of the recorded values, or 0 if there are none. */
+      double GetMean() const noexcept {
+        return Count ?
+            (static_cast<double>(Sum) / static_cast<double>(Count)) : 0.0;
+      }
+
+      /* Return the value at 'percentile', which must be in the range
+         [0, 100].  The result is the upper bound of the bucket containing the
+         value, so it may overstate the true value by up to the histogram's
+         relative precision, but never exceeds GetMax().  Returns 0 if there
+         are no recorded values. */
+      uint64_t GetPercentile(double percentile) const noexcept;
+
+      /* Add the contents of 'that' to this snapshot. */
+      void Merge(const TLatencySnapshot &that) noexcept;
+
+      private:
+      std::vector<uint64_t> Counts;
+
+      uint64_t Count = 0;
+
+      uint64_t Sum = 0;
+
+      uint64_t Max = 0;
+
+      friend class TLatencyHistogram;
+    };  // TLatencySnapshot
+
+    /* A histogram of latency values in the style of HdrHistogram: values are
+       grouped into power of 2 ranges, each split into a fixed number of
+       linear sub-buckets.  This bounds the relative error of reported
+       percentiles while keeping the bucket count small.  Recording is
+       lock-free and never allocates, so it can be done on the message
+       handling fast path while another thread takes snapshots. */
+    class TLatencyHistogram final {
+      NO_COPY_SEMANTICS(TLatencyHistogram);
+
+      public:
+      /* Each power of 2 range is split into 2^(SUB_BUCKET_BITS - 1) linear
+         sub-buckets, giving a relative precision of about 6%. */
+      static const size_t SUB_BUCKET_BITS = 5;
+
+      /* Values of 2^MAX_VALUE_BITS or larger are counted in the last bucket.
+         For microsecond values, this is about 12 days. */
+      static const size_t MAX_VALUE_BITS = 40;
+
+      static const size_t SUB_BUCKET_HALF_COUNT =
+          size_t(1) << (SUB_BUCKET_BITS - 1);
+
+      static const size_t BUCKET_COUNT =
+          (MAX_VALUE_BITS - SUB_BUCKET_BITS + 2) * SUB_BUCKET_HALF_COUNT;
+
+      /* Return the index of the bucket that 'value' is counted in. */
+      static size_t ValueToBucket(uint64_t value) noexcept;
+
+      /* Return the largest value counted in bucket 'bucket'. */
+      static uint64_t BucketUpperBound(size_t bucket) noexcept;
+
+      TLatencyHistogram() noexcept;
+
+      void Record(uint64_t value) noexcept;
+
+      /* Add our current contents to 'snapshot'.  May be called concurrently
+         with Record(), in which case values being recorded may or may not be
+         included. */
+      void AddTo(TLatencySnapshot &snapshot) const noexcept;
+
+      TLatencySnapshot GetSnapshot() const {
+        TLatencySnapshot snapshot;
+        AddTo(snapshot);
+        return snapshot;
+      }
+
+      private:
+      std::array<std::atomic<uint64_t>, BUCKET_COUNT> Buckets;
+
+      std::atomic<uint64_t> Sum;
+
+      std::atomic<uint64_t> Max;
+    };  // TLatencyHistogram
+
+    /* A latency histogram that may be recorded to by many threads.  Each
+       recording thread is assigned one of a fixed number of shards in
+       round-robin order, so threads rarely contend for the same cache
+       lines.  The shards are merged when a snapshot is taken. */
+    class TShardedLatencyHistogram final {
+      NO_COPY_SEMANTICS(TShardedLatencyHistogram);
+
+      public:
+      static const size_t SHARD_COUNT = 8;
+
+      TShardedLatencyHistogram() = default;
+
+      void Record(uint64_t value) noexcept {
+        Shards[Base::GetThreadShardIndex() % SHARD_COUNT].Histogram.Record(
+            value);
+      }
+
+      TLatencySnapshot GetSnapshot() const;
+
+      private:
+      struct alignas(64) TShard {
+        TLatencyHistogram Histogram;
+      };  // TShard
+
+      std::array<TShard, SHARD_COUNT> Shards;
+    };  // TShardedLatencyHistogram
+
+  }  // Util
+
+}  // Dory
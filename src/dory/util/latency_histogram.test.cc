@@ -0,0 +1,149 @@
+/* <dory/util/latency_histogram.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit test for <dory/util/latency_histogram.h>.
+ */
+
+#include <dory/util/latency_histogram.h>
+
+#include <thread>
+#include <vector>
+
+#include <base/tmp_file.h>
+#include <test_util/test_logging.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Dory;
+using namespace Dory::Util;
+using namespace ::TestUtil;
+
+namespace {
+
+  /* The fixture for testing class TLatencyHistogram. */
+  class TLatencyHistogramTest : public ::testing::Test {
+    protected:
+    TLatencyHistogramTest() = default;
+
+    ~TLatencyHistogramTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TLatencyHistogramTest
+
+  TEST_F(TLatencyHistogramTest, Buckets) {
+    /* Small values get exact buckets. */
+    for (uint64_t i = 0; i < 32; ++i) {
+      ASSERT_EQ(TLatencyHistogram::ValueToBucket(i), i);
+      ASSERT_EQ(TLatencyHistogram::BucketUpperBound(i), i);
+    }
+
+    /* Buckets are contiguous, and every value falls in its bucket's range. */
+    uint64_t prev_upper = 31;
+
+    for (size_t i = 32; i < TLatencyHistogram::BUCKET_COUNT; ++i) {
+      uint64_t upper = TLatencyHistogram::BucketUpperBound(i);
+      ASSERT_GT(upper, prev_upper);
+      ASSERT_EQ(TLatencyHistogram::ValueToBucket(prev_upper + 1), i);
+      ASSERT_EQ(TLatencyHistogram::ValueToBucket(upper), i);
+
+      /* Bucket width stays within about 6% of the values it holds. */
+      ASSERT_LE((upper - prev_upper) * 16, prev_upper + 1);
+      prev_upper = upper;
+    }
+
+    ASSERT_EQ(TLatencyHistogram::ValueToBucket(~uint64_t(0)),
+        TLatencyHistogram::BUCKET_COUNT - 1);
+  }
+
+  TEST_F(TLatencyHistogramTest, Percentiles) {
+    TLatencyHistogram h;
+    TLatencySnapshot empty = h.GetSnapshot();
+    ASSERT_EQ(empty.GetCount(), 0U);
+    ASSERT_EQ(empty.GetPercentile(50.0), 0U);
+    ASSERT_EQ(empty.GetMean(), 0.0);
+
+    for (uint64_t i = 1; i <= 1000; ++i) {
+      h.Record(i);
+    }
+
+    TLatencySnapshot s = h.GetSnapshot();
+    ASSERT_EQ(s.GetCount(), 1000U);
+    ASSERT_EQ(s.GetMax(), 1000U);
+    ASSERT_EQ(s.GetMean(), 500.5);
+    ASSERT_EQ(s.GetPercentile(0.0), 1U);
+    ASSERT_EQ(s.GetPercentile(100.0), 1000U);
+    uint64_t p50 = s.GetPercentile(50.0);
+    ASSERT_GE(p50, 500U);
+    ASSERT_LE(p50, 500U + (500U / 16));
+    uint64_t p99 = s.GetPercentile(99.0);
+    ASSERT_GE(p99, 990U);
+    ASSERT_LE(p99, 1000U);
+  }
+
+  TEST_F(TLatencyHistogramTest, Merge) {
+    TLatencyHistogram h1;
+    TLatencyHistogram h2;
+    h1.Record(10);
+    h1.Record(20);
+    h2.Record(5000);
+    TLatencySnapshot s = h1.GetSnapshot();
+    s.Merge(h2.GetSnapshot());
+    ASSERT_EQ(s.GetCount(), 3U);
+    ASSERT_EQ(s.GetMax(), 5000U);
+    ASSERT_EQ(s.GetPercentile(50.0), 20U);
+    ASSERT_GE(s.GetPercentile(90.0), 5000U);
+  }
+
+  TEST_F(TLatencyHistogramTest, Sharded) {
+    static const size_t thread_count = 12;
+    static const uint64_t per_thread = 10000;
+    TShardedLatencyHistogram h;
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < thread_count; ++i) {
+      threads.emplace_back(
+          [&h, i] {
+            for (uint64_t j = 0; j < per_thread; ++j) {
+              h.Record(i + 1);
+            }
+          });
+    }
+
+    for (std::thread &t : threads) {
+      t.join();
+    }
+
+    TLatencySnapshot s = h.GetSnapshot();
+    ASSERT_EQ(s.GetCount(), thread_count * per_thread);
+    ASSERT_EQ(s.GetMax(), thread_count);
+    ASSERT_EQ(s.GetPercentile(100.0), thread_count);
+    ASSERT_EQ(s.GetPercentile(1.0), 1U);
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  TTmpFile test_logfile = InitTestLogging(argv[0]);
+  return RUN_ALL_TESTS();
+}
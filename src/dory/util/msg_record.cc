@@ -0,0 +1,134 @@
+/* <dory/util/msg_record.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <dory/util/msg_record.h>.
+ */
+
+#include <dory/util/msg_record.h>
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <string>
+
+#include <base/field_access.h>
+#include <base/no_default_case.h>
+#include <capped/reader.h>
+#include <dory/msg_creator.h>
+
+using namespace Capped;
+using namespace Dory;
+using namespace Dory::Util;
+
+static const size_t ROUTING_TYPE_OFFSET = 0;
+
+static const size_t FLAGS_OFFSET = 1;
+
+static const size_t TOPIC_SIZE_OFFSET = 2;
+
+static const size_t PARTITION_KEY_OFFSET = 4;
+
+static const size_t TIMESTAMP_OFFSET = 8;
+
+static const size_t KEY_SIZE_OFFSET = 16;
+
+static const size_t VALUE_SIZE_OFFSET = 20;
+
+static const uint8_t FLAG_BODY_TRUNCATED = 0x01;
+
+bool Dory::Util::MsgRecordCanHold(const TMsg &msg) noexcept {
+  return (msg.GetTopic().size() <= std::numeric_limits<uint16_t>::max());
+}
+
+void Dory::Util::WriteMsgRecord(uint8_t *dst, const TMsg &msg) {
+  assert(dst);
+  assert(MsgRecordCanHold(msg));
+  const std::string &topic = msg.GetTopic();
+  dst[ROUTING_TYPE_OFFSET] = static_cast<uint8_t>(msg.GetRoutingType());
+  dst[FLAGS_OFFSET] = msg.BodyIsTruncated() ? FLAG_BODY_TRUNCATED : 0;
+  WriteUint16ToHeader(dst + TOPIC_SIZE_OFFSET,
+      static_cast<uint16_t>(topic.size()));
+  WriteInt32ToHeader(dst + PARTITION_KEY_OFFSET, msg.GetPartitionKey());
+  WriteInt64ToHeader(dst + TIMESTAMP_OFFSET, msg.GetTimestamp());
+  WriteUint32ToHeader(dst + KEY_SIZE_OFFSET,
+      static_cast<uint32_t>(msg.GetKeySize()));
+  WriteUint32ToHeader(dst + VALUE_SIZE_OFFSET,
+      static_cast<uint32_t>(msg.GetValueSize()));
+  std::memcpy(dst + MSG_RECORD_FIXED_SIZE, topic.data(), topic.size());
+
+  /* The key and value are stored contiguously in the message blob. */
+  TReader(&msg.GetKeyAndValue()).Read(
+      dst + MSG_RECORD_FIXED_SIZE + topic.size(),
+      msg.GetKeySize() + msg.GetValueSize());
+}
+
+bool Dory::Util::ReadMsgRecord(const uint8_t *src, size_t size,
+    TMsgRecord &rec) noexcept {
+  assert(src);
+
+  if (size < MSG_RECORD_FIXED_SIZE) {
+    return false;
+  }
+
+  const uint8_t routing_type = src[ROUTING_TYPE_OFFSET];
+
+  if ((routing_type !=
+          static_cast<uint8_t>(TMsg::TRoutingType::AnyPartition)) &&
+      (routing_type !=
+          static_cast<uint8_t>(TMsg::TRoutingType::PartitionKey))) {
+    return false;
+  }
+
+  rec.RoutingType = static_cast<TMsg::TRoutingType>(routing_type);
+  rec.BodyTruncated = ((src[FLAGS_OFFSET] & FLAG_BODY_TRUNCATED) != 0);
+  rec.PartitionKey = ReadInt32FromHeader(src + PARTITION_KEY_OFFSET);
+  rec.Timestamp = ReadInt64FromHeader(src + TIMESTAMP_OFFSET);
+  rec.TopicSize = ReadUint16FromHeader(src + TOPIC_SIZE_OFFSET);
+  rec.KeySize = ReadUint32FromHeader(src + KEY_SIZE_OFFSET);
+  rec.ValueSize = ReadUint32FromHeader(src + VALUE_SIZE_OFFSET);
+
+  if ((MSG_RECORD_FIXED_SIZE + rec.TopicSize + rec.KeySize + rec.ValueSize)
+      != size) {
+    return false;
+  }
+
+  rec.Topic = reinterpret_cast<const char *>(src + MSG_RECORD_FIXED_SIZE);
+  rec.Key = src + MSG_RECORD_FIXED_SIZE + rec.TopicSize;
+  rec.Value = rec.Key + rec.KeySize;
+  return true;
+}
+
+TMsg::TPtr Dory::Util::CreateMsgFromRecord(const TMsgRecord &rec,
+    TPool &pool, TMsgStateTracker &msg_state_tracker) {
+  switch (rec.RoutingType) {
+    case TMsg::TRoutingType::AnyPartition: {
+      return TMsgCreator::CreateAnyPartitionMsg(rec.Timestamp, rec.Topic,
+          rec.Topic + rec.TopicSize, rec.Key, rec.KeySize, rec.Value,
+          rec.ValueSize, rec.BodyTruncated, pool, msg_state_tracker);
+    }
+    case TMsg::TRoutingType::PartitionKey: {
+      return TMsgCreator::CreatePartitionKeyMsg(rec.PartitionKey,
+          rec.Timestamp, rec.Topic, rec.Topic + rec.TopicSize, rec.Key,
+          rec.KeySize, rec.Value, rec.ValueSize, rec.BodyTruncated, pool,
+          msg_state_tracker);
+    }
+    NO_DEFAULT_CASE;
+  }
+
+  return TMsg::TPtr();
+}
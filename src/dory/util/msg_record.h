@@ -0,0 +1,100 @@
+/* <dory/util/msg_record.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Serialized form of a message, for storing messages on disk.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <capped/pool.h>
+#include <dory/msg.h>
+#include <dory/msg_state_tracker.h>
+
+namespace Dory {
+
+  namespace Util {
+
+    /* A message record consists of the following fields, with integers
+       stored in network byte order:
+
+           routing type (1 byte)
+           flags (1 byte, bit 0 is set if body truncated)
+           topic size (2 bytes)
+           partition key (4 bytes)
+           timestamp (8 bytes)
+           key size (4 bytes)
+           value size (4 bytes)
+           topic, key, and value contents
+
+       TMsgRecord is a view of a record.  Its pointers refer to the memory
+       holding the record. */
+    struct TMsgRecord {
+      TMsg::TRoutingType RoutingType = TMsg::TRoutingType::AnyPartition;
+
+      bool BodyTruncated = false;
+
+      int32_t PartitionKey = 0;
+
+      TMsg::TTimestamp Timestamp = 0;
+
+      const char *Topic = nullptr;
+
+      size_t TopicSize = 0;
+
+      const uint8_t *Key = nullptr;
+
+      size_t KeySize = 0;
+
+      const uint8_t *Value = nullptr;
+
+      size_t ValueSize = 0;
+    };  // TMsgRecord
+
+    /* Size of a record for a message with an empty topic, key, and value. */
+    static const size_t MSG_RECORD_FIXED_SIZE = 24;
+
+    /* Return true if 'msg' can be stored as a record.  This fails only if the
+       topic is unreasonably long. */
+    bool MsgRecordCanHold(const TMsg &msg) noexcept;
+
+    /* Return the size of the record for 'msg'. */
+    inline size_t ComputeMsgRecordSize(const TMsg &msg) noexcept {
+      return MSG_RECORD_FIXED_SIZE + msg.GetTopic().size() +
+          msg.GetKeySize() + msg.GetValueSize();
+    }
+
+    /* Write the record for 'msg' to 'dst', which must have space for
+       ComputeMsgRecordSize(msg) bytes.  MsgRecordCanHold(msg) must be true. */
+    void WriteMsgRecord(uint8_t *dst, const TMsg &msg);
+
+    /* Fill in 'rec' from the 'size' bytes at 'src'.  Return false if the
+       data isn't a valid record of exactly that size. */
+    bool ReadMsgRecord(const uint8_t *src, size_t size,
+        TMsgRecord &rec) noexcept;
+
+    /* Create a new message from 'rec', allocating memory from 'pool'.  Throws
+       Capped::TMemoryCapReached if the pool doesn't have enough space. */
+    TMsg::TPtr CreateMsgFromRecord(const TMsgRecord &rec, Capped::TPool &pool,
+        TMsgStateTracker &msg_state_tracker);
+
+  }  // Util
+
+}  // Dory
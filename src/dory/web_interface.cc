@@ -38,11 +38,19 @@ using namespace Log;
 using namespace Server;
 
 DEFINE_COUNTER(MongooseEventLog);
+DEFINE_COUNTER(MongooseGetApiVersionsRequest);
+DEFINE_COUNTER(MongooseGetCompressionStatsRequest);
 DEFINE_COUNTER(MongooseGetServerInfoRequest);
 DEFINE_COUNTER(MongooseGetCountersRequest);
+DEFINE_COUNTER(MongooseGetLatencyStatsRequest);
+DEFINE_COUNTER(MongooseGetLingerStatsRequest);
+DEFINE_COUNTER(MongooseGetMemoryStatsRequest);
 DEFINE_COUNTER(MongooseGetDiscardsRequest);
 DEFINE_COUNTER(MongooseGetMetadataFetchTimeRequest);
+DEFINE_COUNTER(MongooseGetMetricsRequest);
+DEFINE_COUNTER(MongooseGetProfileRequest);
 DEFINE_COUNTER(MongooseGetQueueStatsRequest);
+DEFINE_COUNTER(MongooseGetTracesRequest);
 DEFINE_COUNTER(MongooseHttpRequest);
 DEFINE_COUNTER(MongooseStdException);
 DEFINE_COUNTER(MongooseUnknownException);
@@ -77,6 +85,30 @@ const char *TWebInterface::ToErrorBlurb(TRequestType request_type) {
     case TRequestType::GET_QUEUE_STATS: {
       return "Get queue stats";
     }
+    case TRequestType::GET_API_VERSIONS: {
+      return "Get API versions";
+    }
+    case TRequestType::GET_COMPRESSION_STATS: {
+      return "Get compression stats";
+    }
+    case TRequestType::GET_LINGER_STATS: {
+      return "Get linger stats";
+    }
+    case TRequestType::GET_LATENCY_STATS: {
+      return "Get latency stats";
+    }
+    case TRequestType::GET_MEMORY_STATS: {
+      return "Get memory stats";
+    }
+    case TRequestType::GET_TRACES: {
+      return "Get message traces";
+    }
+    case TRequestType::GET_PROFILE: {
+      return "Get thread profile";
+    }
+    case TRequestType::GET_METRICS: {
+      return "Get metrics";
+    }
     case TRequestType::MSG_DEBUG_GET_TOPICS: {
       return "Msg debug get topics";
     }
@@ -192,6 +224,34 @@ void TWebInterface::WriteFrontPage(std::ostream &os) {
       << std::endl
       << "          [<a href=\"/metadata_fetch_time/json\">JSON</a>]<br/>"
       << std::endl
+      << "      Get broker API versions: [<a href=\"/api_versions/plain\">"
+      << "plain</a>]" << std::endl
+      << "          [<a href=\"/api_versions/json\">JSON</a>]<br/>"
+      << std::endl
+      << "      Get adaptive compression stats:" << std::endl
+      << "          [<a href=\"/compression/plain\">plain</a>]" << std::endl
+      << "          [<a href=\"/compression/json\">JSON</a>]<br/>"
+      << std::endl
+      << "      Get adaptive linger stats:" << std::endl
+      << "          [<a href=\"/linger/plain\">plain</a>]" << std::endl
+      << "          [<a href=\"/linger/json\">JSON</a>]<br/>"
+      << std::endl
+      << "      Get latency histograms:" << std::endl
+      << "          [<a href=\"/latency/plain\">plain</a>]" << std::endl
+      << "          [<a href=\"/latency/json\">JSON</a>]<br/>"
+      << std::endl
+      << "      Get memory usage:" << std::endl
+      << "          [<a href=\"/memory/plain\">plain</a>]" << std::endl
+      << "          [<a href=\"/memory/json\">JSON</a>]<br/>"
+      << std::endl
+      << "      Get sampled message traces:" << std::endl
+      << "          [<a href=\"/traces/json\">JSON</a>]<br/>"
+      << std::endl
+      << "      Get router and connector thread profile:" << std::endl
+      << "          [<a href=\"/profile/json\">JSON</a>]<br/>"
+      << std::endl
+      << "      Get metrics in Prometheus format:" << std::endl
+      << "          [<a href=\"/metrics\">plain</a>]<br/>" << std::endl
       << "    </div>" << std::endl
       << "    <h1>Server Management</h1>" << std::endl
       << "    <form action=\"/metadata_update\" method=\"post\">" << std::endl
@@ -279,6 +339,78 @@ void TWebInterface::HandleHttpRequest(mg_connection *conn,
       MongooseGetQueueStatsRequest.Increment();
       TWebRequestHandler().HandleQueueStatsRequestJson(oss, MsgStateTracker);
       response_type = TResponseType::Json;
+    } else if (!std::strcmp(request_info->uri, "/api_versions/plain")) {
+      request_type = TRequestType::GET_API_VERSIONS;
+      MongooseGetApiVersionsRequest.Increment();
+      TWebRequestHandler().HandleApiVersionsRequestPlain(oss,
+          ApiVersionStats);
+    } else if (!std::strcmp(request_info->uri, "/api_versions/json")) {
+      request_type = TRequestType::GET_API_VERSIONS;
+      MongooseGetApiVersionsRequest.Increment();
+      TWebRequestHandler().HandleApiVersionsRequestJson(oss, ApiVersionStats);
+      response_type = TResponseType::Json;
+    } else if (!std::strcmp(request_info->uri, "/compression/plain")) {
+      request_type = TRequestType::GET_COMPRESSION_STATS;
+      MongooseGetCompressionStatsRequest.Increment();
+      TWebRequestHandler().HandleCompressionStatsRequestPlain(oss,
+          CompressionStats);
+    } else if (!std::strcmp(request_info->uri, "/compression/json")) {
+      request_type = TRequestType::GET_COMPRESSION_STATS;
+      MongooseGetCompressionStatsRequest.Increment();
+      TWebRequestHandler().HandleCompressionStatsRequestJson(oss,
+          CompressionStats);
+      response_type = TResponseType::Json;
+    } else if (!std::strcmp(request_info->uri, "/linger/plain")) {
+      request_type = TRequestType::GET_LINGER_STATS;
+      MongooseGetLingerStatsRequest.Increment();
+      TWebRequestHandler().HandleLingerStatsRequestPlain(oss, LingerStats);
+    } else if (!std::strcmp(request_info->uri, "/linger/json")) {
+      request_type = TRequestType::GET_LINGER_STATS;
+      MongooseGetLingerStatsRequest.Increment();
+      TWebRequestHandler().HandleLingerStatsRequestJson(oss, LingerStats);
+      response_type = TResponseType::Json;
+    } else if (!std::strcmp(request_info->uri, "/latency/plain")) {
+      request_type = TRequestType::GET_LATENCY_STATS;
+      MongooseGetLatencyStatsRequest.Increment();
+      TWebRequestHandler().HandleLatencyStatsRequestPlain(oss, LatencyStats);
+    } else if (!std::strcmp(request_info->uri, "/latency/json")) {
+      request_type = TRequestType::GET_LATENCY_STATS;
+      MongooseGetLatencyStatsRequest.Increment();
+      TWebRequestHandler().HandleLatencyStatsRequestJson(oss, LatencyStats);
+      response_type = TResponseType::Json;
+    } else if (!std::strcmp(request_info->uri, "/memory/plain")) {
+      request_type = TRequestType::GET_MEMORY_STATS;
+      MongooseGetMemoryStatsRequest.Increment();
+      TWebRequestHandler().HandleMemoryStatsRequestPlain(oss,
+          MemoryTelemetry);
+    } else if (!std::strcmp(request_info->uri, "/memory/json")) {
+      request_type = TRequestType::GET_MEMORY_STATS;
+      MongooseGetMemoryStatsRequest.Increment();
+      TWebRequestHandler().HandleMemoryStatsRequestJson(oss, MemoryTelemetry);
+      response_type = TResponseType::Json;
+    } else if (!std::strcmp(request_info->uri, "/traces/json")) {
+      request_type = TRequestType::GET_TRACES;
+      MongooseGetTracesRequest.Increment();
+      TWebRequestHandler().HandleTracesRequestJson(oss, MsgTracer);
+      response_type = TResponseType::Json;
+    } else if (!std::strcmp(request_info->uri, "/profile/json")) {
+      request_type = TRequestType::GET_PROFILE;
+      MongooseGetProfileRequest.Increment();
+      TWebRequestHandler().HandleProfileRequestJson(oss, Profiler);
+      response_type = TResponseType::Json;
+    } else if (!std::strcmp(request_info->uri, "/metrics")) {
+      request_type = TRequestType::GET_METRICS;
+      MongooseGetMetricsRequest.Increment();
+
+      /* Send the rendered metrics directly rather than copying them through
+         'oss'. */
+      const std::string &metrics =
+          MetricsRenderer.Render(request_info->query_string);
+      mg_printf(conn, "HTTP/1.1 200 OK\r\n"
+                      "Content-Type: text/plain; version=0.0.4\r\n"
+                      "Content-Length: %zu\r\n\r\n", metrics.size());
+      mg_write(conn, metrics.data(), metrics.size());
+      return;
     } else if (!std::strcmp(request_info->uri, "/msg_debug/get_topics")) {
       request_type = TRequestType::MSG_DEBUG_GET_TOPICS;
       TWebRequestHandler().HandleGetDebugTopicsRequest(oss, DebugSetup);
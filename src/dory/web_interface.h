@@ -30,10 +30,19 @@
 #include <base/event_semaphore.h>
 #include <base/indent.h>
 #include <base/no_copy_semantics.h>
+#include <capped/pool.h>
 #include <dory/anomaly_tracker.h>
+#include <dory/api_version_stats.h>
+#include <dory/compression_stats.h>
 #include <dory/debug/debug_setup.h>
+#include <dory/latency_stats.h>
+#include <dory/linger_stats.h>
+#include <dory/memory_telemetry.h>
 #include <dory/metadata_timestamp.h>
+#include <dory/metrics_renderer.h>
 #include <dory/msg_state_tracker.h>
+#include <dory/msg_tracer.h>
+#include <dory/profiler.h>
 #include <third_party/mongoose/mongoose.h>
 
 namespace Dory {
@@ -45,12 +54,28 @@ namespace Dory {
     TWebInterface(in_port_t port, TMsgStateTracker &msg_state_tracker,
                   TAnomalyTracker &anomaly_tracker,
                   const TMetadataTimestamp &metadata_timestamp,
+                  const TApiVersionStats &api_version_stats,
+                  const TCompressionStats &compression_stats,
+                  const TLingerStats &linger_stats,
+                  const TLatencyStats &latency_stats,
+                  const TMsgTracer &msg_tracer,
+                  const TMemoryTelemetry &memory_telemetry,
+                  const TProfiler &profiler,
+                  const Capped::TPool &pool,
                   Base::TEventSemaphore &metadata_update_request_sem,
                   Debug::TDebugSetup &debug_setup)
         : Port(port),
           MsgStateTracker(msg_state_tracker),
           AnomalyTracker(anomaly_tracker),
           MetadataTimestamp(metadata_timestamp),
+          ApiVersionStats(api_version_stats),
+          CompressionStats(compression_stats),
+          LingerStats(linger_stats),
+          LatencyStats(latency_stats),
+          MsgTracer(msg_tracer),
+          MemoryTelemetry(memory_telemetry),
+          Profiler(profiler),
+          MetricsRenderer(msg_state_tracker, anomaly_tracker, pool),
           MetadataUpdateRequestSem(metadata_update_request_sem),
           DebugSetup(debug_setup) {
     }
@@ -88,6 +113,14 @@ namespace Dory {
       GET_DISCARDS,
       GET_METADATA_FETCH_TIME,
       GET_QUEUE_STATS,
+      GET_API_VERSIONS,
+      GET_COMPRESSION_STATS,
+      GET_LINGER_STATS,
+      GET_LATENCY_STATS,
+      GET_MEMORY_STATS,
+      GET_TRACES,
+      GET_PROFILE,
+      GET_METRICS,
       MSG_DEBUG_GET_TOPICS,
       MSG_DEBUG_ADD_ALL_TOPICS,
       MSG_DEBUG_DEL_ALL_TOPICS,
@@ -120,6 +153,24 @@ namespace Dory {
 
     const TMetadataTimestamp &MetadataTimestamp;
 
+    const TApiVersionStats &ApiVersionStats;
+
+    const TCompressionStats &CompressionStats;
+
+    const TLingerStats &LingerStats;
+
+    const TLatencyStats &LatencyStats;
+
+    const TMsgTracer &MsgTracer;
+
+    const TMemoryTelemetry &MemoryTelemetry;
+
+    const TProfiler &Profiler;
+
+    /* Handles /metrics requests.  Keeps its buffers between requests, which
+       is safe since the web interface uses a single thread. */
+    TMetricsRenderer MetricsRenderer;
+
     Base::TEventSemaphore &MetadataUpdateRequestSem;
 
     Debug::TDebugSetup &DebugSetup;
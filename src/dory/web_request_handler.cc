@@ -26,7 +26,10 @@
 #include <ctime>
 #include <iomanip>
 #include <memory>
+#include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <sys/types.h>
 #include <unistd.h>
@@ -389,6 +392,813 @@ void TWebRequestHandler::HandleQueueStatsRequestJson(std::ostream &os,
   os << ind0 << "}" << std::endl;
 }
 
+static void WriteOptVersion(std::ostream &os,
+    const std::optional<size_t> &version) {
+  if (version) {
+    os << *version;
+  } else {
+    os << "null";
+  }
+}
+
+void TWebRequestHandler::HandleApiVersionsRequestPlain(std::ostream &os,
+    const TApiVersionStats &stats) {
+  std::vector<TApiVersionStats::TBrokerInfo> broker_info =
+      stats.GetBrokerInfo();
+  uint64_t now = GetEpochSeconds();
+  char now_time_buf[TIME_BUF_SIZE];
+  FillTimeBuf(now, now_time_buf);
+  time_t start_time = GetServerStartTime();
+  char start_time_buf[TIME_BUF_SIZE];
+  FillTimeBuf(start_time, start_time_buf);
+  os << "pid: " << getpid() << std::endl
+      << "version: " << dory_build_id << std::endl
+      << "since: " << start_time << " " << start_time_buf << std::endl
+      << "now: " << now << " " << now_time_buf << std::endl << std::endl;
+
+  for (const auto &item : broker_info) {
+    os << "host: [" << item.Host << "] port: " << item.Port;
+
+    if (item.BrokerId) {
+      os << " broker: " << *item.BrokerId;
+    }
+
+    os << std::endl << "    produce: ";
+    WriteOptVersion(os, item.ProduceApiVersion);
+    os << "  metadata: ";
+    WriteOptVersion(os, item.MetadataApiVersion);
+    os << "  updated: " << item.UpdateTime << std::endl;
+
+    if (!item.BrokerVersions.empty()) {
+      os << "    broker supports:";
+
+      for (const auto &range : item.BrokerVersions) {
+        os << " " << range.ApiKey << ":" << range.MinVersion << "-"
+            << range.MaxVersion;
+      }
+
+      os << std::endl;
+    }
+  }
+}
+
+void TWebRequestHandler::HandleApiVersionsRequestJson(std::ostream &os,
+    const TApiVersionStats &stats) {
+  std::vector<TApiVersionStats::TBrokerInfo> broker_info =
+      stats.GetBrokerInfo();
+  uint64_t now = GetEpochSeconds();
+  time_t start_time = GetServerStartTime();
+  std::string indent_str;
+  TIndent ind0(indent_str, TIndent::StartAt::Zero, 4);
+  os << ind0 << "{" << std::endl;
+
+  {
+    TIndent ind1(ind0);
+    os << ind1 << "\"pid\": " << getpid() << "," << std::endl
+        << ind1 << "\"version\": \"" << dory_build_id << "\"," << std::endl
+        << ind1 << "\"since\": " << start_time << "," << std::endl
+        << ind1 << "\"now\": " << now << "," << std::endl
+        << ind1 << "\"brokers\": [";
+
+    {
+      TIndent ind2(ind1);
+      bool first_time = true;
+
+      for (const auto &item : broker_info) {
+        if (!first_time) {
+          os << ",";
+        }
+
+        os << std::endl << ind2 << "{" << std::endl;
+
+        {
+          TIndent ind3(ind2);
+          os << ind3 << "\"host\": \"" << item.Host << "\"," << std::endl
+              << ind3 << "\"port\": " << item.Port << "," << std::endl
+              << ind3 << "\"broker_id\": ";
+
+          if (item.BrokerId) {
+            os << *item.BrokerId;
+          } else {
+            os << "null";
+          }
+
+          os << "," << std::endl << ind3 << "\"produce\": ";
+          WriteOptVersion(os, item.ProduceApiVersion);
+          os << "," << std::endl << ind3 << "\"metadata\": ";
+          WriteOptVersion(os, item.MetadataApiVersion);
+          os << "," << std::endl
+              << ind3 << "\"updated\": " << item.UpdateTime << "," << std::endl
+              << ind3 << "\"broker_supports\": [";
+
+          {
+            TIndent ind4(ind3);
+            bool first_range = true;
+
+            for (const auto &range : item.BrokerVersions) {
+              if (!first_range) {
+                os << ",";
+              }
+
+              os << std::endl << ind4 << "{ \"api_key\": " << range.ApiKey
+                  << ", \"min\": " << range.MinVersion << ", \"max\": "
+                  << range.MaxVersion << " }";
+              first_range = false;
+            }
+
+            if (!item.BrokerVersions.empty()) {
+              os << std::endl << ind3;
+            }
+          }
+
+          os << "]" << std::endl;
+        }
+
+        os << ind2 << "}";
+        first_time = false;
+      }
+
+      if (!broker_info.empty()) {
+        os << std::endl << ind1;
+      }
+    }
+
+    os << "]" << std::endl;
+  }
+
+  os << ind0 << "}" << std::endl;
+}
+
+static void WriteOptLevel(std::ostream &os, const std::optional<int> &level) {
+  if (level) {
+    os << *level;
+  } else {
+    os << "null";
+  }
+}
+
+void TWebRequestHandler::HandleCompressionStatsRequestPlain(std::ostream &os,
+    const TCompressionStats &stats) {
+  std::vector<TCompressionStats::TTopicInfo> topic_info = stats.GetTopicInfo();
+  uint64_t now = GetEpochSeconds();
+  char now_time_buf[TIME_BUF_SIZE];
+  FillTimeBuf(now, now_time_buf);
+  time_t start_time = GetServerStartTime();
+  char start_time_buf[TIME_BUF_SIZE];
+  FillTimeBuf(start_time, start_time_buf);
+  os << "pid: " << getpid() << std::endl
+      << "version: " << dory_build_id << std::endl
+      << "since: " << start_time << " " << start_time_buf << std::endl
+      << "now: " << now << " " << now_time_buf << std::endl << std::endl;
+
+  for (const auto &item : topic_info) {
+    os << "topic: [" << item.Topic << "] broker: " << item.BrokerId
+        << " type: " << Compress::ToString(item.Type) << " level: ";
+    WriteOptLevel(os, item.Level);
+    os << " configured level: ";
+    WriteOptLevel(os, item.ConfiguredLevel);
+    os << std::endl << "    state: " << item.State << "  ratio: "
+        << item.AvgRatio << "  ns/byte: " << item.AvgNsPerByte
+        << "  samples: " << item.SampleCount << std::endl
+        << "    compressed: " << item.CompressedCount
+        << "  not compressible: " << item.NotCompressibleCount
+        << "  skipped: " << item.SkippedCount
+        << "  updated: " << item.UpdateTime << std::endl;
+  }
+}
+
+void TWebRequestHandler::HandleCompressionStatsRequestJson(std::ostream &os,
+    const TCompressionStats &stats) {
+  std::vector<TCompressionStats::TTopicInfo> topic_info = stats.GetTopicInfo();
+  uint64_t now = GetEpochSeconds();
+  time_t start_time = GetServerStartTime();
+  std::string indent_str;
+  TIndent ind0(indent_str, TIndent::StartAt::Zero, 4);
+  os << ind0 << "{" << std::endl;
+
+  {
+    TIndent ind1(ind0);
+    os << ind1 << "\"pid\": " << getpid() << "," << std::endl
+        << ind1 << "\"version\": \"" << dory_build_id << "\"," << std::endl
+        << ind1 << "\"since\": " << start_time << "," << std::endl
+        << ind1 << "\"now\": " << now << "," << std::endl
+        << ind1 << "\"topics\": [";
+
+    {
+      TIndent ind2(ind1);
+      bool first_time = true;
+
+      for (const auto &item : topic_info) {
+        if (!first_time) {
+          os << ",";
+        }
+
+        os << std::endl << ind2 << "{" << std::endl;
+
+        {
+          TIndent ind3(ind2);
+          os << ind3 << "\"topic\": \"" << item.Topic << "\"," << std::endl
+              << ind3 << "\"broker_id\": " << item.BrokerId << ","
+              << std::endl
+              << ind3 << "\"type\": \"" << Compress::ToString(item.Type)
+              << "\"," << std::endl
+              << ind3 << "\"level\": ";
+          WriteOptLevel(os, item.Level);
+          os << "," << std::endl << ind3 << "\"configured_level\": ";
+          WriteOptLevel(os, item.ConfiguredLevel);
+          os << "," << std::endl
+              << ind3 << "\"state\": \"" << item.State << "\"," << std::endl
+              << ind3 << "\"avg_ratio\": " << item.AvgRatio << ","
+              << std::endl
+              << ind3 << "\"avg_ns_per_byte\": " << item.AvgNsPerByte << ","
+              << std::endl
+              << ind3 << "\"samples\": " << item.SampleCount << ","
+              << std::endl
+              << ind3 << "\"compressed\": " << item.CompressedCount << ","
+              << std::endl
+              << ind3 << "\"not_compressible\": "
+              << item.NotCompressibleCount << "," << std::endl
+              << ind3 << "\"skipped\": " << item.SkippedCount << ","
+              << std::endl
+              << ind3 << "\"updated\": " << item.UpdateTime << std::endl;
+        }
+
+        os << ind2 << "}";
+        first_time = false;
+      }
+
+      if (!topic_info.empty()) {
+        os << std::endl << ind1;
+      }
+    }
+
+    os << "]" << std::endl;
+  }
+
+  os << ind0 << "}" << std::endl;
+}
+
+void TWebRequestHandler::HandleLingerStatsRequestPlain(std::ostream &os,
+    const TLingerStats &stats) {
+  std::vector<TLingerStats::TTopicInfo> topic_info = stats.GetTopicInfo();
+  uint64_t now = GetEpochSeconds();
+  char now_time_buf[TIME_BUF_SIZE];
+  FillTimeBuf(now, now_time_buf);
+  time_t start_time = GetServerStartTime();
+  char start_time_buf[TIME_BUF_SIZE];
+  FillTimeBuf(start_time, start_time_buf);
+  os << "pid: " << getpid() << std::endl
+      << "version: " << dory_build_id << std::endl
+      << "since: " << start_time << " " << start_time_buf << std::endl
+      << "now: " << now << " " << now_time_buf << std::endl << std::endl;
+
+  for (const auto &item : topic_info) {
+    if (item.Topic.empty()) {
+      os << "combined topics";
+    } else {
+      os << "topic: [" << item.Topic << "]";
+    }
+
+    os << " broker: ";
+
+    if (item.BrokerId.has_value()) {
+      os << *item.BrokerId;
+    } else {
+      os << "router";
+    }
+
+    os << " time limit: " << item.TimeLimit << std::endl
+        << "    min: " << item.MinTimeLimit << "  max: " << item.MaxTimeLimit
+        << "  target bytes: " << item.TargetBytes << std::endl
+        << "    bytes/sec: " << item.ByteRate << "  ack latency: "
+        << item.AckLatency << "  updated: " << item.UpdateTime << std::endl;
+  }
+}
+
+void TWebRequestHandler::HandleLingerStatsRequestJson(std::ostream &os,
+    const TLingerStats &stats) {
+  std::vector<TLingerStats::TTopicInfo> topic_info = stats.GetTopicInfo();
+  uint64_t now = GetEpochSeconds();
+  time_t start_time = GetServerStartTime();
+  std::string indent_str;
+  TIndent ind0(indent_str, TIndent::StartAt::Zero, 4);
+  os << ind0 << "{" << std::endl;
+
+  {
+    TIndent ind1(ind0);
+    os << ind1 << "\"pid\": " << getpid() << "," << std::endl
+        << ind1 << "\"version\": \"" << dory_build_id << "\"," << std::endl
+        << ind1 << "\"since\": " << start_time << "," << std::endl
+        << ind1 << "\"now\": " << now << "," << std::endl
+        << ind1 << "\"topics\": [";
+
+    {
+      TIndent ind2(ind1);
+      bool first_time = true;
+
+      for (const auto &item : topic_info) {
+        if (!first_time) {
+          os << ",";
+        }
+
+        os << std::endl << ind2 << "{" << std::endl;
+
+        {
+          TIndent ind3(ind2);
+          os << ind3 << "\"topic\": \"" << item.Topic << "\"," << std::endl
+              << ind3 << "\"combined_topics\": "
+              << (item.Topic.empty() ? "true" : "false") << "," << std::endl
+              << ind3 << "\"broker_id\": ";
+
+          if (item.BrokerId.has_value()) {
+            os << *item.BrokerId;
+          } else {
+            os << "null";
+          }
+
+          os << "," << std::endl
+              << ind3 << "\"time_limit\": " << item.TimeLimit << ","
+              << std::endl
+              << ind3 << "\"min_time_limit\": " << item.MinTimeLimit << ","
+              << std::endl
+              << ind3 << "\"max_time_limit\": " << item.MaxTimeLimit << ","
+              << std::endl
+              << ind3 << "\"target_bytes\": " << item.TargetBytes << ","
+              << std::endl
+              << ind3 << "\"bytes_per_sec\": " << item.ByteRate << ","
+              << std::endl
+              << ind3 << "\"ack_latency\": " << item.AckLatency << ","
+              << std::endl
+              << ind3 << "\"updated\": " << item.UpdateTime << std::endl;
+        }
+
+        os << ind2 << "}";
+        first_time = false;
+      }
+
+      if (!topic_info.empty()) {
+        os << std::endl << ind1;
+      }
+    }
+
+    os << "]" << std::endl;
+  }
+
+  os << ind0 << "}" << std::endl;
+}
+
+static void WriteLatencySummaryPlain(std::ostream &os,
+    const Util::TLatencySnapshot &snapshot) {
+  os << "    count: " << snapshot.GetCount() << "  mean: "
+      << static_cast<uint64_t>(snapshot.GetMean() + 0.5) << "  p50: "
+      << snapshot.GetPercentile(50.0) << "  p90: "
+      << snapshot.GetPercentile(90.0) << "  p99: "
+      << snapshot.GetPercentile(99.0) << "  p99.9: "
+      << snapshot.GetPercentile(99.9) << "  max: " << snapshot.GetMax()
+      << std::endl;
+}
+
+void TWebRequestHandler::HandleLatencyStatsRequestPlain(std::ostream &os,
+    const TLatencyStats &stats) {
+  std::vector<std::pair<TLatencyStats::TStage, Util::TLatencySnapshot>>
+      stages = stats.GetStageSnapshots();
+  std::vector<std::pair<long, Util::TLatencySnapshot>> brokers =
+      stats.GetBrokerRttSnapshots();
+  uint64_t now = GetEpochSeconds();
+  char now_time_buf[TIME_BUF_SIZE];
+  FillTimeBuf(now, now_time_buf);
+  time_t start_time = GetServerStartTime();
+  char start_time_buf[TIME_BUF_SIZE];
+  FillTimeBuf(start_time, start_time_buf);
+  os << "pid: " << getpid() << std::endl
+      << "version: " << dory_build_id << std::endl
+      << "since: " << start_time << " " << start_time_buf << std::endl
+      << "now: " << now << " " << now_time_buf << std::endl
+      << "units: microseconds" << std::endl << std::endl;
+
+  for (const auto &item : stages) {
+    os << "message state: " << TLatencyStats::ToString(item.first)
+        << std::endl;
+    WriteLatencySummaryPlain(os, item.second);
+  }
+
+  for (const auto &item : brokers) {
+    os << "produce request round trip: broker " << item.first << std::endl;
+    WriteLatencySummaryPlain(os, item.second);
+  }
+}
+
+static void WriteLatencySummaryJson(std::ostream &os,
+    const Util::TLatencySnapshot &snapshot, TIndent &ind) {
+  os << ind << "\"count\": " << snapshot.GetCount() << "," << std::endl
+      << ind << "\"mean\": "
+      << static_cast<uint64_t>(snapshot.GetMean() + 0.5) << "," << std::endl
+      << ind << "\"p50\": " << snapshot.GetPercentile(50.0) << ","
+      << std::endl
+      << ind << "\"p90\": " << snapshot.GetPercentile(90.0) << ","
+      << std::endl
+      << ind << "\"p99\": " << snapshot.GetPercentile(99.0) << ","
+      << std::endl
+      << ind << "\"p999\": " << snapshot.GetPercentile(99.9) << ","
+      << std::endl
+      << ind << "\"max\": " << snapshot.GetMax() << std::endl;
+}
+
+void TWebRequestHandler::HandleLatencyStatsRequestJson(std::ostream &os,
+    const TLatencyStats &stats) {
+  std::vector<std::pair<TLatencyStats::TStage, Util::TLatencySnapshot>>
+      stages = stats.GetStageSnapshots();
+  std::vector<std::pair<long, Util::TLatencySnapshot>> brokers =
+      stats.GetBrokerRttSnapshots();
+  uint64_t now = GetEpochSeconds();
+  time_t start_time = GetServerStartTime();
+  std::string indent_str;
+  TIndent ind0(indent_str, TIndent::StartAt::Zero, 4);
+  os << ind0 << "{" << std::endl;
+
+  {
+    TIndent ind1(ind0);
+    os << ind1 << "\"pid\": " << getpid() << "," << std::endl
+        << ind1 << "\"version\": \"" << dory_build_id << "\"," << std::endl
+        << ind1 << "\"since\": " << start_time << "," << std::endl
+        << ind1 << "\"now\": " << now << "," << std::endl
+        << ind1 << "\"units\": \"microseconds\"," << std::endl
+        << ind1 << "\"msg_states\": [";
+
+    {
+      TIndent ind2(ind1);
+      bool first_time = true;
+
+      for (const auto &item : stages) {
+        if (!first_time) {
+          os << ",";
+        }
+
+        os << std::endl << ind2 << "{" << std::endl;
+
+        {
+          TIndent ind3(ind2);
+          os << ind3 << "\"state\": \"" << TLatencyStats::ToString(item.first)
+              << "\"," << std::endl;
+          WriteLatencySummaryJson(os, item.second, ind3);
+        }
+
+        os << ind2 << "}";
+        first_time = false;
+      }
+
+      if (!stages.empty()) {
+        os << std::endl << ind1;
+      }
+    }
+
+    os << "]," << std::endl
+        << ind1 << "\"produce_rtt\": [";
+
+    {
+      TIndent ind2(ind1);
+      bool first_time = true;
+
+      for (const auto &item : brokers) {
+        if (!first_time) {
+          os << ",";
+        }
+
+        os << std::endl << ind2 << "{" << std::endl;
+
+        {
+          TIndent ind3(ind2);
+          os << ind3 << "\"broker_id\": " << item.first << "," << std::endl;
+          WriteLatencySummaryJson(os, item.second, ind3);
+        }
+
+        os << ind2 << "}";
+        first_time = false;
+      }
+
+      if (!brokers.empty()) {
+        os << std::endl << ind1;
+      }
+    }
+
+    os << "]" << std::endl;
+  }
+
+  os << ind0 << "}" << std::endl;
+}
+
+void TWebRequestHandler::HandleTracesRequestJson(std::ostream &os,
+    const TMsgTracer &tracer) {
+  std::vector<TMsgTracer::TTraceRecord> traces = tracer.GetTraces();
+  uint64_t now = GetEpochSeconds();
+  time_t start_time = GetServerStartTime();
+  std::string indent_str;
+  TIndent ind0(indent_str, TIndent::StartAt::Zero, 4);
+  os << ind0 << "{" << std::endl;
+
+  {
+    TIndent ind1(ind0);
+    os << ind1 << "\"pid\": " << getpid() << "," << std::endl
+        << ind1 << "\"version\": \"" << dory_build_id << "\"," << std::endl
+        << ind1 << "\"since\": " << start_time << "," << std::endl
+        << ind1 << "\"now\": " << now << "," << std::endl
+        << ind1 << "\"sample_interval\": " << tracer.GetSampleInterval()
+        << "," << std::endl
+        << ind1 << "\"units\": \"microseconds\"," << std::endl
+        << ind1 << "\"traces\": [";
+
+    {
+      TIndent ind2(ind1);
+      bool first_time = true;
+
+      for (const TMsgTracer::TTraceRecord &item : traces) {
+        if (!first_time) {
+          os << ",";
+        }
+
+        /* Stage times are relative to when the message was received.  -1
+           indicates that the message skipped the stage, as happens for
+           instance when it is discarded before being sent. */
+        auto rel = [&item](uint64_t t) {
+          return t ? static_cast<int64_t>(t - item.ReceivedUsec) : -1;
+        };
+
+        os << std::endl << ind2 << "{" << std::endl;
+
+        {
+          TIndent ind3(ind2);
+          os << ind3 << "\"id\": " << item.Id << "," << std::endl
+              << ind3 << "\"topic\": \"" << item.Topic << "\"," << std::endl
+              << ind3 << "\"partition\": " << item.Partition << ","
+              << std::endl
+              << ind3 << "\"key_size\": " << item.KeySize << "," << std::endl
+              << ind3 << "\"value_size\": " << item.ValueSize << ","
+              << std::endl
+              << ind3 << "\"timestamp\": " << item.Timestamp << ","
+              << std::endl
+              << ind3 << "\"failed_delivery_attempts\": "
+              << item.FailedDeliveryAttemptCount << "," << std::endl
+              << ind3 << "\"received\": 0," << std::endl
+              << ind3 << "\"batched\": " << rel(item.BatchedUsec) << ","
+              << std::endl
+              << ind3 << "\"dispatched\": " << rel(item.DispatchedUsec)
+              << "," << std::endl
+              << ind3 << "\"sent\": " << rel(item.SentUsec) << ","
+              << std::endl
+              << ind3 << "\"processed\": " << rel(item.ProcessedUsec)
+              << std::endl;
+        }
+
+        os << ind2 << "}";
+        first_time = false;
+      }
+
+      if (!traces.empty()) {
+        os << std::endl << ind1;
+      }
+    }
+
+    os << "]" << std::endl;
+  }
+
+  os << ind0 << "}" << std::endl;
+}
+
+void TWebRequestHandler::HandleMemoryStatsRequestPlain(std::ostream &os,
+    const TMemoryTelemetry &telemetry) {
+  const TMemoryTelemetry::TSnapshot snapshot = telemetry.GetSnapshot();
+  char now_time_buf[TIME_BUF_SIZE];
+  FillTimeBuf(static_cast<time_t>(snapshot.Time), now_time_buf);
+  time_t start_time = GetServerStartTime();
+  char start_time_buf[TIME_BUF_SIZE];
+  FillTimeBuf(start_time, start_time_buf);
+  os << "pid: " << getpid() << std::endl
+      << "version: " << dory_build_id << std::endl
+      << "since: " << start_time << " " << start_time_buf << std::endl
+      << "now: " << snapshot.Time << " " << now_time_buf << std::endl
+      << std::endl << std::fixed << std::setprecision(1)
+      << "pool block size: " << snapshot.BlockSize << std::endl
+      << "pool blocks: " << snapshot.BlockCount << std::endl
+      << "pool blocks allocated: " << snapshot.AllocatedBlockCount << " ("
+      << snapshot.GetUsedPercent() << "%)" << std::endl
+      << "pool blocks allocated peak: " << snapshot.PeakAllocatedBlockCount
+      << std::endl
+      << "pool block allocations: " << snapshot.TotalAllocCount << std::endl
+      << "pool allocation failures: " << snapshot.AllocFailureCount
+      << std::endl
+      << "pool allocation rate: " << snapshot.AllocRate << " blocks/s"
+      << std::endl
+      << "pool fragmentation: " << snapshot.GetFragmentationPercent() << "%"
+      << std::endl
+      << "estimated message overhead bytes: "
+      << snapshot.GetMsgOverheadBytes() << std::endl << std::endl;
+
+  for (const auto &item : snapshot.Topics) {
+    const TMsgStateTracker::TTopicStats &stats = item.second;
+    os << "batch: " << std::setw(12) << stats.BatchingBytes
+        << "  send_wait: " << std::setw(12) << stats.SendWaitBytes
+        << "  ack_wait: " << std::setw(12) << stats.AckWaitBytes
+        << "  topic: [" << item.first << "]" << std::endl;
+  }
+
+  if (!snapshot.Topics.empty()) {
+    os << std::endl;
+  }
+
+  auto write_state = [&os](const TMemoryTelemetry::TStateUsage &usage,
+      const char *name) {
+    os << std::setw(12) << usage.Bytes << " bytes in " << std::setw(10)
+        << usage.MsgCount << " msgs " << name << std::endl;
+  };
+  write_state(snapshot.New, "total new");
+  write_state(snapshot.Batching, "total batch");
+  write_state(snapshot.SendWait, "total send_wait");
+  write_state(snapshot.AckWait, "total ack_wait");
+  os << std::setw(12) << snapshot.GetPayloadBytes() << " bytes in "
+      << std::setw(10) << snapshot.GetMsgCount()
+      << " msgs total (all states: new + batch + send_wait + ack_wait)"
+      << std::endl;
+}
+
+static void WriteStateUsageJson(std::ostream &os, const char *name,
+    const TMemoryTelemetry::TStateUsage &usage, TIndent &ind) {
+  os << ind << "\"" << name << "\": { \"msgs\": " << usage.MsgCount
+      << ", \"bytes\": " << usage.Bytes << " }";
+}
+
+void TWebRequestHandler::HandleMemoryStatsRequestJson(std::ostream &os,
+    const TMemoryTelemetry &telemetry) {
+  const TMemoryTelemetry::TSnapshot snapshot = telemetry.GetSnapshot();
+  time_t start_time = GetServerStartTime();
+  std::string indent_str;
+  TIndent ind0(indent_str, TIndent::StartAt::Zero, 4);
+  os << ind0 << "{" << std::endl;
+
+  {
+    TIndent ind1(ind0);
+    os << ind1 << "\"pid\": " << getpid() << "," << std::endl
+        << ind1 << "\"version\": \"" << dory_build_id << "\"," << std::endl
+        << ind1 << "\"since\": " << start_time << "," << std::endl
+        << ind1 << "\"now\": " << snapshot.Time << "," << std::endl
+        << ind1 << "\"pool\": {" << std::endl;
+
+    {
+      TIndent ind2(ind1);
+      os << ind2 << "\"block_size\": " << snapshot.BlockSize << ","
+          << std::endl
+          << ind2 << "\"blocks\": " << snapshot.BlockCount << "," << std::endl
+          << ind2 << "\"allocated\": " << snapshot.AllocatedBlockCount << ","
+          << std::endl
+          << ind2 << "\"allocated_peak\": "
+          << snapshot.PeakAllocatedBlockCount << "," << std::endl
+          << ind2 << "\"allocations\": " << snapshot.TotalAllocCount << ","
+          << std::endl
+          << ind2 << "\"allocation_failures\": " << snapshot.AllocFailureCount
+          << "," << std::endl
+          << ind2 << "\"allocation_rate\": " << snapshot.AllocRate << ","
+          << std::endl
+          << ind2 << "\"fragmentation_percent\": "
+          << snapshot.GetFragmentationPercent() << std::endl;
+    }
+
+    os << ind1 << "}," << std::endl
+        << ind1 << "\"estimated_msg_overhead_bytes\": "
+        << snapshot.GetMsgOverheadBytes() << "," << std::endl;
+    WriteStateUsageJson(os, "new", snapshot.New, ind1);
+    os << "," << std::endl;
+    WriteStateUsageJson(os, "batch", snapshot.Batching, ind1);
+    os << "," << std::endl;
+    WriteStateUsageJson(os, "send_wait", snapshot.SendWait, ind1);
+    os << "," << std::endl;
+    WriteStateUsageJson(os, "ack_wait", snapshot.AckWait, ind1);
+    os << "," << std::endl << ind1 << "\"topics\": [";
+
+    {
+      TIndent ind2(ind1);
+      bool first_time = true;
+
+      for (const auto &item : snapshot.Topics) {
+        if (!first_time) {
+          os << ",";
+        }
+
+        const TMsgStateTracker::TTopicStats &stats = item.second;
+        os << std::endl << ind2 << "{" << std::endl;
+
+        {
+          TIndent ind3(ind2);
+          os << ind3 << "\"topic\": \"" << item.first << "\"," << std::endl
+              << ind3 << "\"batch_bytes\": " << stats.BatchingBytes << ","
+              << std::endl
+              << ind3 << "\"send_wait_bytes\": " << stats.SendWaitBytes << ","
+              << std::endl
+              << ind3 << "\"ack_wait_bytes\": " << stats.AckWaitBytes
+              << std::endl;
+        }
+
+        os << ind2 << "}";
+        first_time = false;
+      }
+
+      if (!snapshot.Topics.empty()) {
+        os << std::endl << ind1;
+      }
+    }
+
+    os << "]" << std::endl;
+  }
+
+  os << ind0 << "}" << std::endl;
+}
+
+void TWebRequestHandler::HandleProfileRequestJson(std::ostream &os,
+    const TProfiler &profiler) {
+  std::vector<TProfiler::TThreadSnapshot> threads = profiler.GetSnapshots();
+  uint64_t now = GetEpochSeconds();
+  time_t start_time = GetServerStartTime();
+  std::string indent_str;
+  TIndent ind0(indent_str, TIndent::StartAt::Zero, 4);
+  os << ind0 << "{" << std::endl;
+
+  {
+    TIndent ind1(ind0);
+    os << ind1 << "\"pid\": " << getpid() << "," << std::endl
+        << ind1 << "\"version\": \"" << dory_build_id << "\"," << std::endl
+        << ind1 << "\"since\": " << start_time << "," << std::endl
+        << ind1 << "\"now\": " << now << "," << std::endl
+        << ind1 << "\"enabled\": "
+        << (profiler.IsEnabled() ? "true" : "false") << "," << std::endl
+        << ind1 << "\"units\": \"nanoseconds\"," << std::endl
+        << ind1 << "\"threads\": [";
+
+    {
+      TIndent ind2(ind1);
+      bool first_time = true;
+
+      for (const TProfiler::TThreadSnapshot &item : threads) {
+        if (!first_time) {
+          os << ",";
+        }
+
+        os << std::endl << ind2 << "{" << std::endl;
+
+        {
+          TIndent ind3(ind2);
+          os << ind3 << "\"name\": \"" << item.Name << "\"," << std::endl
+              << ind3 << "\"running\": "
+              << (item.Running ? "true" : "false") << "," << std::endl
+              << ind3 << "\"cpu\": " << item.CpuNsec << "," << std::endl
+              << ind3 << "\"busy\": " << item.GetBusyNsec() << ","
+              << std::endl
+              << ind3 << "\"phases\": [";
+
+          {
+            TIndent ind4(ind3);
+            bool first_phase = true;
+
+            /* Omit phases the thread has never entered, such as connector
+               phases for the router thread. */
+            for (size_t i = 0; i < TProfiler::PHASE_COUNT; ++i) {
+              const TProfiler::TPhaseTotals &totals = item.Phases[i];
+
+              if (totals.Count == 0) {
+                continue;
+              }
+
+              if (!first_phase) {
+                os << ",";
+              }
+
+              os << std::endl << ind4 << "{ \"phase\": \""
+                  << TProfiler::ToString(static_cast<TProfiler::TPhase>(i))
+                  << "\", \"time\": " << totals.Nsec << ", \"count\": "
+                  << totals.Count << " }";
+              first_phase = false;
+            }
+
+            if (!first_phase) {
+              os << std::endl << ind3;
+            }
+          }
+
+          os << "]" << std::endl;
+        }
+
+        os << ind2 << "}";
+        first_time = false;
+      }
+
+      if (!threads.empty()) {
+        os << std::endl << ind1;
+      }
+    }
+
+    os << "]" << std::endl;
+  }
+
+  os << ind0 << "}" << std::endl;
+}
+
 void TWebRequestHandler::HandleGetDebugTopicsRequest(std::ostream &os,
     const Debug::TDebugSetup &debug_setup) {
   std::shared_ptr<TDebugSetup::TSettings> settings = debug_setup.GetSettings();
@@ -27,9 +27,16 @@
 #include <base/indent.h>
 #include <base/no_copy_semantics.h>
 #include <dory/anomaly_tracker.h>
+#include <dory/api_version_stats.h>
+#include <dory/compression_stats.h>
 #include <dory/debug/debug_setup.h>
+#include <dory/latency_stats.h>
+#include <dory/linger_stats.h>
+#include <dory/memory_telemetry.h>
 #include <dory/metadata_timestamp.h>
 #include <dory/msg_state_tracker.h>
+#include <dory/msg_tracer.h>
+#include <dory/profiler.h>
 
 namespace Dory {
 
@@ -65,6 +72,41 @@ namespace Dory {
     void HandleQueueStatsRequestJson(std::ostream &os,
         const TMsgStateTracker &tracker);
 
+    void HandleApiVersionsRequestPlain(std::ostream &os,
+        const TApiVersionStats &stats);
+
+    void HandleApiVersionsRequestJson(std::ostream &os,
+        const TApiVersionStats &stats);
+
+    void HandleCompressionStatsRequestPlain(std::ostream &os,
+        const TCompressionStats &stats);
+
+    void HandleCompressionStatsRequestJson(std::ostream &os,
+        const TCompressionStats &stats);
+
+    void HandleLingerStatsRequestPlain(std::ostream &os,
+        const TLingerStats &stats);
+
+    void HandleLingerStatsRequestJson(std::ostream &os,
+        const TLingerStats &stats);
+
+    void HandleLatencyStatsRequestPlain(std::ostream &os,
+        const TLatencyStats &stats);
+
+    void HandleLatencyStatsRequestJson(std::ostream &os,
+        const TLatencyStats &stats);
+
+    void HandleTracesRequestJson(std::ostream &os, const TMsgTracer &tracer);
+
+    void HandleMemoryStatsRequestPlain(std::ostream &os,
+        const TMemoryTelemetry &telemetry);
+
+    void HandleMemoryStatsRequestJson(std::ostream &os,
+        const TMemoryTelemetry &telemetry);
+
+    void HandleProfileRequestJson(std::ostream &os,
+        const TProfiler &profiler);
+
     void HandleGetDebugTopicsRequest(std::ostream &os,
         const Debug::TDebugSetup &debug_setup);
 
@@ -0,0 +1,309 @@
+/* <log/async_log_sink.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Implements <log/async_log_sink.h>.
+ */
+
+#include <log/async_log_sink.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <new>
+#include <utility>
+
+#include <base/counter.h>
+#include <base/wr/fd_util.h>
+
+using namespace Base;
+using namespace Log;
+
+DEFINE_COUNTER(AsyncLogSinkBytesDropped);
+DEFINE_COUNTER(AsyncLogSinkDropBufferFull);
+DEFINE_COUNTER(AsyncLogSinkDropNoMem);
+DEFINE_COUNTER(AsyncLogSinkFlusherWakeup);
+DEFINE_COUNTER(AsyncLogSinkWrite);
+DEFINE_COUNTER(AsyncLogSinkWriteError);
+
+/* Sink IDs start at 1, so a thread local holder with ID 0 has no buffer. */
+std::atomic<uint64_t> TAsyncLogSink::NextId{1};
+
+void TAsyncLogSink::TThreadBufferHolder::Reset() noexcept {
+  if (Buffer) {
+    Buffer->Retired.store(true, std::memory_order_release);
+    Buffer.reset();
+  }
+
+  SinkId = 0;
+}
+
+TAsyncLogSink::TAsyncLogSink()
+    : Id(NextId.fetch_add(1, std::memory_order_relaxed)) {
+}
+
+TAsyncLogSink::~TAsyncLogSink() {
+  Stop();
+}
+
+void TAsyncLogSink::Start(size_t thread_buffer_size,
+    size_t flush_interval_ms) {
+  assert(!Flusher.joinable());
+  ThreadBufferSize = thread_buffer_size;
+  FlushIntervalMs = std::max<size_t>(flush_interval_ms, 1);
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    StopRequested = false;
+  }
+
+  Flusher = std::thread(&TAsyncLogSink::Run, this);
+  Running.store(true, std::memory_order_release);
+}
+
+void TAsyncLogSink::Stop() {
+  if (!Flusher.joinable()) {
+    return;
+  }
+
+  Running.store(false, std::memory_order_release);
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    StopRequested = true;
+  }
+
+  WakeCond.notify_one();
+  Flusher.join();
+
+  /* Pick up anything written by a thread that saw the sink running just
+     before we stopped it.  Write() checks 'Running' again while holding its
+     buffer's mutex, so once WriteAll() has taken a buffer's mutex below, its
+     owner either already buffered its data or will write it directly.  A
+     thread whose buffer WriteAll() doesn't see registers it after we cleared
+     'Running', so it also writes directly. */
+  WriteAll();
+}
+
+bool TAsyncLogSink::Write(int fd, const std::shared_ptr<const void> &fd_owner,
+    const char *data, size_t size) noexcept {
+  if (!IsRunning() || (size > ThreadBufferSize)) {
+    return false;
+  }
+
+  bool wake = false;
+
+  try {
+    TThreadBuffer &buf = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(buf.Mutex);
+
+    /* Stop() may have made its final pass over the buffers since we checked
+       above.  In that case, data we buffered now would never be written. */
+    if (!IsRunning()) {
+      return false;
+    }
+
+    if ((buf.Size + size) > ThreadBufferSize) {
+      AsyncLogSinkDropBufferFull.Increment();
+      AsyncLogSinkBytesDropped.Increment(size);
+      return true;
+    }
+
+    if (buf.Chunks.empty() || (buf.Chunks.back().Fd != fd) ||
+        (buf.Chunks.back().FdOwner != fd_owner)) {
+      buf.Chunks.emplace_back();
+      buf.Chunks.back().Fd = fd;
+      buf.Chunks.back().FdOwner = fd_owner;
+    }
+
+    buf.Chunks.back().Data.append(data, size);
+
+    /* Wake the background thread early when the buffer gets half full, so a
+       burst of logging doesn't fill it. */
+    const size_t half = ThreadBufferSize / 2;
+    wake = (buf.Size < half) && ((buf.Size + size) >= half);
+    buf.Size += size;
+  } catch (const std::bad_alloc &) {
+    AsyncLogSinkDropNoMem.Increment();
+    AsyncLogSinkBytesDropped.Increment(size);
+    return true;
+  }
+
+  if (wake) {
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      WakeRequested = true;
+    }
+
+    WakeCond.notify_one();
+  }
+
+  return true;
+}
+
+void TAsyncLogSink::Flush() noexcept {
+  if (!IsRunning()) {
+    return;
+  }
+
+  std::unique_lock<std::mutex> lock(Mutex);
+  const uint64_t target = ++FlushRequested;
+  WakeCond.notify_one();
+
+  /* Don't wait forever, since we may be called on the way to a crash. */
+  FlushDoneCond.wait_for(lock, std::chrono::seconds(1),
+      [this, target]() noexcept {
+        return (FlushDone >= target) || StopRequested;
+      });
+}
+
+void TAsyncLogSink::WriteChunk(const TChunk &chunk) noexcept {
+  const char *pos = chunk.Data.data();
+  size_t remaining = chunk.Data.size();
+
+  while (remaining) {
+    const ssize_t ret = Wr::write(chunk.Fd, pos, remaining);
+
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+
+      AsyncLogSinkWriteError.Increment();
+      return;
+    }
+
+    if (ret == 0) {
+      AsyncLogSinkWriteError.Increment();
+      return;
+    }
+
+    pos += ret;
+    remaining -= static_cast<size_t>(ret);
+  }
+
+  AsyncLogSinkWrite.Increment();
+}
+
+TAsyncLogSink::TThreadBuffer &TAsyncLogSink::GetThreadBuffer() {
+  static thread_local TThreadBufferHolder holder;
+
+  if (holder.SinkId != Id) {
+    /* First use of this sink by the calling thread, or the thread last used a
+       different sink (only in tests). */
+    holder.Reset();
+    auto buf = std::make_shared<TThreadBuffer>();
+
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      ThreadBuffers.push_back(buf);
+    }
+
+    holder.Buffer = std::move(buf);
+    holder.SinkId = Id;
+  }
+
+  return *holder.Buffer;
+}
+
+void TAsyncLogSink::WriteAll() {
+  std::vector<std::shared_ptr<TThreadBuffer>> buffers;
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+    buffers = ThreadBuffers;
+  }
+
+  std::vector<TChunk> chunks;
+  bool found_retired = false;
+
+  for (const auto &buf : buffers) {
+    /* Check this before taking the chunks.  Once a thread has exited, it
+       appends nothing more, so its buffer can be forgotten after this. */
+    const bool retired = buf->Retired.load(std::memory_order_acquire);
+
+    {
+      std::lock_guard<std::mutex> lock(buf->Mutex);
+      chunks.swap(buf->Chunks);
+      buf->Size = 0;
+    }
+
+    for (const TChunk &chunk : chunks) {
+      WriteChunk(chunk);
+    }
+
+    chunks.clear();
+    found_retired = found_retired || retired;
+  }
+
+  if (found_retired) {
+    std::lock_guard<std::mutex> lock(Mutex);
+    ThreadBuffers.erase(std::remove_if(ThreadBuffers.begin(),
+        ThreadBuffers.end(),
+        [](const std::shared_ptr<TThreadBuffer> &buf) noexcept {
+          return buf->Retired.load(std::memory_order_acquire) &&
+              (buf->Size == 0);
+        }), ThreadBuffers.end());
+  }
+}
+
+void TAsyncLogSink::Run() {
+  const auto interval = std::chrono::milliseconds(FlushIntervalMs);
+
+  for (; ; ) {
+    uint64_t flush_target = 0;
+    bool stop = false;
+
+    {
+      std::unique_lock<std::mutex> lock(Mutex);
+      WakeCond.wait_for(lock, interval,
+          [this]() noexcept {
+            return WakeRequested || StopRequested ||
+                (FlushRequested != FlushDone);
+          });
+
+      if (WakeRequested || (FlushRequested != FlushDone)) {
+        AsyncLogSinkFlusherWakeup.Increment();
+      }
+
+      WakeRequested = false;
+      stop = StopRequested;
+      flush_target = FlushRequested;
+    }
+
+    WriteAll();
+
+    {
+      std::lock_guard<std::mutex> lock(Mutex);
+      FlushDone = flush_target;
+    }
+
+    FlushDoneCond.notify_all();
+
+    if (stop) {
+      break;
+    }
+  }
+}
+
+TAsyncLogSink &Log::GetAsyncLogSink() noexcept {
+  /* Never destroyed, so threads can log safely during static destruction.
+     Such writes are done directly, since the sink isn't running then. */
+  static TAsyncLogSink *sink = new TAsyncLogSink;
+  return *sink;
+}
@@ -0,0 +1,173 @@
+/* <log/async_log_sink.h>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Asynchronous sink for data written to logfiles.  Logging threads append to
+   per-thread buffers, and a background thread writes the buffered data.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <base/no_copy_semantics.h>
+
+namespace Log {
+
+  class TAsyncLogSink final {
+    NO_COPY_SEMANTICS(TAsyncLogSink);
+
+    public:
+    /* Default maximum number of bytes buffered by a single thread. */
+    static const size_t DEFAULT_THREAD_BUFFER_SIZE = 256 * 1024;
+
+    /* Default maximum time in milliseconds that data stays buffered. */
+    static const size_t DEFAULT_FLUSH_INTERVAL_MS = 100;
+
+    TAsyncLogSink();
+
+    /* Calls Stop(). */
+    ~TAsyncLogSink();
+
+    bool IsRunning() const noexcept {
+      return Running.load(std::memory_order_acquire);
+    }
+
+    /* Start the background thread.  A thread that has
+       'thread_buffer_size' bytes buffered drops further writes until the
+       background thread catches up. */
+    void Start(size_t thread_buffer_size = DEFAULT_THREAD_BUFFER_SIZE,
+        size_t flush_interval_ms = DEFAULT_FLUSH_INTERVAL_MS);
+
+    /* Write all buffered data and stop the background thread.  Subsequent
+       calls to Write() return false until Start() is called again. */
+    void Stop();
+
+    /* Buffer 'size' bytes at 'data' to be written to 'fd'.  'fd_owner' keeps
+       'fd' open until the data is written.  Data written by a single thread to
+       a single file descriptor stays in order, but data from different
+       threads may be interleaved at entry boundaries.  Return false if the
+       sink is not running or 'size' exceeds the thread buffer size, in which
+       case the caller should write the data itself.  Otherwise return true,
+       even if the data was dropped because the calling thread's buffer is
+       full.  Failures to write buffered data are counted rather than
+       reported. */
+    bool Write(int fd, const std::shared_ptr<const void> &fd_owner,
+        const char *data, size_t size) noexcept;
+
+    /* Wait until all data buffered before the call is written.  Used for
+       urgent log entries, such as those written before a crash.  This blocks
+       the caller synchronously for up to 1 second, after which it gives up
+       and returns even if the data has not yet been written. */
+    void Flush() noexcept;
+
+    private:
+    /* Data for one file descriptor, buffered by one thread. */
+    struct TChunk {
+      int Fd = -1;
+
+      std::shared_ptr<const void> FdOwner;
+
+      std::string Data;
+    };  // TChunk
+
+    /* Data buffered by one thread. */
+    struct TThreadBuffer {
+      /* Protects 'Chunks' and 'Size'.  Contended only while the background
+         thread swaps out the chunks. */
+      std::mutex Mutex;
+
+      std::vector<TChunk> Chunks;
+
+      /* Total bytes in 'Chunks'. */
+      size_t Size = 0;
+
+      /* Set when the owning thread exits. */
+      std::atomic<bool> Retired{false};
+    };  // TThreadBuffer
+
+    /* Thread local pointer to the calling thread's buffer for the sink it
+       most recently used.  Marks the buffer retired on thread exit. */
+    struct TThreadBufferHolder {
+      uint64_t SinkId = 0;
+
+      std::shared_ptr<TThreadBuffer> Buffer;
+
+      void Reset() noexcept;
+
+      ~TThreadBufferHolder() {
+        Reset();
+      }
+    };  // TThreadBufferHolder
+
+    static void WriteChunk(const TChunk &chunk) noexcept;
+
+    TThreadBuffer &GetThreadBuffer();
+
+    /* Called by the background thread.  Write out all buffered data, and
+       forget buffers of threads that have exited. */
+    void WriteAll();
+
+    void Run();
+
+    static std::atomic<uint64_t> NextId;
+
+    const uint64_t Id;
+
+    std::atomic<bool> Running{false};
+
+    size_t ThreadBufferSize = DEFAULT_THREAD_BUFFER_SIZE;
+
+    size_t FlushIntervalMs = DEFAULT_FLUSH_INTERVAL_MS;
+
+    /* Protects 'ThreadBuffers' and the fields below it. */
+    std::mutex Mutex;
+
+    std::vector<std::shared_ptr<TThreadBuffer>> ThreadBuffers;
+
+    /* Signaled to wake the background thread. */
+    std::condition_variable WakeCond;
+
+    /* Signaled when the background thread finishes writing. */
+    std::condition_variable FlushDoneCond;
+
+    bool WakeRequested = false;
+
+    bool StopRequested = false;
+
+    /* Incremented by Flush().  The background thread sets 'FlushDone' to the
+       value it saw before it started writing. */
+    uint64_t FlushRequested = 0;
+
+    uint64_t FlushDone = 0;
+
+    std::thread Flusher;
+  };  // TAsyncLogSink
+
+  /* Sink shared by the application log and the debug logs.  It is not
+     running until someone calls Start(). */
+  TAsyncLogSink &GetAsyncLogSink() noexcept;
+
+}  // Log
@@ -0,0 +1,232 @@
+/* <log/async_log_sink.test.cc>
+
+   ----------------------------------------------------------------------------
+   Copyright 2026 Dave Peterson <dave@dspeterson.com>
+
+   Licensed under the Apache License, Version 2.0 (the "License");
+   you may not use this file except in compliance with the License.
+   You may obtain a copy of the License at
+
+     http://www.apache.org/licenses/LICENSE-2.0
+
+   Unless required by applicable law or agreed to in writing, software
+   distributed under the License is distributed on an "AS IS" BASIS,
+   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+   See the License for the specific language governing permissions and
+   limitations under the License.
+   ----------------------------------------------------------------------------
+
+   Unit tests for <log/async_log_sink.h>.
+ */
+
+#include <log/async_log_sink.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <base/error_util.h>
+#include <base/fd.h>
+#include <base/file_reader.h>
+#include <base/io_util.h>
+#include <base/tmp_file.h>
+
+#include <gtest/gtest.h>
+
+using namespace Base;
+using namespace Log;
+
+namespace {
+
+  /* The fixture for testing class TAsyncLogSink. */
+  class TAsyncLogSinkTest : public ::testing::Test {
+    protected:
+    TAsyncLogSinkTest() = default;
+
+    ~TAsyncLogSinkTest() override = default;
+
+    void SetUp() override {
+    }
+
+    void TearDown() override {
+    }
+  };  // TAsyncLogSinkTest
+
+  std::vector<std::string> SplitLines(const std::string &s) {
+    std::vector<std::string> result;
+    std::istringstream is(s);
+
+    for (std::string line; std::getline(is, line); ) {
+      result.push_back(line);
+    }
+
+    return result;
+  }
+
+  TEST_F(TAsyncLogSinkTest, NotRunning) {
+    TAsyncLogSink sink;
+    TTmpFile tmp_file("/tmp/async_log_sink_test.XXXXXX", true);
+    auto owner = std::make_shared<int>(0);
+    ASSERT_FALSE(sink.IsRunning());
+    ASSERT_FALSE(sink.Write(tmp_file.GetFd(), owner, "x\n", 2));
+
+    /* Data larger than a thread's buffer is left to the caller. */
+    sink.Start(4);
+    ASSERT_TRUE(sink.IsRunning());
+    ASSERT_FALSE(sink.Write(tmp_file.GetFd(), owner, "hello\n", 6));
+    ASSERT_TRUE(sink.Write(tmp_file.GetFd(), owner, "x\n", 2));
+    sink.Stop();
+    ASSERT_FALSE(sink.IsRunning());
+    ASSERT_FALSE(sink.Write(tmp_file.GetFd(), owner, "x\n", 2));
+    ASSERT_EQ(ReadFileIntoString(tmp_file.GetName()), "x\n");
+  }
+
+  TEST_F(TAsyncLogSinkTest, ManyThreads) {
+    const size_t thread_count = 4;
+    const size_t lines_per_thread = 2000;
+    TAsyncLogSink sink;
+    sink.Start(1024 * 1024, 10);
+    TTmpFile file_1("/tmp/async_log_sink_test.XXXXXX", true);
+    TTmpFile file_2("/tmp/async_log_sink_test.XXXXXX", true);
+    auto owner = std::make_shared<int>(0);
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < thread_count; ++i) {
+      threads.emplace_back(
+          [&sink, &file_1, &file_2, &owner, i] {
+            for (size_t j = 0; j < lines_per_thread; ++j) {
+              const std::string line = std::to_string(i) + " " +
+                  std::to_string(j) + "\n";
+              const TTmpFile &file = (j % 2) ? file_2 : file_1;
+              sink.Write(file.GetFd(), owner, line.data(), line.size());
+
+              if ((j % 500) == 0) {
+                sink.Flush();
+              }
+            }
+          });
+    }
+
+    for (auto &t : threads) {
+      t.join();
+    }
+
+    /* Buffers of exited threads are still written. */
+    sink.Stop();
+
+    for (const TTmpFile *file : {&file_1, &file_2}) {
+      const std::vector<std::string> lines =
+          SplitLines(ReadFileIntoString(file->GetName()));
+      ASSERT_EQ(lines.size(), thread_count * lines_per_thread / 2);
+      std::vector<long> last(thread_count, -1);
+
+      for (const std::string &line : lines) {
+        std::istringstream is(line);
+        size_t i = 0;
+        long j = 0;
+        is >> i >> j;
+        ASSERT_LT(i, thread_count);
+
+        /* Each thread's lines stay in order. */
+        ASSERT_GT(j, last[i]);
+        last[i] = j;
+      }
+    }
+  }
+
+  TEST_F(TAsyncLogSinkTest, StopWhileWriting) {
+    const size_t thread_count = 4;
+    const size_t lines_per_thread = 20000;
+    TAsyncLogSink sink;
+    sink.Start(1024 * 1024, 10);
+    TTmpFile tmp_file("/tmp/async_log_sink_test.XXXXXX", true);
+    auto owner = std::make_shared<int>(0);
+    std::vector<std::thread> threads;
+
+    for (size_t i = 0; i < thread_count; ++i) {
+      threads.emplace_back(
+          [&sink, &tmp_file, &owner, i] {
+            for (size_t j = 0; j < lines_per_thread; ++j) {
+              const std::string line = std::to_string(i) + " " +
+                  std::to_string(j) + "\n";
+
+              /* Like the logger, write the data directly once the sink
+                 refuses it. */
+              if (!sink.Write(tmp_file.GetFd(), owner, line.data(),
+                  line.size())) {
+                TryWriteExactly(tmp_file.GetFd(), line.data(), line.size());
+              }
+            }
+          });
+    }
+
+    /* Stop the sink while the threads are still writing.  No line may be
+       left behind in a buffer. */
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    sink.Stop();
+
+    for (auto &t : threads) {
+      t.join();
+    }
+
+    const std::vector<std::string> lines =
+        SplitLines(ReadFileIntoString(tmp_file.GetName()));
+    ASSERT_EQ(lines.size(), thread_count * lines_per_thread);
+  }
+
+  TEST_F(TAsyncLogSinkTest, BufferFull) {
+    const size_t line_size = 100;
+    const size_t line_count = 2000;
+    TAsyncLogSink sink;
+    sink.Start(1024, 10);
+    TFd read_end;
+    auto write_end = std::make_shared<TFd>();
+    TFd::Pipe(read_end, *write_end);
+
+    /* Nothing reads the pipe yet, so the background thread blocks once the
+       pipe is full, and the writing thread's buffer fills up. */
+    const std::string line = std::string(line_size - 1, 'x') + "\n";
+
+    for (size_t i = 0; i < line_count; ++i) {
+      ASSERT_TRUE(sink.Write(*write_end, write_end, line.data(),
+          line.size()));
+    }
+
+    size_t bytes_read = 0;
+    std::thread reader(
+        [&read_end, &bytes_read] {
+          char buf[4096];
+
+          for (; ; ) {
+            const size_t n = ReadAtMost(read_end, buf, sizeof(buf));
+
+            if (n == 0) {
+              break;
+            }
+
+            bytes_read += n;
+          }
+        });
+
+    sink.Stop();
+    write_end.reset();
+    reader.join();
+
+    /* Some lines were dropped rather than buffered without limit, and no line
+       was split. */
+    ASSERT_GT(bytes_read, 0U);
+    ASSERT_LT(bytes_read, line_count * line_size);
+    ASSERT_EQ(bytes_read % line_size, 0U);
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  DieOnTerminate();
+  return RUN_ALL_TESTS();
+}
@@ -29,6 +29,7 @@
 #include <base/error_util.h>
 #include <base/no_default_case.h>
 #include <base/wr/file_util.h>
+#include <log/async_log_sink.h>
 #include <log/write_to_fd.h>
 
 using namespace Base;
@@ -105,6 +106,23 @@ void TFileLogWriter::Enable() {
 void TFileLogWriter::WriteEntry(TLogEntryAccessApi &entry,
     bool /* no_stdout_stderr */) const noexcept {
   if (IsEnabled()) {
+    TAsyncLogSink &sink = GetAsyncLogSink();
+
+    if (sink.IsRunning()) {
+      const auto ret = entry.Get(true /* with_prefix */,
+          true /* with_trailing_newline */);
+
+      if (sink.Write(*FdRef, FdRef, ret.first,
+          static_cast<size_t>(ret.second - ret.first))) {
+        if (entry.GetLevel() <= TPri::ERR) {
+          /* Errors often precede a crash, so make sure they get written. */
+          sink.Flush();
+        }
+
+        return;
+      }
+    }
+
     switch (WriteToFd(*FdRef, entry)) {
       case TFdWriteResult::Ok: {
         break;
@@ -125,6 +143,8 @@ void TFileLogWriter::WriteEntry(TLogEntryAccessApi &entry,
 void TFileLogWriter::WriteStackTrace(TPri /* pri */, void *const *buffer,
     size_t size, bool /* no_stdout_stderr */) const noexcept {
   if (IsEnabled()) {
+    /* Write any buffered entries first, so they precede the stack trace. */
+    GetAsyncLogSink().Flush();
     backtrace_symbols_fd(buffer, static_cast<int>(size), *FdRef);
   }
 }
@@ -102,7 +102,12 @@ namespace Log {
       return OpenMode;
     }
 
-    /* Write 'entry' to file.  A trailing newline will be appended. */
+    /* Write 'entry' to file.  A trailing newline will be appended.  If the
+       sink returned by GetAsyncLogSink() is running, the entry is buffered
+       there and written by its background thread, except that entries at
+       level TPri::ERR or above wait until they are written.  That wait is a
+       synchronous TAsyncLogSink::Flush(), so logging an error may block the
+       calling thread for up to 1 second. */
     void WriteEntry(TLogEntryAccessApi &entry,
         bool no_stdout_stderr) const noexcept override;
 
@@ -32,6 +32,7 @@
 #include <base/on_destroy.h>
 #include <base/file_reader.h>
 #include <base/tmp_file.h>
+#include <log/async_log_sink.h>
 #include <log/log_entry.h>
 #include <log/pri.h>
 
@@ -115,6 +116,32 @@ namespace {
     ASSERT_EQ(file_2_contents, line_1 + "\n" + line_2 + "\n");
   }
 
+  TEST_F(TLogWriterTest, AsyncWrites) {
+    SetLogMask(UpTo(TPri::INFO));
+    const std::string tmp_filename = MakeTmpFilename(
+        "/tmp/log_writer_test.XXXXXX");
+    auto file_deleter = OnDestroy(
+        [&tmp_filename]() noexcept {
+          unlink(tmp_filename.c_str());
+        });
+    SetLogWriter(false /* enable_stdout_stderr */, false /* enable_syslog */,
+        tmp_filename /* file_path */, 0644 /* file_mode */);
+    TAsyncLogSink &sink = GetAsyncLogSink();
+    sink.Start();
+    auto sink_stopper = OnDestroy(
+        [&sink]() noexcept {
+          sink.Stop();
+        });
+    TLogEntry<64, 0>(GetLogWriter(), TPri::INFO) << "line 1";
+
+    /* An error waits for itself and everything before it to be written. */
+    TLogEntry<64, 0>(GetLogWriter(), TPri::ERR) << "line 2";
+    ASSERT_EQ(ReadFileIntoString(tmp_filename), "line 1\nline 2\n");
+    TLogEntry<64, 0>(GetLogWriter(), TPri::INFO) << "line 3";
+    sink.Stop();
+    ASSERT_EQ(ReadFileIntoString(tmp_filename), "line 1\nline 2\nline 3\n");
+  }
+
   TEST_F(TLogWriterTest, NoLogRotate) {
     SetLogMask(UpTo(TPri::INFO));
 
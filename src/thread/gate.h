@@ -70,6 +70,24 @@ namespace Thread {
       }
     }
 
+    /* Same as Put(), except the items go ahead of any items already
+       queued. */
+    void PutFront(std::list<TMsgType> &&put_list) {
+      if (!put_list.empty()) {
+        bool was_empty = false;
+
+        {
+          std::lock_guard<std::mutex> lock(Mutex);
+          was_empty = MsgList.empty();
+          MsgList.splice(MsgList.begin(), std::move(put_list));
+        }
+
+        if (was_empty) {
+          Sem.Push();
+        }
+      }
+    }
+
     std::list<TMsgType> Get() override {
       Sem.Pop();
       return NonblockingGet();
@@ -21,6 +21,7 @@
 
 #include <thread/gate.h>
 
+#include <list>
 #include <string>
 
 #include <base/tmp_file.h>
@@ -107,6 +108,37 @@ namespace {
     ASSERT_TRUE(list_2.empty());
   }
 
+  TEST_F(TGateTest, PutFront) {
+    TGate<std::string> g;
+    const Base::TFd &fd = g.GetMsgAvailableFd();
+    std::list<std::string> list_1;
+    g.PutFront(std::move(list_1));
+    ASSERT_FALSE(fd.IsReadableIntr());
+
+    list_1.emplace_back("msg3");
+    g.Put(std::move(list_1));
+    ASSERT_TRUE(fd.IsReadableIntr());
+    list_1.emplace_back("msg1");
+    list_1.emplace_back("msg2");
+    g.PutFront(std::move(list_1));
+    ASSERT_TRUE(list_1.empty());
+    list_1.emplace_back("msg4");
+    g.Put(std::move(list_1));
+    list_1 = g.Get();
+    ASSERT_FALSE(fd.IsReadableIntr());
+    ASSERT_TRUE(list_1 ==
+        std::list<std::string>({"msg1", "msg2", "msg3", "msg4"}));
+
+    /* Putting items at the front of an empty gate makes it readable. */
+    list_1.clear();
+    list_1.emplace_back("msg5");
+    g.PutFront(std::move(list_1));
+    ASSERT_TRUE(fd.IsReadableIntr());
+    list_1 = g.Get();
+    ASSERT_FALSE(fd.IsReadableIntr());
+    ASSERT_TRUE(list_1 == std::list<std::string>({"msg5"}));
+  }
+
 }  // namespace
 
 int main(int argc, char **argv) {